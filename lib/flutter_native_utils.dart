@@ -4,6 +4,8 @@ import 'package:flutter_native_utils/models/models.dart';
 
 import 'flutter_native_utils_platform_interface.dart';
 
+export 'flutter_native_utils_ffi.dart';
+
 /// Utility class providing access to native platform methods for Flutter applications.
 ///
 /// The [FlutterNativeUtils] class exposes methods that bridge between
@@ -61,6 +63,12 @@ class FlutterNativeUtils {
     return FlutterNativeUtilsPlatform.instance.createKeyPair(keyName);
   }
 
+  /// Signs [nonce] with the persisted key [keyName].
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `REPLAYED_NONCE` if a replay window is
+  ///   configured (see [configureNonceReplayWindow]) and [nonce] was already
+  ///   signed within it.
   @Deprecated('This method is not implemented for any platform.')
   Future<Uint8List> signNonce(Uint8List nonce, String keyName) {
     return FlutterNativeUtilsPlatform.instance.signNonce(nonce, keyName);
@@ -114,4 +122,620 @@ class FlutterNativeUtils {
   Future<Map<String, dynamic>?> getCertificate({required String thumbprint}) {
     return FlutterNativeUtilsPlatform.instance.getCertificate(thumbprint);
   }
+
+  /// Starts sampling system resources natively at [rateHz] (10–1000 Hz).
+  ///
+  /// Listen to [resourceSamples] to receive the samples in batches of
+  /// [batchSize]. Sampling runs on a native thread, so no external tools are
+  /// spawned and the Dart isolate only wakes up once per batch.
+  ///
+  /// Example:
+  /// ```dart
+  /// final utils = FlutterNativeUtils();
+  /// final subscription = utils.resourceSamples.listen((batch) {
+  ///   print('CPU: ${batch.cpuTotal.last}, overhead: ${batch.samplerCpuOverhead}');
+  /// });
+  /// await utils.startResourceSampler(rateHz: 100);
+  /// ```
+  Future<void> startResourceSampler({required int rateHz, int? batchSize}) {
+    return FlutterNativeUtilsPlatform.instance.startResourceSampler(rateHz: rateHz, batchSize: batchSize);
+  }
+
+  /// Stops the resource sampler and returns its final counters.
+  Future<ResourceSamplerStats> stopResourceSampler() {
+    return FlutterNativeUtilsPlatform.instance.stopResourceSampler();
+  }
+
+  /// Batches of resource samples produced while the sampler runs.
+  Stream<ResourceSampleBatch> get resourceSamples {
+    return FlutterNativeUtilsPlatform.instance.resourceSamples;
+  }
+
+  /// Requests the processor topology of the machine.
+  ///
+  /// Use it to size isolate and native worker pools, e.g. one worker per
+  /// performance core, or buffers aligned to [CpuTopology.cacheLineSize].
+  ///
+  /// Example:
+  /// ```dart
+  /// final topology = await FlutterNativeUtils().requestCpuTopology();
+  /// print('P-cores: ${topology.performanceCores}, E-cores: ${topology.efficiencyCores}');
+  /// ```
+  Future<CpuTopology> requestCpuTopology() {
+    return FlutterNativeUtilsPlatform.instance.requestCpuTopology();
+  }
+
+  /// Makes [signNonce] reject any nonce already signed within [window], so
+  /// a component that can reach the plugin cannot replay a captured nonce
+  /// through it. Every engine in the process shares the window.
+  ///
+  /// Replays are filtered natively in fixed memory, sized by [capacity], the
+  /// most nonces expected within one window (100000 by default). A nonce
+  /// never seen may rarely be rejected too, about once in a thousand at
+  /// capacity; retry with a fresh one. Nonces are remembered for at least
+  /// [window] and at most a third longer. Reconfiguring forgets the nonces
+  /// seen so far, and [Duration.zero] turns the check off. Returns the bytes
+  /// the filter holds.
+  ///
+  /// Example:
+  /// ```dart
+  /// await FlutterNativeUtils().configureNonceReplayWindow(const Duration(minutes: 5), capacity: 10000);
+  /// ```
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `BAD_ARGS` for a negative [window] or a
+  ///   [capacity] the filter cannot hold.
+  Future<int> configureNonceReplayWindow(Duration window, {int? capacity}) {
+    return FlutterNativeUtilsPlatform.instance.configureNonceReplayWindow(window, capacity: capacity);
+  }
+
+  /// Fingerprints the machine from its hardware and OS identifiers, keyed
+  /// by [salt] (at least 16 bytes, fixed per app).
+  ///
+  /// The identifiers are the SMBIOS system UUID, system and board serials,
+  /// the processor id, the OS machine id, the system disk serial and the
+  /// MACs of the physical adapters, or the subset named in [identifiers].
+  /// They are read in parallel natively, and vendor placeholders such as
+  /// "To be filled by O.E.M." count as missing.
+  ///
+  /// Pass the [DeviceFingerprint.presentComponents] of an earlier fingerprint
+  /// as [reference] to match the device while tolerating changed parts: the
+  /// result [DeviceFingerprint.matches] when at least [threshold] components
+  /// are unchanged, by default all of them but one.
+  ///
+  /// Example:
+  /// ```dart
+  /// final utils = FlutterNativeUtils();
+  /// final enrolled = await utils.getDeviceFingerprint(salt: appSalt);
+  /// // Later:
+  /// final current = await utils.getDeviceFingerprint(salt: appSalt, reference: enrolled.presentComponents);
+  /// print('Same device: ${current.matches}');
+  /// ```
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `BAD_ARGS` for a short salt, an unknown
+  ///   identifier name or a [threshold] without a [reference].
+  Future<DeviceFingerprint> getDeviceFingerprint({
+    required Uint8List salt,
+    List<String>? identifiers,
+    Map<String, Uint8List>? reference,
+    int? threshold,
+  }) {
+    return FlutterNativeUtilsPlatform.instance.getDeviceFingerprint(
+      salt: salt,
+      identifiers: identifiers,
+      reference: reference,
+      threshold: threshold,
+    );
+  }
+
+  /// Computes SHA-256 or BLAKE3 digests of [paths].
+  ///
+  /// Files are hashed on a native worker pool, so many small files and single
+  /// large files both use every core. A file that shrinks while it is hashed
+  /// gets an error rather than a digest. Listen to
+  /// [hashProgress] for byte-level progress of calls tagged with [jobId].
+  ///
+  /// Example:
+  /// ```dart
+  /// final utils = FlutterNativeUtils();
+  /// utils.hashProgress.listen((p) => print('${(p.fraction * 100).round()}%'));
+  /// final results = await utils.hashFiles(['C:\\data\\disk.img'], algorithm: HashAlgorithm.blake3);
+  /// print(results.single.hexDigest);
+  /// ```
+  Future<List<FileHashResult>> hashFiles(List<String> paths, {HashAlgorithm algorithm = HashAlgorithm.sha256, int jobId = 0}) {
+    return FlutterNativeUtilsPlatform.instance.hashFiles(paths, algorithm: algorithm, jobId: jobId);
+  }
+
+  /// Progress updates for running [hashFiles] calls.
+  Stream<HashProgress> get hashProgress {
+    return FlutterNativeUtilsPlatform.instance.hashProgress;
+  }
+
+  /// Verifies the installed app bundle against a signed manifest.
+  ///
+  /// The manifest is text of the form:
+  ///
+  /// ```text
+  /// fnu-manifest 1 sha256
+  /// <hex digest> <size> <mtime> <relative path>
+  /// ```
+  ///
+  /// It is signed at build time with a key from [createKeyPair] / [signNonce].
+  /// The signature is checked once, then only files whose size or mtime
+  /// changed since the last successful run (tracked in [cachePath]) are
+  /// rehashed, in parallel. A clean launch therefore costs one `stat` per
+  /// file instead of a full rehash.
+  ///
+  /// Example:
+  /// ```dart
+  /// final result = await FlutterNativeUtils().verifyManifest(
+  ///   manifest: manifestBytes,
+  ///   signature: signatureBytes,
+  ///   publicKey: publicKeyBlob,
+  ///   cachePath: r'C:\Program Files\MyApp\verify.cache',
+  /// );
+  /// if (!result.valid) print(result.failures);
+  /// ```
+  Future<ManifestVerification> verifyManifest({
+    required Uint8List manifest,
+    required Uint8List signature,
+    required Uint8List publicKey,
+    String? root,
+    String? cachePath,
+  }) {
+    return FlutterNativeUtilsPlatform.instance.verifyManifest(
+      manifest: manifest,
+      signature: signature,
+      publicKey: publicKey,
+      root: root,
+      cachePath: cachePath,
+    );
+  }
+
+  /// Generates a random AES-256 data key, wrapped by the persisted key-store
+  /// key [keyName] (created on first use).
+  ///
+  /// Example:
+  /// ```dart
+  /// final wrappedKey = await FlutterNativeUtils().generateDataKey('my_app_key');
+  /// ```
+  Future<Uint8List> generateDataKey(String keyName) {
+    return FlutterNativeUtilsPlatform.instance.generateDataKey(keyName);
+  }
+
+  /// Encrypts [data] with AES-256-GCM under a data key from [generateDataKey].
+  ///
+  /// Large buffers are split into independently sealed chunks that are
+  /// encrypted in parallel natively. The chunk order, count and [aad] are all
+  /// authenticated, so reordered or truncated messages fail to decrypt.
+  ///
+  /// Example:
+  /// ```dart
+  /// final sealed = await FlutterNativeUtils().encrypt(
+  ///   bytes,
+  ///   keyName: 'my_app_key',
+  ///   wrappedKey: wrappedKey,
+  /// );
+  /// ```
+  Future<Uint8List> encrypt(Uint8List data, {required String keyName, required Uint8List wrappedKey, Uint8List? aad, int? chunkSize}) {
+    return FlutterNativeUtilsPlatform.instance.encrypt(data, keyName: keyName, wrappedKey: wrappedKey, aad: aad, chunkSize: chunkSize);
+  }
+
+  /// Decrypts a message produced by [encrypt] or an encrypting cipher session.
+  ///
+  /// Example:
+  /// ```dart
+  /// final bytes = await FlutterNativeUtils().decrypt(
+  ///   sealed,
+  ///   keyName: 'my_app_key',
+  ///   wrappedKey: wrappedKey,
+  /// );
+  /// ```
+  Future<Uint8List> decrypt(Uint8List data, {required String keyName, required Uint8List wrappedKey, Uint8List? aad}) {
+    return FlutterNativeUtilsPlatform.instance.decrypt(data, keyName: keyName, wrappedKey: wrappedKey, aad: aad);
+  }
+
+  /// Starts a streaming cipher session for data that does not fit in memory
+  /// at once, e.g. a file read in pieces.
+  ///
+  /// Example:
+  /// ```dart
+  /// final utils = FlutterNativeUtils();
+  /// final id = await utils.startCipherSession(encrypt: true, keyName: 'my_app_key', wrappedKey: wrappedKey);
+  /// await for (final piece in file.openRead()) {
+  ///   sink.add(await utils.updateCipherSession(id, Uint8List.fromList(piece)));
+  /// }
+  /// sink.add(await utils.finishCipherSession(id));
+  /// ```
+  Future<int> startCipherSession({required bool encrypt, required String keyName, required Uint8List wrappedKey, Uint8List? aad, int? chunkSize}) {
+    return FlutterNativeUtilsPlatform.instance.startCipherSession(encrypt: encrypt, keyName: keyName, wrappedKey: wrappedKey, aad: aad, chunkSize: chunkSize);
+  }
+
+  /// Feeds [data] to a cipher session and returns the output produced so far.
+  Future<Uint8List> updateCipherSession(int sessionId, Uint8List data) {
+    return FlutterNativeUtilsPlatform.instance.updateCipherSession(sessionId, data);
+  }
+
+  /// Completes a cipher session and returns its remaining output.
+  Future<Uint8List> finishCipherSession(int sessionId, [Uint8List? data]) {
+    return FlutterNativeUtilsPlatform.instance.finishCipherSession(sessionId, data);
+  }
+
+  /// Discards a cipher session.
+  Future<void> cancelCipherSession(int sessionId) {
+    return FlutterNativeUtilsPlatform.instance.cancelCipherSession(sessionId);
+  }
+
+  /// Creates a reusable HMAC-SHA256/512 session for authenticating requests.
+  ///
+  /// The session is keyed by [key], or by a data key given as [keyName] and
+  /// [wrappedKey]. A data key is not used directly: the MAC key is derived
+  /// from it with HKDF-SHA256 (info "hmac"), so it differs from the key that
+  /// [encrypt] uses.
+  ///
+  /// Example:
+  /// ```dart
+  /// final utils = FlutterNativeUtils();
+  /// final session = await utils.createHmacSession(key: apiSecret);
+  /// final macs = await utils.computeHmacs(session, [body1, body2]);
+  /// ```
+  Future<int> createHmacSession({MacAlgorithm algorithm = MacAlgorithm.sha256, Uint8List? key, String? keyName, Uint8List? wrappedKey}) {
+    return FlutterNativeUtilsPlatform.instance.createHmacSession(algorithm: algorithm, key: key, keyName: keyName, wrappedKey: wrappedKey);
+  }
+
+  /// MACs a batch of messages with one platform call.
+  Future<List<Uint8List>> computeHmacs(int sessionId, List<Uint8List> messages) {
+    return FlutterNativeUtilsPlatform.instance.computeHmacs(sessionId, messages);
+  }
+
+  /// Verifies a batch of messages against their MACs in constant time.
+  ///
+  /// Example:
+  /// ```dart
+  /// final ok = await FlutterNativeUtils().verifyHmacs(session, bodies, macs);
+  /// ```
+  Future<List<bool>> verifyHmacs(int sessionId, List<Uint8List> messages, List<Uint8List> macs) {
+    return FlutterNativeUtilsPlatform.instance.verifyHmacs(sessionId, messages, macs);
+  }
+
+  /// Releases an HMAC session.
+  Future<void> closeHmacSession(int sessionId) {
+    return FlutterNativeUtilsPlatform.instance.closeHmacSession(sessionId);
+  }
+
+  /// Registers a signer's public key for [verifySignatures].
+  ///
+  /// Example:
+  /// ```dart
+  /// await FlutterNativeUtils().importPublicKey('server-1', serverKeyBlob);
+  /// ```
+  Future<void> importPublicKey(String keyId, Uint8List publicKey) {
+    return FlutterNativeUtilsPlatform.instance.importPublicKey(keyId, publicKey);
+  }
+
+  /// Forgets a key registered with [importPublicKey].
+  Future<bool> removePublicKey(String keyId) {
+    return FlutterNativeUtilsPlatform.instance.removePublicKey(keyId);
+  }
+
+  /// Verifies many signed messages in one call, in parallel natively.
+  ///
+  /// Example:
+  /// ```dart
+  /// final result = await FlutterNativeUtils().verifySignatures([
+  ///   for (final m in messages)
+  ///     SignatureCheck(message: m.body, signature: m.signature, keyId: m.server),
+  /// ]);
+  /// if (!result.allValid) print('rejected: ${result.failedIndices}');
+  /// ```
+  Future<SignatureBitmap> verifySignatures(List<SignatureCheck> checks) {
+    return FlutterNativeUtilsPlatform.instance.verifySignatures(checks);
+  }
+
+  /// Returns [length] cryptographically secure random bytes.
+  ///
+  /// Bytes come from a per-thread ChaCha20 generator seeded from the OS, so
+  /// even many small requests are cheap. For hot loops or large buffers use
+  /// [FlutterNativeUtilsFfi.randomBytes] or [FlutterNativeUtilsFfi.fillRandom],
+  /// which skip the platform channel.
+  ///
+  /// Example:
+  /// ```dart
+  /// final nonce = await FlutterNativeUtils().getRandomBytes(12);
+  /// ```
+  Future<Uint8List> getRandomBytes(int length) {
+    return FlutterNativeUtilsPlatform.instance.getRandomBytes(length);
+  }
+
+  /// Lists certificates matching [filter] a page at a time, e.g. to populate
+  /// a client-certificate picker. Filtering runs natively over an index of
+  /// the store that is only rebuilt when the store changes.
+  ///
+  /// Example:
+  /// ```dart
+  /// final utils = FlutterNativeUtils();
+  /// const filter = CertificateFilter(eku: 'clientAuth', hasPrivateKey: true);
+  /// String? token;
+  /// do {
+  ///   final page = await utils.enumerateCertificates(filter: filter, pageToken: token);
+  ///   for (final cert in page.certificates) {
+  ///     print('${cert.subject} (${cert.thumbprint})');
+  ///   }
+  ///   token = page.nextPageToken;
+  /// } while (token != null);
+  /// ```
+  Future<CertificatePage> enumerateCertificates({CertificateFilter filter = const CertificateFilter(), String storeName = 'MY', int pageSize = 100, String? pageToken}) {
+    return FlutterNativeUtilsPlatform.instance.enumerateCertificates(filter: filter, storeName: storeName, pageSize: pageSize, pageToken: pageToken);
+  }
+
+  /// Returns the validated certificate chain of a personal certificate,
+  /// built natively, so a TLS client does not rebuild it per connection.
+  ///
+  /// Example:
+  /// ```dart
+  /// final chain = await FlutterNativeUtils()
+  ///     .getCertificateChain(thumbprint: 'A1B2C3D4E5F6789012345678901234567890ABCD');
+  /// if (chain.trusted) {
+  ///   final context = SecurityContext(withTrustedRoots: false);
+  ///   for (final der in chain.certificates) {
+  ///     context.setTrustedCertificatesBytes(der);
+  ///   }
+  /// } else {
+  ///   print('Chain rejected: ${chain.status}');
+  /// }
+  /// ```
+  Future<CertificateChain> getCertificateChain({required String thumbprint, bool checkRevocation = false}) {
+    return FlutterNativeUtilsPlatform.instance.getCertificateChain(thumbprint, checkRevocation: checkRevocation);
+  }
+
+  /// Signs with the private key of a personal certificate without exporting
+  /// it, e.g. for the CertificateVerify message of TLS client authentication.
+  ///
+  /// Pass either the [data] to sign (hashed natively with [hash]) or its
+  /// [digest]. RSA keys use [padding]; EC signatures are DER-encoded. Only
+  /// the DER certificate is needed on the Dart side, e.g. the leaf of
+  /// [getCertificateChain], so no PFX is exported or re-imported.
+  ///
+  /// Example:
+  /// ```dart
+  /// final utils = FlutterNativeUtils();
+  /// const thumbprint = 'A1B2C3D4E5F6789012345678901234567890ABCD';
+  /// final chain = await utils.getCertificateChain(thumbprint: thumbprint);
+  /// final signature = await utils.signWithCertificate(
+  ///   thumbprint: thumbprint,
+  ///   data: handshakeTranscript,
+  ///   hash: SignatureHash.sha256,
+  ///   padding: SignaturePadding.pss,
+  /// );
+  /// ```
+  ///
+  /// Throws:
+  /// - [PlatformException] with code:
+  ///   - `BAD_ARGS` unless exactly one of [data] and [digest] is given, or if
+  ///     [digest] does not match [hash].
+  ///   - `FAILURE` if the certificate or its private key is not available
+  ///     (keys that need a PIN prompt are not opened).
+  ///   - `CNG_ERROR` if the key refuses to sign.
+  Future<Uint8List> signWithCertificate({
+    required String thumbprint,
+    Uint8List? data,
+    Uint8List? digest,
+    SignatureHash hash = SignatureHash.sha256,
+    SignaturePadding padding = SignaturePadding.pkcs1,
+  }) {
+    return FlutterNativeUtilsPlatform.instance.signWithCertificate(
+      thumbprint: thumbprint,
+      data: data,
+      digest: digest,
+      hash: hash,
+      padding: padding,
+    );
+  }
+
+  /// Creates native backends ahead of their first use, on a native worker
+  /// thread. Registration itself creates none, so call this once the first
+  /// frame is up rather than at startup. Without [backends], every backend
+  /// in [NativeBackend] that the native build includes is warmed.
+  ///
+  /// Example:
+  /// ```dart
+  /// WidgetsBinding.instance.addPostFrameCallback((_) {
+  ///   FlutterNativeUtils().prewarm(backends: [
+  ///     NativeBackend.certificateIndex,
+  ///     NativeBackend.certificateSigner,
+  ///   ]);
+  /// });
+  /// ```
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `BAD_ARGS` if a backend name is
+  ///   unknown to the platform, as are the backends of features left out of
+  ///   the native build.
+  Future<void> prewarm({List<NativeBackend>? backends}) {
+    return FlutterNativeUtilsPlatform.instance.prewarm(backends: backends);
+  }
+
+  /// Returns the native startup timeline: plugin registration, and when and
+  /// how long each backend took to create, on first use or in [prewarm].
+  ///
+  /// Example:
+  /// ```dart
+  /// for (final event in await FlutterNativeUtils().getStartupTimeline()) {
+  ///   print('${event.backend} (${event.phase.name}): ${event.duration.inMicroseconds} us');
+  /// }
+  /// ```
+  Future<List<StartupEvent>> getStartupTimeline() {
+    return FlutterNativeUtilsPlatform.instance.getStartupTimeline();
+  }
+
+  /// Returns queue-wait metrics for each [MethodPriority] class of native
+  /// work. Slow calls such as certificate export and hashing run as bulk
+  /// work and do not queue in front of interactive calls such as
+  /// [signNonce].
+  ///
+  /// Example:
+  /// ```dart
+  /// for (final stats in await FlutterNativeUtils().getSchedulerStats()) {
+  ///   print('${stats.priority.name}: p99 wait ${stats.p99Wait.inMicroseconds} us');
+  /// }
+  /// ```
+  Future<List<SchedulerClassStats>> getSchedulerStats() {
+    return FlutterNativeUtilsPlatform.instance.getSchedulerStats();
+  }
+
+  /// Returns the native heap use of each channel method that has been
+  /// called, for finding handlers that allocate more than they should. When
+  /// [reset] is true the totals start over after this snapshot.
+  ///
+  /// Counting replaces the native allocator, so it is only built in when the
+  /// plugin is configured with `FLUTTER_NATIVE_UTILS_ALLOCATION_STATS=ON`.
+  ///
+  /// Example:
+  /// ```dart
+  /// for (final stats in await FlutterNativeUtils().getAllocationStats()) {
+  ///   print('${stats.method}: ${stats.allocationsPerCall} allocations per call');
+  /// }
+  /// ```
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `UNAVAILABLE` if the plugin was built
+  ///   without allocation counting.
+  Future<List<MethodAllocationStats>> getAllocationStats({bool reset = false}) {
+    return FlutterNativeUtilsPlatform.instance.getAllocationStats(reset: reset);
+  }
+
+  /// Streams the rows of a system inventory class, projected to [columns]
+  /// and filtered natively, one page of [pageSize] rows at a time, so large
+  /// classes are never materialised in full. Cancelling the subscription
+  /// closes the native query.
+  ///
+  /// Class and column names are those of the platform: WMI classes such as
+  /// `Win32_DiskDrive` on Windows. They must be plain identifiers, and
+  /// filter values are escaped, so a filter cannot change the query.
+  ///
+  /// Example:
+  /// ```dart
+  /// final disks = FlutterNativeUtils().queryInventory(
+  ///   'Win32_DiskDrive',
+  ///   columns: ['Model', 'Size'],
+  ///   filter: [const InventoryCondition('MediaType', InventoryOperator.contains, 'fixed')],
+  /// );
+  /// await for (final disk in disks) {
+  ///   print('${disk['Model']}: ${disk['Size']} bytes');
+  /// }
+  /// ```
+  Stream<InventoryRow> queryInventory(
+    String className, {
+    required List<String> columns,
+    List<InventoryCondition> filter = const [],
+    int pageSize = 100,
+  }) {
+    return FlutterNativeUtilsPlatform.instance.queryInventory(
+      className,
+      columns: columns,
+      filter: filter,
+      pageSize: pageSize,
+    );
+  }
+
+  /// Lists the key pairs that [createKeyPair] created, a page at a time,
+  /// with their algorithm, size, creation time and usages. The native index
+  /// behind it is built once and kept current by the plugin's own creations
+  /// and deletions, so there is no need to mirror key names in preferences.
+  ///
+  /// Example:
+  /// ```dart
+  /// final utils = FlutterNativeUtils();
+  /// String? token;
+  /// do {
+  ///   final page = await utils.listKeys(prefix: 'com.example.', pageToken: token);
+  ///   for (final key in page.keys) {
+  ///     print('${key.name}: ${key.algorithm} ${key.lengthBits ?? '?'} bits');
+  ///   }
+  ///   token = page.nextPageToken;
+  /// } while (token != null);
+  /// ```
+  Future<KeyPage> listKeys({String prefix = '', int pageSize = 100, String? pageToken}) {
+    return FlutterNativeUtilsPlatform.instance.listKeys(prefix: prefix, pageSize: pageSize, pageToken: pageToken);
+  }
+
+  /// Returns the metadata of one key pair, or `null` if it does not exist.
+  ///
+  /// Example:
+  /// ```dart
+  /// final key = await FlutterNativeUtils().getKeyInfo('com.example.device');
+  /// print(key?.created);
+  /// ```
+  Future<KeyInfo?> getKeyInfo(String keyName) {
+    return FlutterNativeUtilsPlatform.instance.getKeyInfo(keyName);
+  }
+
+  /// Deletes a key pair. Data keys from [generateDataKey] that it wrapped
+  /// can no longer be used. Returns `false` if the key did not exist.
+  ///
+  /// Example:
+  /// ```dart
+  /// await FlutterNativeUtils().deleteKey('com.example.device');
+  /// ```
+  Future<bool> deleteKey(String keyName) {
+    return FlutterNativeUtilsPlatform.instance.deleteKey(keyName);
+  }
+
+  /// Opens the encrypted key-value store in [directory], creating it if
+  /// there is none, and returns a handle for the other `kv` methods. Keys and
+  /// values are encrypted at rest under a data key that the key pair
+  /// [keyName] wraps (created like [createKeyPair] if missing), and writes are
+  /// appended to a log rather than rewriting a file, so it suits tokens and
+  /// cached API responses. Engines that open the same directory share one
+  /// store; close each handle with [closeKvStore].
+  ///
+  /// Example:
+  /// ```dart
+  /// final utils = FlutterNativeUtils();
+  /// final store = await utils.openKvStore('${support.path}/cache', keyName: 'com.example.cache');
+  /// await utils.kvPut(store, {'token': utf8.encode(token), 'stale': null});
+  /// final cached = await utils.kvGet(store, 'token');
+  /// await utils.closeKvStore(store);
+  /// ```
+  Future<int> openKvStore(String directory, {required String keyName}) {
+    return FlutterNativeUtilsPlatform.instance.openKvStore(directory, keyName: keyName);
+  }
+
+  /// Returns the value of [key], or `null` if it has none.
+  Future<Uint8List?> kvGet(int store, String key) {
+    return FlutterNativeUtilsPlatform.instance.kvGet(store, key);
+  }
+
+  /// Writes every entry at once; a `null` value deletes its key.
+  Future<void> kvPut(int store, Map<String, Uint8List?> entries) {
+    return FlutterNativeUtilsPlatform.instance.kvPut(store, entries);
+  }
+
+  /// Deletes [keys] at once. Missing keys are ignored.
+  Future<void> kvDelete(int store, List<String> keys) {
+    return FlutterNativeUtilsPlatform.instance.kvDelete(store, keys);
+  }
+
+  /// Lists the entries whose keys start with [prefix], a page at a time.
+  ///
+  /// Example:
+  /// ```dart
+  /// String? token;
+  /// do {
+  ///   final page = await utils.kvScan(store, prefix: 'responses/', pageToken: token);
+  ///   for (final entry in page.entries) {
+  ///     print('${entry.key}: ${entry.value.length} bytes');
+  ///   }
+  ///   token = page.nextPageToken;
+  /// } while (token != null);
+  /// ```
+  Future<KvPage> kvScan(int store, {String prefix = '', int pageSize = 100, String? pageToken}) {
+    return FlutterNativeUtilsPlatform.instance.kvScan(store, prefix: prefix, pageSize: pageSize, pageToken: pageToken);
+  }
+
+  /// Releases a handle from [openKvStore]. Returns `false` if it was not open.
+  Future<bool> closeKvStore(int store) {
+    return FlutterNativeUtilsPlatform.instance.closeKvStore(store);
+  }
 }
@@ -0,0 +1,41 @@
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+typedef _FillRandomNative = Int32 Function(Pointer<Uint8> buffer, Size length);
+typedef _FillRandomDart = int Function(Pointer<Uint8> buffer, int length);
+
+/// Direct `dart:ffi` bindings for calls that are too frequent or too large for
+/// a platform-channel round trip.
+class FlutterNativeUtilsFfi {
+  FlutterNativeUtilsFfi._();
+
+  static final DynamicLibrary _library = DynamicLibrary.open('flutter_native_utils_plugin.dll');
+
+  static final _FillRandomDart _fillRandom =
+      _library.lookupFunction<_FillRandomNative, _FillRandomDart>('FlutterNativeUtilsFillRandom');
+
+  /// Fills [length] bytes at [buffer] with cryptographically secure random
+  /// bytes, generated in place on the calling thread.
+  static void fillRandom(Pointer<Uint8> buffer, int length) {
+    if (!Platform.isWindows) {
+      throw UnsupportedError('FlutterNativeUtilsFfi is only available on Windows.');
+    }
+    if (_fillRandom(buffer, length) != 0) {
+      throw StateError('The OS random number generator failed.');
+    }
+  }
+
+  /// Returns [length] cryptographically secure random bytes.
+  static Uint8List randomBytes(int length) {
+    final buffer = malloc<Uint8>(length == 0 ? 1 : length);
+    try {
+      fillRandom(buffer, length);
+      return Uint8List.fromList(buffer.asTypedList(length));
+    } finally {
+      malloc.free(buffer);
+    }
+  }
+}
@@ -10,6 +10,11 @@ class MethodChannelFlutterNativeUtils extends FlutterNativeUtilsPlatform {
   @visibleForTesting
   final methodChannel = const MethodChannel('flutter_native_utils');
 
+  /// The event channel on which the native resource sampler delivers batches.
+  @visibleForTesting
+  final resourceSampleChannel = const EventChannel('flutter_native_utils/resource_samples');
+  final hashProgressChannel = const EventChannel('flutter_native_utils/hash_progress');
+
   @override
   Future<void> requestAppRestart() async {
     try {
@@ -99,7 +104,8 @@ class MethodChannelFlutterNativeUtils extends FlutterNativeUtilsPlatform {
       }
       return signature;
     } on PlatformException catch (error) {
-      throw Exception("Unable to sign nonce: $error");
+      // Keeps the code, so callers can tell a REPLAYED_NONCE apart.
+      throw PlatformException(message: "Unable to sign nonce: ${error.message}", code: error.code);
     } on MissingPluginException catch (_) {
       throw Exception("Plugin is not created for this platform.");
     } catch (error) {
@@ -128,4 +134,1020 @@ class MethodChannelFlutterNativeUtils extends FlutterNativeUtilsPlatform {
       throw Exception("Unexpected error occured, error: $error");
     }
   }
+
+  @override
+  Future<void> startResourceSampler({required int rateHz, int? batchSize}) async {
+    try {
+      await methodChannel.invokeMethod<void>('StartResourceSampler', {
+        'rateHz': rateHz,
+        if (batchSize != null) 'batchSize': batchSize,
+      });
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to start the resource sampler, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<ResourceSamplerStats> stopResourceSampler() async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod('StopResourceSampler');
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return sampler stats.");
+      }
+      return ResourceSamplerStats.fromMap(nativeResponse);
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to stop the resource sampler, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Stream<ResourceSampleBatch> get resourceSamples => resourceSampleChannel
+      .receiveBroadcastStream()
+      .map((event) => ResourceSampleBatch.fromMap(event as Map<dynamic, dynamic>));
+
+  @override
+  Future<CpuTopology> requestCpuTopology() async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod('RequestCpuTopology');
+
+      if (nativeResponse == null) {
+        throw Exception("Unable to get cpuTopology, platform interaction failed with error: platform did not provide info.");
+      } else {
+        return CpuTopology.fromMap(nativeResponse);
+      }
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to get cpuTopology, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<int> configureNonceReplayWindow(Duration window, {int? capacity}) async {
+    try {
+      final memoryBytes = await methodChannel.invokeMethod<int>('ConfigureNonceReplayWindow', {
+        'windowMs': window.inMilliseconds,
+        if (capacity != null) 'capacity': capacity,
+      });
+      return memoryBytes ?? 0;
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to configure nonce replay window, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<DeviceFingerprint> getDeviceFingerprint({
+    required Uint8List salt,
+    List<String>? identifiers,
+    Map<String, Uint8List>? reference,
+    int? threshold,
+  }) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<Map<Object?, Object?>>('GetDeviceFingerprint', {
+        'salt': salt,
+        if (identifiers != null) 'identifiers': identifiers,
+        if (reference != null) 'reference': reference,
+        if (threshold != null) 'threshold': threshold,
+      });
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return a device fingerprint.");
+      }
+      return DeviceFingerprint.fromMap(nativeResponse);
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to get device fingerprint, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<List<FileHashResult>> hashFiles(List<String> paths, {HashAlgorithm algorithm = HashAlgorithm.sha256, int jobId = 0}) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<List<dynamic>>('HashFiles', {
+        'paths': paths,
+        'algorithm': algorithm.name,
+        'jobId': jobId,
+      });
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return hash results.");
+      }
+      return nativeResponse.map((entry) => FileHashResult.fromMap(entry as Map<dynamic, dynamic>)).toList();
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to hash files, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Stream<HashProgress> get hashProgress => hashProgressChannel
+      .receiveBroadcastStream()
+      .map((event) => HashProgress.fromMap(event as Map<dynamic, dynamic>));
+
+  @override
+  Future<ManifestVerification> verifyManifest({
+    required Uint8List manifest,
+    required Uint8List signature,
+    required Uint8List publicKey,
+    String? root,
+    String? cachePath,
+  }) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod('VerifyManifest', {
+        'manifest': manifest,
+        'signature': signature,
+        'publicKey': publicKey,
+        if (root != null) 'root': root,
+        if (cachePath != null) 'cachePath': cachePath,
+      });
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return a verification result.");
+      }
+      return ManifestVerification.fromMap(nativeResponse);
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to verify manifest, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<Uint8List> generateDataKey(String keyName) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<Uint8List>('GenerateDataKey', {'keyName': keyName});
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return any bytes.");
+      }
+      return nativeResponse;
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to generate data key, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<Uint8List> encrypt(Uint8List data, {required String keyName, required Uint8List wrappedKey, Uint8List? aad, int? chunkSize}) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<Uint8List>('Encrypt', {
+        'data': data,
+        'keyName': keyName,
+        'wrappedKey': wrappedKey,
+        if (aad != null) 'aad': aad,
+        if (chunkSize != null) 'chunkSize': chunkSize,
+      });
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return any bytes.");
+      }
+      return nativeResponse;
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to encrypt data, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<Uint8List> decrypt(Uint8List data, {required String keyName, required Uint8List wrappedKey, Uint8List? aad}) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<Uint8List>('Decrypt', {
+        'data': data,
+        'keyName': keyName,
+        'wrappedKey': wrappedKey,
+        if (aad != null) 'aad': aad,
+      });
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return any bytes.");
+      }
+      return nativeResponse;
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to decrypt data, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<int> startCipherSession({required bool encrypt, required String keyName, required Uint8List wrappedKey, Uint8List? aad, int? chunkSize}) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<int>('StartCipherSession', {
+        'mode': encrypt ? 'encrypt' : 'decrypt',
+        'keyName': keyName,
+        'wrappedKey': wrappedKey,
+        if (aad != null) 'aad': aad,
+        if (chunkSize != null) 'chunkSize': chunkSize,
+      });
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return a session id.");
+      }
+      return nativeResponse;
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to start cipher session, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<Uint8List> updateCipherSession(int sessionId, Uint8List data) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<Uint8List>('UpdateCipherSession', {'sessionId': sessionId, 'data': data});
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return any bytes.");
+      }
+      return nativeResponse;
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to update cipher session, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<Uint8List> finishCipherSession(int sessionId, [Uint8List? data]) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<Uint8List>('FinishCipherSession', {
+        'sessionId': sessionId,
+        if (data != null) 'data': data,
+      });
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return any bytes.");
+      }
+      return nativeResponse;
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to finish cipher session, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<void> cancelCipherSession(int sessionId) async {
+    try {
+      await methodChannel.invokeMethod<void>('CancelCipherSession', {'sessionId': sessionId});
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to cancel cipher session, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<int> createHmacSession({MacAlgorithm algorithm = MacAlgorithm.sha256, Uint8List? key, String? keyName, Uint8List? wrappedKey}) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<int>('CreateHmacSession', {
+        'algorithm': algorithm.name,
+        if (key != null) 'key': key,
+        if (keyName != null) 'keyName': keyName,
+        if (wrappedKey != null) 'wrappedKey': wrappedKey,
+      });
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return a session id.");
+      }
+      return nativeResponse;
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to create HMAC session, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<List<Uint8List>> computeHmacs(int sessionId, List<Uint8List> messages) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<List<Object?>>('ComputeHmacs', {'sessionId': sessionId, 'messages': messages});
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return any MACs.");
+      }
+      return nativeResponse.cast<Uint8List>();
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to compute HMACs, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<List<bool>> verifyHmacs(int sessionId, List<Uint8List> messages, List<Uint8List> macs) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<List<Object?>>('VerifyHmacs', {
+        'sessionId': sessionId,
+        'messages': messages,
+        'macs': macs,
+      });
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return any results.");
+      }
+      return nativeResponse.cast<bool>();
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to verify HMACs, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<void> closeHmacSession(int sessionId) async {
+    try {
+      await methodChannel.invokeMethod<void>('CloseHmacSession', {'sessionId': sessionId});
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to close HMAC session, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<void> importPublicKey(String keyId, Uint8List publicKey) async {
+    try {
+      await methodChannel.invokeMethod<void>('ImportPublicKey', {'keyId': keyId, 'publicKey': publicKey});
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to import public key, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<bool> removePublicKey(String keyId) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<bool>('RemovePublicKey', {'keyId': keyId});
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return a result.");
+      }
+      return nativeResponse;
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to remove public key, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<SignatureBitmap> verifySignatures(List<SignatureCheck> checks) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<Uint8List>('VerifySignatures', {
+        // Parallel lists keep the codec from encoding a map per check.
+        'messages': [for (final check in checks) check.message],
+        'signatures': [for (final check in checks) check.signature],
+        'keyIds': [for (final check in checks) check.keyId],
+      });
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return a result bitmap.");
+      }
+      return SignatureBitmap(nativeResponse, checks.length);
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to verify signatures, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<Uint8List> getRandomBytes(int length) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<Uint8List>('GetRandomBytes', {'length': length});
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return any bytes.");
+      }
+      return nativeResponse;
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to get random bytes, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<CertificatePage> enumerateCertificates({CertificateFilter filter = const CertificateFilter(), String storeName = 'MY', int pageSize = 100, String? pageToken}) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<Map<dynamic, dynamic>>('EnumerateCertificates', {
+        ...filter.toMap(),
+        'storeName': storeName,
+        'pageSize': pageSize,
+        if (pageToken != null) 'pageToken': pageToken,
+      });
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return a certificate page.");
+      }
+      return CertificatePage.fromMap(nativeResponse);
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to enumerate certificates, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<CertificateChain> getCertificateChain(String thumbprint, {bool checkRevocation = false}) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<Map<dynamic, dynamic>>('GetCertificateChain', {
+        'thumbprint': thumbprint,
+        'checkRevocation': checkRevocation,
+      });
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return a certificate chain.");
+      }
+      return CertificateChain.fromMap(nativeResponse);
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to get certificate chain, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<Uint8List> signWithCertificate({
+    required String thumbprint,
+    Uint8List? data,
+    Uint8List? digest,
+    SignatureHash hash = SignatureHash.sha256,
+    SignaturePadding padding = SignaturePadding.pkcs1,
+  }) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<Uint8List>('SignWithCertificate', {
+        'thumbprint': thumbprint,
+        if (data != null) 'data': data,
+        if (digest != null) 'digest': digest,
+        'hash': hash.name,
+        'padding': padding.name,
+      });
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return a signature.");
+      }
+      return nativeResponse;
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to sign with certificate, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<void> prewarm({List<NativeBackend>? backends}) async {
+    try {
+      await methodChannel.invokeMethod<void>('Prewarm', {
+        if (backends != null) 'backends': [for (final backend in backends) backend.name],
+      });
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to prewarm, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<List<StartupEvent>> getStartupTimeline() async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<List<Object?>>('GetStartupTimeline');
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return a startup timeline.");
+      }
+      return [
+        for (final event in nativeResponse) StartupEvent.fromMap(event as Map),
+      ];
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to get startup timeline, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<List<SchedulerClassStats>> getSchedulerStats() async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<List<Object?>>('GetSchedulerStats');
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return scheduler stats.");
+      }
+      return [
+        for (final stats in nativeResponse) SchedulerClassStats.fromMap(stats as Map),
+      ];
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to get scheduler stats, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<List<MethodAllocationStats>> getAllocationStats({bool reset = false}) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<List<Object?>>('GetAllocationStats', {'reset': reset});
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return allocation stats.");
+      }
+      return [
+        for (final stats in nativeResponse) MethodAllocationStats.fromMap(stats as Map),
+      ];
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to get allocation stats, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Stream<InventoryRow> queryInventory(
+    String className, {
+    required List<String> columns,
+    List<InventoryCondition> filter = const [],
+    int pageSize = 100,
+  }) async* {
+    var page = await _inventoryPage('QueryInventory', {
+      'class': className,
+      'columns': columns,
+      'filter': [for (final condition in filter) condition.toMap()],
+      'pageSize': pageSize,
+    });
+    try {
+      while (true) {
+        for (final values in page.rows) {
+          yield InventoryRow(columns, values);
+        }
+        if (page.done) return;
+        page = await _inventoryPage('NextInventoryPage', {'cursor': page.cursor});
+      }
+    } finally {
+      if (!page.done) {
+        // Cancelled or failed before the end; free the native cursor.
+        await methodChannel
+            .invokeMethod<bool>('CloseInventoryQuery', {'cursor': page.cursor})
+            .catchError((_) => false);
+      }
+    }
+  }
+
+  Future<_InventoryPage> _inventoryPage(String method, Map<String, Object?> arguments) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<Map<Object?, Object?>>(method, arguments);
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return an inventory page.");
+      }
+      return _InventoryPage(
+        nativeResponse['cursor'] as int,
+        [for (final row in nativeResponse['rows'] as List) List<Object?>.from(row as List)],
+        nativeResponse['done'] as bool,
+      );
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to query inventory, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+}
+
+class _InventoryPage {
+  final int cursor;
+  final List<List<Object?>> rows;
+  final bool done;
+
+  _InventoryPage(this.cursor, this.rows, this.done);
+
+  @override
+  Future<KeyPage> listKeys({String prefix = '', int pageSize = 100, String? pageToken}) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<Map<dynamic, dynamic>>('ListKeys', {
+        'prefix': prefix,
+        'pageSize': pageSize,
+        if (pageToken != null) 'pageToken': pageToken,
+      });
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return a key page.");
+      }
+      return KeyPage.fromMap(nativeResponse);
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to list keys, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<KeyInfo?> getKeyInfo(String keyName) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<Map<dynamic, dynamic>>('GetKeyInfo', {'keyName': keyName});
+      return nativeResponse == null ? null : KeyInfo.fromMap(nativeResponse);
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to get key info, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<bool> deleteKey(String keyName) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<bool>('DeleteKey', {'keyName': keyName});
+      if (nativeResponse == null) {
+        throw Exception("Platform did not report the deletion.");
+      }
+      return nativeResponse;
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to delete key, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<int> openKvStore(String directory, {required String keyName}) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<int>('OpenKvStore', {'directory': directory, 'keyName': keyName});
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return a store handle.");
+      }
+      return nativeResponse;
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to open key-value store, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<Uint8List?> kvGet(int store, String key) async {
+    try {
+      return await methodChannel.invokeMethod<Uint8List>('KvGet', {'store': store, 'key': key});
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to read key-value store, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<void> kvPut(int store, Map<String, Uint8List?> entries) async {
+    try {
+      await methodChannel.invokeMethod<void>('KvPut', {'store': store, 'entries': entries});
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to write key-value store, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<void> kvDelete(int store, List<String> keys) async {
+    try {
+      await methodChannel.invokeMethod<void>('KvDelete', {'store': store, 'keys': keys});
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to delete from key-value store, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<KvPage> kvScan(int store, {String prefix = '', int pageSize = 100, String? pageToken}) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<Map<dynamic, dynamic>>('KvScan', {
+        'store': store,
+        'prefix': prefix,
+        'pageSize': pageSize,
+        if (pageToken != null) 'pageToken': pageToken,
+      });
+      if (nativeResponse == null) {
+        throw Exception("Platform did not return a key-value page.");
+      }
+      return KvPage.fromMap(nativeResponse);
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to scan key-value store, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
+
+  @override
+  Future<bool> closeKvStore(int store) async {
+    try {
+      final nativeResponse = await methodChannel.invokeMethod<bool>('CloseKvStore', {'store': store});
+      if (nativeResponse == null) {
+        throw Exception("Platform did not report the close.");
+      }
+      return nativeResponse;
+    } on PlatformException catch (error) {
+      // Handles platform-specific exceptions.
+      // Throws an exception indicating the failure reason.
+      throw PlatformException(message: "Unable to close key-value store, platform interaction failed with error: ${error.message}", code: error.code);
+    } on MissingPluginException catch (_) {
+      // Handles the case where the plugin is not created for the platform.
+      // Throws an exception indicating the missing plugin.
+      throw MissingPluginException("Plugin is not created for this platform.");
+    } catch (error) {
+      // Handles any other exceptions.
+      // Throws an exception indicating an unexpected error.
+      throw Exception("Unexpected error occured, error: $error");
+    }
+  }
 }
@@ -1,6 +1,6 @@
 import 'dart:typed_data';
 
-import 'package:flutter_native_utils/models/hardware_info.dart';
+import 'package:flutter_native_utils/models/models.dart';
 import 'package:plugin_platform_interface/plugin_platform_interface.dart';
 
 import 'flutter_native_utils_method_channel.dart';
@@ -147,4 +147,364 @@ abstract class FlutterNativeUtilsPlatform extends PlatformInterface {
   Future<Map<String, dynamic>?> getCertificate(String thumbprint) {
     throw UnimplementedError('getCertificate() has not been implemented.');
   }
+
+  /// Starts the native system resource sampler.
+  ///
+  /// A dedicated native thread samples total and per-core CPU usage, memory,
+  /// disk and network throughput [rateHz] times per second (10–1000) and
+  /// delivers them on [resourceSamples] in batches of [batchSize] samples
+  /// (defaults to about ten batches per second).
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `BAD_ARGS` if [rateHz] is out of range,
+  ///   or `FAILURE` if the sampler is already running.
+  Future<void> startResourceSampler({required int rateHz, int? batchSize}) {
+    throw UnimplementedError('startResourceSampler() has not been implemented.');
+  }
+
+  /// Stops the native resource sampler and returns its counters, including
+  /// the CPU overhead of the sampler thread itself.
+  Future<ResourceSamplerStats> stopResourceSampler() {
+    throw UnimplementedError('stopResourceSampler() has not been implemented.');
+  }
+
+  /// Batches of samples produced by the resource sampler while it runs.
+  Stream<ResourceSampleBatch> get resourceSamples {
+    throw UnimplementedError('resourceSamples has not been implemented.');
+  }
+
+  /// Returns the processor topology: physical and logical core counts,
+  /// performance/efficiency core split, cache sizes and line size, NUMA nodes
+  /// and supported SIMD extensions.
+  ///
+  /// The topology is computed natively once per process and cached.
+  Future<CpuTopology> requestCpuTopology() {
+    throw UnimplementedError('requestCpuTopology() has not been implemented.');
+  }
+
+  /// Makes `SignNonce` reject nonces already signed within [window], or
+  /// accept every nonce again for [Duration.zero]. Returns the bytes the
+  /// native filter holds.
+  Future<int> configureNonceReplayWindow(Duration window, {int? capacity}) {
+    throw UnimplementedError('configureNonceReplayWindow() has not been implemented.');
+  }
+
+  /// Fingerprints the machine with [salt], optionally matching it against
+  /// the component hashes of an earlier fingerprint.
+  Future<DeviceFingerprint> getDeviceFingerprint({
+    required Uint8List salt,
+    List<String>? identifiers,
+    Map<String, Uint8List>? reference,
+    int? threshold,
+  }) {
+    throw UnimplementedError('getDeviceFingerprint() has not been implemented.');
+  }
+
+  /// Hashes [paths] in parallel on native worker threads and returns one
+  /// result per path, in input order. Files that cannot be read yield a result
+  /// with an error instead of failing the whole call.
+  ///
+  /// Progress for the call is reported on [hashProgress] tagged with [jobId].
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `BAD_ARGS` for invalid arguments.
+  Future<List<FileHashResult>> hashFiles(List<String> paths, {HashAlgorithm algorithm = HashAlgorithm.sha256, int jobId = 0}) {
+    throw UnimplementedError('hashFiles() has not been implemented.');
+  }
+
+  /// Progress updates for running [hashFiles] calls.
+  Stream<HashProgress> get hashProgress {
+    throw UnimplementedError('hashProgress has not been implemented.');
+  }
+
+  /// Verifies the installed bundle against a signed [manifest].
+  ///
+  /// [signature] must be a SHA-256 RSA signature over the exact [manifest]
+  /// bytes (as produced by [signNonce]) and [publicKey] the matching key blob
+  /// returned by [createKeyPair]. Only files changed since the last successful
+  /// verification recorded in [cachePath] are rehashed. [root] defaults to the
+  /// directory of the running executable.
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `BAD_ARGS` for a malformed manifest or key.
+  Future<ManifestVerification> verifyManifest({
+    required Uint8List manifest,
+    required Uint8List signature,
+    required Uint8List publicKey,
+    String? root,
+    String? cachePath,
+  }) {
+    throw UnimplementedError('verifyManifest() has not been implemented.');
+  }
+
+  /// Generates a random 256-bit data key and returns it wrapped (RSA-OAEP) by
+  /// the persisted key [keyName], which is created if it does not exist.
+  ///
+  /// Only the wrapped key ever leaves the native side; store it alongside the
+  /// data it protects.
+  Future<Uint8List> generateDataKey(String keyName) {
+    throw UnimplementedError('generateDataKey() has not been implemented.');
+  }
+
+  /// Encrypts [data] with AES-256-GCM under the data key [wrappedKey].
+  ///
+  /// The message is split into [chunkSize] byte chunks that are sealed in
+  /// parallel on native worker threads; [aad] is authenticated but not
+  /// encrypted.
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `BAD_ARGS` for invalid arguments.
+  Future<Uint8List> encrypt(Uint8List data, {required String keyName, required Uint8List wrappedKey, Uint8List? aad, int? chunkSize}) {
+    throw UnimplementedError('encrypt() has not been implemented.');
+  }
+
+  /// Decrypts a message produced by [encrypt] or a cipher session.
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `FAILURE` if the message was modified,
+  ///   truncated, or [aad] does not match.
+  Future<Uint8List> decrypt(Uint8List data, {required String keyName, required Uint8List wrappedKey, Uint8List? aad}) {
+    throw UnimplementedError('decrypt() has not been implemented.');
+  }
+
+  /// Starts a streaming encryption (`encrypt: true`) or decryption session and
+  /// returns its id. Sessions produce the same format as [encrypt].
+  Future<int> startCipherSession({required bool encrypt, required String keyName, required Uint8List wrappedKey, Uint8List? aad, int? chunkSize}) {
+    throw UnimplementedError('startCipherSession() has not been implemented.');
+  }
+
+  /// Feeds [data] to session [sessionId] and returns the output that is
+  /// complete so far. Decrypted output is only returned once authenticated.
+  Future<Uint8List> updateCipherSession(int sessionId, Uint8List data) {
+    throw UnimplementedError('updateCipherSession() has not been implemented.');
+  }
+
+  /// Feeds the optional final [data] to session [sessionId], returns the
+  /// remaining output and closes the session.
+  Future<Uint8List> finishCipherSession(int sessionId, [Uint8List? data]) {
+    throw UnimplementedError('finishCipherSession() has not been implemented.');
+  }
+
+  /// Discards session [sessionId] without producing further output.
+  Future<void> cancelCipherSession(int sessionId) {
+    throw UnimplementedError('cancelCipherSession() has not been implemented.');
+  }
+
+  /// Creates an HMAC session keyed with either a raw [key] or a data key
+  /// ([keyName] and [wrappedKey], see [generateDataKey]) and returns its id.
+  ///
+  /// The keyed hash state is kept natively and reused for every message.
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `BAD_ARGS` for invalid arguments.
+  Future<int> createHmacSession({MacAlgorithm algorithm = MacAlgorithm.sha256, Uint8List? key, String? keyName, Uint8List? wrappedKey}) {
+    throw UnimplementedError('createHmacSession() has not been implemented.');
+  }
+
+  /// Returns the MAC of each of [messages], in order.
+  Future<List<Uint8List>> computeHmacs(int sessionId, List<Uint8List> messages) {
+    throw UnimplementedError('computeHmacs() has not been implemented.');
+  }
+
+  /// Checks each of [messages] against the MAC at the same index of [macs]
+  /// using a constant-time comparison.
+  Future<List<bool>> verifyHmacs(int sessionId, List<Uint8List> messages, List<Uint8List> macs) {
+    throw UnimplementedError('verifyHmacs() has not been implemented.');
+  }
+
+  /// Releases session [sessionId].
+  Future<void> closeHmacSession(int sessionId) {
+    throw UnimplementedError('closeHmacSession() has not been implemented.');
+  }
+
+  /// Registers an RSA public key (a `BCRYPT_RSAPUBLIC_BLOB` as returned by
+  /// [createKeyPair]) under [keyId] for use by [verifySignatures]. The blob is
+  /// parsed once and cached natively; importing a new blob under the same id
+  /// replaces the key.
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `BAD_ARGS` for a malformed key.
+  Future<void> importPublicKey(String keyId, Uint8List publicKey) {
+    throw UnimplementedError('importPublicKey() has not been implemented.');
+  }
+
+  /// Forgets the key registered under [keyId]. Returns `false` if there was
+  /// none.
+  Future<bool> removePublicKey(String keyId) {
+    throw UnimplementedError('removePublicKey() has not been implemented.');
+  }
+
+  /// Verifies [checks] in parallel on native worker threads. Checks naming an
+  /// unknown key id fail rather than throwing.
+  Future<SignatureBitmap> verifySignatures(List<SignatureCheck> checks) {
+    throw UnimplementedError('verifySignatures() has not been implemented.');
+  }
+
+  /// Returns [length] cryptographically secure random bytes from the native
+  /// buffered generator.
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `BAD_ARGS` if [length] is negative or
+  ///   above 64 MiB.
+  Future<Uint8List> getRandomBytes(int length) {
+    throw UnimplementedError('getRandomBytes() has not been implemented.');
+  }
+
+  /// Lists certificates in the system store [storeName] (both locations)
+  /// that match [filter], [pageSize] (1–1000) at a time, without exporting
+  /// them. Pass the previous page's `nextPageToken` as [pageToken] to continue;
+  /// later pages come from the same snapshot as the first.
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `BAD_ARGS` for an invalid filter or an
+  ///   expired [pageToken].
+  Future<CertificatePage> enumerateCertificates({CertificateFilter filter = const CertificateFilter(), String storeName = 'MY', int pageSize = 100, String? pageToken}) {
+    throw UnimplementedError('enumerateCertificates() has not been implemented.');
+  }
+
+  /// Builds and validates the chain of the certificate with [thumbprint]
+  /// natively and returns it as DER blobs, leaf first. Chains are cached per
+  /// leaf until a certificate in them expires or a TTL elapses. Revocation is
+  /// only checked if [checkRevocation] is set, which may need the network.
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `FAILURE` if the certificate is not in
+  ///   the personal store.
+  Future<CertificateChain> getCertificateChain(String thumbprint, {bool checkRevocation = false}) {
+    throw UnimplementedError('getCertificateChain() has not been implemented.');
+  }
+
+  /// Signs [data], or a precomputed [digest] of it, with the private key of
+  /// the personal certificate with [thumbprint]. The key is opened once and
+  /// cached natively; it is never exported.
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `FAILURE` if the certificate or its
+  ///   private key is not available.
+  Future<Uint8List> signWithCertificate({
+    required String thumbprint,
+    Uint8List? data,
+    Uint8List? digest,
+    SignatureHash hash = SignatureHash.sha256,
+    SignaturePadding padding = SignaturePadding.pkcs1,
+  }) {
+    throw UnimplementedError('signWithCertificate() has not been implemented.');
+  }
+
+  /// Creates [backends] (all of them if `null`) on a native worker ahead of
+  /// their first use. Completes once they are ready; failures are recorded
+  /// on the startup timeline and retried on first use.
+  Future<void> prewarm({List<NativeBackend>? backends}) {
+    throw UnimplementedError('prewarm() has not been implemented.');
+  }
+
+  /// Returns how long plugin registration and each backend's creation took.
+  Future<List<StartupEvent>> getStartupTimeline() {
+    throw UnimplementedError('getStartupTimeline() has not been implemented.');
+  }
+
+  /// Returns queue-wait metrics of each scheduling class of native work.
+  Future<List<SchedulerClassStats>> getSchedulerStats() {
+    throw UnimplementedError('getSchedulerStats() has not been implemented.');
+  }
+
+  /// Returns the native heap use of each channel method, optionally
+  /// resetting the totals.
+  Future<List<MethodAllocationStats>> getAllocationStats({bool reset = false}) {
+    throw UnimplementedError('getAllocationStats() has not been implemented.');
+  }
+
+  /// Streams the rows of [className] matching every [filter] condition,
+  /// projected to [columns]. Rows are fetched [pageSize] at a time as the
+  /// stream is listened to; cancelling the subscription closes the native
+  /// query.
+  Stream<InventoryRow> queryInventory(
+    String className, {
+    required List<String> columns,
+    List<InventoryCondition> filter = const [],
+    int pageSize = 100,
+  }) {
+    throw UnimplementedError('queryInventory() has not been implemented.');
+  }
+
+  /// Lists the key pairs in the native key store whose names start with
+  /// [prefix], [pageSize] (1–1000) at a time, in name order. Pass the
+  /// previous page's `nextPageToken` as [pageToken] to continue; keys created
+  /// or deleted in between do not shift later pages. Keys are listed from a
+  /// native index without being opened.
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `BAD_ARGS` for an invalid [pageSize].
+  Future<KeyPage> listKeys({String prefix = '', int pageSize = 100, String? pageToken}) {
+    throw UnimplementedError('listKeys() has not been implemented.');
+  }
+
+  /// Returns the full metadata of the key pair [keyName], or `null` if there
+  /// is no such key.
+  Future<KeyInfo?> getKeyInfo(String keyName) {
+    throw UnimplementedError('getKeyInfo() has not been implemented.');
+  }
+
+  /// Deletes the key pair [keyName] and drops every data key it unwrapped
+  /// from the native caches. Returns whether the key existed.
+  Future<bool> deleteKey(String keyName) {
+    throw UnimplementedError('deleteKey() has not been implemented.');
+  }
+
+  /// Opens the encrypted key-value store in [directory] and returns a handle
+  /// to it. Its data key is wrapped by the key pair [keyName]; a store must
+  /// always be opened with the key it was created with.
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `BAD_ARGS` if [directory] or [keyName]
+  ///   is empty, or the store is already open under another key.
+  /// - [PlatformException] with code `FAILURE` if the directory cannot be
+  ///   used, is not a store, or [keyName] cannot unwrap its data key.
+  Future<int> openKvStore(String directory, {required String keyName}) {
+    throw UnimplementedError('openKvStore() has not been implemented.');
+  }
+
+  /// Returns the value of [key] in [store], or `null` if it has none.
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `BAD_ARGS` for a closed [store].
+  /// - [PlatformException] with code `FAILURE` if the record cannot be read
+  ///   or authenticated.
+  Future<Uint8List?> kvGet(int store, String key) {
+    throw UnimplementedError('kvGet() has not been implemented.');
+  }
+
+  /// Applies [entries] to [store] as one atomic, durable batch; a `null`
+  /// value deletes its key. Concurrent writes share a flush.
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `BAD_ARGS` for a closed [store], an
+  ///   empty key, or a key over 4096 bytes.
+  /// - [PlatformException] with code `FAILURE` if the log cannot be written.
+  Future<void> kvPut(int store, Map<String, Uint8List?> entries) {
+    throw UnimplementedError('kvPut() has not been implemented.');
+  }
+
+  /// Deletes [keys] from [store] as one atomic batch.
+  Future<void> kvDelete(int store, List<String> keys) {
+    throw UnimplementedError('kvDelete() has not been implemented.');
+  }
+
+  /// Lists the entries of [store] whose keys start with [prefix], [pageSize]
+  /// (1–1000) at a time, in key order. Pass the previous page's
+  /// `nextPageToken` as [pageToken] to continue. Keys are stored hashed, so
+  /// every page decrypts the whole store; prefer [kvGet] on hot paths.
+  ///
+  /// Throws:
+  /// - [PlatformException] with code `BAD_ARGS` for a closed [store] or an
+  ///   invalid [pageSize].
+  Future<KvPage> kvScan(int store, {String prefix = '', int pageSize = 100, String? pageToken}) {
+    throw UnimplementedError('kvScan() has not been implemented.');
+  }
+
+  /// Releases the handle [store]; the store closes with its last handle.
+  /// Returns whether it was open.
+  Future<bool> closeKvStore(int store) {
+    throw UnimplementedError('closeKvStore() has not been implemented.');
+  }
 }
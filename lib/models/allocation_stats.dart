@@ -0,0 +1,40 @@
+/// Native heap use of one channel method, returned by `getAllocationStats`.
+/// Totals run from plugin load, or from the last reset, and cover every
+/// engine in the process.
+class MethodAllocationStats {
+  final String method;
+  final int calls;
+
+  /// Native allocations the calls made, and the bytes they asked for. Work a
+  /// method hands to other native threads is only counted when it runs on
+  /// the plugin's workers.
+  final int allocations;
+  final int bytes;
+
+  /// The most one call held at once.
+  final int peakBytes;
+
+  MethodAllocationStats({
+    required this.method,
+    required this.calls,
+    required this.allocations,
+    required this.bytes,
+    required this.peakBytes,
+  });
+
+  /// Average allocations per call.
+  double get allocationsPerCall => calls == 0 ? 0 : allocations / calls;
+
+  factory MethodAllocationStats.fromMap(Map<dynamic, dynamic> map) {
+    return MethodAllocationStats(
+      method: map['method'] as String,
+      calls: map['calls'] as int,
+      allocations: map['allocations'] as int,
+      bytes: map['bytes'] as int,
+      peakBytes: map['peakBytes'] as int,
+    );
+  }
+
+  @override
+  String toString() => 'MethodAllocationStats($method, calls: $calls, allocations: $allocations, bytes: $bytes, peak: $peakBytes B)';
+}
@@ -0,0 +1,33 @@
+import 'dart:typed_data';
+
+/// A certificate chain built natively by `getCertificateChain`.
+class CertificateChain {
+  /// DER-encoded certificates, leaf first, ending at the root if one was
+  /// found.
+  final List<Uint8List> certificates;
+
+  /// Whether the chain validated up to a trusted root.
+  final bool trusted;
+
+  /// Why the chain is not trusted (e.g. `untrusted root`), or `null`.
+  final String? status;
+
+  CertificateChain({
+    required this.certificates,
+    required this.trusted,
+    this.status,
+  });
+
+  Uint8List get leaf => certificates.first;
+
+  factory CertificateChain.fromMap(Map<dynamic, dynamic> map) {
+    return CertificateChain(
+      certificates: (map['certificates'] as List).cast<Uint8List>(),
+      trusted: map['trusted'] as bool,
+      status: map['status'] as String?,
+    );
+  }
+
+  @override
+  String toString() => 'CertificateChain(length: ${certificates.length}, trusted: $trusted, status: $status)';
+}
@@ -0,0 +1,128 @@
+/// Windows certificate store locations.
+enum CertificateStoreLocation {
+  currentUser,
+  localMachine,
+}
+
+/// Criteria for `enumerateCertificates`. Every field that is set must match.
+class CertificateFilter {
+  /// Case-insensitive substring of the subject, e.g. `'CN=Alice'`.
+  final String? subjectContains;
+
+  /// Case-insensitive substring of the issuer.
+  final String? issuerContains;
+
+  /// Extended key usage the certificate must allow: an OID, or one of
+  /// `serverAuth`, `clientAuth`, `codeSigning`, `emailProtection` and
+  /// `timeStamping`. Certificates without an EKU extension allow every usage.
+  final String? eku;
+
+  /// The certificate must be valid from [validFrom] through [validTo]. If only
+  /// one is set, it must be valid at that instant.
+  final DateTime? validFrom;
+  final DateTime? validTo;
+
+  /// Only certificates with (or without) an associated private key.
+  final bool? hasPrivateKey;
+
+  /// Only certificates from this location; both are listed if `null`.
+  final CertificateStoreLocation? storeLocation;
+
+  const CertificateFilter({
+    this.subjectContains,
+    this.issuerContains,
+    this.eku,
+    this.validFrom,
+    this.validTo,
+    this.hasPrivateKey,
+    this.storeLocation,
+  });
+
+  Map<String, dynamic> toMap() => {
+        if (subjectContains != null) 'subjectContains': subjectContains,
+        if (issuerContains != null) 'issuerContains': issuerContains,
+        if (eku != null) 'eku': eku,
+        if (validFrom != null) 'validFrom': validFrom!.millisecondsSinceEpoch,
+        if (validTo != null) 'validTo': validTo!.millisecondsSinceEpoch,
+        if (hasPrivateKey != null) 'hasPrivateKey': hasPrivateKey,
+        if (storeLocation != null) 'storeLocation': storeLocation!.name,
+      };
+}
+
+/// Metadata of one certificate in a store. Pass [thumbprint] to
+/// `getCertificate` to export it.
+class CertificateInfo {
+  /// Upper-case hex SHA-1 thumbprint.
+  final String thumbprint;
+
+  /// Subject name, most specific part first, e.g. `'CN=Alice, O=Example'`.
+  final String subject;
+  final String issuer;
+
+  /// Upper-case hex serial number.
+  final String serialNumber;
+  final DateTime notBefore;
+  final DateTime notAfter;
+
+  /// Extended key usage OIDs; empty if the certificate allows every usage.
+  final List<String> ekus;
+  final bool hasPrivateKey;
+  final CertificateStoreLocation storeLocation;
+
+  CertificateInfo({
+    required this.thumbprint,
+    required this.subject,
+    required this.issuer,
+    required this.serialNumber,
+    required this.notBefore,
+    required this.notAfter,
+    required this.ekus,
+    required this.hasPrivateKey,
+    required this.storeLocation,
+  });
+
+  /// Whether the certificate is valid at [time] (default: now).
+  bool isValidAt([DateTime? time]) {
+    final at = time ?? DateTime.now();
+    return !at.isBefore(notBefore) && !at.isAfter(notAfter);
+  }
+
+  factory CertificateInfo.fromMap(Map<dynamic, dynamic> map) {
+    return CertificateInfo(
+      thumbprint: map['thumbprint'] as String,
+      subject: map['subject'] as String,
+      issuer: map['issuer'] as String,
+      serialNumber: map['serialNumber'] as String,
+      notBefore: DateTime.fromMillisecondsSinceEpoch(map['notBefore'] as int, isUtc: true),
+      notAfter: DateTime.fromMillisecondsSinceEpoch(map['notAfter'] as int, isUtc: true),
+      ekus: (map['ekus'] as List).cast<String>(),
+      hasPrivateKey: map['hasPrivateKey'] as bool,
+      storeLocation: CertificateStoreLocation.values.byName(map['storeLocation'] as String),
+    );
+  }
+
+  @override
+  String toString() => 'CertificateInfo(subject: $subject, thumbprint: $thumbprint)';
+}
+
+/// One page of `enumerateCertificates` results.
+class CertificatePage {
+  final List<CertificateInfo> certificates;
+
+  /// Pass to `enumerateCertificates` to fetch the next page; `null` on the
+  /// last page.
+  final String? nextPageToken;
+
+  CertificatePage(this.certificates, this.nextPageToken);
+
+  bool get hasMore => nextPageToken != null;
+
+  factory CertificatePage.fromMap(Map<dynamic, dynamic> map) {
+    return CertificatePage(
+      [
+        for (final certificate in map['certificates'] as List) CertificateInfo.fromMap(certificate as Map),
+      ],
+      map['nextPageToken'] as String?,
+    );
+  }
+}
@@ -0,0 +1,13 @@
+/// Hash functions supported by `signWithCertificate`.
+enum SignatureHash {
+  sha256,
+  sha384,
+  sha512,
+}
+
+/// RSA signature paddings supported by `signWithCertificate`. PSS uses a salt
+/// as long as the digest, as TLS 1.3 requires. EC keys ignore the padding.
+enum SignaturePadding {
+  pkcs1,
+  pss,
+}
@@ -0,0 +1,165 @@
+/// The kind of a physical core on hybrid CPUs.
+enum CpuCoreType {
+  /// A high-performance core (P-core, or "big" core).
+  performance,
+
+  /// A power-efficient core (E-core, or "LITTLE" core).
+  efficiency,
+}
+
+/// A physical core and the logical processors (hardware threads) it runs.
+class CpuCore {
+  /// Logical processor numbers belonging to this core.
+  final List<int> logicalProcessors;
+
+  /// Whether this is a performance or efficiency core.
+  final CpuCoreType type;
+
+  /// Relative performance class reported by the OS; higher is faster.
+  final int efficiencyClass;
+
+  CpuCore({
+    required this.logicalProcessors,
+    required this.type,
+    required this.efficiencyClass,
+  });
+
+  factory CpuCore.fromMap(Map<dynamic, dynamic> map) {
+    return CpuCore(
+      logicalProcessors: List<int>.from(map['logicalProcessors'] as List),
+      type: map['type'] == 'efficiency' ? CpuCoreType.efficiency : CpuCoreType.performance,
+      efficiencyClass: map['efficiencyClass'] as int,
+    );
+  }
+
+  @override
+  String toString() => 'CpuCore(logicalProcessors: $logicalProcessors, type: ${type.name})';
+}
+
+/// A cache level and type, aggregated over all of its instances.
+class CpuCache {
+  /// Cache level (1, 2, 3, ...).
+  final int level;
+
+  /// `data`, `instruction` or `unified`.
+  final String type;
+
+  /// Size of a single instance in bytes.
+  final int sizeBytes;
+
+  /// Cache line size in bytes.
+  final int lineSize;
+
+  /// Number of instances of this cache in the system.
+  final int instances;
+
+  /// Number of logical processors sharing one instance.
+  final int sharedBy;
+
+  CpuCache({
+    required this.level,
+    required this.type,
+    required this.sizeBytes,
+    required this.lineSize,
+    required this.instances,
+    required this.sharedBy,
+  });
+
+  factory CpuCache.fromMap(Map<dynamic, dynamic> map) {
+    return CpuCache(
+      level: map['level'] as int,
+      type: map['type'] as String,
+      sizeBytes: map['sizeBytes'] as int,
+      lineSize: map['lineSize'] as int,
+      instances: map['instances'] as int,
+      sharedBy: map['sharedBy'] as int,
+    );
+  }
+
+  @override
+  String toString() => 'CpuCache(L$level $type, sizeBytes: $sizeBytes, lineSize: $lineSize, instances: $instances)';
+}
+
+/// A NUMA node and the logical processors attached to it.
+class NumaNode {
+  /// The NUMA node number.
+  final int node;
+
+  /// Logical processor numbers on this node (the node's CPU mask).
+  final List<int> logicalProcessors;
+
+  NumaNode({required this.node, required this.logicalProcessors});
+
+  factory NumaNode.fromMap(Map<dynamic, dynamic> map) {
+    return NumaNode(
+      node: map['node'] as int,
+      logicalProcessors: List<int>.from(map['logicalProcessors'] as List),
+    );
+  }
+
+  @override
+  String toString() => 'NumaNode(node: $node, logicalProcessors: $logicalProcessors)';
+}
+
+/// Processor topology of the machine, for sizing isolate and worker pools.
+class CpuTopology {
+  /// Number of physical processor packages (sockets).
+  final int packages;
+
+  /// Number of physical cores.
+  final int physicalCores;
+
+  /// Number of logical processors (hardware threads).
+  final int logicalProcessors;
+
+  /// Number of performance cores. Equals [physicalCores] on non-hybrid CPUs.
+  final int performanceCores;
+
+  /// Number of efficiency cores. Zero on non-hybrid CPUs.
+  final int efficiencyCores;
+
+  final List<CpuCore> cores;
+  final List<CpuCache> caches;
+  final List<NumaNode> numaNodes;
+
+  /// Supported SIMD extensions, e.g. `sse4.2`, `avx2`, `avx512f`, `neon`.
+  final List<String> simdFeatures;
+
+  CpuTopology({
+    required this.packages,
+    required this.physicalCores,
+    required this.logicalProcessors,
+    required this.performanceCores,
+    required this.efficiencyCores,
+    required this.cores,
+    required this.caches,
+    required this.numaNodes,
+    required this.simdFeatures,
+  });
+
+  /// Cache line size of the first-level data cache, or 64 if unknown.
+  int get cacheLineSize {
+    for (final cache in caches) {
+      if (cache.level == 1 && cache.type != 'instruction') return cache.lineSize;
+    }
+    return 64;
+  }
+
+  factory CpuTopology.fromMap(Map<dynamic, dynamic> map) {
+    return CpuTopology(
+      packages: map['packages'] as int,
+      physicalCores: map['physicalCores'] as int,
+      logicalProcessors: map['logicalProcessors'] as int,
+      performanceCores: map['performanceCores'] as int,
+      efficiencyCores: map['efficiencyCores'] as int,
+      cores: (map['cores'] as List).map((e) => CpuCore.fromMap(e as Map)).toList(),
+      caches: (map['caches'] as List).map((e) => CpuCache.fromMap(e as Map)).toList(),
+      numaNodes: (map['numaNodes'] as List).map((e) => NumaNode.fromMap(e as Map)).toList(),
+      simdFeatures: List<String>.from(map['simdFeatures'] as List),
+    );
+  }
+
+  @override
+  String toString() =>
+      'CpuTopology(physicalCores: $physicalCores, logicalProcessors: $logicalProcessors, performanceCores: $performanceCores, efficiencyCores: $efficiencyCores, numaNodes: ${numaNodes.length}, simdFeatures: $simdFeatures)';
+}
@@ -0,0 +1,52 @@
+import 'dart:typed_data';
+
+/// A salted fingerprint of the machine, returned by `getDeviceFingerprint`.
+///
+/// Neither the digest nor the component hashes reveal the identifiers they
+/// were computed from, and fingerprints taken with different salts cannot be
+/// linked.
+class DeviceFingerprint {
+  /// HMAC-SHA256 over every component. Changes when any identifier does,
+  /// e.g. after a disk or network card is replaced.
+  final Uint8List digest;
+
+  /// The hash of each identifier by name, or `null` where the machine has
+  /// none or reports a vendor placeholder. Store these to match the device
+  /// later with `reference`.
+  final Map<String, Uint8List?> components;
+
+  /// The number of components equal to those of the `reference` passed in,
+  /// or `null` without one.
+  final int? matchingComponents;
+
+  /// Whether [matchingComponents] reached the threshold, or `null` without a
+  /// `reference`.
+  final bool? matches;
+
+  DeviceFingerprint({
+    required this.digest,
+    required this.components,
+    this.matchingComponents,
+    this.matches,
+  });
+
+  /// The components the machine has, in the form `reference` takes.
+  Map<String, Uint8List> get presentComponents => {
+        for (final entry in components.entries)
+          if (entry.value != null) entry.key: entry.value!,
+      };
+
+  factory DeviceFingerprint.fromMap(Map<dynamic, dynamic> map) {
+    return DeviceFingerprint(
+      digest: map['digest'] as Uint8List,
+      components: {
+        for (final entry in (map['components'] as Map).entries) entry.key as String: entry.value as Uint8List?,
+      },
+      matchingComponents: map['matchingComponents'] as int?,
+      matches: map['matches'] as bool?,
+    );
+  }
+
+  @override
+  String toString() => 'DeviceFingerprint(${presentComponents.length} of ${components.length} components, matches: $matches)';
+}
@@ -0,0 +1,87 @@
+import 'dart:typed_data';
+
+/// Digest algorithms supported by `hashFiles`.
+enum HashAlgorithm {
+  sha256,
+  blake3,
+}
+
+/// The digest of one file, or the reason it could not be hashed.
+class FileHashResult {
+  /// The path as passed to `hashFiles`.
+  final String path;
+
+  /// File size in bytes (0 if the file could not be opened).
+  final int size;
+
+  /// The 32-byte digest, or `null` if [error] is set.
+  final Uint8List? digest;
+
+  /// Why the file could not be hashed, or `null` on success.
+  final String? error;
+
+  FileHashResult({
+    required this.path,
+    required this.size,
+    this.digest,
+    this.error,
+  });
+
+  /// The digest as lowercase hex, or `null` if hashing failed.
+  String? get hexDigest => digest?.map((byte) => byte.toRadixString(16).padLeft(2, '0')).join();
+
+  factory FileHashResult.fromMap(Map<dynamic, dynamic> map) {
+    return FileHashResult(
+      path: map['path'] as String,
+      size: map['size'] as int,
+      digest: map['digest'] as Uint8List?,
+      error: map['error'] as String?,
+    );
+  }
+
+  @override
+  String toString() => 'FileHashResult(path: $path, size: $size, digest: $hexDigest, error: $error)';
+}
+
+/// Progress of a running `hashFiles` job.
+class HashProgress {
+  /// The `jobId` passed to `hashFiles`.
+  final int jobId;
+
+  /// Files finished so far, including files that failed.
+  final int filesDone;
+
+  /// Number of files in the job.
+  final int fileCount;
+
+  /// Bytes hashed so far.
+  final int bytesDone;
+
+  /// Total size of all readable files in the job.
+  final int totalBytes;
+
+  HashProgress({
+    required this.jobId,
+    required this.filesDone,
+    required this.fileCount,
+    required this.bytesDone,
+    required this.totalBytes,
+  });
+
+  /// Completed fraction in `[0, 1]`, by bytes.
+  double get fraction => totalBytes == 0 ? (filesDone == fileCount ? 1 : 0) : bytesDone / totalBytes;
+
+  factory HashProgress.fromMap(Map<dynamic, dynamic> map) {
+    return HashProgress(
+      jobId: map['jobId'] as int,
+      filesDone: map['filesDone'] as int,
+      fileCount: map['fileCount'] as int,
+      bytesDone: map['bytesDone'] as int,
+      totalBytes: map['totalBytes'] as int,
+    );
+  }
+
+  @override
+  String toString() =>
+      'HashProgress(jobId: $jobId, filesDone: $filesDone/$fileCount, bytesDone: $bytesDone/$totalBytes)';
+}
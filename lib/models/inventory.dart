@@ -0,0 +1,47 @@
+/// Comparison of an [InventoryCondition]. Strings compare case-insensitively
+/// and numbers compare across int and double; `null` only equals `null`.
+enum InventoryOperator {
+  equals,
+  notEquals,
+  less,
+  greater,
+
+  /// Substring match of a string column.
+  contains,
+}
+
+/// One filter condition of `queryInventory`. The column need not be one of
+/// the projected columns.
+class InventoryCondition {
+  final String column;
+  final InventoryOperator op;
+
+  /// `null`, a bool, an int, a double or a String.
+  final Object? value;
+
+  const InventoryCondition(this.column, this.op, this.value);
+
+  Map<String, Object?> toMap() => {'column': column, 'op': op.name, 'value': value};
+
+  @override
+  String toString() => 'InventoryCondition($column ${op.name} $value)';
+}
+
+/// One row of `queryInventory`, with values in the order of the projected
+/// [columns]. Values are `null`, bool, int, double, String, or lists of
+/// String or int.
+class InventoryRow {
+  final List<String> columns;
+  final List<Object?> values;
+
+  InventoryRow(this.columns, this.values);
+
+  /// The value of [column], or `null` if it was not projected.
+  Object? operator [](String column) {
+    final index = columns.indexOf(column);
+    return index < 0 ? null : values[index];
+  }
+
+  @override
+  String toString() => 'InventoryRow(${[for (var i = 0; i < columns.length; i++) '${columns[i]}: ${values[i]}'].join(', ')})';
+}
@@ -0,0 +1,62 @@
+/// Metadata of a key pair in the native key store, as created by
+/// `createKeyPair`.
+///
+/// Listing does not open keys, so [lengthBits], [created] and [usages] are
+/// `null` for keys whose details the native index has not read yet. Keys
+/// created through the plugin, and keys passed to `getKeyInfo`, have them.
+class KeyInfo {
+  final String name;
+
+  /// Algorithm identifier, e.g. `'RSA'` or `'ECDSA_P256'`.
+  final String algorithm;
+  final int? lengthBits;
+  final DateTime? created;
+
+  /// Any of `decrypt`, `sign` and `keyAgreement`.
+  final List<String>? usages;
+
+  KeyInfo({
+    required this.name,
+    required this.algorithm,
+    this.lengthBits,
+    this.created,
+    this.usages,
+  });
+
+  bool get hasDetails => lengthBits != null;
+
+  factory KeyInfo.fromMap(Map<dynamic, dynamic> map) {
+    final created = map['created'] as int?;
+    return KeyInfo(
+      name: map['name'] as String,
+      algorithm: map['algorithm'] as String,
+      lengthBits: map['lengthBits'] as int?,
+      created: created == null ? null : DateTime.fromMillisecondsSinceEpoch(created, isUtc: true),
+      usages: (map['usages'] as List?)?.cast<String>(),
+    );
+  }
+
+  @override
+  String toString() => 'KeyInfo(name: $name, algorithm: $algorithm)';
+}
+
+/// One page of `listKeys` results, in name order.
+class KeyPage {
+  final List<KeyInfo> keys;
+
+  /// Pass to `listKeys` to fetch the next page; `null` on the last page.
+  final String? nextPageToken;
+
+  KeyPage(this.keys, this.nextPageToken);
+
+  bool get hasMore => nextPageToken != null;
+
+  factory KeyPage.fromMap(Map<dynamic, dynamic> map) {
+    return KeyPage(
+      [
+        for (final key in map['keys'] as List) KeyInfo.fromMap(key as Map),
+      ],
+      map['nextPageToken'] as String?,
+    );
+  }
+}
@@ -0,0 +1,37 @@
+import 'dart:typed_data';
+
+/// One entry of an encrypted key-value store, as returned by `kvScan`.
+class KvEntry {
+  final String key;
+  final Uint8List value;
+
+  KvEntry(this.key, this.value);
+
+  factory KvEntry.fromMap(Map<dynamic, dynamic> map) {
+    return KvEntry(map['key'] as String, map['value'] as Uint8List);
+  }
+
+  @override
+  String toString() => 'KvEntry(key: $key, ${value.length} bytes)';
+}
+
+/// One page of `kvScan` results, in key order.
+class KvPage {
+  final List<KvEntry> entries;
+
+  /// Pass to `kvScan` to fetch the next page; `null` on the last page.
+  final String? nextPageToken;
+
+  KvPage(this.entries, this.nextPageToken);
+
+  bool get hasMore => nextPageToken != null;
+
+  factory KvPage.fromMap(Map<dynamic, dynamic> map) {
+    return KvPage(
+      [
+        for (final entry in map['entries'] as List) KvEntry.fromMap(entry as Map),
+      ],
+      map['nextPageToken'] as String?,
+    );
+  }
+}
@@ -0,0 +1,5 @@
+/// Hash functions supported by HMAC sessions (`createHmacSession`).
+enum MacAlgorithm {
+  sha256,
+  sha512,
+}
@@ -0,0 +1,83 @@
+/// Why a file listed in a manifest failed verification.
+enum ManifestFailureReason {
+  missing,
+  sizeMismatch,
+  digestMismatch,
+  readError,
+}
+
+/// A file that did not match its manifest entry.
+class ManifestFailure {
+  /// Path relative to the bundle root, as listed in the manifest.
+  final String path;
+
+  final ManifestFailureReason reason;
+
+  /// Human-readable details, e.g. the expected and actual digests.
+  final String detail;
+
+  ManifestFailure({
+    required this.path,
+    required this.reason,
+    required this.detail,
+  });
+
+  factory ManifestFailure.fromMap(Map<dynamic, dynamic> map) {
+    return ManifestFailure(
+      path: map['path'] as String,
+      reason: ManifestFailureReason.values.byName(map['reason'] as String),
+      detail: map['detail'] as String,
+    );
+  }
+
+  @override
+  String toString() => 'ManifestFailure(path: $path, reason: ${reason.name}, detail: $detail)';
+}
+
+/// The outcome of verifying an installed bundle against a signed manifest.
+class ManifestVerification {
+  /// `true` if the signature is valid and every file matches.
+  final bool valid;
+
+  /// Whether the manifest signature verified. When `false` no files are
+  /// checked.
+  final bool signatureValid;
+
+  /// Number of files listed in the manifest.
+  final int filesChecked;
+
+  /// Files that were rehashed because they changed since the last successful
+  /// verification (all of them on the first run).
+  final int filesRehashed;
+
+  /// Wall-clock time the native verification took.
+  final Duration elapsed;
+
+  final List<ManifestFailure> failures;
+
+  ManifestVerification({
+    required this.valid,
+    required this.signatureValid,
+    required this.filesChecked,
+    required this.filesRehashed,
+    required this.elapsed,
+    required this.failures,
+  });
+
+  factory ManifestVerification.fromMap(Map<dynamic, dynamic> map) {
+    return ManifestVerification(
+      valid: map['valid'] as bool,
+      signatureValid: map['signatureValid'] as bool,
+      filesChecked: map['filesChecked'] as int,
+      filesRehashed: map['filesRehashed'] as int,
+      elapsed: Duration(microseconds: map['elapsedUs'] as int),
+      failures: (map['failures'] as List<dynamic>)
+          .map((failure) => ManifestFailure.fromMap(failure as Map<dynamic, dynamic>))
+          .toList(),
+    );
+  }
+
+  @override
+  String toString() =>
+      'ManifestVerification(valid: $valid, signatureValid: $signatureValid, filesChecked: $filesChecked, filesRehashed: $filesRehashed, elapsed: $elapsed, failures: $failures)';
+}
@@ -1 +1,17 @@
+export 'allocation_stats.dart';
+export 'certificate_chain.dart';
+export 'certificate_info.dart';
+export 'certificate_signing.dart';
+export 'cpu_topology.dart';
+export 'device_fingerprint.dart';
+export 'file_hash.dart';
 export 'hardware_info.dart';
+export 'inventory.dart';
+export 'key_info.dart';
+export 'kv_page.dart';
+export 'mac_algorithm.dart';
+export 'manifest_verification.dart';
+export 'resource_sample_batch.dart';
+export 'scheduler_stats.dart';
+export 'signature_verification.dart';
+export 'startup_timeline.dart';
@@ -0,0 +1,116 @@
+import 'dart:typed_data';
+
+/// A batch of system resource samples delivered by the native sampler.
+///
+/// Samples are stored column-wise: entry `i` of every list belongs to the same
+/// sample. Per-core CPU usage is flattened, so the usage of core `c` in sample
+/// `i` is `cpuPerCore[i * coreCount + c]` (see [cpuForCore]).
+class ResourceSampleBatch {
+  /// Sample timestamps in microseconds since the Unix epoch.
+  final Int64List timestampsUs;
+
+  /// Total CPU busy fraction in `[0, 1]`.
+  final Float32List cpuTotal;
+
+  /// Number of logical cores reported per sample.
+  final int coreCount;
+
+  /// Per-core CPU busy fractions, `coreCount` entries per sample.
+  final Float32List cpuPerCore;
+
+  /// Total physical memory in bytes.
+  final Int64List memoryTotalBytes;
+
+  /// Available physical memory in bytes.
+  final Int64List memoryAvailableBytes;
+
+  /// Disk read throughput in bytes per second.
+  final Float64List diskReadBytesPerSec;
+
+  /// Disk write throughput in bytes per second.
+  final Float64List diskWriteBytesPerSec;
+
+  /// Network receive throughput in bytes per second.
+  final Float64List netRxBytesPerSec;
+
+  /// Network transmit throughput in bytes per second.
+  final Float64List netTxBytesPerSec;
+
+  /// Samples dropped so far because the consumer fell behind.
+  final int dropped;
+
+  /// CPU time used by the native sampler thread, as a fraction of one core.
+  final double samplerCpuOverhead;
+
+  ResourceSampleBatch({
+    required this.timestampsUs,
+    required this.cpuTotal,
+    required this.coreCount,
+    required this.cpuPerCore,
+    required this.memoryTotalBytes,
+    required this.memoryAvailableBytes,
+    required this.diskReadBytesPerSec,
+    required this.diskWriteBytesPerSec,
+    required this.netRxBytesPerSec,
+    required this.netTxBytesPerSec,
+    required this.dropped,
+    required this.samplerCpuOverhead,
+  });
+
+  /// Number of samples in this batch.
+  int get length => timestampsUs.length;
+
+  /// CPU busy fraction of [core] in sample [index].
+  double cpuForCore(int index, int core) => cpuPerCore[index * coreCount + core];
+
+  factory ResourceSampleBatch.fromMap(Map<dynamic, dynamic> map) {
+    return ResourceSampleBatch(
+      timestampsUs: map['timestampsUs'] as Int64List,
+      cpuTotal: map['cpuTotal'] as Float32List,
+      coreCount: map['coreCount'] as int,
+      cpuPerCore: map['cpuPerCore'] as Float32List,
+      memoryTotalBytes: map['memoryTotalBytes'] as Int64List,
+      memoryAvailableBytes: map['memoryAvailableBytes'] as Int64List,
+      diskReadBytesPerSec: map['diskReadBytesPerSec'] as Float64List,
+      diskWriteBytesPerSec: map['diskWriteBytesPerSec'] as Float64List,
+      netRxBytesPerSec: map['netRxBytesPerSec'] as Float64List,
+      netTxBytesPerSec: map['netTxBytesPerSec'] as Float64List,
+      dropped: map['dropped'] as int,
+      samplerCpuOverhead: map['samplerCpuOverhead'] as double,
+    );
+  }
+
+  @override
+  String toString() =>
+      'ResourceSampleBatch(length: $length, coreCount: $coreCount, dropped: $dropped, samplerCpuOverhead: $samplerCpuOverhead)';
+}
+
+/// Counters reported by the native sampler when it stops.
+class ResourceSamplerStats {
+  /// Samples produced since the sampler was started.
+  final int samples;
+
+  /// Samples dropped because the consumer fell behind.
+  final int dropped;
+
+  /// CPU time used by the native sampler thread, as a fraction of one core.
+  final double cpuOverhead;
+
+  ResourceSamplerStats({
+    required this.samples,
+    required this.dropped,
+    required this.cpuOverhead,
+  });
+
+  factory ResourceSamplerStats.fromMap(Map<dynamic, dynamic> map) {
+    return ResourceSamplerStats(
+      samples: map['samples'] as int,
+      dropped: map['dropped'] as int,
+      cpuOverhead: (map['cpuOverhead'] as num).toDouble(),
+    );
+  }
+
+  @override
+  String toString() =>
+      'ResourceSamplerStats(samples: $samples, dropped: $dropped, cpuOverhead: $cpuOverhead)';
+}
@@ -0,0 +1,62 @@
+/// Scheduling class of native method work. Classes share the native worker
+/// threads by weight, so interactive calls are not held up by bulk ones.
+enum MethodPriority {
+  /// Latency-critical calls such as `signNonce`.
+  interactive,
+  normal,
+
+  /// Throughput work such as hashing, certificate export and hardware
+  /// queries.
+  bulk,
+}
+
+/// Queue-wait metrics of one [MethodPriority] class, returned by
+/// `getSchedulerStats`. Counts run from when the native workers started.
+class SchedulerClassStats {
+  final MethodPriority priority;
+
+  /// Tasks waiting for a worker, and tasks running now.
+  final int queued;
+  final int running;
+  final int started;
+
+  /// Tasks started ahead of their turn because the class was starved.
+  final int promoted;
+
+  final Duration totalWait;
+  final Duration maxWait;
+
+  /// Approximate: upper bounds of the power-of-two bucket holding the
+  /// percentile.
+  final Duration p50Wait;
+  final Duration p99Wait;
+
+  SchedulerClassStats({
+    required this.priority,
+    required this.queued,
+    required this.running,
+    required this.started,
+    required this.promoted,
+    required this.totalWait,
+    required this.maxWait,
+    required this.p50Wait,
+    required this.p99Wait,
+  });
+
+  factory SchedulerClassStats.fromMap(Map<dynamic, dynamic> map) {
+    return SchedulerClassStats(
+      priority: MethodPriority.values.byName(map['priority'] as String),
+      queued: map['queued'] as int,
+      running: map['running'] as int,
+      started: map['started'] as int,
+      promoted: map['promoted'] as int,
+      totalWait: Duration(microseconds: map['totalWaitUs'] as int),
+      maxWait: Duration(microseconds: map['maxWaitUs'] as int),
+      p50Wait: Duration(microseconds: map['p50WaitUs'] as int),
+      p99Wait: Duration(microseconds: map['p99WaitUs'] as int),
+    );
+  }
+
+  @override
+  String toString() => 'SchedulerClassStats(${priority.name}, queued: $queued, running: $running, started: $started, promoted: $promoted, p50: ${p50Wait.inMicroseconds} us, p99: ${p99Wait.inMicroseconds} us, max: ${maxWait.inMicroseconds} us)';
+}
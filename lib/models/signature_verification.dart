@@ -0,0 +1,53 @@
+import 'dart:typed_data';
+
+/// One message to verify with `verifySignatures`.
+class SignatureCheck {
+  final Uint8List message;
+
+  /// RSASSA-PKCS1-v1_5 / SHA-256 signature over [message], as produced by
+  /// `signNonce`.
+  final Uint8List signature;
+
+  /// Id the signer's key was registered under with `importPublicKey`.
+  final String keyId;
+
+  SignatureCheck({
+    required this.message,
+    required this.signature,
+    required this.keyId,
+  });
+}
+
+/// Per-check results of `verifySignatures`, packed one bit per check.
+class SignatureBitmap {
+  /// Bit `i % 8` of byte `i ~/ 8` is set if check `i` verified.
+  final Uint8List bytes;
+
+  /// Number of checks in the batch.
+  final int length;
+
+  SignatureBitmap(this.bytes, this.length);
+
+  /// Whether check [index] verified.
+  bool operator [](int index) {
+    RangeError.checkValidIndex(index, this, 'index', length);
+    return (bytes[index >> 3] >> (index & 7)) & 1 == 1;
+  }
+
+  /// `true` if every check verified.
+  bool get allValid {
+    for (var i = 0; i < length; i++) {
+      if (!this[i]) return false;
+    }
+    return true;
+  }
+
+  /// Indices of the checks that failed, in order.
+  List<int> get failedIndices => [
+        for (var i = 0; i < length; i++)
+          if (!this[i]) i,
+      ];
+
+  @override
+  String toString() => 'SignatureBitmap(length: $length, failed: $failedIndices)';
+}
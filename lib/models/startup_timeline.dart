@@ -0,0 +1,68 @@
+/// Native backends that are created on first use and can be warmed up ahead
+/// of it with `prewarm`.
+enum NativeBackend {
+  workers,
+  fileHasher,
+  manifestVerifier,
+  resourceSampler,
+  certificateChains,
+  certificateSigner,
+
+  /// The index of the personal ("MY") certificate store.
+  certificateIndex,
+
+  /// The index of the key store `listKeys` reads, enumerated when warmed.
+  keyIndex,
+
+  /// The thread that runs WMI queries such as `requestHardwareInfo`, joined
+  /// to COM and connected to WMI.
+  wmi,
+}
+
+/// Why a [StartupEvent] was recorded.
+enum StartupPhase {
+  /// Plugin registration, on the app's startup critical path.
+  registration,
+
+  /// Created by the first call that needed it.
+  firstUse,
+
+  /// Created ahead of use by `prewarm`.
+  prewarm,
+}
+
+/// One entry of the native startup timeline returned by `getStartupTimeline`.
+class StartupEvent {
+  /// `plugin` for registration, otherwise the backend, e.g. `workers` or
+  /// `certificateIndex/MY`.
+  final String backend;
+  final StartupPhase phase;
+
+  /// Offset from the start of plugin registration.
+  final Duration start;
+  final Duration duration;
+
+  /// Why initialisation failed, or `null` if it succeeded.
+  final String? error;
+
+  StartupEvent({
+    required this.backend,
+    required this.phase,
+    required this.start,
+    required this.duration,
+    this.error,
+  });
+
+  factory StartupEvent.fromMap(Map<dynamic, dynamic> map) {
+    return StartupEvent(
+      backend: map['backend'] as String,
+      phase: StartupPhase.values.byName(map['phase'] as String),
+      start: Duration(microseconds: map['startUs'] as int),
+      duration: Duration(microseconds: map['durationUs'] as int),
+      error: map['error'] as String?,
+    );
+  }
+
+  @override
+  String toString() => 'StartupEvent($backend, ${phase.name}, start: ${start.inMicroseconds} us, duration: ${duration.inMicroseconds} us${error == null ? '' : ', error: $error'})';
+}
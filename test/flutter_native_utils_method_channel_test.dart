@@ -1,3 +1,5 @@
+import 'dart:typed_data';
+
 import 'package:flutter/services.dart';
 import 'package:flutter_native_utils/flutter_native_utils_method_channel.dart';
 import 'package:flutter_native_utils/models/models.dart';
@@ -246,6 +248,24 @@ void main() {
       expect(() => sut.signNonce(mockNonce, keyName), throwsException);
     });
 
+    test('should keep the REPLAYED_NONCE code', () async {
+      // Arrange
+      final mockNonce = Uint8List.fromList([10, 20, 30]);
+
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(
+        methodChannel,
+        (MethodCall methodCall) async {
+          throw PlatformException(code: 'REPLAYED_NONCE', message: 'nonce was already signed within the replay window');
+        },
+      );
+
+      // Act & Assert
+      expect(
+        () => sut.signNonce(mockNonce, keyName),
+        throwsA(isA<PlatformException>().having((e) => e.code, 'code', 'REPLAYED_NONCE')),
+      );
+    });
+
     test('should throw Exception when MissingPluginException is thrown', () async {
       // Arrange
       final mockNonce = Uint8List.fromList([10, 20, 30]);
@@ -261,4 +281,1009 @@ void main() {
       expect(() => sut.signNonce(mockNonce, keyName), throwsException);
     });
   });
+
+  group('resourceSampler', () {
+    test('startResourceSampler should pass rate and batch size', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'StartResourceSampler');
+        expect(methodCall.arguments, {'rateHz': 100, 'batchSize': 20});
+        return null;
+      });
+
+      // Act & Assert
+      await sut.startResourceSampler(rateHz: 100, batchSize: 20);
+    });
+
+    test('startResourceSampler should rethrow PlatformException with code', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        throw PlatformException(code: 'BAD_ARGS', message: 'rateHz must be between 10 and 1000');
+      });
+
+      // Act & Assert
+      expect(
+        () => sut.startResourceSampler(rateHz: 5),
+        throwsA(isA<PlatformException>().having((e) => e.code, 'code', 'BAD_ARGS')),
+      );
+    });
+
+    test('stopResourceSampler should return stats', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'StopResourceSampler');
+        return {'samples': 500, 'dropped': 2, 'cpuOverhead': 0.004};
+      });
+
+      // Act
+      final stats = await sut.stopResourceSampler();
+
+      // Assert
+      expect(stats.samples, 500);
+      expect(stats.dropped, 2);
+      expect(stats.cpuOverhead, closeTo(0.004, 1e-9));
+    });
+  });
+
+  group('requestCpuTopology', () {
+    test('should return CpuTopology when native call succeeds', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'RequestCpuTopology');
+        return {
+          'packages': 1,
+          'physicalCores': 3,
+          'logicalProcessors': 4,
+          'performanceCores': 1,
+          'efficiencyCores': 2,
+          'cores': [
+            {'logicalProcessors': [0, 1], 'type': 'performance', 'efficiencyClass': 1},
+            {'logicalProcessors': [2], 'type': 'efficiency', 'efficiencyClass': 0},
+            {'logicalProcessors': [3], 'type': 'efficiency', 'efficiencyClass': 0},
+          ],
+          'caches': [
+            {'level': 1, 'type': 'data', 'sizeBytes': 49152, 'lineSize': 64, 'instances': 1, 'sharedBy': 2},
+          ],
+          'numaNodes': [
+            {'node': 0, 'logicalProcessors': [0, 1, 2, 3]},
+          ],
+          'simdFeatures': ['sse4.2', 'avx2'],
+        };
+      });
+
+      // Act
+      final topology = await sut.requestCpuTopology();
+
+      // Assert
+      expect(topology.physicalCores, 3);
+      expect(topology.efficiencyCores, 2);
+      expect(topology.cores[1].type, CpuCoreType.efficiency);
+      expect(topology.cacheLineSize, 64);
+      expect(topology.numaNodes.single.logicalProcessors, [0, 1, 2, 3]);
+      expect(topology.simdFeatures, contains('avx2'));
+    });
+
+    test('should throw Exception when MissingPluginException is thrown', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        throw MissingPluginException();
+      });
+
+      // Act & Assert
+      expect(() => sut.requestCpuTopology(), throwsA(isA<MissingPluginException>()));
+    });
+  });
+
+  group('configureNonceReplayWindow', () {
+    test('should pass the window and capacity', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'ConfigureNonceReplayWindow');
+        expect(methodCall.arguments, {'windowMs': 300000, 'capacity': 10000});
+        return 53312;
+      });
+
+      // Act
+      final memoryBytes = await sut.configureNonceReplayWindow(const Duration(minutes: 5), capacity: 10000);
+
+      // Assert
+      expect(memoryBytes, 53312);
+    });
+
+    test('should turn the check off with a zero window', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.arguments, {'windowMs': 0});
+        return 0;
+      });
+
+      // Act & Assert
+      expect(await sut.configureNonceReplayWindow(Duration.zero), 0);
+    });
+  });
+
+  group('getDeviceFingerprint', () {
+    test('should pass the reference and parse the components', () async {
+      // Arrange
+      final salt = Uint8List.fromList(List.filled(16, 7));
+      final uuidHash = Uint8List.fromList(List.filled(32, 1));
+      final diskHash = Uint8List.fromList(List.filled(32, 2));
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'GetDeviceFingerprint');
+        expect(methodCall.arguments, {
+          'salt': salt,
+          'identifiers': ['systemUuid', 'boardSerial', 'diskSerial'],
+          'reference': {'systemUuid': uuidHash, 'diskSerial': diskHash},
+        });
+        return {
+          'digest': Uint8List.fromList(List.filled(32, 9)),
+          'components': {'boardSerial': null, 'diskSerial': Uint8List.fromList(List.filled(32, 3)), 'systemUuid': uuidHash},
+          'matchingComponents': 1,
+          'matches': true,
+        };
+      });
+
+      // Act
+      final fingerprint = await sut.getDeviceFingerprint(
+        salt: salt,
+        identifiers: ['systemUuid', 'boardSerial', 'diskSerial'],
+        reference: {'systemUuid': uuidHash, 'diskSerial': diskHash},
+      );
+
+      // Assert
+      expect(fingerprint.digest, hasLength(32));
+      expect(fingerprint.components, hasLength(3));
+      expect(fingerprint.components['boardSerial'], isNull);
+      expect(fingerprint.presentComponents.keys, ['diskSerial', 'systemUuid']);
+      expect(fingerprint.matchingComponents, 1);
+      expect(fingerprint.matches, isTrue);
+    });
+
+    test('should leave the match unset without a reference', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.arguments, {'salt': Uint8List(16)});
+        return {
+          'digest': Uint8List(32),
+          'components': {'machineId': Uint8List(32)},
+        };
+      });
+
+      // Act
+      final fingerprint = await sut.getDeviceFingerprint(salt: Uint8List(16));
+
+      // Assert
+      expect(fingerprint.matchingComponents, isNull);
+      expect(fingerprint.matches, isNull);
+    });
+
+    test('should keep the BAD_ARGS code of a short salt', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        throw PlatformException(code: 'BAD_ARGS', message: 'salt must be at least 16 bytes');
+      });
+
+      // Act & Assert
+      expect(
+        () => sut.getDeviceFingerprint(salt: Uint8List(8)),
+        throwsA(isA<PlatformException>().having((e) => e.code, 'code', 'BAD_ARGS')),
+      );
+    });
+  });
+
+  group('hashFiles', () {
+    test('should return results in input order', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'HashFiles');
+        expect(methodCall.arguments, {
+          'paths': ['a.bin', 'missing.bin'],
+          'algorithm': 'blake3',
+          'jobId': 7,
+        });
+        return [
+          {'path': 'a.bin', 'size': 3, 'digest': Uint8List.fromList([0xab, 0x01])},
+          {'path': 'missing.bin', 'size': 0, 'error': 'Failed to open file'},
+        ];
+      });
+
+      // Act
+      final results = await sut.hashFiles(['a.bin', 'missing.bin'], algorithm: HashAlgorithm.blake3, jobId: 7);
+
+      // Assert
+      expect(results[0].hexDigest, 'ab01');
+      expect(results[0].error, isNull);
+      expect(results[1].digest, isNull);
+      expect(results[1].error, 'Failed to open file');
+    });
+
+    test('should rethrow PlatformException with code', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        throw PlatformException(code: 'BAD_ARGS', message: 'Missing paths parameter');
+      });
+
+      // Act & Assert
+      expect(
+        () => sut.hashFiles([]),
+        throwsA(isA<PlatformException>().having((e) => e.code, 'code', 'BAD_ARGS')),
+      );
+    });
+  });
+
+  group('verifyManifest', () {
+    test('should return verification result with failures', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'VerifyManifest');
+        expect(methodCall.arguments['cachePath'], 'verify.cache');
+        expect(methodCall.arguments.containsKey('root'), isFalse);
+        return {
+          'valid': false,
+          'signatureValid': true,
+          'filesChecked': 3,
+          'filesRehashed': 1,
+          'elapsedUs': 1500,
+          'failures': [
+            {'path': 'app.bin', 'reason': 'digestMismatch', 'detail': 'expected aa, found bb'},
+          ],
+        };
+      });
+
+      // Act
+      final result = await sut.verifyManifest(
+        manifest: Uint8List.fromList([1]),
+        signature: Uint8List.fromList([2]),
+        publicKey: Uint8List.fromList([3]),
+        cachePath: 'verify.cache',
+      );
+
+      // Assert
+      expect(result.valid, isFalse);
+      expect(result.filesRehashed, 1);
+      expect(result.elapsed, const Duration(microseconds: 1500));
+      expect(result.failures.single.reason, ManifestFailureReason.digestMismatch);
+    });
+
+    test('should rethrow PlatformException with code', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        throw PlatformException(code: 'BAD_ARGS', message: 'Unsupported manifest header');
+      });
+
+      // Act & Assert
+      expect(
+        () => sut.verifyManifest(manifest: Uint8List(0), signature: Uint8List(0), publicKey: Uint8List(0)),
+        throwsA(isA<PlatformException>().having((e) => e.code, 'code', 'BAD_ARGS')),
+      );
+    });
+  });
+
+  group('encrypt', () {
+    test('should pass optional arguments only when set', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'Encrypt');
+        expect(methodCall.arguments['keyName'], 'key');
+        expect(methodCall.arguments['chunkSize'], 4096);
+        expect(methodCall.arguments.containsKey('aad'), isFalse);
+        return Uint8List.fromList([9, 9]);
+      });
+
+      // Act
+      final result = await sut.encrypt(Uint8List.fromList([1]), keyName: 'key', wrappedKey: Uint8List.fromList([2]), chunkSize: 4096);
+
+      // Assert
+      expect(result, [9, 9]);
+    });
+  });
+
+  group('decrypt', () {
+    test('should rethrow authentication failure with code', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        throw PlatformException(code: 'FAILURE', message: 'Ciphertext failed authentication');
+      });
+
+      // Act & Assert
+      expect(
+        () => sut.decrypt(Uint8List(0), keyName: 'key', wrappedKey: Uint8List(0)),
+        throwsA(isA<PlatformException>().having((e) => e.code, 'code', 'FAILURE')),
+      );
+    });
+  });
+
+  group('cipher sessions', () {
+    test('should start, update and finish a session', () async {
+      // Arrange
+      final calls = <String>[];
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        calls.add(methodCall.method);
+        switch (methodCall.method) {
+          case 'StartCipherSession':
+            expect(methodCall.arguments['mode'], 'decrypt');
+            return 7;
+          case 'UpdateCipherSession':
+            expect(methodCall.arguments['sessionId'], 7);
+            return Uint8List.fromList([1]);
+          default:
+            expect(methodCall.arguments.containsKey('data'), isFalse);
+            return Uint8List.fromList([2]);
+        }
+      });
+
+      // Act
+      final id = await sut.startCipherSession(encrypt: false, keyName: 'key', wrappedKey: Uint8List(1));
+      final first = await sut.updateCipherSession(id, Uint8List(3));
+      final last = await sut.finishCipherSession(id);
+
+      // Assert
+      expect(id, 7);
+      expect(first, [1]);
+      expect(last, [2]);
+      expect(calls, ['StartCipherSession', 'UpdateCipherSession', 'FinishCipherSession']);
+    });
+  });
+
+  group('hmac sessions', () {
+    test('should create a session and verify a batch', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        switch (methodCall.method) {
+          case 'CreateHmacSession':
+            expect(methodCall.arguments['algorithm'], 'sha512');
+            expect(methodCall.arguments.containsKey('keyName'), isFalse);
+            return 3;
+          case 'VerifyHmacs':
+            expect(methodCall.arguments['sessionId'], 3);
+            expect(methodCall.arguments['macs'], hasLength(2));
+            return [true, false];
+        }
+        return null;
+      });
+
+      // Act
+      final session = await sut.createHmacSession(algorithm: MacAlgorithm.sha512, key: Uint8List(32));
+      final valid = await sut.verifyHmacs(session, [Uint8List(1), Uint8List(2)], [Uint8List(64), Uint8List(64)]);
+
+      // Assert
+      expect(session, 3);
+      expect(valid, [true, false]);
+    });
+
+    test('should return MACs as byte arrays', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        return [Uint8List.fromList([1, 2])];
+      });
+
+      // Act
+      final macs = await sut.computeHmacs(1, [Uint8List(0)]);
+
+      // Assert
+      expect(macs.single, [1, 2]);
+    });
+  });
+
+  group('verifySignatures', () {
+    test('should send parallel lists and unpack the bitmap', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'VerifySignatures');
+        expect(methodCall.arguments['keyIds'], ['a', 'b', 'a']);
+        expect(methodCall.arguments['signatures'], hasLength(3));
+        return Uint8List.fromList([0x05]);
+      });
+
+      // Act
+      final result = await sut.verifySignatures([
+        for (final keyId in ['a', 'b', 'a'])
+          SignatureCheck(message: Uint8List(1), signature: Uint8List(2), keyId: keyId),
+      ]);
+
+      // Assert
+      expect(result[0], isTrue);
+      expect(result[1], isFalse);
+      expect(result[2], isTrue);
+      expect(result.allValid, isFalse);
+      expect(result.failedIndices, [1]);
+    });
+
+    test('should rethrow malformed key errors from importPublicKey', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        throw PlatformException(code: 'BAD_ARGS', message: 'Malformed RSA public key blob');
+      });
+
+      // Act & Assert
+      expect(
+        () => sut.importPublicKey('a', Uint8List(3)),
+        throwsA(isA<PlatformException>().having((e) => e.code, 'code', 'BAD_ARGS')),
+      );
+    });
+  });
+
+  group('getRandomBytes', () {
+    test('should return the platform bytes', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'GetRandomBytes');
+        expect(methodCall.arguments['length'], 4);
+        return Uint8List.fromList([1, 2, 3, 4]);
+      });
+
+      // Act
+      final result = await sut.getRandomBytes(4);
+
+      // Assert
+      expect(result, [1, 2, 3, 4]);
+    });
+  });
+
+  group('enumerateCertificates', () {
+    test('should send the filter and parse the page', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'EnumerateCertificates');
+        expect(methodCall.arguments['eku'], 'clientAuth');
+        expect(methodCall.arguments['hasPrivateKey'], true);
+        expect(methodCall.arguments['validFrom'], 1735689600000);
+        expect(methodCall.arguments['storeName'], 'MY');
+        expect(methodCall.arguments.containsKey('subjectContains'), isFalse);
+        return {
+          'certificates': [
+            {
+              'thumbprint': 'D9C75C3F5FAA9B01E310E9F8337DBF9046037AE2',
+              'subject': 'CN=Alice Client, O=Example Corp, C=US',
+              'issuer': 'CN=Example Issuing CA, O=Example Corp, C=US',
+              'serialNumber': '1002',
+              'notBefore': 1704067200000,
+              'notAfter': 2019686400000,
+              'ekus': ['1.3.6.1.5.5.7.3.2'],
+              'hasPrivateKey': true,
+              'storeLocation': 'currentUser',
+            },
+          ],
+          'nextPageToken': '1.42',
+        };
+      });
+
+      // Act
+      final page = await sut.enumerateCertificates(
+        filter: CertificateFilter(eku: 'clientAuth', hasPrivateKey: true, validFrom: DateTime.utc(2025)),
+      );
+
+      // Assert
+      expect(page.hasMore, isTrue);
+      expect(page.nextPageToken, '1.42');
+      final cert = page.certificates.single;
+      expect(cert.subject, startsWith('CN=Alice Client'));
+      expect(cert.notBefore, DateTime.utc(2024));
+      expect(cert.storeLocation, CertificateStoreLocation.currentUser);
+      expect(cert.isValidAt(DateTime.utc(2025)), isTrue);
+    });
+
+    test('should rethrow an expired page token', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.arguments['pageToken'], '1.42');
+        throw PlatformException(code: 'BAD_ARGS', message: 'pageToken has expired; restart the enumeration');
+      });
+
+      // Act & Assert
+      expect(
+        () => sut.enumerateCertificates(pageToken: '1.42'),
+        throwsA(isA<PlatformException>().having((e) => e.code, 'code', 'BAD_ARGS')),
+      );
+    });
+  });
+
+  group('getCertificateChain', () {
+    test('should return the DER chain leaf first', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'GetCertificateChain');
+        expect(methodCall.arguments['thumbprint'], 'ABCD');
+        expect(methodCall.arguments['checkRevocation'], false);
+        return {
+          'certificates': [
+            Uint8List.fromList([1]),
+            Uint8List.fromList([2]),
+          ],
+          'trusted': false,
+          'status': 'untrusted root',
+        };
+      });
+
+      // Act
+      final chain = await sut.getCertificateChain('ABCD');
+
+      // Assert
+      expect(chain.leaf, [1]);
+      expect(chain.certificates, hasLength(2));
+      expect(chain.trusted, isFalse);
+      expect(chain.status, 'untrusted root');
+    });
+
+    test('should rethrow a missing certificate', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        throw PlatformException(code: 'FAILURE', message: 'Certificate not found.');
+      });
+
+      // Act & Assert
+      expect(
+        () => sut.getCertificateChain('ABCD', checkRevocation: true),
+        throwsA(isA<PlatformException>().having((e) => e.code, 'code', 'FAILURE')),
+      );
+    });
+  });
+
+  group('signWithCertificate', () {
+    test('should pass the data, hash and padding', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'SignWithCertificate');
+        expect(methodCall.arguments['thumbprint'], 'ABCD');
+        expect(methodCall.arguments['data'], [1, 2, 3]);
+        expect(methodCall.arguments.containsKey('digest'), isFalse);
+        expect(methodCall.arguments['hash'], 'sha384');
+        expect(methodCall.arguments['padding'], 'pss');
+        return Uint8List.fromList([9, 9]);
+      });
+
+      // Act
+      final signature = await sut.signWithCertificate(
+        thumbprint: 'ABCD',
+        data: Uint8List.fromList([1, 2, 3]),
+        hash: SignatureHash.sha384,
+        padding: SignaturePadding.pss,
+      );
+
+      // Assert
+      expect(signature, [9, 9]);
+    });
+
+    test('should rethrow a missing key', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.arguments['digest'], hasLength(32));
+        throw PlatformException(code: 'FAILURE', message: 'Certificate or private key not found.');
+      });
+
+      // Act & Assert
+      expect(
+        () => sut.signWithCertificate(thumbprint: 'ABCD', digest: Uint8List(32)),
+        throwsA(isA<PlatformException>().having((e) => e.code, 'code', 'FAILURE')),
+      );
+    });
+  });
+
+  group('prewarm', () {
+    test('should pass the backend names', () async {
+      // Arrange
+      Object? arguments;
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'Prewarm');
+        arguments = methodCall.arguments;
+        return null;
+      });
+
+      // Act
+      await sut.prewarm(backends: [NativeBackend.certificateIndex, NativeBackend.workers]);
+
+      // Assert
+      expect(arguments, {
+        'backends': ['certificateIndex', 'workers'],
+      });
+    });
+
+    test('should warm every backend by default', () async {
+      // Arrange
+      Object? arguments;
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        arguments = methodCall.arguments;
+        return null;
+      });
+
+      // Act
+      await sut.prewarm();
+
+      // Assert
+      expect(arguments, isEmpty);
+    });
+  });
+
+  group('getStartupTimeline', () {
+    test('should parse the events', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'GetStartupTimeline');
+        return [
+          {'backend': 'plugin', 'phase': 'registration', 'startUs': 0, 'durationUs': 42, 'error': null},
+          {'backend': 'certificateIndex/MY', 'phase': 'prewarm', 'startUs': 900000, 'durationUs': 15000, 'error': 'Access denied'},
+        ];
+      });
+
+      // Act
+      final events = await sut.getStartupTimeline();
+
+      // Assert
+      expect(events, hasLength(2));
+      expect(events[0].phase, StartupPhase.registration);
+      expect(events[0].duration, const Duration(microseconds: 42));
+      expect(events[0].error, isNull);
+      expect(events[1].backend, 'certificateIndex/MY');
+      expect(events[1].start, const Duration(milliseconds: 900));
+      expect(events[1].error, 'Access denied');
+    });
+  });
+
+  group('getSchedulerStats', () {
+    test('should parse each class', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'GetSchedulerStats');
+        return [
+          {'priority': 'interactive', 'queued': 0, 'running': 1, 'started': 40, 'promoted': 0, 'totalWaitUs': 800, 'maxWaitUs': 90, 'p50WaitUs': 15, 'p99WaitUs': 63},
+          {'priority': 'bulk', 'queued': 120, 'running': 3, 'started': 900, 'promoted': 2, 'totalWaitUs': 9000000, 'maxWaitUs': 250000, 'p50WaitUs': 8191, 'p99WaitUs': 131071},
+        ];
+      });
+
+      // Act
+      final stats = await sut.getSchedulerStats();
+
+      // Assert
+      expect(stats, hasLength(2));
+      expect(stats[0].priority, MethodPriority.interactive);
+      expect(stats[0].p99Wait, const Duration(microseconds: 63));
+      expect(stats[1].priority, MethodPriority.bulk);
+      expect(stats[1].queued, 120);
+      expect(stats[1].promoted, 2);
+      expect(stats[1].maxWait, const Duration(milliseconds: 250));
+    });
+  });
+
+  group('getAllocationStats', () {
+    test('should pass reset and parse each method', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'GetAllocationStats');
+        expect(methodCall.arguments, {'reset': true});
+        return [
+          {'method': 'ComputeHmacs', 'calls': 4, 'allocations': 104, 'bytes': 24816, 'peakBytes': 6184},
+          {'method': 'GetRandomBytes', 'calls': 10, 'allocations': 60, 'bytes': 1550, 'peakBytes': 148},
+        ];
+      });
+
+      // Act
+      final stats = await sut.getAllocationStats(reset: true);
+
+      // Assert
+      expect(stats, hasLength(2));
+      expect(stats[0].method, 'ComputeHmacs');
+      expect(stats[0].allocationsPerCall, 26);
+      expect(stats[0].peakBytes, 6184);
+      expect(stats[1].calls, 10);
+      expect(stats[1].bytes, 1550);
+    });
+
+    test('should keep the UNAVAILABLE code of builds without counting', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        throw PlatformException(code: 'UNAVAILABLE', message: 'Built without FLUTTER_NATIVE_UTILS_ALLOCATION_STATS');
+      });
+
+      // Act & Assert
+      expect(
+        () => sut.getAllocationStats(),
+        throwsA(isA<PlatformException>().having((e) => e.code, 'code', 'UNAVAILABLE')),
+      );
+    });
+  });
+
+  group('queryInventory', () {
+    test('should page through the rows', () async {
+      // Arrange
+      final calls = <MethodCall>[];
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        calls.add(methodCall);
+        if (methodCall.method == 'QueryInventory') {
+          return {
+            'cursor': 7,
+            'rows': [
+              ['Samsung SSD', 500107862016],
+              ['WDC WD10EZEX', 1000204886016],
+            ],
+            'done': false,
+          };
+        }
+        return {
+          'cursor': 7,
+          'rows': [
+            ['USB Flash', null],
+          ],
+          'done': true,
+        };
+      });
+
+      // Act
+      final rows = await sut.queryInventory(
+        'Win32_DiskDrive',
+        columns: ['Model', 'Size'],
+        filter: [const InventoryCondition('Size', InventoryOperator.greater, 0)],
+        pageSize: 2,
+      ).toList();
+
+      // Assert
+      expect(rows, hasLength(3));
+      expect(rows[1]['Model'], 'WDC WD10EZEX');
+      expect(rows[1]['Size'], 1000204886016);
+      expect(rows[2]['Size'], isNull);
+      expect(calls.map((call) => call.method), ['QueryInventory', 'NextInventoryPage']);
+      expect(calls[0].arguments['class'], 'Win32_DiskDrive');
+      expect(calls[0].arguments['filter'], [
+        {'column': 'Size', 'op': 'greater', 'value': 0},
+      ]);
+      expect(calls[0].arguments['pageSize'], 2);
+      expect(calls[1].arguments, {'cursor': 7});
+    });
+
+    test('should close the native query when cancelled', () async {
+      // Arrange
+      final calls = <MethodCall>[];
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        calls.add(methodCall);
+        if (methodCall.method == 'CloseInventoryQuery') return true;
+        return {
+          'cursor': 3,
+          'rows': [
+            ['explorer.exe'],
+            ['svchost.exe'],
+          ],
+          'done': false,
+        };
+      });
+
+      // Act
+      final first = await sut.queryInventory('Win32_Process', columns: ['Name']).first;
+
+      // Assert
+      expect(first['Name'], 'explorer.exe');
+      expect(calls.map((call) => call.method), ['QueryInventory', 'CloseInventoryQuery']);
+      expect(calls[1].arguments, {'cursor': 3});
+    });
+
+    test('should throw a PlatformException for bad arguments', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        throw PlatformException(code: 'BAD_ARGS', message: 'Invalid class name');
+      });
+
+      // Act & Assert
+      expect(
+        () => sut.queryInventory('Win32_Process WHERE 1=1', columns: ['Name']).toList(),
+        throwsA(isA<PlatformException>().having((e) => e.code, 'code', 'BAD_ARGS')),
+      );
+    });
+  });
+
+  group('listKeys', () {
+    test('should send the page request and parse keys with and without details', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'ListKeys');
+        expect(methodCall.arguments, {'prefix': 'app.', 'pageSize': 2, 'pageToken': 'app.a'});
+        return {
+          'keys': [
+            {
+              'name': 'app.b',
+              'algorithm': 'RSA',
+              'lengthBits': 2048,
+              'created': 1735689600000,
+              'usages': ['decrypt', 'sign'],
+            },
+            {'name': 'app.c', 'algorithm': 'RSA', 'lengthBits': null, 'created': null, 'usages': null},
+          ],
+          'nextPageToken': 'app.c',
+        };
+      });
+
+      // Act
+      final page = await sut.listKeys(prefix: 'app.', pageSize: 2, pageToken: 'app.a');
+
+      // Assert
+      expect(page.hasMore, isTrue);
+      expect(page.nextPageToken, 'app.c');
+      expect(page.keys.first.hasDetails, isTrue);
+      expect(page.keys.first.created, DateTime.utc(2025));
+      expect(page.keys.first.usages, ['decrypt', 'sign']);
+      expect(page.keys.last.hasDetails, isFalse);
+      expect(page.keys.last.usages, isNull);
+    });
+  });
+
+  group('getKeyInfo', () {
+    test('should return null for a missing key', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'GetKeyInfo');
+        expect(methodCall.arguments, {'keyName': 'missing'});
+        return null;
+      });
+
+      // Act
+      final info = await sut.getKeyInfo('missing');
+
+      // Assert
+      expect(info, isNull);
+    });
+  });
+
+  group('deleteKey', () {
+    test('should report whether the key existed', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'DeleteKey');
+        expect(methodCall.arguments, {'keyName': 'device'});
+        return true;
+      });
+
+      // Act
+      final deleted = await sut.deleteKey('device');
+
+      // Assert
+      expect(deleted, isTrue);
+    });
+
+    test('should throw a PlatformException for a missing key name', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        throw PlatformException(code: 'BAD_ARGS', message: 'Missing keyName');
+      });
+
+      // Act & Assert
+      expect(
+        () => sut.deleteKey(''),
+        throwsA(isA<PlatformException>().having((e) => e.code, 'code', 'BAD_ARGS')),
+      );
+    });
+  });
+
+  group('openKvStore', () {
+    test('should return the store handle', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'OpenKvStore');
+        expect(methodCall.arguments, {'directory': '/data/cache', 'keyName': 'cache'});
+        return 3;
+      });
+
+      // Act
+      final store = await sut.openKvStore('/data/cache', keyName: 'cache');
+
+      // Assert
+      expect(store, 3);
+    });
+
+    test('should throw a PlatformException when the key cannot unwrap the store', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        throw PlatformException(code: 'FAILURE', message: 'Cannot unwrap the data key');
+      });
+
+      // Act & Assert
+      expect(
+        () => sut.openKvStore('/data/cache', keyName: 'other'),
+        throwsA(isA<PlatformException>().having((e) => e.code, 'code', 'FAILURE')),
+      );
+    });
+  });
+
+  group('kvPut and kvGet', () {
+    test('should send one batch with deletions as null', () async {
+      // Arrange
+      final value = Uint8List.fromList([1, 2, 3]);
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'KvPut');
+        expect(methodCall.arguments, {
+          'store': 3,
+          'entries': {'token': value, 'stale': null},
+        });
+        return null;
+      });
+
+      // Act & Assert
+      await sut.kvPut(3, {'token': value, 'stale': null});
+    });
+
+    test('should return the value, or null for a missing key', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'KvGet');
+        return methodCall.arguments['key'] == 'token' ? Uint8List.fromList([7, 8]) : null;
+      });
+
+      // Act
+      final value = await sut.kvGet(3, 'token');
+      final missing = await sut.kvGet(3, 'missing');
+
+      // Assert
+      expect(value, Uint8List.fromList([7, 8]));
+      expect(missing, isNull);
+    });
+
+    test('should throw a PlatformException for a closed store', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        throw PlatformException(code: 'BAD_ARGS', message: 'Unknown or closed store');
+      });
+
+      // Act & Assert
+      expect(
+        () => sut.kvGet(9, 'token'),
+        throwsA(isA<PlatformException>().having((e) => e.code, 'code', 'BAD_ARGS')),
+      );
+    });
+  });
+
+  group('kvDelete', () {
+    test('should send the keys', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'KvDelete');
+        expect(methodCall.arguments, {
+          'store': 3,
+          'keys': ['a', 'b'],
+        });
+        return null;
+      });
+
+      // Act & Assert
+      await sut.kvDelete(3, ['a', 'b']);
+    });
+  });
+
+  group('kvScan', () {
+    test('should send the page request and parse its entries', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'KvScan');
+        expect(methodCall.arguments, {'store': 3, 'prefix': 'responses/', 'pageSize': 2, 'pageToken': 'responses/a'});
+        return {
+          'entries': [
+            {'key': 'responses/b', 'value': Uint8List.fromList([1])},
+            {'key': 'responses/c', 'value': Uint8List(0)},
+          ],
+          'nextPageToken': 'responses/c',
+        };
+      });
+
+      // Act
+      final page = await sut.kvScan(3, prefix: 'responses/', pageSize: 2, pageToken: 'responses/a');
+
+      // Assert
+      expect(page.hasMore, isTrue);
+      expect(page.entries.map((e) => e.key), ['responses/b', 'responses/c']);
+      expect(page.entries.first.value, [1]);
+      expect(page.entries.last.value, isEmpty);
+    });
+  });
+
+  group('closeKvStore', () {
+    test('should report whether the handle was open', () async {
+      // Arrange
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger.setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+        expect(methodCall.method, 'CloseKvStore');
+        expect(methodCall.arguments, {'store': 3});
+        return true;
+      });
+
+      // Act
+      final closed = await sut.closeKvStore(3);
+
+      // Assert
+      expect(closed, isTrue);
+    });
+  });
 }
@@ -0,0 +1,535 @@
+#include "aes_gcm.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <bcrypt.h>
+
+#pragma comment(lib, "bcrypt.lib")
+#else
+#include <openssl/evp.h>
+#endif
+
+#include <atomic>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <utility>
+
+#include "hmac.h"
+#include "secure_buffer.h"
+#include "secure_random.h"
+
+namespace flutter_native_utils {
+
+namespace {
+
+constexpr uint8_t kMagic[4] = {'F', 'G', 'C', '1'};
+constexpr size_t kSaltLen = 16;
+constexpr size_t kNoncePrefixLen = 7;
+constexpr char kKdfInfo[] = "flutter_native_utils aes-256-gcm chunked v1";
+
+// Bulk jobs hand roughly this much plaintext to each task.
+constexpr size_t kBytesPerTask = 1 << 20;
+
+void StoreLe32(uint8_t* p, uint32_t value) {
+  for (int i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+uint32_t LoadLe32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+         static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+void CheckChunkLen(size_t chunk_len) {
+  if (chunk_len == 0 || chunk_len > kAesGcmMaxChunkLen) {
+    throw std::invalid_argument("Chunk length must be between 1 and 16 MiB");
+  }
+}
+
+#ifdef _WIN32
+BCRYPT_ALG_HANDLE AesGcmProvider() {
+  static BCRYPT_ALG_HANDLE provider = [] {
+    BCRYPT_ALG_HANDLE handle = nullptr;
+    if (BCryptOpenAlgorithmProvider(&handle, BCRYPT_AES_ALGORITHM, nullptr,
+                                    0) != 0) {
+      return static_cast<BCRYPT_ALG_HANDLE>(nullptr);
+    }
+    if (BCryptSetProperty(handle, BCRYPT_CHAINING_MODE,
+                          reinterpret_cast<PUCHAR>(
+                              const_cast<wchar_t*>(BCRYPT_CHAIN_MODE_GCM)),
+                          sizeof(BCRYPT_CHAIN_MODE_GCM), 0) != 0) {
+      BCryptCloseAlgorithmProvider(handle, 0);
+      return static_cast<BCRYPT_ALG_HANDLE>(nullptr);
+    }
+    return handle;
+  }();
+  return provider;
+}
+
+void InitAuthInfo(BCRYPT_AUTHENTICATED_CIPHER_MODE_INFO* info,
+                  const uint8_t* nonce, const uint8_t* aad, size_t aad_len,
+                  uint8_t* tag) {
+  BCRYPT_INIT_AUTH_MODE_INFO(*info);
+  info->pbNonce = const_cast<PUCHAR>(nonce);
+  info->cbNonce = static_cast<ULONG>(kAesGcmNonceLen);
+  info->pbAuthData = const_cast<PUCHAR>(aad);
+  info->cbAuthData = static_cast<ULONG>(aad_len);
+  info->pbTag = tag;
+  info->cbTag = static_cast<ULONG>(kAesGcmTagLen);
+}
+#endif
+
+}  // namespace
+
+#ifdef _WIN32
+AesGcmCipher::AesGcmCipher(const AesGcmKey& key) {
+  BCRYPT_ALG_HANDLE provider = AesGcmProvider();
+  BCRYPT_KEY_HANDLE handle = nullptr;
+  if (!provider ||
+      BCryptGenerateSymmetricKey(provider, &handle, nullptr, 0,
+                                 const_cast<PUCHAR>(key.data()),
+                                 static_cast<ULONG>(key.size()), 0) != 0) {
+    throw std::runtime_error("BCryptGenerateSymmetricKey (AES-GCM) failed");
+  }
+  key_ = handle;
+}
+
+AesGcmCipher::~AesGcmCipher() {
+  BCryptDestroyKey(static_cast<BCRYPT_KEY_HANDLE>(key_));
+}
+
+void AesGcmCipher::Seal(const uint8_t* nonce, const uint8_t* aad,
+                        size_t aad_len, const uint8_t* in, size_t len,
+                        uint8_t* out) const {
+  BCRYPT_AUTHENTICATED_CIPHER_MODE_INFO info;
+  InitAuthInfo(&info, nonce, aad, aad_len, out + len);
+  ULONG written = 0;
+  if (BCryptEncrypt(static_cast<BCRYPT_KEY_HANDLE>(key_), const_cast<PUCHAR>(in),
+                    static_cast<ULONG>(len), &info, nullptr, 0, out,
+                    static_cast<ULONG>(len), &written, 0) != 0) {
+    throw std::runtime_error("BCryptEncrypt (AES-GCM) failed");
+  }
+}
+
+bool AesGcmCipher::Open(const uint8_t* nonce, const uint8_t* aad,
+                        size_t aad_len, const uint8_t* in, size_t len,
+                        uint8_t* out) const {
+  if (len < kAesGcmTagLen) return false;
+  size_t text_len = len - kAesGcmTagLen;
+  BCRYPT_AUTHENTICATED_CIPHER_MODE_INFO info;
+  InitAuthInfo(&info, nonce, aad, aad_len, const_cast<uint8_t*>(in + text_len));
+  ULONG written = 0;
+  return BCryptDecrypt(static_cast<BCRYPT_KEY_HANDLE>(key_),
+                       const_cast<PUCHAR>(in), static_cast<ULONG>(text_len),
+                       &info, nullptr, 0, out, static_cast<ULONG>(text_len),
+                       &written, 0) == 0;
+}
+#else
+AesGcmCipher::AesGcmCipher(const AesGcmKey& key) : key_(key) {}
+
+AesGcmCipher::~AesGcmCipher() { SecureZero(key_.data(), key_.size()); }
+
+// A context per call keeps the cipher thread-safe; initialising one costs far
+// less than encrypting a chunk.
+void AesGcmCipher::Seal(const uint8_t* nonce, const uint8_t* aad,
+                        size_t aad_len, const uint8_t* in, size_t len,
+                        uint8_t* out) const {
+  EVP_CIPHER_CTX* context = EVP_CIPHER_CTX_new();
+  int out_len = 0;
+  bool ok =
+      context &&
+      EVP_EncryptInit_ex(context, EVP_aes_256_gcm(), nullptr, key_.data(),
+                         nonce) == 1 &&
+      (aad_len == 0 || EVP_EncryptUpdate(context, nullptr, &out_len, aad,
+                                         static_cast<int>(aad_len)) == 1) &&
+      (len == 0 || EVP_EncryptUpdate(context, out, &out_len, in,
+                                     static_cast<int>(len)) == 1) &&
+      EVP_EncryptFinal_ex(context, out + len, &out_len) == 1 &&
+      EVP_CIPHER_CTX_ctrl(context, EVP_CTRL_GCM_GET_TAG,
+                          static_cast<int>(kAesGcmTagLen), out + len) == 1;
+  EVP_CIPHER_CTX_free(context);
+  if (!ok) throw std::runtime_error("AES-GCM encryption failed");
+}
+
+bool AesGcmCipher::Open(const uint8_t* nonce, const uint8_t* aad,
+                        size_t aad_len, const uint8_t* in, size_t len,
+                        uint8_t* out) const {
+  if (len < kAesGcmTagLen) return false;
+  size_t text_len = len - kAesGcmTagLen;
+  EVP_CIPHER_CTX* context = EVP_CIPHER_CTX_new();
+  int out_len = 0;
+  bool ok =
+      context &&
+      EVP_DecryptInit_ex(context, EVP_aes_256_gcm(), nullptr, key_.data(),
+                         nonce) == 1 &&
+      (aad_len == 0 || EVP_DecryptUpdate(context, nullptr, &out_len, aad,
+                                         static_cast<int>(aad_len)) == 1) &&
+      (text_len == 0 || EVP_DecryptUpdate(context, out, &out_len, in,
+                                          static_cast<int>(text_len)) == 1) &&
+      EVP_CIPHER_CTX_ctrl(context, EVP_CTRL_GCM_SET_TAG,
+                          static_cast<int>(kAesGcmTagLen),
+                          const_cast<uint8_t*>(in + text_len)) == 1 &&
+      EVP_DecryptFinal_ex(context, out + text_len, &out_len) == 1;
+  EVP_CIPHER_CTX_free(context);
+  return ok;
+}
+#endif
+
+// Per-message state shared by the bulk and streaming code: the header, the
+// derived message key and the chunk nonce schedule.
+class AesGcmStream {
+ public:
+  // Starts a new message with a fresh salt and nonce prefix.
+  static std::unique_ptr<AesGcmStream> Create(const AesGcmKey& key,
+                                              const std::vector<uint8_t>& aad,
+                                              size_t chunk_len) {
+    CheckChunkLen(chunk_len);
+    uint8_t header[kAesGcmHeaderLen];
+    std::memcpy(header, kMagic, sizeof(kMagic));
+    StoreLe32(header + 4, static_cast<uint32_t>(chunk_len));
+    FillRandom(header + 8, kSaltLen + kNoncePrefixLen);
+    return std::unique_ptr<AesGcmStream>(new AesGcmStream(key, aad, header));
+  }
+
+  // Resumes a message from its header. Throws std::invalid_argument if the
+  // header is not in the chunked format.
+  static std::unique_ptr<AesGcmStream> FromHeader(
+      const AesGcmKey& key, const std::vector<uint8_t>& aad,
+      const uint8_t* header) {
+    if (std::memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+      throw std::invalid_argument("Not an AES-GCM chunked message");
+    }
+    CheckChunkLen(LoadLe32(header + 4));
+    return std::unique_ptr<AesGcmStream>(new AesGcmStream(key, aad, header));
+  }
+
+  const uint8_t* header() const { return aad_.data(); }
+  size_t chunk_len() const { return chunk_len_; }
+
+  void SealChunk(uint32_t index, bool last, const uint8_t* in, size_t len,
+                 uint8_t* out) const {
+    uint8_t nonce[kAesGcmNonceLen];
+    MakeNonce(index, last, nonce);
+    cipher_->Seal(nonce, aad_.data(), aad_.size(), in, len, out);
+  }
+
+  bool OpenChunk(uint32_t index, bool last, const uint8_t* in, size_t len,
+                 uint8_t* out) const {
+    uint8_t nonce[kAesGcmNonceLen];
+    MakeNonce(index, last, nonce);
+    return cipher_->Open(nonce, aad_.data(), aad_.size(), in, len, out);
+  }
+
+ private:
+  AesGcmStream(const AesGcmKey& key, const std::vector<uint8_t>& aad,
+               const uint8_t* header)
+      : chunk_len_(LoadLe32(header + 4)) {
+    // Every chunk authenticates the header, binding chunk_len and the salt.
+    aad_.resize(kAesGcmHeaderLen + aad.size());
+    std::memcpy(aad_.data(), header, kAesGcmHeaderLen);
+    if (!aad.empty()) {
+      std::memcpy(aad_.data() + kAesGcmHeaderLen, aad.data(), aad.size());
+    }
+    AesGcmKey message_key;
+    HkdfSha256(key.data(), key.size(), header + 8, kSaltLen,
+               reinterpret_cast<const uint8_t*>(kKdfInfo), sizeof(kKdfInfo) - 1,
+               message_key.data(), message_key.size());
+    cipher_ = std::make_unique<AesGcmCipher>(message_key);
+    SecureZero(message_key.data(), message_key.size());
+  }
+
+  void MakeNonce(uint32_t index, bool last, uint8_t* nonce) const {
+    std::memcpy(nonce, aad_.data() + 8 + kSaltLen, kNoncePrefixLen);
+    nonce[7] = static_cast<uint8_t>(index >> 24);
+    nonce[8] = static_cast<uint8_t>(index >> 16);
+    nonce[9] = static_cast<uint8_t>(index >> 8);
+    nonce[10] = static_cast<uint8_t>(index);
+    nonce[11] = last ? 1 : 0;
+  }
+
+  size_t chunk_len_;
+  std::vector<uint8_t> aad_;  // Header followed by the caller's AAD.
+  std::unique_ptr<AesGcmCipher> cipher_;
+};
+
+namespace {
+
+struct BulkJob {
+  std::unique_ptr<AesGcmStream> stream;
+  std::vector<uint8_t> input;
+  std::vector<uint8_t> output;
+  size_t chunk_count = 0;
+  std::atomic<size_t> remaining{0};
+  std::atomic<bool> failed{false};
+  AesGcmCallback on_complete;
+
+  void TaskDone() {
+    if (remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    if (failed.load()) {
+      SecureZero(output.data(), output.size());
+      on_complete(false, {});
+    } else {
+      on_complete(true, std::move(output));
+    }
+  }
+};
+
+// Runs |process(chunk)| for every chunk of |job|, a few chunks per task.
+template <typename Process>
+void RunChunks(const std::shared_ptr<BulkJob>& job, WorkerPool* pool,
+               Process process) {
+  size_t chunks_per_task = kBytesPerTask / job->stream->chunk_len();
+  if (chunks_per_task == 0) chunks_per_task = 1;
+  size_t task_count = (job->chunk_count + chunks_per_task - 1) / chunks_per_task;
+  job->remaining.store(task_count);
+  for (size_t first = 0; first < job->chunk_count; first += chunks_per_task) {
+    size_t end = first + chunks_per_task;
+    if (end > job->chunk_count) end = job->chunk_count;
+    pool->Post([job, first, end, process]() {
+      try {
+        for (size_t chunk = first; chunk < end && !job->failed.load(); ++chunk) {
+          if (!process(job.get(), chunk)) job->failed.store(true);
+        }
+      } catch (const std::exception&) {
+        job->failed.store(true);
+      }
+      job->TaskDone();
+    });
+  }
+}
+
+}  // namespace
+
+size_t AesGcmCiphertextLen(size_t plaintext_len, size_t chunk_len) {
+  size_t chunk_count = (plaintext_len + chunk_len - 1) / chunk_len;
+  if (chunk_count == 0) chunk_count = 1;
+  return kAesGcmHeaderLen + plaintext_len + chunk_count * kAesGcmTagLen;
+}
+
+void AesGcmEncryptAsync(const AesGcmKey& key, std::vector<uint8_t> plaintext,
+                        std::vector<uint8_t> aad, WorkerPool* pool,
+                        AesGcmCallback on_complete, size_t chunk_len) {
+  auto job = std::make_shared<BulkJob>();
+  job->stream = AesGcmStream::Create(key, aad, chunk_len);
+  job->input = std::move(plaintext);
+  job->on_complete = std::move(on_complete);
+  job->chunk_count = (job->input.size() + chunk_len - 1) / chunk_len;
+  if (job->chunk_count == 0) job->chunk_count = 1;
+  if (job->chunk_count > UINT32_MAX) {
+    throw std::invalid_argument("Message has too many chunks");
+  }
+  job->output.resize(AesGcmCiphertextLen(job->input.size(), chunk_len));
+  std::memcpy(job->output.data(), job->stream->header(), kAesGcmHeaderLen);
+
+  RunChunks(job, pool, [](BulkJob* job, size_t chunk) {
+    size_t chunk_len = job->stream->chunk_len();
+    size_t offset = chunk * chunk_len;
+    size_t len = job->input.size() - offset;
+    if (len > chunk_len) len = chunk_len;
+    uint8_t* out = job->output.data() + kAesGcmHeaderLen +
+                   chunk * (chunk_len + kAesGcmTagLen);
+    job->stream->SealChunk(static_cast<uint32_t>(chunk),
+                           chunk + 1 == job->chunk_count,
+                           job->input.data() + offset, len, out);
+    return true;
+  });
+}
+
+void AesGcmDecryptAsync(const AesGcmKey& key, std::vector<uint8_t> ciphertext,
+                        std::vector<uint8_t> aad, WorkerPool* pool,
+                        AesGcmCallback on_complete) {
+  if (ciphertext.size() < kAesGcmHeaderLen) {
+    throw std::invalid_argument("Ciphertext is too short");
+  }
+  auto job = std::make_shared<BulkJob>();
+  job->stream = AesGcmStream::FromHeader(key, aad, ciphertext.data());
+  job->input = std::move(ciphertext);
+  job->on_complete = std::move(on_complete);
+
+  const size_t record_len = job->stream->chunk_len() + kAesGcmTagLen;
+  const size_t body_len = job->input.size() - kAesGcmHeaderLen;
+  job->chunk_count = (body_len + record_len - 1) / record_len;
+  size_t last_len = body_len - (job->chunk_count - 1) * record_len;
+  if (job->chunk_count == 0 || job->chunk_count > UINT32_MAX ||
+      last_len < kAesGcmTagLen) {
+    // Truncated inside the final tag: indistinguishable from tampering.
+    pool->Post([job]() { job->on_complete(false, {}); });
+    return;
+  }
+  job->output.resize(body_len - job->chunk_count * kAesGcmTagLen);
+
+  RunChunks(job, pool, [](BulkJob* job, size_t chunk) {
+    const size_t chunk_len = job->stream->chunk_len();
+    const size_t record_len = chunk_len + kAesGcmTagLen;
+    size_t offset = kAesGcmHeaderLen + chunk * record_len;
+    size_t len = job->input.size() - offset;
+    if (len > record_len) len = record_len;
+    return job->stream->OpenChunk(static_cast<uint32_t>(chunk),
+                                  chunk + 1 == job->chunk_count,
+                                  job->input.data() + offset, len,
+                                  job->output.data() + chunk * chunk_len);
+  });
+}
+
+std::vector<uint8_t> AesGcmEncrypt(const AesGcmKey& key,
+                                   std::vector<uint8_t> plaintext,
+                                   std::vector<uint8_t> aad, WorkerPool* pool,
+                                   size_t chunk_len) {
+  std::promise<std::pair<bool, std::vector<uint8_t>>> promise;
+  auto future = promise.get_future();
+  AesGcmEncryptAsync(
+      key, std::move(plaintext), std::move(aad), pool,
+      [&promise](bool ok, std::vector<uint8_t> output) {
+        promise.set_value({ok, std::move(output)});
+      },
+      chunk_len);
+  auto result = future.get();
+  if (!result.first) throw std::runtime_error("AES-GCM encryption failed");
+  return std::move(result.second);
+}
+
+bool AesGcmDecrypt(const AesGcmKey& key, std::vector<uint8_t> ciphertext,
+                   std::vector<uint8_t> aad, WorkerPool* pool,
+                   std::vector<uint8_t>* plaintext) {
+  std::promise<std::pair<bool, std::vector<uint8_t>>> promise;
+  auto future = promise.get_future();
+  AesGcmDecryptAsync(key, std::move(ciphertext), std::move(aad), pool,
+                     [&promise](bool ok, std::vector<uint8_t> output) {
+                       promise.set_value({ok, std::move(output)});
+                     });
+  auto result = future.get();
+  *plaintext = std::move(result.second);
+  return result.first;
+}
+
+AesGcmStreamEncryptor::AesGcmStreamEncryptor(const AesGcmKey& key,
+                                             std::vector<uint8_t> aad,
+                                             size_t chunk_len)
+    : stream_(AesGcmStream::Create(key, aad, chunk_len)) {
+  pending_.reserve(chunk_len);
+}
+
+AesGcmStreamEncryptor::~AesGcmStreamEncryptor() {
+  SecureZero(pending_.data(), pending_.size());
+}
+
+void AesGcmStreamEncryptor::EmitHeader(std::vector<uint8_t>* out) {
+  if (header_written_) return;
+  out->insert(out->end(), stream_->header(),
+              stream_->header() + kAesGcmHeaderLen);
+  header_written_ = true;
+}
+
+void AesGcmStreamEncryptor::Update(const uint8_t* data, size_t len,
+                                   std::vector<uint8_t>* out) {
+  EmitHeader(out);
+  const size_t chunk_len = stream_->chunk_len();
+  // A full chunk is only sealed once more data arrives, since the final
+  // chunk needs the last-chunk nonce flag.
+  auto seal = [this, out, chunk_len](const uint8_t* chunk) {
+    if (next_index_ == UINT32_MAX) {
+      throw std::runtime_error("Message has too many chunks");
+    }
+    size_t offset = out->size();
+    out->resize(offset + chunk_len + kAesGcmTagLen);
+    stream_->SealChunk(next_index_++, false, chunk, chunk_len,
+                       out->data() + offset);
+  };
+  while (len > 0) {
+    if (pending_.size() == chunk_len) {
+      seal(pending_.data());
+      SecureZero(pending_.data(), pending_.size());
+      pending_.clear();
+    }
+    if (pending_.empty() && len > chunk_len) {
+      seal(data);
+      data += chunk_len;
+      len -= chunk_len;
+      continue;
+    }
+    size_t take = chunk_len - pending_.size();
+    if (take > len) take = len;
+    pending_.insert(pending_.end(), data, data + take);
+    data += take;
+    len -= take;
+  }
+}
+
+void AesGcmStreamEncryptor::Finish(std::vector<uint8_t>* out) {
+  EmitHeader(out);
+  size_t offset = out->size();
+  out->resize(offset + pending_.size() + kAesGcmTagLen);
+  stream_->SealChunk(next_index_, true, pending_.data(), pending_.size(),
+                     out->data() + offset);
+  SecureZero(pending_.data(), pending_.size());
+  pending_.clear();
+}
+
+AesGcmStreamDecryptor::AesGcmStreamDecryptor(const AesGcmKey& key,
+                                             std::vector<uint8_t> aad)
+    : key_(key), aad_(std::move(aad)) {}
+
+AesGcmStreamDecryptor::~AesGcmStreamDecryptor() {
+  SecureZero(key_.data(), key_.size());
+}
+
+bool AesGcmStreamDecryptor::Update(const uint8_t* data, size_t len,
+                                   std::vector<uint8_t>* out) {
+  while (len > 0 && !failed_) {
+    if (!stream_) {
+      size_t take = kAesGcmHeaderLen - pending_.size();
+      if (take > len) take = len;
+      pending_.insert(pending_.end(), data, data + take);
+      data += take;
+      len -= take;
+      if (pending_.size() < kAesGcmHeaderLen) continue;
+      try {
+        stream_ = AesGcmStream::FromHeader(key_, aad_, pending_.data());
+      } catch (const std::invalid_argument&) {
+        failed_ = true;
+        break;
+      }
+      pending_.clear();
+      continue;
+    }
+    // As when encrypting, a full record is only opened once more data shows
+    // it is not the last one.
+    const size_t record_len = stream_->chunk_len() + kAesGcmTagLen;
+    if (pending_.size() == record_len && !DecryptPending(false, out)) break;
+    size_t take = record_len - pending_.size();
+    if (take > len) take = len;
+    pending_.insert(pending_.end(), data, data + take);
+    data += take;
+    len -= take;
+  }
+  return !failed_;
+}
+
+bool AesGcmStreamDecryptor::Finish(std::vector<uint8_t>* out) {
+  if (failed_ || !stream_ || pending_.size() < kAesGcmTagLen) {
+    failed_ = true;
+    return false;
+  }
+  return DecryptPending(true, out);
+}
+
+bool AesGcmStreamDecryptor::DecryptPending(bool final,
+                                           std::vector<uint8_t>* out) {
+  if (next_index_ == UINT32_MAX && !final) {
+    failed_ = true;
+    return false;
+  }
+  size_t offset = out->size();
+  out->resize(offset + pending_.size() - kAesGcmTagLen);
+  if (!stream_->OpenChunk(next_index_++, final, pending_.data(),
+                          pending_.size(), out->data() + offset)) {
+    SecureZero(out->data() + offset, out->size() - offset);
+    out->resize(offset);
+    failed_ = true;
+    return false;
+  }
+  pending_.clear();
+  return true;
+}
+
+}  // namespace flutter_native_utils
@@ -0,0 +1,146 @@
+#ifndef FLUTTER_PLUGIN_AES_GCM_H_
+#define FLUTTER_PLUGIN_AES_GCM_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "worker_pool.h"
+
+namespace flutter_native_utils {
+
+constexpr size_t kAesGcmKeyLen = 32;
+constexpr size_t kAesGcmNonceLen = 12;
+constexpr size_t kAesGcmTagLen = 16;
+
+using AesGcmKey = std::array<uint8_t, kAesGcmKeyLen>;
+
+// Single-shot AES-256-GCM with one key, backed by CNG on Windows and OpenSSL
+// libcrypto elsewhere; both use AES-NI and PCLMULQDQ when the CPU has them.
+// Seal and Open are thread-safe, so one cipher can serve many chunks in
+// parallel.
+class AesGcmCipher {
+ public:
+  explicit AesGcmCipher(const AesGcmKey& key);
+  ~AesGcmCipher();
+
+  // Disallow copy and assign.
+  AesGcmCipher(const AesGcmCipher&) = delete;
+  AesGcmCipher& operator=(const AesGcmCipher&) = delete;
+
+  // Writes |len| bytes of ciphertext followed by the tag to |out|.
+  void Seal(const uint8_t* nonce, const uint8_t* aad, size_t aad_len,
+            const uint8_t* in, size_t len, uint8_t* out) const;
+
+  // |len| includes the trailing tag. Writes |len| - kAesGcmTagLen bytes to
+  // |out| and returns false if authentication fails.
+  bool Open(const uint8_t* nonce, const uint8_t* aad, size_t aad_len,
+            const uint8_t* in, size_t len, uint8_t* out) const;
+
+ private:
+#ifdef _WIN32
+  void* key_ = nullptr;  // BCRYPT_KEY_HANDLE.
+#else
+  AesGcmKey key_;
+#endif
+};
+
+// Chunked AES-256-GCM message format:
+//
+//   header  = "FGC1" | chunk_len (u32 LE) | salt (16) | nonce_prefix (7)
+//   chunk_i = AES-GCM(message_key, nonce_i, header | aad, plaintext_i) | tag
+//
+// message_key is HKDF-SHA256(key, salt), so random nonces never repeat across
+// messages, and nonce_i = nonce_prefix | i (u32 BE) | last-chunk flag, so
+// chunks cannot be reordered, dropped or truncated without detection. Every
+// chunk except the last holds exactly chunk_len bytes of plaintext; an empty
+// message is a single empty last chunk.
+constexpr size_t kAesGcmHeaderLen = 31;
+constexpr size_t kAesGcmDefaultChunkLen = 64 << 10;
+constexpr size_t kAesGcmMaxChunkLen = 16 << 20;
+
+// Size of the ciphertext for |plaintext_len| bytes.
+size_t AesGcmCiphertextLen(size_t plaintext_len, size_t chunk_len);
+
+using AesGcmCallback =
+    std::function<void(bool ok, std::vector<uint8_t> output)>;
+
+// Encrypts |plaintext| with chunks spread over |pool|. |on_complete| runs on
+// a worker thread; ok is only false if the platform library fails. Throws
+// std::invalid_argument for a chunk_len that is zero or above
+// kAesGcmMaxChunkLen.
+void AesGcmEncryptAsync(const AesGcmKey& key, std::vector<uint8_t> plaintext,
+                        std::vector<uint8_t> aad, WorkerPool* pool,
+                        AesGcmCallback on_complete,
+                        size_t chunk_len = kAesGcmDefaultChunkLen);
+
+// Decrypts a message produced by AesGcmEncryptAsync or AesGcmStreamEncryptor.
+// Throws std::invalid_argument for a malformed header; authentication
+// failures are reported through |on_complete| with ok == false.
+void AesGcmDecryptAsync(const AesGcmKey& key, std::vector<uint8_t> ciphertext,
+                        std::vector<uint8_t> aad, WorkerPool* pool,
+                        AesGcmCallback on_complete);
+
+// Blocking variants. Must not be called from a task running on |pool|.
+std::vector<uint8_t> AesGcmEncrypt(const AesGcmKey& key,
+                                   std::vector<uint8_t> plaintext,
+                                   std::vector<uint8_t> aad, WorkerPool* pool,
+                                   size_t chunk_len = kAesGcmDefaultChunkLen);
+bool AesGcmDecrypt(const AesGcmKey& key, std::vector<uint8_t> ciphertext,
+                   std::vector<uint8_t> aad, WorkerPool* pool,
+                   std::vector<uint8_t>* plaintext);
+
+class AesGcmStream;
+
+// Incremental encryption in the chunked format, for data that does not fit
+// in memory. Output is produced one chunk at a time; the last chunk is only
+// emitted by Finish.
+class AesGcmStreamEncryptor {
+ public:
+  AesGcmStreamEncryptor(const AesGcmKey& key, std::vector<uint8_t> aad,
+                        size_t chunk_len = kAesGcmDefaultChunkLen);
+  ~AesGcmStreamEncryptor();
+
+  // Appends the header (on the first call) and all complete chunks to |out|.
+  void Update(const uint8_t* data, size_t len, std::vector<uint8_t>* out);
+
+  // Appends the remaining output. The encryptor must not be used afterwards.
+  void Finish(std::vector<uint8_t>* out);
+
+ private:
+  void EmitHeader(std::vector<uint8_t>* out);
+
+  std::unique_ptr<AesGcmStream> stream_;
+  std::vector<uint8_t> pending_;
+  uint32_t next_index_ = 0;
+  bool header_written_ = false;
+};
+
+// Incremental decryption of the chunked format. Once Update or Finish
+// returns false the decryptor is failed and plaintext already returned must
+// be discarded.
+class AesGcmStreamDecryptor {
+ public:
+  AesGcmStreamDecryptor(const AesGcmKey& key, std::vector<uint8_t> aad);
+  ~AesGcmStreamDecryptor();
+
+  bool Update(const uint8_t* data, size_t len, std::vector<uint8_t>* out);
+  bool Finish(std::vector<uint8_t>* out);
+
+ private:
+  bool DecryptPending(bool final, std::vector<uint8_t>* out);
+
+  AesGcmKey key_;
+  std::vector<uint8_t> aad_;
+  std::unique_ptr<AesGcmStream> stream_;
+  std::vector<uint8_t> pending_;
+  uint32_t next_index_ = 0;
+  bool failed_ = false;
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_AES_GCM_H_
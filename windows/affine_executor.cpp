@@ -0,0 +1,57 @@
+#include "affine_executor.h"
+
+namespace flutter_native_utils {
+
+AffineThread::AffineThread(std::function<void()> setup,
+                           std::function<void()> teardown)
+    : thread_([this, setup = std::move(setup),
+               teardown = std::move(teardown)]() {
+        ThreadLoop(setup, teardown);
+      }) {}
+
+AffineThread::~AffineThread() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    tasks_.clear();
+  }
+  wake_.notify_all();
+  thread_.join();
+}
+
+void AffineThread::Post(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) return;
+    tasks_.push_back(std::move(task));
+  }
+  wake_.notify_one();
+}
+
+bool AffineThread::IsCurrentThread() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::this_thread::get_id() == thread_id_;
+}
+
+void AffineThread::ThreadLoop(const std::function<void()>& setup,
+                              const std::function<void()>& teardown) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    thread_id_ = std::this_thread::get_id();
+  }
+  if (setup) setup();
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+      if (stopping_) break;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+  if (teardown) teardown();
+}
+
+}  // namespace flutter_native_utils
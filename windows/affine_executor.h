@@ -0,0 +1,117 @@
+#ifndef FLUTTER_PLUGIN_AFFINE_EXECUTOR_H_
+#define FLUTTER_PLUGIN_AFFINE_EXECUTOR_H_
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace flutter_native_utils {
+
+// A single dedicated thread that runs posted tasks one at a time, in order.
+// |setup| runs on the thread before the first task and |teardown| after the
+// last, so per-thread state such as a COM apartment is initialised once
+// rather than around every call.
+class AffineThread {
+ public:
+  AffineThread(std::function<void()> setup, std::function<void()> teardown);
+
+  // Discards tasks that have not started, waits for the running one, then
+  // runs |teardown| and joins the thread.
+  ~AffineThread();
+
+  // Disallow copy and assign.
+  AffineThread(const AffineThread&) = delete;
+  AffineThread& operator=(const AffineThread&) = delete;
+
+  void Post(std::function<void()> task);
+
+  // Whether the caller is running on this thread. Blocking on a task from
+  // this thread itself would deadlock.
+  bool IsCurrentThread() const;
+
+ private:
+  void ThreadLoop(const std::function<void()>& setup,
+                  const std::function<void()>& teardown);
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<std::function<void()>> tasks_;
+  bool stopping_ = false;
+  // Set by the thread itself, which may start running before thread_ is
+  // assigned.
+  std::thread::id thread_id_;
+  std::thread thread_;
+};
+
+// Runs tasks on one long-lived thread that owns a |Context|, for APIs bound
+// to the thread that initialised them (apartment-threaded COM objects,
+// thread-affine handles). The Context is constructed on the thread before
+// the first task and destroyed there after the last; every task receives
+// it. Thread-safe.
+template <typename Context>
+class AffineExecutor {
+ public:
+  AffineExecutor()
+      : thread_(
+            [this]() {
+              try {
+                context_.emplace();
+              } catch (...) {
+                setup_error_ = std::current_exception();
+              }
+            },
+            [this]() { context_.reset(); }) {}
+
+  // Disallow copy and assign.
+  AffineExecutor(const AffineExecutor&) = delete;
+  AffineExecutor& operator=(const AffineExecutor&) = delete;
+
+  // Queues |task|, a copyable callable taking Context&, and returns a future
+  // for its result. If it throws, or the Context could not be constructed,
+  // the future holds that exception. Tasks discarded at destruction leave
+  // their futures with std::future_errc::broken_promise.
+  template <typename Task>
+  auto Submit(Task task) -> std::future<std::invoke_result_t<Task&, Context&>> {
+    using Result = std::invoke_result_t<Task&, Context&>;
+    auto promise = std::make_shared<std::promise<Result>>();
+    std::future<Result> future = promise->get_future();
+    thread_.Post([this, promise, task = std::move(task)]() mutable {
+      if (setup_error_) {
+        promise->set_exception(setup_error_);
+        return;
+      }
+      try {
+        if constexpr (std::is_void_v<Result>) {
+          task(*context_);
+          promise->set_value();
+        } else {
+          promise->set_value(task(*context_));
+        }
+      } catch (...) {
+        promise->set_exception(std::current_exception());
+      }
+    });
+    return future;
+  }
+
+  bool IsCurrentThread() const { return thread_.IsCurrentThread(); }
+
+ private:
+  // Touched only on the thread, which starts after and is joined before
+  // they are destroyed.
+  std::optional<Context> context_;
+  std::exception_ptr setup_error_;
+  AffineThread thread_;
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_AFFINE_EXECUTOR_H_
@@ -0,0 +1,156 @@
+// Replaces the global operator new and delete so AllocationScope can count
+// the heap use of each method call. Only linked into instrumented builds; see
+// allocation_stats.h.
+//
+// Every block carries a header with its size and the scope it was charged
+// to. Over-aligned types (e.g. NonceReplayFilter's cache lines) take the
+// std::align_val_t overloads, which put the header just below a block
+// aligned as asked.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#include "allocation_stats.h"
+
+namespace {
+
+struct alignas(alignof(std::max_align_t)) BlockHeader {
+  size_t size;
+  uint64_t scope_id;
+};
+
+void* Allocate(size_t size) {
+  auto* header =
+      static_cast<BlockHeader*>(std::malloc(sizeof(BlockHeader) + size));
+  if (!header) return nullptr;
+  header->size = size;
+  header->scope_id = flutter_native_utils::RecordAllocation(size);
+  return header + 1;
+}
+
+void Free(void* ptr) {
+  if (!ptr) return;
+  BlockHeader* header = static_cast<BlockHeader*>(ptr) - 1;
+  flutter_native_utils::RecordFree(header->scope_id, header->size);
+  std::free(header);
+}
+
+// Room for the header ahead of a block aligned to |alignment|, which the
+// aligned delete recomputes from the same alignment.
+size_t AlignedOffset(size_t alignment) {
+  return (sizeof(BlockHeader) + alignment - 1) / alignment * alignment;
+}
+
+void* AllocateAligned(size_t size, size_t alignment) {
+  const size_t offset = AlignedOffset(alignment);
+#ifdef _WIN32
+  auto* base = static_cast<char*>(_aligned_malloc(offset + size, alignment));
+#else
+  // aligned_alloc wants a multiple of the alignment.
+  const size_t total = (offset + size + alignment - 1) / alignment * alignment;
+  auto* base = static_cast<char*>(std::aligned_alloc(alignment, total));
+#endif
+  if (!base) return nullptr;
+  BlockHeader* header = reinterpret_cast<BlockHeader*>(base + offset) - 1;
+  header->size = size;
+  header->scope_id = flutter_native_utils::RecordAllocation(size);
+  return base + offset;
+}
+
+void FreeAligned(void* ptr, size_t alignment) {
+  if (!ptr) return;
+  BlockHeader* header = static_cast<BlockHeader*>(ptr) - 1;
+  flutter_native_utils::RecordFree(header->scope_id, header->size);
+  char* base = static_cast<char*>(ptr) - AlignedOffset(alignment);
+#ifdef _WIN32
+  _aligned_free(base);
+#else
+  std::free(base);
+#endif
+}
+
+void* AllocateOrThrow(size_t size, size_t alignment = 0) {
+  if (size == 0) size = 1;
+  for (;;) {
+    void* ptr = alignment ? AllocateAligned(size, alignment) : Allocate(size);
+    if (ptr) return ptr;
+    std::new_handler handler = std::get_new_handler();
+    if (!handler) throw std::bad_alloc();
+    handler();
+  }
+}
+
+void* AllocateOrNull(size_t size, size_t alignment = 0) noexcept {
+  try {
+    return AllocateOrThrow(size, alignment);
+  } catch (const std::bad_alloc&) {
+    return nullptr;
+  }
+}
+
+struct HooksInstaller {
+  HooksInstaller() { flutter_native_utils::MarkAllocationHooksInstalled(); }
+} hooks_installer;
+
+}  // namespace
+
+void* operator new(size_t size) { return AllocateOrThrow(size); }
+void* operator new[](size_t size) { return AllocateOrThrow(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return AllocateOrNull(size);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return AllocateOrNull(size);
+}
+
+void operator delete(void* ptr) noexcept { Free(ptr); }
+void operator delete[](void* ptr) noexcept { Free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { Free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { Free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { Free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+  Free(ptr);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+  return AllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+  return AllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+void* operator new(size_t size, std::align_val_t alignment,
+                   const std::nothrow_t&) noexcept {
+  return AllocateOrNull(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept {
+  return AllocateOrNull(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* ptr, std::align_val_t alignment) noexcept {
+  FreeAligned(ptr, static_cast<size_t>(alignment));
+}
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept {
+  FreeAligned(ptr, static_cast<size_t>(alignment));
+}
+void operator delete(void* ptr, size_t, std::align_val_t alignment) noexcept {
+  FreeAligned(ptr, static_cast<size_t>(alignment));
+}
+void operator delete[](void* ptr, size_t,
+                       std::align_val_t alignment) noexcept {
+  FreeAligned(ptr, static_cast<size_t>(alignment));
+}
+void operator delete(void* ptr, std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept {
+  FreeAligned(ptr, static_cast<size_t>(alignment));
+}
+void operator delete[](void* ptr, std::align_val_t alignment,
+                       const std::nothrow_t&) noexcept {
+  FreeAligned(ptr, static_cast<size_t>(alignment));
+}
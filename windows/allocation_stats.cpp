@@ -0,0 +1,95 @@
+#include "allocation_stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+
+namespace flutter_native_utils {
+
+namespace {
+
+std::atomic<bool> hooks_installed{false};
+std::atomic<uint64_t> next_scope_id{1};
+
+// The scope charged for this thread's allocations. A plain pointer, so the
+// hooks can read it during thread start-up and teardown.
+thread_local AllocationScope* current_scope = nullptr;
+
+// Function-local so scopes opened by static initialisers find them built.
+std::mutex& TotalsMutex() {
+  static std::mutex* mutex = new std::mutex();
+  return *mutex;
+}
+
+std::map<std::string, MethodAllocationStats>& Totals() {
+  static auto* totals = new std::map<std::string, MethodAllocationStats>();
+  return *totals;
+}
+
+}  // namespace
+
+bool AllocationTrackingEnabled() {
+  return hooks_installed.load(std::memory_order_relaxed);
+}
+
+AllocationScope::AllocationScope(const std::string& method,
+                                 bool continuation)
+    : continuation_(continuation) {
+  if (!AllocationTrackingEnabled() || current_scope) return;
+  // Copied before the scope starts, so the copy is not charged to it.
+  method_ = method;
+  id_ = next_scope_id.fetch_add(1, std::memory_order_relaxed);
+  active_ = true;
+  current_scope = this;
+}
+
+AllocationScope::~AllocationScope() {
+  if (!active_) return;
+  // Ended first: updating the totals allocates.
+  current_scope = nullptr;
+  std::lock_guard<std::mutex> lock(TotalsMutex());
+  MethodAllocationStats& totals = Totals()[method_];
+  if (totals.method.empty()) totals.method = method_;
+  if (!continuation_) ++totals.calls;
+  totals.allocations += allocations_;
+  totals.bytes += bytes_;
+  totals.peak_bytes = std::max(totals.peak_bytes, peak_bytes_);
+}
+
+std::vector<MethodAllocationStats> AllocationStatsSnapshot() {
+  std::lock_guard<std::mutex> lock(TotalsMutex());
+  std::vector<MethodAllocationStats> snapshot;
+  snapshot.reserve(Totals().size());
+  for (const auto& entry : Totals()) snapshot.push_back(entry.second);
+  return snapshot;
+}
+
+void ResetAllocationStats() {
+  std::lock_guard<std::mutex> lock(TotalsMutex());
+  Totals().clear();
+}
+
+// ---------- Hooks ----------
+
+void MarkAllocationHooksInstalled() {
+  hooks_installed.store(true, std::memory_order_relaxed);
+}
+
+uint64_t RecordAllocation(size_t size) {
+  AllocationScope* scope = current_scope;
+  if (!scope) return 0;
+  ++scope->allocations_;
+  scope->bytes_ += size;
+  scope->live_bytes_ += size;
+  scope->peak_bytes_ = std::max(scope->peak_bytes_, scope->live_bytes_);
+  return scope->id_;
+}
+
+void RecordFree(uint64_t scope_id, size_t size) {
+  AllocationScope* scope = current_scope;
+  if (!scope || scope_id != scope->id_) return;
+  scope->live_bytes_ -= size;
+}
+
+}  // namespace flutter_native_utils
@@ -0,0 +1,89 @@
+#ifndef FLUTTER_PLUGIN_ALLOCATION_STATS_H_
+#define FLUTTER_PLUGIN_ALLOCATION_STATS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace flutter_native_utils {
+
+// Heap use of one channel method, summed over its invocations.
+struct MethodAllocationStats {
+  std::string method;
+  uint64_t calls = 0;
+  // operator new calls made by the invocations, and the bytes they asked for.
+  uint64_t allocations = 0;
+  uint64_t bytes = 0;
+  // The most any single invocation held at once: bytes it allocated and had
+  // not yet freed.
+  uint64_t peak_bytes = 0;
+};
+
+// Whether allocation_hooks.cpp, which replaces the global operator new and
+// delete, is linked into this binary. Without it scopes count nothing. It is
+// linked into the plugin when FLUTTER_NATIVE_UTILS_ALLOCATION_STATS is on,
+// and into the Linux benchmark and tests.
+bool AllocationTrackingEnabled();
+
+// Charges the allocations this thread makes while it lives to |method|, and
+// adds them to the method's totals when destroyed. A scope opened while
+// another is active on the same thread is inert, so the outer one keeps
+// counting. Allocations made for the invocation on other threads, e.g. by
+// work it posts, are not charged to it unless that work opens a scope of its
+// own.
+class AllocationScope {
+ public:
+  // |continuation| marks a later part of an invocation already counted, such
+  // as its work on a worker thread: its allocations are added to the
+  // method's but not another call, and its peak is taken on its own.
+  explicit AllocationScope(const std::string& method,
+                           bool continuation = false);
+  ~AllocationScope();
+
+  // Disallow copy and assign.
+  AllocationScope(const AllocationScope&) = delete;
+  AllocationScope& operator=(const AllocationScope&) = delete;
+
+  // Counts so far, for the benchmark's per-call budgets.
+  uint64_t allocations() const { return allocations_; }
+  uint64_t bytes() const { return bytes_; }
+  uint64_t peak_bytes() const { return peak_bytes_; }
+
+ private:
+  friend uint64_t RecordAllocation(size_t size);
+  friend void RecordFree(uint64_t scope_id, size_t size);
+
+  bool active_ = false;
+  bool continuation_ = false;
+  uint64_t id_ = 0;
+  std::string method_;
+  uint64_t allocations_ = 0;
+  uint64_t bytes_ = 0;
+  uint64_t live_bytes_ = 0;
+  uint64_t peak_bytes_ = 0;
+};
+
+// Totals of every method that has run under a scope, sorted by method.
+std::vector<MethodAllocationStats> AllocationStatsSnapshot();
+
+// Forgets every method's totals.
+void ResetAllocationStats();
+
+// ---------- Hooks ----------
+// Called by allocation_hooks.cpp only; they must not allocate.
+
+void MarkAllocationHooksInstalled();
+
+// Charges |size| bytes to this thread's scope and returns its id, which the
+// block keeps so its free can be matched to it, or 0 if there is no scope.
+uint64_t RecordAllocation(size_t size);
+
+// Releases |size| bytes allocated under |scope_id| if that scope is still
+// this thread's; frees on other threads or after the scope ended are not
+// its to count.
+void RecordFree(uint64_t scope_id, size_t size);
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_ALLOCATION_STATS_H_
@@ -0,0 +1,313 @@
+#include "backend_hub.h"
+
+#include <filesystem>
+#include <stdexcept>
+
+namespace flutter_native_utils {
+
+std::shared_ptr<BackendHub> BackendHub::Acquire(
+    const BackendHubOptions& options) {
+  static std::mutex mutex;
+  static std::weak_ptr<BackendHub> current;
+  std::lock_guard<std::mutex> lock(mutex);
+  std::shared_ptr<BackendHub> hub = current.lock();
+  if (!hub) {
+    // The constructor is private, so make_shared cannot be used.
+    hub.reset(new BackendHub(options));
+    current = hub;
+  }
+  return hub;
+}
+
+#if defined(_WIN32) && defined(FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE)
+static std::unique_ptr<AffineExecutor<WmiSession>> CreateWmiExecutor() {
+  auto executor = std::make_unique<AffineExecutor<WmiSession>>();
+  // Surfaces a failure to join the apartment here, so it is recorded and
+  // retried on the next call.
+  executor->Submit([](WmiSession&) {}).get();
+  return executor;
+}
+#endif
+
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+static std::unique_ptr<CertificateChainBuilder> CreateChainBuilder(
+    const BackendHubOptions& options) {
+#ifdef _WIN32
+  return std::make_unique<CertificateChainBuilder>();
+#else
+  return std::make_unique<CertificateChainBuilder>(
+      options.certificate_directory, options.ca_directory);
+#endif
+}
+
+static std::unique_ptr<CertificateSigner> CreateCertificateSigner(
+    const BackendHubOptions& options) {
+#ifdef _WIN32
+  return std::make_unique<CertificateSigner>();
+#else
+  return std::make_unique<CertificateSigner>(options.certificate_directory);
+#endif
+}
+#endif
+
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+static std::unique_ptr<KeyIndex> CreateKeyIndex(
+    const BackendHubOptions& options) {
+#ifdef _WIN32
+  return std::make_unique<KeyIndex>(std::make_unique<CngKeyStore>());
+#else
+  return std::make_unique<KeyIndex>(
+      std::make_unique<FileKeyStore>(options.key_directory));
+#endif
+}
+#endif
+
+// The feature backends are declared ahead of the hasher, so a disabled
+// feature's initializers drop out without leaving a trailing comma.
+BackendHub::BackendHub(const BackendHubOptions& options)
+    : workers_("workers", &timeline_,
+               [threads = options.worker_threads]() {
+                 return std::make_unique<WorkerPool>(threads);
+               }),
+#if defined(_WIN32) && defined(FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE)
+      wmi_("wmi", &timeline_, CreateWmiExecutor),
+#endif
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+      chain_builder_("certificateChains", &timeline_,
+                     [options]() { return CreateChainBuilder(options); }),
+      certificate_signer_(
+          "certificateSigner", &timeline_,
+          [options]() { return CreateCertificateSigner(options); }),
+#endif
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+      key_index_("keyIndex", &timeline_,
+                 [options]() { return CreateKeyIndex(options); }),
+      data_keys_("dataKeys", &timeline_,
+                 [this]() {
+                   return std::make_unique<DataKeyCache>(key_index());
+                 }),
+#endif
+      hasher_("fileHasher", &timeline_,
+              [this]() { return std::make_unique<FileHasher>(workers()); }),
+      manifest_verifier_("manifestVerifier", &timeline_,
+                         [this]() {
+                           return std::make_unique<ManifestVerifier>(hasher());
+                         }) {
+  OpenCallLog(options.call_log_path);
+}
+
+void BackendHub::OpenCallLog(const std::string& path) {
+  if (path.empty()) return;
+  try {
+    call_recorder_ = std::make_unique<MethodCallRecorder>(path);
+  } catch (const std::runtime_error&) {
+    // Recording is a diagnostic; the plugin works without it.
+  }
+}
+
+BackendHub::~BackendHub() {
+  // Nothing may run on the pool while the backends its tasks use go away.
+  workers_.Close();
+#if defined(_WIN32) && defined(FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE)
+  // Drops queries still queued; their callers' routes are closed by now.
+  wmi_.Close();
+#endif
+  manifest_verifier_.Close();
+  hasher_.Close();
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+  chain_builder_.Close();
+  certificate_signer_.Close();
+#endif
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+  // Flushes each store's index; their compactions were on the pool.
+  kv_stores_.clear();
+  data_keys_.Close();
+  key_index_.Close();
+#endif
+}
+
+WorkerPool* BackendHub::workers(StartupPhase phase) {
+  return workers_.Get(phase);
+}
+
+#if defined(_WIN32) && defined(FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE)
+AffineExecutor<WmiSession>* BackendHub::wmi(StartupPhase phase) {
+  return wmi_.Get(phase);
+}
+#endif
+
+FileHasher* BackendHub::hasher(StartupPhase phase) { return hasher_.Get(phase); }
+
+ManifestVerifier* BackendHub::manifest_verifier(StartupPhase phase) {
+  return manifest_verifier_.Get(phase);
+}
+
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+CertificateChainBuilder* BackendHub::chain_builder(StartupPhase phase) {
+  return chain_builder_.Get(phase);
+}
+
+CertificateSigner* BackendHub::certificate_signer(StartupPhase phase) {
+  return certificate_signer_.Get(phase);
+}
+#endif
+
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+KeyIndex* BackendHub::key_index(StartupPhase phase) {
+  return key_index_.Get(phase);
+}
+
+DataKeyCache* BackendHub::data_keys(StartupPhase phase) {
+  return data_keys_.Get(phase);
+}
+
+std::shared_ptr<NonceReplayFilter> BackendHub::nonce_filter() {
+  std::lock_guard<std::mutex> lock(nonce_filter_mutex_);
+  return nonce_filter_;
+}
+
+void BackendHub::set_nonce_filter(std::shared_ptr<NonceReplayFilter> filter) {
+  std::lock_guard<std::mutex> lock(nonce_filter_mutex_);
+  nonce_filter_ = std::move(filter);
+}
+
+int64_t BackendHub::OpenKvStore(const std::string& directory,
+                                const std::string& key_name) {
+  if (directory.empty()) throw std::invalid_argument("Missing directory");
+  std::error_code error;
+  // Stores know their directory canonically, however it was spelled.
+  const std::string path =
+      std::filesystem::weakly_canonical(std::filesystem::u8path(directory),
+                                        error)
+          .u8string();
+  if (error) throw std::invalid_argument("Invalid directory: " + directory);
+
+  std::lock_guard<std::mutex> lock(kv_stores_mutex_);
+  std::shared_ptr<EncryptedKvStore> store;
+  for (const auto& entry : kv_stores_) {
+    if (entry.second->directory() != path) continue;
+    if (entry.second->key_name() != key_name) {
+      throw std::invalid_argument("Store is open under another key");
+    }
+    store = entry.second;
+    break;
+  }
+  // Opened under the lock, so two engines cannot both open one directory.
+  // One whose last handle just closed may still be flushing; Open waits.
+  if (!store) {
+    store = EncryptedKvStore::Open(path, key_name, key_index(), workers());
+  }
+  const int64_t handle = next_kv_store_++;
+  kv_stores_[handle] = std::move(store);
+  return handle;
+}
+
+std::shared_ptr<EncryptedKvStore> BackendHub::kv_store(int64_t handle) {
+  std::lock_guard<std::mutex> lock(kv_stores_mutex_);
+  auto it = kv_stores_.find(handle);
+  return it == kv_stores_.end() ? nullptr : it->second;
+}
+
+bool BackendHub::CloseKvStore(int64_t handle) {
+  std::shared_ptr<EncryptedKvStore> store;
+  {
+    std::lock_guard<std::mutex> lock(kv_stores_mutex_);
+    auto it = kv_stores_.find(handle);
+    if (it == kv_stores_.end()) return false;
+    store = std::move(it->second);
+    kv_stores_.erase(it);
+  }
+  // Flushed here, outside the lock, if this was the last handle.
+  return true;
+}
+#endif
+
+std::vector<std::string> BackendHub::PrewarmableBackends() {
+  std::vector<std::string> backends = {"workers", "fileHasher",
+                                       "manifestVerifier"};
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+  backends.push_back("certificateChains");
+  backends.push_back("certificateSigner");
+#endif
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+  backends.push_back("keyIndex");
+#endif
+#if defined(_WIN32) && defined(FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE)
+  backends.push_back("wmi");
+#endif
+  return backends;
+}
+
+bool BackendHub::Prewarm(const std::string& backend) {
+  if (backend == "workers") {
+    workers(StartupPhase::kPrewarm);
+  } else if (backend == "fileHasher") {
+    hasher(StartupPhase::kPrewarm);
+  } else if (backend == "manifestVerifier") {
+    manifest_verifier(StartupPhase::kPrewarm);
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+  } else if (backend == "certificateChains") {
+    chain_builder(StartupPhase::kPrewarm);
+  } else if (backend == "certificateSigner") {
+    certificate_signer(StartupPhase::kPrewarm);
+#endif
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+  } else if (backend == "keyIndex") {
+    // Listing is what is slow, not creating the index.
+    key_index(StartupPhase::kPrewarm)->Load();
+#endif
+#if defined(_WIN32) && defined(FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE)
+  } else if (backend == "wmi") {
+    // Connecting to WMI is the slow part, so warm that too.
+    wmi(StartupPhase::kPrewarm)
+        ->Submit([](WmiSession& session) {
+          session.Query("Win32_Processor", "ProcessorId");
+        })
+        .get();
+#endif
+  } else {
+    return false;
+  }
+  return true;
+}
+
+EngineRoute::Hold::~Hold() {
+  if (route_) route_->Release();
+}
+
+std::shared_ptr<EngineRoute> EngineRoute::Create(Poster poster) {
+  return std::shared_ptr<EngineRoute>(new EngineRoute(std::move(poster)));
+}
+
+bool EngineRoute::Post(std::function<void()> task) {
+  // Held while posting, so Close cannot return while the poster's target is
+  // still being used.
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_) return false;
+  poster_([self = shared_from_this(), task = std::move(task)]() {
+    if (!self->closed()) task();
+  });
+  return true;
+}
+
+EngineRoute::Hold EngineRoute::Enter() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_) return Hold(nullptr);
+  ++holds_;
+  return Hold(this);
+}
+
+void EngineRoute::Close() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  closed_ = true;
+  released_.wait(lock, [this]() { return holds_ == 0; });
+}
+
+bool EngineRoute::closed() const { return closed_; }
+
+void EngineRoute::Release() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (--holds_ == 0) released_.notify_all();
+}
+
+}  // namespace flutter_native_utils
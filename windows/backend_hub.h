@@ -0,0 +1,250 @@
+#ifndef FLUTTER_PLUGIN_BACKEND_HUB_H_
+#define FLUTTER_PLUGIN_BACKEND_HUB_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+#include "certificate_chain.h"
+#include "certificate_signer.h"
+#endif
+#include "file_hasher.h"
+#if defined(_WIN32) && defined(FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE)
+#include "affine_executor.h"
+#include "wmi_session.h"
+#endif
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+#include "encrypted_kv_store.h"
+#include "key_store.h"
+#include "nonce_replay_filter.h"
+#endif
+#include "manifest_verifier.h"
+#include "method_call_log.h"
+#include "startup_timeline.h"
+#include "worker_pool.h"
+
+namespace flutter_native_utils {
+
+struct BackendHubOptions {
+  // Zero uses one worker thread per logical processor.
+  size_t worker_threads = 0;
+  // If set, every engine's method calls are recorded there; see
+  // MethodCallRecorder.
+  std::string call_log_path;
+#ifndef _WIN32
+  // Linux hosts have no system stores; see CertificateChainBuilder. Ignored
+  // without the certificates feature.
+  std::string certificate_directory;
+  std::string ca_directory;
+  // Where FileKeyStore keeps CreateKeyPair's keys. Ignored without the keys
+  // feature.
+  std::string key_directory;
+#endif
+};
+
+// The backends every Flutter engine in the process can share: the worker
+// pool, the file hasher and manifest verifier built on it, the certificate
+// chain and key caches, the key-store index and its data-key cache and, on
+// Windows, the WMI thread.
+// The certificate backends exist only with
+// FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES, the index only with
+// FLUTTER_NATIVE_UTILS_FEATURE_KEYS, and the WMI thread only with
+// FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE. A multi-window app runs one
+// engine, and so one plugin instance, per window; they all acquire the same
+// hub, which is destroyed when the last of them releases it. Each backend is still
+// created on first use and recorded on the shared timeline.
+//
+// Work posted to the shared pool outlives the engine that posted it, so it
+// must deliver results through that engine's EngineRoute and must not hold
+// a reference to the hub itself: the destructor joins the pool, which a
+// worker cannot do for its own thread. Thread-safe.
+class BackendHub {
+ public:
+  // Returns the process-wide hub, creating it with |options| if no engine
+  // holds one. Callers that find a live hub share it; their |options| are
+  // ignored.
+  static std::shared_ptr<BackendHub> Acquire(
+      const BackendHubOptions& options = BackendHubOptions());
+
+  // Joins the workers, discarding tasks that have not started, then
+  // destroys the backends.
+  ~BackendHub();
+
+  // Disallow copy and assign.
+  BackendHub(const BackendHub&) = delete;
+  BackendHub& operator=(const BackendHub&) = delete;
+
+  StartupTimeline& timeline() { return timeline_; }
+
+  // Each creates its backend on first use; see LazyBackend::Get.
+  WorkerPool* workers(StartupPhase phase = StartupPhase::kFirstUse);
+  FileHasher* hasher(StartupPhase phase = StartupPhase::kFirstUse);
+  ManifestVerifier* manifest_verifier(
+      StartupPhase phase = StartupPhase::kFirstUse);
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+  // Throws std::runtime_error if the chain engine cannot be created.
+  CertificateChainBuilder* chain_builder(
+      StartupPhase phase = StartupPhase::kFirstUse);
+  CertificateSigner* certificate_signer(
+      StartupPhase phase = StartupPhase::kFirstUse);
+#endif
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+  // Enumerates the key store only when first listed.
+  KeyIndex* key_index(StartupPhase phase = StartupPhase::kFirstUse);
+  // The data keys every engine has unwrapped with the index's keys.
+  DataKeyCache* data_keys(StartupPhase phase = StartupPhase::kFirstUse);
+
+  // The filter SignNonce turns replayed nonces away with, or null while
+  // replays are allowed. Shared, so a nonce cannot be replayed through
+  // another engine.
+  std::shared_ptr<NonceReplayFilter> nonce_filter();
+  void set_nonce_filter(std::shared_ptr<NonceReplayFilter> filter);
+
+  // Opens the encrypted key-value store in |directory| under |key_name| (see
+  // EncryptedKvStore::Open), compacting on the shared pool, or shares the
+  // one already open there, and returns a new handle to it. Engines share
+  // stores, as a directory may only be open once. Throws
+  // std::invalid_argument if it is open under another key, and as Open
+  // does.
+  int64_t OpenKvStore(const std::string& directory,
+                      const std::string& key_name);
+  // The store |handle| refers to, or null if it is closed or unknown.
+  std::shared_ptr<EncryptedKvStore> kv_store(int64_t handle);
+  // Closes |handle|; the store closes with its last handle, once calls
+  // already using it return. Returns false if it was not open.
+  bool CloseKvStore(int64_t handle);
+#endif
+  // The pool if something has created it; never creates.
+  WorkerPool* workers_if_created() { return workers_.GetIfCreated(); }
+#if defined(_WIN32) && defined(FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE)
+  // One long-lived thread in the multithreaded COM apartment that runs
+  // every engine's WMI queries. Throws std::runtime_error if it cannot join
+  // the apartment.
+  AffineExecutor<WmiSession>* wmi(StartupPhase phase = StartupPhase::kFirstUse);
+  // The WMI thread if something has created it; never creates.
+  AffineExecutor<WmiSession>* wmi_if_created() { return wmi_.GetIfCreated(); }
+#endif
+
+  // The names Prewarm accepts in this build: "workers", "fileHasher",
+  // "manifestVerifier", "certificateChains", "certificateSigner",
+  // "keyIndex" and, on Windows, "wmi", less those of disabled features.
+  static std::vector<std::string> PrewarmableBackends();
+
+  // Creates the backend named |backend| (one of PrewarmableBackends();
+  // "keyIndex" is also loaded, and "wmi" also connected) ahead of first use. Returns false for any
+  // other name. Creation failures propagate as from the accessors.
+  bool Prewarm(const std::string& backend);
+
+  // The process-wide call recorder, or null if recording is off or its log
+  // could not be created.
+  MethodCallRecorder* call_recorder() { return call_recorder_.get(); }
+
+ private:
+  explicit BackendHub(const BackendHubOptions& options);
+
+  void OpenCallLog(const std::string& path);
+
+  // Declared first: every backend records on it.
+  StartupTimeline timeline_;
+  LazyBackend<WorkerPool> workers_;
+#if defined(_WIN32) && defined(FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE)
+  LazyBackend<AffineExecutor<WmiSession>> wmi_;
+#endif
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+  LazyBackend<CertificateChainBuilder> chain_builder_;
+  LazyBackend<CertificateSigner> certificate_signer_;
+#endif
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+  LazyBackend<KeyIndex> key_index_;
+  LazyBackend<DataKeyCache> data_keys_;
+  std::mutex nonce_filter_mutex_;
+  std::shared_ptr<NonceReplayFilter> nonce_filter_;
+  std::mutex kv_stores_mutex_;
+  std::map<int64_t, std::shared_ptr<EncryptedKvStore>> kv_stores_;
+  int64_t next_kv_store_ = 1;
+#endif
+  LazyBackend<FileHasher> hasher_;
+  LazyBackend<ManifestVerifier> manifest_verifier_;
+  std::unique_ptr<MethodCallRecorder> call_recorder_;
+};
+
+// Routes the results of shared-backend work back to one engine. Results are
+// run by the engine's poster (on Windows, its PlatformTaskRunner) until the
+// engine closes the route; after that they are dropped, so work that
+// finishes after its window closed cannot reach a destroyed plugin.
+// Thread-safe.
+class EngineRoute : public std::enable_shared_from_this<EngineRoute> {
+ public:
+  // Runs |task| on the engine's platform thread.
+  using Poster = std::function<void(std::function<void()> task)>;
+
+  // Keeps the route open while worker code uses engine state directly.
+  class Hold {
+   public:
+    Hold(Hold&& other) noexcept : route_(other.route_) {
+      other.route_ = nullptr;
+    }
+    ~Hold();
+
+    Hold(const Hold&) = delete;
+    Hold& operator=(const Hold&) = delete;
+    Hold& operator=(Hold&&) = delete;
+
+    // False if the route was already closed; the engine state must not be
+    // touched then.
+    explicit operator bool() const { return route_ != nullptr; }
+
+   private:
+    friend class EngineRoute;
+    explicit Hold(EngineRoute* route) : route_(route) {}
+
+    EngineRoute* route_;
+  };
+
+  static std::shared_ptr<EngineRoute> Create(Poster poster);
+
+  // Disallow copy and assign.
+  EngineRoute(const EngineRoute&) = delete;
+  EngineRoute& operator=(const EngineRoute&) = delete;
+
+  // Hands |task| to the poster unless the route is closed, in which case it
+  // is destroyed on the calling thread. A task already handed over is
+  // skipped if the route closes before it runs. Returns whether it was
+  // handed over.
+  bool Post(std::function<void()> task);
+
+  // See Hold.
+  Hold Enter();
+
+  // Drops results still to come and waits for outstanding holds. Call on
+  // the platform thread before the poster's target goes away. Idempotent.
+  void Close();
+
+  bool closed() const;
+
+ private:
+  explicit EngineRoute(Poster poster) : poster_(std::move(poster)) {}
+
+  void Release();
+
+  const Poster poster_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable released_;
+  // Written under |mutex_|; read without it by tasks already handed over.
+  std::atomic<bool> closed_{false};
+  size_t holds_ = 0;
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_BACKEND_HUB_H_
@@ -0,0 +1,93 @@
+// AES-256-GCM throughput for the bulk, parallel and streaming paths. The bulk
+// figures include allocating and first-touching the output buffer.
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "aes_gcm.h"
+#include "benchmarks.h"
+#include "worker_pool.h"
+
+namespace flutter_native_utils {
+namespace benchmark {
+
+namespace {
+
+// Raw AES-GCM speed on pre-faulted buffers, one core.
+void RunCipher(const std::vector<uint8_t>& plaintext) {
+  AesGcmCipher cipher(AesGcmKey{});
+  uint8_t nonce[kAesGcmNonceLen] = {};
+  const size_t chunk_len = kAesGcmDefaultChunkLen;
+  std::vector<uint8_t> out(chunk_len + kAesGcmTagLen);
+
+  Stopwatch stopwatch;
+  for (size_t offset = 0; offset + chunk_len <= plaintext.size();
+       offset += chunk_len) {
+    nonce[0]++;
+    cipher.Seal(nonce, nullptr, 0, plaintext.data() + offset, chunk_len,
+                out.data());
+  }
+  PrintThroughput("cipher only (per core)",
+                  static_cast<double>(plaintext.size()), stopwatch.Seconds());
+}
+
+void RunBulk(const std::vector<uint8_t>& plaintext, size_t threads) {
+  WorkerPool pool(threads);
+  AesGcmKey key = {};
+  const double bytes = static_cast<double>(plaintext.size());
+  const std::string suffix = " x" + std::to_string(pool.thread_count());
+
+  // The API takes ownership of its input, so copies are made up front to
+  // keep them out of the measurement.
+  std::vector<uint8_t> input = plaintext;
+  Stopwatch encrypt;
+  std::vector<uint8_t> ciphertext =
+      AesGcmEncrypt(key, std::move(input), {}, &pool);
+  PrintThroughput("encrypt" + suffix, bytes, encrypt.Seconds());
+
+  std::vector<uint8_t> decrypted;
+  Stopwatch decrypt;
+  bool ok = AesGcmDecrypt(key, std::move(ciphertext), {}, &pool, &decrypted);
+  PrintThroughput(std::string(ok ? "decrypt" : "decrypt FAILED") + suffix,
+                  bytes, decrypt.Seconds());
+}
+
+void RunStream(const std::vector<uint8_t>& plaintext) {
+  AesGcmKey key = {};
+  // Typical platform-channel message size.
+  constexpr size_t kPieceLen = 256 << 10;
+  std::vector<uint8_t> out;
+  out.reserve(AesGcmCiphertextLen(plaintext.size(), kAesGcmDefaultChunkLen));
+
+  Stopwatch stopwatch;
+  AesGcmStreamEncryptor encryptor(key, {});
+  for (size_t offset = 0; offset < plaintext.size(); offset += kPieceLen) {
+    size_t piece = plaintext.size() - offset;
+    if (piece > kPieceLen) piece = kPieceLen;
+    encryptor.Update(plaintext.data() + offset, piece, &out);
+  }
+  encryptor.Finish(&out);
+  PrintThroughput("stream encrypt (256 KiB updates)",
+                  static_cast<double>(plaintext.size()), stopwatch.Seconds());
+}
+
+}  // namespace
+
+void RunAesGcmBenchmarks(const BenchmarkOptions& options) {
+  const size_t size = static_cast<size_t>(256.0 * options.scale) << 20;
+  std::vector<uint8_t> plaintext(size);
+  for (size_t i = 0; i < size; ++i) plaintext[i] = static_cast<uint8_t>(i);
+
+  std::printf(" %zu MiB, %zu KiB chunks\n", size >> 20,
+              kAesGcmDefaultChunkLen >> 10);
+  RunCipher(plaintext);
+  RunBulk(plaintext, 1);
+  if (std::thread::hardware_concurrency() > 1) RunBulk(plaintext, 0);
+  RunStream(plaintext);
+}
+
+}  // namespace benchmark
+}  // namespace flutter_native_utils
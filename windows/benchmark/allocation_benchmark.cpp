@@ -0,0 +1,224 @@
+// Heap allocations per call of the portable work behind the busiest channel
+// methods: decoding the arguments the Dart side sends, the backend call and
+// encoding the reply with the standard codec. The plugin's handlers do not
+// build on this host; the plugin test budgets them through HandleMethodCall
+// (BusiestMethodsStayWithinAllocationBudgets). Each method has a budget of
+// allocations per call; exceeding it fails the run, so CTest catches a
+// backend or the codec starting to allocate more. Counts only cover the
+// calling thread; see AllocationScope.
+
+#include <cinttypes>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "aes_gcm.h"
+#include "allocation_stats.h"
+#include "benchmarks.h"
+#include "buffered_random.h"
+#include "hmac_session.h"
+#include "standard_codec.h"
+#include "worker_pool.h"
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+#include "certificate_index.h"
+#endif
+
+namespace flutter_native_utils {
+namespace benchmark {
+
+namespace {
+
+struct Scenario {
+  const char* method;
+  // Most allocations one call may make, with some headroom over what it
+  // makes today.
+  double budget;
+  std::function<void()> call;
+};
+
+// Encoded arguments, as they arrive over the channel.
+std::vector<uint8_t> EncodeArguments(CodecMap args) {
+  return EncodeStandardValue(CodecValue(std::move(args)));
+}
+
+CodecMap DecodeArguments(const std::vector<uint8_t>& encoded) {
+  return std::get<CodecMap>(DecodeStandardValue(encoded.data(), encoded.size()));
+}
+
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+std::vector<CertificateInfo> MakeCertificates(size_t count) {
+  std::vector<CertificateInfo> certificates(count);
+  for (size_t i = 0; i < count; ++i) {
+    CertificateInfo& info = certificates[i];
+    info.thumbprint = std::string(40, "0123456789ABCDEF"[i % 16]);
+    info.subject = "CN=user" + std::to_string(i) + "@example.com, O=Tenant " +
+                   std::to_string(i % 97);
+    info.issuer = "CN=Issuing CA " + std::to_string(i % 8);
+    info.serial_number = std::to_string(i + 1);
+    info.not_before = 1600000000000LL;
+    info.not_after = 1900000000000LL;
+    info.ekus = {"1.3.6.1.5.5.7.3.2"};
+    info.has_private_key = i % 2 == 0;
+  }
+  return certificates;
+}
+
+CodecValue CertificateInfoToValue(const CertificateInfo& info) {
+  CodecList ekus(info.ekus.begin(), info.ekus.end());
+  return CodecMap{
+      {"thumbprint", info.thumbprint},
+      {"subject", info.subject},
+      {"issuer", info.issuer},
+      {"serialNumber", info.serial_number},
+      {"notBefore", info.not_before},
+      {"notAfter", info.not_after},
+      {"ekus", std::move(ekus)},
+      {"hasPrivateKey", info.has_private_key},
+      {"storeLocation", CertificateStoreLocationName(info.location)},
+  };
+}
+#endif
+
+bool RunScenario(const Scenario& scenario, size_t calls) {
+  // The first call creates per-thread and per-process state a long-running
+  // plugin only creates once.
+  scenario.call();
+  ResetAllocationStats();
+  for (size_t i = 0; i < calls; ++i) {
+    AllocationScope scope(scenario.method);
+    scenario.call();
+  }
+  std::vector<MethodAllocationStats> snapshot = AllocationStatsSnapshot();
+  if (snapshot.size() != 1 || snapshot[0].calls != calls) {
+    std::printf("  %-44s  not counted\n", scenario.method);
+    return false;
+  }
+  const MethodAllocationStats& stats = snapshot[0];
+  const double n = static_cast<double>(stats.calls);
+  const double per_call = static_cast<double>(stats.allocations) / n;
+  const bool within = per_call <= scenario.budget;
+  std::printf("  %-44s %8.1f allocs %10.0f B  peak %8" PRIu64
+              " B  (budget %.0f)%s\n",
+              scenario.method, per_call,
+              static_cast<double>(stats.bytes) / n, stats.peak_bytes,
+              scenario.budget, within ? "" : "  OVER BUDGET");
+  return within;
+}
+
+}  // namespace
+
+void RunAllocationBenchmarks(const BenchmarkOptions& options) {
+  if (!AllocationTrackingEnabled()) {
+    std::printf("  allocation_hooks.cpp is not linked; nothing to count\n");
+    return;
+  }
+  size_t calls = static_cast<size_t>(1000 * options.scale);
+  if (calls == 0) calls = 1;
+
+  WorkerPool pool;
+  const std::vector<uint8_t> key(32, 0x5a);
+  AesGcmKey aes_key;
+  aes_key.fill(0x33);
+  HmacSession session(MacAlgorithm::kHmacSha256, key.data(), key.size());
+
+  const std::vector<uint8_t> random_args =
+      EncodeArguments({{"length", int32_t{32}}});
+
+  CodecList messages;
+  for (int i = 0; i < 16; ++i) {
+    messages.push_back(std::vector<uint8_t>(256, static_cast<uint8_t>(i)));
+  }
+  const std::vector<uint8_t> hmac_args =
+      EncodeArguments({{"sessionId", int32_t{1}}, {"messages", messages}});
+
+  // The handler unwraps the data key once and caches it by name and wrapped
+  // bytes, so a call only looks it up.
+  const std::vector<uint8_t> wrapped_key(256, 0x44);
+  std::string cached_key_name = "data-key";
+  cached_key_name.push_back('\0');
+  cached_key_name.append(wrapped_key.begin(), wrapped_key.end());
+  const std::unordered_map<std::string, AesGcmKey> data_keys = {
+      {cached_key_name, aes_key}};
+  const std::vector<uint8_t> encrypt_args =
+      EncodeArguments({{"keyName", "data-key"},
+                       {"wrappedKey", wrapped_key},
+                       {"data", std::vector<uint8_t>(4096, 7)}});
+
+  std::vector<Scenario> scenarios = {
+      {"GetRandomBytes", 8,
+       [&]() {
+         CodecMap args = DecodeArguments(random_args);
+         std::vector<uint8_t> bytes(static_cast<size_t>(
+             std::get<int32_t>(*FindCodecMapValue(args, "length"))));
+         FillRandomBuffered(bytes.data(), bytes.size());
+         EncodeStandardValue(CodecValue(std::move(bytes)));
+       }},
+      {"ComputeHmacs", 32,
+       [&]() {
+         CodecMap args = DecodeArguments(hmac_args);
+         const auto& list =
+             std::get<CodecList>(*FindCodecMapValue(args, "messages"));
+         std::vector<MacMessage> views;
+         views.reserve(list.size());
+         for (const CodecValue& item : list) {
+           const auto& bytes = std::get<std::vector<uint8_t>>(item);
+           views.push_back(MacMessage{bytes.data(), bytes.size()});
+         }
+         std::vector<uint8_t> macs = session.ComputeBatch(views);
+         EncodeStandardValue(CodecValue(std::move(macs)));
+       }},
+      {"Encrypt", 28,
+       [&]() {
+         CodecMap args = DecodeArguments(encrypt_args);
+         const auto& wrapped = std::get<std::vector<uint8_t>>(
+             *FindCodecMapValue(args, "wrappedKey"));
+         std::string cache_key =
+             std::get<std::string>(*FindCodecMapValue(args, "keyName"));
+         cache_key.push_back('\0');
+         cache_key.append(wrapped.begin(), wrapped.end());
+         const AesGcmKey& key = data_keys.at(cache_key);
+         std::vector<uint8_t> plaintext = std::get<std::vector<uint8_t>>(
+             *FindCodecMapValue(args, "data"));
+         std::vector<uint8_t> ciphertext =
+             AesGcmEncrypt(key, std::move(plaintext), {}, &pool);
+         EncodeStandardValue(CodecValue(std::move(ciphertext)));
+       }},
+  };
+
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+  CertificateIndex index(MakeCertificates(5000));
+  const std::vector<uint8_t> enumerate_args = EncodeArguments(
+      {{"subjectContains", "tenant 1"}, {"pageSize", int32_t{100}}});
+  scenarios.push_back(
+      {"EnumerateCertificates", 2048, [&]() {
+         CodecMap args = DecodeArguments(enumerate_args);
+         CertificateFilter filter;
+         filter.subject_contains =
+             std::get<std::string>(*FindCodecMapValue(args, "subjectContains"));
+         CertificatePage page = index.Query(
+             filter, 0,
+             static_cast<size_t>(
+                 std::get<int32_t>(*FindCodecMapValue(args, "pageSize"))));
+         CodecList certificates;
+         certificates.reserve(page.certificates.size());
+         for (const CertificateInfo& info : page.certificates) {
+           certificates.push_back(CertificateInfoToValue(info));
+         }
+         EncodeStandardValue(CodecMap{
+             {"certificates", std::move(certificates)},
+             {"nextPageToken", CodecValue()},
+         });
+       }});
+#endif
+
+  for (const Scenario& scenario : scenarios) {
+    if (!RunScenario(scenario, calls)) {
+      ReportFailure(std::string("allocation budget of ") + scenario.method);
+    }
+  }
+}
+
+}  // namespace benchmark
+}  // namespace flutter_native_utils
@@ -0,0 +1,79 @@
+// Throughput benchmarks for the plugin's portable sources.
+//
+// Usage: flutter_native_utils_benchmark [suite ...] [--scale=FACTOR]
+// Runs every suite when none is named. Exits non-zero if a suite reported a
+// failure, e.g. an allocation budget being exceeded.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "benchmarks.h"
+
+namespace {
+
+using flutter_native_utils::benchmark::BenchmarkOptions;
+
+struct Suite {
+  const char* name;
+  void (*run)(const BenchmarkOptions& options);
+};
+
+const Suite kSuites[] = {
+    {"aes-gcm", flutter_native_utils::benchmark::RunAesGcmBenchmarks},
+    {"allocation", flutter_native_utils::benchmark::RunAllocationBenchmarks},
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+    {"certificate",
+     flutter_native_utils::benchmark::RunCertificateBenchmarks},
+#endif
+    {"hash", flutter_native_utils::benchmark::RunHashBenchmarks},
+    {"hmac", flutter_native_utils::benchmark::RunHmacBenchmarks},
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+    {"kv-store", flutter_native_utils::benchmark::RunKvStoreBenchmarks},
+#endif
+    {"manifest", flutter_native_utils::benchmark::RunManifestBenchmarks},
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+    {"nonce-filter",
+     flutter_native_utils::benchmark::RunNonceFilterBenchmarks},
+#endif
+    {"random", flutter_native_utils::benchmark::RunRandomBenchmarks},
+    {"signature", flutter_native_utils::benchmark::RunSignatureBenchmarks},
+};
+
+int failures = 0;
+
+}  // namespace
+
+namespace flutter_native_utils {
+namespace benchmark {
+
+void ReportFailure(const std::string& what) {
+  std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+  ++failures;
+}
+
+}  // namespace benchmark
+}  // namespace flutter_native_utils
+
+int main(int argc, char** argv) {
+  BenchmarkOptions options;
+  std::vector<std::string> selected;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strncmp(argv[i], "--scale=", 8) == 0) {
+      options.scale = std::atof(argv[i] + 8);
+    } else {
+      selected.push_back(argv[i]);
+    }
+  }
+
+  for (const Suite& suite : kSuites) {
+    bool run = selected.empty();
+    for (const std::string& name : selected) run = run || name == suite.name;
+    if (!run) continue;
+    std::printf("[%s]\n", suite.name);
+    suite.run(options);
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+#ifndef FLUTTER_PLUGIN_BENCHMARKS_H_
+#define FLUTTER_PLUGIN_BENCHMARKS_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+namespace flutter_native_utils {
+namespace benchmark {
+
+struct BenchmarkOptions {
+  // Multiplies the amount of work each suite does (e.g. --scale=0.1 for a
+  // quick smoke run).
+  double scale = 1.0;
+};
+
+// Wall-clock stopwatch used by the suites.
+class Stopwatch {
+ public:
+  Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+  double Seconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start_)
+        .count();
+  }
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+};
+
+inline void PrintThroughput(const std::string& name, double bytes,
+                            double seconds) {
+  std::printf("  %-44s %10.1f MB/s  (%.3f s)\n", name.c_str(),
+              bytes / seconds / 1e6, seconds);
+}
+
+inline void PrintRate(const std::string& name, double count, double seconds) {
+  std::printf("  %-44s %10.0f ops/s  (%.3f s)\n", name.c_str(),
+              count / seconds, seconds);
+}
+
+// Fails the run: the benchmark exits non-zero once every suite has run.
+void ReportFailure(const std::string& what);
+
+// One entry point per suite; each prints its own results.
+void RunAesGcmBenchmarks(const BenchmarkOptions& options);
+void RunAllocationBenchmarks(const BenchmarkOptions& options);
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+void RunCertificateBenchmarks(const BenchmarkOptions& options);
+#endif
+void RunHashBenchmarks(const BenchmarkOptions& options);
+void RunHmacBenchmarks(const BenchmarkOptions& options);
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+void RunKvStoreBenchmarks(const BenchmarkOptions& options);
+#endif
+void RunManifestBenchmarks(const BenchmarkOptions& options);
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+void RunNonceFilterBenchmarks(const BenchmarkOptions& options);
+#endif
+void RunRandomBenchmarks(const BenchmarkOptions& options);
+void RunSignatureBenchmarks(const BenchmarkOptions& options);
+
+}  // namespace benchmark
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_BENCHMARKS_H_
@@ -0,0 +1,200 @@
+// Measures projecting a large PEM directory into a CertificateIndex, the
+// cost of filtered, paged queries against it, and signing with a cached
+// versus a freshly opened certificate key.
+
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "benchmarks.h"
+#include "certificate_index.h"
+#include "certificate_signer.h"
+
+namespace flutter_native_utils {
+namespace benchmark {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// Certificates per PEM file; stores of this size are usually bundles.
+constexpr size_t kCertificatesPerFile = 100;
+
+X509* MakeCertificate(EVP_PKEY* key, size_t serial) {
+  X509* cert = X509_new();
+  X509_set_version(cert, 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(cert), static_cast<long>(serial + 1));
+  // Staggered validity so window filters select a fraction of the store.
+  X509_gmtime_adj(X509_getm_notBefore(cert),
+                  -static_cast<long>(serial % 1000) * 86400L);
+  X509_gmtime_adj(X509_getm_notAfter(cert),
+                  (static_cast<long>(serial % 730) - 180) * 86400L);
+
+  X509_NAME* subject = X509_get_subject_name(cert);
+  std::string org = "Tenant " + std::to_string(serial % 97);
+  std::string cn = "user" + std::to_string(serial) + "@example.com";
+  X509_NAME_add_entry_by_txt(subject, "O", MBSTRING_ASC,
+                             reinterpret_cast<const unsigned char*>(org.c_str()),
+                             -1, -1, 0);
+  X509_NAME_add_entry_by_txt(subject, "CN", MBSTRING_ASC,
+                             reinterpret_cast<const unsigned char*>(cn.c_str()),
+                             -1, -1, 0);
+  X509_NAME* issuer = X509_get_issuer_name(cert);
+  std::string ca = "Issuing CA " + std::to_string(serial % 8);
+  X509_NAME_add_entry_by_txt(issuer, "CN", MBSTRING_ASC,
+                             reinterpret_cast<const unsigned char*>(ca.c_str()),
+                             -1, -1, 0);
+
+  X509_EXTENSION* eku = X509V3_EXT_conf_nid(
+      nullptr, nullptr, NID_ext_key_usage,
+      serial % 3 == 0 ? "serverAuth" : "clientAuth,emailProtection");
+  X509_add_ext(cert, eku, -1);
+  X509_EXTENSION_free(eku);
+
+  X509_set_pubkey(cert, key);
+  X509_sign(cert, key, EVP_sha256());
+  return cert;
+}
+
+void WriteStore(const fs::path& root, size_t count) {
+  EVP_PKEY* key = EVP_EC_gen("P-256");
+  for (size_t file = 0; file * kCertificatesPerFile < count; ++file) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "bundle%05zu", file);
+    fs::path path = root / (std::string(name) + ".pem");
+    FILE* out = std::fopen(path.string().c_str(), "w");
+    for (size_t i = file * kCertificatesPerFile;
+         i < count && i < (file + 1) * kCertificatesPerFile; ++i) {
+      X509* cert = MakeCertificate(key, i);
+      PEM_write_X509(out, cert);
+      X509_free(cert);
+    }
+    std::fclose(out);
+    // Every other bundle has a key, so has-private-key halves the store.
+    if (file % 2 == 0) {
+      std::ofstream(root / (std::string(name) + ".key")) << "placeholder\n";
+    }
+  }
+  EVP_PKEY_free(key);
+}
+
+// Signs one digest per iteration with an EC client key, reopening the key
+// each time unless |cached|, as re-importing a PFX per handshake does.
+void RunSigningBenchmark(const fs::path& root, size_t iterations) {
+  fs::create_directories(root);
+  EVP_PKEY* key = EVP_EC_gen("P-256");
+  X509* cert = MakeCertificate(key, 0);
+  FILE* out = std::fopen((root / "client.pem").string().c_str(), "w");
+  PEM_write_X509(out, cert);
+  std::fclose(out);
+  out = std::fopen((root / "client.key").string().c_str(), "w");
+  PEM_write_PrivateKey(out, key, nullptr, nullptr, 0, nullptr, nullptr);
+  std::fclose(out);
+  uint8_t sha1[EVP_MAX_MD_SIZE];
+  unsigned int sha1_len = 0;
+  X509_digest(cert, EVP_sha1(), sha1, &sha1_len);
+  X509_free(cert);
+  EVP_PKEY_free(key);
+  std::string thumbprint;
+  for (unsigned int i = 0; i < sha1_len; ++i) {
+    char hex[3];
+    std::snprintf(hex, sizeof(hex), "%02X", sha1[i]);
+    thumbprint += hex;
+  }
+
+  CertificateSigner signer(root.string());
+  const std::vector<uint8_t> digest(SignatureHashLength(SignatureHash::kSha256),
+                                    0x5a);
+  for (bool cached : {false, true}) {
+    Stopwatch time;
+    for (size_t i = 0; i < iterations; ++i) {
+      if (!cached) signer.Clear();
+      signer.Key(thumbprint)->SignDigest(SignatureHash::kSha256,
+                                         SignaturePadding::kPkcs1,
+                                         digest.data(), digest.size());
+    }
+    PrintRate(cached ? "sign, cached key" : "sign, key opened per call",
+              static_cast<double>(iterations), time.Seconds());
+  }
+}
+
+}  // namespace
+
+void RunCertificateBenchmarks(const BenchmarkOptions& options) {
+  const size_t count = static_cast<size_t>(50000.0 * options.scale) + 1;
+  const fs::path root = fs::temp_directory_path() / "fnu_bench_certificates";
+  fs::remove_all(root);
+  fs::create_directories(root);
+  WriteStore(root, count);
+  std::printf(" %zu certificates in %zu PEM files\n", count,
+              (count + kCertificatesPerFile - 1) / kCertificatesPerFile);
+
+  Stopwatch read_time;
+  std::vector<CertificateInfo> certificates = ReadPemDirectory(root.string());
+  PrintRate("project PEM directory (certs)",
+            static_cast<double>(certificates.size()), read_time.Seconds());
+
+  Stopwatch build_time;
+  CertificateIndex index(std::move(certificates));
+  PrintRate("build index (certs)", static_cast<double>(index.size()),
+            build_time.Seconds());
+
+  const int64_t now = static_cast<int64_t>(std::time(nullptr)) * 1000;
+  struct Case {
+    const char* label;
+    CertificateFilter filter;
+  };
+  std::vector<Case> cases(4);
+  cases[0].label = "first page, unfiltered";
+  cases[1].label = "first page, client cert picker";
+  cases[1].filter.eku = "clientAuth";
+  cases[1].filter.has_private_key = true;
+  cases[1].filter.valid_from = now;
+  cases[1].filter.issuer_contains = "issuing ca 3";
+  cases[2].label = "first page, selective subject";
+  cases[2].filter.subject_contains = "USER4999";
+  cases[3].label = "first page, no match (full scan)";
+  cases[3].filter.subject_contains = "nobody@";
+
+  const size_t iterations = static_cast<size_t>(200.0 * options.scale) + 1;
+  for (const Case& test : cases) {
+    size_t returned = 0;
+    Stopwatch time;
+    for (size_t i = 0; i < iterations; ++i) {
+      returned = index.Query(test.filter, 0, 100).certificates.size();
+    }
+    char label[96];
+    std::snprintf(label, sizeof(label), "%s (%zu)", test.label, returned);
+    PrintRate(label, static_cast<double>(iterations), time.Seconds());
+  }
+
+  // Pages through every match, as a picker scrolling to the end would.
+  Stopwatch page_time;
+  size_t pages = 0;
+  size_t matched = 0;
+  for (size_t cursor = 0;; ++pages) {
+    CertificatePage page = index.Query(cases[1].filter, cursor, 100);
+    matched += page.certificates.size();
+    cursor = page.next_cursor;
+    if (page.done) break;
+  }
+  char label[96];
+  std::snprintf(label, sizeof(label), "page through picker matches (%zu)",
+                matched);
+  PrintRate(label, static_cast<double>(pages + 1), page_time.Seconds());
+
+  RunSigningBenchmark(root / "signing", iterations * 5);
+
+  fs::remove_all(root);
+}
+
+}  // namespace benchmark
+}  // namespace flutter_native_utils
@@ -0,0 +1,103 @@
+// Compares FileHasher against the coreutils sha256sum binary.
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmarks.h"
+#include "file_hasher.h"
+
+namespace flutter_native_utils {
+namespace benchmark {
+
+namespace {
+
+std::vector<std::string> WriteFiles(const std::string& prefix, size_t count,
+                                    size_t size) {
+  std::vector<std::string> paths;
+  std::vector<char> buffer(size);
+  uint32_t state = 0x12345678;
+  for (char& c : buffer) {
+    state = state * 1664525u + 1013904223u;
+    c = static_cast<char>(state >> 24);
+  }
+  for (size_t i = 0; i < count; ++i) {
+    auto path = std::filesystem::temp_directory_path() /
+                (prefix + std::to_string(i) + ".bin");
+    std::ofstream file(path, std::ios::binary);
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    paths.push_back(path.string());
+  }
+  return paths;
+}
+
+void RemoveFiles(const std::vector<std::string>& paths) {
+  for (const auto& path : paths) std::remove(path.c_str());
+}
+
+void RunFileHasher(const std::string& label,
+                   const std::vector<std::string>& paths, double bytes,
+                   HashAlgorithm algorithm, size_t threads) {
+  FileHasher hasher(threads);
+  // Warm the page cache so that every run measures hashing, not the disk.
+  hasher.HashFiles(paths, algorithm);
+  Stopwatch stopwatch;
+  hasher.HashFiles(paths, algorithm);
+  PrintThroughput(label + " x" + std::to_string(hasher.thread_count()), bytes,
+                  stopwatch.Seconds());
+}
+
+void RunSha256sum(const std::string& label,
+                  const std::vector<std::string>& paths, double bytes) {
+  std::string command = "sha256sum";
+  for (const auto& path : paths) command += " '" + path + "'";
+  command += " > /dev/null";
+  Stopwatch stopwatch;
+  if (std::system(command.c_str()) != 0) {
+    std::printf("  %-44s unavailable\n", label.c_str());
+    return;
+  }
+  PrintThroughput(label, bytes, stopwatch.Seconds());
+}
+
+}  // namespace
+
+void RunHashBenchmarks(const BenchmarkOptions& options) {
+  const size_t hardware_threads =
+      std::thread::hardware_concurrency() ? std::thread::hardware_concurrency()
+                                          : 1;
+
+  // One large file exercises intra-file parallelism (BLAKE3 only); many
+  // medium files exercise inter-file parallelism.
+  const size_t large_size = static_cast<size_t>(256.0 * options.scale) << 20;
+  const size_t many_count = static_cast<size_t>(64.0 * options.scale) + 1;
+  auto large = WriteFiles("fnu_bench_large_", 1, large_size);
+  auto many = WriteFiles("fnu_bench_many_", many_count, 4 << 20);
+  const double large_bytes = static_cast<double>(large_size);
+  const double many_bytes = static_cast<double>(many_count) * (4 << 20);
+
+  std::printf(" 1 file, %zu MiB\n", large_size >> 20);
+  RunSha256sum("sha256sum", large, large_bytes);
+  RunFileHasher("FileHasher sha256", large, large_bytes, HashAlgorithm::kSha256, 1);
+  RunFileHasher("FileHasher blake3", large, large_bytes, HashAlgorithm::kBlake3, 1);
+  RunFileHasher("FileHasher blake3", large, large_bytes, HashAlgorithm::kBlake3,
+                hardware_threads);
+
+  std::printf(" %zu files, 4 MiB each\n", many_count);
+  RunSha256sum("sha256sum", many, many_bytes);
+  RunFileHasher("FileHasher sha256", many, many_bytes, HashAlgorithm::kSha256, 1);
+  RunFileHasher("FileHasher sha256", many, many_bytes, HashAlgorithm::kSha256,
+                hardware_threads);
+  RunFileHasher("FileHasher blake3", many, many_bytes, HashAlgorithm::kBlake3,
+                hardware_threads);
+
+  RemoveFiles(large);
+  RemoveFiles(many);
+}
+
+}  // namespace benchmark
+}  // namespace flutter_native_utils
@@ -0,0 +1,69 @@
+// HMAC messages per second at typical API-request sizes: a reused session
+// against re-keying for every message, and batch verification.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "benchmarks.h"
+#include "hmac_session.h"
+
+namespace flutter_native_utils {
+namespace benchmark {
+
+namespace {
+
+void RunSize(MacAlgorithm algorithm, const char* name, size_t message_len,
+             size_t count) {
+  const std::vector<uint8_t> key(32, 0x5a);
+  std::vector<uint8_t> body(count * message_len);
+  for (size_t i = 0; i < body.size(); ++i) body[i] = static_cast<uint8_t>(i);
+  std::vector<MacMessage> messages(count);
+  for (size_t i = 0; i < count; ++i) {
+    messages[i] = MacMessage{body.data() + i * message_len, message_len};
+  }
+  const std::string suffix =
+      std::string(" ") + name + " " + std::to_string(message_len) + " B";
+  const double n = static_cast<double>(count);
+
+  uint8_t mac[64];
+  Stopwatch rekey;
+  for (const MacMessage& message : messages) {
+    HmacSession session(algorithm, key.data(), key.size());
+    session.Compute(message.data, message.len, mac);
+  }
+  PrintRate("re-key per message" + suffix, n, rekey.Seconds());
+
+  HmacSession session(algorithm, key.data(), key.size());
+  Stopwatch batch;
+  std::vector<uint8_t> macs = session.ComputeBatch(messages);
+  PrintRate("session batch" + suffix, n, batch.Seconds());
+
+  std::vector<MacMessage> mac_views(count);
+  for (size_t i = 0; i < count; ++i) {
+    mac_views[i] = MacMessage{macs.data() + i * session.mac_len(),
+                              session.mac_len()};
+  }
+  Stopwatch verify;
+  std::vector<bool> valid = session.VerifyBatch(messages, mac_views);
+  size_t failed = 0;
+  for (bool ok : valid) failed += ok ? 0 : 1;
+  PrintRate(std::string(failed ? "verify batch FAILED" : "verify batch") +
+                suffix,
+            n, verify.Seconds());
+}
+
+}  // namespace
+
+void RunHmacBenchmarks(const BenchmarkOptions& options) {
+  size_t count = static_cast<size_t>(200000 * options.scale);
+  if (count == 0) count = 1;
+  std::printf(" %zu messages per run, one core\n", count);
+  for (size_t len : {64, 256, 1024}) {
+    RunSize(MacAlgorithm::kHmacSha256, "sha256", len, count);
+  }
+  RunSize(MacAlgorithm::kHmacSha512, "sha512", 256, count);
+}
+
+}  // namespace benchmark
+}  // namespace flutter_native_utils
@@ -0,0 +1,213 @@
+// The encrypted key-value store: write throughput one put at a time, synced
+// and not, in batches, and from concurrent writers sharing commits; read
+// throughput from one thread and several; a full scan; and a compaction of
+// overwritten keys.
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmarks.h"
+#include "encrypted_kv_store.h"
+#include "key_store.h"
+#include "worker_pool.h"
+
+namespace flutter_native_utils {
+namespace benchmark {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr size_t kValueLen = 256;
+
+std::string Key(size_t index) { return "cache/" + std::to_string(index); }
+
+// A value distinct per |index|, to check reads against.
+std::vector<uint8_t> Value(size_t index) {
+  std::vector<uint8_t> value(kValueLen);
+  for (size_t i = 0; i < value.size(); ++i) {
+    value[i] = static_cast<uint8_t>(index * 31 + i);
+  }
+  return value;
+}
+
+// A fresh store in its own directory under |root|.
+std::shared_ptr<EncryptedKvStore> OpenStore(const fs::path& root,
+                                            const std::string& name,
+                                            KeyIndex* keys, WorkerPool* pool,
+                                            bool sync,
+                                            size_t segment_bytes = 8 << 20) {
+  KvStoreOptions options;
+  options.sync = sync;
+  options.segment_bytes = segment_bytes;
+  return EncryptedKvStore::Open((root / name).string(), "kv", keys, pool,
+                                options);
+}
+
+void PrintWrites(const std::string& name, size_t writes, double seconds) {
+  PrintRate(name, static_cast<double>(writes), seconds);
+  PrintThroughput(name, static_cast<double>(writes * kValueLen), seconds);
+}
+
+// Puts |per_thread| keys from each of |threads| threads at once.
+void PutConcurrently(EncryptedKvStore* store, size_t threads,
+                     size_t per_thread) {
+  std::vector<std::thread> writers;
+  for (size_t t = 0; t < threads; ++t) {
+    writers.emplace_back([store, t, per_thread]() {
+      for (size_t i = 0; i < per_thread; ++i) {
+        const size_t index = t * per_thread + i;
+        store->Put(Key(index), Value(index));
+      }
+    });
+  }
+  for (std::thread& writer : writers) writer.join();
+}
+
+// Reads |per_thread| keys of the first |count| on each of |threads| threads;
+// returns the reads that did not find the value written.
+size_t GetConcurrently(EncryptedKvStore* store, size_t threads,
+                       size_t per_thread, size_t count) {
+  std::vector<size_t> wrong(threads);
+  std::vector<std::thread> readers;
+  for (size_t t = 0; t < threads; ++t) {
+    readers.emplace_back([store, &wrong, t, per_thread, count]() {
+      // A fixed stride through the keys rather than a sequential walk.
+      size_t index = t;
+      for (size_t i = 0; i < per_thread; ++i) {
+        index = (index + 7919) % count;
+        if (store->Get(Key(index)) != Value(index)) ++wrong[t];
+      }
+    });
+  }
+  for (std::thread& reader : readers) reader.join();
+  size_t total = 0;
+  for (size_t count_wrong : wrong) total += count_wrong;
+  return total;
+}
+
+void RunWrites(const fs::path& root, KeyIndex* keys, WorkerPool* pool,
+               size_t count) {
+  const size_t synced = std::max<size_t>(1, count / 20);
+  {
+    auto store = OpenStore(root, "synced", keys, pool, true);
+    Stopwatch watch;
+    for (size_t i = 0; i < synced; ++i) store->Put(Key(i), Value(i));
+    PrintWrites("put, synced", synced, watch.Seconds());
+  }
+  {
+    auto store = OpenStore(root, "unsynced", keys, pool, false);
+    Stopwatch watch;
+    for (size_t i = 0; i < count; ++i) store->Put(Key(i), Value(i));
+    PrintWrites("put, unsynced", count, watch.Seconds());
+  }
+  {
+    auto store = OpenStore(root, "batched", keys, pool, true);
+    constexpr size_t kBatch = 100;
+    Stopwatch watch;
+    for (size_t i = 0; i < count; i += kBatch) {
+      std::vector<KvWrite> batch;
+      for (size_t j = i; j < i + kBatch && j < count; ++j) {
+        batch.push_back({Key(j), Value(j)});
+      }
+      store->Write(std::move(batch));
+    }
+    PrintWrites("put, synced in batches of 100", count, watch.Seconds());
+  }
+  for (size_t threads : {2, 8}) {
+    auto store = OpenStore(root, "concurrent" + std::to_string(threads), keys,
+                           pool, true);
+    const size_t per_thread = std::max<size_t>(1, synced / threads);
+    Stopwatch watch;
+    PutConcurrently(store.get(), threads, per_thread);
+    const double seconds = watch.Seconds();
+    PrintWrites("put, synced x" + std::to_string(threads),
+                threads * per_thread, seconds);
+    // Group commit: how many writers shared each append and sync.
+    const KvStoreStats stats = store->stats();
+    std::printf("  %-44s %10.1f writes/commit\n",
+                ("group commit x" + std::to_string(threads)).c_str(),
+                static_cast<double>(stats.batches) /
+                    std::max<uint64_t>(1, stats.commits));
+  }
+}
+
+// Puts the first |count| keys in batches of 1000.
+void PutAll(EncryptedKvStore* store, size_t count) {
+  for (size_t i = 0; i < count; i += 1000) {
+    std::vector<KvWrite> batch;
+    for (size_t j = i; j < i + 1000 && j < count; ++j) {
+      batch.push_back({Key(j), Value(j)});
+    }
+    store->Write(std::move(batch));
+  }
+}
+
+void RunReads(const fs::path& root, KeyIndex* keys, size_t count) {
+  // Small segments, so most of the garbage below is in sealed ones; without
+  // a pool it is only compacted when asked.
+  auto store = OpenStore(root, "reads", keys, nullptr, false, 256 << 10);
+  PutAll(store.get(), count);
+
+  const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+  for (size_t threads = 1; threads <= 8 && threads <= cores; threads *= 2) {
+    Stopwatch watch;
+    const size_t wrong = GetConcurrently(store.get(), threads, count, count);
+    const double seconds = watch.Seconds();
+    const std::string name = "get x" + std::to_string(threads);
+    PrintWrites(wrong ? name + " FAILED" : name, threads * count, seconds);
+    if (wrong) ReportFailure("kv store returned a wrong value");
+  }
+
+  Stopwatch scan;
+  size_t scanned = 0;
+  std::string after;
+  for (bool done = false; !done;) {
+    KvScanPage page =
+        store->Scan("cache/", after, EncryptedKvStore::kMaxPageSize);
+    scanned += page.entries.size();
+    after = page.last;
+    done = page.done;
+  }
+  PrintWrites(scanned == count ? "scan" : "scan FAILED", scanned,
+              scan.Seconds());
+  if (scanned != count) ReportFailure("kv store scan missed keys");
+
+  // Every key written three more times: three quarters garbage.
+  for (int round = 0; round < 3; ++round) PutAll(store.get(), count);
+  const uint64_t before = store->stats().disk_bytes;
+  Stopwatch compaction;
+  store->Compact();
+  const double seconds = compaction.Seconds();
+  PrintThroughput("compact", static_cast<double>(before), seconds);
+  std::printf("  %-44s %10.1f MB -> %.1f MB\n", "compacted size",
+              before / 1e6, store->stats().disk_bytes / 1e6);
+  if (GetConcurrently(store.get(), 1, std::min<size_t>(count, 1000), count)) {
+    ReportFailure("kv store lost a value in compaction");
+  }
+}
+
+}  // namespace
+
+void RunKvStoreBenchmarks(const BenchmarkOptions& options) {
+  size_t count = static_cast<size_t>(20000 * options.scale);
+  if (count == 0) count = 1;
+  const fs::path root = fs::temp_directory_path() / "fnu_kv_store_benchmark";
+  fs::remove_all(root);
+  {
+    KeyIndex keys(std::make_unique<FileKeyStore>((root / "keys").string()));
+    WorkerPool pool(2);
+    std::printf(" %zu keys, %zu-byte values\n", count, kValueLen);
+    RunWrites(root, &keys, &pool, count);
+    RunReads(root, &keys, count);
+  }
+  fs::remove_all(root);
+}
+
+}  // namespace benchmark
+}  // namespace flutter_native_utils
@@ -0,0 +1,88 @@
+// Compares a full-rehash bundle verification with a cached one.
+
+#include <openssl/evp.h>
+#include <openssl/rsa.h>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "benchmarks.h"
+#include "file_hasher.h"
+#include "manifest_verifier.h"
+#include "rsa_keys.h"
+
+namespace flutter_native_utils {
+namespace benchmark {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+void PrintVerify(const std::string& label, const ManifestVerifyResult& result) {
+  std::printf("  %-44s %10.2f ms  (%zu rehashed, %s)\n", label.c_str(),
+              static_cast<double>(result.elapsed_us) / 1000.0,
+              result.files_rehashed, result.ok() ? "ok" : "FAILED");
+}
+
+}  // namespace
+
+void RunManifestBenchmarks(const BenchmarkOptions& options) {
+  const size_t file_count = static_cast<size_t>(2000.0 * options.scale) + 1;
+  const size_t file_size = 64 << 10;
+  const fs::path root = fs::temp_directory_path() / "fnu_bench_bundle";
+  fs::remove_all(root);
+  fs::create_directories(root / "files");
+
+  std::vector<char> contents(file_size);
+  std::string manifest = "fnu-manifest 1 sha256\n";
+  for (size_t i = 0; i < file_count; ++i) {
+    for (size_t j = 0; j < contents.size(); ++j) {
+      contents[j] = static_cast<char>(i * 31 + j);
+    }
+    std::string name = "files/" + std::to_string(i) + ".bin";
+    std::ofstream(root / name, std::ios::binary)
+        .write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    std::vector<uint8_t> digest = FileHasher::HashBuffer(
+        reinterpret_cast<const uint8_t*>(contents.data()), contents.size(),
+        HashAlgorithm::kSha256);
+    static const char kDigits[] = "0123456789abcdef";
+    for (uint8_t byte : digest) {
+      manifest.push_back(kDigits[byte >> 4]);
+      manifest.push_back(kDigits[byte & 0xf]);
+    }
+    manifest += " " + std::to_string(file_size) + " 0 " + name + "\n";
+  }
+
+  EVP_PKEY* key = EVP_RSA_gen(2048);
+  ManifestVerifyRequest request;
+  request.manifest = manifest;
+  request.signature = Sign(key, manifest);
+  request.public_key = CngPublicBlob(key);
+  request.root = root.string();
+  request.cache_path = (root / "verify.cache").string();
+  EVP_PKEY_free(key);
+
+  std::printf(" %zu files, %zu KiB each\n", file_count, file_size >> 10);
+  FileHasher hasher;
+  ManifestVerifier verifier(&hasher);
+  PrintVerify("first launch (no cache)", verifier.Verify(request));
+  PrintVerify("clean launch (cache hit)", verifier.Verify(request));
+
+  fs::last_write_time(root / "files/0.bin",
+                      fs::last_write_time(root / "files/0.bin") +
+                          std::chrono::hours(1));
+  PrintVerify("one file touched", verifier.Verify(request));
+
+  ManifestVerifyRequest uncached = request;
+  uncached.cache_path.clear();
+  PrintVerify("cache disabled", verifier.Verify(uncached));
+
+  fs::remove_all(root);
+}
+
+}  // namespace benchmark
+}  // namespace flutter_native_utils
@@ -0,0 +1,128 @@
+// The SignNonce replay filter: the cost of a check with every thread
+// recording fresh nonces into one filter, and of turning replays away, and
+// the false-positive rate once a window's capacity is reached.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmarks.h"
+#include "nonce_replay_filter.h"
+
+namespace flutter_native_utils {
+namespace benchmark {
+
+namespace {
+
+using Clock = NonceReplayFilter::Clock;
+
+// 32-byte nonces, distinct per |index|.
+void WriteNonce(uint64_t index, uint8_t* nonce) {
+  for (int i = 0; i < 32; ++i) {
+    nonce[i] = static_cast<uint8_t>((index >> (8 * (i % 8))) + i);
+  }
+}
+
+// Checks |per_thread| nonces on each of |threads| threads at once; returns
+// the nonces accepted.
+size_t CheckConcurrently(NonceReplayFilter& filter, size_t threads,
+                         size_t per_thread) {
+  std::vector<size_t> accepted(threads);
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&filter, &accepted, t, per_thread]() {
+      uint8_t nonce[32];
+      size_t count = 0;
+      for (size_t i = 0; i < per_thread; ++i) {
+        WriteNonce(t * per_thread + i, nonce);
+        count += filter.CheckAndRecord(nonce, sizeof(nonce));
+      }
+      accepted[t] = count;
+    });
+  }
+  for (std::thread& worker : workers) worker.join();
+  size_t total = 0;
+  for (size_t count : accepted) total += count;
+  return total;
+}
+
+void PrintNanos(const std::string& name, double checks, double seconds,
+                size_t threads) {
+  // Per check on one thread, so flat numbers mean the filter scales.
+  std::printf("  %-44s %10.1f ns/check  (%.3f s)\n", name.c_str(),
+              seconds * 1e9 * threads / checks, seconds);
+}
+
+void RunThreads(size_t threads, size_t per_thread) {
+  NonceReplayFilterOptions options;
+  // Without a rotation every nonce lands in one generation; size that for
+  // them.
+  options.capacity = threads * per_thread * (options.generations - 1);
+  NonceReplayFilter filter(options);
+  const double checks = static_cast<double>(threads * per_thread);
+  const std::string suffix = " x" + std::to_string(threads);
+
+  Stopwatch fresh;
+  const size_t accepted = CheckConcurrently(filter, threads, per_thread);
+  PrintNanos("fresh" + suffix, checks, fresh.Seconds(), threads);
+
+  Stopwatch replayed;
+  const size_t reaccepted = CheckConcurrently(filter, threads, per_thread);
+  PrintNanos(std::string(reaccepted ? "replayed FAILED" : "replayed") + suffix,
+             checks, replayed.Seconds(), threads);
+  if (reaccepted) ReportFailure("nonce filter accepted a replayed nonce");
+  std::printf("  %-44s %10.4f %%\n", ("false positives" + suffix).c_str(),
+              100.0 * (checks - accepted) / checks);
+}
+
+// Fills a window to capacity, spread over its generations as nonces would
+// arrive, then probes with a generation's worth of unseen nonces.
+void RunFalsePositives(size_t bits_per_nonce, size_t capacity) {
+  const Clock::time_point start = Clock::now();
+  NonceReplayFilterOptions options;
+  options.capacity = capacity;
+  options.bits_per_nonce = bits_per_nonce;
+  NonceReplayFilter filter(options, start);
+  const auto generation = options.window / (options.generations - 1);
+  const size_t per_generation = capacity / (options.generations - 1);
+
+  uint8_t nonce[32];
+  for (size_t i = 0; i < capacity; ++i) {
+    WriteNonce(i, nonce);
+    filter.CheckAndRecord(nonce, sizeof(nonce),
+                          start + generation * (i / per_generation));
+  }
+  const Clock::time_point end = start + generation * (options.generations - 1);
+  size_t false_positives = 0;
+  for (size_t i = 0; i < per_generation; ++i) {
+    WriteNonce(capacity + i, nonce);
+    false_positives += !filter.CheckAndRecord(nonce, sizeof(nonce), end);
+  }
+  std::printf("  %-44s %10.4f %%  (%zu KiB)\n",
+              ("false positives at capacity, " +
+               std::to_string(bits_per_nonce) + " bits")
+                  .c_str(),
+              100.0 * false_positives / per_generation,
+              filter.memory_bytes() >> 10);
+}
+
+}  // namespace
+
+void RunNonceFilterBenchmarks(const BenchmarkOptions& options) {
+  size_t per_thread = static_cast<size_t>(1000000 * options.scale);
+  if (per_thread == 0) per_thread = 1;
+  const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+  std::printf(" %zu nonces per thread, up to %zu threads\n", per_thread,
+              std::min<size_t>(8, cores));
+  for (size_t threads = 1; threads <= 8 && threads <= cores; threads *= 2) {
+    RunThreads(threads, per_thread);
+  }
+  const size_t capacity = std::max<size_t>(3000, per_thread);
+  for (size_t bits : {16, 24, 32}) RunFalsePositives(bits, capacity);
+}
+
+}  // namespace benchmark
+}  // namespace flutter_native_utils
@@ -0,0 +1,46 @@
+// Random-byte throughput: the buffered ChaCha20 generator against calling
+// the OS CSPRNG for every request.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "benchmarks.h"
+#include "buffered_random.h"
+#include "secure_random.h"
+
+namespace flutter_native_utils {
+namespace benchmark {
+
+namespace {
+
+template <typename Fill>
+void RunSize(const std::string& name, Fill fill, size_t request_len,
+             size_t total) {
+  std::vector<uint8_t> out(request_len);
+  const size_t requests = total / request_len;
+  Stopwatch stopwatch;
+  for (size_t i = 0; i < requests; ++i) fill(out.data(), out.size());
+  double seconds = stopwatch.Seconds();
+  const std::string suffix = " " + std::to_string(request_len) + " B";
+  if (request_len < 1024) {
+    PrintRate(name + suffix, static_cast<double>(requests), seconds);
+  } else {
+    PrintThroughput(name + suffix, static_cast<double>(requests * request_len),
+                    seconds);
+  }
+}
+
+}  // namespace
+
+void RunRandomBenchmarks(const BenchmarkOptions& options) {
+  const size_t total = static_cast<size_t>(256.0 * options.scale) << 20;
+  std::printf(" %zu MiB per run, one core\n", total >> 20);
+  for (size_t len : {16, 64, 256, 1 << 20}) {
+    RunSize("buffered", FillRandomBuffered, len, len < 1024 ? total / 16 : total);
+    RunSize("os", FillRandom, len, len < 1024 ? total / 16 : total);
+  }
+}
+
+}  // namespace benchmark
+}  // namespace flutter_native_utils
@@ -0,0 +1,58 @@
+#include "rsa_keys.h"
+
+#include <openssl/bn.h>
+#include <openssl/core_names.h>
+
+namespace flutter_native_utils {
+namespace benchmark {
+
+namespace {
+
+void AppendLe32(std::vector<uint8_t>* out, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    out->push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+}  // namespace
+
+std::vector<uint8_t> CngPublicBlob(EVP_PKEY* key) {
+  BIGNUM* n = nullptr;
+  BIGNUM* e = nullptr;
+  EVP_PKEY_get_bn_param(key, OSSL_PKEY_PARAM_RSA_N, &n);
+  EVP_PKEY_get_bn_param(key, OSSL_PKEY_PARAM_RSA_E, &e);
+  std::vector<uint8_t> modulus(BN_num_bytes(n));
+  std::vector<uint8_t> exponent(BN_num_bytes(e));
+  BN_bn2bin(n, modulus.data());
+  BN_bn2bin(e, exponent.data());
+  BN_free(n);
+  BN_free(e);
+
+  std::vector<uint8_t> blob;
+  AppendLe32(&blob, 0x31415352);  // "RSA1"
+  AppendLe32(&blob, static_cast<uint32_t>(modulus.size() * 8));
+  AppendLe32(&blob, static_cast<uint32_t>(exponent.size()));
+  AppendLe32(&blob, static_cast<uint32_t>(modulus.size()));
+  AppendLe32(&blob, 0);
+  AppendLe32(&blob, 0);
+  blob.insert(blob.end(), exponent.begin(), exponent.end());
+  blob.insert(blob.end(), modulus.begin(), modulus.end());
+  return blob;
+}
+
+std::vector<uint8_t> Sign(EVP_PKEY* key, const std::string& data) {
+  EVP_MD_CTX* context = EVP_MD_CTX_new();
+  size_t len = 0;
+  EVP_DigestSignInit(context, nullptr, EVP_sha256(), nullptr, key);
+  EVP_DigestSign(context, nullptr, &len,
+                 reinterpret_cast<const uint8_t*>(data.data()), data.size());
+  std::vector<uint8_t> signature(len);
+  EVP_DigestSign(context, signature.data(), &len,
+                 reinterpret_cast<const uint8_t*>(data.data()), data.size());
+  EVP_MD_CTX_free(context);
+  signature.resize(len);
+  return signature;
+}
+
+}  // namespace benchmark
+}  // namespace flutter_native_utils
@@ -0,0 +1,22 @@
+#ifndef FLUTTER_PLUGIN_BENCHMARK_RSA_KEYS_H_
+#define FLUTTER_PLUGIN_BENCHMARK_RSA_KEYS_H_
+
+#include <openssl/evp.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace flutter_native_utils {
+namespace benchmark {
+
+// Builds the BCRYPT_RSAPUBLIC_BLOB that CreateKeyPair would return.
+std::vector<uint8_t> CngPublicBlob(EVP_PKEY* key);
+
+// Signs |data| the way SignNonce does (RSASSA-PKCS1-v1_5 / SHA-256).
+std::vector<uint8_t> Sign(EVP_PKEY* key, const std::string& data);
+
+}  // namespace benchmark
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_BENCHMARK_RSA_KEYS_H_
@@ -0,0 +1,72 @@
+// Batch RSA-2048 signature verification rate, one core against all cores.
+
+#include <openssl/evp.h>
+#include <openssl/rsa.h>
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmarks.h"
+#include "rsa_keys.h"
+#include "signature_verifier.h"
+#include "worker_pool.h"
+
+namespace flutter_native_utils {
+namespace benchmark {
+
+namespace {
+
+void RunBatch(const std::vector<SignatureCheck>& checks, size_t threads) {
+  WorkerPool pool(threads);
+  Stopwatch stopwatch;
+  SignatureBitmap bitmap = VerifySignatures(checks, &pool);
+  double seconds = stopwatch.Seconds();
+  size_t valid = 0;
+  for (size_t i = 0; i < checks.size(); ++i) {
+    valid += SignatureBitmapTest(bitmap, i) ? 1 : 0;
+  }
+  PrintRate(std::string(valid == checks.size() ? "verify" : "verify FAILED") +
+                " x" + std::to_string(pool.thread_count()),
+            static_cast<double>(checks.size()), seconds);
+}
+
+}  // namespace
+
+void RunSignatureBenchmarks(const BenchmarkOptions& options) {
+  size_t count = static_cast<size_t>(20000.0 * options.scale);
+  if (count == 0) count = 1;
+
+  // A handful of signers, as with messages from several servers.
+  constexpr size_t kKeyCount = 4;
+  PublicKeyTable keys;
+  std::vector<std::vector<std::string>> messages(kKeyCount);
+  std::vector<std::vector<uint8_t>> signatures;
+  std::vector<std::string> bodies(kKeyCount);
+  for (size_t k = 0; k < kKeyCount; ++k) {
+    EVP_PKEY* key = EVP_RSA_gen(2048);
+    keys.Import("server-" + std::to_string(k), CngPublicBlob(key));
+    bodies[k] = "{\"event\":\"update\",\"server\":" + std::to_string(k) +
+                ",\"payload\":\"" + std::string(200, 'p') + "\"}";
+    signatures.push_back(Sign(key, bodies[k]));
+    EVP_PKEY_free(key);
+  }
+
+  std::vector<SignatureCheck> checks(count);
+  for (size_t i = 0; i < count; ++i) {
+    size_t k = i % kKeyCount;
+    checks[i].message = reinterpret_cast<const uint8_t*>(bodies[k].data());
+    checks[i].message_len = bodies[k].size();
+    checks[i].signature = signatures[k].data();
+    checks[i].signature_len = signatures[k].size();
+    checks[i].key = keys.Find("server-" + std::to_string(k));
+  }
+
+  std::printf(" %zu RSA-2048 signatures, %zu keys\n", count, kKeyCount);
+  RunBatch(checks, 1);
+  if (std::thread::hardware_concurrency() > 1) RunBatch(checks, 0);
+}
+
+}  // namespace benchmark
+}  // namespace flutter_native_utils
@@ -0,0 +1,206 @@
+#include "blake3.h"
+
+#include <cstring>
+
+namespace flutter_native_utils {
+
+namespace {
+
+constexpr size_t kBlockLen = 64;
+
+constexpr uint32_t kChunkStart = 1 << 0;
+constexpr uint32_t kChunkEnd = 1 << 1;
+constexpr uint32_t kParent = 1 << 2;
+constexpr uint32_t kRoot = 1 << 3;
+
+constexpr uint32_t kIv[8] = {0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+                             0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19};
+
+constexpr uint8_t kMessageSchedule[7][16] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8},
+    {3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1},
+    {10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6},
+    {12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4},
+    {9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7},
+    {11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13},
+};
+
+inline uint32_t RotateRight(uint32_t value, int bits) {
+  return (value >> bits) | (value << (32 - bits));
+}
+
+inline void G(uint32_t* state, size_t a, size_t b, size_t c, size_t d,
+              uint32_t x, uint32_t y) {
+  state[a] = state[a] + state[b] + x;
+  state[d] = RotateRight(state[d] ^ state[a], 16);
+  state[c] = state[c] + state[d];
+  state[b] = RotateRight(state[b] ^ state[c], 12);
+  state[a] = state[a] + state[b] + y;
+  state[d] = RotateRight(state[d] ^ state[a], 8);
+  state[c] = state[c] + state[d];
+  state[b] = RotateRight(state[b] ^ state[c], 7);
+}
+
+void Compress(const uint32_t cv[8], const uint32_t block[16], uint64_t counter,
+              uint32_t block_len, uint32_t flags, uint32_t out[16]) {
+  uint32_t state[16] = {cv[0],   cv[1],   cv[2],   cv[3],
+                        cv[4],   cv[5],   cv[6],   cv[7],
+                        kIv[0],  kIv[1],  kIv[2],  kIv[3],
+                        static_cast<uint32_t>(counter),
+                        static_cast<uint32_t>(counter >> 32),
+                        block_len, flags};
+  for (const auto& schedule : kMessageSchedule) {
+    G(state, 0, 4, 8, 12, block[schedule[0]], block[schedule[1]]);
+    G(state, 1, 5, 9, 13, block[schedule[2]], block[schedule[3]]);
+    G(state, 2, 6, 10, 14, block[schedule[4]], block[schedule[5]]);
+    G(state, 3, 7, 11, 15, block[schedule[6]], block[schedule[7]]);
+    G(state, 0, 5, 10, 15, block[schedule[8]], block[schedule[9]]);
+    G(state, 1, 6, 11, 12, block[schedule[10]], block[schedule[11]]);
+    G(state, 2, 7, 8, 13, block[schedule[12]], block[schedule[13]]);
+    G(state, 3, 4, 9, 14, block[schedule[14]], block[schedule[15]]);
+  }
+  for (size_t i = 0; i < 8; ++i) {
+    out[i] = state[i] ^ state[i + 8];
+    out[i + 8] = state[i + 8] ^ cv[i];
+  }
+}
+
+void LoadBlock(const uint8_t* bytes, size_t len, uint32_t block[16]) {
+  uint8_t padded[kBlockLen] = {};
+  // An empty input may have no buffer at all.
+  if (len > 0) std::memcpy(padded, bytes, len);
+  for (size_t i = 0; i < 16; ++i) {
+    const uint8_t* p = padded + 4 * i;
+    block[i] = static_cast<uint32_t>(p[0]) |
+               (static_cast<uint32_t>(p[1]) << 8) |
+               (static_cast<uint32_t>(p[2]) << 16) |
+               (static_cast<uint32_t>(p[3]) << 24);
+  }
+}
+
+// The inputs of the final compression of a node. Kept unevaluated so that the
+// root node can be compressed with the ROOT flag.
+struct Output {
+  uint32_t input_cv[8];
+  uint32_t block[16];
+  uint64_t counter;
+  uint32_t block_len;
+  uint32_t flags;
+
+  Blake3ChainingValue ChainingValue() const {
+    uint32_t words[16];
+    Compress(input_cv, block, counter, block_len, flags, words);
+    Blake3ChainingValue cv;
+    std::memcpy(cv.words, words, sizeof(cv.words));
+    return cv;
+  }
+
+  void RootHash(uint8_t out[kBlake3OutLen]) const {
+    uint32_t words[16];
+    Compress(input_cv, block, 0, block_len, flags | kRoot, words);
+    for (size_t i = 0; i < 8; ++i) {
+      out[4 * i] = static_cast<uint8_t>(words[i]);
+      out[4 * i + 1] = static_cast<uint8_t>(words[i] >> 8);
+      out[4 * i + 2] = static_cast<uint8_t>(words[i] >> 16);
+      out[4 * i + 3] = static_cast<uint8_t>(words[i] >> 24);
+    }
+  }
+};
+
+// Hashes a single chunk (at most kBlake3ChunkLen bytes, possibly empty).
+Output ChunkOutput(const uint8_t* data, size_t len, uint64_t chunk_counter) {
+  uint32_t cv[8];
+  std::memcpy(cv, kIv, sizeof(cv));
+  uint32_t flags = kChunkStart;
+  while (len > kBlockLen) {
+    uint32_t block[16];
+    uint32_t out[16];
+    LoadBlock(data, kBlockLen, block);
+    Compress(cv, block, chunk_counter, kBlockLen, flags, out);
+    std::memcpy(cv, out, sizeof(cv));
+    data += kBlockLen;
+    len -= kBlockLen;
+    flags = 0;
+  }
+  Output output;
+  std::memcpy(output.input_cv, cv, sizeof(cv));
+  LoadBlock(data, len, output.block);
+  output.counter = chunk_counter;
+  output.block_len = static_cast<uint32_t>(len);
+  output.flags = flags | kChunkEnd;
+  return output;
+}
+
+Output ParentOutput(const Blake3ChainingValue& left,
+                    const Blake3ChainingValue& right) {
+  Output output;
+  std::memcpy(output.input_cv, kIv, sizeof(kIv));
+  std::memcpy(output.block, left.words, sizeof(left.words));
+  std::memcpy(output.block + 8, right.words, sizeof(right.words));
+  output.counter = 0;
+  output.block_len = kBlockLen;
+  output.flags = kParent;
+  return output;
+}
+
+// Size of the left subtree: the largest power-of-two number of chunks that
+// leaves at least one byte for the right subtree.
+size_t LeftSubtreeLen(size_t len) {
+  size_t full_chunks = (len - 1) / kBlake3ChunkLen;
+  size_t chunks = 1;
+  while (chunks * 2 <= full_chunks) chunks *= 2;
+  return chunks * kBlake3ChunkLen;
+}
+
+Output SubtreeOutput(const uint8_t* data, size_t len, uint64_t chunk_counter) {
+  if (len <= kBlake3ChunkLen) return ChunkOutput(data, len, chunk_counter);
+  size_t left_len = LeftSubtreeLen(len);
+  Blake3ChainingValue left =
+      SubtreeOutput(data, left_len, chunk_counter).ChainingValue();
+  Blake3ChainingValue right =
+      SubtreeOutput(data + left_len, len - left_len,
+                    chunk_counter + left_len / kBlake3ChunkLen)
+          .ChainingValue();
+  return ParentOutput(left, right);
+}
+
+}  // namespace
+
+void Blake3Hash(const uint8_t* data, size_t len, uint8_t out[kBlake3OutLen]) {
+  SubtreeOutput(data, len, 0).RootHash(out);
+}
+
+Blake3ChainingValue Blake3SubtreeChainingValue(const uint8_t* data, size_t len,
+                                               uint64_t chunk_counter) {
+  return SubtreeOutput(data, len, chunk_counter).ChainingValue();
+}
+
+void Blake3CombineSubtrees(const std::vector<Blake3ChainingValue>& subtrees,
+                           uint64_t subtree_chunks, const uint8_t* tail,
+                           size_t tail_len, uint8_t out[kBlake3OutLen]) {
+  // Merge complete subtrees the same way the incremental hasher merges
+  // chunks: after adding subtree n, one merge per trailing zero bit of n.
+  std::vector<Blake3ChainingValue> stack;
+  uint64_t count = 0;
+  for (const Blake3ChainingValue& subtree : subtrees) {
+    Blake3ChainingValue cv = subtree;
+    ++count;
+    for (uint64_t total = count; (total & 1) == 0; total >>= 1) {
+      cv = ParentOutput(stack.back(), cv).ChainingValue();
+      stack.pop_back();
+    }
+    stack.push_back(cv);
+  }
+
+  // The tail is the right-most node; fold the stack into it from the top so
+  // that the last parent is compressed as the root.
+  Output output = SubtreeOutput(tail, tail_len, subtrees.size() * subtree_chunks);
+  while (!stack.empty()) {
+    output = ParentOutput(stack.back(), output.ChainingValue());
+    stack.pop_back();
+  }
+  output.RootHash(out);
+}
+
+}  // namespace flutter_native_utils
@@ -0,0 +1,44 @@
+#ifndef FLUTTER_PLUGIN_BLAKE3_H_
+#define FLUTTER_PLUGIN_BLAKE3_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flutter_native_utils {
+
+// Portable BLAKE3 (hash mode, 32-byte output).
+//
+// Besides the one-shot Blake3Hash, the tree-hashing building blocks are
+// exposed so that callers can hash complete subtrees of a large input on
+// different threads and combine them afterwards:
+//
+//   1. Split the input into N complete subtrees of 2^k chunks each followed by
+//      a non-empty tail of at most 2^k chunks.
+//   2. Compute Blake3SubtreeChainingValue for each subtree (in parallel).
+//   3. Call Blake3CombineSubtrees with the chaining values and the tail.
+constexpr size_t kBlake3OutLen = 32;
+constexpr size_t kBlake3ChunkLen = 1024;
+
+struct Blake3ChainingValue {
+  uint32_t words[8];
+};
+
+void Blake3Hash(const uint8_t* data, size_t len, uint8_t out[kBlake3OutLen]);
+
+// Chaining value of a complete subtree. |len| must be a power-of-two multiple
+// of kBlake3ChunkLen and |chunk_counter| the index of its first chunk.
+Blake3ChainingValue Blake3SubtreeChainingValue(const uint8_t* data, size_t len,
+                                               uint64_t chunk_counter);
+
+// Computes the root hash from the in-order chaining values of equally sized
+// complete subtrees (|subtree_chunks| chunks each) followed by a tail of
+// 1..|subtree_chunks| chunks. For an input of at most one subtree, pass no
+// chaining values and the whole input as the tail.
+void Blake3CombineSubtrees(const std::vector<Blake3ChainingValue>& subtrees,
+                           uint64_t subtree_chunks, const uint8_t* tail,
+                           size_t tail_len, uint8_t out[kBlake3OutLen]);
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_BLAKE3_H_
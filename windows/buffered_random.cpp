@@ -0,0 +1,314 @@
+#include "buffered_random.h"
+
+#ifdef _WIN32
+#include "secure_random.h"
+#else
+#include <pthread.h>
+#include <sys/random.h>
+
+#include <atomic>
+#include <cerrno>
+#endif
+
+#include <cstring>
+#include <stdexcept>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "secure_buffer.h"
+
+namespace flutter_native_utils {
+
+namespace {
+
+constexpr size_t kBlockLen = 64;
+
+// Blocks computed per call of ChaCha20Blocks.
+constexpr size_t kLanes = 4;
+
+// Keystream generated per refill; the first kChaCha20KeyLen bytes become the
+// next key.
+constexpr size_t kBufferLen = 8 * kLanes * kBlockLen;
+
+// Requests at least this long are generated directly into the caller's
+// buffer.
+constexpr size_t kDirectLen = 1024;
+
+// Output between reseeds from the OS.
+constexpr uint64_t kReseedInterval = 64ull << 20;
+
+uint32_t LoadLe32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+         static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+template <int bits>
+__m128i Rotl(__m128i value) {
+  return _mm_or_si128(_mm_slli_epi32(value, bits),
+                      _mm_srli_epi32(value, 32 - bits));
+}
+
+// Rotating by 16 swaps the 16-bit halves of each word.
+template <>
+__m128i Rotl<16>(__m128i value) {
+  return _mm_shufflehi_epi16(_mm_shufflelo_epi16(value, 0xb1), 0xb1);
+}
+
+template <int a, int b, int c, int d>
+void QuarterRound(__m128i* x) {
+  x[a] = _mm_add_epi32(x[a], x[b]);
+  x[d] = Rotl<16>(_mm_xor_si128(x[d], x[a]));
+  x[c] = _mm_add_epi32(x[c], x[d]);
+  x[b] = Rotl<12>(_mm_xor_si128(x[b], x[c]));
+  x[a] = _mm_add_epi32(x[a], x[b]);
+  x[d] = Rotl<8>(_mm_xor_si128(x[d], x[a]));
+  x[c] = _mm_add_epi32(x[c], x[d]);
+  x[b] = Rotl<7>(_mm_xor_si128(x[b], x[c]));
+}
+
+// Computes four consecutive blocks starting at |counter| into |out|. Vector
+// register i holds word i of all four blocks (SSE2 is baseline on x64).
+void ChaCha20Blocks(const uint32_t* key, uint64_t counter, uint64_t nonce,
+                    uint8_t* out) {
+  static const uint32_t kSigma[4] = {0x61707865, 0x3320646e, 0x79622d32,
+                                     0x6b206574};
+  __m128i input[16];
+  for (int i = 0; i < 4; ++i) {
+    input[i] = _mm_set1_epi32(static_cast<int>(kSigma[i]));
+  }
+  for (int i = 0; i < 8; ++i) {
+    input[4 + i] = _mm_set1_epi32(static_cast<int>(key[i]));
+  }
+  uint32_t low[4];
+  uint32_t high[4];
+  for (int l = 0; l < 4; ++l) {
+    low[l] = static_cast<uint32_t>(counter + l);
+    high[l] = static_cast<uint32_t>((counter + l) >> 32);
+  }
+  input[12] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(low));
+  input[13] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(high));
+  input[14] = _mm_set1_epi32(static_cast<int>(static_cast<uint32_t>(nonce)));
+  input[15] = _mm_set1_epi32(static_cast<int>(static_cast<uint32_t>(nonce >> 32)));
+
+  __m128i x[16];
+  for (int i = 0; i < 16; ++i) x[i] = input[i];
+  for (int round = 0; round < 10; ++round) {
+    QuarterRound<0, 4, 8, 12>(x);
+    QuarterRound<1, 5, 9, 13>(x);
+    QuarterRound<2, 6, 10, 14>(x);
+    QuarterRound<3, 7, 11, 15>(x);
+    QuarterRound<0, 5, 10, 15>(x);
+    QuarterRound<1, 6, 11, 12>(x);
+    QuarterRound<2, 7, 8, 13>(x);
+    QuarterRound<3, 4, 9, 14>(x);
+  }
+
+  // Transpose each group of four words back into block order.
+  for (int i = 0; i < 16; i += 4) {
+    __m128i a = _mm_add_epi32(x[i], input[i]);
+    __m128i b = _mm_add_epi32(x[i + 1], input[i + 1]);
+    __m128i c = _mm_add_epi32(x[i + 2], input[i + 2]);
+    __m128i d = _mm_add_epi32(x[i + 3], input[i + 3]);
+    __m128i ab_low = _mm_unpacklo_epi32(a, b);
+    __m128i ab_high = _mm_unpackhi_epi32(a, b);
+    __m128i cd_low = _mm_unpacklo_epi32(c, d);
+    __m128i cd_high = _mm_unpackhi_epi32(c, d);
+    __m128i rows[4] = {
+        _mm_unpacklo_epi64(ab_low, cd_low), _mm_unpackhi_epi64(ab_low, cd_low),
+        _mm_unpacklo_epi64(ab_high, cd_high),
+        _mm_unpackhi_epi64(ab_high, cd_high)};
+    for (int l = 0; l < 4; ++l) {
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(out + l * kBlockLen + 4 * i), rows[l]);
+    }
+  }
+}
+#else
+uint32_t Rotl(uint32_t value, int bits) {
+  return (value << bits) | (value >> (32 - bits));
+}
+
+void QuarterRound(uint32_t* x, int a, int b, int c, int d) {
+  x[a] += x[b];
+  x[d] = Rotl(x[d] ^ x[a], 16);
+  x[c] += x[d];
+  x[b] = Rotl(x[b] ^ x[c], 12);
+  x[a] += x[b];
+  x[d] = Rotl(x[d] ^ x[a], 8);
+  x[c] += x[d];
+  x[b] = Rotl(x[b] ^ x[c], 7);
+}
+
+// Portable fallback: computes kLanes consecutive blocks one at a time.
+void ChaCha20Blocks(const uint32_t* key, uint64_t counter, uint64_t nonce,
+                    uint8_t* out) {
+  static const uint32_t kSigma[4] = {0x61707865, 0x3320646e, 0x79622d32,
+                                     0x6b206574};
+  for (size_t l = 0; l < kLanes; ++l) {
+    uint32_t input[16];
+    for (int i = 0; i < 4; ++i) input[i] = kSigma[i];
+    for (int i = 0; i < 8; ++i) input[4 + i] = key[i];
+    input[12] = static_cast<uint32_t>(counter + l);
+    input[13] = static_cast<uint32_t>((counter + l) >> 32);
+    input[14] = static_cast<uint32_t>(nonce);
+    input[15] = static_cast<uint32_t>(nonce >> 32);
+
+    uint32_t x[16];
+    std::memcpy(x, input, sizeof(x));
+    for (int round = 0; round < 10; ++round) {
+      QuarterRound(x, 0, 4, 8, 12);
+      QuarterRound(x, 1, 5, 9, 13);
+      QuarterRound(x, 2, 6, 10, 14);
+      QuarterRound(x, 3, 7, 11, 15);
+      QuarterRound(x, 0, 5, 10, 15);
+      QuarterRound(x, 1, 6, 11, 12);
+      QuarterRound(x, 2, 7, 8, 13);
+      QuarterRound(x, 3, 4, 9, 14);
+    }
+
+    uint8_t* block = out + l * kBlockLen;
+    for (int i = 0; i < 16; ++i) {
+      uint32_t word = x[i] + input[i];
+      block[4 * i] = static_cast<uint8_t>(word);
+      block[4 * i + 1] = static_cast<uint8_t>(word >> 8);
+      block[4 * i + 2] = static_cast<uint8_t>(word >> 16);
+      block[4 * i + 3] = static_cast<uint8_t>(word >> 24);
+    }
+  }
+}
+#endif
+
+#ifdef _WIN32
+void SeedFromOs(uint8_t* data, size_t len) { FillRandom(data, len); }
+#else
+void SeedFromOs(uint8_t* data, size_t len) {
+  while (len > 0) {
+    ssize_t got = getrandom(data, len, 0);
+    if (got < 0) {
+      if (errno == EINTR) continue;
+      throw std::runtime_error("getrandom failed");
+    }
+    data += got;
+    len -= static_cast<size_t>(got);
+  }
+}
+
+// Bumped in the child after fork() so every inherited generator reseeds
+// instead of repeating the parent's output.
+std::atomic<uint64_t> g_fork_generation{0};
+
+void OnFork() { g_fork_generation.fetch_add(1, std::memory_order_relaxed); }
+#endif
+
+class ThreadRng {
+ public:
+  ~ThreadRng() {
+    SecureZero(key_, sizeof(key_));
+    SecureZero(buffer_, sizeof(buffer_));
+  }
+
+  void Fill(uint8_t* data, size_t len) {
+    if (NeedsReseed()) Reseed();
+    output_since_seed_ += len;
+
+    if (len >= kDirectLen) {
+      // A one-off key from the buffered stream keeps the caller's bytes
+      // independent of everything the generator outputs later.
+      uint8_t one_off[kChaCha20KeyLen];
+      Take(one_off, sizeof(one_off));
+      ChaCha20Keystream(one_off, 0, 0, data, len);
+      SecureZero(one_off, sizeof(one_off));
+      return;
+    }
+    Take(data, len);
+  }
+
+ private:
+  bool NeedsReseed() const {
+#ifndef _WIN32
+    if (fork_generation_ !=
+        g_fork_generation.load(std::memory_order_relaxed)) {
+      return true;
+    }
+#endif
+    return !seeded_ || output_since_seed_ >= kReseedInterval;
+  }
+
+  void Reseed() {
+#ifndef _WIN32
+    static const bool registered = pthread_atfork(nullptr, nullptr, OnFork) == 0;
+    if (!registered) throw std::runtime_error("pthread_atfork failed");
+    fork_generation_ = g_fork_generation.load(std::memory_order_relaxed);
+#endif
+    // Mixing into the old key keeps it in play should the OS source ever be
+    // weak; on first use the old key is all zero.
+    uint8_t seed[kChaCha20KeyLen];
+    SeedFromOs(seed, sizeof(seed));
+    for (size_t i = 0; i < sizeof(seed); ++i) key_[i] ^= seed[i];
+    SecureZero(seed, sizeof(seed));
+    // Anything buffered under the old key is discarded.
+    SecureZero(buffer_, sizeof(buffer_));
+    available_ = 0;
+    output_since_seed_ = 0;
+    seeded_ = true;
+  }
+
+  void Take(uint8_t* data, size_t len) {
+    while (len > 0) {
+      if (available_ == 0) Refill();
+      size_t piece = len < available_ ? len : available_;
+      uint8_t* source = buffer_ + sizeof(buffer_) - available_;
+      std::memcpy(data, source, piece);
+      SecureZero(source, piece);
+      available_ -= piece;
+      data += piece;
+      len -= piece;
+    }
+  }
+
+  void Refill() {
+    ChaCha20Keystream(key_, 0, 0, buffer_, sizeof(buffer_));
+    std::memcpy(key_, buffer_, kChaCha20KeyLen);
+    SecureZero(buffer_, kChaCha20KeyLen);
+    available_ = sizeof(buffer_) - kChaCha20KeyLen;
+  }
+
+  uint8_t key_[kChaCha20KeyLen] = {};
+  uint8_t buffer_[kBufferLen];
+  size_t available_ = 0;
+  uint64_t output_since_seed_ = 0;
+  bool seeded_ = false;
+#ifndef _WIN32
+  uint64_t fork_generation_ = 0;
+#endif
+};
+
+}  // namespace
+
+void ChaCha20Keystream(const uint8_t* key, uint64_t counter, uint64_t nonce,
+                       uint8_t* out, size_t len) {
+  uint32_t key_words[8];
+  for (int i = 0; i < 8; ++i) key_words[i] = LoadLe32(key + 4 * i);
+
+  constexpr size_t kStride = kLanes * kBlockLen;
+  for (; len >= kStride; len -= kStride, out += kStride, counter += kLanes) {
+    ChaCha20Blocks(key_words, counter, nonce, out);
+  }
+  if (len > 0) {
+    uint8_t tail[kStride];
+    ChaCha20Blocks(key_words, counter, nonce, tail);
+    std::memcpy(out, tail, len);
+    SecureZero(tail, sizeof(tail));
+  }
+  SecureZero(key_words, sizeof(key_words));
+}
+
+void FillRandomBuffered(uint8_t* data, size_t len) {
+  static thread_local ThreadRng rng;
+  rng.Fill(data, len);
+}
+
+}  // namespace flutter_native_utils
@@ -0,0 +1,32 @@
+#ifndef FLUTTER_PLUGIN_BUFFERED_RANDOM_H_
+#define FLUTTER_PLUGIN_BUFFERED_RANDOM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace flutter_native_utils {
+
+constexpr size_t kChaCha20KeyLen = 32;
+
+// Writes |len| bytes of ChaCha20 keystream starting at block |counter|. Uses
+// the original layout with a 64-bit block counter and a 64-bit nonce, so a
+// single key can produce far more output than the RFC 8439 variant.
+void ChaCha20Keystream(const uint8_t* key, uint64_t counter, uint64_t nonce,
+                       uint8_t* out, size_t len);
+
+// Fills |data| with cryptographically secure random bytes from a per-thread
+// ChaCha20 generator, which is much cheaper than a system call per request.
+//
+// Each thread's generator is seeded from the OS (BCryptGenRandom on Windows,
+// getrandom elsewhere) and reseeded after a fixed amount of output and in
+// the child after fork(). After every refill the generator replaces its key
+// with fresh keystream and bytes are wiped from its buffer once handed out,
+// so a later memory disclosure does not reveal earlier output. Large
+// requests are generated straight into |data| under a one-off key.
+//
+// Throws std::runtime_error if the OS CSPRNG fails.
+void FillRandomBuffered(uint8_t* data, size_t len);
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_BUFFERED_RANDOM_H_
@@ -0,0 +1,392 @@
+#include "certificate_chain.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <wincrypt.h>
+
+#pragma comment(lib, "crypt32.lib")
+#else
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509_vfy.h>
+
+#include <ctime>
+#include <filesystem>
+#endif
+
+#include <chrono>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace flutter_native_utils {
+
+namespace {
+
+std::string CacheKey(const std::string& thumbprint, bool check_revocation) {
+  std::string key = thumbprint;
+  for (char& c : key) {
+    if (c >= 'a' && c <= 'f') c = static_cast<char>(c - 'a' + 'A');
+  }
+  if (check_revocation) key += "/revocation";
+  return key;
+}
+
+}  // namespace
+
+#ifdef _WIN32
+// ---------- CryptoAPI backend ----------
+
+namespace {
+
+bool ParseThumbprint(const std::string& hex, uint8_t out[20]) {
+  if (hex.size() != 40) return false;
+  for (size_t i = 0; i < 20; ++i) {
+    int value = 0;
+    for (size_t j = 0; j < 2; ++j) {
+      char c = hex[i * 2 + j];
+      int digit;
+      if (c >= '0' && c <= '9') {
+        digit = c - '0';
+      } else if (c >= 'a' && c <= 'f') {
+        digit = c - 'a' + 10;
+      } else if (c >= 'A' && c <= 'F') {
+        digit = c - 'A' + 10;
+      } else {
+        return false;
+      }
+      value = value * 16 + digit;
+    }
+    out[i] = static_cast<uint8_t>(value);
+  }
+  return true;
+}
+
+int64_t FileTimeToUnixMillis(const FILETIME& time) {
+  ULARGE_INTEGER ticks;
+  ticks.LowPart = time.dwLowDateTime;
+  ticks.HighPart = time.dwHighDateTime;
+  return (static_cast<int64_t>(ticks.QuadPart) - 116444736000000000LL) / 10000;
+}
+
+FILETIME UnixMillisToFileTime(int64_t millis) {
+  ULARGE_INTEGER ticks;
+  ticks.QuadPart =
+      static_cast<ULONGLONG>(millis * 10000 + 116444736000000000LL);
+  FILETIME time;
+  time.dwLowDateTime = ticks.LowPart;
+  time.dwHighDateTime = ticks.HighPart;
+  return time;
+}
+
+std::string TrustStatusToString(DWORD status) {
+  static const std::pair<DWORD, const char*> kErrors[] = {
+      {CERT_TRUST_IS_NOT_TIME_VALID, "not time valid"},
+      {CERT_TRUST_IS_REVOKED, "revoked"},
+      {CERT_TRUST_IS_NOT_SIGNATURE_VALID, "invalid signature"},
+      {CERT_TRUST_IS_NOT_VALID_FOR_USAGE, "not valid for usage"},
+      {CERT_TRUST_IS_UNTRUSTED_ROOT, "untrusted root"},
+      {CERT_TRUST_REVOCATION_STATUS_UNKNOWN, "revocation status unknown"},
+      {CERT_TRUST_IS_CYCLIC, "cyclic chain"},
+      {CERT_TRUST_IS_OFFLINE_REVOCATION, "revocation server offline"},
+      {CERT_TRUST_IS_PARTIAL_CHAIN, "partial chain"},
+  };
+  std::string text;
+  for (const auto& error : kErrors) {
+    if (!(status & error.first)) continue;
+    if (!text.empty()) text += ", ";
+    text += error.second;
+  }
+  return text.empty() ? "chain error" : text;
+}
+
+}  // namespace
+
+struct CertificateChainBuilder::Backend {
+  HCERTCHAINENGINE engine = nullptr;
+  HCERTSTORE stores[2] = {nullptr, nullptr};  // Current user, local machine.
+
+  ~Backend() {
+    for (HCERTSTORE store : stores) {
+      if (store) CertCloseStore(store, 0);
+    }
+    if (engine) CertFreeCertificateChainEngine(engine);
+  }
+};
+
+CertificateChainBuilder::CertificateChainBuilder(CertificateClock clock)
+    : clock_(std::move(clock)), backend_(std::make_unique<Backend>()) {
+  CERT_CHAIN_ENGINE_CONFIG config = {};
+  config.cbSize = sizeof(config);
+  config.dwFlags = CERT_CHAIN_CACHE_END_CERT;
+  if (!CertCreateCertificateChainEngine(&config, &backend_->engine)) {
+    throw std::runtime_error("CertCreateCertificateChainEngine failed");
+  }
+  const DWORD locations[] = {CERT_SYSTEM_STORE_CURRENT_USER,
+                             CERT_SYSTEM_STORE_LOCAL_MACHINE};
+  for (size_t i = 0; i < 2; ++i) {
+    backend_->stores[i] = CertOpenStore(
+        CERT_STORE_PROV_SYSTEM_W, 0, 0,
+        locations[i] | CERT_STORE_READONLY_FLAG | CERT_STORE_OPEN_EXISTING_FLAG,
+        L"MY");
+  }
+}
+
+std::unique_ptr<CertificateChain> CertificateChainBuilder::BuildUncached(
+    const std::string& thumbprint, bool check_revocation, int64_t now) {
+  uint8_t hash[20];
+  if (!ParseThumbprint(thumbprint, hash)) return nullptr;
+  CRYPT_HASH_BLOB blob = {sizeof(hash), hash};
+  PCCERT_CONTEXT leaf = nullptr;
+  for (HCERTSTORE store : backend_->stores) {
+    if (!store) continue;
+    leaf = CertFindCertificateInStore(store, X509_ASN_ENCODING, 0,
+                                      CERT_FIND_SHA1_HASH, &blob, nullptr);
+    if (leaf) break;
+  }
+  if (!leaf) return nullptr;
+
+  CERT_CHAIN_PARA para = {};
+  para.cbSize = sizeof(para);
+  FILETIME time = UnixMillisToFileTime(now);
+  const DWORD flags =
+      check_revocation ? CERT_CHAIN_REVOCATION_CHECK_CHAIN_EXCLUDE_ROOT : 0;
+  PCCERT_CHAIN_CONTEXT context = nullptr;
+  BOOL ok = CertGetCertificateChain(backend_->engine, leaf, &time,
+                                    leaf->hCertStore, &para, flags, nullptr,
+                                    &context);
+  CertFreeCertificateContext(leaf);
+  if (!ok) throw std::runtime_error("CertGetCertificateChain failed");
+
+  auto chain = std::make_unique<CertificateChain>();
+  int64_t expires_at = INT64_MAX;
+  if (context->cChain > 0) {
+    const CERT_SIMPLE_CHAIN* simple = context->rgpChain[0];
+    for (DWORD i = 0; i < simple->cElement; ++i) {
+      PCCERT_CONTEXT cert = simple->rgpElement[i]->pCertContext;
+      chain->certificates.emplace_back(
+          cert->pbCertEncoded, cert->pbCertEncoded + cert->cbCertEncoded);
+      int64_t not_after = FileTimeToUnixMillis(cert->pCertInfo->NotAfter);
+      if (not_after < expires_at) expires_at = not_after;
+    }
+  }
+  const DWORD status = context->TrustStatus.dwErrorStatus;
+  chain->trusted = status == CERT_TRUST_NO_ERROR;
+  if (!chain->trusted) chain->status = TrustStatusToString(status);
+  chain->expires_at = expires_at;
+  CertFreeCertificateChain(context);
+  return chain;
+}
+#else
+// ---------- OpenSSL backend ----------
+
+namespace {
+
+int64_t AsnTimeToUnixMillis(const ASN1_TIME* time) {
+  struct tm parts = {};
+  if (!ASN1_TIME_to_tm(time, &parts)) return 0;
+  return static_cast<int64_t>(timegm(&parts)) * 1000;
+}
+
+std::string Sha1Hex(X509* cert) {
+  static const char kDigits[] = "0123456789ABCDEF";
+  uint8_t digest[EVP_MAX_MD_SIZE];
+  unsigned int len = 0;
+  if (!X509_digest(cert, EVP_sha1(), digest, &len)) return std::string();
+  std::string hex;
+  for (unsigned int i = 0; i < len; ++i) {
+    hex.push_back(kDigits[digest[i] >> 4]);
+    hex.push_back(kDigits[digest[i] & 0xf]);
+  }
+  return hex;
+}
+
+// Calls |on_certificate| / |on_crl| with every certificate and CRL in the
+// *.pem, *.crt and *.crl files directly under |directory|.
+template <typename CertificateFn, typename CrlFn>
+void ReadPemItems(const std::string& directory, CertificateFn on_certificate,
+                  CrlFn on_crl) {
+  namespace fs = std::filesystem;
+  std::error_code error;
+  for (fs::directory_iterator it(fs::u8path(directory), error), end;
+       !error && it != end; it.increment(error)) {
+    const fs::path& path = it->path();
+    if (!it->is_regular_file(error) ||
+        (path.extension() != ".pem" && path.extension() != ".crt" &&
+         path.extension() != ".crl")) {
+      continue;
+    }
+    BIO* bio = BIO_new_file(path.c_str(), "r");
+    if (!bio) continue;
+    STACK_OF(X509_INFO)* items =
+        PEM_X509_INFO_read_bio(bio, nullptr, nullptr, nullptr);
+    BIO_free(bio);
+    if (!items) continue;
+    for (int i = 0; i < sk_X509_INFO_num(items); ++i) {
+      X509_INFO* item = sk_X509_INFO_value(items, i);
+      if (item->x509) on_certificate(item->x509);
+      if (item->crl) on_crl(item->crl);
+    }
+    sk_X509_INFO_pop_free(items, X509_INFO_free);
+  }
+}
+
+}  // namespace
+
+struct CertificateChainBuilder::Backend {
+  X509_STORE* trust = nullptr;
+  STACK_OF(X509)* untrusted = nullptr;  // Every certificate, for path building.
+  std::unordered_map<std::string, X509*> by_thumbprint;
+
+  ~Backend() {
+    sk_X509_pop_free(untrusted, X509_free);
+    X509_STORE_free(trust);
+  }
+};
+
+CertificateChainBuilder::CertificateChainBuilder(
+    const std::string& certificate_directory, const std::string& ca_directory,
+    CertificateClock clock)
+    : clock_(std::move(clock)), backend_(std::make_unique<Backend>()) {
+  Backend* backend = backend_.get();
+  backend->trust = X509_STORE_new();
+  backend->untrusted = sk_X509_new_null();
+  if (!backend->trust || !backend->untrusted) throw std::bad_alloc();
+  ReadPemItems(
+      certificate_directory,
+      [backend](X509* cert) {
+        X509_up_ref(cert);
+        sk_X509_push(backend->untrusted, cert);
+        backend->by_thumbprint.emplace(Sha1Hex(cert), cert);
+      },
+      [](X509_CRL*) {});
+  ReadPemItems(
+      ca_directory,
+      [backend](X509* cert) { X509_STORE_add_cert(backend->trust, cert); },
+      [backend](X509_CRL* crl) { X509_STORE_add_crl(backend->trust, crl); });
+}
+
+std::unique_ptr<CertificateChain> CertificateChainBuilder::BuildUncached(
+    const std::string& thumbprint, bool check_revocation, int64_t now) {
+  auto leaf = backend_->by_thumbprint.find(CacheKey(thumbprint, false));
+  if (leaf == backend_->by_thumbprint.end()) return nullptr;
+
+  X509_STORE_CTX* context = X509_STORE_CTX_new();
+  if (!context ||
+      !X509_STORE_CTX_init(context, backend_->trust, leaf->second,
+                           backend_->untrusted)) {
+    X509_STORE_CTX_free(context);
+    throw std::runtime_error("X509_STORE_CTX_init failed");
+  }
+  X509_VERIFY_PARAM* param = X509_STORE_CTX_get0_param(context);
+  X509_VERIFY_PARAM_set_time(param, static_cast<time_t>(now / 1000));
+  if (check_revocation) {
+    X509_VERIFY_PARAM_set_flags(param,
+                                X509_V_FLAG_CRL_CHECK | X509_V_FLAG_CRL_CHECK_ALL);
+  }
+
+  auto chain = std::make_unique<CertificateChain>();
+  chain->trusted = X509_verify_cert(context) == 1;
+  if (!chain->trusted) {
+    chain->status =
+        X509_verify_cert_error_string(X509_STORE_CTX_get_error(context));
+  }
+  // On failure the context still holds the path built so far.
+  STACK_OF(X509)* path = X509_STORE_CTX_get0_chain(context);
+  int64_t expires_at = INT64_MAX;
+  for (int i = 0; path && i < sk_X509_num(path); ++i) {
+    X509* cert = sk_X509_value(path, i);
+    int len = i2d_X509(cert, nullptr);
+    if (len <= 0) continue;
+    std::vector<uint8_t> der(static_cast<size_t>(len));
+    uint8_t* out = der.data();
+    i2d_X509(cert, &out);
+    chain->certificates.push_back(std::move(der));
+    int64_t not_after = AsnTimeToUnixMillis(X509_get0_notAfter(cert));
+    if (not_after < expires_at) expires_at = not_after;
+  }
+  if (chain->certificates.empty()) {
+    // Nothing was built (e.g. the leaf itself failed a check); fall back to
+    // the leaf alone.
+    X509* cert = leaf->second;
+    int len = i2d_X509(cert, nullptr);
+    std::vector<uint8_t> der(static_cast<size_t>(len > 0 ? len : 0));
+    uint8_t* out = der.data();
+    if (len > 0) i2d_X509(cert, &out);
+    chain->certificates.push_back(std::move(der));
+    expires_at = AsnTimeToUnixMillis(X509_get0_notAfter(cert));
+  }
+  chain->expires_at = expires_at;
+  X509_STORE_CTX_free(context);
+  return chain;
+}
+#endif
+
+CertificateChainBuilder::~CertificateChainBuilder() = default;
+
+int64_t CertificateChainBuilder::Now() const {
+  if (clock_) return clock_();
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+std::shared_ptr<const CertificateChain> CertificateChainBuilder::Find(
+    const std::string& thumbprint, bool check_revocation) {
+  const std::string key = CacheKey(thumbprint, check_revocation);
+  const int64_t now = Now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = cache_.find(key);
+  if (it == cache_.end()) return nullptr;
+  if (now >= it->second->expires_at) {
+    cache_.erase(it);
+    return nullptr;
+  }
+  stats_.hits++;
+  return it->second;
+}
+
+std::shared_ptr<const CertificateChain> CertificateChainBuilder::Build(
+    const std::string& thumbprint, bool check_revocation) {
+  if (auto cached = Find(thumbprint, check_revocation)) return cached;
+
+  // Built outside the lock: revocation checks may block on the network.
+  const int64_t now = Now();
+  std::unique_ptr<CertificateChain> built =
+      BuildUncached(thumbprint, check_revocation, now);
+  if (!built) return nullptr;
+  const int64_t ttl = built->trusted && !check_revocation ? kTrustedTtlMs
+                                                          : kShortTtlMs;
+  // An already-expired chain is still cached briefly, so repeated requests
+  // for it do not each rebuild.
+  if (built->expires_at <= now || built->expires_at > now + ttl) {
+    built->expires_at = now + ttl;
+  }
+  std::shared_ptr<const CertificateChain> chain = std::move(built);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.misses++;
+  if (cache_.size() >= kMaxEntries) {
+    for (auto it = cache_.begin(); it != cache_.end();) {
+      it = now >= it->second->expires_at ? cache_.erase(it) : std::next(it);
+    }
+    if (cache_.size() >= kMaxEntries) cache_.clear();
+  }
+  cache_[CacheKey(thumbprint, check_revocation)] = chain;
+  return chain;
+}
+
+void CertificateChainBuilder::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  cache_.clear();
+}
+
+CertificateChainCacheStats CertificateChainBuilder::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CertificateChainCacheStats stats = stats_;
+  stats.entries = cache_.size();
+  return stats;
+}
+
+}  // namespace flutter_native_utils
@@ -0,0 +1,100 @@
+#ifndef FLUTTER_PLUGIN_CERTIFICATE_CHAIN_H_
+#define FLUTTER_PLUGIN_CERTIFICATE_CHAIN_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace flutter_native_utils {
+
+struct CertificateChain {
+  std::vector<std::vector<uint8_t>> certificates;  // DER, leaf first.
+  bool trusted = false;
+  std::string status;  // Why the chain is not trusted; empty if it is.
+  // When the cached chain must be rebuilt: the earliest expiry in the chain,
+  // capped by a TTL. Milliseconds since the Unix epoch.
+  int64_t expires_at = 0;
+};
+
+struct CertificateChainCacheStats {
+  size_t hits = 0;
+  size_t misses = 0;
+  size_t entries = 0;
+};
+
+// Milliseconds since the Unix epoch; injectable for tests.
+using CertificateClock = std::function<int64_t()>;
+
+// Builds and validates certificate chains for leaves identified by SHA-1
+// thumbprint, and caches the result per leaf (and revocation mode). A cached
+// chain is reused until the first certificate in it expires or its TTL runs
+// out, whichever is sooner; chains that were not trusted, or whose revocation
+// status was checked, get a shorter TTL.
+//
+// On Windows leaves are looked up in the current-user, then local-machine
+// "MY" store, and chains are built by a private CryptoAPI chain engine kept
+// for the builder's lifetime, so its intermediate and URL caches stay warm.
+// On Linux hosts leaves and intermediates come from a PEM directory and trust
+// anchors (and CRLs) from a second one, both read once at construction.
+// Thread-safe; concurrent misses for the same leaf may both build.
+class CertificateChainBuilder {
+ public:
+  static constexpr int64_t kTrustedTtlMs = 60 * 60 * 1000;
+  static constexpr int64_t kShortTtlMs = 5 * 60 * 1000;
+  static constexpr size_t kMaxEntries = 256;
+
+#ifdef _WIN32
+  // Throws std::runtime_error if the chain engine cannot be created.
+  explicit CertificateChainBuilder(CertificateClock clock = nullptr);
+#else
+  CertificateChainBuilder(const std::string& certificate_directory,
+                          const std::string& ca_directory,
+                          CertificateClock clock = nullptr);
+#endif
+  ~CertificateChainBuilder();
+
+  // Disallow copy and assign.
+  CertificateChainBuilder(const CertificateChainBuilder&) = delete;
+  CertificateChainBuilder& operator=(const CertificateChainBuilder&) = delete;
+
+  // Returns the cached chain for |thumbprint| (hex, any case) if it is still
+  // fresh, without building. Never blocks on the network.
+  std::shared_ptr<const CertificateChain> Find(const std::string& thumbprint,
+                                               bool check_revocation);
+
+  // Returns the chain for |thumbprint|, building and caching it if needed.
+  // Returns null if no such leaf exists. With |check_revocation| this may
+  // block on CRL/OCSP retrieval.
+  std::shared_ptr<const CertificateChain> Build(const std::string& thumbprint,
+                                                bool check_revocation);
+
+  void Clear();
+
+  CertificateChainCacheStats stats() const;
+
+ private:
+  struct Backend;
+
+  // Builds without consulting the cache; null if the leaf is unknown.
+  std::unique_ptr<CertificateChain> BuildUncached(const std::string& thumbprint,
+                                                  bool check_revocation,
+                                                  int64_t now);
+  int64_t Now() const;
+
+  CertificateClock clock_;
+  std::unique_ptr<Backend> backend_;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, std::shared_ptr<const CertificateChain>>
+      cache_;
+  CertificateChainCacheStats stats_;
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_CERTIFICATE_CHAIN_H_
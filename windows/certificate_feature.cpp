@@ -0,0 +1,790 @@
+#include "plugin_feature.h"
+
+#include <windows.h>
+
+#include <wincrypt.h>
+
+#include <flutter/encodable_value.h>
+
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "certificate_chain.h"
+#include "certificate_index.h"
+#include "certificate_signer.h"
+#include "secure_buffer.h"
+#include "startup_timeline.h"
+
+#pragma comment(lib, "crypt32.lib")
+
+namespace flutter_native_utils {
+
+// ---------- Helper Functions ----------
+static std::vector<BYTE> HexStringToBytes(const std::string& hex) {
+  std::vector<BYTE> bytes;
+  for (size_t i = 0; i < hex.length(); i += 2) {
+    std::string byteString = hex.substr(i, 2);
+    BYTE byte = static_cast<BYTE>(strtol(byteString.c_str(), nullptr, 16));
+    bytes.push_back(byte);
+  }
+  return bytes;
+}
+
+// Converts secret text (e.g. a password) to a NUL-terminated wide string held
+// in locked memory that is wiped on release.
+static SecureWideChars Utf8ToSecureWide(const std::string& str) {
+  int len = str.empty() ? 0
+                        : MultiByteToWideChar(CP_UTF8, 0, str.c_str(),
+                                              static_cast<int>(str.size()),
+                                              nullptr, 0);
+  SecureWideChars result(static_cast<size_t>(len) + 1, L'\0');
+  if (len > 0) {
+    MultiByteToWideChar(CP_UTF8, 0, str.c_str(), static_cast<int>(str.size()),
+                        result.data(), len);
+  }
+  return result;
+}
+
+// ---------- GetCertificate ----------
+static std::wstring GetCertificate(const std::string& thumbprint, 
+                                   SecureBytes& certBytes,
+                                   const SecureWideChars& wPassword) {
+  HCERTSTORE hStore = CertOpenStore(
+      CERT_STORE_PROV_SYSTEM,
+      0,
+      NULL,
+      CERT_SYSTEM_STORE_CURRENT_USER,
+      L"MY"
+  );
+
+  if (!hStore) {
+    return L"Failed to open certificate store.";
+  }
+
+  std::vector<BYTE> binaryThumbprint = HexStringToBytes(thumbprint);
+  
+  CRYPT_HASH_BLOB hashBlob;
+  hashBlob.cbData = static_cast<DWORD>(binaryThumbprint.size());
+  hashBlob.pbData = binaryThumbprint.data();
+
+  PCCERT_CONTEXT pCertContext = CertFindCertificateInStore(
+      hStore,
+      X509_ASN_ENCODING | PKCS_7_ASN_ENCODING,
+      0,
+      CERT_FIND_HASH,
+      &hashBlob,
+      NULL
+  );
+
+  if (!pCertContext) {
+    CertCloseStore(hStore, 0);
+    return L"Certificate not found.";
+  }
+
+  // Create a temporary memory store for PFX export
+  HCERTSTORE hMemStore = CertOpenStore(
+      CERT_STORE_PROV_MEMORY,
+      0,
+      NULL,
+      0,
+      NULL
+  );
+
+  if (!hMemStore) {
+    CertFreeCertificateContext(pCertContext);
+    CertCloseStore(hStore, 0);
+    return L"Failed to create memory store.";
+  }
+
+  // Add certificate with private key to memory store
+  if (!CertAddCertificateContextToStore(hMemStore, pCertContext, 
+                                        CERT_STORE_ADD_ALWAYS, NULL)) {
+    CertCloseStore(hMemStore, 0);
+    CertFreeCertificateContext(pCertContext);
+    CertCloseStore(hStore, 0);
+    return L"Failed to add certificate to memory store.";
+  }
+
+  // Export as PFX
+  CRYPT_DATA_BLOB pfxBlob = { 0 };
+  pfxBlob.cbData = 0;
+  pfxBlob.pbData = NULL;
+
+  // Get required size
+  if (!PFXExportCertStoreEx(hMemStore, &pfxBlob, wPassword.data(), NULL,
+                            EXPORT_PRIVATE_KEYS)) {
+    CertCloseStore(hMemStore, 0);
+    CertFreeCertificateContext(pCertContext);
+    CertCloseStore(hStore, 0);
+    return L"Failed to get PFX size.";
+  }
+
+  // Allocate and export
+  certBytes.resize(pfxBlob.cbData);
+  pfxBlob.pbData = certBytes.data();
+
+  if (!PFXExportCertStoreEx(hMemStore, &pfxBlob, wPassword.data(), NULL,
+                            EXPORT_PRIVATE_KEYS)) {
+    CertCloseStore(hMemStore, 0);
+    CertFreeCertificateContext(pCertContext);
+    CertCloseStore(hStore, 0);
+    return L"Failed to export PFX.";
+  }
+
+  CertCloseStore(hMemStore, 0);
+  CertFreeCertificateContext(pCertContext);
+  CertCloseStore(hStore, 0);
+
+  return L"Success";
+}
+
+class CertificateFeature : public PluginFeature {
+ public:
+  explicit CertificateFeature(const FeatureContext& context)
+      : context_(context) {}
+
+  void Register(MethodRegistry* registry) override;
+  // The store warmed by "certificateIndex" is "MY".
+  std::vector<std::string> PrewarmBackends() const override {
+    return {"certificateIndex"};
+  }
+  std::function<void()> Prewarm(const std::string& backend) override;
+
+ private:
+  struct CertificateStoreCache {
+    // Indexed by CertificateStoreLocation; null if the store could not be
+    // opened there.
+    std::unique_ptr<SystemCertificateStore> stores[2];
+    std::shared_ptr<const CertificateIndex> index;
+    int64_t generation = 0;
+  };
+  // Opens the stores of |cache| that are not open yet and rebuilds its index
+  // if either changed. Returns true if it did. Touches no feature state, so
+  // it may run on a worker. Throws std::runtime_error if the store exists in
+  // neither location.
+  static bool RefreshCertificateStore(const std::string& store_name,
+                                      CertificateStoreCache* cache);
+  // True if neither open store of |cache| changed since its index was built,
+  // so it can answer a first page without a rebuild. Cheap enough for the
+  // platform thread.
+  static bool IsCurrent(const CertificateStoreCache& cache);
+  // Opens |store_name| afresh and indexes it. Enumerating a store may take a
+  // while, so this runs on a worker; a first build is recorded on
+  // |timeline|. Throws std::runtime_error if the store exists in neither
+  // location.
+  static std::shared_ptr<CertificateStoreCache> BuildCertificateStore(
+      const std::string& store_name, bool first_use,
+      StartupTimeline* timeline);
+  // Makes |cache| the one of |store_name|, under a new generation.
+  const CertificateStoreCache& AdoptCertificateStore(
+      const std::string& store_name, CertificateStoreCache cache);
+
+  void HandleGetCertificate(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleEnumerateCertificates(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleGetCertificateChain(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleSignWithCertificate(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  FeatureContext context_;
+  std::unordered_map<std::string, CertificateStoreCache> certificate_stores_;
+  // Shared across store names so a page token cannot match another store.
+  int64_t next_certificate_generation_ = 1;
+};
+
+// ---------- Certificate Export ----------
+// Exports |thumbprint| as a PFX protected by |password| into |certificate|.
+// Returns an error message, or an empty string on success.
+static std::string ExportCertificate(const std::string& thumbprint,
+                                     const SecureWideChars& password,
+                                     flutter::EncodableValue* certificate) {
+  SecureBytes certBytes;
+  std::wstring msg = GetCertificate(thumbprint, certBytes, password);
+  if (msg != L"Success") return WideToUtf8(msg);
+  *certificate = flutter::EncodableValue(flutter::EncodableMap{
+      {flutter::EncodableValue("certificate"),
+       flutter::EncodableValue(
+           std::vector<uint8_t>(certBytes.begin(), certBytes.end()))},
+  });
+  return std::string();
+}
+
+void CertificateFeature::HandleGetCertificate(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* arguments = std::get_if<flutter::EncodableMap>(call.arguments());
+  if (!arguments) {
+    result->Error("BAD_ARGS", "Invalid arguments");
+    return;
+  }
+
+  const flutter::EncodableValue* thumbprint_value =
+      FindArgument(*arguments, "thumbprint");
+  const auto* thumbprint =
+      thumbprint_value ? std::get_if<std::string>(thumbprint_value) : nullptr;
+  if (!thumbprint) {
+    result->Error("BAD_ARGS", "Missing thumbprint parameter");
+    return;
+  }
+
+  // Optional password parameter (empty if not provided). Converted here,
+  // straight from the arguments into locked, zeroizing memory, so the worker
+  // gets no plaintext copy of it; the call itself is not copied.
+  auto password = std::make_shared<SecureWideChars>(1, L'\0');
+  if (const flutter::EncodableValue* value =
+          FindArgument(*arguments, "password")) {
+    const auto* text = std::get_if<std::string>(value);
+    if (!text) {
+      result->Error("BAD_ARGS", "password must be a string");
+      return;
+    }
+    *password = Utf8ToSecureWide(*text);
+  }
+
+  if (!context_.route) {
+    flutter::EncodableValue certificate;
+    std::string error = ExportCertificate(*thumbprint, *password, &certificate);
+    if (error.empty()) {
+      result->Success(certificate);
+    } else {
+      result->Error("FAILURE", error);
+    }
+    return;
+  }
+  WorkerPool* workers = nullptr;
+  try {
+    workers = context_.hub->workers();
+  } catch (const std::exception& ex) {
+    result->Error("FAILURE", ex.what());
+    return;
+  }
+  // Exporting a key may wait on a hardware token, so it runs on the workers.
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result =
+      std::move(result);
+  workers->Post([route = context_.route, thumbprint = *thumbprint, password,
+                 shared_result]() {
+    auto certificate = std::make_shared<flutter::EncodableValue>();
+    std::string error;
+    try {
+      error = ExportCertificate(thumbprint, *password, certificate.get());
+    } catch (const std::exception& ex) {
+      error = ex.what();
+    }
+    route->Post([shared_result, certificate, error]() {
+      if (error.empty()) {
+        shared_result->Success(*certificate);
+      } else {
+        shared_result->Error("FAILURE", error);
+      }
+    });
+  }, TaskPriority::kBulk);
+}
+
+// ---------- Certificate Enumeration ----------
+static std::optional<int64_t> OptionalTimeArgument(
+    const flutter::EncodableMap& args, const char* name) {
+  const flutter::EncodableValue* value = FindArgument(args, name);
+  if (!value || value->IsNull()) return std::nullopt;
+  if (!std::holds_alternative<int32_t>(*value) &&
+      !std::holds_alternative<int64_t>(*value)) {
+    throw std::invalid_argument(std::string(name) +
+                                " must be milliseconds since the epoch");
+  }
+  return value->LongValue();
+}
+
+static CertificateFilter CertificateFilterArgument(
+    const flutter::EncodableMap& args) {
+  CertificateFilter filter;
+  filter.subject_contains = OptionalStringArgument(args, "subjectContains");
+  filter.issuer_contains = OptionalStringArgument(args, "issuerContains");
+  filter.eku = OptionalStringArgument(args, "eku");
+  filter.valid_from = OptionalTimeArgument(args, "validFrom");
+  filter.valid_to = OptionalTimeArgument(args, "validTo");
+  const flutter::EncodableValue* has_key = FindArgument(args, "hasPrivateKey");
+  if (has_key && !has_key->IsNull()) {
+    const auto* flag = std::get_if<bool>(has_key);
+    if (!flag) throw std::invalid_argument("hasPrivateKey must be a bool");
+    filter.has_private_key = *flag;
+  }
+  std::string location = OptionalStringArgument(args, "storeLocation");
+  if (!location.empty()) {
+    CertificateStoreLocation parsed;
+    if (!ParseCertificateStoreLocation(location, &parsed)) {
+      throw std::invalid_argument(
+          "storeLocation must be currentUser or localMachine");
+    }
+    filter.location = parsed;
+  }
+  return filter;
+}
+
+static flutter::EncodableMap CertificateInfoToMap(const CertificateInfo& info) {
+  flutter::EncodableList ekus;
+  for (const std::string& oid : info.ekus) {
+    ekus.push_back(flutter::EncodableValue(oid));
+  }
+  return {
+      {flutter::EncodableValue("thumbprint"),
+       flutter::EncodableValue(info.thumbprint)},
+      {flutter::EncodableValue("subject"), flutter::EncodableValue(info.subject)},
+      {flutter::EncodableValue("issuer"), flutter::EncodableValue(info.issuer)},
+      {flutter::EncodableValue("serialNumber"),
+       flutter::EncodableValue(info.serial_number)},
+      {flutter::EncodableValue("notBefore"),
+       flutter::EncodableValue(info.not_before)},
+      {flutter::EncodableValue("notAfter"),
+       flutter::EncodableValue(info.not_after)},
+      {flutter::EncodableValue("ekus"), flutter::EncodableValue(ekus)},
+      {flutter::EncodableValue("hasPrivateKey"),
+       flutter::EncodableValue(info.has_private_key)},
+      {flutter::EncodableValue("storeLocation"),
+       flutter::EncodableValue(CertificateStoreLocationName(info.location))},
+  };
+}
+
+bool CertificateFeature::RefreshCertificateStore(
+    const std::string& store_name, CertificateStoreCache* cache) {
+  static const CertificateStoreLocation kLocations[] = {
+      CertificateStoreLocation::kCurrentUser,
+      CertificateStoreLocation::kLocalMachine};
+  bool changed = !cache->index;
+  bool opened = false;
+  for (size_t i = 0; i < 2; ++i) {
+    if (!cache->stores[i]) {
+      try {
+        cache->stores[i] =
+            std::make_unique<SystemCertificateStore>(kLocations[i], store_name);
+      } catch (const std::runtime_error&) {
+        // A store may exist in only one location.
+        continue;
+      }
+    }
+    opened = true;
+    changed = changed || cache->stores[i]->Changed();
+  }
+  if (!opened) {
+    throw std::runtime_error("Failed to open certificate store " + store_name);
+  }
+  if (changed) {
+    std::vector<CertificateInfo> certificates;
+    for (auto& store : cache->stores) {
+      if (!store) continue;
+      std::vector<CertificateInfo> read = store->Read();
+      certificates.insert(certificates.end(),
+                          std::make_move_iterator(read.begin()),
+                          std::make_move_iterator(read.end()));
+    }
+    cache->index = std::make_shared<CertificateIndex>(std::move(certificates));
+  }
+  return changed;
+}
+
+bool CertificateFeature::IsCurrent(const CertificateStoreCache& cache) {
+  if (!cache.index) return false;
+  for (const auto& store : cache.stores) {
+    if (store && store->Changed()) return false;
+  }
+  return true;
+}
+
+std::shared_ptr<CertificateFeature::CertificateStoreCache>
+CertificateFeature::BuildCertificateStore(const std::string& store_name,
+                                          bool first_use,
+                                          StartupTimeline* timeline) {
+  auto cache = std::make_shared<CertificateStoreCache>();
+  const int64_t start = timeline->Now();
+  try {
+    RefreshCertificateStore(store_name, cache.get());
+  } catch (const std::exception& ex) {
+    if (first_use) {
+      timeline->Record("certificateIndex/" + store_name,
+                       StartupPhase::kFirstUse, start, ex.what());
+    }
+    throw;
+  }
+  if (first_use) {
+    timeline->Record("certificateIndex/" + store_name, StartupPhase::kFirstUse,
+                     start);
+  }
+  return cache;
+}
+
+const CertificateFeature::CertificateStoreCache&
+CertificateFeature::AdoptCertificateStore(const std::string& store_name,
+                                          CertificateStoreCache cache) {
+  // Only reached once a store opened, so unknown names add no entry.
+  CertificateStoreCache& adopted = certificate_stores_[store_name];
+  adopted = std::move(cache);
+  adopted.generation = next_certificate_generation_++;
+  return adopted;
+}
+
+// A page token is "<index generation>.<cursor>". Later pages are served from
+// the snapshot the first page was, so a listing stays consistent.
+static void AnswerCertificatePage(
+    const CertificateIndex& index, int64_t generation,
+    const CertificateFilter& filter, size_t cursor, int32_t page_size,
+    flutter::MethodResult<flutter::EncodableValue>* result) {
+  try {
+    CertificatePage page =
+        index.Query(filter, cursor, static_cast<size_t>(page_size));
+    flutter::EncodableList certificates;
+    certificates.reserve(page.certificates.size());
+    for (const CertificateInfo& info : page.certificates) {
+      certificates.push_back(flutter::EncodableValue(CertificateInfoToMap(info)));
+    }
+    flutter::EncodableMap response = {
+        {flutter::EncodableValue("certificates"),
+         flutter::EncodableValue(std::move(certificates))},
+        {flutter::EncodableValue("nextPageToken"),
+         page.done ? flutter::EncodableValue()
+                   : flutter::EncodableValue(std::to_string(generation) + "." +
+                                             std::to_string(page.next_cursor))},
+    };
+    result->Success(flutter::EncodableValue(std::move(response)));
+  } catch (const std::exception& ex) {
+    result->Error("FAILURE", ex.what());
+  }
+}
+
+void CertificateFeature::HandleEnumerateCertificates(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  constexpr int32_t kMaxPageSize = 1000;
+  static const flutter::EncodableMap kNoArguments;
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  if (!args) args = &kNoArguments;
+
+  CertificateFilter filter;
+  std::string store_name;
+  std::string page_token;
+  int32_t page_size = 100;
+  try {
+    filter = CertificateFilterArgument(*args);
+    store_name = OptionalStringArgument(*args, "storeName");
+    if (store_name.empty()) store_name = "MY";
+    page_token = OptionalStringArgument(*args, "pageToken");
+    if (const flutter::EncodableValue* value = FindArgument(*args, "pageSize")) {
+      const auto* size = std::get_if<int32_t>(value);
+      if (!size || *size <= 0 || *size > kMaxPageSize) {
+        throw std::invalid_argument("pageSize must be between 1 and 1000");
+      }
+      page_size = *size;
+    }
+  } catch (const std::invalid_argument& ex) {
+    result->Error("BAD_ARGS", ex.what());
+    return;
+  }
+
+  auto it = certificate_stores_.find(store_name);
+  if (!page_token.empty()) {
+    size_t dot = page_token.find('.');
+    char* end = nullptr;
+    const int64_t token_generation =
+        std::strtoll(page_token.c_str(), &end, 10);
+    if (dot == std::string::npos || end != page_token.c_str() + dot) {
+      result->Error("BAD_ARGS", "Malformed pageToken");
+      return;
+    }
+    const size_t cursor = static_cast<size_t>(
+        std::strtoull(page_token.c_str() + dot + 1, nullptr, 10));
+    if (it == certificate_stores_.end() ||
+        it->second.generation != token_generation) {
+      result->Error("BAD_ARGS",
+                    "pageToken has expired; restart the enumeration");
+      return;
+    }
+    AnswerCertificatePage(*it->second.index, token_generation, filter, cursor,
+                          page_size, result.get());
+    return;
+  }
+
+  // First pages are answered inline from an index that is still current;
+  // building or rebuilding one goes to the workers.
+  if (it != certificate_stores_.end() && IsCurrent(it->second)) {
+    AnswerCertificatePage(*it->second.index, it->second.generation, filter, 0,
+                          page_size, result.get());
+    return;
+  }
+  const bool first_use = it == certificate_stores_.end();
+  StartupTimeline* timeline = &context_.hub->timeline();
+  if (!context_.route) {
+    try {
+      const CertificateStoreCache& cache = AdoptCertificateStore(
+          store_name,
+          std::move(*BuildCertificateStore(store_name, first_use, timeline)));
+      AnswerCertificatePage(*cache.index, cache.generation, filter, 0,
+                            page_size, result.get());
+    } catch (const std::exception& ex) {
+      result->Error("FAILURE", ex.what());
+    }
+    return;
+  }
+  WorkerPool* workers = nullptr;
+  try {
+    workers = context_.hub->workers();
+  } catch (const std::exception& ex) {
+    result->Error("FAILURE", ex.what());
+    return;
+  }
+
+  // As in Prewarm, the worker fills a cache of its own for the platform
+  // thread to adopt.
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result =
+      std::move(result);
+  workers->Post([this, route = context_.route, store_name, first_use,
+                 timeline, filter, page_size, shared_result]() {
+    std::shared_ptr<CertificateStoreCache> cache;
+    std::string error;
+    try {
+      cache = BuildCertificateStore(store_name, first_use, timeline);
+    } catch (const std::exception& ex) {
+      error = ex.what();
+    }
+    // Runs only while the engine, and so this feature, is alive.
+    route->Post([this, store_name, cache, error, filter, page_size,
+                 shared_result]() {
+      if (!cache) {
+        shared_result->Error("FAILURE", error);
+        return;
+      }
+      const CertificateStoreCache& adopted =
+          AdoptCertificateStore(store_name, std::move(*cache));
+      AnswerCertificatePage(*adopted.index, adopted.generation, filter, 0,
+                            page_size, shared_result.get());
+    });
+  }, TaskPriority::kBulk);
+}
+
+// ---------- Certificate Chains ----------
+static flutter::EncodableValue CertificateChainToValue(
+    const CertificateChain& chain) {
+  flutter::EncodableList certificates;
+  certificates.reserve(chain.certificates.size());
+  for (const std::vector<uint8_t>& der : chain.certificates) {
+    certificates.push_back(flutter::EncodableValue(der));
+  }
+  return flutter::EncodableValue(flutter::EncodableMap{
+      {flutter::EncodableValue("certificates"),
+       flutter::EncodableValue(std::move(certificates))},
+      {flutter::EncodableValue("trusted"), flutter::EncodableValue(chain.trusted)},
+      {flutter::EncodableValue("status"),
+       chain.status.empty() ? flutter::EncodableValue()
+                            : flutter::EncodableValue(chain.status)},
+  });
+}
+
+void CertificateFeature::HandleGetCertificateChain(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  const flutter::EncodableValue* thumbprint_value =
+      args ? FindArgument(*args, "thumbprint") : nullptr;
+  const auto* thumbprint =
+      thumbprint_value ? std::get_if<std::string>(thumbprint_value) : nullptr;
+  if (!thumbprint) {
+    result->Error("BAD_ARGS", "Missing thumbprint parameter");
+    return;
+  }
+  const flutter::EncodableValue* revocation =
+      FindArgument(*args, "checkRevocation");
+  if (revocation && !std::holds_alternative<bool>(*revocation)) {
+    result->Error("BAD_ARGS", "checkRevocation must be a bool");
+    return;
+  }
+  const bool check_revocation = revocation && std::get<bool>(*revocation);
+
+  CertificateChainBuilder* builder = nullptr;
+  WorkerPool* workers = nullptr;
+  try {
+    builder = context_.hub->chain_builder();
+    // Cache hits are answered inline; only builds go to the workers.
+    if (auto cached = builder->Find(*thumbprint, check_revocation)) {
+      result->Success(CertificateChainToValue(*cached));
+      return;
+    }
+    if (context_.route) workers = context_.hub->workers();
+  } catch (const std::exception& ex) {
+    result->Error("FAILURE", ex.what());
+    return;
+  }
+  if (!context_.route) {
+    result->Error("UNAVAILABLE", "Building certificate chains requires a registrar");
+    return;
+  }
+
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result =
+      std::move(result);
+  workers->Post([route = context_.route, builder,
+                                 thumbprint = *thumbprint, check_revocation,
+                                 shared_result]() {
+    std::shared_ptr<const CertificateChain> chain;
+    std::string error;
+    try {
+      chain = builder->Build(thumbprint, check_revocation);
+      if (!chain) error = "Certificate not found.";
+    } catch (const std::exception& ex) {
+      error = ex.what();
+    }
+    route->Post([shared_result, chain, error]() {
+      if (chain) {
+        shared_result->Success(CertificateChainToValue(*chain));
+      } else {
+        shared_result->Error("FAILURE", error);
+      }
+    });
+  });
+}
+
+// ---------- Certificate Signing ----------
+void CertificateFeature::HandleSignWithCertificate(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  if (!args) {
+    result->Error("BAD_ARGS", "Invalid arguments");
+    return;
+  }
+  const flutter::EncodableValue* thumbprint_value =
+      FindArgument(*args, "thumbprint");
+  const auto* thumbprint =
+      thumbprint_value ? std::get_if<std::string>(thumbprint_value) : nullptr;
+  if (!thumbprint) {
+    result->Error("BAD_ARGS", "Missing thumbprint parameter");
+    return;
+  }
+  SignatureHash hash = SignatureHash::kSha256;
+  SignaturePadding padding = SignaturePadding::kPkcs1;
+  std::vector<uint8_t> input;
+  bool prehashed = false;
+  try {
+    std::string hash_name = OptionalStringArgument(*args, "hash");
+    if (!hash_name.empty() && !ParseSignatureHash(hash_name, &hash)) {
+      throw std::invalid_argument("hash must be sha256, sha384 or sha512");
+    }
+    std::string padding_name = OptionalStringArgument(*args, "padding");
+    if (!padding_name.empty() && !ParseSignaturePadding(padding_name, &padding)) {
+      throw std::invalid_argument("padding must be pkcs1 or pss");
+    }
+    prehashed = FindArgument(*args, "digest") != nullptr;
+    if (prehashed == (FindArgument(*args, "data") != nullptr)) {
+      throw std::invalid_argument("Pass exactly one of data and digest");
+    }
+    input = BytesArgument(*args, prehashed ? "digest" : "data", true);
+    if (prehashed && input.size() != SignatureHashLength(hash)) {
+      throw std::invalid_argument("digest length does not match hash");
+    }
+  } catch (const std::invalid_argument& ex) {
+    result->Error("BAD_ARGS", ex.what());
+    return;
+  } catch (const std::exception& ex) {
+    result->Error("FAILURE", ex.what());
+    return;
+  }
+  if (!context_.route) {
+    result->Error("UNAVAILABLE", "Signing with certificates requires a registrar");
+    return;
+  }
+
+  // Opening an uncached key, or signing with a hardware-backed one, may
+  // take a while, so both run on the workers.
+  CertificateSigner* signer = nullptr;
+  WorkerPool* workers = nullptr;
+  try {
+    signer = context_.hub->certificate_signer();
+    workers = context_.hub->workers();
+  } catch (const std::exception& ex) {
+    result->Error("FAILURE", ex.what());
+    return;
+  }
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result =
+      std::move(result);
+  workers->Post([route = context_.route, signer,
+                                 thumbprint = *thumbprint, hash, padding,
+                                 input = std::move(input), prehashed,
+                                 shared_result]() {
+    std::vector<uint8_t> signature;
+    std::string code;
+    std::string error;
+    try {
+      std::shared_ptr<const CertificateKey> key = signer->Key(thumbprint);
+      if (!key) {
+        code = "FAILURE";
+        error = "Certificate or private key not found.";
+      } else if (prehashed) {
+        signature = key->SignDigest(hash, padding, input.data(), input.size());
+      } else {
+        signature = key->Sign(hash, padding, input.data(), input.size());
+      }
+    } catch (const std::exception& ex) {
+      code = "CNG_ERROR";
+      error = ex.what();
+    }
+    route->Post([shared_result, signature = std::move(signature), code,
+                 error]() {
+      if (code.empty()) {
+        shared_result->Success(flutter::EncodableValue(signature));
+      } else {
+        shared_result->Error(code, error);
+      }
+    });
+  }, TaskPriority::kInteractive);
+}
+
+// ---------- Registration ----------
+void CertificateFeature::Register(MethodRegistry* registry) {
+  (*registry)["GetCertificate"] = [this](const auto& call, auto result) {
+    HandleGetCertificate(call, std::move(result));
+  };
+  (*registry)["EnumerateCertificates"] = [this](const auto& call,
+                                                auto result) {
+    HandleEnumerateCertificates(call, std::move(result));
+  };
+  (*registry)["GetCertificateChain"] = [this](const auto& call, auto result) {
+    HandleGetCertificateChain(call, std::move(result));
+  };
+  (*registry)["SignWithCertificate"] = [this](const auto& call, auto result) {
+    HandleSignWithCertificate(call, std::move(result));
+  };
+}
+
+std::function<void()> CertificateFeature::Prewarm(const std::string&) {
+  // Built into a detached cache and adopted on the platform thread, which
+  // owns certificate_stores_.
+  StartupTimeline& timeline = context_.hub->timeline();
+  const int64_t start = timeline.Now();
+  auto store = std::make_shared<CertificateStoreCache>();
+  try {
+    RefreshCertificateStore("MY", store.get());
+  } catch (const std::exception& ex) {
+    timeline.Record("certificateIndex/MY", StartupPhase::kPrewarm, start,
+                    ex.what());
+    throw;
+  }
+  timeline.Record("certificateIndex/MY", StartupPhase::kPrewarm, start);
+  return [this, store]() {
+    if (certificate_stores_.find("MY") == certificate_stores_.end()) {
+      AdoptCertificateStore("MY", std::move(*store));
+    }
+  };
+}
+
+std::shared_ptr<PluginFeature> CreateCertificateFeature(
+    const FeatureContext& context) {
+  return std::make_shared<CertificateFeature>(context);
+}
+
+}  // namespace flutter_native_utils
@@ -0,0 +1,565 @@
+#include "certificate_index.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <wincrypt.h>
+
+#pragma comment(lib, "crypt32.lib")
+#else
+#include <openssl/asn1.h>
+#include <openssl/bio.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace flutter_native_utils {
+
+namespace {
+
+constexpr char kAnyExtendedKeyUsage[] = "2.5.29.37.0";
+
+std::string FoldCase(const std::string& text) {
+  std::string folded = text;
+  for (char& c : folded) {
+    if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+  }
+  return folded;
+}
+
+std::string HexUpper(const uint8_t* data, size_t len) {
+  static const char kDigits[] = "0123456789ABCDEF";
+  std::string hex;
+  hex.reserve(len * 2);
+  for (size_t i = 0; i < len; ++i) {
+    hex.push_back(kDigits[data[i] >> 4]);
+    hex.push_back(kDigits[data[i] & 0xf]);
+  }
+  return hex;
+}
+
+}  // namespace
+
+bool ParseCertificateStoreLocation(const std::string& name,
+                                   CertificateStoreLocation* location) {
+  if (name == "currentUser") {
+    *location = CertificateStoreLocation::kCurrentUser;
+    return true;
+  }
+  if (name == "localMachine") {
+    *location = CertificateStoreLocation::kLocalMachine;
+    return true;
+  }
+  return false;
+}
+
+const char* CertificateStoreLocationName(CertificateStoreLocation location) {
+  return location == CertificateStoreLocation::kCurrentUser ? "currentUser"
+                                                            : "localMachine";
+}
+
+std::string ResolveEkuOid(const std::string& name_or_oid) {
+  static const std::pair<const char*, const char*> kNames[] = {
+      {"serverAuth", "1.3.6.1.5.5.7.3.1"},
+      {"clientAuth", "1.3.6.1.5.5.7.3.2"},
+      {"codeSigning", "1.3.6.1.5.5.7.3.3"},
+      {"emailProtection", "1.3.6.1.5.5.7.3.4"},
+      {"timeStamping", "1.3.6.1.5.5.7.3.8"},
+  };
+  for (const auto& name : kNames) {
+    if (name_or_oid == name.first) return name.second;
+  }
+  return name_or_oid;
+}
+
+// ---------- CertificateIndex ----------
+
+struct CertificateIndex::PreparedFilter {
+  std::string subject;
+  std::string issuer;
+  std::string eku;
+  bool has_window = false;
+  int64_t window_start = 0;
+  int64_t window_end = 0;
+  std::optional<bool> has_private_key;
+  std::optional<CertificateStoreLocation> location;
+
+  explicit PreparedFilter(const CertificateFilter& filter)
+      : subject(FoldCase(filter.subject_contains)),
+        issuer(FoldCase(filter.issuer_contains)),
+        eku(filter.eku.empty() ? std::string() : ResolveEkuOid(filter.eku)),
+        has_private_key(filter.has_private_key),
+        location(filter.location) {
+    if (filter.valid_from || filter.valid_to) {
+      has_window = true;
+      window_start = filter.valid_from ? *filter.valid_from : *filter.valid_to;
+      window_end = filter.valid_to ? *filter.valid_to : *filter.valid_from;
+    }
+  }
+};
+
+CertificateIndex::CertificateIndex(std::vector<CertificateInfo> certificates) {
+  entries_.reserve(certificates.size());
+  for (CertificateInfo& info : certificates) {
+    Entry entry;
+    entry.folded_subject = FoldCase(info.subject);
+    entry.folded_issuer = FoldCase(info.issuer);
+    entry.info = std::move(info);
+    entries_.push_back(std::move(entry));
+  }
+}
+
+bool CertificateIndex::Matches(const Entry& entry,
+                               const PreparedFilter& filter) {
+  // Cheapest tests first; the substring searches run last.
+  const CertificateInfo& info = entry.info;
+  if (filter.location && info.location != *filter.location) return false;
+  if (filter.has_private_key && info.has_private_key != *filter.has_private_key) {
+    return false;
+  }
+  if (filter.has_window && (info.not_before > filter.window_start ||
+                            info.not_after < filter.window_end)) {
+    return false;
+  }
+  if (!filter.eku.empty() && !info.ekus.empty()) {
+    bool found = false;
+    for (const std::string& oid : info.ekus) {
+      if (oid == filter.eku || oid == kAnyExtendedKeyUsage) {
+        found = true;
+        break;
+      }
+    }
+    if (!found) return false;
+  }
+  if (!filter.subject.empty() &&
+      entry.folded_subject.find(filter.subject) == std::string::npos) {
+    return false;
+  }
+  if (!filter.issuer.empty() &&
+      entry.folded_issuer.find(filter.issuer) == std::string::npos) {
+    return false;
+  }
+  return true;
+}
+
+CertificatePage CertificateIndex::Query(const CertificateFilter& filter,
+                                        size_t cursor, size_t page_size) const {
+  PreparedFilter prepared(filter);
+  CertificatePage page;
+  size_t i = cursor;
+  for (; i < entries_.size() && page.certificates.size() < page_size; ++i) {
+    if (Matches(entries_[i], prepared)) {
+      page.certificates.push_back(entries_[i].info);
+    }
+  }
+  // Skip trailing non-matches so a caller is not handed a cursor that only
+  // leads to an empty page.
+  while (i < entries_.size() && !Matches(entries_[i], prepared)) ++i;
+  page.next_cursor = i;
+  page.done = i >= entries_.size();
+  return page;
+}
+
+size_t CertificateIndex::Count(const CertificateFilter& filter) const {
+  PreparedFilter prepared(filter);
+  size_t count = 0;
+  for (const Entry& entry : entries_) {
+    if (Matches(entry, prepared)) ++count;
+  }
+  return count;
+}
+
+#ifdef _WIN32
+// ---------- SystemCertificateStore ----------
+
+namespace {
+
+std::string WideToUtf8(const wchar_t* text, size_t len) {
+  if (len == 0) return std::string();
+  int size = WideCharToMultiByte(CP_UTF8, 0, text, static_cast<int>(len),
+                                 nullptr, 0, nullptr, nullptr);
+  std::string utf8(static_cast<size_t>(size), '\0');
+  WideCharToMultiByte(CP_UTF8, 0, text, static_cast<int>(len), utf8.data(),
+                      size, nullptr, nullptr);
+  return utf8;
+}
+
+std::wstring Utf8ToWide(const std::string& text) {
+  if (text.empty()) return std::wstring();
+  int size = MultiByteToWideChar(CP_UTF8, 0, text.c_str(),
+                                 static_cast<int>(text.size()), nullptr, 0);
+  std::wstring wide(static_cast<size_t>(size), L'\0');
+  MultiByteToWideChar(CP_UTF8, 0, text.c_str(), static_cast<int>(text.size()),
+                      wide.data(), size);
+  return wide;
+}
+
+std::string NameToString(const CERT_NAME_BLOB& name) {
+  // Reversed so the most specific RDN comes first, as on other platforms.
+  const DWORD flags = CERT_X500_NAME_STR | CERT_NAME_STR_REVERSE_FLAG;
+  CERT_NAME_BLOB* blob = const_cast<CERT_NAME_BLOB*>(&name);
+  DWORD len = CertNameToStrW(X509_ASN_ENCODING, blob, flags, nullptr, 0);
+  if (len <= 1) return std::string();
+  std::wstring text(len, L'\0');
+  CertNameToStrW(X509_ASN_ENCODING, blob, flags, text.data(), len);
+  return WideToUtf8(text.data(), len - 1);
+}
+
+int64_t FileTimeToUnixMillis(const FILETIME& time) {
+  ULARGE_INTEGER ticks;
+  ticks.LowPart = time.dwLowDateTime;
+  ticks.HighPart = time.dwHighDateTime;
+  // FILETIME counts 100 ns ticks since 1601-01-01.
+  return (static_cast<int64_t>(ticks.QuadPart) - 116444736000000000LL) / 10000;
+}
+
+CertificateInfo Project(PCCERT_CONTEXT cert,
+                        CertificateStoreLocation location) {
+  CertificateInfo info;
+  info.location = location;
+
+  BYTE sha1[20];
+  DWORD size = sizeof(sha1);
+  if (CertGetCertificateContextProperty(cert, CERT_SHA1_HASH_PROP_ID, sha1,
+                                        &size)) {
+    info.thumbprint = HexUpper(sha1, size);
+  }
+
+  const CERT_INFO* cert_info = cert->pCertInfo;
+  info.subject = NameToString(cert_info->Subject);
+  info.issuer = NameToString(cert_info->Issuer);
+  // CryptoAPI stores the serial number little-endian.
+  std::vector<uint8_t> serial(
+      cert_info->SerialNumber.pbData,
+      cert_info->SerialNumber.pbData + cert_info->SerialNumber.cbData);
+  std::reverse(serial.begin(), serial.end());
+  info.serial_number = HexUpper(serial.data(), serial.size());
+  info.not_before = FileTimeToUnixMillis(cert_info->NotBefore);
+  info.not_after = FileTimeToUnixMillis(cert_info->NotAfter);
+
+  size = 0;
+  if (CertGetEnhancedKeyUsage(cert, CERT_FIND_EXT_ONLY_ENHKEY_USAGE_FLAG,
+                              nullptr, &size)) {
+    std::vector<BYTE> buffer(size);
+    auto* usage = reinterpret_cast<PCERT_ENHKEY_USAGE>(buffer.data());
+    if (CertGetEnhancedKeyUsage(cert, CERT_FIND_EXT_ONLY_ENHKEY_USAGE_FLAG,
+                                usage, &size)) {
+      for (DWORD i = 0; i < usage->cUsageIdentifier; ++i) {
+        info.ekus.emplace_back(usage->rgpszUsageIdentifier[i]);
+      }
+    }
+  }
+
+  // Only the property is queried; the key itself is never opened.
+  size = 0;
+  info.has_private_key =
+      CertGetCertificateContextProperty(cert, CERT_KEY_PROV_INFO_PROP_ID,
+                                        nullptr, &size) != FALSE;
+  return info;
+}
+
+}  // namespace
+
+SystemCertificateStore::SystemCertificateStore(
+    CertificateStoreLocation location, const std::string& name)
+    : location_(location) {
+  const DWORD flags = (location == CertificateStoreLocation::kCurrentUser
+                           ? CERT_SYSTEM_STORE_CURRENT_USER
+                           : CERT_SYSTEM_STORE_LOCAL_MACHINE) |
+                      CERT_STORE_READONLY_FLAG | CERT_STORE_OPEN_EXISTING_FLAG;
+  std::wstring wide_name = Utf8ToWide(name);
+  store_ = CertOpenStore(CERT_STORE_PROV_SYSTEM_W, 0, 0, flags,
+                         wide_name.c_str());
+  if (!store_) {
+    throw std::runtime_error("Failed to open certificate store " + name);
+  }
+  // Manual-reset and initially signalled, so the first Changed() is true.
+  HANDLE event = CreateEventW(nullptr, TRUE, TRUE, nullptr);
+  if (event && !CertControlStore(static_cast<HCERTSTORE>(store_), 0,
+                                 CERT_STORE_CTRL_NOTIFY_CHANGE, &event)) {
+    CloseHandle(event);
+    event = nullptr;
+  }
+  event_ = event;
+}
+
+SystemCertificateStore::~SystemCertificateStore() {
+  CertCloseStore(static_cast<HCERTSTORE>(store_), 0);
+  if (event_) CloseHandle(static_cast<HANDLE>(event_));
+}
+
+bool SystemCertificateStore::Changed() const {
+  return !event_ ||
+         WaitForSingleObject(static_cast<HANDLE>(event_), 0) == WAIT_OBJECT_0;
+}
+
+std::vector<CertificateInfo> SystemCertificateStore::Read() {
+  HCERTSTORE store = static_cast<HCERTSTORE>(store_);
+  if (event_) {
+    // Re-arms the notification; a change made during the enumeration below
+    // signals the event again and invalidates this snapshot.
+    HANDLE event = static_cast<HANDLE>(event_);
+    ResetEvent(event);
+    CertControlStore(store, 0, CERT_STORE_CTRL_RESYNC, &event);
+  }
+  std::vector<CertificateInfo> certificates;
+  PCCERT_CONTEXT cert = nullptr;
+  while ((cert = CertEnumCertificatesInStore(store, cert)) != nullptr) {
+    certificates.push_back(Project(cert, location_));
+  }
+  return certificates;
+}
+#else
+// ---------- PEM directory ----------
+
+namespace {
+
+std::string NameToString(X509_NAME* name) {
+  // Most specific RDN first with ", " separators, matching CertNameToStr's
+  // reversed X.500 form; UTF-8 is kept rather than escaped.
+  const unsigned long flags =
+      (ASN1_STRFLGS_RFC2253 & ~ASN1_STRFLGS_ESC_MSB) | XN_FLAG_SEP_CPLUS_SPC |
+      XN_FLAG_DN_REV | XN_FLAG_FN_SN;
+  BIO* bio = BIO_new(BIO_s_mem());
+  if (!bio) return std::string();
+  X509_NAME_print_ex(bio, name, 0, flags);
+  char* data = nullptr;
+  long len = BIO_get_mem_data(bio, &data);
+  std::string text(data, len > 0 ? static_cast<size_t>(len) : 0);
+  BIO_free(bio);
+  return text;
+}
+
+int64_t AsnTimeToUnixMillis(const ASN1_TIME* time) {
+  struct tm parts = {};
+  if (!ASN1_TIME_to_tm(time, &parts)) return 0;
+  return static_cast<int64_t>(timegm(&parts)) * 1000;
+}
+
+// One DER element. Only the handful of fields the projection needs are
+// decoded, because d2i_X509 also decodes the public key through the provider
+// layer, which costs ~0.3 ms per certificate in OpenSSL 3.
+struct DerElement {
+  uint8_t tag = 0;
+  const uint8_t* begin = nullptr;  // Start of the tag.
+  const uint8_t* content = nullptr;
+  size_t content_len = 0;
+  size_t total_len = 0;  // Tag, length and content.
+};
+
+bool ReadDer(const uint8_t** p, const uint8_t* end, DerElement* element) {
+  const uint8_t* cursor = *p;
+  if (end - cursor < 2) return false;
+  element->begin = cursor;
+  element->tag = *cursor++;
+  size_t len = *cursor++;
+  if (len & 0x80) {
+    size_t bytes = len & 0x7f;
+    if (bytes == 0 || bytes > 4 || static_cast<size_t>(end - cursor) < bytes) {
+      return false;
+    }
+    len = 0;
+    while (bytes--) len = (len << 8) | *cursor++;
+  }
+  if (static_cast<size_t>(end - cursor) < len) return false;
+  element->content = cursor;
+  element->content_len = len;
+  element->total_len = static_cast<size_t>(cursor + len - element->begin);
+  *p = cursor + len;
+  return true;
+}
+
+std::string DerNameToString(const DerElement& element) {
+  const uint8_t* p = element.begin;
+  X509_NAME* name =
+      d2i_X509_NAME(nullptr, &p, static_cast<long>(element.total_len));
+  if (!name) return std::string();
+  std::string text = NameToString(name);
+  X509_NAME_free(name);
+  return text;
+}
+
+int64_t DerTimeToUnixMillis(const DerElement& element) {
+  const uint8_t* p = element.begin;
+  ASN1_TIME* time =
+      d2i_ASN1_TIME(nullptr, &p, static_cast<long>(element.total_len));
+  if (!time) return 0;
+  int64_t millis = AsnTimeToUnixMillis(time);
+  ASN1_TIME_free(time);
+  return millis;
+}
+
+std::string OidToString(const uint8_t* data, size_t len) {
+  std::string text;
+  uint64_t value = 0;
+  for (size_t i = 0; i < len; ++i) {
+    value = (value << 7) | (data[i] & 0x7f);
+    if (data[i] & 0x80) continue;
+    if (text.empty()) {
+      const uint64_t first = value < 80 ? value / 40 : 2;
+      text = std::to_string(first) + "." + std::to_string(value - first * 40);
+    } else {
+      text += "." + std::to_string(value);
+    }
+    value = 0;
+  }
+  return text;
+}
+
+// Appends the OIDs of an ExtKeyUsageSyntax (SEQUENCE OF OBJECT IDENTIFIER).
+void ReadEkus(const uint8_t* data, size_t len, std::vector<std::string>* ekus) {
+  const uint8_t* p = data;
+  DerElement sequence, oid;
+  if (!ReadDer(&p, data + len, &sequence) || sequence.tag != 0x30) return;
+  p = sequence.content;
+  const uint8_t* end = sequence.content + sequence.content_len;
+  while (p < end && ReadDer(&p, end, &oid)) {
+    if (oid.tag == 0x06) {
+      ekus->push_back(OidToString(oid.content, oid.content_len));
+    }
+  }
+}
+
+// Reads the X.509 extensions list ([3] EXPLICIT SEQUENCE OF Extension).
+void ReadExtensions(const DerElement& element, CertificateInfo* info) {
+  static const uint8_t kExtKeyUsageOid[] = {0x55, 0x1d, 0x25};  // 2.5.29.37
+  const uint8_t* p = element.content;
+  const uint8_t* end = element.content + element.content_len;
+  DerElement list;
+  if (!ReadDer(&p, end, &list) || list.tag != 0x30) return;
+  p = list.content;
+  end = list.content + list.content_len;
+  DerElement extension;
+  while (p < end && ReadDer(&p, end, &extension)) {
+    const uint8_t* q = extension.content;
+    const uint8_t* extension_end = extension.content + extension.content_len;
+    DerElement oid, field;
+    if (!ReadDer(&q, extension_end, &oid) || oid.tag != 0x06 ||
+        oid.content_len != sizeof(kExtKeyUsageOid) ||
+        std::memcmp(oid.content, kExtKeyUsageOid, sizeof(kExtKeyUsageOid)) !=
+            0) {
+      continue;
+    }
+    // Skip the optional critical flag to reach the OCTET STRING value.
+    while (ReadDer(&q, extension_end, &field)) {
+      if (field.tag == 0x04) {
+        ReadEkus(field.content, field.content_len, &info->ekus);
+        break;
+      }
+    }
+  }
+}
+
+// Projects one DER certificate. Returns false if it is malformed.
+bool ProjectDer(const uint8_t* der, size_t len, CertificateInfo* info) {
+  const uint8_t* p = der;
+  DerElement cert, tbs, field;
+  if (!ReadDer(&p, der + len, &cert) || cert.tag != 0x30) return false;
+  p = cert.content;
+  if (!ReadDer(&p, cert.content + cert.content_len, &tbs) || tbs.tag != 0x30) {
+    return false;
+  }
+
+  // TBSCertificate: [0] version (optional), serialNumber, signature, issuer,
+  // validity, subject, subjectPublicKeyInfo, then optional [1] [2] [3].
+  p = tbs.content;
+  const uint8_t* end = tbs.content + tbs.content_len;
+  if (!ReadDer(&p, end, &field)) return false;
+  if (field.tag == 0xa0 && !ReadDer(&p, end, &field)) return false;
+  if (field.tag != 0x02 || field.content_len == 0) return false;
+  const uint8_t* serial = field.content;
+  size_t serial_len = field.content_len;
+  while (serial_len > 1 && serial[0] == 0) {
+    ++serial;
+    --serial_len;
+  }
+  info->serial_number = HexUpper(serial, serial_len);
+
+  DerElement signature, issuer, validity, subject, key;
+  if (!ReadDer(&p, end, &signature) || !ReadDer(&p, end, &issuer) ||
+      !ReadDer(&p, end, &validity) || !ReadDer(&p, end, &subject) ||
+      !ReadDer(&p, end, &key) || validity.tag != 0x30) {
+    return false;
+  }
+  info->issuer = DerNameToString(issuer);
+  info->subject = DerNameToString(subject);
+  const uint8_t* q = validity.content;
+  const uint8_t* validity_end = validity.content + validity.content_len;
+  DerElement not_before, not_after;
+  if (!ReadDer(&q, validity_end, &not_before) ||
+      !ReadDer(&q, validity_end, &not_after)) {
+    return false;
+  }
+  info->not_before = DerTimeToUnixMillis(not_before);
+  info->not_after = DerTimeToUnixMillis(not_after);
+  while (p < end && ReadDer(&p, end, &field)) {
+    if (field.tag == 0xa3) ReadExtensions(field, info);
+  }
+
+  uint8_t sha1[EVP_MAX_MD_SIZE];
+  unsigned int sha1_len = 0;
+  if (EVP_Digest(cert.begin, cert.total_len, sha1, &sha1_len, EVP_sha1(),
+                 nullptr)) {
+    info->thumbprint = HexUpper(sha1, sha1_len);
+  }
+  return true;
+}
+
+}  // namespace
+
+std::vector<CertificateInfo> ReadPemDirectory(
+    const std::string& directory, CertificateStoreLocation location) {
+  namespace fs = std::filesystem;
+  std::vector<fs::path> files;
+  std::error_code error;
+  for (fs::directory_iterator it(fs::u8path(directory), error), end;
+       !error && it != end; it.increment(error)) {
+    const fs::path& path = it->path();
+    if (it->is_regular_file(error) &&
+        (path.extension() == ".pem" || path.extension() == ".crt")) {
+      files.push_back(path);
+    }
+  }
+  std::sort(files.begin(), files.end());
+
+  std::vector<CertificateInfo> certificates;
+  for (const fs::path& path : files) {
+    BIO* bio = BIO_new_file(path.c_str(), "r");
+    if (!bio) continue;
+    fs::path key_path = path;
+    key_path.replace_extension(".key");
+    const bool has_private_key = fs::exists(key_path, error);
+    char* name = nullptr;
+    char* header = nullptr;
+    unsigned char* data = nullptr;
+    long len = 0;
+    while (PEM_read_bio(bio, &name, &header, &data, &len)) {
+      CertificateInfo info;
+      info.location = location;
+      info.has_private_key = has_private_key;
+      if (std::strcmp(name, PEM_STRING_X509) == 0 &&
+          ProjectDer(data, static_cast<size_t>(len), &info)) {
+        certificates.push_back(std::move(info));
+      }
+      OPENSSL_free(name);
+      OPENSSL_free(header);
+      OPENSSL_free(data);
+    }
+    BIO_free(bio);
+  }
+  // The read loop ends on an expected "no start line" error.
+  ERR_clear_error();
+  return certificates;
+}
+#endif
+
+}  // namespace flutter_native_utils
@@ -0,0 +1,130 @@
+#ifndef FLUTTER_PLUGIN_CERTIFICATE_INDEX_H_
+#define FLUTTER_PLUGIN_CERTIFICATE_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace flutter_native_utils {
+
+enum class CertificateStoreLocation { kCurrentUser, kLocalMachine };
+
+// Accepts "currentUser" and "localMachine" (case-sensitive).
+bool ParseCertificateStoreLocation(const std::string& name,
+                                   CertificateStoreLocation* location);
+
+const char* CertificateStoreLocationName(CertificateStoreLocation location);
+
+// Maps the well-known names "serverAuth", "clientAuth", "codeSigning",
+// "emailProtection" and "timeStamping" to their OIDs; anything else is
+// returned unchanged and treated as an OID.
+std::string ResolveEkuOid(const std::string& name_or_oid);
+
+// Metadata projected from one certificate. No certificate or key material is
+// kept, so an index of tens of thousands of entries stays small.
+struct CertificateInfo {
+  std::string thumbprint;  // Upper-case hex SHA-1, as GetCertificate takes.
+  std::string subject;     // "CN=..., O=..., C=..." (most specific first).
+  std::string issuer;
+  std::string serial_number;  // Upper-case hex, big-endian.
+  int64_t not_before = 0;     // Milliseconds since the Unix epoch.
+  int64_t not_after = 0;
+  std::vector<std::string> ekus;  // OIDs; empty if the extension is absent.
+  bool has_private_key = false;
+  CertificateStoreLocation location = CertificateStoreLocation::kCurrentUser;
+};
+
+// All set fields must match. Substring matches are ASCII case-insensitive.
+struct CertificateFilter {
+  std::string subject_contains;
+  std::string issuer_contains;
+  // OID the certificate must be valid for. Certificates without an EKU
+  // extension, or with anyExtendedKeyUsage, are valid for every purpose.
+  std::string eku;
+  // The certificate must be valid for the whole window; if only one end is
+  // set the window is that instant. Milliseconds since the Unix epoch.
+  std::optional<int64_t> valid_from;
+  std::optional<int64_t> valid_to;
+  std::optional<bool> has_private_key;
+  std::optional<CertificateStoreLocation> location;
+};
+
+struct CertificatePage {
+  std::vector<CertificateInfo> certificates;
+  // Position to resume the scan from, or the index size once exhausted.
+  size_t next_cursor = 0;
+  bool done = true;
+};
+
+// An immutable snapshot of projected certificates. Names are case-folded
+// once at construction, so a query is a single allocation-free pass over
+// the entries that only copies the ones it returns. Thread-safe.
+class CertificateIndex {
+ public:
+  explicit CertificateIndex(std::vector<CertificateInfo> certificates);
+
+  size_t size() const { return entries_.size(); }
+  const CertificateInfo& at(size_t i) const { return entries_[i].info; }
+
+  // Returns up to |page_size| matches at or after |cursor|, in index order.
+  CertificatePage Query(const CertificateFilter& filter, size_t cursor,
+                        size_t page_size) const;
+
+  // Number of entries matching |filter|.
+  size_t Count(const CertificateFilter& filter) const;
+
+ private:
+  struct Entry {
+    CertificateInfo info;
+    std::string folded_subject;
+    std::string folded_issuer;
+  };
+
+  struct PreparedFilter;
+  static bool Matches(const Entry& entry, const PreparedFilter& filter);
+
+  std::vector<Entry> entries_;
+};
+
+#ifdef _WIN32
+// An open system certificate store ("MY", "Root", ...) that remembers whether
+// it has changed since it was last read, so an index built from it can be
+// reused until then.
+class SystemCertificateStore {
+ public:
+  // Throws std::runtime_error if the store cannot be opened.
+  SystemCertificateStore(CertificateStoreLocation location,
+                         const std::string& name);
+  ~SystemCertificateStore();
+
+  // Disallow copy and assign.
+  SystemCertificateStore(const SystemCertificateStore&) = delete;
+  SystemCertificateStore& operator=(const SystemCertificateStore&) = delete;
+
+  // True if the store may have changed since the last Read(). Always true
+  // if the store does not support change notification.
+  bool Changed() const;
+
+  // Projects every certificate in the store, in store order.
+  std::vector<CertificateInfo> Read();
+
+ private:
+  CertificateStoreLocation location_;
+  void* store_ = nullptr;  // HCERTSTORE.
+  void* event_ = nullptr;  // Signalled when the store changes.
+};
+#else
+// Projects every certificate in the *.pem / *.crt files directly under
+// |directory| (a file may hold several), ordered by file name. A certificate
+// has a private key if a *.key file with the same stem exists. Unreadable
+// files are skipped. Stands in for the system store on Linux hosts.
+std::vector<CertificateInfo> ReadPemDirectory(
+    const std::string& directory,
+    CertificateStoreLocation location = CertificateStoreLocation::kCurrentUser);
+#endif
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_CERTIFICATE_INDEX_H_
@@ -0,0 +1,503 @@
+#include "certificate_signer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <bcrypt.h>
+#include <ncrypt.h>
+#include <wincrypt.h>
+
+#pragma comment(lib, "bcrypt.lib")
+#pragma comment(lib, "crypt32.lib")
+#pragma comment(lib, "ncrypt.lib")
+#else
+#include <openssl/bio.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+
+#include <filesystem>
+#endif
+
+#include <stdexcept>
+#include <utility>
+
+namespace flutter_native_utils {
+
+namespace {
+
+// Half of a P-521 r || s signature.
+constexpr size_t kMaxEcdsaScalarLen = 66;
+
+std::string NormalizeThumbprint(const std::string& thumbprint) {
+  std::string key = thumbprint;
+  for (char& c : key) {
+    if (c >= 'a' && c <= 'f') c = static_cast<char>(c - 'a' + 'A');
+  }
+  return key;
+}
+
+void AppendDerInteger(const uint8_t* bytes, size_t len,
+                      std::vector<uint8_t>* out) {
+  while (len > 1 && bytes[0] == 0) {
+    ++bytes;
+    --len;
+  }
+  // A set high bit would make the INTEGER negative.
+  const bool pad = (bytes[0] & 0x80) != 0;
+  out->push_back(0x02);
+  out->push_back(static_cast<uint8_t>(len + (pad ? 1 : 0)));
+  if (pad) out->push_back(0);
+  out->insert(out->end(), bytes, bytes + len);
+}
+
+}  // namespace
+
+bool ParseSignatureHash(const std::string& name, SignatureHash* hash) {
+  if (name == "sha256") {
+    *hash = SignatureHash::kSha256;
+  } else if (name == "sha384") {
+    *hash = SignatureHash::kSha384;
+  } else if (name == "sha512") {
+    *hash = SignatureHash::kSha512;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+size_t SignatureHashLength(SignatureHash hash) {
+  switch (hash) {
+    case SignatureHash::kSha384:
+      return 48;
+    case SignatureHash::kSha512:
+      return 64;
+    case SignatureHash::kSha256:
+    default:
+      return 32;
+  }
+}
+
+bool ParseSignaturePadding(const std::string& name, SignaturePadding* padding) {
+  if (name == "pkcs1") {
+    *padding = SignaturePadding::kPkcs1;
+  } else if (name == "pss") {
+    *padding = SignaturePadding::kPss;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::vector<uint8_t> EcdsaRawToDer(const uint8_t* raw, size_t len) {
+  if (len == 0 || len % 2 != 0 || len > 2 * kMaxEcdsaScalarLen) {
+    throw std::invalid_argument("Malformed ECDSA signature");
+  }
+  std::vector<uint8_t> body;
+  body.reserve(len + 6);
+  AppendDerInteger(raw, len / 2, &body);
+  AppendDerInteger(raw + len / 2, len / 2, &body);
+
+  std::vector<uint8_t> der;
+  der.reserve(body.size() + 3);
+  der.push_back(0x30);
+  if (body.size() >= 0x80) der.push_back(0x81);
+  der.push_back(static_cast<uint8_t>(body.size()));
+  der.insert(der.end(), body.begin(), body.end());
+  return der;
+}
+
+#ifdef _WIN32
+// ---------- CNG backend ----------
+
+namespace {
+
+bool ParseThumbprint(const std::string& hex, uint8_t out[20]) {
+  if (hex.size() != 40) return false;
+  for (size_t i = 0; i < 20; ++i) {
+    int value = 0;
+    for (size_t j = 0; j < 2; ++j) {
+      char c = hex[i * 2 + j];
+      int digit;
+      if (c >= '0' && c <= '9') {
+        digit = c - '0';
+      } else if (c >= 'A' && c <= 'F') {
+        digit = c - 'A' + 10;
+      } else {
+        return false;
+      }
+      value = value * 16 + digit;
+    }
+    out[i] = static_cast<uint8_t>(value);
+  }
+  return true;
+}
+
+LPCWSTR HashAlgorithmId(SignatureHash hash) {
+  switch (hash) {
+    case SignatureHash::kSha384:
+      return BCRYPT_SHA384_ALGORITHM;
+    case SignatureHash::kSha512:
+      return BCRYPT_SHA512_ALGORITHM;
+    case SignatureHash::kSha256:
+    default:
+      return BCRYPT_SHA256_ALGORITHM;
+  }
+}
+
+// Hash providers are opened once per process, like the SHA-256 one.
+BCRYPT_ALG_HANDLE HashProvider(SignatureHash hash) {
+  static BCRYPT_ALG_HANDLE providers[3] = {};
+  static std::once_flag opened;
+  std::call_once(opened, [] {
+    const SignatureHash hashes[] = {SignatureHash::kSha256,
+                                    SignatureHash::kSha384,
+                                    SignatureHash::kSha512};
+    for (size_t i = 0; i < 3; ++i) {
+      if (BCryptOpenAlgorithmProvider(&providers[i], HashAlgorithmId(hashes[i]),
+                                      nullptr, 0) != 0) {
+        providers[i] = nullptr;
+      }
+    }
+  });
+  return providers[static_cast<size_t>(hash)];
+}
+
+}  // namespace
+
+struct CertificateKey::Handle {
+  NCRYPT_KEY_HANDLE key = 0;
+
+  ~Handle() {
+    if (key) NCryptFreeObject(key);
+  }
+};
+
+std::vector<uint8_t> ComputeSignatureHash(SignatureHash hash,
+                                          const uint8_t* data, size_t len) {
+  BCRYPT_ALG_HANDLE provider = HashProvider(hash);
+  std::vector<uint8_t> digest(SignatureHashLength(hash));
+  if (!provider ||
+      BCryptHash(provider, nullptr, 0, const_cast<PUCHAR>(data),
+                 static_cast<ULONG>(len), digest.data(),
+                 static_cast<ULONG>(digest.size())) != 0) {
+    throw std::runtime_error("BCryptHash failed");
+  }
+  return digest;
+}
+
+std::vector<uint8_t> CertificateKey::SignDigest(SignatureHash hash,
+                                                SignaturePadding padding,
+                                                const uint8_t* digest,
+                                                size_t len) const {
+  if (len != SignatureHashLength(hash)) {
+    throw std::invalid_argument("Digest length does not match the hash");
+  }
+  BCRYPT_PKCS1_PADDING_INFO pkcs1 = {HashAlgorithmId(hash)};
+  BCRYPT_PSS_PADDING_INFO pss = {HashAlgorithmId(hash),
+                                 static_cast<ULONG>(len)};
+  void* padding_info = nullptr;
+  DWORD flags = 0;
+  if (type_ == CertificateKeyType::kRsa) {
+    if (padding == SignaturePadding::kPss) {
+      padding_info = &pss;
+      flags = BCRYPT_PAD_PSS;
+    } else {
+      padding_info = &pkcs1;
+      flags = BCRYPT_PAD_PKCS1;
+    }
+  }
+
+  DWORD size = 0;
+  SECURITY_STATUS status =
+      NCryptSignHash(handle_->key, padding_info, const_cast<PBYTE>(digest),
+                     static_cast<DWORD>(len), nullptr, 0, &size, flags);
+  std::vector<uint8_t> signature(size);
+  if (status == ERROR_SUCCESS) {
+    status = NCryptSignHash(handle_->key, padding_info,
+                            const_cast<PBYTE>(digest), static_cast<DWORD>(len),
+                            signature.data(), size, &size, flags);
+  }
+  if (status != ERROR_SUCCESS) {
+    throw std::runtime_error("NCryptSignHash failed");
+  }
+  signature.resize(size);
+  if (type_ == CertificateKeyType::kEc) {
+    return EcdsaRawToDer(signature.data(), signature.size());
+  }
+  return signature;
+}
+
+struct CertificateSigner::Backend {
+  HCERTSTORE stores[2] = {nullptr, nullptr};  // Current user, local machine.
+
+  ~Backend() {
+    for (HCERTSTORE store : stores) {
+      if (store) CertCloseStore(store, 0);
+    }
+  }
+};
+
+CertificateSigner::CertificateSigner() : backend_(std::make_unique<Backend>()) {
+  const DWORD locations[] = {CERT_SYSTEM_STORE_CURRENT_USER,
+                             CERT_SYSTEM_STORE_LOCAL_MACHINE};
+  for (size_t i = 0; i < 2; ++i) {
+    backend_->stores[i] = CertOpenStore(
+        CERT_STORE_PROV_SYSTEM_W, 0, 0,
+        locations[i] | CERT_STORE_READONLY_FLAG | CERT_STORE_OPEN_EXISTING_FLAG,
+        L"MY");
+  }
+}
+
+std::unique_ptr<CertificateKey> CertificateSigner::OpenKey(
+    const std::string& thumbprint) {
+  uint8_t hash[20];
+  if (!ParseThumbprint(thumbprint, hash)) return nullptr;
+  CRYPT_HASH_BLOB blob = {sizeof(hash), hash};
+  PCCERT_CONTEXT cert = nullptr;
+  for (HCERTSTORE store : backend_->stores) {
+    if (!store) continue;
+    cert = CertFindCertificateInStore(store, X509_ASN_ENCODING, 0,
+                                      CERT_FIND_SHA1_HASH, &blob, nullptr);
+    if (cert) break;
+  }
+  if (!cert) return nullptr;
+
+  // Silent: a key behind a PIN prompt must not block a worker thread on UI.
+  HCRYPTPROV_OR_NCRYPT_KEY_HANDLE key = 0;
+  DWORD key_spec = 0;
+  BOOL caller_free = FALSE;
+  BOOL ok = CryptAcquireCertificatePrivateKey(
+      cert, CRYPT_ACQUIRE_ONLY_NCRYPT_KEY_FLAG | CRYPT_ACQUIRE_SILENT_FLAG,
+      nullptr, &key, &key_spec, &caller_free);
+  CertFreeCertificateContext(cert);
+  if (!ok || key_spec != CERT_NCRYPT_KEY_SPEC) return nullptr;
+
+  auto handle = std::make_unique<CertificateKey::Handle>();
+  // Without CRYPT_ACQUIRE_CACHE_FLAG the handle is always the caller's.
+  handle->key = static_cast<NCRYPT_KEY_HANDLE>(key);
+
+  wchar_t group[32] = {};
+  DWORD group_size = 0;
+  if (NCryptGetProperty(handle->key, NCRYPT_ALGORITHM_GROUP_PROPERTY,
+                        reinterpret_cast<PBYTE>(group),
+                        static_cast<DWORD>(sizeof(group)),
+                        &group_size, 0) != ERROR_SUCCESS) {
+    return nullptr;
+  }
+  CertificateKeyType type;
+  if (wcscmp(group, NCRYPT_RSA_ALGORITHM_GROUP) == 0) {
+    type = CertificateKeyType::kRsa;
+  } else if (wcscmp(group, NCRYPT_ECDSA_ALGORITHM_GROUP) == 0) {
+    type = CertificateKeyType::kEc;
+  } else {
+    return nullptr;
+  }
+  return std::unique_ptr<CertificateKey>(
+      new CertificateKey(std::move(handle), type));
+}
+#else
+// ---------- OpenSSL software-key backend ----------
+
+namespace {
+
+std::string Sha1Hex(X509* cert) {
+  static const char kDigits[] = "0123456789ABCDEF";
+  uint8_t digest[EVP_MAX_MD_SIZE];
+  unsigned int len = 0;
+  if (!X509_digest(cert, EVP_sha1(), digest, &len)) return std::string();
+  std::string hex;
+  for (unsigned int i = 0; i < len; ++i) {
+    hex.push_back(kDigits[digest[i] >> 4]);
+    hex.push_back(kDigits[digest[i] & 0xf]);
+  }
+  return hex;
+}
+
+const EVP_MD* HashMd(SignatureHash hash) {
+  switch (hash) {
+    case SignatureHash::kSha384:
+      return EVP_sha384();
+    case SignatureHash::kSha512:
+      return EVP_sha512();
+    case SignatureHash::kSha256:
+    default:
+      return EVP_sha256();
+  }
+}
+
+// Encrypted keys are unavailable rather than prompted for on the terminal.
+int NoPassword(char*, int, int, void*) { return 0; }
+
+}  // namespace
+
+struct CertificateKey::Handle {
+  EVP_PKEY* key = nullptr;
+
+  ~Handle() { EVP_PKEY_free(key); }
+};
+
+std::vector<uint8_t> ComputeSignatureHash(SignatureHash hash,
+                                          const uint8_t* data, size_t len) {
+  std::vector<uint8_t> digest(SignatureHashLength(hash));
+  unsigned int digest_len = 0;
+  if (EVP_Digest(data, len, digest.data(), &digest_len, HashMd(hash),
+                 nullptr) != 1) {
+    throw std::runtime_error("EVP_Digest failed");
+  }
+  return digest;
+}
+
+std::vector<uint8_t> CertificateKey::SignDigest(SignatureHash hash,
+                                                SignaturePadding padding,
+                                                const uint8_t* digest,
+                                                size_t len) const {
+  if (len != SignatureHashLength(hash)) {
+    throw std::invalid_argument("Digest length does not match the hash");
+  }
+  EVP_PKEY_CTX* context = EVP_PKEY_CTX_new(handle_->key, nullptr);
+  bool ok = context && EVP_PKEY_sign_init(context) == 1 &&
+            EVP_PKEY_CTX_set_signature_md(context, HashMd(hash)) == 1;
+  if (ok && type_ == CertificateKeyType::kRsa) {
+    if (padding == SignaturePadding::kPss) {
+      ok = EVP_PKEY_CTX_set_rsa_padding(context, RSA_PKCS1_PSS_PADDING) == 1 &&
+           EVP_PKEY_CTX_set_rsa_pss_saltlen(context, RSA_PSS_SALTLEN_DIGEST) ==
+               1;
+    } else {
+      ok = EVP_PKEY_CTX_set_rsa_padding(context, RSA_PKCS1_PADDING) == 1;
+    }
+  }
+  size_t size = 0;
+  ok = ok && EVP_PKEY_sign(context, nullptr, &size, digest, len) == 1;
+  std::vector<uint8_t> signature(size);
+  ok = ok && EVP_PKEY_sign(context, signature.data(), &size, digest, len) == 1;
+  EVP_PKEY_CTX_free(context);
+  if (!ok) throw std::runtime_error("EVP_PKEY_sign failed");
+  signature.resize(size);
+  return signature;
+}
+
+struct CertificateSigner::Backend {
+  struct Entry {
+    X509* certificate = nullptr;
+    std::filesystem::path key_path;
+  };
+  std::unordered_map<std::string, Entry> by_thumbprint;
+
+  ~Backend() {
+    for (auto& entry : by_thumbprint) X509_free(entry.second.certificate);
+  }
+};
+
+CertificateSigner::CertificateSigner(const std::string& certificate_directory)
+    : backend_(std::make_unique<Backend>()) {
+  namespace fs = std::filesystem;
+  std::error_code error;
+  for (fs::directory_iterator it(fs::u8path(certificate_directory), error), end;
+       !error && it != end; it.increment(error)) {
+    const fs::path& path = it->path();
+    if (!it->is_regular_file(error) ||
+        (path.extension() != ".pem" && path.extension() != ".crt")) {
+      continue;
+    }
+    fs::path key_path = path;
+    key_path.replace_extension(".key");
+    std::error_code key_error;
+    if (!fs::exists(key_path, key_error)) continue;
+    BIO* bio = BIO_new_file(path.c_str(), "r");
+    if (!bio) continue;
+    while (X509* cert = PEM_read_bio_X509(bio, nullptr, nullptr, nullptr)) {
+      auto inserted = backend_->by_thumbprint.emplace(
+          Sha1Hex(cert), Backend::Entry{cert, key_path});
+      if (!inserted.second) X509_free(cert);
+    }
+    BIO_free(bio);
+  }
+  // The read loops end on an expected "no start line" error.
+  ERR_clear_error();
+}
+
+std::unique_ptr<CertificateKey> CertificateSigner::OpenKey(
+    const std::string& thumbprint) {
+  auto entry = backend_->by_thumbprint.find(thumbprint);
+  if (entry == backend_->by_thumbprint.end()) return nullptr;
+
+  BIO* bio = BIO_new_file(entry->second.key_path.c_str(), "r");
+  EVP_PKEY* key =
+      bio ? PEM_read_bio_PrivateKey(bio, nullptr, NoPassword, nullptr) : nullptr;
+  BIO_free(bio);
+  // A bundle shares one key file; only the certificate it belongs to signs.
+  if (!key || X509_check_private_key(entry->second.certificate, key) != 1) {
+    EVP_PKEY_free(key);
+    ERR_clear_error();
+    return nullptr;
+  }
+
+  auto handle = std::make_unique<CertificateKey::Handle>();
+  handle->key = key;
+  CertificateKeyType type;
+  switch (EVP_PKEY_get_base_id(key)) {
+    case EVP_PKEY_RSA:
+      type = CertificateKeyType::kRsa;
+      break;
+    case EVP_PKEY_EC:
+      type = CertificateKeyType::kEc;
+      break;
+    default:
+      return nullptr;
+  }
+  return std::unique_ptr<CertificateKey>(
+      new CertificateKey(std::move(handle), type));
+}
+#endif
+
+CertificateKey::CertificateKey(std::unique_ptr<Handle> handle,
+                               CertificateKeyType type)
+    : handle_(std::move(handle)), type_(type) {}
+
+CertificateKey::~CertificateKey() = default;
+
+std::vector<uint8_t> CertificateKey::Sign(SignatureHash hash,
+                                          SignaturePadding padding,
+                                          const uint8_t* data,
+                                          size_t len) const {
+  std::vector<uint8_t> digest = ComputeSignatureHash(hash, data, len);
+  return SignDigest(hash, padding, digest.data(), digest.size());
+}
+
+CertificateSigner::~CertificateSigner() = default;
+
+std::shared_ptr<const CertificateKey> CertificateSigner::Key(
+    const std::string& thumbprint) {
+  const std::string normalized = NormalizeThumbprint(thumbprint);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = keys_.find(normalized);
+    if (it != keys_.end()) return it->second;
+  }
+
+  // Opened outside the lock: a hardware-backed key may take a while.
+  std::shared_ptr<const CertificateKey> key = OpenKey(normalized);
+  if (!key) return nullptr;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // A concurrent open of the same key may have won; keep the first.
+  auto it = keys_.find(normalized);
+  if (it != keys_.end()) return it->second;
+  if (keys_.size() >= kMaxKeys) keys_.clear();
+  keys_.emplace(normalized, key);
+  return key;
+}
+
+void CertificateSigner::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  keys_.clear();
+}
+
+size_t CertificateSigner::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return keys_.size();
+}
+
+}  // namespace flutter_native_utils
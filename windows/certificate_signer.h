@@ -0,0 +1,124 @@
+#ifndef FLUTTER_PLUGIN_CERTIFICATE_SIGNER_H_
+#define FLUTTER_PLUGIN_CERTIFICATE_SIGNER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace flutter_native_utils {
+
+enum class SignatureHash { kSha256, kSha384, kSha512 };
+
+// Accepts "sha256", "sha384" and "sha512" (case-sensitive).
+bool ParseSignatureHash(const std::string& name, SignatureHash* hash);
+
+// Length in bytes of a digest produced by |hash|.
+size_t SignatureHashLength(SignatureHash hash);
+
+// One-shot digest of |data| with |hash|.
+std::vector<uint8_t> ComputeSignatureHash(SignatureHash hash,
+                                          const uint8_t* data, size_t len);
+
+// RSA signature padding. PSS uses a salt as long as the digest, as TLS 1.3
+// requires. Ignored for EC keys.
+enum class SignaturePadding { kPkcs1, kPss };
+
+// Accepts "pkcs1" and "pss" (case-sensitive).
+bool ParseSignaturePadding(const std::string& name, SignaturePadding* padding);
+
+// Encodes a fixed-size r || s ECDSA signature (as CNG produces it) as the DER
+// Ecdsa-Sig-Value that TLS and X.509 use. Throws std::invalid_argument if
+// |len| is zero, odd or longer than a P-521 signature.
+std::vector<uint8_t> EcdsaRawToDer(const uint8_t* raw, size_t len);
+
+enum class CertificateKeyType { kRsa, kEc };
+
+// The private key of a certificate, opened once and kept open. Sign and
+// SignDigest may be called concurrently.
+class CertificateKey {
+ public:
+  ~CertificateKey();
+
+  // Disallow copy and assign.
+  CertificateKey(const CertificateKey&) = delete;
+  CertificateKey& operator=(const CertificateKey&) = delete;
+
+  CertificateKeyType type() const { return type_; }
+
+  // Signs |digest|, the |hash| of the message. EC signatures are returned
+  // DER-encoded. Throws std::invalid_argument if |len| does not match |hash|
+  // and std::runtime_error if the key refuses to sign.
+  std::vector<uint8_t> SignDigest(SignatureHash hash, SignaturePadding padding,
+                                  const uint8_t* digest, size_t len) const;
+
+  // Hashes |data| (e.g. TLS handshake messages) with |hash| and signs it.
+  std::vector<uint8_t> Sign(SignatureHash hash, SignaturePadding padding,
+                            const uint8_t* data, size_t len) const;
+
+ private:
+  friend class CertificateSigner;
+  struct Handle;
+
+  CertificateKey(std::unique_ptr<Handle> handle, CertificateKeyType type);
+
+  std::unique_ptr<Handle> handle_;
+  CertificateKeyType type_;
+};
+
+// Opens the private keys of certificates by SHA-1 thumbprint and caches the
+// open keys, so signing with a client certificate needs neither a PFX export
+// nor a key-store round trip per signature. The key never leaves the store.
+//
+// On Windows certificates are looked up in the current-user, then
+// local-machine "MY" store, and keys are acquired silently through CNG; keys
+// that would need a PIN prompt, or that no CNG provider can open, are treated
+// as unavailable. On Linux hosts certificates come from a PEM directory, and
+// the key of a certificate in "name.pem" is read from an unencrypted
+// "name.key" (the layout ReadPemDirectory reports as has-private-key).
+// Thread-safe.
+class CertificateSigner {
+ public:
+  static constexpr size_t kMaxKeys = 64;
+
+#ifdef _WIN32
+  CertificateSigner();
+#else
+  explicit CertificateSigner(const std::string& certificate_directory);
+#endif
+  ~CertificateSigner();
+
+  // Disallow copy and assign.
+  CertificateSigner(const CertificateSigner&) = delete;
+  CertificateSigner& operator=(const CertificateSigner&) = delete;
+
+  // Returns the key of the certificate with |thumbprint| (hex, any case),
+  // opening it on first use. Returns null if there is no such certificate or
+  // it has no usable private key; such misses are not cached, so a key
+  // installed later is found.
+  std::shared_ptr<const CertificateKey> Key(const std::string& thumbprint);
+
+  // Closes every cached key. Keys still referenced stay usable.
+  void Clear();
+
+  // Number of cached keys.
+  size_t size() const;
+
+ private:
+  struct Backend;
+
+  // Opens the key without consulting the cache; null if unavailable.
+  std::unique_ptr<CertificateKey> OpenKey(const std::string& thumbprint);
+
+  std::unique_ptr<Backend> backend_;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, std::shared_ptr<const CertificateKey>> keys_;
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_CERTIFICATE_SIGNER_H_
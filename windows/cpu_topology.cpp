@@ -0,0 +1,405 @@
+#include "cpu_topology.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <tuple>
+#include <utility>
+
+namespace flutter_native_utils {
+
+namespace {
+
+// Key used to merge cache instances that share a level, type and geometry.
+using CacheKey = std::tuple<uint32_t, std::string, uint64_t, uint32_t>;
+
+void AppendCaches(const std::map<CacheKey, std::pair<uint32_t, uint32_t>>& merged,
+                  CpuTopology* topology) {
+  for (const auto& entry : merged) {
+    CpuCache cache;
+    cache.level = std::get<0>(entry.first);
+    cache.type = std::get<1>(entry.first);
+    cache.size_bytes = std::get<2>(entry.first);
+    cache.line_size = std::get<3>(entry.first);
+    cache.instances = entry.second.first;
+    cache.shared_by = entry.second.second;
+    topology->caches.push_back(cache);
+  }
+}
+
+void CountCoreTypes(CpuTopology* topology) {
+  topology->physical_cores = static_cast<uint32_t>(topology->cores.size());
+  topology->performance_cores = 0;
+  topology->efficiency_cores = 0;
+  topology->logical_processors = 0;
+  for (const CpuCore& core : topology->cores) {
+    topology->logical_processors +=
+        static_cast<uint32_t>(core.logical_processors.size());
+    if (core.type == CpuCoreType::kPerformance) {
+      ++topology->performance_cores;
+    } else {
+      ++topology->efficiency_cores;
+    }
+  }
+}
+
+// Marks every core below the highest efficiency class as an E-core.
+void ClassifyCoresByEfficiencyClass(CpuTopology* topology) {
+  uint32_t highest = 0;
+  for (const CpuCore& core : topology->cores) {
+    if (core.efficiency_class > highest) highest = core.efficiency_class;
+  }
+  for (CpuCore& core : topology->cores) {
+    core.type = core.efficiency_class == highest ? CpuCoreType::kPerformance
+                                                 : CpuCoreType::kEfficiency;
+  }
+}
+
+// ---------- sysfs helpers ----------
+
+bool ReadFirstLine(const std::string& path, std::string* line) {
+  std::ifstream file(path);
+  if (!file) return false;
+  std::getline(file, *line);
+  while (!line->empty() && (line->back() == '\r' || line->back() == ' ')) {
+    line->pop_back();
+  }
+  return true;
+}
+
+bool ReadUint(const std::string& path, uint64_t* value) {
+  std::string line;
+  if (!ReadFirstLine(path, &line) || line.empty()) return false;
+  *value = std::strtoull(line.c_str(), nullptr, 10);
+  return true;
+}
+
+// Parses sysfs cache sizes such as "48K", "2M" or "1024".
+uint64_t ParseCacheSize(const std::string& text) {
+  char* end = nullptr;
+  uint64_t value = std::strtoull(text.c_str(), &end, 10);
+  if (end && (*end == 'K' || *end == 'k')) return value * 1024;
+  if (end && (*end == 'M' || *end == 'm')) return value * 1024 * 1024;
+  return value;
+}
+
+std::string LowerCase(std::string text) {
+  for (char& c : text) {
+    if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+  }
+  return text;
+}
+
+#ifdef _WIN32
+// ---------- Windows ----------
+
+uint32_t PopCount(uint64_t value) {
+  uint32_t count = 0;
+  while (value) {
+    value &= value - 1;
+    ++count;
+  }
+  return count;
+}
+
+std::vector<uint32_t> GroupMaskToProcessors(const GROUP_AFFINITY& mask) {
+  std::vector<uint32_t> processors;
+  for (uint32_t bit = 0; bit < 64; ++bit) {
+    if (static_cast<uint64_t>(mask.Mask) & (1ull << bit)) {
+      processors.push_back(static_cast<uint32_t>(mask.Group) * 64 + bit);
+    }
+  }
+  return processors;
+}
+
+const char* CacheTypeName(PROCESSOR_CACHE_TYPE type) {
+  switch (type) {
+    case CacheData:
+      return "data";
+    case CacheInstruction:
+      return "instruction";
+    case CacheTrace:
+      return "trace";
+    default:
+      return "unified";
+  }
+}
+
+CpuTopology ReadWindowsCpuTopology() {
+  CpuTopology topology;
+  DWORD length = 0;
+  GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+  if (GetLastError() != ERROR_INSUFFICIENT_BUFFER || length == 0) {
+    return topology;
+  }
+  std::vector<uint8_t> buffer(length);
+  auto* first =
+      reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data());
+  if (!GetLogicalProcessorInformationEx(RelationAll, first, &length)) {
+    return topology;
+  }
+
+  std::map<CacheKey, std::pair<uint32_t, uint32_t>> caches;
+  for (DWORD offset = 0; offset < length;) {
+    auto* info = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(
+        buffer.data() + offset);
+    switch (info->Relationship) {
+      case RelationProcessorCore: {
+        CpuCore core;
+        core.efficiency_class = info->Processor.EfficiencyClass;
+        for (WORD group = 0; group < info->Processor.GroupCount; ++group) {
+          auto processors =
+              GroupMaskToProcessors(info->Processor.GroupMask[group]);
+          core.logical_processors.insert(core.logical_processors.end(),
+                                         processors.begin(), processors.end());
+        }
+        topology.cores.push_back(std::move(core));
+        break;
+      }
+      case RelationCache: {
+        const CACHE_RELATIONSHIP& cache = info->Cache;
+        CacheKey key{cache.Level, CacheTypeName(cache.Type), cache.CacheSize,
+                     cache.LineSize};
+        auto& entry = caches[key];
+        ++entry.first;
+        entry.second = PopCount(static_cast<uint64_t>(cache.GroupMask.Mask));
+        break;
+      }
+      case RelationNumaNode: {
+        NumaNode node;
+        node.node = info->NumaNode.NodeNumber;
+        node.logical_processors =
+            GroupMaskToProcessors(info->NumaNode.GroupMask);
+        topology.numa_nodes.push_back(std::move(node));
+        break;
+      }
+      case RelationProcessorPackage:
+        ++topology.packages;
+        break;
+      default:
+        break;
+    }
+    offset += info->Size;
+  }
+
+  AppendCaches(caches, &topology);
+  ClassifyCoresByEfficiencyClass(&topology);
+  CountCoreTypes(&topology);
+  return topology;
+}
+#endif
+
+}  // namespace
+
+std::vector<uint32_t> ParseCpuList(const std::string& list) {
+  std::vector<uint32_t> cpus;
+  std::stringstream stream(list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    if (range.empty()) continue;
+    char* end = nullptr;
+    unsigned long first = std::strtoul(range.c_str(), &end, 10);
+    if (end == range.c_str()) continue;
+    unsigned long last = first;
+    if (*end == '-') last = std::strtoul(end + 1, nullptr, 10);
+    for (unsigned long cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(static_cast<uint32_t>(cpu));
+    }
+  }
+  return cpus;
+}
+
+CpuTopology ReadSysfsCpuTopology(const std::string& sys_root) {
+  namespace fs = std::filesystem;
+  CpuTopology topology;
+  const std::string cpu_root = sys_root + "/devices/system/cpu";
+
+  std::string line;
+  std::vector<uint32_t> online;
+  if (ReadFirstLine(cpu_root + "/online", &line)) online = ParseCpuList(line);
+
+  // Intel hybrid parts expose their E-cores as a separate PMU.
+  std::set<uint32_t> atom_cpus;
+  bool hybrid = false;
+  if (ReadFirstLine(sys_root + "/devices/cpu_atom/cpus", &line)) {
+    auto list = ParseCpuList(line);
+    atom_cpus.insert(list.begin(), list.end());
+    hybrid = !atom_cpus.empty();
+  }
+
+  std::map<std::pair<uint64_t, uint64_t>, CpuCore> cores;
+  std::set<uint64_t> packages;
+  std::set<std::tuple<uint32_t, std::string, std::string>> seen_cache_instances;
+  std::map<CacheKey, std::pair<uint32_t, uint32_t>> caches;
+
+  for (uint32_t cpu : online) {
+    const std::string base = cpu_root + "/cpu" + std::to_string(cpu);
+    uint64_t core_id = cpu;
+    uint64_t package_id = 0;
+    ReadUint(base + "/topology/core_id", &core_id);
+    ReadUint(base + "/topology/physical_package_id", &package_id);
+    packages.insert(package_id);
+
+    CpuCore& core = cores[{package_id, core_id}];
+    core.logical_processors.push_back(cpu);
+    if (hybrid) {
+      core.efficiency_class = atom_cpus.count(cpu) ? 0 : 1;
+    } else {
+      // Arm big.LITTLE reports relative capacity (max 1024) per CPU.
+      uint64_t capacity = 0;
+      if (ReadUint(base + "/cpu_capacity", &capacity)) {
+        core.efficiency_class = static_cast<uint32_t>(capacity);
+      }
+    }
+
+    for (uint32_t index = 0;; ++index) {
+      const std::string cache_dir = base + "/cache/index" + std::to_string(index);
+      uint64_t level = 0;
+      if (!ReadUint(cache_dir + "/level", &level)) break;
+      std::string type, size, shared;
+      uint64_t line_size = 0;
+      ReadFirstLine(cache_dir + "/type", &type);
+      ReadFirstLine(cache_dir + "/size", &size);
+      ReadFirstLine(cache_dir + "/shared_cpu_list", &shared);
+      ReadUint(cache_dir + "/coherency_line_size", &line_size);
+      type = LowerCase(type);
+
+      // Every CPU sharing a cache lists it; count each instance once.
+      if (!seen_cache_instances
+               .insert({static_cast<uint32_t>(level), type, shared})
+               .second) {
+        continue;
+      }
+      CacheKey key{static_cast<uint32_t>(level), type, ParseCacheSize(size),
+                   static_cast<uint32_t>(line_size)};
+      auto& entry = caches[key];
+      ++entry.first;
+      entry.second = static_cast<uint32_t>(ParseCpuList(shared).size());
+    }
+  }
+
+  for (auto& entry : cores) topology.cores.push_back(std::move(entry.second));
+  topology.packages = static_cast<uint32_t>(packages.size());
+  AppendCaches(caches, &topology);
+
+  std::error_code error;
+  for (const auto& entry :
+       fs::directory_iterator(sys_root + "/devices/system/node", error)) {
+    std::string name = entry.path().filename().string();
+    if (name.rfind("node", 0) != 0 || name.size() == 4) continue;
+    char* end = nullptr;
+    unsigned long node_id = std::strtoul(name.c_str() + 4, &end, 10);
+    if (*end != '\0') continue;
+    NumaNode node;
+    node.node = static_cast<uint32_t>(node_id);
+    if (ReadFirstLine(entry.path().string() + "/cpulist", &line)) {
+      node.logical_processors = ParseCpuList(line);
+    }
+    topology.numa_nodes.push_back(std::move(node));
+  }
+  std::sort(topology.numa_nodes.begin(), topology.numa_nodes.end(),
+            [](const NumaNode& a, const NumaNode& b) { return a.node < b.node; });
+
+  ClassifyCoresByEfficiencyClass(&topology);
+  CountCoreTypes(&topology);
+  return topology;
+}
+
+std::vector<std::string> DetectSimdFeatures() {
+  std::vector<std::string> features;
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || \
+    defined(__i386__)
+  auto cpuid = [](uint32_t leaf, uint32_t subleaf, uint32_t regs[4]) {
+#ifdef _WIN32
+    int info[4];
+    __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; ++i) regs[i] = static_cast<uint32_t>(info[i]);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+  };
+  auto xgetbv = []() -> uint64_t {
+#ifdef _WIN32
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+  };
+
+  uint32_t regs[4] = {};
+  cpuid(0, 0, regs);
+  const uint32_t max_leaf = regs[0];
+  cpuid(1, 0, regs);
+  const uint32_t ecx1 = regs[2];
+  const uint32_t edx1 = regs[3];
+  uint32_t ebx7 = 0, ecx7 = 0;
+  if (max_leaf >= 7) {
+    cpuid(7, 0, regs);
+    ebx7 = regs[1];
+    ecx7 = regs[2];
+  }
+
+  // AVX state must also be enabled by the OS (XCR0), not just the CPU.
+  bool os_avx = false, os_avx512 = false;
+  if (ecx1 & (1u << 27)) {  // OSXSAVE
+    uint64_t xcr0 = xgetbv();
+    os_avx = (xcr0 & 0x6) == 0x6;
+    os_avx512 = os_avx && (xcr0 & 0xe0) == 0xe0;
+  }
+
+  auto add = [&features](uint32_t present, const char* name) {
+    if (present != 0) features.emplace_back(name);
+  };
+  add(edx1 & (1u << 26), "sse2");
+  add(ecx1 & (1u << 0), "sse3");
+  add(ecx1 & (1u << 9), "ssse3");
+  add(ecx1 & (1u << 19), "sse4.1");
+  add(ecx1 & (1u << 20), "sse4.2");
+  add(ecx1 & (1u << 23), "popcnt");
+  add(ecx1 & (1u << 25), "aes");
+  add(ecx1 & (1u << 1), "pclmul");
+  add(os_avx && (ecx1 & (1u << 28)), "avx");
+  add(os_avx && (ecx1 & (1u << 12)), "fma");
+  add(os_avx && (ebx7 & (1u << 5)), "avx2");
+  add(ebx7 & (1u << 3), "bmi1");
+  add(ebx7 & (1u << 8), "bmi2");
+  add(ebx7 & (1u << 29), "sha");
+  add(os_avx && (ecx7 & (1u << 9)), "vaes");
+  add(os_avx512 && (ebx7 & (1u << 16)), "avx512f");
+  add(os_avx512 && (ebx7 & (1u << 17)), "avx512dq");
+  add(os_avx512 && (ebx7 & (1u << 30)), "avx512bw");
+  add(os_avx512 && (ebx7 & (1u << 31)), "avx512vl");
+#elif defined(_M_ARM64) || defined(__aarch64__)
+  // Advanced SIMD is mandatory on AArch64.
+  features.emplace_back("neon");
+#endif
+  return features;
+}
+
+const CpuTopology& GetCpuTopology() {
+  static const CpuTopology topology = [] {
+#ifdef _WIN32
+    CpuTopology result = ReadWindowsCpuTopology();
+#else
+    CpuTopology result = ReadSysfsCpuTopology("/sys");
+#endif
+    result.simd_features = DetectSimdFeatures();
+    return result;
+  }();
+  return topology;
+}
+
+}  // namespace flutter_native_utils
@@ -0,0 +1,67 @@
+#ifndef FLUTTER_PLUGIN_CPU_TOPOLOGY_H_
+#define FLUTTER_PLUGIN_CPU_TOPOLOGY_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace flutter_native_utils {
+
+enum class CpuCoreType { kPerformance, kEfficiency };
+
+struct CpuCore {
+  // Logical processor numbers (hardware threads) belonging to this core.
+  std::vector<uint32_t> logical_processors;
+  CpuCoreType type = CpuCoreType::kPerformance;
+  // Higher is faster. Cores of a non-hybrid CPU all share class 0.
+  uint32_t efficiency_class = 0;
+};
+
+// One cache level/type, aggregated over all of its instances. Hybrid CPUs can
+// have differently sized caches at the same level; those are reported as
+// separate entries.
+struct CpuCache {
+  uint32_t level = 0;
+  std::string type;  // "data", "instruction" or "unified".
+  uint64_t size_bytes = 0;  // Size of a single instance.
+  uint32_t line_size = 0;
+  uint32_t instances = 0;
+  // Logical processors sharing one instance.
+  uint32_t shared_by = 0;
+};
+
+struct NumaNode {
+  uint32_t node = 0;
+  std::vector<uint32_t> logical_processors;
+};
+
+struct CpuTopology {
+  uint32_t packages = 0;
+  uint32_t physical_cores = 0;
+  uint32_t logical_processors = 0;
+  uint32_t performance_cores = 0;
+  uint32_t efficiency_cores = 0;
+  std::vector<CpuCore> cores;
+  std::vector<CpuCache> caches;
+  std::vector<NumaNode> numa_nodes;
+  std::vector<std::string> simd_features;
+};
+
+// Returns the topology of the machine. It is computed on first call and
+// cached for the lifetime of the process; the call is thread-safe.
+const CpuTopology& GetCpuTopology();
+
+// Reads the topology from a sysfs tree rooted at |sys_root| (normally "/sys").
+// Exposed so that recorded fixtures can be used in tests. SIMD features are
+// not part of sysfs and are left empty.
+CpuTopology ReadSysfsCpuTopology(const std::string& sys_root);
+
+// SIMD instruction set extensions supported by the running CPU and OS.
+std::vector<std::string> DetectSimdFeatures();
+
+// Parses a Linux cpulist such as "0-3,8,10-11".
+std::vector<uint32_t> ParseCpuList(const std::string& list);
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_CPU_TOPOLOGY_H_
@@ -0,0 +1,641 @@
+#include "device_fingerprint.h"
+
+#ifdef _WIN32
+// winsock2.h must come before windows.h, which would otherwise pull in the
+// conflicting winsock.h that iphlpapi.h does not expect.
+#include <winsock2.h>
+#include <windows.h>
+
+#include <intrin.h>
+#include <iphlpapi.h>
+#include <winioctl.h>
+
+#pragma comment(lib, "advapi32.lib")
+#pragma comment(lib, "iphlpapi.lib")
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+#include "hmac.h"
+
+namespace flutter_native_utils {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+std::string Trim(const std::string& text) {
+  const char* const kSpace = " \t\r\n";
+  size_t begin = text.find_first_not_of(kSpace);
+  if (begin == std::string::npos) return std::string();
+  size_t end = text.find_last_not_of(kSpace);
+  return text.substr(begin, end - begin + 1);
+}
+
+std::string Upper(std::string text) {
+  std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) {
+    return static_cast<char>(std::toupper(c));
+  });
+  return text;
+}
+
+bool IsKnownIdentifier(const std::string& name) {
+  const std::vector<std::string>& names = DeviceIdentifierNames();
+  return std::find(names.begin(), names.end(), name) != names.end();
+}
+
+// Values firmware and OEM images leave in place of a real identifier,
+// upper-case.
+const char* const kPlaceholders[] = {
+    "TO BE FILLED BY O.E.M.",
+    "TO BE FILLED BY OEM",
+    "DEFAULT STRING",
+    "SYSTEM SERIAL NUMBER",
+    "SYSTEM PRODUCT NAME",
+    "BASE BOARD SERIAL NUMBER",
+    "CHASSIS SERIAL NUMBER",
+    "SERIAL NUMBER",
+    "SERIALNUMBER",
+    "SERIAL",
+    "NOT SPECIFIED",
+    "NOT APPLICABLE",
+    "NOT AVAILABLE",
+    "NOT PRESENT",
+    "NONE",
+    "N/A",
+    "NA",
+    "NULL",
+    "EMPTY",
+    "UNKNOWN",
+    "INVALID",
+    "OEM",
+    "O.E.M.",
+    "0123456789",
+    "123456789",
+    "1234567890",
+};
+
+// Whether every character of |value| other than separators is the same,
+// as in all-zero or all-F UUIDs, "XXXXXXXX" or "00:00:00:00:00:00".
+bool IsRepeatedCharacter(const std::string& value) {
+  char repeated = '\0';
+  for (char c : value) {
+    if (c == '-' || c == ':' || c == '.' || c == '_' || c == ' ') continue;
+    if (repeated == '\0') {
+      repeated = c;
+    } else if (c != repeated) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void AppendLengthPrefixed(HmacSha256* mac, const std::string& text) {
+  const uint32_t len = static_cast<uint32_t>(text.size());
+  const uint8_t prefix[4] = {
+      static_cast<uint8_t>(len >> 24), static_cast<uint8_t>(len >> 16),
+      static_cast<uint8_t>(len >> 8), static_cast<uint8_t>(len)};
+  mac->Update(prefix, sizeof(prefix));
+  mac->Update(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+}
+
+std::string FormatSmbiosUuid(const uint8_t* uuid, bool little_endian) {
+  // Since SMBIOS 2.6 the first three fields are little-endian.
+  static const int kLittleEndianOrder[16] = {3, 2, 1, 0, 5, 4, 7, 6,
+                                             8, 9, 10, 11, 12, 13, 14, 15};
+  std::string text;
+  char hex[3];
+  for (int i = 0; i < 16; ++i) {
+    if (i == 4 || i == 6 || i == 8 || i == 10) text.push_back('-');
+    std::snprintf(hex, sizeof(hex), "%02X",
+                  uuid[little_endian ? kLittleEndianOrder[i] : i]);
+    text += hex;
+  }
+  return text;
+}
+
+// ---------- sysfs ----------
+
+// Contents of a small file; empty if it cannot be read.
+std::string ReadTextFile(const fs::path& path) {
+  std::ifstream file(path);
+  if (!file) return std::string();
+  std::string text((std::istreambuf_iterator<char>(file)),
+                   std::istreambuf_iterator<char>());
+  return file.bad() ? std::string() : text;
+}
+
+std::vector<fs::path> SortedEntries(const fs::path& directory) {
+  std::vector<fs::path> entries;
+  std::error_code error;
+  for (fs::directory_iterator it(directory, error), end; !error && it != end;
+       it.increment(error)) {
+    entries.push_back(it->path());
+  }
+  std::sort(entries.begin(), entries.end());
+  return entries;
+}
+
+// The CPU fields of the first processor block of a cpuinfo file: vendor and
+// model on x86, implementer and part on ARM.
+std::string ReadProcessorSignature(const fs::path& cpuinfo) {
+  static const char* const kKeys[] = {
+      "vendor_id",       "cpu family",  "model",    "model name",  "stepping",
+      "CPU implementer", "CPU variant", "CPU part", "CPU revision"};
+  std::map<std::string, std::string> fields;
+  std::ifstream file(cpuinfo);
+  std::string line;
+  while (std::getline(file, line)) {
+    if (Trim(line).empty()) {
+      if (!fields.empty()) break;
+      continue;
+    }
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) continue;
+    fields.emplace(Trim(line.substr(0, colon)), Trim(line.substr(colon + 1)));
+  }
+  std::string signature;
+  for (const char* key : kKeys) {
+    auto it = fields.find(key);
+    if (it == fields.end() || it->second.empty()) continue;
+    if (!signature.empty()) signature.push_back(' ');
+    signature += it->second;
+  }
+  return signature;
+}
+
+// The serial of the first fixed disk, in name order. Virtual block devices
+// have no device/ entry.
+std::string ReadSystemDiskSerial(const fs::path& block) {
+  for (const fs::path& disk : SortedEntries(block)) {
+    std::error_code error;
+    if (!fs::exists(disk / "device", error)) continue;
+    if (Trim(ReadTextFile(disk / "removable")) == "1") continue;
+    std::string serial = Trim(ReadTextFile(disk / "device" / "serial"));
+    if (serial.empty()) {
+      serial = Trim(ReadTextFile(disk / "serial"));
+    }
+    return serial;
+  }
+  return std::string();
+}
+
+// Adapters backed by a device; virtual ones such as lo and bridges have no
+// device/ entry.
+std::string ReadPhysicalMacAddresses(const fs::path& net) {
+  std::vector<std::string> macs;
+  for (const fs::path& adapter : SortedEntries(net)) {
+    std::error_code error;
+    if (!fs::exists(adapter / "device", error)) continue;
+    macs.push_back(Trim(ReadTextFile(adapter / "address")));
+  }
+  return JoinPhysicalMacAddresses(std::move(macs));
+}
+
+#ifdef _WIN32
+// ---------- Windows ----------
+
+std::string WideToUtf8(const wchar_t* text, size_t len) {
+  if (len == 0) return std::string();
+  int size = WideCharToMultiByte(CP_UTF8, 0, text, static_cast<int>(len),
+                                 nullptr, 0, nullptr, nullptr);
+  std::string utf8(static_cast<size_t>(size), '\0');
+  WideCharToMultiByte(CP_UTF8, 0, text, static_cast<int>(len), utf8.data(),
+                      size, nullptr, nullptr);
+  return utf8;
+}
+
+std::string ReadRegistryString(const wchar_t* key, const wchar_t* value) {
+  wchar_t buffer[256];
+  DWORD size = sizeof(buffer);
+  // The 64-bit view, which is where MachineGuid lives, from 32-bit builds too.
+  if (RegGetValueW(HKEY_LOCAL_MACHINE, key, value,
+                   RRF_RT_REG_SZ | RRF_SUBKEY_WOW6464KEY, nullptr, buffer,
+                   &size) != ERROR_SUCCESS) {
+    return std::string();
+  }
+  return WideToUtf8(buffer, wcsnlen(buffer, size / sizeof(wchar_t)));
+}
+
+SmbiosIdentifiers ReadSmbios() {
+  // 'RSMB'.
+  const DWORD kRawSmbiosProvider = 0x52534D42;
+  UINT size = GetSystemFirmwareTable(kRawSmbiosProvider, 0, nullptr, 0);
+  // RawSMBIOSData: calling method, major and minor version, DMI revision
+  // and the table length, then the table.
+  constexpr UINT kHeaderLen = 8;
+  if (size <= kHeaderLen) return SmbiosIdentifiers();
+  std::vector<uint8_t> raw(size);
+  if (GetSystemFirmwareTable(kRawSmbiosProvider, 0, raw.data(), size) != size) {
+    return SmbiosIdentifiers();
+  }
+  uint32_t table_len;
+  std::memcpy(&table_len, raw.data() + 4, sizeof(table_len));
+  if (table_len > size - kHeaderLen) table_len = size - kHeaderLen;
+  return ParseSmbiosTable(raw.data() + kHeaderLen, table_len, raw[1], raw[2]);
+}
+
+std::string ReadProcessorId() {
+#if defined(_M_X64) || defined(_M_IX86)
+  // EDX then EAX of leaf 1, as WMI's Win32_Processor.ProcessorId.
+  int registers[4];
+  __cpuid(registers, 1);
+  char text[17];
+  std::snprintf(text, sizeof(text), "%08X%08X",
+                static_cast<unsigned>(registers[3]),
+                static_cast<unsigned>(registers[0]));
+  return text;
+#else
+  const wchar_t* const kKey =
+      L"HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0";
+  return ReadRegistryString(kKey, L"Identifier") + " " +
+         ReadRegistryString(kKey, L"ProcessorNameString");
+#endif
+}
+
+class ScopedHandle {
+ public:
+  explicit ScopedHandle(HANDLE handle) : handle_(handle) {}
+  ~ScopedHandle() {
+    if (valid()) CloseHandle(handle_);
+  }
+
+  // Disallow copy and assign.
+  ScopedHandle(const ScopedHandle&) = delete;
+  ScopedHandle& operator=(const ScopedHandle&) = delete;
+
+  bool valid() const { return handle_ != INVALID_HANDLE_VALUE; }
+  HANDLE get() const { return handle_; }
+
+ private:
+  HANDLE handle_;
+};
+
+// Opens a volume or disk for queries only, which needs no elevation.
+HANDLE OpenForQuery(const std::wstring& path) {
+  return CreateFileW(path.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                     nullptr, OPEN_EXISTING, 0, nullptr);
+}
+
+// The serial of the disk holding the Windows directory.
+std::string ReadSystemDiskSerial() {
+  wchar_t windows_dir[MAX_PATH];
+  UINT len = GetSystemWindowsDirectoryW(windows_dir, MAX_PATH);
+  if (len < 2 || len >= MAX_PATH || windows_dir[1] != L':') {
+    return std::string();
+  }
+  STORAGE_DEVICE_NUMBER number;
+  DWORD returned = 0;
+  {
+    ScopedHandle volume(
+        OpenForQuery(L"\\\\.\\" + std::wstring(windows_dir, 2)));
+    if (!volume.valid() ||
+        !DeviceIoControl(volume.get(), IOCTL_STORAGE_GET_DEVICE_NUMBER,
+                         nullptr, 0, &number, sizeof(number), &returned,
+                         nullptr)) {
+      return std::string();
+    }
+  }
+
+  ScopedHandle disk(OpenForQuery(L"\\\\.\\PhysicalDrive" +
+                                 std::to_wstring(number.DeviceNumber)));
+  if (!disk.valid()) return std::string();
+  STORAGE_PROPERTY_QUERY query = {};
+  query.PropertyId = StorageDeviceProperty;
+  query.QueryType = PropertyStandardQuery;
+  std::vector<uint8_t> buffer(1024);
+  if (!DeviceIoControl(disk.get(), IOCTL_STORAGE_QUERY_PROPERTY, &query,
+                       sizeof(query), buffer.data(),
+                       static_cast<DWORD>(buffer.size()), &returned, nullptr) ||
+      returned < sizeof(STORAGE_DEVICE_DESCRIPTOR)) {
+    return std::string();
+  }
+  const auto* descriptor =
+      reinterpret_cast<const STORAGE_DEVICE_DESCRIPTOR*>(buffer.data());
+  const DWORD offset = descriptor->SerialNumberOffset;
+  if (offset == 0 || offset >= returned) return std::string();
+  const char* serial = reinterpret_cast<const char*>(buffer.data() + offset);
+  return std::string(serial, strnlen(serial, returned - offset));
+}
+
+std::string ReadPhysicalMacAddresses() {
+  const ULONG kFlags = GAA_FLAG_SKIP_UNICAST | GAA_FLAG_SKIP_ANYCAST |
+                       GAA_FLAG_SKIP_MULTICAST | GAA_FLAG_SKIP_DNS_SERVER;
+  ULONG size = 16 * 1024;
+  std::vector<uint8_t> buffer;
+  ULONG status;
+  do {
+    buffer.resize(size);
+    status = GetAdaptersAddresses(
+        AF_UNSPEC, kFlags, nullptr,
+        reinterpret_cast<IP_ADAPTER_ADDRESSES*>(buffer.data()), &size);
+  } while (status == ERROR_BUFFER_OVERFLOW);
+  if (status != NO_ERROR) return std::string();
+
+  std::vector<std::string> macs;
+  for (auto* adapter = reinterpret_cast<IP_ADAPTER_ADDRESSES*>(buffer.data());
+       adapter; adapter = adapter->Next) {
+    if ((adapter->IfType != IF_TYPE_ETHERNET_CSMACD &&
+         adapter->IfType != IF_TYPE_IEEE80211) ||
+        adapter->PhysicalAddressLength != 6) {
+      continue;
+    }
+    char text[18];
+    const BYTE* mac = adapter->PhysicalAddress;
+    std::snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X", mac[0],
+                  mac[1], mac[2], mac[3], mac[4], mac[5]);
+    macs.push_back(text);
+  }
+  return JoinPhysicalMacAddresses(std::move(macs));
+}
+
+class WindowsDeviceIdentifierSource : public DeviceIdentifierSource {
+ public:
+  std::string Read(const std::string& name) override {
+    if (name == "systemUuid" || name == "systemSerial" ||
+        name == "boardSerial") {
+      // One firmware table read serves all three.
+      std::call_once(smbios_once_, [this]() { smbios_ = ReadSmbios(); });
+      if (name == "systemUuid") return smbios_.system_uuid;
+      if (name == "systemSerial") return smbios_.system_serial;
+      return smbios_.board_serial;
+    }
+    if (name == "processorId") return ReadProcessorId();
+    if (name == "machineId") {
+      return ReadRegistryString(L"SOFTWARE\\Microsoft\\Cryptography",
+                                L"MachineGuid");
+    }
+    if (name == "diskSerial") return ReadSystemDiskSerial();
+    if (name == "macAddresses") return ReadPhysicalMacAddresses();
+    return std::string();
+  }
+
+ private:
+  std::once_flag smbios_once_;
+  SmbiosIdentifiers smbios_;
+};
+#endif
+
+// One ReadDeviceIdentifiersAsync call; the last read to finish completes it.
+struct IdentifierJob {
+  std::shared_ptr<DeviceIdentifierSource> source;
+  std::vector<DeviceIdentifier> identifiers;
+  std::atomic<size_t> remaining{0};
+  DeviceIdentifierCallback on_complete;
+};
+
+}  // namespace
+
+const std::vector<std::string>& DeviceIdentifierNames() {
+  static const std::vector<std::string> kNames = {
+      "systemUuid", "systemSerial", "boardSerial",  "processorId",
+      "machineId",  "diskSerial",   "macAddresses"};
+  return kNames;
+}
+
+SysfsDeviceIdentifierSource::SysfsDeviceIdentifierSource(std::string root)
+    : root_(std::move(root)) {}
+
+std::string SysfsDeviceIdentifierSource::Read(const std::string& name) {
+  const fs::path root = fs::u8path(root_);
+  const fs::path dmi = root / "sys" / "class" / "dmi" / "id";
+  if (name == "systemUuid") return ReadTextFile(dmi / "product_uuid");
+  if (name == "systemSerial") return ReadTextFile(dmi / "product_serial");
+  if (name == "boardSerial") return ReadTextFile(dmi / "board_serial");
+  if (name == "processorId") {
+    return ReadProcessorSignature(root / "proc" / "cpuinfo");
+  }
+  if (name == "machineId") {
+    std::string id = ReadTextFile(root / "etc" / "machine-id");
+    if (Trim(id).empty()) {
+      id = ReadTextFile(root / "var" / "lib" / "dbus" / "machine-id");
+    }
+    return id;
+  }
+  if (name == "diskSerial") return ReadSystemDiskSerial(root / "sys" / "block");
+  if (name == "macAddresses") {
+    return ReadPhysicalMacAddresses(root / "sys" / "class" / "net");
+  }
+  return std::string();
+}
+
+std::unique_ptr<DeviceIdentifierSource> CreateDefaultDeviceIdentifierSource() {
+#ifdef _WIN32
+  return std::make_unique<WindowsDeviceIdentifierSource>();
+#else
+  return std::make_unique<SysfsDeviceIdentifierSource>();
+#endif
+}
+
+SmbiosIdentifiers ParseSmbiosTable(const uint8_t* data, size_t len,
+                                   uint8_t major_version,
+                                   uint8_t minor_version) {
+  constexpr uint8_t kSystemInformation = 1;
+  constexpr uint8_t kBaseboardInformation = 2;
+  constexpr uint8_t kEndOfTable = 127;
+  const bool little_endian_uuid =
+      major_version > 2 || (major_version == 2 && minor_version >= 6);
+
+  SmbiosIdentifiers identifiers;
+  size_t offset = 0;
+  while (offset + 4 <= len) {
+    const uint8_t type = data[offset];
+    const size_t formatted_len = data[offset + 1];
+    if (formatted_len < 4 || offset + formatted_len > len) break;
+    // The formatted area is followed by NUL-terminated strings and one more
+    // NUL; a structure without strings ends in two NULs.
+    const size_t strings = offset + formatted_len;
+    size_t end = strings;
+    while (end + 1 < len && (data[end] != 0 || data[end + 1] != 0)) ++end;
+    if (end + 1 >= len) break;
+
+    // String fields hold a 1-based index into the strings; 0 is none.
+    auto string_field = [&](size_t field) {
+      if (field >= formatted_len || data[offset + field] == 0) {
+        return std::string();
+      }
+      const uint8_t index = data[offset + field];
+      size_t position = strings;
+      for (uint8_t i = 1; position < end; ++i) {
+        const char* text = reinterpret_cast<const char*>(data + position);
+        const size_t text_len = strnlen(text, end - position);
+        if (i == index) return std::string(text, text_len);
+        position += text_len + 1;
+      }
+      return std::string();
+    };
+
+    if (type == kSystemInformation) {
+      identifiers.system_serial = string_field(0x07);
+      if (formatted_len >= 0x18) {
+        identifiers.system_uuid =
+            FormatSmbiosUuid(data + offset + 0x08, little_endian_uuid);
+      }
+    } else if (type == kBaseboardInformation) {
+      identifiers.board_serial = string_field(0x07);
+    } else if (type == kEndOfTable) {
+      break;
+    }
+    offset = end + 2;
+  }
+  return identifiers;
+}
+
+std::string JoinPhysicalMacAddresses(std::vector<std::string> macs) {
+  std::vector<std::string> physical;
+  for (std::string& mac : macs) {
+    mac = Upper(Trim(mac));
+    std::replace(mac.begin(), mac.end(), '-', ':');
+    unsigned first_octet = 0;
+    if (mac.size() != 17 || std::sscanf(mac.c_str(), "%2x", &first_octet) != 1) {
+      continue;
+    }
+    // Bit 1 of the first octet marks a locally administered address.
+    if ((first_octet & 0x02) != 0 || IsRepeatedCharacter(mac)) continue;
+    physical.push_back(std::move(mac));
+  }
+  std::sort(physical.begin(), physical.end());
+  physical.erase(std::unique(physical.begin(), physical.end()), physical.end());
+  std::string joined;
+  for (const std::string& mac : physical) {
+    if (!joined.empty()) joined.push_back(',');
+    joined += mac;
+  }
+  return joined;
+}
+
+std::string NormalizeDeviceIdentifier(const std::string& raw) {
+  std::string value;
+  bool space = false;
+  for (char c : Trim(raw)) {
+    if (std::isspace(static_cast<unsigned char>(c))) {
+      space = true;
+      continue;
+    }
+    if (space) value.push_back(' ');
+    space = false;
+    value.push_back(static_cast<char>(std::toupper(static_cast<unsigned char>(c))));
+  }
+  if (IsRepeatedCharacter(value)) return std::string();
+  for (const char* placeholder : kPlaceholders) {
+    if (value == placeholder) return std::string();
+  }
+  return value;
+}
+
+void ReadDeviceIdentifiersAsync(std::shared_ptr<DeviceIdentifierSource> source,
+                                std::vector<std::string> names,
+                                WorkerPool* pool,
+                                DeviceIdentifierCallback on_complete) {
+  for (const std::string& name : names) {
+    if (!IsKnownIdentifier(name)) {
+      throw std::invalid_argument("Unknown device identifier: " + name);
+    }
+  }
+  auto job = std::make_shared<IdentifierJob>();
+  job->source = std::move(source);
+  job->on_complete = std::move(on_complete);
+  job->identifiers.resize(names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    job->identifiers[i].name = std::move(names[i]);
+  }
+  if (job->identifiers.empty()) {
+    job->on_complete({});
+    return;
+  }
+
+  // Each identifier is a separate system call or file read, some of them
+  // slow (the disk and adapter queries), so they run side by side.
+  job->remaining = job->identifiers.size();
+  for (size_t index = 0; index < job->identifiers.size(); ++index) {
+    pool->Post([job, index]() {
+      DeviceIdentifier& identifier = job->identifiers[index];
+      try {
+        identifier.value =
+            NormalizeDeviceIdentifier(job->source->Read(identifier.name));
+      } catch (const std::exception&) {
+        // Unreadable identifiers are missing, like absent ones.
+      }
+      if (job->remaining.fetch_sub(1) == 1) {
+        job->on_complete(std::move(job->identifiers));
+      }
+    });
+  }
+}
+
+std::vector<DeviceIdentifier> ReadDeviceIdentifiers(
+    std::shared_ptr<DeviceIdentifierSource> source,
+    std::vector<std::string> names, WorkerPool* pool) {
+  std::promise<std::vector<DeviceIdentifier>> promise;
+  std::future<std::vector<DeviceIdentifier>> future = promise.get_future();
+  ReadDeviceIdentifiersAsync(
+      std::move(source), std::move(names), pool,
+      [&promise](std::vector<DeviceIdentifier> identifiers) {
+        promise.set_value(std::move(identifiers));
+      });
+  return future.get();
+}
+
+DeviceFingerprint ComputeDeviceFingerprint(
+    const std::vector<DeviceIdentifier>& identifiers, const uint8_t* salt,
+    size_t salt_len) {
+  if (salt_len < kDeviceFingerprintMinSaltLen) {
+    throw std::invalid_argument("salt must be at least " +
+                                std::to_string(kDeviceFingerprintMinSaltLen) +
+                                " bytes");
+  }
+  DeviceFingerprint fingerprint;
+  HmacSha256 composite(salt, salt_len);
+  AppendLengthPrefixed(&composite, "deviceFingerprint/v1");
+  for (const DeviceIdentifier& identifier : identifiers) {
+    DeviceFingerprintComponent component;
+    component.name = identifier.name;
+    AppendLengthPrefixed(&composite, identifier.name);
+    if (identifier.value.empty()) {
+      const uint8_t missing = 0;
+      composite.Update(&missing, 1);
+    } else {
+      HmacSha256 mac(salt, salt_len);
+      AppendLengthPrefixed(&mac, identifier.name);
+      AppendLengthPrefixed(&mac, identifier.value);
+      component.hash = mac.Finish();
+      const uint8_t present = 1;
+      composite.Update(&present, 1);
+      composite.Update(component.hash->data(), component.hash->size());
+    }
+    fingerprint.components.push_back(std::move(component));
+  }
+  fingerprint.digest = composite.Finish();
+  return fingerprint;
+}
+
+size_t CountMatchingComponents(
+    const DeviceFingerprint& fingerprint,
+    const std::map<std::string, std::vector<uint8_t>>& reference) {
+  size_t matching = 0;
+  for (const DeviceFingerprintComponent& component : fingerprint.components) {
+    if (!component.hash) continue;
+    auto it = reference.find(component.name);
+    if (it == reference.end() || it->second.size() != component.hash->size()) {
+      continue;
+    }
+    if (std::equal(it->second.begin(), it->second.end(),
+                   component.hash->begin())) {
+      ++matching;
+    }
+  }
+  return matching;
+}
+
+}  // namespace flutter_native_utils
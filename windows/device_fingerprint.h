@@ -0,0 +1,140 @@
+#ifndef FLUTTER_PLUGIN_DEVICE_FINGERPRINT_H_
+#define FLUTTER_PLUGIN_DEVICE_FINGERPRINT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "sha256.h"
+#include "worker_pool.h"
+
+namespace flutter_native_utils {
+
+// Identifiers a fingerprint is built from, in the order they are hashed:
+//   systemUuid    SMBIOS system UUID
+//   systemSerial  SMBIOS system serial number
+//   boardSerial   SMBIOS baseboard serial number
+//   processorId   CPU signature: CPUID leaf 1 on Windows (as WMI's
+//                 ProcessorId), the vendor and model name elsewhere
+//   machineId     OS installation id: MachineGuid on Windows,
+//                 /etc/machine-id elsewhere
+//   diskSerial    serial number of the system disk
+//   macAddresses  sorted, comma-separated MACs of the physical adapters
+const std::vector<std::string>& DeviceIdentifierNames();
+
+// Raw identifier values of one device.
+class DeviceIdentifierSource {
+ public:
+  virtual ~DeviceIdentifierSource() = default;
+
+  // The raw value of |name|, one of DeviceIdentifierNames(), or an empty
+  // string if the device has none or it cannot be read. Called from several
+  // threads at once.
+  virtual std::string Read(const std::string& name) = 0;
+};
+
+// Reads a sysfs and procfs tree. |root| can point at a fixture tree holding
+// sys/, proc/ and etc/. The DMI serials and UUID are usually only readable
+// by root; unreadable identifiers are missing.
+class SysfsDeviceIdentifierSource : public DeviceIdentifierSource {
+ public:
+  explicit SysfsDeviceIdentifierSource(std::string root = "/");
+
+  std::string Read(const std::string& name) override;
+
+ private:
+  std::string root_;
+};
+
+// Returns the source for the current platform: SMBIOS, CPUID, the registry
+// and the storage and adapter APIs on Windows, without WMI; sysfs elsewhere.
+std::unique_ptr<DeviceIdentifierSource> CreateDefaultDeviceIdentifierSource();
+
+// Identifiers SMBIOS holds, from the system (type 1) and baseboard (type 2)
+// structures.
+struct SmbiosIdentifiers {
+  std::string system_uuid;  // "XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX".
+  std::string system_serial;
+  std::string board_serial;
+};
+
+// Parses the structure table of a raw SMBIOS dump (the SMBIOSTableData of
+// GetSystemFirmwareTable('RSMB'), or /sys/firmware/dmi/tables/DMI). Stops at
+// the end-of-table structure or at the first truncated structure.
+SmbiosIdentifiers ParseSmbiosTable(const uint8_t* data, size_t len,
+                                   uint8_t major_version,
+                                   uint8_t minor_version);
+
+// Joins |macs| into the macAddresses identifier: upper-case, sorted and
+// without duplicates, skipping all-zero and locally administered addresses
+// (randomised, VPN and most virtual adapters).
+std::string JoinPhysicalMacAddresses(std::vector<std::string> macs);
+
+// The canonical form of a raw identifier: trimmed, upper-case, with runs of
+// whitespace collapsed. Vendor placeholders ("To be filled by O.E.M.",
+// "Default string", "System Serial Number", all-zero or all-F UUIDs and the
+// like) normalise to an empty string, i.e. a missing identifier.
+std::string NormalizeDeviceIdentifier(const std::string& raw);
+
+struct DeviceIdentifier {
+  std::string name;
+  // Normalised; empty if missing.
+  std::string value;
+};
+
+using DeviceIdentifierCallback =
+    std::function<void(std::vector<DeviceIdentifier> identifiers)>;
+
+// Reads |names| from |source| in parallel on |pool| and calls |on_complete|
+// on a worker with the normalised values, in the order of |names|. Throws
+// std::invalid_argument if a name is not one of DeviceIdentifierNames().
+void ReadDeviceIdentifiersAsync(std::shared_ptr<DeviceIdentifierSource> source,
+                                std::vector<std::string> names,
+                                WorkerPool* pool,
+                                DeviceIdentifierCallback on_complete);
+
+// Blocking variant. Must not be called from a task running on |pool|.
+std::vector<DeviceIdentifier> ReadDeviceIdentifiers(
+    std::shared_ptr<DeviceIdentifierSource> source,
+    std::vector<std::string> names, WorkerPool* pool);
+
+// Salts shorter than this are rejected, so fingerprints of different apps
+// cannot be linked.
+constexpr size_t kDeviceFingerprintMinSaltLen = 16;
+
+struct DeviceFingerprintComponent {
+  std::string name;
+  // HMAC-SHA256 of the name and value, keyed by the salt; unset if the
+  // identifier is missing.
+  std::optional<Sha256Digest> hash;
+};
+
+struct DeviceFingerprint {
+  // HMAC-SHA256 over every component in order, keyed by the salt. Changes
+  // if any identifier does.
+  Sha256Digest digest;
+  std::vector<DeviceFingerprintComponent> components;
+};
+
+// Throws std::invalid_argument if |salt_len| is below
+// kDeviceFingerprintMinSaltLen.
+DeviceFingerprint ComputeDeviceFingerprint(
+    const std::vector<DeviceIdentifier>& identifiers, const uint8_t* salt,
+    size_t salt_len);
+
+// The number of components of |fingerprint| whose hash equals the one
+// |reference| holds under the same name, for k-of-n matching against a
+// fingerprint taken earlier with the same salt. Missing components never
+// match.
+size_t CountMatchingComponents(
+    const DeviceFingerprint& fingerprint,
+    const std::map<std::string, std::vector<uint8_t>>& reference);
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_DEVICE_FINGERPRINT_H_
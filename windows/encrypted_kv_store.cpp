@@ -0,0 +1,1495 @@
+#include "encrypted_kv_store.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include "buffered_random.h"
+#include "secure_random.h"
+#include "siphash.h"
+
+namespace flutter_native_utils {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// ---------- Files ----------
+
+// A file read and written at explicit offsets, so appends and reads from
+// several threads need no shared file position, and optionally mapped
+// read-write.
+class StoreFile {
+ public:
+  StoreFile() = default;
+  ~StoreFile() { Close(); }
+
+  // Disallow copy and assign.
+  StoreFile(const StoreFile&) = delete;
+  StoreFile& operator=(const StoreFile&) = delete;
+
+  // Opens |path| for reading and writing, creating it (readable only by the
+  // owner) if |create|. Returns false if it cannot.
+  bool Open(const std::string& path, bool create);
+  void Close();
+
+  bool ReadAt(uint64_t offset, uint8_t* data, size_t len) const;
+  bool WriteAt(uint64_t offset, const uint8_t* data, size_t len);
+  // Flushes written data to the device.
+  bool Sync();
+  // Grows (with zeros) or truncates the file. Not while mapped.
+  bool Resize(uint64_t size);
+  uint64_t Size() const;
+
+  // Maps the first |len| bytes, which must exist, read-write; null on
+  // failure. Writes reach the file; see FlushMapping.
+  uint8_t* Map(size_t len);
+  void Unmap();
+  bool FlushMapping();
+
+ private:
+#ifdef _WIN32
+  HANDLE file_ = INVALID_HANDLE_VALUE;
+  HANDLE mapping_ = nullptr;
+#else
+  int fd_ = -1;
+#endif
+  uint8_t* view_ = nullptr;
+  size_t view_len_ = 0;
+};
+
+#ifdef _WIN32
+bool StoreFile::Open(const std::string& path, bool create) {
+  Close();
+  // Segments are deleted by compaction while readers may still hold them.
+  file_ = CreateFileW(fs::u8path(path).c_str(), GENERIC_READ | GENERIC_WRITE,
+                      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                      nullptr, create ? OPEN_ALWAYS : OPEN_EXISTING,
+                      FILE_ATTRIBUTE_NORMAL, nullptr);
+  return file_ != INVALID_HANDLE_VALUE;
+}
+
+void StoreFile::Close() {
+  Unmap();
+  if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+  file_ = INVALID_HANDLE_VALUE;
+}
+
+bool StoreFile::ReadAt(uint64_t offset, uint8_t* data, size_t len) const {
+  while (len > 0) {
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = static_cast<DWORD>(offset);
+    overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    const DWORD chunk = static_cast<DWORD>(std::min<size_t>(len, 1 << 30));
+    DWORD read = 0;
+    if (!ReadFile(file_, data, chunk, &read, &overlapped) || read == 0) {
+      return false;
+    }
+    offset += read;
+    data += read;
+    len -= read;
+  }
+  return true;
+}
+
+bool StoreFile::WriteAt(uint64_t offset, const uint8_t* data, size_t len) {
+  while (len > 0) {
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = static_cast<DWORD>(offset);
+    overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    const DWORD chunk = static_cast<DWORD>(std::min<size_t>(len, 1 << 30));
+    DWORD written = 0;
+    if (!WriteFile(file_, data, chunk, &written, &overlapped) ||
+        written == 0) {
+      return false;
+    }
+    offset += written;
+    data += written;
+    len -= written;
+  }
+  return true;
+}
+
+bool StoreFile::Sync() { return FlushFileBuffers(file_) != 0; }
+
+bool StoreFile::Resize(uint64_t size) {
+  FILE_END_OF_FILE_INFO end = {};
+  end.EndOfFile.QuadPart = static_cast<LONGLONG>(size);
+  return SetFileInformationByHandle(file_, FileEndOfFileInfo, &end,
+                                    sizeof(end)) != 0;
+}
+
+uint64_t StoreFile::Size() const {
+  LARGE_INTEGER size;
+  return GetFileSizeEx(file_, &size) ? static_cast<uint64_t>(size.QuadPart)
+                                     : 0;
+}
+
+uint8_t* StoreFile::Map(size_t len) {
+  Unmap();
+  mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+  if (!mapping_) return nullptr;
+  view_ = static_cast<uint8_t*>(
+      MapViewOfFile(mapping_, FILE_MAP_WRITE, 0, 0, len));
+  if (!view_) {
+    Unmap();
+    return nullptr;
+  }
+  view_len_ = len;
+  return view_;
+}
+
+void StoreFile::Unmap() {
+  if (view_) UnmapViewOfFile(view_);
+  if (mapping_) CloseHandle(mapping_);
+  view_ = nullptr;
+  mapping_ = nullptr;
+  view_len_ = 0;
+}
+
+bool StoreFile::FlushMapping() {
+  return FlushViewOfFile(view_, view_len_) && FlushFileBuffers(file_);
+}
+
+void SyncDirectory(const std::string&) {
+  // NTFS journals renames and creations itself.
+}
+#else
+bool StoreFile::Open(const std::string& path, bool create) {
+  Close();
+  fd_ = open(path.c_str(), O_RDWR | O_CLOEXEC | (create ? O_CREAT : 0), 0600);
+  return fd_ >= 0;
+}
+
+void StoreFile::Close() {
+  Unmap();
+  if (fd_ >= 0) close(fd_);
+  fd_ = -1;
+}
+
+bool StoreFile::ReadAt(uint64_t offset, uint8_t* data, size_t len) const {
+  while (len > 0) {
+    const ssize_t read =
+        pread(fd_, data, len, static_cast<off_t>(offset));
+    if (read < 0 && errno == EINTR) continue;
+    if (read <= 0) return false;
+    offset += static_cast<uint64_t>(read);
+    data += read;
+    len -= static_cast<size_t>(read);
+  }
+  return true;
+}
+
+bool StoreFile::WriteAt(uint64_t offset, const uint8_t* data, size_t len) {
+  while (len > 0) {
+    const ssize_t written =
+        pwrite(fd_, data, len, static_cast<off_t>(offset));
+    if (written < 0 && errno == EINTR) continue;
+    if (written <= 0) return false;
+    offset += static_cast<uint64_t>(written);
+    data += written;
+    len -= static_cast<size_t>(written);
+  }
+  return true;
+}
+
+bool StoreFile::Sync() { return fdatasync(fd_) == 0; }
+
+bool StoreFile::Resize(uint64_t size) {
+  return ftruncate(fd_, static_cast<off_t>(size)) == 0;
+}
+
+uint64_t StoreFile::Size() const {
+  struct stat status;
+  return fstat(fd_, &status) == 0 ? static_cast<uint64_t>(status.st_size) : 0;
+}
+
+uint8_t* StoreFile::Map(size_t len) {
+  Unmap();
+  void* view =
+      mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (view == MAP_FAILED) return nullptr;
+  view_ = static_cast<uint8_t*>(view);
+  view_len_ = len;
+  return view_;
+}
+
+void StoreFile::Unmap() {
+  if (view_) munmap(view_, view_len_);
+  view_ = nullptr;
+  view_len_ = 0;
+}
+
+bool StoreFile::FlushMapping() { return msync(view_, view_len_, MS_SYNC) == 0; }
+
+// Makes creations and renames in |directory| durable.
+void SyncDirectory(const std::string& directory) {
+  int fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) return;
+  fsync(fd);
+  close(fd);
+}
+#endif
+
+std::vector<uint8_t> ReadWholeFile(const StoreFile& file, uint64_t size) {
+  std::vector<uint8_t> data(static_cast<size_t>(size));
+  if (!file.ReadAt(0, data.data(), data.size())) {
+    throw std::runtime_error("Cannot read store file");
+  }
+  return data;
+}
+
+// Replaces |path| with |data|: readers see the old or the new file, never
+// a mix, even across a crash.
+void WriteFileAtomically(const std::string& directory, const std::string& name,
+                         const std::vector<uint8_t>& data) {
+  const std::string path = directory + "/" + name;
+  const std::string temp = path + ".tmp";
+  {
+    StoreFile file;
+    if (!file.Open(temp, true) || !file.Resize(0) ||
+        !file.WriteAt(0, data.data(), data.size()) || !file.Sync()) {
+      throw std::runtime_error("Cannot write " + temp);
+    }
+  }
+  std::error_code error;
+  fs::rename(fs::u8path(temp), fs::u8path(path), error);
+  if (error) throw std::runtime_error("Cannot replace " + path);
+  SyncDirectory(directory);
+}
+
+void AppendLe32(uint32_t value, uint8_t* out) {
+  for (int i = 0; i < 4; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+void AppendLe64(uint64_t value, uint8_t* out) {
+  for (int i = 0; i < 8; ++i) out[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+uint32_t ReadLe32(const uint8_t* data) {
+  uint32_t value = 0;
+  for (int i = 3; i >= 0; --i) value = (value << 8) | data[i];
+  return value;
+}
+
+uint64_t ReadLe64(const uint8_t* data) {
+  uint64_t value = 0;
+  for (int i = 7; i >= 0; --i) value = (value << 8) | data[i];
+  return value;
+}
+
+// ---------- Formats ----------
+
+// KEY: magic | store id (16) | key name length (u32 LE) | key name |
+// wrapped secret length (u32 LE) | wrapped secret. The secret is the AES
+// data key followed by the SipHash keys of the index.
+constexpr char kKeyFileMagic[8] = {'F', 'N', 'K', 'V', 'K', 'E', 'Y', '1'};
+constexpr size_t kStoreIdLen = 16;
+constexpr size_t kHashKeysLen = 32;
+constexpr size_t kSecretLen = kAesGcmKeyLen + kHashKeysLen;
+
+// MANIFEST, text: a version line, then the next segment id, the segment
+// being appended to and the sealed segments.
+constexpr char kManifestVersion[] = "flutter_native_utils kv-store 1";
+
+// A record: body length (u32 LE) | nonce | AES-GCM(data key, nonce,
+// store id, plaintext) | tag, where plaintext is type (1 put, 0 delete) |
+// sequence (u64 LE) | records after it in its batch (u32 LE) | key length
+// (u32 LE) | key | value.
+constexpr size_t kRecordLenLen = 4;
+constexpr size_t kPlainHeaderLen = 1 + 8 + 4 + 4;
+constexpr size_t kRecordOverhead =
+    kRecordLenLen + kAesGcmNonceLen + kPlainHeaderLen + kAesGcmTagLen;
+constexpr size_t kMaxRecordLen = kRecordOverhead +
+                                 EncryptedKvStore::kMaxKeyLen +
+                                 EncryptedKvStore::kMaxValueLen;
+
+// INDEX: this header, then |capacity| slots. Native byte order; a foreign
+// index is rebuilt.
+struct IndexHeader {
+  char magic[8];
+  uint8_t store_id[kStoreIdLen];
+  uint64_t capacity;  // A power of two.
+  uint64_t count;     // Keys.
+  uint64_t deleted;   // Slots freed by deletions, still ending no probe.
+  uint64_t next_sequence;
+  uint32_t clean;     // Whether the index matches the segments.
+  uint32_t reserved;
+};
+static_assert(sizeof(IndexHeader) == 64, "IndexHeader is one cache line");
+
+constexpr char kIndexMagic[8] = {'F', 'N', 'K', 'V', 'I', 'D', 'X', '1'};
+constexpr uint64_t kMinIndexCapacity = 1024;
+
+// A slot: the key's tag and where its latest record is. Segment ids start
+// at 1, so a zeroed slot is empty.
+struct IndexSlot {
+  uint64_t high;
+  uint64_t low;
+  uint64_t offset;
+  uint32_t segment;
+  uint32_t length;
+};
+static_assert(sizeof(IndexSlot) == 32, "IndexSlot is half a cache line");
+
+constexpr uint32_t kEmptySlot = 0;
+constexpr uint32_t kDeletedSlot = 0xffffffff;
+
+// Batches appended with one write and sync are capped at about this many
+// bytes, so a writer that arrives during a huge batch is not held behind
+// the next one too.
+constexpr size_t kMaxCommitBytes = 4 << 20;
+
+std::string SegmentName(uint32_t id) { return std::to_string(id) + ".seg"; }
+
+uint64_t IndexCapacityFor(uint64_t keys) {
+  uint64_t capacity = kMinIndexCapacity;
+  // At most half full, so it grows only after a good while.
+  while (capacity < keys * 2) capacity *= 2;
+  return capacity;
+}
+
+// A store being destroyed holds its directory until its index is flushed;
+// Open waits this long for it before taking the directory for open.
+constexpr auto kDirectoryReleaseWait = std::chrono::seconds(1);
+
+// The directories stores in this process have open, by canonical path.
+class OpenDirectories {
+ public:
+  static OpenDirectories& Get() {
+    // Leaked, so a store destroyed during exit can still release.
+    static OpenDirectories* const directories = new OpenDirectories();
+    return *directories;
+  }
+
+  // Claims |path|; false if another store still has it.
+  bool Claim(const std::string& path) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!released_.wait_for(lock, kDirectoryReleaseWait, [this, &path]() {
+          return paths_.count(path) == 0;
+        })) {
+      return false;
+    }
+    paths_.insert(path);
+    return true;
+  }
+
+  void Release(const std::string& path) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      paths_.erase(path);
+    }
+    released_.notify_all();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable released_;
+  std::set<std::string> paths_;
+};
+
+}  // namespace
+
+// Declared ahead of the files it guards, so it is released after them.
+class EncryptedKvStore::DirectoryClaim {
+ public:
+  explicit DirectoryClaim(std::string path) : path_(std::move(path)) {
+    if (!OpenDirectories::Get().Claim(path_)) {
+      throw std::runtime_error(path_ + " is already open");
+    }
+  }
+  ~DirectoryClaim() { OpenDirectories::Get().Release(path_); }
+
+  // Disallow copy and assign.
+  DirectoryClaim(const DirectoryClaim&) = delete;
+  DirectoryClaim& operator=(const DirectoryClaim&) = delete;
+
+ private:
+  const std::string path_;
+};
+
+// ---------- Index ----------
+
+struct EncryptedKvStore::Segment {
+  uint32_t id = 0;
+  StoreFile file;
+  // Bytes appended; the writer changes it with |state_mutex_| held
+  // exclusively.
+  uint64_t size = 0;
+  // Bytes of records the index points to.
+  uint64_t live = 0;
+};
+
+// The hash table of tags to record locations, in a mapped file, with
+// linear probing. Not thread-safe; the store locks around it.
+class EncryptedKvStore::Index {
+ public:
+  // The index at |path| if the store |store_id| closed it cleanly, or null.
+  static std::unique_ptr<Index> OpenClean(const std::string& path,
+                                          const uint8_t* store_id);
+
+  // A new, empty index at |path|, replacing any there, marked not clean.
+  static std::unique_ptr<Index> Create(const std::string& path,
+                                       const uint8_t* store_id,
+                                       uint64_t capacity);
+
+  uint64_t count() const { return header_->count; }
+  uint64_t next_sequence() const { return header_->next_sequence; }
+
+  bool Find(const Tag& tag, Location* location) const;
+  // Makes room for |added| more keys, so that many Set calls cannot fail.
+  // Throws std::runtime_error if the index cannot grow; it is unchanged
+  // then.
+  void Reserve(uint64_t added);
+  // Points |tag| at |location|. Returns true, setting |*previous|, if it
+  // already pointed somewhere. Throws as Reserve does.
+  bool Set(const Tag& tag, const Location& location, Location* previous);
+  // Returns true, setting |*previous|, if |tag| was there.
+  bool Remove(const Tag& tag, Location* previous);
+  // Points |tag| at |to| if it still points at |from|.
+  bool Relocate(const Tag& tag, const Location& from, const Location& to);
+
+  void ForEach(const std::function<void(const Tag&, const Location&)>& visit)
+      const;
+
+  // Flushes the index marked as not matching the segments, as it stops
+  // doing with the next write.
+  bool MarkDirty();
+  // Flushes the index marked as matching them, with the sequence the next
+  // write would get.
+  bool MarkClean(uint64_t next_sequence);
+
+ private:
+  bool Map(uint64_t capacity);
+  // The slot |tag| is in, or the empty slot that ends its probe. Sets
+  // |*reusable| to the first slot freed by a deletion on the way, if any.
+  size_t Probe(const Tag& tag, size_t* reusable) const;
+  // Rehashes into a new file sized for |keys|, dropping deletion marks, and
+  // swaps it in once it is complete.
+  void Grow(uint64_t keys);
+
+  std::string path_;
+  std::unique_ptr<StoreFile> file_ = std::make_unique<StoreFile>();
+  IndexHeader* header_ = nullptr;
+  IndexSlot* slots_ = nullptr;
+};
+
+std::unique_ptr<EncryptedKvStore::Index> EncryptedKvStore::Index::OpenClean(
+    const std::string& path, const uint8_t* store_id) {
+  auto index = std::unique_ptr<Index>(new Index());
+  index->path_ = path;
+  if (!index->file_->Open(path, false)) return nullptr;
+  const uint64_t size = index->file_->Size();
+  IndexHeader header;
+  if (size < sizeof(header) ||
+      !index->file_->ReadAt(0, reinterpret_cast<uint8_t*>(&header),
+                           sizeof(header)) ||
+      std::memcmp(header.magic, kIndexMagic, sizeof(kIndexMagic)) != 0 ||
+      std::memcmp(header.store_id, store_id, kStoreIdLen) != 0 ||
+      header.clean != 1 || header.capacity < kMinIndexCapacity ||
+      (header.capacity & (header.capacity - 1)) != 0 ||
+      header.count + header.deleted >= header.capacity ||
+      size != sizeof(header) + header.capacity * sizeof(IndexSlot) ||
+      !index->Map(header.capacity)) {
+    return nullptr;
+  }
+  return index;
+}
+
+std::unique_ptr<EncryptedKvStore::Index> EncryptedKvStore::Index::Create(
+    const std::string& path, const uint8_t* store_id, uint64_t capacity) {
+  auto index = std::unique_ptr<Index>(new Index());
+  index->path_ = path;
+  // Zero-filled, so every slot starts empty.
+  if (!index->file_->Open(path, true) || !index->file_->Resize(0) ||
+      !index->file_->Resize(sizeof(IndexHeader) +
+                           capacity * sizeof(IndexSlot)) ||
+      !index->Map(capacity)) {
+    throw std::runtime_error("Cannot create index " + path);
+  }
+  std::memcpy(index->header_->magic, kIndexMagic, sizeof(kIndexMagic));
+  std::memcpy(index->header_->store_id, store_id, kStoreIdLen);
+  index->header_->capacity = capacity;
+  return index;
+}
+
+bool EncryptedKvStore::Index::Map(uint64_t capacity) {
+  uint8_t* view = file_->Map(
+      static_cast<size_t>(sizeof(IndexHeader) + capacity * sizeof(IndexSlot)));
+  if (!view) return false;
+  header_ = reinterpret_cast<IndexHeader*>(view);
+  slots_ = reinterpret_cast<IndexSlot*>(view + sizeof(IndexHeader));
+  return true;
+}
+
+size_t EncryptedKvStore::Index::Probe(const Tag& tag, size_t* reusable) const {
+  const uint64_t mask = header_->capacity - 1;
+  *reusable = SIZE_MAX;
+  for (uint64_t i = tag.high & mask;; i = (i + 1) & mask) {
+    const IndexSlot& slot = slots_[i];
+    if (slot.segment == kEmptySlot) return static_cast<size_t>(i);
+    if (slot.segment == kDeletedSlot) {
+      if (*reusable == SIZE_MAX) *reusable = static_cast<size_t>(i);
+    } else if (slot.high == tag.high && slot.low == tag.low) {
+      return static_cast<size_t>(i);
+    }
+  }
+}
+
+bool EncryptedKvStore::Index::Find(const Tag& tag, Location* location) const {
+  size_t reusable;
+  const IndexSlot& slot = slots_[Probe(tag, &reusable)];
+  if (slot.segment == kEmptySlot) return false;
+  *location = Location{slot.segment, slot.length, slot.offset};
+  return true;
+}
+
+void EncryptedKvStore::Index::Reserve(uint64_t added) {
+  // Kept at most three quarters full, counting deletion marks, so probes
+  // stay short and always end.
+  if ((header_->count + header_->deleted + added) * 4 <=
+      header_->capacity * 3) {
+    return;
+  }
+  Grow(header_->count + added);
+}
+
+bool EncryptedKvStore::Index::Set(const Tag& tag, const Location& location,
+                                  Location* previous) {
+  size_t reusable;
+  size_t i = Probe(tag, &reusable);
+  IndexSlot* slot = &slots_[i];
+  if (slot->segment != kEmptySlot) {
+    *previous = Location{slot->segment, slot->length, slot->offset};
+    slot->segment = location.segment;
+    slot->length = location.length;
+    slot->offset = location.offset;
+    return true;
+  }
+  if (reusable != SIZE_MAX) {
+    slot = &slots_[reusable];
+    --header_->deleted;
+  } else if ((header_->count + header_->deleted + 1) * 4 >
+             header_->capacity * 3) {
+    Reserve(1);
+    slot = &slots_[Probe(tag, &reusable)];
+  }
+  *slot = IndexSlot{tag.high, tag.low, location.offset, location.segment,
+                    location.length};
+  ++header_->count;
+  return false;
+}
+
+bool EncryptedKvStore::Index::Remove(const Tag& tag, Location* previous) {
+  size_t reusable;
+  IndexSlot& slot = slots_[Probe(tag, &reusable)];
+  if (slot.segment == kEmptySlot) return false;
+  *previous = Location{slot.segment, slot.length, slot.offset};
+  // Later keys may have probed past this slot, so it cannot become empty.
+  slot.segment = kDeletedSlot;
+  --header_->count;
+  ++header_->deleted;
+  return true;
+}
+
+bool EncryptedKvStore::Index::Relocate(const Tag& tag, const Location& from,
+                                       const Location& to) {
+  size_t reusable;
+  IndexSlot& slot = slots_[Probe(tag, &reusable)];
+  if (slot.segment != from.segment || slot.offset != from.offset) {
+    return false;
+  }
+  slot.segment = to.segment;
+  slot.length = to.length;
+  slot.offset = to.offset;
+  return true;
+}
+
+void EncryptedKvStore::Index::ForEach(
+    const std::function<void(const Tag&, const Location&)>& visit) const {
+  for (uint64_t i = 0; i < header_->capacity; ++i) {
+    const IndexSlot& slot = slots_[i];
+    if (slot.segment == kEmptySlot || slot.segment == kDeletedSlot) continue;
+    visit(Tag{slot.high, slot.low},
+          Location{slot.segment, slot.length, slot.offset});
+  }
+}
+
+void EncryptedKvStore::Index::Grow(uint64_t keys) {
+  // Built beside the index in use, which stays whole if this fails. Both
+  // are marked dirty, so a crash part way through is rebuilt.
+  std::unique_ptr<Index> grown =
+      Create(path_ + ".tmp", header_->store_id, IndexCapacityFor(keys));
+  const uint64_t mask = grown->header_->capacity - 1;
+  for (uint64_t i = 0; i < header_->capacity; ++i) {
+    const IndexSlot& slot = slots_[i];
+    if (slot.segment == kEmptySlot || slot.segment == kDeletedSlot) continue;
+    uint64_t j = slot.high & mask;
+    while (grown->slots_[j].segment != kEmptySlot) j = (j + 1) & mask;
+    grown->slots_[j] = slot;
+  }
+  grown->header_->count = header_->count;
+  grown->header_->next_sequence = header_->next_sequence;
+
+  // Closed first: Windows cannot replace a file that is open or mapped.
+  file_.reset();
+  std::error_code error;
+  fs::rename(fs::u8path(grown->path_), fs::u8path(path_), error);
+  // If the rename failed the grown index serves from where it is; the one
+  // left at |path_| is dirty, so the next open rebuilds it.
+  if (!error) grown->path_ = path_;
+  path_ = std::move(grown->path_);
+  file_ = std::move(grown->file_);
+  header_ = grown->header_;
+  slots_ = grown->slots_;
+}
+
+bool EncryptedKvStore::Index::MarkDirty() {
+  header_->clean = 0;
+  return file_->FlushMapping();
+}
+
+bool EncryptedKvStore::Index::MarkClean(uint64_t next_sequence) {
+  header_->next_sequence = next_sequence;
+  // The slots first, so the mark never precedes them on disk.
+  if (!file_->FlushMapping()) return false;
+  header_->clean = 1;
+  return file_->FlushMapping();
+}
+
+// ---------- Opening ----------
+
+struct EncryptedKvStore::Pending {
+  const std::vector<KvWrite>* batch = nullptr;
+  std::vector<Tag> tags;
+  std::vector<uint8_t> records;
+  std::vector<uint32_t> lengths;
+  uint64_t first_sequence = 0;
+  bool sealed = false;  // |records| are ready; set under |queue_mutex_|.
+  bool done = false;
+  std::string error;
+  std::condition_variable ready;
+};
+
+EncryptedKvStore::EncryptedKvStore(std::string directory, std::string key_name,
+                                   WorkerPool* pool,
+                                   const KvStoreOptions& options)
+    : directory_(std::move(directory)),
+      key_name_(std::move(key_name)),
+      pool_(pool),
+      options_(options) {}
+
+std::shared_ptr<EncryptedKvStore> EncryptedKvStore::Open(
+    const std::string& directory, const std::string& key_name, KeyIndex* keys,
+    WorkerPool* pool, const KvStoreOptions& options) {
+  if (directory.empty()) throw std::invalid_argument("Empty store directory");
+  if (key_name.empty()) throw std::invalid_argument("Empty key name");
+  if (options.segment_bytes < 4096) {
+    throw std::invalid_argument("segment_bytes must be at least 4096");
+  }
+  if (!(options.compaction_ratio > 0 && options.compaction_ratio <= 1)) {
+    throw std::invalid_argument("compaction_ratio must be in (0, 1]");
+  }
+  std::error_code error;
+  const fs::path path = fs::weakly_canonical(fs::u8path(directory), error);
+  if (error) throw std::runtime_error("Cannot resolve " + directory);
+  std::shared_ptr<EncryptedKvStore> store(
+      new EncryptedKvStore(path.u8string(), key_name, pool, options));
+  store->claim_ = std::make_unique<DirectoryClaim>(store->directory_);
+  store->OpenOrCreate(keys);
+  return store;
+}
+
+EncryptedKvStore::~EncryptedKvStore() {
+  // Not opened, or the log may be missing writes the index has.
+  if (!index_ || failed_) return;
+  auto active = segments_.find(active_segment_);
+  // With sync on, every commit already was.
+  if (!options_.sync && active != segments_.end() &&
+      !active->second->file.Sync()) {
+    return;
+  }
+  index_->MarkClean(next_sequence_);
+}
+
+void EncryptedKvStore::OpenOrCreate(KeyIndex* keys) {
+  std::error_code error;
+  fs::create_directories(fs::u8path(directory_), error);
+  if (error) throw std::runtime_error("Cannot create " + directory_);
+
+  const bool exists = fs::exists(fs::u8path(directory_ + "/KEY"), error);
+  if (exists) {
+    ReadKeyFile(keys);
+    LoadManifest();
+  } else {
+    if (fs::exists(fs::u8path(directory_ + "/MANIFEST"), error)) {
+      throw std::runtime_error(directory_ + " has lost its KEY file");
+    }
+    CreateKeyFile(keys);
+    auto segment = std::make_shared<Segment>();
+    segment->id = next_segment_++;
+    if (!segment->file.Open(directory_ + "/" + SegmentName(segment->id),
+                            true) ||
+        !segment->file.Resize(0)) {
+      throw std::runtime_error("Cannot create a segment in " + directory_);
+    }
+    segments_[segment->id] = segment;
+    active_segment_ = segment->id;
+    std::lock_guard<std::mutex> lock(manifest_mutex_);
+    WriteManifest(active_segment_, {});
+  }
+
+  index_ = Index::OpenClean(directory_ + "/INDEX", store_id_);
+  if (index_) {
+    next_sequence_ = index_->next_sequence();
+    if (!ComputeLiveBytes()) index_.reset();
+  }
+  if (!index_) RebuildIndex();
+  // From the first write on, the index runs ahead of what is on disk.
+  if (!index_->MarkDirty()) {
+    index_.reset();
+    throw std::runtime_error("Cannot write the index");
+  }
+}
+
+void EncryptedKvStore::CreateKeyFile(KeyIndex* keys) {
+  SecureBytes secret(kSecretLen);
+  FillRandom(secret.data(), secret.size());
+  FillRandom(store_id_, sizeof(store_id_));
+  keys->CreateOrOpen(key_name_);
+  std::vector<uint8_t> wrapped =
+      keys->Wrap(key_name_, secret.data(), secret.size());
+
+  std::vector<uint8_t> file(kKeyFileMagic, kKeyFileMagic + 8);
+  file.insert(file.end(), store_id_, store_id_ + kStoreIdLen);
+  uint8_t len[4];
+  AppendLe32(static_cast<uint32_t>(key_name_.size()), len);
+  file.insert(file.end(), len, len + 4);
+  file.insert(file.end(), key_name_.begin(), key_name_.end());
+  AppendLe32(static_cast<uint32_t>(wrapped.size()), len);
+  file.insert(file.end(), len, len + 4);
+  file.insert(file.end(), wrapped.begin(), wrapped.end());
+  WriteFileAtomically(directory_, "KEY", file);
+
+  AesGcmKey data_key;
+  std::memcpy(data_key.data(), secret.data(), kAesGcmKeyLen);
+  cipher_ = std::make_unique<AesGcmCipher>(data_key);
+  SecureZero(data_key.data(), data_key.size());
+  hash_keys_.assign(secret.begin() + kAesGcmKeyLen, secret.end());
+}
+
+void EncryptedKvStore::ReadKeyFile(KeyIndex* keys) {
+  StoreFile file;
+  if (!file.Open(directory_ + "/KEY", false)) {
+    throw std::runtime_error("Cannot open " + directory_ + "/KEY");
+  }
+  const std::vector<uint8_t> data = ReadWholeFile(file, file.Size());
+  size_t offset = 8 + kStoreIdLen;
+  auto read_field = [&data, &offset](std::string* field) {
+    if (offset + 4 > data.size()) return false;
+    const uint32_t len = ReadLe32(&data[offset]);
+    offset += 4;
+    if (len > data.size() - offset) return false;
+    field->assign(data.begin() + offset, data.begin() + offset + len);
+    offset += len;
+    return true;
+  };
+  std::string name, wrapped;
+  if (data.size() < offset ||
+      std::memcmp(data.data(), kKeyFileMagic, 8) != 0 || !read_field(&name) ||
+      !read_field(&wrapped) || offset != data.size()) {
+    throw std::runtime_error(directory_ + " is not an encrypted store");
+  }
+  if (name != key_name_) {
+    throw std::runtime_error(directory_ + " is protected by key " + name);
+  }
+  std::memcpy(store_id_, data.data() + 8, kStoreIdLen);
+
+  SecureBytes secret(kSecretLen);
+  if (!keys->Unwrap(key_name_,
+                    reinterpret_cast<const uint8_t*>(wrapped.data()),
+                    wrapped.size(), secret.data(), secret.size())) {
+    throw std::runtime_error("The store key cannot be unwrapped by " +
+                             key_name_);
+  }
+  AesGcmKey data_key;
+  std::memcpy(data_key.data(), secret.data(), kAesGcmKeyLen);
+  cipher_ = std::make_unique<AesGcmCipher>(data_key);
+  SecureZero(data_key.data(), data_key.size());
+  hash_keys_.assign(secret.begin() + kAesGcmKeyLen, secret.end());
+}
+
+void EncryptedKvStore::LoadManifest() {
+  StoreFile file;
+  if (!file.Open(directory_ + "/MANIFEST", false)) {
+    throw std::runtime_error("Cannot open " + directory_ + "/MANIFEST");
+  }
+  const std::vector<uint8_t> data = ReadWholeFile(file, file.Size());
+  std::istringstream in(std::string(data.begin(), data.end()));
+  std::string version, field;
+  std::getline(in, version);
+  std::set<uint32_t> ids;
+  uint32_t next = 0, active = 0;
+  bool ok = version == kManifestVersion && (in >> field >> next) &&
+            field == "next" && (in >> field >> active) && field == "active" &&
+            (in >> field) && field == "sealed";
+  for (uint32_t id; ok && in >> id;) ids.insert(id);
+  ids.insert(active);
+  if (!ok || !in.eof() || active == 0 || ids.count(0) ||
+      *ids.rbegin() >= next) {
+    throw std::runtime_error(directory_ + "/MANIFEST is corrupt");
+  }
+  next_segment_ = next;
+  active_segment_ = active;
+
+  for (uint32_t id : ids) {
+    auto segment = std::make_shared<Segment>();
+    segment->id = id;
+    if (!segment->file.Open(directory_ + "/" + SegmentName(id), false)) {
+      throw std::runtime_error("Missing segment " + SegmentName(id));
+    }
+    segment->size = segment->file.Size();
+    segments_[id] = segment;
+  }
+
+  // Left by a compaction cut short, or by a write of the manifest.
+  std::error_code error;
+  for (fs::directory_iterator it(fs::u8path(directory_), error), end;
+       !error && it != end; it.increment(error)) {
+    const fs::path& path = it->path();
+    const std::string stem = path.stem().u8string();
+    if (path.extension() == ".tmp" ||
+        (path.extension() == ".seg" && !stem.empty() && stem.size() <= 9 &&
+         stem.find_first_not_of("0123456789") == std::string::npos &&
+         ids.count(static_cast<uint32_t>(std::stoul(stem))) == 0)) {
+      std::error_code ignored;
+      fs::remove(path, ignored);
+    }
+  }
+}
+
+void EncryptedKvStore::WriteManifest(uint32_t active,
+                                     const std::vector<uint32_t>& sealed) {
+  std::ostringstream out;
+  out << kManifestVersion << "\nnext " << next_segment_ << "\nactive "
+      << active << "\nsealed";
+  for (uint32_t id : sealed) out << ' ' << id;
+  out << '\n';
+  const std::string text = out.str();
+  WriteFileAtomically(directory_, "MANIFEST",
+                      std::vector<uint8_t>(text.begin(), text.end()));
+}
+
+bool EncryptedKvStore::ComputeLiveBytes() {
+  bool valid = true;
+  index_->ForEach([this, &valid](const Tag&, const Location& location) {
+    auto it = segments_.find(location.segment);
+    if (it == segments_.end() ||
+        location.offset + location.length > it->second->size) {
+      valid = false;
+      return;
+    }
+    it->second->live += location.length;
+  });
+  if (!valid) {
+    for (auto& entry : segments_) entry.second->live = 0;
+  }
+  return valid;
+}
+
+void EncryptedKvStore::RebuildIndex() {
+  struct Latest {
+    uint64_t sequence;
+    bool put;
+    Location location;
+  };
+  struct TagHash {
+    size_t operator()(const Tag& tag) const {
+      return static_cast<size_t>(tag.high);
+    }
+  };
+  struct TagEqual {
+    bool operator()(const Tag& a, const Tag& b) const {
+      return a.high == b.high && a.low == b.low;
+    }
+  };
+  std::unordered_map<Tag, Latest, TagHash, TagEqual> latest;
+  uint64_t max_sequence = 0;
+
+  for (auto& entry : segments_) {
+    Segment& segment = *entry.second;
+    const std::vector<uint8_t> data = ReadWholeFile(segment.file, segment.size);
+    // Records of the batch being read, applied once it is complete.
+    std::vector<std::pair<Tag, Latest>> batch;
+    uint64_t complete = 0;
+    Record record;
+    for (uint64_t offset = 0; offset + kRecordLenLen <= data.size();) {
+      const uint64_t len = kRecordLenLen + ReadLe32(&data[offset]);
+      if (len > data.size() - offset || len > kMaxRecordLen ||
+          !OpenRecord(&data[offset], static_cast<size_t>(len), &record)) {
+        break;
+      }
+      batch.emplace_back(
+          TagOf(record.key),
+          Latest{record.sequence, record.put,
+                 Location{segment.id, static_cast<uint32_t>(len), offset}});
+      offset += len;
+      if (record.remaining != 0) continue;
+      for (auto& applied : batch) {
+        max_sequence = std::max(max_sequence, applied.second.sequence);
+        auto it = latest.find(applied.first);
+        if (it == latest.end()) {
+          latest.emplace(applied.first, applied.second);
+        } else if (it->second.sequence < applied.second.sequence) {
+          it->second = applied.second;
+        }
+      }
+      batch.clear();
+      complete = offset;
+    }
+    // Only the segment being appended to can end in a torn batch; cut it
+    // off so appends continue from a whole one. In sealed segments it is
+    // just garbage.
+    if (segment.id == active_segment_ && complete < segment.size) {
+      if (!segment.file.Resize(complete)) {
+        throw std::runtime_error("Cannot repair " + SegmentName(segment.id));
+      }
+      segment.size = complete;
+    }
+  }
+
+  size_t puts = 0;
+  for (const auto& entry : latest) puts += entry.second.put;
+  std::unique_ptr<Index> index = Index::Create(
+      directory_ + "/INDEX", store_id_, IndexCapacityFor(puts));
+  Location previous;
+  for (const auto& entry : latest) {
+    if (!entry.second.put) continue;
+    index->Set(entry.first, entry.second.location, &previous);
+    segments_[entry.second.location.segment]->live +=
+        entry.second.location.length;
+  }
+  index_ = std::move(index);
+  next_sequence_ = max_sequence + 1;
+}
+
+// ---------- Records ----------
+
+EncryptedKvStore::Tag EncryptedKvStore::TagOf(const std::string& key) const {
+  uint64_t keys[4];
+  for (int i = 0; i < 4; ++i) keys[i] = ReadLe64(&hash_keys_[8 * i]);
+  const auto* data = reinterpret_cast<const uint8_t*>(key.data());
+  return Tag{SipHash24(keys, data, key.size()),
+             SipHash24(keys + 2, data, key.size())};
+}
+
+void EncryptedKvStore::SealRecord(const KvWrite& write, uint64_t sequence,
+                                  uint32_t remaining,
+                                  std::vector<uint8_t>* out) const {
+  const size_t value_len = write.value ? write.value->size() : 0;
+  std::vector<uint8_t> plain(kPlainHeaderLen + write.key.size() + value_len);
+  plain[0] = write.value ? 1 : 0;
+  AppendLe64(sequence, &plain[1]);
+  AppendLe32(remaining, &plain[9]);
+  AppendLe32(static_cast<uint32_t>(write.key.size()), &plain[13]);
+  std::memcpy(&plain[kPlainHeaderLen], write.key.data(), write.key.size());
+  if (value_len) {
+    std::memcpy(&plain[kPlainHeaderLen + write.key.size()],
+                write.value->data(), value_len);
+  }
+
+  const size_t offset = out->size();
+  const size_t body_len = kAesGcmNonceLen + plain.size() + kAesGcmTagLen;
+  out->resize(offset + kRecordLenLen + body_len);
+  uint8_t* record = out->data() + offset;
+  AppendLe32(static_cast<uint32_t>(body_len), record);
+  uint8_t* nonce = record + kRecordLenLen;
+  // Random nonces are safe for the 2^32 records one key may seal.
+  FillRandomBuffered(nonce, kAesGcmNonceLen);
+  cipher_->Seal(nonce, store_id_, kStoreIdLen, plain.data(), plain.size(),
+                nonce + kAesGcmNonceLen);
+  SecureZero(plain.data(), plain.size());
+}
+
+bool EncryptedKvStore::OpenRecord(const uint8_t* data, size_t len,
+                                  Record* record) const {
+  if (len < kRecordOverhead || ReadLe32(data) != len - kRecordLenLen) {
+    return false;
+  }
+  const uint8_t* nonce = data + kRecordLenLen;
+  std::vector<uint8_t> plain(len - kRecordLenLen - kAesGcmNonceLen -
+                             kAesGcmTagLen);
+  if (!cipher_->Open(nonce, store_id_, kStoreIdLen, nonce + kAesGcmNonceLen,
+                     plain.size() + kAesGcmTagLen, plain.data())) {
+    return false;
+  }
+  const uint32_t key_len = ReadLe32(&plain[13]);
+  if (plain[0] > 1 || key_len > plain.size() - kPlainHeaderLen) return false;
+  record->put = plain[0] == 1;
+  record->sequence = ReadLe64(&plain[1]);
+  record->remaining = ReadLe32(&plain[9]);
+  const auto key = plain.begin() + kPlainHeaderLen;
+  record->key.assign(key, key + key_len);
+  record->value.assign(key + key_len, plain.end());
+  SecureZero(plain.data(), plain.size());
+  return true;
+}
+
+std::vector<uint8_t> EncryptedKvStore::ReadRecord(
+    const Segment& segment, const Location& location) const {
+  std::vector<uint8_t> data(location.length);
+  if (!segment.file.ReadAt(location.offset, data.data(), data.size())) {
+    throw std::runtime_error("Cannot read " + SegmentName(segment.id));
+  }
+  return data;
+}
+
+// ---------- Reads ----------
+
+std::optional<std::vector<uint8_t>> EncryptedKvStore::Get(
+    const std::string& key) {
+  const Tag tag = TagOf(key);
+  std::shared_ptr<Segment> segment;
+  Location location;
+  {
+    std::shared_lock<std::shared_mutex> lock(state_mutex_);
+    if (!index_->Find(tag, &location)) return std::nullopt;
+    segment = segments_.at(location.segment);
+  }
+  // Read unlocked: a compaction that retires the segment meanwhile deletes
+  // the file, but the handle held here keeps it readable.
+  const std::vector<uint8_t> data = ReadRecord(*segment, location);
+  Record record;
+  if (!OpenRecord(data.data(), data.size(), &record) || !record.put ||
+      record.key != key) {
+    throw std::runtime_error("Corrupt record in " + SegmentName(segment->id));
+  }
+  return std::move(record.value);
+}
+
+KvScanPage EncryptedKvStore::Scan(const std::string& prefix,
+                                  const std::string& after, size_t page_size) {
+  if (page_size == 0 || page_size > kMaxPageSize) {
+    throw std::invalid_argument("pageSize must be between 1 and 1000");
+  }
+  std::vector<std::pair<Location, std::shared_ptr<Segment>>> records;
+  {
+    std::shared_lock<std::shared_mutex> lock(state_mutex_);
+    records.reserve(static_cast<size_t>(index_->count()));
+    index_->ForEach([this, &records](const Tag&, const Location& location) {
+      records.emplace_back(location, segments_.at(location.segment));
+    });
+  }
+  // In file order, so each segment is read front to back.
+  std::sort(records.begin(), records.end(), [](const auto& a, const auto& b) {
+    return a.first.segment != b.first.segment
+               ? a.first.segment < b.first.segment
+               : a.first.offset < b.first.offset;
+  });
+
+  // The first page_size + 1 matches in key order; the extra one tells
+  // whether there are more.
+  std::map<std::string, std::vector<uint8_t>> matches;
+  Record record;
+  for (const auto& entry : records) {
+    const std::vector<uint8_t> data = ReadRecord(*entry.second, entry.first);
+    if (!OpenRecord(data.data(), data.size(), &record)) {
+      throw std::runtime_error("Corrupt record in " +
+                               SegmentName(entry.second->id));
+    }
+    if (record.key.compare(0, prefix.size(), prefix) != 0 ||
+        record.key <= after) {
+      continue;
+    }
+    if (matches.size() > page_size) {
+      if (record.key >= matches.rbegin()->first) continue;
+      matches.erase(std::prev(matches.end()));
+    }
+    matches.emplace(std::move(record.key), std::move(record.value));
+  }
+
+  KvScanPage page;
+  page.done = matches.size() <= page_size;
+  for (auto& match : matches) {
+    if (page.entries.size() == page_size) break;
+    page.entries.push_back(KvEntry{match.first, std::move(match.second)});
+  }
+  if (!page.entries.empty()) page.last = page.entries.back().key;
+  return page;
+}
+
+KvStoreStats EncryptedKvStore::stats() const {
+  KvStoreStats stats;
+  std::shared_lock<std::shared_mutex> lock(state_mutex_);
+  stats.keys = static_cast<size_t>(index_->count());
+  stats.segments = segments_.size();
+  for (const auto& entry : segments_) {
+    stats.disk_bytes += entry.second->size;
+    stats.live_bytes += entry.second->live;
+  }
+  stats.batches = batches_.load(std::memory_order_relaxed);
+  stats.commits = commits_.load(std::memory_order_relaxed);
+  stats.compactions = compactions_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+// ---------- Writes ----------
+
+void EncryptedKvStore::Put(const std::string& key, std::vector<uint8_t> value) {
+  std::vector<KvWrite> batch(1);
+  batch[0].key = key;
+  batch[0].value = std::move(value);
+  Write(std::move(batch));
+}
+
+void EncryptedKvStore::Delete(const std::string& key) {
+  std::vector<KvWrite> batch(1);
+  batch[0].key = key;
+  Write(std::move(batch));
+}
+
+void EncryptedKvStore::Write(std::vector<KvWrite> batch) {
+  for (const KvWrite& write : batch) {
+    if (write.key.empty() || write.key.size() > kMaxKeyLen) {
+      throw std::invalid_argument("Keys must be 1 to 4096 bytes long");
+    }
+    if (write.value && write.value->size() > kMaxValueLen) {
+      throw std::invalid_argument("Values must be at most 64 MiB");
+    }
+  }
+  if (batch.empty()) return;
+  batches_.fetch_add(1, std::memory_order_relaxed);
+
+  Pending pending;
+  pending.batch = &batch;
+  pending.tags.reserve(batch.size());
+  for (const KvWrite& write : batch) pending.tags.push_back(TagOf(write.key));
+  {
+    // Sequences follow queue order, which is commit order.
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (failed_) throw std::runtime_error("The store failed an earlier write");
+    pending.first_sequence = next_sequence_;
+    next_sequence_ += batch.size();
+    queue_.push_back(&pending);
+  }
+
+  // Sealed unlocked, in parallel with other writers and the commit ahead.
+  std::exception_ptr seal_error;
+  try {
+    for (size_t i = 0; i < batch.size(); ++i) {
+      const size_t before = pending.records.size();
+      SealRecord(batch[i], pending.first_sequence + i,
+                 static_cast<uint32_t>(batch.size() - 1 - i),
+                 &pending.records);
+      pending.lengths.push_back(
+          static_cast<uint32_t>(pending.records.size() - before));
+    }
+  } catch (...) {
+    // Still queued: it commits as nothing, leaving its sequences unused.
+    seal_error = std::current_exception();
+    pending.records.clear();
+    pending.lengths.clear();
+  }
+
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  pending.sealed = true;
+  while (!pending.done && queue_.front() != &pending) pending.ready.wait(lock);
+  if (!pending.done) Commit(&lock);
+  lock.unlock();
+
+  if (seal_error) std::rethrow_exception(seal_error);
+  if (!pending.error.empty()) throw std::runtime_error(pending.error);
+  MaybeCompact();
+}
+
+void EncryptedKvStore::Commit(std::unique_lock<std::mutex>* queue_lock) {
+  // This writer and the sealed ones behind it, up to one still sealing.
+  std::vector<Pending*> group;
+  size_t bytes = 0;
+  for (Pending* pending : queue_) {
+    if (!pending->sealed ||
+        (!group.empty() && bytes + pending->records.size() > kMaxCommitBytes)) {
+      break;
+    }
+    group.push_back(pending);
+    bytes += pending->records.size();
+  }
+  const bool failed = failed_;
+  queue_lock->unlock();
+
+  std::string error;
+  if (failed) {
+    error = "The store failed an earlier write";
+  } else {
+    try {
+      AppendGroup(group, bytes);
+    } catch (const std::exception& ex) {
+      error = ex.what();
+    }
+  }
+
+  queue_lock->lock();
+  if (!error.empty()) failed_ = true;
+  for (Pending* pending : group) {
+    pending->error = error;
+    pending->done = true;
+    queue_.pop_front();
+    pending->ready.notify_one();
+  }
+  if (!queue_.empty()) queue_.front()->ready.notify_one();
+}
+
+void EncryptedKvStore::AppendGroup(const std::vector<Pending*>& group,
+                                   size_t bytes) {
+  std::shared_ptr<Segment> active;
+  {
+    // Room for every key first, so a failure to grow the index leaves the
+    // log and the index as they were.
+    uint64_t puts = 0;
+    for (const Pending* pending : group) {
+      for (size_t i = 0; i < pending->lengths.size(); ++i) {
+        puts += (*pending->batch)[i].value.has_value();
+      }
+    }
+    std::unique_lock<std::shared_mutex> lock(state_mutex_);
+    index_->Reserve(puts);
+    active = segments_.at(active_segment_);
+  }
+  if (bytes > 0) {
+    // One write for the whole group; a lone batch is written as it is.
+    std::vector<uint8_t> joined;
+    const std::vector<uint8_t>* records = &group[0]->records;
+    if (group.size() > 1) {
+      joined.reserve(bytes);
+      for (const Pending* pending : group) {
+        joined.insert(joined.end(), pending->records.begin(),
+                      pending->records.end());
+      }
+      records = &joined;
+    }
+    if (!active->file.WriteAt(active->size, records->data(), bytes)) {
+      throw std::runtime_error("Cannot append to " + SegmentName(active->id));
+    }
+    if (options_.sync && !active->file.Sync()) {
+      throw std::runtime_error("Cannot sync " + SegmentName(active->id));
+    }
+    commits_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Sealing the segment changes the manifest, which compaction also does;
+  // both take |manifest_mutex_| before |state_mutex_|.
+  std::unique_lock<std::mutex> manifest_lock(manifest_mutex_,
+                                             std::defer_lock);
+  std::shared_ptr<Segment> next;
+  if (active->size + bytes >= options_.segment_bytes) {
+    manifest_lock.lock();
+    next = std::make_shared<Segment>();
+    next->id = next_segment_++;
+    if (!next->file.Open(directory_ + "/" + SegmentName(next->id), true) ||
+        !next->file.Resize(0)) {
+      throw std::runtime_error("Cannot create " + SegmentName(next->id));
+    }
+    // Segments only change with |manifest_mutex_| held. The new segment is
+    // empty, so a crash before the index catches up loses nothing.
+    std::vector<uint32_t> sealed;
+    for (const auto& entry : segments_) sealed.push_back(entry.first);
+    WriteManifest(next->id, sealed);
+  }
+
+  std::unique_lock<std::shared_mutex> lock(state_mutex_);
+  uint64_t offset = active->size;
+  Location previous;
+  for (const Pending* pending : group) {
+    for (size_t i = 0; i < pending->lengths.size(); ++i) {
+      const Location location{active->id, pending->lengths[i], offset};
+      offset += location.length;
+      const bool put = (*pending->batch)[i].value.has_value();
+      const bool replaced =
+          put ? index_->Set(pending->tags[i], location, &previous)
+              : index_->Remove(pending->tags[i], &previous);
+      if (replaced) segments_.at(previous.segment)->live -= previous.length;
+      if (put) active->live += location.length;
+    }
+  }
+  active->size = offset;
+  if (next) {
+    segments_[next->id] = next;
+    active_segment_ = next->id;
+  }
+}
+
+// ---------- Compaction ----------
+
+void EncryptedKvStore::MaybeCompact() {
+  if (!pool_ || compacting_.load(std::memory_order_relaxed)) return;
+  uint64_t sealed = 0, garbage = 0;
+  {
+    std::shared_lock<std::shared_mutex> lock(state_mutex_);
+    for (const auto& entry : segments_) {
+      if (entry.first == active_segment_) continue;
+      sealed += entry.second->size;
+      garbage += entry.second->size - entry.second->live;
+    }
+  }
+  if (garbage < options_.compaction_min_garbage ||
+      static_cast<double>(garbage) < sealed * options_.compaction_ratio ||
+      compacting_.exchange(true)) {
+    return;
+  }
+  // The task holds the store, so it is never destroyed under a compaction.
+  std::shared_ptr<EncryptedKvStore> self = shared_from_this();
+  pool_->Post(
+      [self]() {
+        try {
+          self->RunCompaction();
+        } catch (const std::exception&) {
+          // The segments stay as they were; a later write tries again.
+        }
+        self->compacting_.store(false);
+      },
+      TaskPriority::kBulk);
+}
+
+bool EncryptedKvStore::Compact() {
+  if (compacting_.exchange(true)) return false;
+  struct Reset {
+    std::atomic<bool>* flag;
+    ~Reset() { flag->store(false); }
+  } reset{&compacting_};
+  RunCompaction();
+  return true;
+}
+
+void EncryptedKvStore::RunCompaction() {
+  // Every sealed segment at once: a delete record can only be dropped with
+  // every older record of its key, and those are all in sealed segments.
+  std::map<uint32_t, std::shared_ptr<Segment>> victims;
+  {
+    std::shared_lock<std::shared_mutex> lock(state_mutex_);
+    for (const auto& entry : segments_) {
+      if (entry.first != active_segment_) victims.insert(entry);
+    }
+  }
+  if (victims.empty()) return;
+
+  struct Move {
+    Tag tag;
+    Location from;
+    Location to;
+  };
+  std::vector<Move> moves;
+  {
+    std::shared_lock<std::shared_mutex> lock(state_mutex_);
+    index_->ForEach([&victims, &moves](const Tag& tag, const Location& from) {
+      if (victims.count(from.segment)) moves.push_back(Move{tag, from, {}});
+    });
+  }
+  std::sort(moves.begin(), moves.end(), [](const Move& a, const Move& b) {
+    return a.from.segment != b.from.segment ? a.from.segment < b.from.segment
+                                            : a.from.offset < b.from.offset;
+  });
+
+  // Live records are copied into new segments, re-sealed as batches of
+  // one; writes to their keys meanwhile win, by sequence, in any rebuild.
+  std::vector<std::shared_ptr<Segment>> outputs;
+  std::vector<uint8_t> buffer;
+  auto flush = [this, &outputs, &buffer]() {
+    Segment& output = *outputs.back();
+    if (!output.file.WriteAt(0, buffer.data(), buffer.size()) ||
+        !output.file.Sync()) {
+      throw std::runtime_error("Cannot write " + SegmentName(output.id));
+    }
+    output.size = buffer.size();
+    buffer.clear();
+  };
+  try {
+    Record record;
+    for (Move& move : moves) {
+      if (outputs.empty() || buffer.size() >= options_.segment_bytes) {
+        if (!outputs.empty()) flush();
+        auto output = std::make_shared<Segment>();
+        {
+          std::lock_guard<std::mutex> lock(manifest_mutex_);
+          output->id = next_segment_++;
+        }
+        outputs.push_back(output);
+        if (!output->file.Open(directory_ + "/" + SegmentName(output->id),
+                               true) ||
+            !output->file.Resize(0)) {
+          throw std::runtime_error("Cannot create " + SegmentName(output->id));
+        }
+      }
+      const std::vector<uint8_t> data =
+          ReadRecord(*victims.at(move.from.segment), move.from);
+      if (!OpenRecord(data.data(), data.size(), &record)) {
+        throw std::runtime_error("Corrupt record in " +
+                                 SegmentName(move.from.segment));
+      }
+      KvWrite write{std::move(record.key), std::move(record.value)};
+      const size_t offset = buffer.size();
+      SealRecord(write, record.sequence, 0, &buffer);
+      move.to = Location{outputs.back()->id,
+                         static_cast<uint32_t>(buffer.size() - offset),
+                         offset};
+    }
+    if (!outputs.empty()) flush();
+  } catch (...) {
+    for (const auto& output : outputs) {
+      output->file.Close();
+      std::error_code ignored;
+      fs::remove(fs::u8path(directory_ + "/" + SegmentName(output->id)),
+                 ignored);
+    }
+    throw;
+  }
+
+  {
+    std::lock_guard<std::mutex> manifest_lock(manifest_mutex_);
+    // Until this lands, a crash leaves the old segments in use and the new
+    // ones to be deleted on open.
+    std::vector<uint32_t> sealed;
+    for (const auto& entry : segments_) {
+      if (entry.first != active_segment_ && !victims.count(entry.first)) {
+        sealed.push_back(entry.first);
+      }
+    }
+    for (const auto& output : outputs) sealed.push_back(output->id);
+    WriteManifest(active_segment_, sealed);
+
+    std::unique_lock<std::shared_mutex> lock(state_mutex_);
+    for (const auto& output : outputs) segments_[output->id] = output;
+    for (const Move& move : moves) {
+      if (index_->Relocate(move.tag, move.from, move.to)) {
+        segments_.at(move.to.segment)->live += move.to.length;
+      }
+    }
+    for (const auto& victim : victims) segments_.erase(victim.first);
+  }
+  for (const auto& victim : victims) {
+    std::error_code ignored;
+    fs::remove(fs::u8path(directory_ + "/" + SegmentName(victim.first)),
+               ignored);
+  }
+  compactions_.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace flutter_native_utils
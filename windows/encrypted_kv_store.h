@@ -0,0 +1,243 @@
+#ifndef FLUTTER_PLUGIN_ENCRYPTED_KV_STORE_H_
+#define FLUTTER_PLUGIN_ENCRYPTED_KV_STORE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "aes_gcm.h"
+#include "key_store.h"
+#include "secure_buffer.h"
+#include "worker_pool.h"
+
+namespace flutter_native_utils {
+
+struct KvStoreOptions {
+  // The segment being appended to is sealed, and a new one started, once it
+  // holds this many bytes.
+  size_t segment_bytes = 8 << 20;
+  // Sealed segments are compacted in the background once their garbage
+  // (overwritten and deleted records) exceeds both this many bytes and
+  // |compaction_ratio| of their size.
+  size_t compaction_min_garbage = 1 << 20;
+  double compaction_ratio = 0.5;
+  // Whether Write returns only once the batch is on disk. Writers that
+  // arrive while a flush is under way share the next one.
+  bool sync = true;
+};
+
+// A put, or without a value a delete.
+struct KvWrite {
+  std::string key;
+  std::optional<std::vector<uint8_t>> value;
+};
+
+struct KvEntry {
+  std::string key;
+  std::vector<uint8_t> value;
+};
+
+struct KvScanPage {
+  std::vector<KvEntry> entries;
+  // Key of the last entry returned; pass it as |after| for the next page.
+  std::string last;
+  bool done = true;
+};
+
+struct KvStoreStats {
+  size_t keys = 0;
+  size_t segments = 0;
+  uint64_t disk_bytes = 0;     // Segment bytes, live or not.
+  uint64_t live_bytes = 0;     // Of those, records the index points to.
+  uint64_t batches = 0;        // Write() calls.
+  uint64_t commits = 0;        // Appends (and flushes) they were grouped in.
+  uint64_t compactions = 0;
+};
+
+// A log-structured key-value store whose keys and values are encrypted at
+// rest, for tokens and cached responses.
+//
+// Records are appended to segment files, each sealed with AES-256-GCM under
+// the store's data key, so nothing in the directory is readable without the
+// key-store key that wraps the data key. Batches are appended whole by one
+// writer at a time: concurrent Write calls queue behind it, and the next
+// writer appends and flushes everything queued with one write and one sync
+// (group commit). A torn batch at the end of the log is dropped on open, so
+// a batch is durable completely or not at all.
+//
+// The index is an open-addressed hash table in a memory-mapped file, from a
+// 128-bit keyed hash of each key to where its latest record is; a lookup
+// reads one record. It is marked clean only when the store is closed, and
+// rebuilt from the segments if it was not, such as after a crash. When
+// enough of the sealed segments is garbage, a task on |pool| copies their
+// live records, still encrypted, into new segments and deletes them; writes
+// and reads go on meanwhile.
+//
+// Directory layout: "KEY" (the wrapped data key), "MANIFEST" (the segments
+// in use, replaced atomically), "INDEX", and "<id>.seg" segments. Only one
+// store object in the process may have a directory open at a time; see
+// BackendHub for the shared instances. Thread-safe.
+class EncryptedKvStore
+    : public std::enable_shared_from_this<EncryptedKvStore> {
+ public:
+  static constexpr size_t kMaxKeyLen = 4096;
+  static constexpr size_t kMaxValueLen = 64 << 20;
+  static constexpr size_t kMaxPageSize = 1000;
+
+  // Opens the store in |directory|, creating both if there is none, with a
+  // fresh data key wrapped by |key_name| in |keys| (see
+  // KeyIndex::CreateOrOpen). An existing store must be opened with the key
+  // it was created with. Compaction runs on |pool|, or only in Compact() if
+  // it is null. Throws std::invalid_argument for bad options and
+  // std::runtime_error if the directory cannot be used, is not a store, is
+  // open in another store object, or its data key cannot be unwrapped.
+  static std::shared_ptr<EncryptedKvStore> Open(
+      const std::string& directory, const std::string& key_name,
+      KeyIndex* keys, WorkerPool* pool,
+      const KvStoreOptions& options = KvStoreOptions());
+
+  // Flushes the index and marks it clean. A compaction still queued holds
+  // the store, so this runs after it.
+  ~EncryptedKvStore();
+
+  // Disallow copy and assign.
+  EncryptedKvStore(const EncryptedKvStore&) = delete;
+  EncryptedKvStore& operator=(const EncryptedKvStore&) = delete;
+
+  // The value of |key|, or nullopt if there is none. Throws
+  // std::runtime_error if its record cannot be read or authenticated.
+  std::optional<std::vector<uint8_t>> Get(const std::string& key);
+
+  // Applies |batch| in order, atomically. Throws std::invalid_argument if a
+  // key is empty or over kMaxKeyLen, or a value over kMaxValueLen, and
+  // std::runtime_error if the log cannot be written; the store then refuses
+  // further writes.
+  void Write(std::vector<KvWrite> batch);
+  void Put(const std::string& key, std::vector<uint8_t> value);
+  void Delete(const std::string& key);
+
+  // Up to |page_size| entries whose keys start with |prefix| and sort after
+  // |after|, in key order. Keys are only stored hashed, so this reads every
+  // live record; it suits the occasional listing, not a hot path. Throws
+  // std::invalid_argument if |page_size| is not in [1, kMaxPageSize].
+  KvScanPage Scan(const std::string& prefix, const std::string& after,
+                  size_t page_size);
+
+  // Compacts every sealed segment now, whatever its garbage. Returns false
+  // if a compaction was already running.
+  bool Compact();
+
+  KvStoreStats stats() const;
+  // Canonical, whatever |directory| Open was given.
+  const std::string& directory() const { return directory_; }
+  const std::string& key_name() const { return key_name_; }
+
+ private:
+  struct Segment;
+  class Index;
+  struct Pending;
+  class DirectoryClaim;
+
+  // Where a record is.
+  struct Location {
+    uint32_t segment = 0;
+    uint32_t length = 0;
+    uint64_t offset = 0;
+  };
+  struct Tag {
+    uint64_t high = 0;
+    uint64_t low = 0;
+  };
+  // A record decrypted.
+  struct Record {
+    bool put = false;
+    uint64_t sequence = 0;
+    uint32_t remaining = 0;  // Records after this one in its batch.
+    std::string key;
+    std::vector<uint8_t> value;
+  };
+
+  EncryptedKvStore(std::string directory, std::string key_name,
+                   WorkerPool* pool, const KvStoreOptions& options);
+
+  void OpenOrCreate(KeyIndex* keys);
+  void CreateKeyFile(KeyIndex* keys);
+  void ReadKeyFile(KeyIndex* keys);
+  void LoadManifest();
+  // Replaces MANIFEST. Requires |manifest_mutex_|.
+  void WriteManifest(uint32_t active, const std::vector<uint32_t>& sealed);
+  // Rebuilds the index from every segment, by record sequence, dropping a
+  // torn batch from the end of the active one.
+  void RebuildIndex();
+  // Sums each segment's live records; false if the index points outside
+  // the segments.
+  bool ComputeLiveBytes();
+
+  Tag TagOf(const std::string& key) const;
+  // Appends the sealed record to |out|.
+  void SealRecord(const KvWrite& write, uint64_t sequence, uint32_t remaining,
+                  std::vector<uint8_t>* out) const;
+  // Parses and decrypts the record in |data|; false if it is not one.
+  bool OpenRecord(const uint8_t* data, size_t len, Record* record) const;
+  // Reads the record at |location| of |segment|.
+  std::vector<uint8_t> ReadRecord(const Segment& segment,
+                                  const Location& location) const;
+
+  // Appends the sealed batches from the front of |queue_| and wakes their
+  // writers. Called by the writer at the front, with |queue_lock| held.
+  void Commit(std::unique_lock<std::mutex>* queue_lock);
+  // Writes |group|'s |bytes| of records, points the index at them and
+  // starts a new segment if the active one is full.
+  void AppendGroup(const std::vector<Pending*>& group, size_t bytes);
+  // Schedules a compaction if enough of the sealed segments is garbage.
+  void MaybeCompact();
+  // Compacts the sealed segments; requires |compacting_| to be held.
+  void RunCompaction();
+
+  const std::string directory_;
+  const std::string key_name_;
+  WorkerPool* const pool_;
+  const KvStoreOptions options_;
+  std::unique_ptr<DirectoryClaim> claim_;
+
+  std::unique_ptr<AesGcmCipher> cipher_;
+  // SipHash keys of the two tag halves.
+  SecureBytes hash_keys_;
+  uint8_t store_id_[16] = {};
+
+  // Guards the index, the segment table and the counters below; Get and
+  // Scan hold it shared.
+  mutable std::shared_mutex state_mutex_;
+  std::unique_ptr<Index> index_;
+  std::map<uint32_t, std::shared_ptr<Segment>> segments_;
+  uint32_t active_segment_ = 0;
+
+  // Held by the writer and compaction while they change the set of
+  // segments (taken before |state_mutex_|), and for |next_segment_|.
+  std::mutex manifest_mutex_;
+  uint32_t next_segment_ = 1;
+
+  // Writers waiting for, or performing, a commit, and what they share.
+  std::mutex queue_mutex_;
+  std::deque<Pending*> queue_;
+  uint64_t next_sequence_ = 1;
+  bool failed_ = false;
+
+  std::atomic<bool> compacting_{false};
+  std::atomic<uint64_t> batches_{0};
+  std::atomic<uint64_t> commits_{0};
+  std::atomic<uint64_t> compactions_{0};
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_ENCRYPTED_KV_STORE_H_
@@ -0,0 +1,363 @@
+#include "file_hasher.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "blake3.h"
+#include "mapped_file.h"
+#include "sha256.h"
+
+namespace flutter_native_utils {
+
+namespace {
+
+// SHA-256 progress granularity; also bounds how long a file task runs between
+// progress updates.
+constexpr size_t kSha256PieceLen = 8 << 20;
+
+// Minimum interval between progress callbacks.
+constexpr auto kProgressInterval = std::chrono::milliseconds(50);
+
+constexpr char kFileChangedError[] = "File shrank while it was hashed";
+
+// Returned for reads of zero bytes, so that only failed reads return null.
+constexpr uint8_t kNoBytes[1] = {};
+
+// A file being hashed. On Windows it is mapped: the share mode keeps other
+// processes from opening it for writing, and a mapped file cannot be
+// truncated. POSIX systems let another process truncate a file under a
+// mapping, and touching the lost pages raises SIGBUS, so there it is read at
+// explicit offsets instead and a file that shrinks fails with an error.
+class HashInput {
+ public:
+  HashInput() = default;
+  ~HashInput() { Close(); }
+
+  // Disallow copy and assign.
+  HashInput(const HashInput&) = delete;
+  HashInput& operator=(const HashInput&) = delete;
+
+  // Opens |path|. Returns false and fills |error| on failure.
+  bool Open(const std::string& path, std::string* error);
+  void Close();
+
+  // The size when opened; bytes appended later are not hashed.
+  size_t size() const { return size_; }
+
+  // Returns the |len| bytes at |offset|, read into |scratch| unless the file
+  // is mapped. Returns null if the file no longer holds them. Safe to call
+  // from several threads at once, each with its own |scratch|.
+  const uint8_t* Read(size_t offset, size_t len,
+                      std::vector<uint8_t>* scratch) const;
+
+ private:
+#ifdef _WIN32
+  MappedFile file_;
+#else
+  int fd_ = -1;
+#endif
+  size_t size_ = 0;
+};
+
+#ifdef _WIN32
+bool HashInput::Open(const std::string& path, std::string* error) {
+  if (!file_.Open(path, error)) return false;
+  size_ = file_.size();
+  return true;
+}
+
+void HashInput::Close() {
+  file_.Close();
+  size_ = 0;
+}
+
+const uint8_t* HashInput::Read(size_t offset, size_t len,
+                               std::vector<uint8_t>*) const {
+  // An empty file has no mapping to point into.
+  return len == 0 ? kNoBytes : file_.data() + offset;
+}
+#else
+bool HashInput::Open(const std::string& path, std::string* error) {
+  Close();
+  fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd_ < 0) {
+    *error = std::string("Failed to open file: ") + std::strerror(errno);
+    return false;
+  }
+  struct stat info;
+  if (fstat(fd_, &info) != 0) {
+    *error = std::string("Failed to stat file: ") + std::strerror(errno);
+    Close();
+    return false;
+  }
+  size_ = static_cast<size_t>(info.st_size);
+  posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+  return true;
+}
+
+void HashInput::Close() {
+  if (fd_ >= 0) ::close(fd_);
+  fd_ = -1;
+  size_ = 0;
+}
+
+const uint8_t* HashInput::Read(size_t offset, size_t len,
+                               std::vector<uint8_t>* scratch) const {
+  if (len == 0) return kNoBytes;
+  if (scratch->size() < len) scratch->resize(len);
+  uint8_t* data = scratch->data();
+  for (size_t done = 0; done < len;) {
+    const ssize_t read = pread(fd_, data + done, len - done,
+                               static_cast<off_t>(offset + done));
+    if (read < 0 && errno == EINTR) continue;
+    if (read <= 0) return nullptr;
+    done += static_cast<size_t>(read);
+  }
+  return data;
+}
+#endif
+
+struct HashJob {
+  HashAlgorithm algorithm;
+  std::vector<FileHashResult> results;
+  // Fixed before any task runs; |results| is moved out by the last file.
+  size_t file_count = 0;
+  HashProgressCallback on_progress;
+  HashCompletionCallback on_complete;
+
+  uint64_t total_bytes = 0;
+  std::atomic<uint64_t> bytes_done{0};
+  std::atomic<size_t> files_done{0};
+
+  std::mutex progress_mutex;
+  std::chrono::steady_clock::time_point last_progress;
+
+  void AddBytes(uint64_t bytes) {
+    bytes_done.fetch_add(bytes, std::memory_order_relaxed);
+    ReportProgress(false);
+  }
+
+  void ReportProgress(bool force) {
+    if (!on_progress) return;
+    std::unique_lock<std::mutex> lock(progress_mutex, std::try_to_lock);
+    if (!lock.owns_lock() && !force) return;
+    if (!lock.owns_lock()) lock.lock();
+    auto now = std::chrono::steady_clock::now();
+    if (!force && now - last_progress < kProgressInterval) return;
+    last_progress = now;
+    HashProgress progress;
+    progress.files_done = files_done.load(std::memory_order_relaxed);
+    progress.file_count = file_count;
+    progress.bytes_done = bytes_done.load(std::memory_order_relaxed);
+    progress.total_bytes = total_bytes;
+    on_progress(progress);
+  }
+
+  void FileDone() {
+    size_t done = files_done.fetch_add(1, std::memory_order_acq_rel) + 1;
+    if (done != file_count) {
+      ReportProgress(false);
+      return;
+    }
+    ReportProgress(true);
+    if (on_complete) on_complete(std::move(results));
+  }
+};
+
+// State shared by the subtree tasks of one large BLAKE3 file.
+struct Blake3FileState {
+  std::unique_ptr<HashInput> file;
+  std::vector<Blake3ChainingValue> subtrees;
+  std::atomic<size_t> remaining{0};
+  // Set by a subtree task that could not read its segment.
+  std::atomic<bool> changed{false};
+};
+
+void FinishBlake3File(HashJob* job, size_t index, Blake3FileState* state) {
+  const size_t subtree_count = state->subtrees.size();
+  const size_t tail_offset = subtree_count * FileHasher::kBlake3SegmentLen;
+  const size_t tail_len = state->file->size() - tail_offset;
+  FileHashResult& result = job->results[index];
+  std::vector<uint8_t> scratch;
+  const uint8_t* tail =
+      state->changed.load(std::memory_order_relaxed)
+          ? nullptr
+          : state->file->Read(tail_offset, tail_len, &scratch);
+  if (tail) {
+    result.digest.resize(kBlake3OutLen);
+    Blake3CombineSubtrees(state->subtrees,
+                          FileHasher::kBlake3SegmentLen / kBlake3ChunkLen, tail,
+                          tail_len, result.digest.data());
+  } else {
+    result.error = kFileChangedError;
+  }
+  job->AddBytes(tail_len);
+  state->file->Close();
+}
+
+}  // namespace
+
+bool ParseHashAlgorithm(const std::string& name, HashAlgorithm* algorithm) {
+  if (name == "sha256") {
+    *algorithm = HashAlgorithm::kSha256;
+    return true;
+  }
+  if (name == "blake3") {
+    *algorithm = HashAlgorithm::kBlake3;
+    return true;
+  }
+  return false;
+}
+
+FileHasher::FileHasher(size_t thread_count)
+    : owned_pool_(std::make_unique<WorkerPool>(thread_count)),
+      pool_(owned_pool_.get()) {}
+
+FileHasher::FileHasher(WorkerPool* pool) : pool_(pool) {}
+
+std::vector<uint8_t> FileHasher::HashBuffer(const uint8_t* data, size_t len,
+                                            HashAlgorithm algorithm) {
+  if (algorithm == HashAlgorithm::kSha256) {
+    Sha256Digest digest = ComputeSha256(data, len);
+    return std::vector<uint8_t>(digest.begin(), digest.end());
+  }
+  std::vector<uint8_t> digest(kBlake3OutLen);
+  Blake3Hash(data, len, digest.data());
+  return digest;
+}
+
+void FileHasher::HashFilesAsync(std::vector<std::string> paths,
+                                HashAlgorithm algorithm,
+                                HashProgressCallback on_progress,
+                                HashCompletionCallback on_complete) {
+  auto job = std::make_shared<HashJob>();
+  job->algorithm = algorithm;
+  job->on_progress = std::move(on_progress);
+  job->on_complete = std::move(on_complete);
+  job->results.resize(paths.size());
+  for (size_t i = 0; i < paths.size(); ++i) {
+    job->results[i].path = std::move(paths[i]);
+  }
+  job->file_count = job->results.size();
+  if (job->results.empty()) {
+    if (job->on_complete) job->on_complete({});
+    return;
+  }
+
+  // Sizing the files is I/O, so it runs on the pool rather than the caller.
+  // Hashing is throughput work and yields to interactive tasks.
+  // Tasks capture the pool rather than the hasher, so a hasher on a shared
+  // pool may be destroyed while its jobs finish.
+  WorkerPool* pool = pool_;
+  pool->Post([pool, job]() {
+    namespace fs = std::filesystem;
+    for (FileHashResult& result : job->results) {
+      std::error_code error;
+      uint64_t size = fs::file_size(fs::u8path(result.path), error);
+      if (!error) job->total_bytes += size;
+    }
+
+    for (size_t index = 0; index < job->file_count; ++index) {
+      pool->Post([pool, job, index]() {
+        FileHashResult& result = job->results[index];
+        auto file = std::make_unique<HashInput>();
+        if (!file->Open(result.path, &result.error)) {
+          job->FileDone();
+          return;
+        }
+        result.size = file->size();
+
+        try {
+          std::vector<uint8_t> scratch;
+          if (job->algorithm == HashAlgorithm::kSha256) {
+            Sha256 hash;
+            for (size_t offset = 0; offset < file->size();
+                 offset += kSha256PieceLen) {
+              const size_t piece =
+                  std::min(file->size() - offset, kSha256PieceLen);
+              const uint8_t* data = file->Read(offset, piece, &scratch);
+              if (!data) throw std::runtime_error(kFileChangedError);
+              hash.Update(data, piece);
+              job->AddBytes(piece);
+            }
+            Sha256Digest digest = hash.Finish();
+            result.digest.assign(digest.begin(), digest.end());
+          } else if (file->size() <= kBlake3SegmentLen) {
+            const uint8_t* data = file->Read(0, file->size(), &scratch);
+            if (!data) throw std::runtime_error(kFileChangedError);
+            result.digest.resize(kBlake3OutLen);
+            Blake3Hash(data, file->size(), result.digest.data());
+            job->AddBytes(file->size());
+          } else {
+            // Hash all complete subtrees except the last piece in parallel;
+            // the task that finishes last folds them into the root.
+            auto state = std::make_shared<Blake3FileState>();
+            state->file = std::move(file);
+            size_t subtree_count =
+                (state->file->size() - 1) / kBlake3SegmentLen;
+            state->subtrees.resize(subtree_count);
+            state->remaining.store(subtree_count);
+            for (size_t s = 0; s < subtree_count; ++s) {
+              pool->Post([job, index, state, s]() {
+                // Reused by the segments this worker hashes after this one.
+                thread_local std::vector<uint8_t> scratch;
+                const uint8_t* data = state->file->Read(
+                    s * kBlake3SegmentLen, kBlake3SegmentLen, &scratch);
+                if (data) {
+                  state->subtrees[s] = Blake3SubtreeChainingValue(
+                      data, kBlake3SegmentLen,
+                      s * (kBlake3SegmentLen / kBlake3ChunkLen));
+                } else {
+                  state->changed.store(true, std::memory_order_relaxed);
+                }
+                job->AddBytes(kBlake3SegmentLen);
+                if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) ==
+                    1) {
+                  FinishBlake3File(job.get(), index, state.get());
+                  job->FileDone();
+                }
+              }, TaskPriority::kBulk);
+            }
+            return;
+          }
+        } catch (const std::exception& ex) {
+          result.digest.clear();
+          result.error = ex.what();
+        }
+        file->Close();
+        job->FileDone();
+      }, TaskPriority::kBulk);
+    }
+  }, TaskPriority::kBulk);
+}
+
+std::vector<FileHashResult> FileHasher::HashFiles(
+    const std::vector<std::string>& paths, HashAlgorithm algorithm,
+    HashProgressCallback on_progress) {
+  std::promise<std::vector<FileHashResult>> promise;
+  auto future = promise.get_future();
+  HashFilesAsync(paths, algorithm, std::move(on_progress),
+                 [&promise](std::vector<FileHashResult> results) {
+                   promise.set_value(std::move(results));
+                 });
+  return future.get();
+}
+
+}  // namespace flutter_native_utils
@@ -0,0 +1,86 @@
+#ifndef FLUTTER_PLUGIN_FILE_HASHER_H_
+#define FLUTTER_PLUGIN_FILE_HASHER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "worker_pool.h"
+
+namespace flutter_native_utils {
+
+enum class HashAlgorithm { kSha256, kBlake3 };
+
+// Accepts "sha256" and "blake3" (case-sensitive).
+bool ParseHashAlgorithm(const std::string& name, HashAlgorithm* algorithm);
+
+struct FileHashResult {
+  std::string path;
+  uint64_t size = 0;
+  std::vector<uint8_t> digest;  // Empty if |error| is set.
+  std::string error;
+};
+
+struct HashProgress {
+  size_t files_done = 0;
+  size_t file_count = 0;
+  uint64_t bytes_done = 0;
+  uint64_t total_bytes = 0;
+};
+
+using HashProgressCallback = std::function<void(const HashProgress&)>;
+using HashCompletionCallback =
+    std::function<void(std::vector<FileHashResult> results)>;
+
+// Hashes files on a worker pool. Files are memory-mapped on Windows and read
+// in large pieces elsewhere, where a mapped file truncated by another process
+// would raise SIGBUS; a file that shrinks while it is hashed gets an error
+// rather than a digest. Different files are hashed concurrently and large
+// BLAKE3 inputs are additionally split into subtrees that are hashed in
+// parallel. SHA-256 is inherently sequential per file and relies on the
+// platform library's SHA-NI/AVX2 code paths.
+class FileHasher {
+ public:
+  // BLAKE3 subtree size handled by one task (must be a power-of-two multiple
+  // of the 1 KiB chunk size).
+  static constexpr size_t kBlake3SegmentLen = 1 << 20;
+
+  // |thread_count| of zero uses one thread per logical processor.
+  explicit FileHasher(size_t thread_count = 0);
+
+  // Runs on a shared |pool|, which must outlive the hasher.
+  explicit FileHasher(WorkerPool* pool);
+
+  // Hashes |paths| asynchronously. |on_progress| (optional, throttled) and
+  // |on_complete| are invoked on worker threads; results keep input order.
+  void HashFilesAsync(std::vector<std::string> paths, HashAlgorithm algorithm,
+                      HashProgressCallback on_progress,
+                      HashCompletionCallback on_complete);
+
+  // Blocking variant of HashFilesAsync. Must not be called from a task running
+  // on this hasher's pool.
+  std::vector<FileHashResult> HashFiles(const std::vector<std::string>& paths,
+                                        HashAlgorithm algorithm,
+                                        HashProgressCallback on_progress = nullptr);
+
+  // Hashes an in-memory buffer on the calling thread.
+  static std::vector<uint8_t> HashBuffer(const uint8_t* data, size_t len,
+                                         HashAlgorithm algorithm);
+
+  size_t thread_count() const { return pool_->thread_count(); }
+
+  // The pool the hasher runs on, for callers that schedule related work
+  // (e.g. stat calls) alongside their hash jobs.
+  WorkerPool* pool() { return pool_; }
+
+ private:
+  std::unique_ptr<WorkerPool> owned_pool_;
+  WorkerPool* pool_;
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_FILE_HASHER_H_
@@ -3,35 +3,47 @@
 // This must be included before many other Windows headers.
 #include <windows.h>
 
-#include <comdef.h>
-#include <Wbemidl.h>
-
 #include <VersionHelpers.h>
 
+#include <flutter/event_stream_handler_functions.h>
 #include <flutter/method_channel.h>
 #include <flutter/plugin_registrar_windows.h>
+#include <flutter/standard_message_codec.h>
 #include <flutter/standard_method_codec.h>
 #include <flutter/encodable_value.h>
 
+#include <algorithm>
+#include <cstdlib>
 #include <memory>
 #include <string>
 #include <vector>
 #include <sstream>
-#include <unordered_map>
 #include <functional>
+#include <stdexcept>
+#include <utility>
+#include <variant>
 
 #include <winrt/Windows.ApplicationModel.Core.h>
 #include <winrt/Windows.Foundation.h>
 
-#include <ncrypt.h>
-#include <wincrypt.h>
 #include <iostream>
 #include <iomanip>
 
-// Link required libraries
-#pragma comment(lib, "wbemuuid.lib")
-#pragma comment(lib, "ncrypt.lib")
-#pragma comment(lib, "crypt32.lib")
+#include "allocation_stats.h"
+#include "backend_hub.h"
+#include "buffered_random.h"
+#include "file_hasher.h"
+#include "manifest_verifier.h"
+#include "method_call_log.h"
+#include "platform_task_runner.h"
+#include "plugin_feature.h"
+#include "resource_sampler.h"
+#include "secure_random.h"
+#include "signature_verifier.h"
+#include "startup_timeline.h"
+#include "worker_pool.h"
+
+// System libraries of the optional features are linked by their sources.
 
 using namespace winrt;
 using namespace Windows::ApplicationModel::Core;
@@ -48,502 +60,956 @@ namespace flutter_native_utils {
 // }
 // #endif
 
-static std::vector<BYTE> HexStringToBytes(const std::string& hex) {
-  std::vector<BYTE> bytes;
-  for (size_t i = 0; i < hex.length(); i += 2) {
-    std::string byteString = hex.substr(i, 2);
-    BYTE byte = static_cast<BYTE>(strtol(byteString.c_str(), nullptr, 16));
-    bytes.push_back(byte);
-  }
-  return bytes;
+// ---------- Resource Sampler ----------
+static flutter::EncodableMap ResourceSamplerStatsToMap(
+    const ResourceSamplerStats& stats) {
+  return {
+      {flutter::EncodableValue("samples"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.samples))},
+      {flutter::EncodableValue("dropped"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.dropped))},
+      {flutter::EncodableValue("cpuOverhead"),
+       flutter::EncodableValue(stats.cpu_overhead)},
+  };
 }
 
+void FlutterNativeUtilsPlugin::HandleStartResourceSampler(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  if (!task_runner_) {
+    result->Error("UNAVAILABLE", "Resource sampler requires a registrar");
+    return;
+  }
+
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  if (!args) {
+    result->Error("BAD_ARGS", "Invalid arguments");
+    return;
+  }
+  auto rate_it = args->find(flutter::EncodableValue("rateHz"));
+  if (rate_it == args->end() || !std::holds_alternative<int32_t>(rate_it->second)) {
+    result->Error("BAD_ARGS", "Missing rateHz parameter");
+    return;
+  }
+  int32_t rate_hz = std::get<int32_t>(rate_it->second);
+
+  // Default to roughly ten batches per second.
+  int32_t batch_size = rate_hz / 10;
+  auto batch_it = args->find(flutter::EncodableValue("batchSize"));
+  if (batch_it != args->end() &&
+      std::holds_alternative<int32_t>(batch_it->second)) {
+    batch_size = std::get<int32_t>(batch_it->second);
+  }
+  if (rate_hz <= 0 || batch_size <= 0) {
+    result->Error("BAD_ARGS", "rateHz and batchSize must be positive");
+    return;
+  }
+
+  try {
+    // The backend (PDH queries, interface tables) is only set up on first use.
+    ResourceSampler* sampler = sampler_.Get();
+    sampler->Start(static_cast<uint32_t>(rate_hz),
+                   static_cast<uint32_t>(batch_size), [this]() {
+                     task_runner_->PostTask([this]() { FlushResourceSamples(); });
+                   });
+    result->Success();
+  } catch (const std::invalid_argument& ex) {
+    result->Error("BAD_ARGS", ex.what());
+  } catch (const std::exception& ex) {
+    result->Error("FAILURE", ex.what());
+  }
+}
 
-// ---------- RAII wrapper for NCrypt handles ----------
-struct NCryptHandle {
-  NCRYPT_HANDLE handle{0};
-  ~NCryptHandle() { reset(); }
+void FlutterNativeUtilsPlugin::HandleStopResourceSampler(
+    const flutter::MethodCall<flutter::EncodableValue>&,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  ResourceSampler* sampler = sampler_.GetIfCreated();
+  if (!sampler) {
+    result->Success(flutter::EncodableValue(
+        ResourceSamplerStatsToMap(ResourceSamplerStats())));
+    return;
+  }
+  sampler->Stop();
+  FlushResourceSamples();
+  result->Success(flutter::EncodableValue(
+      ResourceSamplerStatsToMap(sampler->stats())));
+}
 
-  void reset() {
-    if (handle) {
-      NCryptFreeObject(handle);
-      handle = 0;
+void FlutterNativeUtilsPlugin::FlushResourceSamples() {
+  ResourceSampler* sampler = sampler_.GetIfCreated();
+  if (!sampler) return;
+  sample_scratch_.clear();
+  sampler->Drain(&sample_scratch_, 4096);
+  // Always drain so the ring buffer does not fill up while nobody listens.
+  if (!sample_sink_ || sample_scratch_.empty()) return;
+
+  // Samples are sent column-wise as typed lists, which the standard codec
+  // encodes as flat arrays instead of one map per sample.
+  size_t count = sample_scratch_.size();
+  uint32_t core_count = sample_scratch_.front().core_count;
+  std::vector<int64_t> timestamps(count);
+  std::vector<float> cpu_total(count);
+  std::vector<float> cpu_per_core(count * core_count);
+  std::vector<int64_t> memory_total(count);
+  std::vector<int64_t> memory_available(count);
+  std::vector<double> disk_read(count);
+  std::vector<double> disk_write(count);
+  std::vector<double> net_rx(count);
+  std::vector<double> net_tx(count);
+  for (size_t i = 0; i < count; ++i) {
+    const ResourceSample& sample = sample_scratch_[i];
+    timestamps[i] = sample.timestamp_us;
+    cpu_total[i] = sample.cpu_total;
+    for (uint32_t core = 0; core < core_count && core < sample.core_count;
+         ++core) {
+      cpu_per_core[i * core_count + core] = sample.cpu_per_core[core];
     }
+    memory_total[i] = static_cast<int64_t>(sample.memory_total_bytes);
+    memory_available[i] = static_cast<int64_t>(sample.memory_available_bytes);
+    disk_read[i] = sample.disk_read_bytes_per_sec;
+    disk_write[i] = sample.disk_write_bytes_per_sec;
+    net_rx[i] = sample.net_rx_bytes_per_sec;
+    net_tx[i] = sample.net_tx_bytes_per_sec;
   }
-  operator NCRYPT_HANDLE() const { return handle; }
-  NCRYPT_HANDLE* put() { reset(); return &handle; }
-};
 
-// ---------- UTF8 <-> Wide ----------
-static std::wstring Utf8ToWide(const std::string& str) {
-  if (str.empty()) return L"";
-  int len = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), (int)str.size(), nullptr, 0);
-  std::wstring result(len, 0);
-  MultiByteToWideChar(CP_UTF8, 0, str.c_str(), (int)str.size(), result.data(), len);
-  return result;
+  ResourceSamplerStats stats = sampler->stats();
+  flutter::EncodableMap batch = {
+      {flutter::EncodableValue("timestampsUs"), flutter::EncodableValue(timestamps)},
+      {flutter::EncodableValue("cpuTotal"), flutter::EncodableValue(cpu_total)},
+      {flutter::EncodableValue("coreCount"),
+       flutter::EncodableValue(static_cast<int32_t>(core_count))},
+      {flutter::EncodableValue("cpuPerCore"), flutter::EncodableValue(cpu_per_core)},
+      {flutter::EncodableValue("memoryTotalBytes"), flutter::EncodableValue(memory_total)},
+      {flutter::EncodableValue("memoryAvailableBytes"),
+       flutter::EncodableValue(memory_available)},
+      {flutter::EncodableValue("diskReadBytesPerSec"), flutter::EncodableValue(disk_read)},
+      {flutter::EncodableValue("diskWriteBytesPerSec"), flutter::EncodableValue(disk_write)},
+      {flutter::EncodableValue("netRxBytesPerSec"), flutter::EncodableValue(net_rx)},
+      {flutter::EncodableValue("netTxBytesPerSec"), flutter::EncodableValue(net_tx)},
+      {flutter::EncodableValue("dropped"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.dropped))},
+      {flutter::EncodableValue("samplerCpuOverhead"),
+       flutter::EncodableValue(stats.cpu_overhead)},
+  };
+  sample_sink_->Success(flutter::EncodableValue(batch));
 }
 
-static std::string WideToUtf8(const std::wstring& wstr) {
-  if (wstr.empty()) return "";
-  int len = WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), (int)wstr.size(),
-                                nullptr, 0, nullptr, nullptr);
-  std::string result(len, 0);
-  WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), (int)wstr.size(),
-                      result.data(), len, nullptr, nullptr);
-  return result;
+// ---------- File Hashing ----------
+static flutter::EncodableMap HashProgressToMap(int64_t job_id,
+                                               const HashProgress& progress) {
+  return {
+      {flutter::EncodableValue("jobId"), flutter::EncodableValue(job_id)},
+      {flutter::EncodableValue("filesDone"),
+       flutter::EncodableValue(static_cast<int64_t>(progress.files_done))},
+      {flutter::EncodableValue("fileCount"),
+       flutter::EncodableValue(static_cast<int64_t>(progress.file_count))},
+      {flutter::EncodableValue("bytesDone"),
+       flutter::EncodableValue(static_cast<int64_t>(progress.bytes_done))},
+      {flutter::EncodableValue("totalBytes"),
+       flutter::EncodableValue(static_cast<int64_t>(progress.total_bytes))},
+  };
 }
 
-// ---------- RequestAppRestart ----------
-static std::wstring RequestAppRestart(const std::wstring& restartArgs) {
-  wchar_t moduleFileName[MAX_PATH];
-  if (GetModuleFileName(NULL, moduleFileName, MAX_PATH) == 0) {
-    return L"Failed to get module file name.";
+static flutter::EncodableValue FileHashResultsToValue(
+    const std::vector<FileHashResult>& results) {
+  flutter::EncodableList list;
+  list.reserve(results.size());
+  for (const FileHashResult& file : results) {
+    flutter::EncodableMap entry = {
+        {flutter::EncodableValue("path"), flutter::EncodableValue(file.path)},
+        {flutter::EncodableValue("size"),
+         flutter::EncodableValue(static_cast<int64_t>(file.size))},
+    };
+    if (file.error.empty()) {
+      entry[flutter::EncodableValue("digest")] =
+          flutter::EncodableValue(file.digest);
+    } else {
+      entry[flutter::EncodableValue("error")] =
+          flutter::EncodableValue(file.error);
+    }
+    list.push_back(flutter::EncodableValue(entry));
   }
+  return flutter::EncodableValue(list);
+}
 
-  std::wstring commandLine = L"\"";
-  commandLine += moduleFileName;
-  commandLine += L"\" ";
-  commandLine += restartArgs;
+void FlutterNativeUtilsPlugin::HandleHashFiles(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  if (!task_runner_) {
+    result->Error("UNAVAILABLE", "File hashing requires a registrar");
+    return;
+  }
 
-  STARTUPINFO startupInfo = { sizeof(startupInfo) };
-  PROCESS_INFORMATION processInfo = { 0 };
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  if (!args) {
+    result->Error("BAD_ARGS", "Invalid arguments");
+    return;
+  }
+  auto paths_it = args->find(flutter::EncodableValue("paths"));
+  if (paths_it == args->end() ||
+      !std::holds_alternative<flutter::EncodableList>(paths_it->second)) {
+    result->Error("BAD_ARGS", "Missing paths parameter");
+    return;
+  }
+  std::vector<std::string> paths;
+  for (const auto& path : std::get<flutter::EncodableList>(paths_it->second)) {
+    if (!std::holds_alternative<std::string>(path)) {
+      result->Error("BAD_ARGS", "paths must only contain strings");
+      return;
+    }
+    paths.push_back(std::get<std::string>(path));
+  }
 
-  if (!CreateProcess(moduleFileName, &commandLine[0], NULL, NULL, FALSE,
-                     0, NULL, NULL, &startupInfo, &processInfo)) {
-    return L"Failed to create process.";
+  HashAlgorithm algorithm = HashAlgorithm::kSha256;
+  auto algorithm_it = args->find(flutter::EncodableValue("algorithm"));
+  if (algorithm_it != args->end()) {
+    const auto* name = std::get_if<std::string>(&algorithm_it->second);
+    if (!name || !ParseHashAlgorithm(*name, &algorithm)) {
+      result->Error("BAD_ARGS", "algorithm must be sha256 or blake3");
+      return;
+    }
   }
 
-  CloseHandle(processInfo.hProcess);
-  CloseHandle(processInfo.hThread);
+  int64_t job_id = 0;
+  auto job_it = args->find(flutter::EncodableValue("jobId"));
+  if (job_it != args->end() &&
+      (std::holds_alternative<int32_t>(job_it->second) ||
+       std::holds_alternative<int64_t>(job_it->second))) {
+    job_id = job_it->second.LongValue();
+  }
 
-  ExitProcess(0);
+  // std::function must be copyable, so the move-only result is shared.
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result =
+      std::move(result);
+  hasher()->HashFilesAsync(
+      std::move(paths), algorithm,
+      [this, route = route_, job_id](const HashProgress& progress) {
+        route->Post([this, job_id, progress]() {
+          if (!hash_progress_sink_) return;
+          hash_progress_sink_->Success(
+              flutter::EncodableValue(HashProgressToMap(job_id, progress)));
+        });
+      },
+      [route = route_, shared_result](std::vector<FileHashResult> results) {
+        auto value = std::make_shared<flutter::EncodableValue>(
+            FileHashResultsToValue(results));
+        route->Post(
+            [shared_result, value]() { shared_result->Success(*value); });
+      });
 }
 
-void HandleRequestAppRestart(
-    const flutter::MethodCall<flutter::EncodableValue>&,
-    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  std::wstring msg = RequestAppRestart(L"");
-  if (msg == L"Success") {
-    result->Success("Restart requested successfully.");
-  } else {
-    result->Error("FAILURE", WideToUtf8(msg));
+FileHasher* FlutterNativeUtilsPlugin::hasher() { return hub_->hasher(); }
+
+// ---------- Manifest Verification ----------
+static const char* ManifestFailureReasonName(ManifestFailureReason reason) {
+  switch (reason) {
+    case ManifestFailureReason::kMissing:
+      return "missing";
+    case ManifestFailureReason::kSizeMismatch:
+      return "sizeMismatch";
+    case ManifestFailureReason::kDigestMismatch:
+      return "digestMismatch";
+    case ManifestFailureReason::kReadError:
+      return "readError";
   }
+  return "unknown";
 }
 
-// ---------- Hardware Info (WMI) ----------
-static std::string QueryWmiProperty(const std::wstring& wmi_class,
-                                    const std::wstring& property) {
-  HRESULT hres = CoInitializeEx(0, COINIT_MULTITHREADED);
-  if (hres == RPC_E_CHANGED_MODE) hres = S_OK;
-  if (FAILED(hres)) return "";
-
-  hres = CoInitializeSecurity(NULL, -1, NULL, NULL,
-                              RPC_C_AUTHN_LEVEL_DEFAULT,
-                              RPC_C_IMP_LEVEL_IMPERSONATE,
-                              NULL, EOAC_NONE, NULL);
-  if (FAILED(hres) && hres != RPC_E_TOO_LATE) {
-    CoUninitialize();
-    return "";
-  }
-
-  IWbemLocator* pLoc = NULL;
-  hres = CoCreateInstance(CLSID_WbemLocator, 0, CLSCTX_INPROC_SERVER,
-                          IID_IWbemLocator, reinterpret_cast<LPVOID*>(&pLoc));
-  if (FAILED(hres)) {
-    CoUninitialize();
-    return "";
-  }
-
-  IWbemServices* pSvc = NULL;
-  hres = pLoc->ConnectServer(_bstr_t(L"ROOT\\CIMV2"),
-                             NULL, NULL, 0, NULL, 0, 0, &pSvc);
-  if (FAILED(hres)) {
-    pLoc->Release();
-    CoUninitialize();
-    return "";
-  }
-
-  CoSetProxyBlanket(pSvc, RPC_C_AUTHN_WINNT, RPC_C_AUTHZ_NONE, NULL,
-                    RPC_C_AUTHN_LEVEL_CALL, RPC_C_IMP_LEVEL_IMPERSONATE,
-                    NULL, EOAC_NONE);
-
-  IEnumWbemClassObject* pEnumerator = NULL;
-  std::wstring query = L"SELECT " + property + L" FROM " + wmi_class;
-  hres = pSvc->ExecQuery(bstr_t("WQL"), bstr_t(query.c_str()),
-                         WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY,
-                         NULL, &pEnumerator);
-
-  std::string resultStr;
-  if (SUCCEEDED(hres) && pEnumerator) {
-    IWbemClassObject* pclsObj = NULL;
-    ULONG uReturn = 0;
-    HRESULT hr = pEnumerator->Next(WBEM_INFINITE, 1, &pclsObj, &uReturn);
-    if (uReturn != 0) {
-      VARIANT vtProp;
-      hr = pclsObj->Get(property.c_str(), 0, &vtProp, 0, 0);
-      if (SUCCEEDED(hr) && vtProp.vt == VT_BSTR) {
-        resultStr = WideToUtf8(vtProp.bstrVal);
-      }
-      VariantClear(&vtProp);
-      pclsObj->Release();
-    }
-    pEnumerator->Release();
+static flutter::EncodableMap ManifestVerifyResultToMap(
+    const ManifestVerifyResult& verify_result) {
+  flutter::EncodableList failures;
+  for (const ManifestFailure& failure : verify_result.failures) {
+    failures.push_back(flutter::EncodableValue(flutter::EncodableMap{
+        {flutter::EncodableValue("path"), flutter::EncodableValue(failure.path)},
+        {flutter::EncodableValue("reason"),
+         flutter::EncodableValue(ManifestFailureReasonName(failure.reason))},
+        {flutter::EncodableValue("detail"),
+         flutter::EncodableValue(failure.detail)},
+    }));
   }
+  return {
+      {flutter::EncodableValue("valid"),
+       flutter::EncodableValue(verify_result.ok())},
+      {flutter::EncodableValue("signatureValid"),
+       flutter::EncodableValue(verify_result.signature_valid)},
+      {flutter::EncodableValue("filesChecked"),
+       flutter::EncodableValue(static_cast<int64_t>(verify_result.files_checked))},
+      {flutter::EncodableValue("filesRehashed"),
+       flutter::EncodableValue(
+           static_cast<int64_t>(verify_result.files_rehashed))},
+      {flutter::EncodableValue("elapsedUs"),
+       flutter::EncodableValue(verify_result.elapsed_us)},
+      {flutter::EncodableValue("failures"), flutter::EncodableValue(failures)},
+  };
+}
 
-  pSvc->Release();
-  pLoc->Release();
-  CoUninitialize();
-  return resultStr;
+// Directory containing the running executable, i.e. the installed bundle.
+static std::string ExecutableDirectory() {
+  std::wstring path(MAX_PATH, L'\0');
+  DWORD len = 0;
+  while ((len = GetModuleFileNameW(nullptr, path.data(),
+                                   static_cast<DWORD>(path.size()))) ==
+         path.size()) {
+    path.resize(path.size() * 2);
+  }
+  path.resize(len);
+  size_t slash = path.find_last_of(L"\\/");
+  if (slash != std::wstring::npos) path.resize(slash);
+  return WideToUtf8(path);
 }
 
-static void HandleRequestHardwareInfo(
-    const flutter::MethodCall<flutter::EncodableValue>&,
+void FlutterNativeUtilsPlugin::HandleVerifyManifest(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  std::string cpuId = QueryWmiProperty(L"Win32_Processor", L"ProcessorId");
-  std::string boardId = QueryWmiProperty(L"Win32_BaseBoard", L"SerialNumber");
+  if (!task_runner_) {
+    result->Error("UNAVAILABLE", "Manifest verification requires a registrar");
+    return;
+  }
+
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  if (!args) {
+    result->Error("BAD_ARGS", "Invalid arguments");
+    return;
+  }
+  auto find_bytes = [args](const char* name) -> const std::vector<uint8_t>* {
+    auto it = args->find(flutter::EncodableValue(name));
+    if (it == args->end()) return nullptr;
+    return std::get_if<std::vector<uint8_t>>(&it->second);
+  };
+  auto find_string = [args](const char* name) -> const std::string* {
+    auto it = args->find(flutter::EncodableValue(name));
+    if (it == args->end()) return nullptr;
+    return std::get_if<std::string>(&it->second);
+  };
+
+  const std::vector<uint8_t>* manifest = find_bytes("manifest");
+  const std::vector<uint8_t>* signature = find_bytes("signature");
+  const std::vector<uint8_t>* public_key = find_bytes("publicKey");
+  if (!manifest || !signature || !public_key) {
+    result->Error("BAD_ARGS",
+                  "manifest, signature and publicKey must be byte arrays");
+    return;
+  }
 
-  flutter::EncodableMap response = {
-      {flutter::EncodableValue("systemCpuId"), flutter::EncodableValue(cpuId)},
-      {flutter::EncodableValue("systemBoardId"), flutter::EncodableValue(boardId)}};
-  result->Success(response);
+  ManifestVerifyRequest request;
+  request.manifest.assign(manifest->begin(), manifest->end());
+  request.signature = *signature;
+  request.public_key = *public_key;
+  const std::string* root = find_string("root");
+  request.root = root ? *root : ExecutableDirectory();
+  const std::string* cache_path = find_string("cachePath");
+  if (cache_path) request.cache_path = *cache_path;
+
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result =
+      std::move(result);
+  try {
+    hub_->manifest_verifier()->VerifyAsync(
+        std::move(request),
+        [route = route_, shared_result](ManifestVerifyResult verify_result) {
+          auto value = std::make_shared<flutter::EncodableValue>(
+              ManifestVerifyResultToMap(verify_result));
+          route->Post(
+              [shared_result, value]() { shared_result->Success(*value); });
+        });
+  } catch (const std::invalid_argument& ex) {
+    shared_result->Error("BAD_ARGS", ex.what());
+  } catch (const std::exception& ex) {
+    shared_result->Error("FAILURE", ex.what());
+  }
 }
 
-// ---------- CNG Key Management ----------
-static std::vector<uint8_t> CreateOrOpenKeyPair(const std::wstring& keyName) {
-  NCryptHandle hProv, hKey;
-  SECURITY_STATUS status = NCryptOpenStorageProvider(hProv.put(),
-                                                     MS_KEY_STORAGE_PROVIDER, 0);
-  if (status != ERROR_SUCCESS) throw std::runtime_error("OpenStorageProvider failed");
-
-  status = NCryptOpenKey(hProv, hKey.put(), keyName.c_str(), 0, 0);
-  if (status == NTE_BAD_KEYSET) {
-    status = NCryptCreatePersistedKey(hProv, hKey.put(),
-                                      NCRYPT_RSA_ALGORITHM,
-                                      keyName.c_str(), 0,
-                                      NCRYPT_OVERWRITE_KEY_FLAG);
-    if (status != ERROR_SUCCESS) throw std::runtime_error("CreatePersistedKey failed");
-
-    DWORD keyLength = 2048;
-    status = NCryptSetProperty(hKey, NCRYPT_LENGTH_PROPERTY,
-                               (PBYTE)&keyLength, sizeof(keyLength), 0);
-    if (status != ERROR_SUCCESS) throw std::runtime_error("SetProperty failed");
-
-    status = NCryptFinalizeKey(hKey, 0);
-    if (status != ERROR_SUCCESS) throw std::runtime_error("FinalizeKey failed");
-  } else if (status != ERROR_SUCCESS) {
-    throw std::runtime_error("OpenKey failed");
-  }
-
-  DWORD keySize = 0;
-  status = NCryptExportKey(hKey, 0, BCRYPT_RSAPUBLIC_BLOB,
-                           nullptr, nullptr, 0, &keySize, 0);
-  if (status != ERROR_SUCCESS) throw std::runtime_error("ExportKey size failed");
-
-  std::vector<uint8_t> pubKey(keySize);
-  status = NCryptExportKey(hKey, 0, BCRYPT_RSAPUBLIC_BLOB,
-                           nullptr, pubKey.data(), keySize, &keySize, 0);
-  if (status != ERROR_SUCCESS) throw std::runtime_error("ExportKey failed");
-
-  return pubKey;
+WorkerPool* FlutterNativeUtilsPlugin::workers() { return hub_->workers(); }
+
+// ---------- Signature Verification ----------
+static const std::string* KeyIdArgument(const flutter::EncodableMap* args) {
+  const flutter::EncodableValue* value =
+      args ? FindArgument(*args, "keyId") : nullptr;
+  return value ? std::get_if<std::string>(value) : nullptr;
 }
 
-void HandleCreateKeyPair(
+void FlutterNativeUtilsPlugin::HandleImportPublicKey(
     const flutter::MethodCall<flutter::EncodableValue>& call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  const std::string* key_id = KeyIdArgument(args);
+  if (!key_id) {
+    result->Error("BAD_ARGS", "Missing keyId");
+    return;
+  }
   try {
-    const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
-    if (!args) throw std::runtime_error("Invalid arguments");
-    auto it = args->find(flutter::EncodableValue("keyName"));
-    if (it == args->end()) throw std::runtime_error("Missing keyName");
-
-    std::wstring keyName = Utf8ToWide(std::get<std::string>(it->second));
-    auto pubKey = CreateOrOpenKeyPair(keyName);
-    result->Success(flutter::EncodableValue(pubKey));
+    public_keys_.Import(*key_id, BytesArgument(*args, "publicKey", true));
+    result->Success();
+  } catch (const std::invalid_argument& ex) {
+    result->Error("BAD_ARGS", ex.what());
   } catch (const std::exception& ex) {
     result->Error("CNG_ERROR", ex.what());
   }
 }
 
-// ---------- Signing ----------
-static std::vector<uint8_t> SignWithKey(const std::wstring& keyName,
-                                        const std::vector<uint8_t>& data) {
-  NCRYPT_PROV_HANDLE hProvider = 0;
-  NCRYPT_KEY_HANDLE hKey = 0;
-  BCRYPT_ALG_HANDLE hAlgSha = nullptr;
-  BCRYPT_HASH_HANDLE hHash = nullptr;
+void FlutterNativeUtilsPlugin::HandleRemovePublicKey(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  const std::string* key_id = KeyIdArgument(args);
+  if (!key_id) {
+    result->Error("BAD_ARGS", "Missing keyId");
+    return;
+  }
+  result->Success(flutter::EncodableValue(public_keys_.Remove(*key_id)));
+}
 
-  try {
-    SECURITY_STATUS status = NCryptOpenStorageProvider(&hProvider, MS_KEY_STORAGE_PROVIDER, 0);
-    if (status != ERROR_SUCCESS) {
-      throw std::runtime_error("NCryptOpenStorageProvider failed");
-    }
+void FlutterNativeUtilsPlugin::HandleVerifySignatures(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  if (!task_runner_) {
+    result->Error("UNAVAILABLE", "Signature verification requires a registrar");
+    return;
+  }
+  if (!call.arguments()) {
+    result->Error("BAD_ARGS", "Invalid arguments");
+    return;
+  }
+  // The checks point into the arguments, which must outlive the batch.
+  auto arguments = std::make_shared<flutter::EncodableValue>(*call.arguments());
+  const auto* args = std::get_if<flutter::EncodableMap>(arguments.get());
+  const flutter::EncodableValue* key_ids =
+      args ? FindArgument(*args, "keyIds") : nullptr;
+  const auto* key_id_list =
+      key_ids ? std::get_if<flutter::EncodableList>(key_ids) : nullptr;
+  if (!key_id_list) {
+    result->Error("BAD_ARGS", "keyIds must be a list");
+    return;
+  }
 
-    status = NCryptOpenKey(hProvider, &hKey, keyName.c_str(), 0, 0);
-    if (status != ERROR_SUCCESS) {
-      throw std::runtime_error("NCryptOpenKey failed - key not found");
+  std::vector<SignatureCheck> checks;
+  try {
+    std::vector<MacMessage> messages = ByteListArgument(*args, "messages");
+    std::vector<MacMessage> signatures =
+        ByteListArgument(*args, "signatures");
+    if (messages.size() != signatures.size() ||
+        messages.size() != key_id_list->size()) {
+      throw std::invalid_argument(
+          "messages, signatures and keyIds must have the same length");
     }
-
-    status = BCryptOpenAlgorithmProvider(&hAlgSha, BCRYPT_SHA256_ALGORITHM, nullptr, 0);
-    if (status != ERROR_SUCCESS) {
-      throw std::runtime_error("BCryptOpenAlgorithmProvider (SHA256) failed");
+    // Each distinct key id is looked up once per batch.
+    std::unordered_map<std::string, std::shared_ptr<const RsaPublicKey>> keys;
+    checks.resize(messages.size());
+    for (size_t i = 0; i < messages.size(); ++i) {
+      const auto* key_id = std::get_if<std::string>(&(*key_id_list)[i]);
+      if (!key_id) throw std::invalid_argument("keyIds must be strings");
+      auto key = keys.find(*key_id);
+      if (key == keys.end()) {
+        key = keys.emplace(*key_id, public_keys_.Find(*key_id)).first;
+      }
+      checks[i].message = messages[i].data;
+      checks[i].message_len = messages[i].len;
+      checks[i].signature = signatures[i].data;
+      checks[i].signature_len = signatures[i].len;
+      checks[i].key = key->second;
     }
+  } catch (const std::invalid_argument& ex) {
+    result->Error("BAD_ARGS", ex.what());
+    return;
+  }
 
-    // Query hash object/length
-    DWORD hashObjLen = 0, hashLen = 0, cbData = 0;
-    status = BCryptGetProperty(hAlgSha, BCRYPT_OBJECT_LENGTH,
-                               reinterpret_cast<PUCHAR>(&hashObjLen), sizeof(DWORD), &cbData, 0);
-    status = BCryptGetProperty(hAlgSha, BCRYPT_HASH_LENGTH,
-                               reinterpret_cast<PUCHAR>(&hashLen), sizeof(DWORD), &cbData, 0);
-
-    std::vector<uint8_t> hash(hashLen);
-    std::vector<uint8_t> hashObj(hashObjLen);
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result =
+      std::move(result);
+  VerifySignaturesAsync(
+      std::move(checks), workers(),
+      [route = route_, shared_result, arguments](SignatureBitmap bitmap) {
+        auto value = std::make_shared<flutter::EncodableValue>(std::move(bitmap));
+        route->Post([shared_result, value]() {
+          shared_result->Success(*value);
+        });
+      });
+}
 
-    status = BCryptCreateHash(hAlgSha, &hHash, hashObj.data(), hashObjLen, nullptr, 0, 0);
-    if (status != ERROR_SUCCESS) {
-      throw std::runtime_error("BCryptCreateHash failed");
-    }
+// ---------- Random Bytes ----------
+static void HandleGetRandomBytes(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  // Larger requests belong on the FFI entry point, which fills the caller's
+  // buffer without copying it through the codec.
+  constexpr int32_t kMaxLength = 64 << 20;
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  const flutter::EncodableValue* value =
+      args ? FindArgument(*args, "length") : nullptr;
+  const auto* length = value ? std::get_if<int32_t>(value) : nullptr;
+  if (!length || *length < 0 || *length > kMaxLength) {
+    result->Error("BAD_ARGS", "length must be between 0 and 64 MiB");
+    return;
+  }
+  try {
+    std::vector<uint8_t> bytes(static_cast<size_t>(*length));
+    FillRandomBuffered(bytes.data(), bytes.size());
+    result->Success(flutter::EncodableValue(std::move(bytes)));
+  } catch (const std::exception& ex) {
+    result->Error("CNG_ERROR", ex.what());
+  }
+}
 
-    status = BCryptHashData(hHash, const_cast<PUCHAR>(data.data()),
-                            static_cast<ULONG>(data.size()), 0);
-    if (status != ERROR_SUCCESS) {
-      throw std::runtime_error("BCryptHashData failed");
+// ---------- Startup ----------
+std::vector<std::pair<std::string, std::shared_ptr<PluginFeature>>>
+FlutterNativeUtilsPlugin::PrewarmBackends() const {
+  std::vector<std::pair<std::string, std::shared_ptr<PluginFeature>>> backends;
+  for (std::string& backend : BackendHub::PrewarmableBackends()) {
+    backends.emplace_back(std::move(backend), nullptr);
+  }
+  backends.emplace_back("resourceSampler", nullptr);
+  for (const std::shared_ptr<PluginFeature>& feature : features_) {
+    for (std::string& backend : feature->PrewarmBackends()) {
+      backends.emplace_back(std::move(backend), feature);
     }
+  }
+  return backends;
+}
 
-    status = BCryptFinishHash(hHash, hash.data(), hashLen, 0);
-    if (status != ERROR_SUCCESS) {
-      throw std::runtime_error("BCryptFinishHash failed");
+void FlutterNativeUtilsPlugin::HandlePrewarm(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto known = PrewarmBackends();
+  std::vector<std::pair<std::string, std::shared_ptr<PluginFeature>>> backends;
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  const flutter::EncodableValue* list =
+      args ? FindArgument(*args, "backends") : nullptr;
+  if (list && !list->IsNull()) {
+    const auto* names = std::get_if<flutter::EncodableList>(list);
+    if (!names) {
+      result->Error("BAD_ARGS", "backends must be a list of names");
+      return;
     }
-
-    BCRYPT_PKCS1_PADDING_INFO paddingInfo;
-    paddingInfo.pszAlgId = BCRYPT_SHA256_ALGORITHM; // correct value
-
-    // Query signature size
-    DWORD sigLen = 0;
-    status = NCryptSignHash(hKey, &paddingInfo, hash.data(), hashLen,
-                            nullptr, 0, &sigLen, BCRYPT_PAD_PKCS1);
-    if (status != ERROR_SUCCESS) {
-      throw std::runtime_error("NCryptSignHash (size query) failed");
+    for (const flutter::EncodableValue& name : *names) {
+      const auto* text = std::get_if<std::string>(&name);
+      auto it = std::find_if(known.begin(), known.end(), [text](const auto& k) {
+        return text && k.first == *text;
+      });
+      if (it == known.end()) {
+        // Also the answer for backends of features left out of the build.
+        result->Error("BAD_ARGS", "Unknown backend: " +
+                                      (text ? *text : std::string("?")));
+        return;
+      }
+      backends.push_back(*it);
     }
+  } else {
+    backends = known;
+  }
+  if (!task_runner_) {
+    result->Error("UNAVAILABLE", "Prewarm requires a registrar");
+    return;
+  }
 
-    std::vector<uint8_t> signature(sigLen);
-
-    // Perform signature
-    status = NCryptSignHash(hKey, &paddingInfo, hash.data(), hashLen,
-                            signature.data(), sigLen, &sigLen, BCRYPT_PAD_PKCS1);
-    if (status != ERROR_SUCCESS) {
-      throw std::runtime_error("NCryptSignHash failed");
+  WorkerPool* pool = nullptr;
+  try {
+    pool = hub_->workers(StartupPhase::kPrewarm);
+  } catch (const std::exception& ex) {
+    result->Error("FAILURE", ex.what());
+    return;
+  }
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result =
+      std::move(result);
+  // Everything is built on one bulk worker task, off the platform thread.
+  // Failures are recorded on the timeline; the backend is retried on first
+  // use.
+  // The hub outlives every task on its pool, so it is not kept alive here.
+  pool->Post([this, hub = hub_.get(), route = route_, backends,
+              shared_result]() {
+    // Run on the platform thread, which owns the features' state.
+    std::vector<std::function<void()>> adopt;
+    for (const auto& [backend, feature] : backends) {
+      try {
+        if (feature) {
+          if (auto task = feature->Prewarm(backend)) {
+            adopt.push_back(std::move(task));
+          }
+        } else if (backend == "resourceSampler") {
+          // Belongs to this engine, which may be closing meanwhile.
+          EngineRoute::Hold hold = route->Enter();
+          if (!hold) continue;
+          sampler_.Get(StartupPhase::kPrewarm);
+        } else {
+          hub->Prewarm(backend);
+        }
+      } catch (const std::exception&) {
+        // Already on the timeline.
+      }
     }
+    route->Post([adopt = std::move(adopt), shared_result]() {
+      for (const std::function<void()>& task : adopt) task();
+      shared_result->Success();
+    });
+  }, TaskPriority::kBulk);
+}
 
-    signature.resize(sigLen);
-
-    if (hHash) BCryptDestroyHash(hHash);
-    if (hAlgSha) BCryptCloseAlgorithmProvider(hAlgSha, 0);
-    if (hKey) NCryptFreeObject(hKey);
-    if (hProvider) NCryptFreeObject(hProvider);
+void FlutterNativeUtilsPlugin::HandleGetStartupTimeline(
+    const flutter::MethodCall<flutter::EncodableValue>&,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  flutter::EncodableList events;
+  for (const StartupEvent& event : hub_->timeline().events()) {
+    events.push_back(flutter::EncodableValue(flutter::EncodableMap{
+        {flutter::EncodableValue("backend"), flutter::EncodableValue(event.backend)},
+        {flutter::EncodableValue("phase"),
+         flutter::EncodableValue(StartupPhaseName(event.phase))},
+        {flutter::EncodableValue("startUs"), flutter::EncodableValue(event.start_us)},
+        {flutter::EncodableValue("durationUs"),
+         flutter::EncodableValue(event.duration_us)},
+        {flutter::EncodableValue("error"),
+         event.error.empty() ? flutter::EncodableValue()
+                             : flutter::EncodableValue(event.error)},
+    }));
+  }
+  result->Success(flutter::EncodableValue(std::move(events)));
+}
 
-    return signature;
-  } catch (...) {
-    if (hHash) BCryptDestroyHash(hHash);
-    if (hAlgSha) BCryptCloseAlgorithmProvider(hAlgSha, 0);
-    if (hKey) NCryptFreeObject(hKey);
-    if (hProvider) NCryptFreeObject(hProvider);
-    throw;
+void FlutterNativeUtilsPlugin::HandleGetSchedulerStats(
+    const flutter::MethodCall<flutter::EncodableValue>&,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  // A pool that was never created has nothing to report.
+  WorkerPool* pool = hub_->workers_if_created();
+  flutter::EncodableList classes;
+  for (size_t i = 0; i < kTaskPriorityCount; ++i) {
+    const TaskPriority priority = static_cast<TaskPriority>(i);
+    const TaskClassStats stats =
+        pool ? pool->stats(priority) : TaskClassStats();
+    classes.push_back(flutter::EncodableValue(flutter::EncodableMap{
+        {flutter::EncodableValue("priority"),
+         flutter::EncodableValue(TaskPriorityName(priority))},
+        {flutter::EncodableValue("queued"),
+         flutter::EncodableValue(static_cast<int64_t>(stats.queued))},
+        {flutter::EncodableValue("running"),
+         flutter::EncodableValue(static_cast<int64_t>(stats.running))},
+        {flutter::EncodableValue("started"),
+         flutter::EncodableValue(static_cast<int64_t>(stats.started))},
+        {flutter::EncodableValue("promoted"),
+         flutter::EncodableValue(static_cast<int64_t>(stats.promoted))},
+        {flutter::EncodableValue("totalWaitUs"),
+         flutter::EncodableValue(stats.total_wait_us)},
+        {flutter::EncodableValue("maxWaitUs"),
+         flutter::EncodableValue(stats.max_wait_us)},
+        {flutter::EncodableValue("p50WaitUs"),
+         flutter::EncodableValue(stats.p50_wait_us)},
+        {flutter::EncodableValue("p99WaitUs"),
+         flutter::EncodableValue(stats.p99_wait_us)},
+    }));
   }
+  result->Success(flutter::EncodableValue(std::move(classes)));
 }
 
-void HandleSignNonce(
+// ---------- Allocation stats ----------
+void FlutterNativeUtilsPlugin::HandleGetAllocationStats(
     const flutter::MethodCall<flutter::EncodableValue>& call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  try {
-    const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
-    if (!args) throw std::runtime_error("Invalid arguments");
+  bool reset = false;
+  if (const auto* args = std::get_if<flutter::EncodableMap>(call.arguments())) {
+    if (const flutter::EncodableValue* value = FindArgument(*args, "reset")) {
+      const auto* flag = std::get_if<bool>(value);
+      if (!flag) {
+        result->Error("BAD_ARGS", "reset must be a bool");
+        return;
+      }
+      reset = *flag;
+    }
+  }
+  if (!AllocationTrackingEnabled()) {
+    result->Error("UNAVAILABLE",
+                  "Built without FLUTTER_NATIVE_UTILS_ALLOCATION_STATS");
+    return;
+  }
+  // Totals are process-wide: every engine's calls are counted together.
+  std::vector<MethodAllocationStats> snapshot = AllocationStatsSnapshot();
+  if (reset) ResetAllocationStats();
+  flutter::EncodableList methods;
+  methods.reserve(snapshot.size());
+  for (const MethodAllocationStats& stats : snapshot) {
+    methods.push_back(flutter::EncodableValue(flutter::EncodableMap{
+        {flutter::EncodableValue("method"), flutter::EncodableValue(stats.method)},
+        {flutter::EncodableValue("calls"),
+         flutter::EncodableValue(static_cast<int64_t>(stats.calls))},
+        {flutter::EncodableValue("allocations"),
+         flutter::EncodableValue(static_cast<int64_t>(stats.allocations))},
+        {flutter::EncodableValue("bytes"),
+         flutter::EncodableValue(static_cast<int64_t>(stats.bytes))},
+        {flutter::EncodableValue("peakBytes"),
+         flutter::EncodableValue(static_cast<int64_t>(stats.peak_bytes))},
+    }));
+  }
+  result->Success(flutter::EncodableValue(std::move(methods)));
+}
 
-    auto keyIt = args->find(flutter::EncodableValue("keyName"));
-    auto nonceIt = args->find(flutter::EncodableValue("nonce"));
-    if (keyIt == args->end() || nonceIt == args->end())
-      throw std::runtime_error("Missing arguments");
+// ---------- Call recording ----------
 
-    std::wstring keyName = Utf8ToWide(std::get<std::string>(keyIt->second));
-    std::vector<uint8_t> nonce = std::get<std::vector<uint8_t>>(nonceIt->second);
+// Size of |value| as the standard codec would put it on the channel.
+static uint64_t EncodedSize(const flutter::EncodableValue* value) {
+  if (!value) return 0;
+  auto encoded =
+      flutter::StandardMessageCodec::GetInstance().EncodeMessage(*value);
+  return encoded ? encoded->size() : 0;
+}
 
-    auto signature = SignWithKey(keyName, nonce);
-    result->Success(flutter::EncodableValue(signature));
-  } catch (const std::exception& ex) {
-    result->Error("CNG_ERROR", ex.what());
+// Forwards to |inner| and records the call once it completes, however late
+// and on whichever thread that happens.
+class RecordingMethodResult
+    : public flutter::MethodResult<flutter::EncodableValue> {
+ public:
+  RecordingMethodResult(
+      MethodCallRecorder* recorder,
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> inner)
+      : recorder_(recorder),
+        method_(call.method_name()),
+        start_us_(recorder->Now()),
+        inner_(std::move(inner)) {
+    if (call.arguments()) {
+      auto encoded = flutter::StandardMessageCodec::GetInstance().EncodeMessage(
+          *call.arguments());
+      if (encoded) arguments_ = std::move(*encoded);
+    }
   }
-}
 
-// ---------- GetCertificate ----------
-static std::wstring GetCertificate(const std::string& thumbprint, 
-                                   std::vector<BYTE>& certBytes,
-                                   const std::string& password) {
-  HCERTSTORE hStore = CertOpenStore(
-      CERT_STORE_PROV_SYSTEM,
-      0,
-      NULL,
-      CERT_SYSTEM_STORE_CURRENT_USER,
-      L"MY"
-  );
-
-  if (!hStore) {
-    return L"Failed to open certificate store.";
-  }
-
-  std::vector<BYTE> binaryThumbprint = HexStringToBytes(thumbprint);
-  
-  CRYPT_HASH_BLOB hashBlob;
-  hashBlob.cbData = static_cast<DWORD>(binaryThumbprint.size());
-  hashBlob.pbData = binaryThumbprint.data();
-
-  PCCERT_CONTEXT pCertContext = CertFindCertificateInStore(
-      hStore,
-      X509_ASN_ENCODING | PKCS_7_ASN_ENCODING,
-      0,
-      CERT_FIND_HASH,
-      &hashBlob,
-      NULL
-  );
-
-  if (!pCertContext) {
-    CertCloseStore(hStore, 0);
-    return L"Certificate not found.";
-  }
-
-  // Create a temporary memory store for PFX export
-  HCERTSTORE hMemStore = CertOpenStore(
-      CERT_STORE_PROV_MEMORY,
-      0,
-      NULL,
-      0,
-      NULL
-  );
-
-  if (!hMemStore) {
-    CertFreeCertificateContext(pCertContext);
-    CertCloseStore(hStore, 0);
-    return L"Failed to create memory store.";
-  }
-
-  // Add certificate with private key to memory store
-  if (!CertAddCertificateContextToStore(hMemStore, pCertContext, 
-                                        CERT_STORE_ADD_ALWAYS, NULL)) {
-    CertCloseStore(hMemStore, 0);
-    CertFreeCertificateContext(pCertContext);
-    CertCloseStore(hStore, 0);
-    return L"Failed to add certificate to memory store.";
-  }
-
-  // Convert password to wide string
-  std::wstring wPassword(password.begin(), password.end());
-
-  // Export as PFX
-  CRYPT_DATA_BLOB pfxBlob = { 0 };
-  pfxBlob.cbData = 0;
-  pfxBlob.pbData = NULL;
-
-  // Get required size
-  if (!PFXExportCertStoreEx(hMemStore, &pfxBlob, wPassword.c_str(), NULL,
-                            EXPORT_PRIVATE_KEYS)) {
-    CertCloseStore(hMemStore, 0);
-    CertFreeCertificateContext(pCertContext);
-    CertCloseStore(hStore, 0);
-    return L"Failed to get PFX size.";
-  }
-
-  // Allocate and export
-  certBytes.resize(pfxBlob.cbData);
-  pfxBlob.pbData = certBytes.data();
-
-  if (!PFXExportCertStoreEx(hMemStore, &pfxBlob, wPassword.c_str(), NULL,
-                            EXPORT_PRIVATE_KEYS)) {
-    CertCloseStore(hMemStore, 0);
-    CertFreeCertificateContext(pCertContext);
-    CertCloseStore(hStore, 0);
-    return L"Failed to export PFX.";
-  }
-
-  CertCloseStore(hMemStore, 0);
-  CertFreeCertificateContext(pCertContext);
-  CertCloseStore(hStore, 0);
-
-  return L"Success";
-}
+ protected:
+  void SuccessInternal(const flutter::EncodableValue* result) override {
+    Record(MethodCallOutcome::kSuccess, EncodedSize(result));
+    if (result) {
+      inner_->Success(*result);
+    } else {
+      inner_->Success();
+    }
+  }
 
-void HandleGetCertificate(
-    const flutter::MethodCall<flutter::EncodableValue>& call,
-    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  
-  const auto* arguments = std::get_if<flutter::EncodableMap>(call.arguments());
-  if (!arguments) {
-    result->Error("BAD_ARGS", "Invalid arguments");
-    return;
+  void ErrorInternal(const std::string& error_code,
+                     const std::string& error_message,
+                     const flutter::EncodableValue* error_details) override {
+    Record(MethodCallOutcome::kError,
+           error_code.size() + error_message.size() +
+               EncodedSize(error_details));
+    if (error_details) {
+      inner_->Error(error_code, error_message, *error_details);
+    } else {
+      inner_->Error(error_code, error_message);
+    }
   }
 
-  auto thumbprint_it = arguments->find(flutter::EncodableValue("thumbprint"));
-  if (thumbprint_it == arguments->end()) {
-    result->Error("BAD_ARGS", "Missing thumbprint parameter");
-    return;
+  void NotImplementedInternal() override {
+    Record(MethodCallOutcome::kNotImplemented, 0);
+    inner_->NotImplemented();
   }
 
-  // Optional password parameter (empty string if not provided)
-  std::string password = "";
-  auto password_it = arguments->find(flutter::EncodableValue("password"));
-  if (password_it != arguments->end()) {
-    password = std::get<std::string>(password_it->second);
+ private:
+  void Record(MethodCallOutcome outcome, uint64_t result_bytes) {
+    recorder_->Record(method_, arguments_.data(), arguments_.size(), start_us_,
+                      outcome, result_bytes);
   }
 
-  std::string thumbprint = std::get<std::string>(thumbprint_it->second);
-  std::vector<BYTE> certBytes;
-  
-  std::wstring msg = GetCertificate(thumbprint, certBytes, password);
-  
-  if (msg == L"Success") {
-    flutter::EncodableMap certData;
-    certData[flutter::EncodableValue("certificate")] = 
-        flutter::EncodableValue(certBytes);
-    result->Success(flutter::EncodableValue(certData));
-  } else {
-    result->Error("FAILURE", WideToUtf8(msg));
+  MethodCallRecorder* recorder_;
+  std::string method_;
+  std::vector<uint8_t> arguments_;
+  int64_t start_us_;
+  std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> inner_;
+};
+
+// Hub options from the environment. FLUTTER_NATIVE_UTILS_CALL_LOG names a
+// file that receives every method call, for replay with
+// flutter_native_utils_replay.
+static BackendHubOptions PluginHubOptions() {
+  BackendHubOptions options;
+  wchar_t path[MAX_PATH];
+  DWORD len = GetEnvironmentVariableW(L"FLUTTER_NATIVE_UTILS_CALL_LOG", path,
+                                      MAX_PATH);
+  if (len > 0 && len < MAX_PATH) {
+    options.call_log_path = WideToUtf8(std::wstring(path, len));
   }
+  return options;
 }
 
 // ---------- Plugin Boilerplate ----------
 void FlutterNativeUtilsPlugin::RegisterWithRegistrar(
     flutter::PluginRegistrarWindows *registrar) {
+  // Later engines share the hub, so their registration starts now rather
+  // than at the start of its timeline. No backend is created here; they
+  // start on first use or in Prewarm.
+  // The hub is acquired once and handed to the plugin: released in between,
+  // the first engine's hub would be destroyed, and its call log reopened.
+  std::shared_ptr<BackendHub> hub = BackendHub::Acquire(PluginHubOptions());
+  const int64_t start = hub->timeline().Now();
+  auto plugin =
+      std::make_unique<FlutterNativeUtilsPlugin>(registrar, std::move(hub));
+
   auto channel = std::make_unique<flutter::MethodChannel<flutter::EncodableValue>>(
       registrar->messenger(), "flutter_native_utils",
       &flutter::StandardMethodCodec::GetInstance());
 
-  auto plugin = std::make_unique<FlutterNativeUtilsPlugin>();
-
   channel->SetMethodCallHandler(
       [plugin_pointer = plugin.get()](const auto& call, auto result) {
         plugin_pointer->HandleMethodCall(call, std::move(result));
       });
 
+  plugin->hub_->timeline().Record("plugin", StartupPhase::kRegistration, start);
   registrar->AddPlugin(std::move(plugin));
 }
 
-FlutterNativeUtilsPlugin::FlutterNativeUtilsPlugin() {}
-FlutterNativeUtilsPlugin::~FlutterNativeUtilsPlugin() {}
+// Creates an event channel whose active sink is stored in |*sink| while Dart
+// listens.
+static std::unique_ptr<flutter::EventChannel<flutter::EncodableValue>>
+CreateEventChannel(
+    flutter::PluginRegistrarWindows* registrar, const std::string& name,
+    std::unique_ptr<flutter::EventSink<flutter::EncodableValue>>* sink) {
+  auto channel = std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+      registrar->messenger(), name, &flutter::StandardMethodCodec::GetInstance());
+  channel->SetStreamHandler(
+      std::make_unique<flutter::StreamHandlerFunctions<flutter::EncodableValue>>(
+          [sink](const flutter::EncodableValue*,
+                 std::unique_ptr<flutter::EventSink<flutter::EncodableValue>>&&
+                     events)
+              -> std::unique_ptr<
+                  flutter::StreamHandlerError<flutter::EncodableValue>> {
+            *sink = std::move(events);
+            return nullptr;
+          },
+          [sink](const flutter::EncodableValue*)
+              -> std::unique_ptr<
+                  flutter::StreamHandlerError<flutter::EncodableValue>> {
+            sink->reset();
+            return nullptr;
+          }));
+  return channel;
+}
+
+FlutterNativeUtilsPlugin::FlutterNativeUtilsPlugin()
+    : FlutterNativeUtilsPlugin(nullptr) {}
+
+FlutterNativeUtilsPlugin::FlutterNativeUtilsPlugin(
+    flutter::PluginRegistrarWindows* registrar)
+    : FlutterNativeUtilsPlugin(registrar,
+                               BackendHub::Acquire(PluginHubOptions())) {}
+
+FlutterNativeUtilsPlugin::FlutterNativeUtilsPlugin(
+    flutter::PluginRegistrarWindows* registrar,
+    std::shared_ptr<BackendHub> hub)
+    : FlutterNativeUtilsPlugin(registrar, std::move(hub), nullptr) {}
+
+FlutterNativeUtilsPlugin::FlutterNativeUtilsPlugin(
+    std::shared_ptr<BackendHub> hub, EngineRoute::Poster poster)
+    : FlutterNativeUtilsPlugin(nullptr, std::move(hub), std::move(poster)) {}
+
+FlutterNativeUtilsPlugin::FlutterNativeUtilsPlugin(
+    flutter::PluginRegistrarWindows* registrar,
+    std::shared_ptr<BackendHub> hub, EngineRoute::Poster poster)
+    // Every engine in the process shares the hub's backends. The sampler
+    // stays per engine: each one starts, stops and drains its own.
+    : hub_(std::move(hub)),
+      sampler_("resourceSampler", &hub_->timeline(), []() {
+        return std::make_unique<ResourceSampler>(CreateDefaultResourceBackend());
+      }) {
+  if (registrar) {
+    task_runner_ = std::make_unique<PlatformTaskRunner>(registrar);
+    poster = [runner = task_runner_.get()](std::function<void()> task) {
+      runner->PostTask(std::move(task));
+    };
+
+    sample_channel_ = CreateEventChannel(
+        registrar, "flutter_native_utils/resource_samples", &sample_sink_);
+    hash_progress_channel_ = CreateEventChannel(
+        registrar, "flutter_native_utils/hash_progress", &hash_progress_sink_);
+  }
+  if (poster) route_ = EngineRoute::Create(std::move(poster));
+
+  // Compiled in per FLUTTER_NATIVE_UTILS_FEATURE_* option; a feature left
+  // out registers nothing, so its methods report NotImplemented.
+  const FeatureContext context{hub_.get(), route_};
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE
+  features_.push_back(CreateHardwareFeature(context));
+#endif
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+  features_.push_back(CreateKeyFeature(context));
+#endif
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+  features_.push_back(CreateCertificateFeature(context));
+#endif
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_RESTART
+  features_.push_back(CreateRestartFeature(context));
+#endif
+  RegisterHandlers();
+}
+
+FlutterNativeUtilsPlugin::~FlutterNativeUtilsPlugin() {
+  // Work on the shared pool may outlive this engine; cut it off before the
+  // task runner it posts to goes away. The sampler and the features'
+  // threads are ours to join.
+  if (route_) route_->Close();
+  sampler_.Close();
+  for (const std::shared_ptr<PluginFeature>& feature : features_) {
+    feature->Close();
+  }
+  task_runner_.reset();
+  // Releasing hub_ joins the shared pool if this was the last engine.
+}
+
+void FlutterNativeUtilsPlugin::RegisterHandlers() {
+  handlers_ = {
+      // These return quickly or offload their own work. Each feature adds
+      // its methods below.
+      {"GetRandomBytes", HandleGetRandomBytes},
+      {"StartResourceSampler",
+       [this](const auto& call, auto result) {
+         HandleStartResourceSampler(call, std::move(result));
+       }},
+      {"StopResourceSampler",
+       [this](const auto& call, auto result) {
+         HandleStopResourceSampler(call, std::move(result));
+       }},
+      {"HashFiles",
+       [this](const auto& call, auto result) {
+         HandleHashFiles(call, std::move(result));
+       }},
+      {"VerifyManifest",
+       [this](const auto& call, auto result) {
+         HandleVerifyManifest(call, std::move(result));
+       }},
+      {"ImportPublicKey",
+       [this](const auto& call, auto result) {
+         HandleImportPublicKey(call, std::move(result));
+       }},
+      {"RemovePublicKey",
+       [this](const auto& call, auto result) {
+         HandleRemovePublicKey(call, std::move(result));
+       }},
+      {"VerifySignatures",
+       [this](const auto& call, auto result) {
+         HandleVerifySignatures(call, std::move(result));
+       }},
+      {"Prewarm",
+       [this](const auto& call, auto result) {
+         HandlePrewarm(call, std::move(result));
+       }},
+      {"GetStartupTimeline",
+       [this](const auto& call, auto result) {
+         HandleGetStartupTimeline(call, std::move(result));
+       }},
+      {"GetSchedulerStats",
+       [this](const auto& call, auto result) {
+         HandleGetSchedulerStats(call, std::move(result));
+       }},
+      {"GetAllocationStats",
+       [this](const auto& call, auto result) {
+         HandleGetAllocationStats(call, std::move(result));
+       }},
+  };
+  for (const std::shared_ptr<PluginFeature>& feature : features_) {
+    feature->Register(&handlers_);
+  }
+}
 
 void FlutterNativeUtilsPlugin::HandleMethodCall(
     const flutter::MethodCall<flutter::EncodableValue>& call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  using Handler = std::function<void(
-      const flutter::MethodCall<flutter::EncodableValue>&,
-      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>)>;
-
-  static const std::unordered_map<std::string, Handler> handlers = {
-      {"RequestAppRestart", HandleRequestAppRestart},
-      {"RequestHardwareInfo", HandleRequestHardwareInfo},
-      {"CreateKeyPair", HandleCreateKeyPair},
-      {"SignNonce", HandleSignNonce},
-      {"GetCertificate", HandleGetCertificate},
-  };
-
-  auto it = handlers.find(call.method_name());
-  if (it != handlers.end()) {
+  if (MethodCallRecorder* recorder = hub_->call_recorder()) {
+    result = std::make_unique<RecordingMethodResult>(recorder, call,
+                                                     std::move(result));
+  }
+  auto it = handlers_.find(call.method_name());
+  if (it != handlers_.end()) {
+    // Counts nothing unless allocation_hooks.cpp is linked in.
+    AllocationScope scope(call.method_name());
     it->second(call, std::move(result));
   } else {
     result->NotImplemented();
@@ -1,19 +1,51 @@
 #ifndef FLUTTER_PLUGIN_FLUTTER_NATIVE_UTILS_PLUGIN_H_
 #define FLUTTER_PLUGIN_FLUTTER_NATIVE_UTILS_PLUGIN_H_
 
+#include <flutter/encodable_value.h>
+#include <flutter/event_channel.h>
+#include <flutter/event_sink.h>
 #include <flutter/method_channel.h>
 #include <flutter/plugin_registrar_windows.h>
 
+#include <functional>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "backend_hub.h"
+#include "plugin_feature.h"
+#include "signature_verifier.h"
+#include "startup_timeline.h"
 
 namespace flutter_native_utils {
 
+class PlatformTaskRunner;
+class ResourceSampler;
+struct ResourceSample;
+
 class FlutterNativeUtilsPlugin : public flutter::Plugin {
  public:
   static void RegisterWithRegistrar(flutter::PluginRegistrarWindows *registrar);
 
+  // Creates a plugin without a registrar. Methods that need to deliver
+  // results from background threads (e.g. the resource sampler) report
+  // UNAVAILABLE in this mode; it is mainly useful for unit tests.
   FlutterNativeUtilsPlugin();
 
+  explicit FlutterNativeUtilsPlugin(flutter::PluginRegistrarWindows* registrar);
+
+  // Uses |hub|, which the caller already acquired, instead of acquiring it.
+  FlutterNativeUtilsPlugin(flutter::PluginRegistrarWindows* registrar,
+                           std::shared_ptr<BackendHub> hub);
+
+  // Creates a plugin without a registrar whose features deliver results
+  // from background threads through |poster| rather than a platform thread,
+  // so tests can run their methods. The plugin's own methods that need a
+  // registrar still report UNAVAILABLE.
+  FlutterNativeUtilsPlugin(std::shared_ptr<BackendHub> hub,
+                           EngineRoute::Poster poster);
+
   virtual ~FlutterNativeUtilsPlugin();
 
   // Disallow copy and assign.
@@ -24,6 +56,95 @@ class FlutterNativeUtilsPlugin : public flutter::Plugin {
   void HandleMethodCall(
       const flutter::MethodCall<flutter::EncodableValue> &method_call,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+ private:
+  FlutterNativeUtilsPlugin(flutter::PluginRegistrarWindows* registrar,
+                           std::shared_ptr<BackendHub> hub,
+                           EngineRoute::Poster poster);
+
+  void RegisterHandlers();
+
+  // ---------- Scheduling ----------
+  void HandleGetSchedulerStats(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // ---------- Allocation stats ----------
+  void HandleGetAllocationStats(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // ---------- Resource sampler ----------
+  void HandleStartResourceSampler(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleStopResourceSampler(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  // Runs on the platform thread; drains queued samples into the event sink.
+  void FlushResourceSamples();
+
+  // ---------- File hashing ----------
+  void HandleHashFiles(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleVerifyManifest(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  FileHasher* hasher();
+
+  // ---------- Signature verification ----------
+  void HandleImportPublicKey(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleRemovePublicKey(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleVerifySignatures(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // ---------- Startup ----------
+  // Backends Prewarm accepts, each with the feature that owns it; null for
+  // the hub's backends and the sampler.
+  std::vector<std::pair<std::string, std::shared_ptr<PluginFeature>>>
+  PrewarmBackends() const;
+  void HandlePrewarm(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleGetStartupTimeline(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Shared by all background work of every engine; created on first use.
+  WorkerPool* workers();
+
+  // Declared first: the per-engine backends record on its timeline too, and
+  // the features keep a pointer to it.
+  std::shared_ptr<BackendHub> hub_;
+
+  MethodRegistry handlers_;
+  std::unique_ptr<PlatformTaskRunner> task_runner_;
+  // Delivers results of work on the shared backends to this engine; null
+  // without a registrar.
+  std::shared_ptr<EngineRoute> route_;
+
+  std::unique_ptr<flutter::EventChannel<flutter::EncodableValue>>
+      sample_channel_;
+  std::unique_ptr<flutter::EventSink<flutter::EncodableValue>> sample_sink_;
+  LazyBackend<ResourceSampler> sampler_;
+  std::vector<ResourceSample> sample_scratch_;
+
+  std::unique_ptr<flutter::EventChannel<flutter::EncodableValue>>
+      hash_progress_channel_;
+  std::unique_ptr<flutter::EventSink<flutter::EncodableValue>>
+      hash_progress_sink_;
+
+  PublicKeyTable public_keys_;
+
+  // One of each feature enabled in this build. Shared so that a Prewarm
+  // task can keep its feature alive past the engine.
+  std::vector<std::shared_ptr<PluginFeature>> features_;
 };
 
 }  // namespace flutter_native_utils
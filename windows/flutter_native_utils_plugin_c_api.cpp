@@ -2,6 +2,9 @@
 
 #include <flutter/plugin_registrar_windows.h>
 
+#include <exception>
+
+#include "buffered_random.h"
 #include "flutter_native_utils_plugin.h"
 
 void FlutterNativeUtilsPluginCApiRegisterWithRegistrar(
@@ -10,3 +13,12 @@ void FlutterNativeUtilsPluginCApiRegisterWithRegistrar(
       flutter::PluginRegistrarManager::GetInstance()
           ->GetRegistrar<flutter::PluginRegistrarWindows>(registrar));
 }
+
+int32_t FlutterNativeUtilsFillRandom(uint8_t* buffer, size_t length) {
+  try {
+    flutter_native_utils::FillRandomBuffered(buffer, length);
+    return 0;
+  } catch (const std::exception&) {
+    return -1;
+  }
+}
@@ -0,0 +1,576 @@
+#include "plugin_feature.h"
+
+#include <windows.h>
+
+#include <flutter/encodable_value.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "affine_executor.h"
+#include "cpu_topology.h"
+#include "device_fingerprint.h"
+#include "inventory.h"
+#include "startup_timeline.h"
+#include "wmi_session.h"
+
+namespace flutter_native_utils {
+
+// ---------- Hardware Info (WMI) ----------
+
+static flutter::EncodableMap QueryHardwareInfo(WmiSession& wmi) {
+  std::string cpuId = wmi.Query("Win32_Processor", "ProcessorId");
+  std::string boardId = wmi.Query("Win32_BaseBoard", "SerialNumber");
+  return {
+      {flutter::EncodableValue("systemCpuId"), flutter::EncodableValue(cpuId)},
+      {flutter::EncodableValue("systemBoardId"), flutter::EncodableValue(boardId)}};
+}
+
+// Outcome of a task on the WMI thread, carried back to the platform thread.
+struct WmiReply {
+  flutter::EncodableValue value;
+  std::string error_code;
+  std::string error;
+};
+
+static void SendWmiReply(flutter::MethodResult<flutter::EncodableValue>& result,
+                         const WmiReply& reply) {
+  if (reply.error_code.empty()) {
+    result.Success(reply.value);
+  } else {
+    result.Error(reply.error_code, reply.error);
+  }
+}
+
+class HardwareFeature : public PluginFeature {
+ public:
+  explicit HardwareFeature(const FeatureContext& context)
+      : context_(context), inventory_owner_(next_inventory_owner_++) {}
+
+  void Register(MethodRegistry* registry) override;
+  void Close() override;
+
+ private:
+  // Runs |task| on the hub's WMI thread and completes |result| with its
+  // value on the platform thread. std::invalid_argument from |task| is
+  // reported as BAD_ARGS and other exceptions as FAILURE.
+  void RunOnWmiThread(
+      std::function<flutter::EncodableValue(WmiSession&)> task,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleRequestHardwareInfo(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  // Reads the identifiers on the hub's workers, not the WMI thread.
+  void HandleGetDeviceFingerprint(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  // Paged inventory queries; cursors live on the WMI thread, per engine.
+  void HandleQueryInventory(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleNextInventoryPage(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleCloseInventoryQuery(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  static std::atomic<int64_t> next_inventory_owner_;
+
+  FeatureContext context_;
+  // Keys this engine's cursors in the shared WmiSession.
+  const int64_t inventory_owner_;
+};
+
+std::atomic<int64_t> HardwareFeature::next_inventory_owner_{1};
+
+void HardwareFeature::Close() {
+  // Only if some engine started the WMI thread; the cursors go with it.
+  if (AffineExecutor<WmiSession>* wmi = context_.hub->wmi_if_created()) {
+    wmi->Submit([owner = inventory_owner_](WmiSession& session) {
+      session.CloseInventory(owner);
+    });
+  }
+}
+
+void HardwareFeature::RunOnWmiThread(
+    std::function<flutter::EncodableValue(WmiSession&)> task,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  AffineExecutor<WmiSession>* wmi;
+  try {
+    wmi = context_.hub->wmi();
+  } catch (const std::exception& ex) {
+    result->Error("FAILURE", ex.what());
+    return;
+  }
+  auto run = [task = std::move(task)](WmiSession& session) {
+    WmiReply reply;
+    try {
+      reply.value = task(session);
+    } catch (const std::invalid_argument& ex) {
+      reply.error_code = "BAD_ARGS";
+      reply.error = ex.what();
+    } catch (const std::exception& ex) {
+      reply.error_code = "FAILURE";
+      reply.error = ex.what();
+    }
+    return reply;
+  };
+  if (!context_.route) {
+    // Without a registrar there is nowhere to post the answer, so wait.
+    try {
+      SendWmiReply(*result, wmi->Submit(run).get());
+    } catch (const std::exception& ex) {
+      result->Error("FAILURE", ex.what());
+    }
+    return;
+  }
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result =
+      std::move(result);
+  wmi->Submit([route = context_.route, shared_result,
+               run](WmiSession& session) {
+    auto reply = std::make_shared<WmiReply>(run(session));
+    route->Post([shared_result, reply]() { SendWmiReply(*shared_result, *reply); });
+  });
+}
+
+void HardwareFeature::HandleRequestHardwareInfo(
+    const flutter::MethodCall<flutter::EncodableValue>&,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  RunOnWmiThread(
+      [](WmiSession& session) {
+        return flutter::EncodableValue(QueryHardwareInfo(session));
+      },
+      std::move(result));
+}
+
+// ---------- CPU Topology ----------
+static flutter::EncodableList ProcessorList(const std::vector<uint32_t>& cpus) {
+  flutter::EncodableList list;
+  list.reserve(cpus.size());
+  for (uint32_t cpu : cpus) {
+    list.push_back(flutter::EncodableValue(static_cast<int32_t>(cpu)));
+  }
+  return list;
+}
+
+static void HandleRequestCpuTopology(
+    const flutter::MethodCall<flutter::EncodableValue>&,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  // Computed once per process; later calls only re-encode the cached value.
+  const CpuTopology& topology = GetCpuTopology();
+
+  flutter::EncodableList cores;
+  for (const CpuCore& core : topology.cores) {
+    cores.push_back(flutter::EncodableValue(flutter::EncodableMap{
+        {flutter::EncodableValue("logicalProcessors"),
+         flutter::EncodableValue(ProcessorList(core.logical_processors))},
+        {flutter::EncodableValue("type"),
+         flutter::EncodableValue(core.type == CpuCoreType::kPerformance
+                                     ? "performance"
+                                     : "efficiency")},
+        {flutter::EncodableValue("efficiencyClass"),
+         flutter::EncodableValue(static_cast<int32_t>(core.efficiency_class))},
+    }));
+  }
+
+  flutter::EncodableList caches;
+  for (const CpuCache& cache : topology.caches) {
+    caches.push_back(flutter::EncodableValue(flutter::EncodableMap{
+        {flutter::EncodableValue("level"),
+         flutter::EncodableValue(static_cast<int32_t>(cache.level))},
+        {flutter::EncodableValue("type"), flutter::EncodableValue(cache.type)},
+        {flutter::EncodableValue("sizeBytes"),
+         flutter::EncodableValue(static_cast<int64_t>(cache.size_bytes))},
+        {flutter::EncodableValue("lineSize"),
+         flutter::EncodableValue(static_cast<int32_t>(cache.line_size))},
+        {flutter::EncodableValue("instances"),
+         flutter::EncodableValue(static_cast<int32_t>(cache.instances))},
+        {flutter::EncodableValue("sharedBy"),
+         flutter::EncodableValue(static_cast<int32_t>(cache.shared_by))},
+    }));
+  }
+
+  flutter::EncodableList numa_nodes;
+  for (const NumaNode& node : topology.numa_nodes) {
+    numa_nodes.push_back(flutter::EncodableValue(flutter::EncodableMap{
+        {flutter::EncodableValue("node"),
+         flutter::EncodableValue(static_cast<int32_t>(node.node))},
+        {flutter::EncodableValue("logicalProcessors"),
+         flutter::EncodableValue(ProcessorList(node.logical_processors))},
+    }));
+  }
+
+  flutter::EncodableList simd_features;
+  for (const std::string& feature : topology.simd_features) {
+    simd_features.push_back(flutter::EncodableValue(feature));
+  }
+
+  flutter::EncodableMap response = {
+      {flutter::EncodableValue("packages"),
+       flutter::EncodableValue(static_cast<int32_t>(topology.packages))},
+      {flutter::EncodableValue("physicalCores"),
+       flutter::EncodableValue(static_cast<int32_t>(topology.physical_cores))},
+      {flutter::EncodableValue("logicalProcessors"),
+       flutter::EncodableValue(static_cast<int32_t>(topology.logical_processors))},
+      {flutter::EncodableValue("performanceCores"),
+       flutter::EncodableValue(static_cast<int32_t>(topology.performance_cores))},
+      {flutter::EncodableValue("efficiencyCores"),
+       flutter::EncodableValue(static_cast<int32_t>(topology.efficiency_cores))},
+      {flutter::EncodableValue("cores"), flutter::EncodableValue(cores)},
+      {flutter::EncodableValue("caches"), flutter::EncodableValue(caches)},
+      {flutter::EncodableValue("numaNodes"), flutter::EncodableValue(numa_nodes)},
+      {flutter::EncodableValue("simdFeatures"), flutter::EncodableValue(simd_features)},
+  };
+  result->Success(flutter::EncodableValue(response));
+}
+
+// ---------- Device Fingerprint ----------
+struct FingerprintRequest {
+  std::vector<uint8_t> salt;
+  std::vector<std::string> identifiers;
+  // Component hashes of an earlier fingerprint to match against.
+  std::map<std::string, std::vector<uint8_t>> reference;
+  bool has_reference = false;
+  size_t threshold = 0;
+};
+
+// Parses the salt/identifiers/reference/threshold arguments. Throws
+// std::invalid_argument if they are malformed.
+static FingerprintRequest FingerprintRequestArgument(
+    const flutter::EncodableMap& args) {
+  FingerprintRequest request;
+  request.salt = BytesArgument(args, "salt", true);
+  if (request.salt.size() < kDeviceFingerprintMinSaltLen) {
+    throw std::invalid_argument(
+        "salt must be at least " +
+        std::to_string(kDeviceFingerprintMinSaltLen) + " bytes");
+  }
+
+  const std::vector<std::string>& known = DeviceIdentifierNames();
+  request.identifiers = known;
+  const flutter::EncodableValue* identifiers = FindArgument(args, "identifiers");
+  if (identifiers && !identifiers->IsNull()) {
+    const auto* list = std::get_if<flutter::EncodableList>(identifiers);
+    if (!list || list->empty()) {
+      throw std::invalid_argument("identifiers must be a non-empty list");
+    }
+    request.identifiers.clear();
+    for (const flutter::EncodableValue& item : *list) {
+      const auto* name = std::get_if<std::string>(&item);
+      if (!name || std::find(known.begin(), known.end(), *name) == known.end()) {
+        throw std::invalid_argument("Unknown device identifier");
+      }
+      request.identifiers.push_back(*name);
+    }
+  }
+
+  const flutter::EncodableValue* reference = FindArgument(args, "reference");
+  if (reference && !reference->IsNull()) {
+    const auto* map = std::get_if<flutter::EncodableMap>(reference);
+    if (!map) {
+      throw std::invalid_argument(
+          "reference must map identifier names to hashes");
+    }
+    for (const auto& [key, value] : *map) {
+      const auto* name = std::get_if<std::string>(&key);
+      if (!name) {
+        throw std::invalid_argument("reference keys must be identifier names");
+      }
+      // Identifiers missing at enrolment have no hash.
+      if (value.IsNull()) continue;
+      const auto* hash = std::get_if<std::vector<uint8_t>>(&value);
+      if (!hash) throw std::invalid_argument("reference hashes must be bytes");
+      request.reference[*name] = *hash;
+    }
+    request.has_reference = true;
+    // Tolerates one changed component by default, e.g. a replaced disk.
+    request.threshold =
+        request.reference.size() > 1 ? request.reference.size() - 1 : 1;
+  }
+
+  if (const flutter::EncodableValue* threshold =
+          FindArgument(args, "threshold")) {
+    const auto* count = std::get_if<int32_t>(threshold);
+    if (!count || *count <= 0) {
+      throw std::invalid_argument("threshold must be a positive integer");
+    }
+    if (!request.has_reference) {
+      throw std::invalid_argument("threshold needs a reference");
+    }
+    request.threshold = static_cast<size_t>(*count);
+  }
+  return request;
+}
+
+static flutter::EncodableValue DeviceFingerprintToValue(
+    const FingerprintRequest& request,
+    const std::vector<DeviceIdentifier>& identifiers) {
+  DeviceFingerprint fingerprint = ComputeDeviceFingerprint(
+      identifiers, request.salt.data(), request.salt.size());
+  flutter::EncodableMap components;
+  for (const DeviceFingerprintComponent& component : fingerprint.components) {
+    components[flutter::EncodableValue(component.name)] =
+        component.hash ? flutter::EncodableValue(std::vector<uint8_t>(
+                             component.hash->begin(), component.hash->end()))
+                       : flutter::EncodableValue();
+  }
+  flutter::EncodableMap response = {
+      {flutter::EncodableValue("digest"),
+       flutter::EncodableValue(std::vector<uint8_t>(fingerprint.digest.begin(),
+                                                    fingerprint.digest.end()))},
+      {flutter::EncodableValue("components"),
+       flutter::EncodableValue(std::move(components))},
+  };
+  if (request.has_reference) {
+    const size_t matching =
+        CountMatchingComponents(fingerprint, request.reference);
+    response[flutter::EncodableValue("matchingComponents")] =
+        flutter::EncodableValue(static_cast<int32_t>(matching));
+    response[flutter::EncodableValue("matches")] =
+        flutter::EncodableValue(matching >= request.threshold);
+  }
+  return flutter::EncodableValue(std::move(response));
+}
+
+void HardwareFeature::HandleGetDeviceFingerprint(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  if (!args) {
+    result->Error("BAD_ARGS", "Missing salt");
+    return;
+  }
+  auto request = std::make_shared<FingerprintRequest>();
+  try {
+    *request = FingerprintRequestArgument(*args);
+  } catch (const std::invalid_argument& ex) {
+    result->Error("BAD_ARGS", ex.what());
+    return;
+  }
+
+  std::shared_ptr<DeviceIdentifierSource> source =
+      CreateDefaultDeviceIdentifierSource();
+  WorkerPool* pool = nullptr;
+  try {
+    pool = context_.hub->workers();
+  } catch (const std::exception& ex) {
+    result->Error("FAILURE", ex.what());
+    return;
+  }
+  if (!context_.route) {
+    // Without a registrar there is nowhere to post the answer, so wait; the
+    // platform thread is not one of the pool's.
+    result->Success(DeviceFingerprintToValue(
+        *request, ReadDeviceIdentifiers(source, request->identifiers, pool)));
+    return;
+  }
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result =
+      std::move(result);
+  ReadDeviceIdentifiersAsync(
+      source, request->identifiers, pool,
+      [route = context_.route, shared_result,
+       request](std::vector<DeviceIdentifier> identifiers) {
+        auto value = std::make_shared<flutter::EncodableValue>(
+            DeviceFingerprintToValue(*request, identifiers));
+        route->Post(
+            [shared_result, value]() { shared_result->Success(*value); });
+      });
+}
+
+// ---------- Inventory ----------
+
+static InventoryValue InventoryFilterValue(const flutter::EncodableValue& value) {
+  if (value.IsNull()) return InventoryValue();
+  if (const auto* b = std::get_if<bool>(&value)) return *b;
+  if (const auto* i = std::get_if<int32_t>(&value)) return int64_t{*i};
+  if (const auto* i = std::get_if<int64_t>(&value)) return *i;
+  if (const auto* d = std::get_if<double>(&value)) return *d;
+  if (const auto* text = std::get_if<std::string>(&value)) return *text;
+  throw std::invalid_argument(
+      "filter values must be null, bool, int, double or string");
+}
+
+// Parses the class/columns/filter/pageSize arguments. Throws
+// std::invalid_argument if they are malformed.
+static InventoryQuery InventoryQueryArgument(const flutter::EncodableMap* args) {
+  InventoryQuery query;
+  const flutter::EncodableValue* class_name =
+      args ? FindArgument(*args, "class") : nullptr;
+  if (!class_name || !std::holds_alternative<std::string>(*class_name)) {
+    throw std::invalid_argument("Missing class");
+  }
+  query.class_name = std::get<std::string>(*class_name);
+
+  const flutter::EncodableValue* columns = FindArgument(*args, "columns");
+  const auto* column_list =
+      columns ? std::get_if<flutter::EncodableList>(columns) : nullptr;
+  if (!column_list) throw std::invalid_argument("Missing columns");
+  for (const flutter::EncodableValue& column : *column_list) {
+    const auto* name = std::get_if<std::string>(&column);
+    if (!name) throw std::invalid_argument("columns must be strings");
+    query.columns.push_back(*name);
+  }
+
+  if (const flutter::EncodableValue* filter = FindArgument(*args, "filter")) {
+    const auto* conditions = std::get_if<flutter::EncodableList>(filter);
+    if (!conditions) throw std::invalid_argument("filter must be a list");
+    for (const flutter::EncodableValue& entry : *conditions) {
+      const auto* map = std::get_if<flutter::EncodableMap>(&entry);
+      const flutter::EncodableValue* column =
+          map ? FindArgument(*map, "column") : nullptr;
+      const flutter::EncodableValue* op =
+          map ? FindArgument(*map, "op") : nullptr;
+      if (!column || !std::holds_alternative<std::string>(*column) || !op ||
+          !std::holds_alternative<std::string>(*op)) {
+        throw std::invalid_argument("filter entries need column and op");
+      }
+      InventoryCondition condition;
+      condition.column = std::get<std::string>(*column);
+      if (!ParseInventoryOperator(std::get<std::string>(*op), &condition.op)) {
+        throw std::invalid_argument("Unknown filter op: " +
+                                    std::get<std::string>(*op));
+      }
+      const flutter::EncodableValue* value = FindArgument(*map, "value");
+      if (value) condition.value = InventoryFilterValue(*value);
+      query.filter.push_back(std::move(condition));
+    }
+  }
+
+  if (const flutter::EncodableValue* page_size =
+          FindArgument(*args, "pageSize")) {
+    const auto* size = std::get_if<int32_t>(page_size);
+    if (!size || *size <= 0) {
+      throw std::invalid_argument("pageSize must be a positive integer");
+    }
+    query.page_size = static_cast<size_t>(*size);
+  }
+  return query;
+}
+
+// Returns the cursor argument, or 0 (never a valid cursor) if it is missing.
+static int64_t InventoryCursorArgument(const flutter::EncodableMap* args) {
+  const flutter::EncodableValue* value =
+      args ? FindArgument(*args, "cursor") : nullptr;
+  if (!value || !(std::holds_alternative<int32_t>(*value) ||
+                  std::holds_alternative<int64_t>(*value))) {
+    return 0;
+  }
+  return value->LongValue();
+}
+
+static flutter::EncodableValue EncodeInventoryValue(const InventoryValue& value) {
+  return std::visit(
+      [](const auto& v) -> flutter::EncodableValue {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, std::monostate>) {
+          return flutter::EncodableValue();
+        } else if constexpr (std::is_same_v<T, std::vector<std::string>>) {
+          flutter::EncodableList list;
+          list.reserve(v.size());
+          for (const std::string& item : v) {
+            list.push_back(flutter::EncodableValue(item));
+          }
+          return flutter::EncodableValue(std::move(list));
+        } else {
+          return flutter::EncodableValue(v);
+        }
+      },
+      value);
+}
+
+static flutter::EncodableValue EncodeInventoryPage(const InventoryPage& page) {
+  flutter::EncodableList rows;
+  rows.reserve(page.rows.size());
+  for (const InventoryRow& row : page.rows) {
+    flutter::EncodableList values;
+    values.reserve(row.size());
+    for (const InventoryValue& value : row) {
+      values.push_back(EncodeInventoryValue(value));
+    }
+    rows.push_back(flutter::EncodableValue(std::move(values)));
+  }
+  return flutter::EncodableValue(flutter::EncodableMap{
+      {flutter::EncodableValue("cursor"), flutter::EncodableValue(page.cursor)},
+      {flutter::EncodableValue("rows"), flutter::EncodableValue(std::move(rows))},
+      {flutter::EncodableValue("done"), flutter::EncodableValue(page.done)},
+  });
+}
+
+void HardwareFeature::HandleQueryInventory(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  InventoryQuery query;
+  try {
+    query = InventoryQueryArgument(
+        std::get_if<flutter::EncodableMap>(call.arguments()));
+  } catch (const std::invalid_argument& ex) {
+    result->Error("BAD_ARGS", ex.what());
+    return;
+  }
+  RunOnWmiThread(
+      [query, owner = inventory_owner_](WmiSession& session) {
+        return EncodeInventoryPage(session.inventory(owner).Start(query));
+      },
+      std::move(result));
+}
+
+void HardwareFeature::HandleNextInventoryPage(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const int64_t cursor = InventoryCursorArgument(
+      std::get_if<flutter::EncodableMap>(call.arguments()));
+  RunOnWmiThread(
+      [cursor, owner = inventory_owner_](WmiSession& session) {
+        return EncodeInventoryPage(session.inventory(owner).Next(cursor));
+      },
+      std::move(result));
+}
+
+void HardwareFeature::HandleCloseInventoryQuery(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const int64_t cursor = InventoryCursorArgument(
+      std::get_if<flutter::EncodableMap>(call.arguments()));
+  RunOnWmiThread(
+      [cursor, owner = inventory_owner_](WmiSession& session) {
+        return flutter::EncodableValue(session.inventory(owner).Close(cursor));
+      },
+      std::move(result));
+}
+
+// ---------- Registration ----------
+void HardwareFeature::Register(MethodRegistry* registry) {
+  (*registry)["RequestHardwareInfo"] = [this](const auto& call, auto result) {
+    HandleRequestHardwareInfo(call, std::move(result));
+  };
+  (*registry)["QueryInventory"] = [this](const auto& call, auto result) {
+    HandleQueryInventory(call, std::move(result));
+  };
+  (*registry)["NextInventoryPage"] = [this](const auto& call, auto result) {
+    HandleNextInventoryPage(call, std::move(result));
+  };
+  (*registry)["CloseInventoryQuery"] = [this](const auto& call, auto result) {
+    HandleCloseInventoryQuery(call, std::move(result));
+  };
+  (*registry)["RequestCpuTopology"] = HandleRequestCpuTopology;
+  (*registry)["GetDeviceFingerprint"] = [this](const auto& call,
+                                              auto result) {
+    HandleGetDeviceFingerprint(call, std::move(result));
+  };
+}
+
+std::shared_ptr<PluginFeature> CreateHardwareFeature(
+    const FeatureContext& context) {
+  return std::make_shared<HardwareFeature>(context);
+}
+
+}  // namespace flutter_native_utils
@@ -0,0 +1,67 @@
+#include "hmac.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "secure_buffer.h"
+
+namespace flutter_native_utils {
+
+HmacSha256::HmacSha256(const uint8_t* key, size_t key_len) {
+  uint8_t block[kSha256BlockLen] = {};
+  if (key_len > kSha256BlockLen) {
+    Sha256Digest digest = ComputeSha256(key, key_len);
+    std::memcpy(block, digest.data(), digest.size());
+  } else if (key_len > 0) {
+    std::memcpy(block, key, key_len);
+  }
+  uint8_t inner_key[kSha256BlockLen];
+  uint8_t outer_key[kSha256BlockLen];
+  for (size_t i = 0; i < kSha256BlockLen; ++i) {
+    inner_key[i] = block[i] ^ 0x36;
+    outer_key[i] = block[i] ^ 0x5c;
+  }
+  inner_.Update(inner_key, sizeof(inner_key));
+  outer_.Update(outer_key, sizeof(outer_key));
+  SecureZero(block, sizeof(block));
+  SecureZero(inner_key, sizeof(inner_key));
+  SecureZero(outer_key, sizeof(outer_key));
+}
+
+void HmacSha256::Update(const uint8_t* data, size_t len) {
+  inner_.Update(data, len);
+}
+
+Sha256Digest HmacSha256::Finish() {
+  Sha256Digest inner_digest = inner_.Finish();
+  outer_.Update(inner_digest.data(), inner_digest.size());
+  return outer_.Finish();
+}
+
+void HkdfSha256(const uint8_t* ikm, size_t ikm_len, const uint8_t* salt,
+                size_t salt_len, const uint8_t* info, size_t info_len,
+                uint8_t* out, size_t out_len) {
+  if (out_len > 255 * kSha256Len) {
+    throw std::invalid_argument("HKDF output too long");
+  }
+  HmacSha256 extract(salt, salt_len);
+  extract.Update(ikm, ikm_len);
+  Sha256Digest prk = extract.Finish();
+
+  Sha256Digest block;
+  for (uint8_t counter = 1; out_len > 0; ++counter) {
+    HmacSha256 expand(prk.data(), prk.size());
+    if (counter > 1) expand.Update(block.data(), block.size());
+    expand.Update(info, info_len);
+    expand.Update(&counter, 1);
+    block = expand.Finish();
+    size_t piece = out_len < block.size() ? out_len : block.size();
+    std::memcpy(out, block.data(), piece);
+    out += piece;
+    out_len -= piece;
+  }
+  SecureZero(prk.data(), prk.size());
+  SecureZero(block.data(), block.size());
+}
+
+}  // namespace flutter_native_utils
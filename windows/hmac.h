@@ -0,0 +1,45 @@
+#ifndef FLUTTER_PLUGIN_HMAC_H_
+#define FLUTTER_PLUGIN_HMAC_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "sha256.h"
+
+namespace flutter_native_utils {
+
+constexpr size_t kSha256BlockLen = 64;
+
+// Incremental HMAC-SHA256 (RFC 2104) on top of Sha256. The key is absorbed
+// at construction, so copying a fresh instance MACs another message without
+// repeating the key schedule.
+class HmacSha256 {
+ public:
+  HmacSha256(const uint8_t* key, size_t key_len);
+
+  // Copies the running state, key included.
+  HmacSha256(const HmacSha256& other) = default;
+
+  // Disallow assign.
+  HmacSha256& operator=(const HmacSha256&) = delete;
+
+  void Update(const uint8_t* data, size_t len);
+
+  // Finishes the MAC. The object must not be updated afterwards.
+  Sha256Digest Finish();
+
+ private:
+  Sha256 inner_;
+  // Has absorbed the outer key block; takes the inner digest in Finish.
+  Sha256 outer_;
+};
+
+// HKDF-SHA256 (RFC 5869) with a single extract and up to 255 * 32 bytes of
+// expanded output written to |out|.
+void HkdfSha256(const uint8_t* ikm, size_t ikm_len, const uint8_t* salt,
+                size_t salt_len, const uint8_t* info, size_t info_len,
+                uint8_t* out, size_t out_len);
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_HMAC_H_
@@ -0,0 +1,191 @@
+#include "hmac_session.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <bcrypt.h>
+
+#pragma comment(lib, "bcrypt.lib")
+#else
+#include <openssl/core_names.h>
+#include <openssl/evp.h>
+#include <openssl/params.h>
+#endif
+
+#include <cstring>
+#include <stdexcept>
+
+#include "hmac.h"
+
+namespace flutter_native_utils {
+
+namespace {
+
+constexpr size_t kMaxMacLen = 64;
+constexpr size_t kSha512MacLen = 64;
+
+#ifdef _WIN32
+// The HMAC provider is opened once per process, like the SHA-256 one.
+BCRYPT_ALG_HANDLE Sha512HmacProvider() {
+  static BCRYPT_ALG_HANDLE provider = [] {
+    BCRYPT_ALG_HANDLE handle = nullptr;
+    if (BCryptOpenAlgorithmProvider(&handle, BCRYPT_SHA512_ALGORITHM, nullptr,
+                                    BCRYPT_ALG_HANDLE_HMAC_FLAG) != 0) {
+      handle = nullptr;
+    }
+    return handle;
+  }();
+  return provider;
+}
+
+void* CreateSha512State(const uint8_t* key, size_t key_len) {
+  BCRYPT_ALG_HANDLE provider = Sha512HmacProvider();
+  BCRYPT_HASH_HANDLE hash = nullptr;
+  if (!provider ||
+      BCryptCreateHash(provider, &hash, nullptr, 0, const_cast<PUCHAR>(key),
+                       static_cast<ULONG>(key_len), 0) != 0) {
+    throw std::runtime_error("BCryptCreateHash (HMAC) failed");
+  }
+  return hash;
+}
+
+void FreeSha512State(void* state) {
+  if (state) BCryptDestroyHash(static_cast<BCRYPT_HASH_HANDLE>(state));
+}
+
+void ComputeSha512(void* state, const uint8_t* data, size_t len,
+                   uint8_t* out) {
+  BCRYPT_HASH_HANDLE hash = nullptr;
+  if (BCryptDuplicateHash(static_cast<BCRYPT_HASH_HANDLE>(state), &hash,
+                          nullptr, 0, 0) != 0) {
+    throw std::runtime_error("BCryptDuplicateHash failed");
+  }
+  NTSTATUS status = 0;
+  // BCryptHashData takes a 32-bit length.
+  constexpr size_t kMaxPiece = 1u << 30;
+  while (status == 0 && len > 0) {
+    size_t piece = len < kMaxPiece ? len : kMaxPiece;
+    status = BCryptHashData(hash, const_cast<PUCHAR>(data),
+                            static_cast<ULONG>(piece), 0);
+    data += piece;
+    len -= piece;
+  }
+  if (status == 0) status = BCryptFinishHash(hash, out, kSha512MacLen, 0);
+  BCryptDestroyHash(hash);
+  if (status != 0) throw std::runtime_error("HMAC computation failed");
+}
+#else
+EVP_MAC* HmacMac() {
+  static EVP_MAC* mac = EVP_MAC_fetch(nullptr, OSSL_MAC_NAME_HMAC, nullptr);
+  return mac;
+}
+
+void* CreateSha512State(const uint8_t* key, size_t key_len) {
+  OSSL_PARAM params[] = {
+      OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST,
+                                       const_cast<char*>("SHA512"), 0),
+      OSSL_PARAM_construct_end(),
+  };
+  EVP_MAC_CTX* context = HmacMac() ? EVP_MAC_CTX_new(HmacMac()) : nullptr;
+  if (!context || EVP_MAC_init(context, key, key_len, params) != 1) {
+    EVP_MAC_CTX_free(context);
+    throw std::runtime_error("EVP_MAC_init (HMAC) failed");
+  }
+  return context;
+}
+
+void FreeSha512State(void* state) {
+  EVP_MAC_CTX_free(static_cast<EVP_MAC_CTX*>(state));
+}
+
+void ComputeSha512(void* state, const uint8_t* data, size_t len,
+                   uint8_t* out) {
+  EVP_MAC_CTX* context = EVP_MAC_CTX_dup(static_cast<EVP_MAC_CTX*>(state));
+  size_t out_len = 0;
+  bool ok = context && EVP_MAC_update(context, data, len) == 1 &&
+            EVP_MAC_final(context, out, &out_len, kSha512MacLen) == 1;
+  EVP_MAC_CTX_free(context);
+  if (!ok) throw std::runtime_error("HMAC computation failed");
+}
+#endif
+
+}  // namespace
+
+bool ParseMacAlgorithm(const std::string& name, MacAlgorithm* algorithm) {
+  if (name == "sha256") {
+    *algorithm = MacAlgorithm::kHmacSha256;
+    return true;
+  }
+  if (name == "sha512") {
+    *algorithm = MacAlgorithm::kHmacSha512;
+    return true;
+  }
+  return false;
+}
+
+size_t MacLength(MacAlgorithm algorithm) {
+  return algorithm == MacAlgorithm::kHmacSha256 ? 32 : 64;
+}
+
+bool ConstantTimeEqual(const uint8_t* a, const uint8_t* b, size_t len) {
+  // volatile keeps the compiler from turning this into an early-exit loop.
+  volatile uint8_t diff = 0;
+  for (size_t i = 0; i < len; ++i) diff = diff | (a[i] ^ b[i]);
+  return diff == 0;
+}
+
+HmacSession::HmacSession(MacAlgorithm algorithm, const uint8_t* key,
+                         size_t key_len)
+    : algorithm_(algorithm) {
+  if (algorithm == MacAlgorithm::kHmacSha256) {
+    sha256_ = std::make_unique<HmacSha256>(key, key_len);
+  } else {
+    sha512_ = CreateSha512State(key, key_len);
+  }
+}
+
+HmacSession::~HmacSession() { FreeSha512State(sha512_); }
+
+void HmacSession::Compute(const uint8_t* data, size_t len,
+                          uint8_t* out) const {
+  if (!sha256_) {
+    ComputeSha512(sha512_, data, len, out);
+    return;
+  }
+  HmacSha256 mac(*sha256_);
+  mac.Update(data, len);
+  const Sha256Digest digest = mac.Finish();
+  std::memcpy(out, digest.data(), digest.size());
+}
+
+bool HmacSession::Verify(const uint8_t* data, size_t len, const uint8_t* mac,
+                         size_t mac_len) const {
+  uint8_t expected[kMaxMacLen];
+  Compute(data, len, expected);
+  return mac_len == this->mac_len() &&
+         ConstantTimeEqual(expected, mac, mac_len);
+}
+
+std::vector<uint8_t> HmacSession::ComputeBatch(
+    const std::vector<MacMessage>& messages) const {
+  std::vector<uint8_t> macs(messages.size() * mac_len());
+  for (size_t i = 0; i < messages.size(); ++i) {
+    Compute(messages[i].data, messages[i].len, macs.data() + i * mac_len());
+  }
+  return macs;
+}
+
+std::vector<bool> HmacSession::VerifyBatch(
+    const std::vector<MacMessage>& messages,
+    const std::vector<MacMessage>& macs) const {
+  if (messages.size() != macs.size()) {
+    throw std::invalid_argument("Message and MAC counts differ");
+  }
+  std::vector<bool> valid(messages.size());
+  for (size_t i = 0; i < messages.size(); ++i) {
+    valid[i] = Verify(messages[i].data, messages[i].len, macs[i].data,
+                      macs[i].len);
+  }
+  return valid;
+}
+
+}  // namespace flutter_native_utils
@@ -0,0 +1,77 @@
+#ifndef FLUTTER_PLUGIN_HMAC_SESSION_H_
+#define FLUTTER_PLUGIN_HMAC_SESSION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace flutter_native_utils {
+
+enum class MacAlgorithm { kHmacSha256, kHmacSha512 };
+
+// Accepts "sha256" and "sha512" (case-sensitive).
+bool ParseMacAlgorithm(const std::string& name, MacAlgorithm* algorithm);
+
+// Length in bytes of a MAC produced by |algorithm|.
+size_t MacLength(MacAlgorithm algorithm);
+
+// Compares |len| bytes in time independent of their contents.
+bool ConstantTimeEqual(const uint8_t* a, const uint8_t* b, size_t len);
+
+// A message referenced by a batch call; the bytes are not copied.
+struct MacMessage {
+  const uint8_t* data = nullptr;
+  size_t len = 0;
+};
+
+class HmacSha256;
+
+// An HMAC keyed once and reused for any number of messages. The keyed hash
+// state is built at construction and duplicated for each message, so the key
+// schedule (two compression-function calls) is not repeated per message.
+//
+// SHA-256 sessions copy a keyed HmacSha256; SHA-512 ones are backed by CNG on
+// Windows and OpenSSL libcrypto elsewhere. Const methods are safe to call
+// concurrently.
+class HmacSession {
+ public:
+  // Throws std::runtime_error if the provider cannot be initialised.
+  HmacSession(MacAlgorithm algorithm, const uint8_t* key, size_t key_len);
+  ~HmacSession();
+
+  // Disallow copy and assign.
+  HmacSession(const HmacSession&) = delete;
+  HmacSession& operator=(const HmacSession&) = delete;
+
+  MacAlgorithm algorithm() const { return algorithm_; }
+  size_t mac_len() const { return MacLength(algorithm_); }
+
+  // Writes mac_len() bytes to |out|.
+  void Compute(const uint8_t* data, size_t len, uint8_t* out) const;
+
+  // Returns true if |mac| is the MAC of |data|. A |mac_len| other than
+  // mac_len() never verifies; truncated MACs are not accepted.
+  bool Verify(const uint8_t* data, size_t len, const uint8_t* mac,
+              size_t mac_len) const;
+
+  // Returns the concatenated MACs of |messages|, mac_len() bytes each.
+  std::vector<uint8_t> ComputeBatch(
+      const std::vector<MacMessage>& messages) const;
+
+  // Verifies |messages[i]| against |macs[i]|. Every entry is checked, so the
+  // time taken does not reveal which one failed. Throws std::invalid_argument
+  // if the counts differ.
+  std::vector<bool> VerifyBatch(const std::vector<MacMessage>& messages,
+                                const std::vector<MacMessage>& macs) const;
+
+ private:
+  MacAlgorithm algorithm_;
+  std::unique_ptr<HmacSha256> sha256_;
+  void* sha512_ = nullptr;  // BCRYPT_HASH_HANDLE or EVP_MAC_CTX*.
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_HMAC_SESSION_H_
@@ -3,6 +3,9 @@
 
 #include <flutter_plugin_registrar.h>
 
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef FLUTTER_PLUGIN_IMPL
 #define FLUTTER_PLUGIN_EXPORT __declspec(dllexport)
 #else
@@ -16,6 +19,13 @@ extern "C" {
 FLUTTER_PLUGIN_EXPORT void FlutterNativeUtilsPluginCApiRegisterWithRegistrar(
     FlutterDesktopPluginRegistrarRef registrar);
 
+// Fills |buffer| with |length| cryptographically secure random bytes from the
+// calling thread's buffered generator. For dart:ffi callers that cannot
+// afford a platform-channel round trip. Returns 0 on success and -1 if the OS
+// CSPRNG failed.
+FLUTTER_PLUGIN_EXPORT int32_t FlutterNativeUtilsFillRandom(uint8_t* buffer,
+                                                           size_t length);
+
 #if defined(__cplusplus)
 }  // extern "C"
 #endif
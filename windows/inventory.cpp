@@ -0,0 +1,761 @@
+#include "inventory.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include <Wbemidl.h>
+#include <comdef.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <locale>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace flutter_native_utils {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+std::string Lower(std::string text) {
+  std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) {
+    return static_cast<char>(std::tolower(c));
+  });
+  return text;
+}
+
+std::string Trim(const std::string& text) {
+  const char* const kSpace = " \t\r\n";
+  size_t begin = text.find_first_not_of(kSpace);
+  if (begin == std::string::npos) return std::string();
+  size_t end = text.find_last_not_of(kSpace);
+  return text.substr(begin, end - begin + 1);
+}
+
+// Orders |a| against |b| if they are comparable: both numbers, both bools
+// or both strings (case-insensitively).
+bool Compare(const InventoryValue& a, const InventoryValue& b, int* order) {
+  auto number = [](const InventoryValue& value, double* out) {
+    if (const auto* i = std::get_if<int64_t>(&value)) {
+      *out = static_cast<double>(*i);
+      return true;
+    }
+    if (const auto* d = std::get_if<double>(&value)) {
+      *out = *d;
+      return true;
+    }
+    return false;
+  };
+  const auto* ai = std::get_if<int64_t>(&a);
+  const auto* bi = std::get_if<int64_t>(&b);
+  if (ai && bi) {
+    *order = *ai < *bi ? -1 : (*ai > *bi ? 1 : 0);
+    return true;
+  }
+  double ad = 0;
+  double bd = 0;
+  if (number(a, &ad) && number(b, &bd)) {
+    *order = ad < bd ? -1 : (ad > bd ? 1 : 0);
+    return true;
+  }
+  const auto* ab = std::get_if<bool>(&a);
+  const auto* bb = std::get_if<bool>(&b);
+  if (ab && bb) {
+    *order = static_cast<int>(*ab) - static_cast<int>(*bb);
+    return true;
+  }
+  const auto* as = std::get_if<std::string>(&a);
+  const auto* bs = std::get_if<std::string>(&b);
+  if (as && bs) {
+    *order = Lower(*as).compare(Lower(*bs));
+    return true;
+  }
+  return false;
+}
+
+bool IsIdentifier(const std::string& name) {
+  if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) {
+    return false;
+  }
+  return std::all_of(name.begin(), name.end(), [](unsigned char c) {
+    return std::isalnum(c) || c == '_';
+  });
+}
+
+std::string WqlString(const std::string& text) {
+  std::string quoted = "'";
+  for (char c : text) {
+    if (c == '\\' || c == '\'') quoted.push_back('\\');
+    quoted.push_back(c);
+  }
+  quoted.push_back('\'');
+  return quoted;
+}
+
+std::string WqlLiteral(const InventoryValue& value) {
+  if (const auto* b = std::get_if<bool>(&value)) return *b ? "TRUE" : "FALSE";
+  if (const auto* i = std::get_if<int64_t>(&value)) return std::to_string(*i);
+  if (const auto* d = std::get_if<double>(&value)) {
+    std::ostringstream text;
+    text.imbue(std::locale::classic());
+    text.precision(17);
+    text << *d;
+    return text.str();
+  }
+  if (const auto* s = std::get_if<std::string>(&value)) return WqlString(*s);
+  throw std::invalid_argument("Filter values must be null, bool, int, double "
+                              "or string");
+}
+
+// ---------- sysfs ----------
+
+using Record = std::map<std::string, InventoryValue>;
+
+// Trimmed contents of a small sysfs attribute; nullopt if it cannot be
+// read, as for the speed of a link that is down.
+std::optional<std::string> ReadAttribute(const fs::path& path) {
+  std::ifstream file(path);
+  if (!file) return std::nullopt;
+  std::string text((std::istreambuf_iterator<char>(file)),
+                   std::istreambuf_iterator<char>());
+  if (file.bad()) return std::nullopt;
+  return Trim(text);
+}
+
+InventoryValue StringAttribute(const fs::path& path) {
+  std::optional<std::string> text = ReadAttribute(path);
+  if (!text) return InventoryValue();
+  return *text;
+}
+
+InventoryValue IntAttribute(const fs::path& path, int64_t scale = 1) {
+  std::optional<std::string> text = ReadAttribute(path);
+  if (!text || text->empty()) return InventoryValue();
+  char* end = nullptr;
+  const long long value = std::strtoll(text->c_str(), &end, 10);
+  if (*end != '\0') return InventoryValue();
+  return static_cast<int64_t>(value) * scale;
+}
+
+InventoryValue BoolAttribute(const fs::path& path) {
+  std::optional<std::string> text = ReadAttribute(path);
+  if (text == "1") return true;
+  if (text == "0") return false;
+  return InventoryValue();
+}
+
+void ReadDisk(const fs::path& entry, Record* record) {
+  // The size is always in 512-byte sectors, whatever the device's own.
+  (*record)["sizeBytes"] = IntAttribute(entry / "size", 512);
+  (*record)["removable"] = BoolAttribute(entry / "removable");
+  (*record)["rotational"] = BoolAttribute(entry / "queue" / "rotational");
+  (*record)["readOnly"] = BoolAttribute(entry / "ro");
+  (*record)["model"] = StringAttribute(entry / "device" / "model");
+}
+
+void ReadNetworkAdapter(const fs::path& entry, Record* record) {
+  (*record)["macAddress"] = StringAttribute(entry / "address");
+  (*record)["mtu"] = IntAttribute(entry / "mtu");
+  (*record)["operState"] = StringAttribute(entry / "operstate");
+  InventoryValue speed = IntAttribute(entry / "speed");
+  // Some drivers report -1 for an unknown speed.
+  if (const auto* mbps = std::get_if<int64_t>(&speed)) {
+    if (*mbps < 0) speed = InventoryValue();
+  }
+  (*record)["speedMbps"] = speed;
+}
+
+void ReadMonitor(const fs::path& entry, Record* record) {
+  (*record)["status"] = StringAttribute(entry / "status");
+  std::optional<std::string> enabled = ReadAttribute(entry / "enabled");
+  (*record)["enabled"] = enabled == "enabled"    ? InventoryValue(true)
+                         : enabled == "disabled" ? InventoryValue(false)
+                                                 : InventoryValue();
+}
+
+// DRM entries are cards ("card0") and their connectors ("card0-HDMI-A-1").
+bool IsConnector(const std::string& name) {
+  return name.find('-') != std::string::npos;
+}
+
+class RecordSource {
+ public:
+  virtual ~RecordSource() = default;
+  // Returns false at the end.
+  virtual bool NextRecord(Record* record) = 0;
+};
+
+// One record per entry of a directory, in name order, each read only when
+// it is reached. A missing directory has no entries.
+class DirectorySource : public RecordSource {
+ public:
+  using Reader = void (*)(const fs::path& entry, Record* record);
+  using Filter = bool (*)(const std::string& name);
+
+  DirectorySource(fs::path directory, Reader reader, Filter filter)
+      : directory_(std::move(directory)), reader_(reader) {
+    std::error_code error;
+    for (fs::directory_iterator it(directory_, error), end;
+         !error && it != end; it.increment(error)) {
+      std::string name = it->path().filename().string();
+      if (!filter || filter(name)) names_.push_back(std::move(name));
+    }
+    std::sort(names_.begin(), names_.end());
+  }
+
+  bool NextRecord(Record* record) override {
+    if (next_ == names_.size()) return false;
+    const std::string& name = names_[next_++];
+    record->clear();
+    (*record)["name"] = name;
+    reader_(directory_ / name, record);
+    return true;
+  }
+
+ private:
+  fs::path directory_;
+  Reader reader_;
+  std::vector<std::string> names_;
+  size_t next_ = 0;
+};
+
+// One record per processor block of a cpuinfo file, parsed as it is
+// reached.
+class CpuinfoSource : public RecordSource {
+ public:
+  explicit CpuinfoSource(const fs::path& path) : file_(path) {
+    if (!file_) throw std::runtime_error("Cannot read " + path.string());
+  }
+
+  bool NextRecord(Record* record) override {
+    record->clear();
+    std::string line;
+    while (std::getline(file_, line)) {
+      if (Trim(line).empty()) {
+        if (!record->empty()) return true;
+        continue;
+      }
+      const size_t colon = line.find(':');
+      if (colon == std::string::npos) continue;
+      const std::string key = Trim(line.substr(0, colon));
+      const std::string value = Trim(line.substr(colon + 1));
+      if (key == "processor") {
+        (*record)["processor"] =
+            static_cast<int64_t>(std::strtoll(value.c_str(), nullptr, 10));
+      } else if (key == "core id") {
+        (*record)["coreId"] =
+            static_cast<int64_t>(std::strtoll(value.c_str(), nullptr, 10));
+      } else if (key == "model name") {
+        (*record)["modelName"] = value;
+      } else if (key == "cpu MHz") {
+        std::istringstream text(value);
+        text.imbue(std::locale::classic());
+        double mhz = 0;
+        if (text >> mhz) (*record)["mhz"] = mhz;
+      }
+    }
+    return !record->empty();
+  }
+
+ private:
+  std::ifstream file_;
+};
+
+const std::map<std::string, std::vector<std::string>>& SysfsClasses() {
+  static const std::map<std::string, std::vector<std::string>> classes = {
+      {"disks",
+       {"name", "sizeBytes", "removable", "rotational", "readOnly", "model"}},
+      {"networkAdapters",
+       {"name", "macAddress", "mtu", "operState", "speedMbps"}},
+      {"monitors", {"name", "status", "enabled"}},
+      {"processors", {"processor", "coreId", "modelName", "mhz"}},
+  };
+  return classes;
+}
+
+class SysfsCursor : public InventoryCursor {
+ public:
+  SysfsCursor(std::unique_ptr<RecordSource> source, InventoryQuery query)
+      : source_(std::move(source)), query_(std::move(query)) {}
+
+  bool Next(size_t max_rows, std::vector<InventoryRow>* rows) override {
+    size_t added = 0;
+    while (added < max_rows) {
+      if (!source_->NextRecord(&record_)) return false;
+      if (!Matches()) continue;
+      InventoryRow row;
+      row.reserve(query_.columns.size());
+      for (const std::string& column : query_.columns) {
+        auto it = record_.find(column);
+        row.push_back(it == record_.end() ? InventoryValue() : it->second);
+      }
+      rows->push_back(std::move(row));
+      ++added;
+    }
+    return true;
+  }
+
+ private:
+  bool Matches() const {
+    for (const InventoryCondition& condition : query_.filter) {
+      auto it = record_.find(condition.column);
+      const InventoryValue value =
+          it == record_.end() ? InventoryValue() : it->second;
+      if (!MatchesCondition(value, condition)) return false;
+    }
+    return true;
+  }
+
+  std::unique_ptr<RecordSource> source_;
+  InventoryQuery query_;
+  Record record_;
+};
+
+#ifdef _WIN32
+// ---------- WMI ----------
+
+std::wstring Utf8ToWide(const std::string& text) {
+  if (text.empty()) return std::wstring();
+  int len = MultiByteToWideChar(CP_UTF8, 0, text.data(),
+                                static_cast<int>(text.size()), nullptr, 0);
+  std::wstring wide(static_cast<size_t>(len), L'\0');
+  MultiByteToWideChar(CP_UTF8, 0, text.data(), static_cast<int>(text.size()),
+                      wide.data(), len);
+  return wide;
+}
+
+std::string WideToUtf8(const wchar_t* text, size_t len) {
+  if (len == 0) return std::string();
+  int size = WideCharToMultiByte(CP_UTF8, 0, text, static_cast<int>(len),
+                                 nullptr, 0, nullptr, nullptr);
+  std::string utf8(static_cast<size_t>(size), '\0');
+  WideCharToMultiByte(CP_UTF8, 0, text, static_cast<int>(len), utf8.data(),
+                      size, nullptr, nullptr);
+  return utf8;
+}
+
+std::string BstrToUtf8(BSTR text) {
+  return text ? WideToUtf8(text, SysStringLen(text)) : std::string();
+}
+
+std::string HResultText(HRESULT hres) {
+  std::ostringstream text;
+  text << "0x" << std::hex << static_cast<unsigned long>(hres);
+  return text.str();
+}
+
+InventoryValue FromSafeArray(SAFEARRAY* array, VARTYPE element_type) {
+  LONG lower = 0;
+  LONG upper = -1;
+  if (FAILED(SafeArrayGetLBound(array, 1, &lower)) ||
+      FAILED(SafeArrayGetUBound(array, 1, &upper))) {
+    return InventoryValue();
+  }
+  if (element_type == VT_BSTR) {
+    std::vector<std::string> strings;
+    for (LONG i = lower; i <= upper; ++i) {
+      BSTR item = nullptr;
+      if (SUCCEEDED(SafeArrayGetElement(array, &i, &item))) {
+        strings.push_back(BstrToUtf8(item));
+        SysFreeString(item);
+      }
+    }
+    return strings;
+  }
+  std::vector<int64_t> numbers;
+  for (LONG i = lower; i <= upper; ++i) {
+    switch (element_type) {
+      case VT_UI1: {
+        BYTE item = 0;
+        SafeArrayGetElement(array, &i, &item);
+        numbers.push_back(item);
+        break;
+      }
+      case VT_I2:
+      case VT_UI2: {
+        // WMI returns uint16 arrays, such as monitor names, as VT_I2.
+        uint16_t item = 0;
+        SafeArrayGetElement(array, &i, &item);
+        numbers.push_back(item);
+        break;
+      }
+      case VT_I4: {
+        LONG item = 0;
+        SafeArrayGetElement(array, &i, &item);
+        numbers.push_back(item);
+        break;
+      }
+      case VT_UI4: {
+        ULONG item = 0;
+        SafeArrayGetElement(array, &i, &item);
+        numbers.push_back(item);
+        break;
+      }
+      default:
+        return InventoryValue();
+    }
+  }
+  return numbers;
+}
+
+InventoryValue FromVariant(const VARIANT& value, CIMTYPE type) {
+  if (value.vt & VT_ARRAY) {
+    return FromSafeArray(value.parray,
+                         static_cast<VARTYPE>(value.vt & ~VT_ARRAY));
+  }
+  switch (value.vt) {
+    case VT_BSTR:
+      // 64-bit integers arrive as decimal strings.
+      if (type == CIM_SINT64 || type == CIM_UINT64) {
+        return static_cast<int64_t>(_wcstoi64(value.bstrVal, nullptr, 10));
+      }
+      return BstrToUtf8(value.bstrVal);
+    case VT_BOOL:
+      return value.boolVal != VARIANT_FALSE;
+    case VT_I1:
+      return static_cast<int64_t>(value.cVal);
+    case VT_UI1:
+      return static_cast<int64_t>(value.bVal);
+    case VT_I2:
+      return static_cast<int64_t>(value.iVal);
+    case VT_UI2:
+      return static_cast<int64_t>(value.uiVal);
+    case VT_I4:
+      return static_cast<int64_t>(value.lVal);
+    case VT_UI4:
+      return static_cast<int64_t>(value.ulVal);
+    case VT_INT:
+      return static_cast<int64_t>(value.intVal);
+    case VT_UINT:
+      return static_cast<int64_t>(value.uintVal);
+    case VT_I8:
+      return static_cast<int64_t>(value.llVal);
+    case VT_UI8:
+      return static_cast<int64_t>(value.ullVal);
+    case VT_R4:
+      return static_cast<double>(value.fltVal);
+    case VT_R8:
+      return value.dblVal;
+    default:
+      return InventoryValue();
+  }
+}
+
+class WmiCursor : public InventoryCursor {
+ public:
+  WmiCursor(IEnumWbemClassObject* enumerator, std::vector<std::string> columns)
+      : enumerator_(enumerator) {
+    for (const std::string& column : columns) {
+      columns_.push_back(Utf8ToWide(column));
+    }
+  }
+
+  ~WmiCursor() override { enumerator_->Release(); }
+
+  bool Next(size_t max_rows, std::vector<InventoryRow>* rows) override {
+    std::vector<IWbemClassObject*> objects(max_rows, nullptr);
+    ULONG returned = 0;
+    HRESULT hres = enumerator_->Next(WBEM_INFINITE, static_cast<ULONG>(max_rows),
+                                     objects.data(), &returned);
+    if (FAILED(hres)) {
+      throw std::runtime_error("WMI enumeration failed: " + HResultText(hres));
+    }
+    for (ULONG i = 0; i < returned; ++i) {
+      InventoryRow row;
+      row.reserve(columns_.size());
+      for (const std::wstring& column : columns_) {
+        VARIANT value;
+        VariantInit(&value);
+        CIMTYPE type = CIM_EMPTY;
+        if (SUCCEEDED(objects[i]->Get(column.c_str(), 0, &value, &type, 0))) {
+          row.push_back(FromVariant(value, type));
+        } else {
+          row.push_back(InventoryValue());
+        }
+        VariantClear(&value);
+      }
+      objects[i]->Release();
+      rows->push_back(std::move(row));
+    }
+    // WBEM_S_FALSE: fewer objects than asked for were left.
+    return hres != WBEM_S_FALSE;
+  }
+
+ private:
+  IEnumWbemClassObject* enumerator_;
+  std::vector<std::wstring> columns_;
+};
+
+class WmiInventoryProvider : public InventoryProvider {
+ public:
+  ~WmiInventoryProvider() override {
+    if (services_) services_->Release();
+    if (locator_) locator_->Release();
+  }
+
+  std::unique_ptr<InventoryCursor> Open(const InventoryQuery& query) override {
+    const std::wstring wql = Utf8ToWide(BuildWqlQuery(query));
+    IEnumWbemClassObject* enumerator = nullptr;
+    HRESULT hres = Services()->ExecQuery(
+        bstr_t(L"WQL"), bstr_t(wql.c_str()),
+        WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY, nullptr,
+        &enumerator);
+    if (hres == WBEM_E_INVALID_CLASS || hres == WBEM_E_INVALID_QUERY) {
+      throw std::invalid_argument("Invalid inventory query: " +
+                                  HResultText(hres));
+    }
+    if (FAILED(hres) || !enumerator) {
+      throw std::runtime_error("WMI query failed: " + HResultText(hres));
+    }
+    return std::make_unique<WmiCursor>(enumerator, query.columns);
+  }
+
+ private:
+  // Connects on first use; a failure is retried by the next query.
+  IWbemServices* Services() {
+    if (services_) return services_;
+    HRESULT hres;
+    if (!locator_) {
+      hres = CoCreateInstance(CLSID_WbemLocator, nullptr, CLSCTX_INPROC_SERVER,
+                              IID_IWbemLocator,
+                              reinterpret_cast<LPVOID*>(&locator_));
+      if (FAILED(hres)) {
+        locator_ = nullptr;
+        throw std::runtime_error("WbemLocator unavailable: " +
+                                 HResultText(hres));
+      }
+    }
+    IWbemServices* services = nullptr;
+    hres = locator_->ConnectServer(_bstr_t(L"ROOT\\CIMV2"), nullptr, nullptr,
+                                   nullptr, 0, nullptr, nullptr, &services);
+    if (FAILED(hres)) {
+      throw std::runtime_error("Connecting to ROOT\\CIMV2 failed: " +
+                               HResultText(hres));
+    }
+    CoSetProxyBlanket(services, RPC_C_AUTHN_WINNT, RPC_C_AUTHZ_NONE, nullptr,
+                      RPC_C_AUTHN_LEVEL_CALL, RPC_C_IMP_LEVEL_IMPERSONATE,
+                      nullptr, EOAC_NONE);
+    services_ = services;
+    return services_;
+  }
+
+  IWbemLocator* locator_ = nullptr;
+  IWbemServices* services_ = nullptr;
+};
+#endif
+
+}  // namespace
+
+bool ParseInventoryOperator(const std::string& name, InventoryOperator* op) {
+  if (name == "equals") {
+    *op = InventoryOperator::kEquals;
+  } else if (name == "notEquals") {
+    *op = InventoryOperator::kNotEquals;
+  } else if (name == "less") {
+    *op = InventoryOperator::kLess;
+  } else if (name == "greater") {
+    *op = InventoryOperator::kGreater;
+  } else if (name == "contains") {
+    *op = InventoryOperator::kContains;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool MatchesCondition(const InventoryValue& value,
+                      const InventoryCondition& condition) {
+  const bool value_null = std::holds_alternative<std::monostate>(value);
+  if (std::holds_alternative<std::monostate>(condition.value)) {
+    if (condition.op == InventoryOperator::kEquals) return value_null;
+    if (condition.op == InventoryOperator::kNotEquals) return !value_null;
+    return false;
+  }
+  if (value_null) return false;
+
+  if (condition.op == InventoryOperator::kContains) {
+    const auto* text = std::get_if<std::string>(&value);
+    const auto* part = std::get_if<std::string>(&condition.value);
+    return text && part && Lower(*text).find(Lower(*part)) != std::string::npos;
+  }
+  int order = 0;
+  if (!Compare(value, condition.value, &order)) return false;
+  switch (condition.op) {
+    case InventoryOperator::kEquals:
+      return order == 0;
+    case InventoryOperator::kNotEquals:
+      return order != 0;
+    case InventoryOperator::kLess:
+      return order < 0;
+    case InventoryOperator::kGreater:
+      return order > 0;
+    case InventoryOperator::kContains:
+      break;
+  }
+  return false;
+}
+
+std::string BuildWqlQuery(const InventoryQuery& query) {
+  if (!IsIdentifier(query.class_name)) {
+    throw std::invalid_argument("Invalid class name: " + query.class_name);
+  }
+  if (query.columns.empty()) {
+    throw std::invalid_argument("At least one column is required");
+  }
+  std::string wql = "SELECT ";
+  for (size_t i = 0; i < query.columns.size(); ++i) {
+    if (!IsIdentifier(query.columns[i])) {
+      throw std::invalid_argument("Invalid column name: " + query.columns[i]);
+    }
+    if (i > 0) wql += ", ";
+    wql += query.columns[i];
+  }
+  wql += " FROM " + query.class_name;
+
+  for (size_t i = 0; i < query.filter.size(); ++i) {
+    const InventoryCondition& condition = query.filter[i];
+    if (!IsIdentifier(condition.column)) {
+      throw std::invalid_argument("Invalid column name: " + condition.column);
+    }
+    wql += i == 0 ? " WHERE " : " AND ";
+    wql += condition.column;
+    const bool is_null =
+        std::holds_alternative<std::monostate>(condition.value);
+    switch (condition.op) {
+      case InventoryOperator::kEquals:
+        wql += is_null ? " IS NULL" : " = " + WqlLiteral(condition.value);
+        break;
+      case InventoryOperator::kNotEquals:
+        wql += is_null ? " IS NOT NULL" : " <> " + WqlLiteral(condition.value);
+        break;
+      case InventoryOperator::kLess:
+        wql += " < " + WqlLiteral(condition.value);
+        break;
+      case InventoryOperator::kGreater:
+        wql += " > " + WqlLiteral(condition.value);
+        break;
+      case InventoryOperator::kContains: {
+        const auto* part = std::get_if<std::string>(&condition.value);
+        if (!part) {
+          throw std::invalid_argument("contains needs a string value");
+        }
+        // LIKE wildcards in the value match literally.
+        std::string pattern = "%";
+        for (char c : *part) {
+          if (c == '%' || c == '_' || c == '[') {
+            pattern += '[';
+            pattern += c;
+            pattern += ']';
+          } else {
+            pattern += c;
+          }
+        }
+        pattern += '%';
+        wql += " LIKE " + WqlString(pattern);
+        break;
+      }
+    }
+  }
+  return wql;
+}
+
+SysfsInventoryProvider::SysfsInventoryProvider(std::string root)
+    : root_(std::move(root)) {}
+
+std::unique_ptr<InventoryCursor> SysfsInventoryProvider::Open(
+    const InventoryQuery& query) {
+  const auto& classes = SysfsClasses();
+  auto known = classes.find(query.class_name);
+  if (known == classes.end()) {
+    throw std::invalid_argument("Unknown inventory class: " + query.class_name);
+  }
+  auto check = [&known](const std::string& column) {
+    const std::vector<std::string>& columns = known->second;
+    if (std::find(columns.begin(), columns.end(), column) == columns.end()) {
+      throw std::invalid_argument("Unknown column of " + known->first + ": " +
+                                  column);
+    }
+  };
+  for (const std::string& column : query.columns) check(column);
+  for (const InventoryCondition& condition : query.filter) {
+    check(condition.column);
+  }
+
+  const fs::path root = fs::u8path(root_);
+  std::unique_ptr<RecordSource> source;
+  if (query.class_name == "disks") {
+    source = std::make_unique<DirectorySource>(root / "sys" / "block",
+                                               ReadDisk, nullptr);
+  } else if (query.class_name == "networkAdapters") {
+    source = std::make_unique<DirectorySource>(
+        root / "sys" / "class" / "net", ReadNetworkAdapter, nullptr);
+  } else if (query.class_name == "monitors") {
+    source = std::make_unique<DirectorySource>(
+        root / "sys" / "class" / "drm", ReadMonitor, IsConnector);
+  } else {
+    source = std::make_unique<CpuinfoSource>(root / "proc" / "cpuinfo");
+  }
+  return std::make_unique<SysfsCursor>(std::move(source), query);
+}
+
+std::unique_ptr<InventoryProvider> CreateDefaultInventoryProvider() {
+#ifdef _WIN32
+  return std::make_unique<WmiInventoryProvider>();
+#else
+  return std::make_unique<SysfsInventoryProvider>();
+#endif
+}
+
+InventoryEngine::InventoryEngine(std::unique_ptr<InventoryProvider> provider)
+    : provider_(std::move(provider)) {}
+
+InventoryPage InventoryEngine::Start(const InventoryQuery& query) {
+  if (query.columns.empty()) {
+    throw std::invalid_argument("At least one column is required");
+  }
+  if (query.page_size == 0 || query.page_size > kMaxPageSize) {
+    throw std::invalid_argument("pageSize must be between 1 and " +
+                                std::to_string(kMaxPageSize));
+  }
+  OpenCursor open;
+  open.cursor = provider_->Open(query);
+  open.page_size = query.page_size;
+  // Abandoned streams must not pin their sources forever.
+  while (cursors_.size() >= kMaxOpenCursors) cursors_.erase(cursors_.begin());
+  auto it = cursors_.emplace(next_cursor_++, std::move(open)).first;
+  return Read(it);
+}
+
+InventoryPage InventoryEngine::Next(int64_t cursor) {
+  auto it = cursors_.find(cursor);
+  if (it == cursors_.end()) {
+    throw std::invalid_argument("Unknown or closed inventory cursor");
+  }
+  return Read(it);
+}
+
+bool InventoryEngine::Close(int64_t cursor) { return cursors_.erase(cursor) > 0; }
+
+InventoryPage InventoryEngine::Read(
+    std::map<int64_t, OpenCursor>::iterator it) {
+  InventoryPage page;
+  page.cursor = it->first;
+  try {
+    page.done = !it->second.cursor->Next(it->second.page_size, &page.rows);
+  } catch (...) {
+    cursors_.erase(it);
+    throw;
+  }
+  if (page.done) cursors_.erase(it);
+  return page;
+}
+
+}  // namespace flutter_native_utils
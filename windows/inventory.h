@@ -0,0 +1,153 @@
+#ifndef FLUTTER_PLUGIN_INVENTORY_H_
+#define FLUTTER_PLUGIN_INVENTORY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace flutter_native_utils {
+
+// A typed inventory value. Integers of every width are widened to int64;
+// null is std::monostate.
+using InventoryValue =
+    std::variant<std::monostate, bool, int64_t, double, std::string,
+                 std::vector<std::string>, std::vector<int64_t>>;
+
+// Values in the order of the query's columns.
+using InventoryRow = std::vector<InventoryValue>;
+
+enum class InventoryOperator { kEquals, kNotEquals, kLess, kGreater, kContains };
+
+// Accepts "equals", "notEquals", "less", "greater" and "contains".
+bool ParseInventoryOperator(const std::string& name, InventoryOperator* op);
+
+struct InventoryCondition {
+  std::string column;
+  InventoryOperator op = InventoryOperator::kEquals;
+  // Null, bool, int64, double or string.
+  InventoryValue value;
+};
+
+struct InventoryQuery {
+  // Provider-specific, e.g. "Win32_DiskDrive" for WMI or "disks" for sysfs.
+  std::string class_name;
+  std::vector<std::string> columns;
+  // Conditions that must all hold; columns need not be projected.
+  std::vector<InventoryCondition> filter;
+  size_t page_size = 100;
+};
+
+// Whether |value| satisfies |condition|, with WQL semantics: strings compare
+// case-insensitively, numbers compare across int64 and double, and null
+// only equals null.
+bool MatchesCondition(const InventoryValue& value,
+                      const InventoryCondition& condition);
+
+// Builds the WQL for |query|. Class and column names must be plain
+// identifiers and string values are escaped, so the filter cannot change
+// the shape of the query. Throws std::invalid_argument otherwise.
+std::string BuildWqlQuery(const InventoryQuery& query);
+
+// A forward-only stream of rows.
+class InventoryCursor {
+ public:
+  virtual ~InventoryCursor() = default;
+
+  // Appends up to |max_rows| rows to |rows|. Returns false once the cursor
+  // is exhausted, including if it appended the last rows. Throws
+  // std::runtime_error if the source fails.
+  virtual bool Next(size_t max_rows, std::vector<InventoryRow>* rows) = 0;
+};
+
+// Source of inventory classes. A provider and its cursors are used from one
+// thread.
+class InventoryProvider {
+ public:
+  virtual ~InventoryProvider() = default;
+
+  // Throws std::invalid_argument for an unknown class or column, and
+  // std::runtime_error if the source cannot be read.
+  virtual std::unique_ptr<InventoryCursor> Open(const InventoryQuery& query) = 0;
+};
+
+// Reads a sysfs and procfs tree. |root| can point at a fixture tree holding
+// sys/ and proc/. Classes and columns:
+//   disks            name, sizeBytes, removable, rotational, readOnly, model
+//   networkAdapters  name, macAddress, mtu, operState, speedMbps
+//   monitors         name, status, enabled
+//   processors       processor, coreId, modelName, mhz
+// Entries are read one at a time as rows are requested.
+class SysfsInventoryProvider : public InventoryProvider {
+ public:
+  explicit SysfsInventoryProvider(std::string root = "/");
+
+  std::unique_ptr<InventoryCursor> Open(const InventoryQuery& query) override;
+
+ private:
+  std::string root_;
+};
+
+// Returns the provider for the current platform: WMI's ROOT\CIMV2 on
+// Windows, which must be used from a thread in a COM apartment, and sysfs
+// elsewhere.
+std::unique_ptr<InventoryProvider> CreateDefaultInventoryProvider();
+
+struct InventoryPage {
+  int64_t cursor = 0;
+  std::vector<InventoryRow> rows;
+  // The cursor is closed; there are no more pages.
+  bool done = false;
+};
+
+// Pages through provider cursors for callers that fetch one page per
+// request, so a large result is never held in full. Cursors not read to the
+// end stay open until closed or until kMaxOpenCursors newer ones have
+// opened. Not thread-safe; use it from the provider's thread.
+class InventoryEngine {
+ public:
+  static constexpr size_t kMaxOpenCursors = 16;
+  static constexpr size_t kMaxPageSize = 1000;
+
+  explicit InventoryEngine(std::unique_ptr<InventoryProvider> provider);
+
+  // Disallow copy and assign.
+  InventoryEngine(const InventoryEngine&) = delete;
+  InventoryEngine& operator=(const InventoryEngine&) = delete;
+
+  // Opens |query| and reads its first page. Throws as
+  // InventoryProvider::Open, and std::invalid_argument for an empty
+  // projection or a page size outside [1, kMaxPageSize].
+  InventoryPage Start(const InventoryQuery& query);
+
+  // Reads the next page. Throws std::invalid_argument if |cursor| is not
+  // open. A cursor whose source fails is closed.
+  InventoryPage Next(int64_t cursor);
+
+  // Returns false if |cursor| was not open.
+  bool Close(int64_t cursor);
+
+  size_t open_cursors() const { return cursors_.size(); }
+
+  InventoryProvider* provider() { return provider_.get(); }
+
+ private:
+  struct OpenCursor {
+    std::unique_ptr<InventoryCursor> cursor;
+    size_t page_size = 0;
+  };
+
+  InventoryPage Read(std::map<int64_t, OpenCursor>::iterator it);
+
+  std::unique_ptr<InventoryProvider> provider_;
+  // Ids increase, so the first entry is the oldest.
+  std::map<int64_t, OpenCursor> cursors_;
+  int64_t next_cursor_ = 1;
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_INVENTORY_H_
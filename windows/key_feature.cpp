@@ -0,0 +1,1113 @@
+#include "plugin_feature.h"
+
+#include <windows.h>
+
+#include <ncrypt.h>
+
+#include <flutter/encodable_value.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "aes_gcm.h"
+#include "encrypted_kv_store.h"
+#include "hmac.h"
+#include "hmac_session.h"
+#include "key_store.h"
+#include "nonce_replay_filter.h"
+#include "secure_buffer.h"
+#include "secure_random.h"
+#include "sha256.h"
+
+#pragma comment(lib, "ncrypt.lib")
+
+namespace flutter_native_utils {
+
+// ---------- RAII wrapper for NCrypt handles ----------
+struct NCryptHandle {
+  NCRYPT_HANDLE handle{0};
+  ~NCryptHandle() { reset(); }
+
+  void reset() {
+    if (handle) {
+      NCryptFreeObject(handle);
+      handle = 0;
+    }
+  }
+  operator NCRYPT_HANDLE() const { return handle; }
+  NCRYPT_HANDLE* put() { reset(); return &handle; }
+};
+
+// ---------- CNG Key Management ----------
+// Keys live in the hub's key store, so the key index sees every key created
+// here.
+static void HandleCreateKeyPair(
+    BackendHub* hub,
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  try {
+    const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+    if (!args) throw std::runtime_error("Invalid arguments");
+    auto it = args->find(flutter::EncodableValue("keyName"));
+    if (it == args->end()) throw std::runtime_error("Missing keyName");
+
+    auto pubKey =
+        hub->key_index()->CreateOrOpen(std::get<std::string>(it->second));
+    result->Success(flutter::EncodableValue(pubKey));
+  } catch (const std::exception& ex) {
+    result->Error("CNG_ERROR", ex.what());
+  }
+}
+
+// ---------- Signing ----------
+static std::vector<uint8_t> SignWithKey(const std::wstring& keyName,
+                                        const std::vector<uint8_t>& data) {
+  NCRYPT_PROV_HANDLE hProvider = 0;
+  NCRYPT_KEY_HANDLE hKey = 0;
+
+  try {
+    SECURITY_STATUS status = NCryptOpenStorageProvider(&hProvider, MS_KEY_STORAGE_PROVIDER, 0);
+    if (status != ERROR_SUCCESS) {
+      throw std::runtime_error("NCryptOpenStorageProvider failed");
+    }
+
+    status = NCryptOpenKey(hProvider, &hKey, keyName.c_str(), 0, 0);
+    if (status != ERROR_SUCCESS) {
+      throw std::runtime_error("NCryptOpenKey failed - key not found");
+    }
+
+    // The SHA-256 provider is opened once per process by Sha256.
+    Sha256Digest hash = ComputeSha256(data.data(), data.size());
+    const DWORD hashLen = static_cast<DWORD>(hash.size());
+
+    BCRYPT_PKCS1_PADDING_INFO paddingInfo;
+    paddingInfo.pszAlgId = BCRYPT_SHA256_ALGORITHM; // correct value
+
+    // Query signature size
+    DWORD sigLen = 0;
+    status = NCryptSignHash(hKey, &paddingInfo, hash.data(), hashLen,
+                            nullptr, 0, &sigLen, BCRYPT_PAD_PKCS1);
+    if (status != ERROR_SUCCESS) {
+      throw std::runtime_error("NCryptSignHash (size query) failed");
+    }
+
+    std::vector<uint8_t> signature(sigLen);
+
+    // Perform signature
+    status = NCryptSignHash(hKey, &paddingInfo, hash.data(), hashLen,
+                            signature.data(), sigLen, &sigLen, BCRYPT_PAD_PKCS1);
+    if (status != ERROR_SUCCESS) {
+      throw std::runtime_error("NCryptSignHash failed");
+    }
+
+    signature.resize(sigLen);
+
+    if (hKey) NCryptFreeObject(hKey);
+    if (hProvider) NCryptFreeObject(hProvider);
+
+    return signature;
+  } catch (...) {
+    if (hKey) NCryptFreeObject(hKey);
+    if (hProvider) NCryptFreeObject(hProvider);
+    throw;
+  }
+}
+
+static void HandleSignNonce(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  try {
+    const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+    if (!args) throw std::runtime_error("Invalid arguments");
+
+    auto keyIt = args->find(flutter::EncodableValue("keyName"));
+    auto nonceIt = args->find(flutter::EncodableValue("nonce"));
+    if (keyIt == args->end() || nonceIt == args->end())
+      throw std::runtime_error("Missing arguments");
+
+    std::wstring keyName = Utf8ToWide(std::get<std::string>(keyIt->second));
+    const auto& nonce = std::get<std::vector<uint8_t>>(nonceIt->second);
+
+    auto signature = SignWithKey(keyName, nonce);
+    result->Success(flutter::EncodableValue(signature));
+  } catch (const std::exception& ex) {
+    result->Error("CNG_ERROR", ex.what());
+  }
+}
+
+// ---------- Nonce Replay Window ----------
+// Whether the nonce of a SignNonce |call| was already seen within the replay
+// window. Checked on the platform thread, so a replay is turned away before
+// a worker or the key is involved. A nonce is spent even if signing it then
+// fails.
+static bool NonceReplayed(
+    BackendHub* hub, const flutter::MethodCall<flutter::EncodableValue>& call) {
+  std::shared_ptr<NonceReplayFilter> filter = hub->nonce_filter();
+  if (!filter) return false;
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  const flutter::EncodableValue* value =
+      args ? FindArgument(*args, "nonce") : nullptr;
+  const auto* nonce = value ? std::get_if<std::vector<uint8_t>>(value) : nullptr;
+  // HandleSignNonce reports the missing argument.
+  if (!nonce) return false;
+  return !filter->CheckAndRecord(nonce->data(), nonce->size());
+}
+
+// Replaces the hub's replay filter, forgetting the nonces the old one saw;
+// a missing or zero windowMs turns replay checks off. Returns the bytes the
+// filter holds.
+static void HandleConfigureNonceReplayWindow(
+    BackendHub* hub, const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  static const flutter::EncodableMap kNoArguments;
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  if (!args) args = &kNoArguments;
+  try {
+    int64_t window_ms = 0;
+    const flutter::EncodableValue* window = FindArgument(*args, "windowMs");
+    if (window && !window->IsNull()) {
+      if (!std::holds_alternative<int32_t>(*window) &&
+          !std::holds_alternative<int64_t>(*window)) {
+        throw std::invalid_argument("windowMs must be an integer");
+      }
+      window_ms = window->LongValue();
+      if (window_ms < 0) throw std::invalid_argument("windowMs is negative");
+    }
+    if (window_ms == 0) {
+      hub->set_nonce_filter(nullptr);
+      result->Success(flutter::EncodableValue(int64_t{0}));
+      return;
+    }
+    NonceReplayFilterOptions options;
+    options.window = std::chrono::milliseconds(window_ms);
+    if (const flutter::EncodableValue* value =
+            FindArgument(*args, "capacity")) {
+      const auto* capacity = std::get_if<int32_t>(value);
+      if (!capacity || *capacity <= 0) {
+        throw std::invalid_argument("capacity must be a positive integer");
+      }
+      options.capacity = static_cast<size_t>(*capacity);
+    }
+    auto filter = std::make_shared<NonceReplayFilter>(options);
+    const int64_t memory_bytes = static_cast<int64_t>(filter->memory_bytes());
+    hub->set_nonce_filter(std::move(filter));
+    result->Success(flutter::EncodableValue(memory_bytes));
+  } catch (const std::invalid_argument& ex) {
+    result->Error("BAD_ARGS", ex.what());
+  }
+}
+
+// ---------- Symmetric Encryption ----------
+// Data keys are random AES-256 keys wrapped with RSA-OAEP (SHA-256) by a
+// persisted key-store key, so only their wrapped form ever leaves the plugin.
+static std::vector<uint8_t> WrapDataKey(KeyIndex* keys,
+                                        const std::string& key_name,
+                                        const AesGcmKey& data_key) {
+  keys->CreateOrOpen(key_name);
+  return keys->Wrap(key_name, data_key.data(), data_key.size());
+}
+
+static size_t ChunkSizeArgument(const flutter::EncodableMap& args) {
+  const flutter::EncodableValue* value = FindArgument(args, "chunkSize");
+  if (!value) return kAesGcmDefaultChunkLen;
+  const auto* chunk_size = std::get_if<int32_t>(value);
+  if (!chunk_size || *chunk_size <= 0) {
+    throw std::invalid_argument("chunkSize must be a positive integer");
+  }
+  return static_cast<size_t>(*chunk_size);
+}
+
+static void HandleGenerateDataKey(
+    BackendHub* hub, const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  const flutter::EncodableValue* key_name =
+      args ? FindArgument(*args, "keyName") : nullptr;
+  if (!key_name || !std::holds_alternative<std::string>(*key_name)) {
+    result->Error("BAD_ARGS", "Missing keyName");
+    return;
+  }
+  try {
+    AesGcmKey data_key;
+    FillRandom(data_key.data(), data_key.size());
+    std::vector<uint8_t> wrapped =
+        WrapDataKey(hub->key_index(), std::get<std::string>(*key_name),
+                    data_key);
+    SecureZero(data_key.data(), data_key.size());
+    result->Success(flutter::EncodableValue(wrapped));
+  } catch (const std::exception& ex) {
+    result->Error("CNG_ERROR", ex.what());
+  }
+}
+
+class KeyFeature : public PluginFeature {
+ public:
+  explicit KeyFeature(const FeatureContext& context) : context_(context) {}
+
+  void Register(MethodRegistry* registry) override;
+
+ private:
+  void HandleEncrypt(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleDecrypt(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleStartCipherSession(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleUpdateCipherSession(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleFinishCipherSession(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleCancelCipherSession(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleCreateHmacSession(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleComputeHmacs(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleVerifyHmacs(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  void HandleCloseHmacSession(
+      const flutter::MethodCall<flutter::EncodableValue>& call,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  // Calls |use| on the platform thread with the data key named by the
+  // keyName/wrappedKey arguments: at once if the hub has it cached,
+  // otherwise once a worker has unwrapped it. Answers |result| instead if
+  // the arguments are missing or the key cannot be unwrapped, and if |use|
+  // throws.
+  void WithDataKey(
+      const flutter::EncodableMap& args,
+      std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> result,
+      std::function<void(std::shared_ptr<const AesGcmKey>)> use);
+
+  FeatureContext context_;
+
+  struct CipherSession {
+    std::unique_ptr<AesGcmStreamEncryptor> encryptor;
+    std::unique_ptr<AesGcmStreamDecryptor> decryptor;
+  };
+  std::unordered_map<int64_t, CipherSession> cipher_sessions_;
+  int64_t next_cipher_session_id_ = 1;
+
+  std::unordered_map<int64_t, std::unique_ptr<HmacSession>> hmac_sessions_;
+  int64_t next_hmac_session_id_ = 1;
+};
+
+void KeyFeature::WithDataKey(
+    const flutter::EncodableMap& args,
+    std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> result,
+    std::function<void(std::shared_ptr<const AesGcmKey>)> use) {
+  auto run = [result, use = std::move(use)](
+                 std::shared_ptr<const AesGcmKey> key) {
+    try {
+      use(std::move(key));
+    } catch (const std::invalid_argument& ex) {
+      result->Error("BAD_ARGS", ex.what());
+    } catch (const std::exception& ex) {
+      result->Error("CNG_ERROR", ex.what());
+    }
+  };
+
+  std::string key_name;
+  std::vector<uint8_t> wrapped;
+  DataKeyCache* cache;
+  try {
+    const flutter::EncodableValue* value = FindArgument(args, "keyName");
+    const auto* name = value ? std::get_if<std::string>(value) : nullptr;
+    if (!name) throw std::invalid_argument("Missing keyName");
+    key_name = *name;
+    wrapped = BytesArgument(args, "wrappedKey", true);
+    cache = context_.hub->data_keys();
+    // Without a registrar there is nowhere to post the key, so a miss is
+    // unwrapped here.
+    std::shared_ptr<const AesGcmKey> key =
+        context_.route ? cache->Find(key_name, wrapped)
+                       : cache->Unwrap(key_name, wrapped);
+    if (key) {
+      run(std::move(key));
+      return;
+    }
+  } catch (const std::invalid_argument& ex) {
+    result->Error("BAD_ARGS", ex.what());
+    return;
+  } catch (const std::exception& ex) {
+    result->Error("CNG_ERROR", ex.what());
+    return;
+  }
+
+  WorkerPool* workers;
+  try {
+    workers = context_.hub->workers();
+  } catch (const std::exception& ex) {
+    result->Error("FAILURE", ex.what());
+    return;
+  }
+  // Unwrapping is an RSA private-key operation; the hub's cache keeps the
+  // key for every engine once it is done.
+  workers->Post([cache, route = context_.route, key_name = std::move(key_name),
+                 wrapped = std::move(wrapped), result,
+                 run = std::move(run)]() mutable {
+    std::shared_ptr<const AesGcmKey> key;
+    std::string error_code;
+    std::string error;
+    try {
+      key = cache->Unwrap(key_name, wrapped);
+    } catch (const std::invalid_argument& ex) {
+      error_code = "BAD_ARGS";
+      error = ex.what();
+    } catch (const std::exception& ex) {
+      error_code = "CNG_ERROR";
+      error = ex.what();
+    }
+    // Runs only while the engine, and so this feature, is alive.
+    route->Post([key, error_code, error, result, run = std::move(run)]() {
+      if (key) {
+        run(key);
+      } else {
+        result->Error(error_code, error);
+      }
+    });
+  }, TaskPriority::kInteractive);
+}
+
+void KeyFeature::HandleEncrypt(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  if (!context_.route) {
+    result->Error("UNAVAILABLE", "Encryption requires a registrar");
+    return;
+  }
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  if (!args) {
+    result->Error("BAD_ARGS", "Invalid arguments");
+    return;
+  }
+
+  std::vector<uint8_t> data;
+  std::vector<uint8_t> aad;
+  size_t chunk_size;
+  try {
+    data = BytesArgument(*args, "data", true);
+    aad = BytesArgument(*args, "aad", false);
+    chunk_size = ChunkSizeArgument(*args);
+  } catch (const std::invalid_argument& ex) {
+    result->Error("BAD_ARGS", ex.what());
+    return;
+  }
+
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result =
+      std::move(result);
+  WithDataKey(*args, shared_result,
+              [hub = context_.hub, route = context_.route, shared_result,
+               data = std::move(data), aad = std::move(aad),
+               chunk_size](std::shared_ptr<const AesGcmKey> key) mutable {
+    AesGcmEncryptAsync(
+        *key, std::move(data), std::move(aad), hub->workers(),
+        [route, shared_result](bool ok, std::vector<uint8_t> output) {
+          auto value = std::make_shared<flutter::EncodableValue>(std::move(output));
+          route->Post([shared_result, value, ok]() {
+            if (ok) {
+              shared_result->Success(*value);
+            } else {
+              shared_result->Error("FAILURE", "Encryption failed");
+            }
+          });
+        },
+        chunk_size);
+  });
+}
+
+void KeyFeature::HandleDecrypt(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  if (!context_.route) {
+    result->Error("UNAVAILABLE", "Decryption requires a registrar");
+    return;
+  }
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  if (!args) {
+    result->Error("BAD_ARGS", "Invalid arguments");
+    return;
+  }
+
+  std::vector<uint8_t> data;
+  std::vector<uint8_t> aad;
+  try {
+    data = BytesArgument(*args, "data", true);
+    aad = BytesArgument(*args, "aad", false);
+  } catch (const std::invalid_argument& ex) {
+    result->Error("BAD_ARGS", ex.what());
+    return;
+  }
+
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result =
+      std::move(result);
+  WithDataKey(*args, shared_result,
+              [hub = context_.hub, route = context_.route, shared_result,
+               data = std::move(data),
+               aad = std::move(aad)](std::shared_ptr<const AesGcmKey> key) mutable {
+    AesGcmDecryptAsync(
+        *key, std::move(data), std::move(aad), hub->workers(),
+        [route, shared_result](bool ok, std::vector<uint8_t> output) {
+          auto value = std::make_shared<flutter::EncodableValue>(std::move(output));
+          route->Post([shared_result, value, ok]() {
+            if (ok) {
+              shared_result->Success(*value);
+            } else {
+              shared_result->Error("FAILURE", "Ciphertext failed authentication");
+            }
+          });
+        });
+  });
+}
+
+void KeyFeature::HandleStartCipherSession(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  if (!args) {
+    result->Error("BAD_ARGS", "Invalid arguments");
+    return;
+  }
+  const flutter::EncodableValue* mode = FindArgument(*args, "mode");
+  const std::string* mode_name = mode ? std::get_if<std::string>(mode) : nullptr;
+  if (!mode_name || (*mode_name != "encrypt" && *mode_name != "decrypt")) {
+    result->Error("BAD_ARGS", "mode must be encrypt or decrypt");
+    return;
+  }
+
+  const bool encrypt = *mode_name == "encrypt";
+  std::vector<uint8_t> aad;
+  size_t chunk_size = kAesGcmDefaultChunkLen;
+  try {
+    aad = BytesArgument(*args, "aad", false);
+    if (encrypt) chunk_size = ChunkSizeArgument(*args);
+  } catch (const std::invalid_argument& ex) {
+    result->Error("BAD_ARGS", ex.what());
+    return;
+  }
+
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result =
+      std::move(result);
+  WithDataKey(*args, shared_result,
+              [this, shared_result, encrypt, aad = std::move(aad),
+               chunk_size](std::shared_ptr<const AesGcmKey> key) mutable {
+    CipherSession session;
+    if (encrypt) {
+      session.encryptor = std::make_unique<AesGcmStreamEncryptor>(
+          *key, std::move(aad), chunk_size);
+    } else {
+      session.decryptor =
+          std::make_unique<AesGcmStreamDecryptor>(*key, std::move(aad));
+    }
+    int64_t session_id = next_cipher_session_id_++;
+    cipher_sessions_[session_id] = std::move(session);
+    shared_result->Success(flutter::EncodableValue(session_id));
+  });
+}
+
+// Returns the sessionId argument, or 0 (never a valid id) if it is missing.
+static int64_t SessionIdArgument(const flutter::EncodableMap* args) {
+  const flutter::EncodableValue* value =
+      args ? FindArgument(*args, "sessionId") : nullptr;
+  if (!value || !(std::holds_alternative<int32_t>(*value) ||
+                  std::holds_alternative<int64_t>(*value))) {
+    return 0;
+  }
+  return value->LongValue();
+}
+
+void KeyFeature::HandleUpdateCipherSession(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  auto it = cipher_sessions_.find(SessionIdArgument(args));
+  if (it == cipher_sessions_.end()) {
+    result->Error("BAD_ARGS", "Unknown sessionId");
+    return;
+  }
+  try {
+    std::vector<uint8_t> data = BytesArgument(*args, "data", true);
+    std::vector<uint8_t> output;
+    if (it->second.encryptor) {
+      it->second.encryptor->Update(data.data(), data.size(), &output);
+    } else if (!it->second.decryptor->Update(data.data(), data.size(),
+                                             &output)) {
+      cipher_sessions_.erase(it);
+      result->Error("FAILURE", "Ciphertext failed authentication");
+      return;
+    }
+    result->Success(flutter::EncodableValue(std::move(output)));
+  } catch (const std::invalid_argument& ex) {
+    result->Error("BAD_ARGS", ex.what());
+  } catch (const std::exception& ex) {
+    cipher_sessions_.erase(it);
+    result->Error("FAILURE", ex.what());
+  }
+}
+
+void KeyFeature::HandleFinishCipherSession(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  auto it = cipher_sessions_.find(SessionIdArgument(args));
+  if (it == cipher_sessions_.end()) {
+    result->Error("BAD_ARGS", "Unknown sessionId");
+    return;
+  }
+  // The session ends here whatever the outcome.
+  CipherSession session = std::move(it->second);
+  cipher_sessions_.erase(it);
+  try {
+    std::vector<uint8_t> data = BytesArgument(*args, "data", false);
+    std::vector<uint8_t> output;
+    if (session.encryptor) {
+      session.encryptor->Update(data.data(), data.size(), &output);
+      session.encryptor->Finish(&output);
+    } else if (!session.decryptor->Update(data.data(), data.size(), &output) ||
+               !session.decryptor->Finish(&output)) {
+      result->Error("FAILURE", "Ciphertext failed authentication");
+      return;
+    }
+    result->Success(flutter::EncodableValue(std::move(output)));
+  } catch (const std::invalid_argument& ex) {
+    result->Error("BAD_ARGS", ex.what());
+  } catch (const std::exception& ex) {
+    result->Error("FAILURE", ex.what());
+  }
+}
+
+void KeyFeature::HandleCancelCipherSession(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  cipher_sessions_.erase(SessionIdArgument(args));
+  result->Success();
+}
+
+// ---------- HMAC Sessions ----------
+// Request authentication MACs many small messages under one key, so a session
+// keeps the keyed hash state and duplicates it per message instead of
+// re-keying (or doing an RSA operation through SignNonce) for each one.
+
+void KeyFeature::HandleCreateHmacSession(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  if (!args) {
+    result->Error("BAD_ARGS", "Invalid arguments");
+    return;
+  }
+  MacAlgorithm algorithm = MacAlgorithm::kHmacSha256;
+  const flutter::EncodableValue* name = FindArgument(*args, "algorithm");
+  if (name && (!std::holds_alternative<std::string>(*name) ||
+               !ParseMacAlgorithm(std::get<std::string>(*name), &algorithm))) {
+    result->Error("BAD_ARGS", "algorithm must be sha256 or sha512");
+    return;
+  }
+
+  // The key is either given directly or as a wrapped data key.
+  if (const flutter::EncodableValue* value = FindArgument(*args, "key")) {
+    try {
+      // Keyed straight from the codec's buffer, without a local copy.
+      const auto* key = std::get_if<std::vector<uint8_t>>(value);
+      if (!key) throw std::invalid_argument("key must be a byte array");
+      int64_t session_id = next_hmac_session_id_++;
+      hmac_sessions_[session_id] =
+          std::make_unique<HmacSession>(algorithm, key->data(), key->size());
+      result->Success(flutter::EncodableValue(session_id));
+    } catch (const std::invalid_argument& ex) {
+      result->Error("BAD_ARGS", ex.what());
+    } catch (const std::exception& ex) {
+      result->Error("CNG_ERROR", ex.what());
+    }
+    return;
+  }
+
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> shared_result =
+      std::move(result);
+  WithDataKey(*args, shared_result,
+              [this, shared_result,
+               algorithm](std::shared_ptr<const AesGcmKey> data_key) {
+    // The data key is an AES-GCM key; MACs get a key of their own derived
+    // from it, so no key serves both ciphers and MACs.
+    static constexpr char kMacKeyLabel[] = "hmac";
+    uint8_t mac_key[64];
+    const size_t mac_key_len = MacLength(algorithm);
+    HkdfSha256(data_key->data(), data_key->size(), nullptr, 0,
+               reinterpret_cast<const uint8_t*>(kMacKeyLabel),
+               sizeof(kMacKeyLabel) - 1, mac_key, mac_key_len);
+    auto session =
+        std::make_unique<HmacSession>(algorithm, mac_key, mac_key_len);
+    SecureZero(mac_key, sizeof(mac_key));
+    int64_t session_id = next_hmac_session_id_++;
+    hmac_sessions_[session_id] = std::move(session);
+    shared_result->Success(flutter::EncodableValue(session_id));
+  });
+}
+
+void KeyFeature::HandleComputeHmacs(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  auto it = hmac_sessions_.find(SessionIdArgument(args));
+  if (it == hmac_sessions_.end()) {
+    result->Error("BAD_ARGS", "Unknown sessionId");
+    return;
+  }
+  try {
+    const HmacSession& session = *it->second;
+    std::vector<uint8_t> macs =
+        session.ComputeBatch(ByteListArgument(*args, "messages"));
+    flutter::EncodableList response;
+    response.reserve(macs.size() / session.mac_len());
+    for (size_t offset = 0; offset < macs.size(); offset += session.mac_len()) {
+      response.emplace_back(std::vector<uint8_t>(
+          macs.begin() + offset, macs.begin() + offset + session.mac_len()));
+    }
+    result->Success(flutter::EncodableValue(std::move(response)));
+  } catch (const std::invalid_argument& ex) {
+    result->Error("BAD_ARGS", ex.what());
+  } catch (const std::exception& ex) {
+    result->Error("CNG_ERROR", ex.what());
+  }
+}
+
+void KeyFeature::HandleVerifyHmacs(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  auto it = hmac_sessions_.find(SessionIdArgument(args));
+  if (it == hmac_sessions_.end()) {
+    result->Error("BAD_ARGS", "Unknown sessionId");
+    return;
+  }
+  try {
+    std::vector<bool> valid = it->second->VerifyBatch(
+        ByteListArgument(*args, "messages"),
+        ByteListArgument(*args, "macs"));
+    flutter::EncodableList response;
+    response.reserve(valid.size());
+    for (bool ok : valid) response.emplace_back(ok);
+    result->Success(flutter::EncodableValue(std::move(response)));
+  } catch (const std::invalid_argument& ex) {
+    result->Error("BAD_ARGS", ex.what());
+  } catch (const std::exception& ex) {
+    result->Error("CNG_ERROR", ex.what());
+  }
+}
+
+void KeyFeature::HandleCloseHmacSession(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  hmac_sessions_.erase(SessionIdArgument(args));
+  result->Success();
+}
+
+// ---------- Key Store ----------
+static flutter::EncodableMap KeyInfoToMap(const KeyInfo& info) {
+  // Details are null until the key has been opened; see KeyIndex.
+  flutter::EncodableValue usages;
+  if (info.has_details) {
+    flutter::EncodableList list;
+    for (const std::string& usage : info.usages) {
+      list.push_back(flutter::EncodableValue(usage));
+    }
+    usages = flutter::EncodableValue(std::move(list));
+  }
+  return {
+      {flutter::EncodableValue("name"), flutter::EncodableValue(info.name)},
+      {flutter::EncodableValue("algorithm"),
+       flutter::EncodableValue(info.algorithm)},
+      {flutter::EncodableValue("lengthBits"),
+       info.has_details
+           ? flutter::EncodableValue(static_cast<int32_t>(info.length_bits))
+           : flutter::EncodableValue()},
+      {flutter::EncodableValue("created"),
+       info.has_details && info.created != 0
+           ? flutter::EncodableValue(info.created)
+           : flutter::EncodableValue()},
+      {flutter::EncodableValue("usages"), usages},
+  };
+}
+
+static std::string KeyNameArgument(const flutter::EncodableMap* args) {
+  const flutter::EncodableValue* value =
+      args ? FindArgument(*args, "keyName") : nullptr;
+  const auto* name = value ? std::get_if<std::string>(value) : nullptr;
+  if (!name || name->empty()) throw std::invalid_argument("Missing keyName");
+  return *name;
+}
+
+static void HandleListKeys(
+    BackendHub* hub, const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  static const flutter::EncodableMap kNoArguments;
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  if (!args) args = &kNoArguments;
+
+  std::string prefix;
+  std::string page_token;
+  size_t page_size = 100;
+  try {
+    prefix = OptionalStringArgument(*args, "prefix");
+    page_token = OptionalStringArgument(*args, "pageToken");
+    if (const flutter::EncodableValue* value = FindArgument(*args, "pageSize")) {
+      const auto* size = std::get_if<int32_t>(value);
+      if (!size || *size <= 0 ||
+          static_cast<size_t>(*size) > KeyIndex::kMaxPageSize) {
+        throw std::invalid_argument("pageSize must be between 1 and 1000");
+      }
+      page_size = static_cast<size_t>(*size);
+    }
+  } catch (const std::invalid_argument& ex) {
+    result->Error("BAD_ARGS", ex.what());
+    return;
+  }
+
+  try {
+    // A page token is the name of the last key listed, so pages stay in
+    // order while keys are created and deleted between them.
+    KeyPage page = hub->key_index()->List(prefix, page_token, page_size);
+    flutter::EncodableList keys;
+    keys.reserve(page.keys.size());
+    for (const KeyInfo& info : page.keys) {
+      keys.push_back(flutter::EncodableValue(KeyInfoToMap(info)));
+    }
+    flutter::EncodableMap response = {
+        {flutter::EncodableValue("keys"), flutter::EncodableValue(std::move(keys))},
+        {flutter::EncodableValue("nextPageToken"),
+         page.done ? flutter::EncodableValue()
+                   : flutter::EncodableValue(page.last)},
+    };
+    result->Success(flutter::EncodableValue(std::move(response)));
+  } catch (const std::exception& ex) {
+    result->Error("CNG_ERROR", ex.what());
+  }
+}
+
+static void HandleGetKeyInfo(
+    BackendHub* hub, const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  std::string key_name;
+  try {
+    key_name =
+        KeyNameArgument(std::get_if<flutter::EncodableMap>(call.arguments()));
+  } catch (const std::invalid_argument& ex) {
+    result->Error("BAD_ARGS", ex.what());
+    return;
+  }
+  try {
+    std::optional<KeyInfo> info = hub->key_index()->Info(key_name);
+    result->Success(info ? flutter::EncodableValue(KeyInfoToMap(*info))
+                         : flutter::EncodableValue());
+  } catch (const std::exception& ex) {
+    result->Error("CNG_ERROR", ex.what());
+  }
+}
+
+// Data keys unwrapped with the deleted key are dropped from the hub's cache;
+// see DataKeyCache.
+static void HandleDeleteKey(
+    BackendHub* hub, const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  std::string key_name;
+  try {
+    key_name =
+        KeyNameArgument(std::get_if<flutter::EncodableMap>(call.arguments()));
+  } catch (const std::invalid_argument& ex) {
+    result->Error("BAD_ARGS", ex.what());
+    return;
+  }
+  try {
+    const bool deleted = hub->key_index()->Delete(key_name);
+    if (deleted) hub->data_keys()->Forget(key_name);
+    result->Success(flutter::EncodableValue(deleted));
+  } catch (const std::exception& ex) {
+    result->Error("CNG_ERROR", ex.what());
+  }
+}
+
+// ---------- Key-Value Store ----------
+// Stores are shared through the hub, so a handle opened by one engine works
+// in another; each is closed once by whoever opened it.
+static int64_t KvHandleArgument(const flutter::EncodableMap& args) {
+  const flutter::EncodableValue* value = FindArgument(args, "store");
+  if (!value || !(std::holds_alternative<int32_t>(*value) ||
+                  std::holds_alternative<int64_t>(*value))) {
+    throw std::invalid_argument("Missing store");
+  }
+  return value->LongValue();
+}
+
+static std::shared_ptr<EncryptedKvStore> KvStoreArgument(
+    BackendHub* hub, const flutter::EncodableMap& args) {
+  std::shared_ptr<EncryptedKvStore> store =
+      hub->kv_store(KvHandleArgument(args));
+  if (!store) throw std::invalid_argument("Unknown or closed store");
+  return store;
+}
+
+static std::string KvKeyArgument(const flutter::EncodableMap& args) {
+  const flutter::EncodableValue* value = FindArgument(args, "key");
+  const auto* key = value ? std::get_if<std::string>(value) : nullptr;
+  if (!key) throw std::invalid_argument("key must be a string");
+  return *key;
+}
+
+// Runs |action| against the arguments, mapping bad arguments (including an
+// unknown store) to BAD_ARGS and store failures to FAILURE.
+template <typename Action>
+static void WithKvArguments(
+    const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result,
+    Action action) {
+  const auto* args = std::get_if<flutter::EncodableMap>(call.arguments());
+  if (!args) {
+    result->Error("BAD_ARGS", "Invalid arguments");
+    return;
+  }
+  try {
+    result->Success(action(*args));
+  } catch (const std::invalid_argument& ex) {
+    result->Error("BAD_ARGS", ex.what());
+  } catch (const std::exception& ex) {
+    result->Error("FAILURE", ex.what());
+  }
+}
+
+static void HandleOpenKvStore(
+    BackendHub* hub, const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  WithKvArguments(call, std::move(result), [hub](const auto& args) {
+    const std::string directory = OptionalStringArgument(args, "directory");
+    if (directory.empty()) throw std::invalid_argument("Missing directory");
+    return flutter::EncodableValue(
+        hub->OpenKvStore(directory, KeyNameArgument(&args)));
+  });
+}
+
+static void HandleKvGet(
+    BackendHub* hub, const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  WithKvArguments(call, std::move(result), [hub](const auto& args) {
+    std::optional<std::vector<uint8_t>> value =
+        KvStoreArgument(hub, args)->Get(KvKeyArgument(args));
+    return value ? flutter::EncodableValue(std::move(*value))
+                 : flutter::EncodableValue();
+  });
+}
+
+// Applies every entry of the map, a null value deleting its key, as one
+// atomic batch.
+static void HandleKvPut(
+    BackendHub* hub, const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  WithKvArguments(call, std::move(result), [hub](const auto& args) {
+    std::shared_ptr<EncryptedKvStore> store = KvStoreArgument(hub, args);
+    const flutter::EncodableValue* value = FindArgument(args, "entries");
+    const auto* entries =
+        value ? std::get_if<flutter::EncodableMap>(value) : nullptr;
+    if (!entries) throw std::invalid_argument("entries must be a map");
+    std::vector<KvWrite> batch;
+    batch.reserve(entries->size());
+    for (const auto& entry : *entries) {
+      const auto* key = std::get_if<std::string>(&entry.first);
+      const auto* bytes = std::get_if<std::vector<uint8_t>>(&entry.second);
+      if (!key || (!bytes && !entry.second.IsNull())) {
+        throw std::invalid_argument(
+            "entries must map strings to byte arrays or null");
+      }
+      batch.push_back({*key, bytes ? std::optional<std::vector<uint8_t>>(*bytes)
+                                   : std::nullopt});
+    }
+    store->Write(std::move(batch));
+    return flutter::EncodableValue();
+  });
+}
+
+static void HandleKvDelete(
+    BackendHub* hub, const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  WithKvArguments(call, std::move(result), [hub](const auto& args) {
+    std::shared_ptr<EncryptedKvStore> store = KvStoreArgument(hub, args);
+    const flutter::EncodableValue* value = FindArgument(args, "keys");
+    const auto* keys = value ? std::get_if<flutter::EncodableList>(value) : nullptr;
+    if (!keys) throw std::invalid_argument("keys must be a list of strings");
+    std::vector<KvWrite> batch;
+    batch.reserve(keys->size());
+    for (const flutter::EncodableValue& key : *keys) {
+      const auto* name = std::get_if<std::string>(&key);
+      if (!name) throw std::invalid_argument("keys must be a list of strings");
+      batch.push_back({*name, std::nullopt});
+    }
+    store->Write(std::move(batch));
+    return flutter::EncodableValue();
+  });
+}
+
+static void HandleKvScan(
+    BackendHub* hub, const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  WithKvArguments(call, std::move(result), [hub](const auto& args) {
+    std::shared_ptr<EncryptedKvStore> store = KvStoreArgument(hub, args);
+    size_t page_size = 100;
+    if (const flutter::EncodableValue* value = FindArgument(args, "pageSize")) {
+      const auto* size = std::get_if<int32_t>(value);
+      if (!size || *size <= 0 ||
+          static_cast<size_t>(*size) > EncryptedKvStore::kMaxPageSize) {
+        throw std::invalid_argument("pageSize must be between 1 and 1000");
+      }
+      page_size = static_cast<size_t>(*size);
+    }
+    // As with ListKeys, a page token is the last key returned.
+    KvScanPage page = store->Scan(OptionalStringArgument(args, "prefix"),
+                                  OptionalStringArgument(args, "pageToken"),
+                                  page_size);
+    flutter::EncodableList entries;
+    entries.reserve(page.entries.size());
+    for (KvEntry& entry : page.entries) {
+      entries.push_back(flutter::EncodableValue(flutter::EncodableMap{
+          {flutter::EncodableValue("key"),
+           flutter::EncodableValue(std::move(entry.key))},
+          {flutter::EncodableValue("value"),
+           flutter::EncodableValue(std::move(entry.value))},
+      }));
+    }
+    return flutter::EncodableValue(flutter::EncodableMap{
+        {flutter::EncodableValue("entries"),
+         flutter::EncodableValue(std::move(entries))},
+        {flutter::EncodableValue("nextPageToken"),
+         page.done ? flutter::EncodableValue()
+                   : flutter::EncodableValue(page.last)},
+    });
+  });
+}
+
+static void HandleCloseKvStore(
+    BackendHub* hub, const flutter::MethodCall<flutter::EncodableValue>& call,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  WithKvArguments(call, std::move(result), [hub](const auto& args) {
+    return flutter::EncodableValue(hub->CloseKvStore(KvHandleArgument(args)));
+  });
+}
+
+// ---------- Registration ----------
+void KeyFeature::Register(MethodRegistry* registry) {
+  // Blocking handlers run on the shared workers in their class. Key-store
+  // handlers hold the hub, not the feature, which a queued task may outlive;
+  // the hub outlives every task on its pool.
+  BackendHub* hub = context_.hub;
+  (*registry)["CreateKeyPair"] = Scheduled(
+      context_, TaskPriority::kNormal, [hub](const auto& call, auto result) {
+        HandleCreateKeyPair(hub, call, std::move(result));
+      });
+  (*registry)["ListKeys"] = Scheduled(
+      context_, TaskPriority::kNormal, [hub](const auto& call, auto result) {
+        HandleListKeys(hub, call, std::move(result));
+      });
+  (*registry)["GetKeyInfo"] = Scheduled(
+      context_, TaskPriority::kNormal, [hub](const auto& call, auto result) {
+        HandleGetKeyInfo(hub, call, std::move(result));
+      });
+  (*registry)["DeleteKey"] = Scheduled(
+      context_, TaskPriority::kNormal, [hub](const auto& call, auto result) {
+        HandleDeleteKey(hub, call, std::move(result));
+      });
+  (*registry)["GenerateDataKey"] = Scheduled(
+      context_, TaskPriority::kNormal, [hub](const auto& call, auto result) {
+        HandleGenerateDataKey(hub, call, std::move(result));
+      });
+  (*registry)["OpenKvStore"] = Scheduled(
+      context_, TaskPriority::kNormal, [hub](const auto& call, auto result) {
+        HandleOpenKvStore(hub, call, std::move(result));
+      });
+  (*registry)["KvGet"] = Scheduled(
+      context_, TaskPriority::kInteractive,
+      [hub](const auto& call, auto result) {
+        HandleKvGet(hub, call, std::move(result));
+      });
+  (*registry)["KvPut"] = Scheduled(
+      context_, TaskPriority::kNormal, [hub](const auto& call, auto result) {
+        HandleKvPut(hub, call, std::move(result));
+      });
+  (*registry)["KvDelete"] = Scheduled(
+      context_, TaskPriority::kNormal, [hub](const auto& call, auto result) {
+        HandleKvDelete(hub, call, std::move(result));
+      });
+  // Reads every live record.
+  (*registry)["KvScan"] = Scheduled(
+      context_, TaskPriority::kBulk, [hub](const auto& call, auto result) {
+        HandleKvScan(hub, call, std::move(result));
+      });
+  (*registry)["CloseKvStore"] = Scheduled(
+      context_, TaskPriority::kNormal, [hub](const auto& call, auto result) {
+        HandleCloseKvStore(hub, call, std::move(result));
+      });
+  (*registry)["ConfigureNonceReplayWindow"] = Scheduled(
+      context_, TaskPriority::kNormal, [hub](const auto& call, auto result) {
+        HandleConfigureNonceReplayWindow(hub, call, std::move(result));
+      });
+  MethodHandler sign_nonce =
+      Scheduled(context_, TaskPriority::kInteractive, HandleSignNonce);
+  (*registry)["SignNonce"] = [hub, sign_nonce](const auto& call, auto result) {
+    if (NonceReplayed(hub, call)) {
+      result->Error("REPLAYED_NONCE",
+                    "nonce was already signed within the replay window");
+      return;
+    }
+    sign_nonce(call, std::move(result));
+  };
+  (*registry)["Encrypt"] = [this](const auto& call, auto result) {
+    HandleEncrypt(call, std::move(result));
+  };
+  (*registry)["Decrypt"] = [this](const auto& call, auto result) {
+    HandleDecrypt(call, std::move(result));
+  };
+  (*registry)["StartCipherSession"] = [this](const auto& call, auto result) {
+    HandleStartCipherSession(call, std::move(result));
+  };
+  (*registry)["UpdateCipherSession"] = [this](const auto& call, auto result) {
+    HandleUpdateCipherSession(call, std::move(result));
+  };
+  (*registry)["FinishCipherSession"] = [this](const auto& call, auto result) {
+    HandleFinishCipherSession(call, std::move(result));
+  };
+  (*registry)["CancelCipherSession"] = [this](const auto& call, auto result) {
+    HandleCancelCipherSession(call, std::move(result));
+  };
+  (*registry)["CreateHmacSession"] = [this](const auto& call, auto result) {
+    HandleCreateHmacSession(call, std::move(result));
+  };
+  (*registry)["ComputeHmacs"] = [this](const auto& call, auto result) {
+    HandleComputeHmacs(call, std::move(result));
+  };
+  (*registry)["VerifyHmacs"] = [this](const auto& call, auto result) {
+    HandleVerifyHmacs(call, std::move(result));
+  };
+  (*registry)["CloseHmacSession"] = [this](const auto& call, auto result) {
+    HandleCloseHmacSession(call, std::move(result));
+  };
+}
+
+std::shared_ptr<PluginFeature> CreateKeyFeature(const FeatureContext& context) {
+  return std::make_shared<KeyFeature>(context);
+}
+
+}  // namespace flutter_native_utils
@@ -0,0 +1,749 @@
+#include "key_store.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <bcrypt.h>
+#include <ncrypt.h>
+
+#pragma comment(lib, "ncrypt.lib")
+#else
+#include <fcntl.h>
+#include <openssl/bn.h>
+#include <openssl/core_names.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/rsa.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <filesystem>
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "secure_buffer.h"
+
+namespace flutter_native_utils {
+
+#ifdef _WIN32
+// ---------- CngKeyStore ----------
+
+namespace {
+
+struct NCryptObject {
+  NCRYPT_HANDLE handle = 0;
+
+  NCryptObject() = default;
+  ~NCryptObject() { reset(); }
+
+  NCryptObject(const NCryptObject&) = delete;
+  NCryptObject& operator=(const NCryptObject&) = delete;
+
+  void reset() {
+    if (handle) NCryptFreeObject(handle);
+    handle = 0;
+  }
+  NCRYPT_HANDLE* put() {
+    reset();
+    return &handle;
+  }
+};
+
+std::string WideToUtf8(const wchar_t* text, size_t len) {
+  if (len == 0) return std::string();
+  int size = WideCharToMultiByte(CP_UTF8, 0, text, static_cast<int>(len),
+                                 nullptr, 0, nullptr, nullptr);
+  std::string utf8(static_cast<size_t>(size), '\0');
+  WideCharToMultiByte(CP_UTF8, 0, text, static_cast<int>(len), utf8.data(),
+                      size, nullptr, nullptr);
+  return utf8;
+}
+
+std::wstring Utf8ToWide(const std::string& text) {
+  if (text.empty()) return std::wstring();
+  int size = MultiByteToWideChar(CP_UTF8, 0, text.c_str(),
+                                 static_cast<int>(text.size()), nullptr, 0);
+  std::wstring wide(static_cast<size_t>(size), L'\0');
+  MultiByteToWideChar(CP_UTF8, 0, text.c_str(), static_cast<int>(text.size()),
+                      wide.data(), size);
+  return wide;
+}
+
+void OpenProvider(NCryptObject* provider) {
+  if (NCryptOpenStorageProvider(provider->put(), MS_KEY_STORAGE_PROVIDER, 0) !=
+      ERROR_SUCCESS) {
+    throw std::runtime_error("NCryptOpenStorageProvider failed");
+  }
+}
+
+// Opens |name| silently. Returns false if there is no such key.
+bool OpenKey(const NCryptObject& provider, const std::wstring& name,
+             NCryptObject* key) {
+  SECURITY_STATUS status = NCryptOpenKey(provider.handle, key->put(),
+                                         name.c_str(), 0, NCRYPT_SILENT_FLAG);
+  if (status == NTE_BAD_KEYSET) return false;
+  if (status != ERROR_SUCCESS) throw std::runtime_error("NCryptOpenKey failed");
+  return true;
+}
+
+bool DwordProperty(const NCryptObject& key, const wchar_t* property,
+                   DWORD* value) {
+  DWORD size = 0;
+  return NCryptGetProperty(key.handle, property, reinterpret_cast<PBYTE>(value),
+                           sizeof(*value), &size, 0) == ERROR_SUCCESS &&
+         size == sizeof(*value);
+}
+
+int64_t FileTimeToUnixMillis(const FILETIME& time) {
+  ULARGE_INTEGER ticks;
+  ticks.LowPart = time.dwLowDateTime;
+  ticks.HighPart = time.dwHighDateTime;
+  // FILETIME counts 100 ns ticks since 1601-01-01.
+  return (static_cast<int64_t>(ticks.QuadPart) - 116444736000000000LL) / 10000;
+}
+
+}  // namespace
+
+std::vector<KeyInfo> CngKeyStore::Enumerate() {
+  NCryptObject provider;
+  OpenProvider(&provider);
+  std::vector<KeyInfo> keys;
+  PVOID state = nullptr;
+  for (;;) {
+    NCryptKeyName* key_name = nullptr;
+    SECURITY_STATUS status = NCryptEnumKeys(provider.handle, nullptr, &key_name,
+                                            &state, NCRYPT_SILENT_FLAG);
+    if (status == NTE_NO_MORE_ITEMS) break;
+    if (status != ERROR_SUCCESS) {
+      if (state) NCryptFreeBuffer(state);
+      throw std::runtime_error("NCryptEnumKeys failed");
+    }
+    KeyInfo info;
+    info.name = WideToUtf8(key_name->pszName, wcslen(key_name->pszName));
+    info.algorithm = WideToUtf8(key_name->pszAlgid, wcslen(key_name->pszAlgid));
+    NCryptFreeBuffer(key_name);
+    keys.push_back(std::move(info));
+  }
+  if (state) NCryptFreeBuffer(state);
+  return keys;
+}
+
+std::optional<KeyInfo> CngKeyStore::Describe(const std::string& name) {
+  NCryptObject provider, key;
+  OpenProvider(&provider);
+  if (!OpenKey(provider, Utf8ToWide(name), &key)) return std::nullopt;
+
+  KeyInfo info;
+  info.name = name;
+  info.has_details = true;
+  wchar_t algorithm[64];
+  DWORD size = 0;
+  if (NCryptGetProperty(key.handle, NCRYPT_ALGORITHM_PROPERTY,
+                        reinterpret_cast<PBYTE>(algorithm), sizeof(algorithm),
+                        &size, 0) == ERROR_SUCCESS &&
+      size >= sizeof(wchar_t)) {
+    // |size| counts the terminator.
+    info.algorithm = WideToUtf8(algorithm, size / sizeof(wchar_t) - 1);
+  }
+  DWORD length = 0;
+  if (DwordProperty(key, NCRYPT_LENGTH_PROPERTY, &length)) {
+    info.length_bits = length;
+  }
+  FILETIME modified;
+  if (NCryptGetProperty(key.handle, NCRYPT_LAST_MODIFIED_PROPERTY,
+                        reinterpret_cast<PBYTE>(&modified), sizeof(modified),
+                        &size, 0) == ERROR_SUCCESS &&
+      size == sizeof(modified)) {
+    info.created = FileTimeToUnixMillis(modified);
+  }
+  DWORD usage = 0;
+  if (DwordProperty(key, NCRYPT_KEY_USAGE_PROPERTY, &usage)) {
+    if (usage & NCRYPT_ALLOW_DECRYPT_FLAG) info.usages.push_back("decrypt");
+    if (usage & NCRYPT_ALLOW_SIGNING_FLAG) info.usages.push_back("sign");
+    if (usage & NCRYPT_ALLOW_KEY_AGREEMENT_FLAG) {
+      info.usages.push_back("keyAgreement");
+    }
+  }
+  return info;
+}
+
+std::vector<uint8_t> CngKeyStore::CreateOrOpen(const std::string& name,
+                                               bool* created) {
+  const std::wstring wide_name = Utf8ToWide(name);
+  NCryptObject provider, key;
+  OpenProvider(&provider);
+  *created = false;
+  if (!OpenKey(provider, wide_name, &key)) {
+    if (NCryptCreatePersistedKey(provider.handle, key.put(),
+                                 NCRYPT_RSA_ALGORITHM, wide_name.c_str(), 0,
+                                 0) != ERROR_SUCCESS) {
+      throw std::runtime_error("CreatePersistedKey failed");
+    }
+    DWORD length = 2048;
+    if (NCryptSetProperty(key.handle, NCRYPT_LENGTH_PROPERTY,
+                          reinterpret_cast<PBYTE>(&length), sizeof(length),
+                          0) != ERROR_SUCCESS) {
+      throw std::runtime_error("SetProperty failed");
+    }
+    SECURITY_STATUS status = NCryptFinalizeKey(key.handle, 0);
+    if (status == NTE_EXISTS) {
+      // Another caller created it first; theirs is the key.
+      if (!OpenKey(provider, wide_name, &key)) {
+        throw std::runtime_error("NCryptOpenKey failed");
+      }
+    } else if (status != ERROR_SUCCESS) {
+      throw std::runtime_error("FinalizeKey failed");
+    } else {
+      *created = true;
+    }
+  }
+
+  DWORD size = 0;
+  if (NCryptExportKey(key.handle, 0, BCRYPT_RSAPUBLIC_BLOB, nullptr, nullptr,
+                      0, &size, 0) != ERROR_SUCCESS) {
+    throw std::runtime_error("ExportKey size failed");
+  }
+  std::vector<uint8_t> public_key(size);
+  if (NCryptExportKey(key.handle, 0, BCRYPT_RSAPUBLIC_BLOB, nullptr,
+                      public_key.data(), size, &size, 0) != ERROR_SUCCESS) {
+    throw std::runtime_error("ExportKey failed");
+  }
+  public_key.resize(size);
+  return public_key;
+}
+
+bool CngKeyStore::Delete(const std::string& name) {
+  NCryptObject provider, key;
+  OpenProvider(&provider);
+  if (!OpenKey(provider, Utf8ToWide(name), &key)) return false;
+  if (NCryptDeleteKey(key.handle, 0) != ERROR_SUCCESS) {
+    throw std::runtime_error("NCryptDeleteKey failed");
+  }
+  // A successful delete frees the handle.
+  key.handle = 0;
+  return true;
+}
+
+std::vector<uint8_t> CngKeyStore::Wrap(const std::string& name,
+                                       const uint8_t* data, size_t len) {
+  NCryptObject provider, key;
+  OpenProvider(&provider);
+  if (!OpenKey(provider, Utf8ToWide(name), &key)) {
+    throw std::runtime_error("No key named " + name);
+  }
+  BCRYPT_OAEP_PADDING_INFO padding = {BCRYPT_SHA256_ALGORITHM, nullptr, 0};
+  DWORD size = 0;
+  if (NCryptEncrypt(key.handle, const_cast<PBYTE>(data),
+                    static_cast<DWORD>(len), &padding, nullptr, 0, &size,
+                    NCRYPT_PAD_OAEP_FLAG) != ERROR_SUCCESS) {
+    throw std::runtime_error("NCryptEncrypt (size query) failed");
+  }
+  std::vector<uint8_t> wrapped(size);
+  if (NCryptEncrypt(key.handle, const_cast<PBYTE>(data),
+                    static_cast<DWORD>(len), &padding, wrapped.data(), size,
+                    &size, NCRYPT_PAD_OAEP_FLAG) != ERROR_SUCCESS) {
+    throw std::runtime_error("NCryptEncrypt failed");
+  }
+  wrapped.resize(size);
+  return wrapped;
+}
+
+bool CngKeyStore::Unwrap(const std::string& name, const uint8_t* wrapped,
+                         size_t wrapped_len, uint8_t* out, size_t out_len) {
+  NCryptObject provider, key;
+  OpenProvider(&provider);
+  if (!OpenKey(provider, Utf8ToWide(name), &key)) return false;
+  BCRYPT_OAEP_PADDING_INFO padding = {BCRYPT_SHA256_ALGORITHM, nullptr, 0};
+  DWORD size = 0;
+  return NCryptDecrypt(key.handle, const_cast<PBYTE>(wrapped),
+                       static_cast<DWORD>(wrapped_len), &padding, out,
+                       static_cast<DWORD>(out_len), &size,
+                       NCRYPT_PAD_OAEP_FLAG) == ERROR_SUCCESS &&
+         size == out_len;
+}
+#else
+// ---------- FileKeyStore ----------
+
+namespace {
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+// BCRYPT_RSAKEY_BLOB header; all fields are little-endian.
+constexpr uint32_t kRsaPublicMagic = 0x31415352;  // "RSA1"
+
+std::string HexName(const std::string& name) {
+  std::string hex;
+  hex.reserve(name.size() * 2);
+  for (unsigned char c : name) {
+    hex.push_back(kHexDigits[c >> 4]);
+    hex.push_back(kHexDigits[c & 0xf]);
+  }
+  return hex;
+}
+
+bool ParseHexName(const std::string& hex, std::string* name) {
+  if (hex.empty() || hex.size() % 2 != 0) return false;
+  name->clear();
+  for (size_t i = 0; i < hex.size(); i += 2) {
+    int value = 0;
+    for (size_t j = i; j < i + 2; ++j) {
+      const char c = hex[j];
+      int digit;
+      if (c >= '0' && c <= '9') {
+        digit = c - '0';
+      } else if (c >= 'a' && c <= 'f') {
+        digit = c - 'a' + 10;
+      } else {
+        return false;
+      }
+      value = value * 16 + digit;
+    }
+    name->push_back(static_cast<char>(value));
+  }
+  return true;
+}
+
+int NoPassword(char*, int, int, void*) { return -1; }
+
+EVP_PKEY* ReadKey(const std::string& path) {
+  BIO* bio = BIO_new_file(path.c_str(), "r");
+  EVP_PKEY* key =
+      bio ? PEM_read_bio_PrivateKey(bio, nullptr, NoPassword, nullptr) : nullptr;
+  BIO_free(bio);
+  ERR_clear_error();
+  return key;
+}
+
+void AppendLe32(uint32_t value, std::vector<uint8_t>* out) {
+  for (int shift = 0; shift < 32; shift += 8) {
+    out->push_back(static_cast<uint8_t>(value >> shift));
+  }
+}
+
+bool AppendBignum(const EVP_PKEY* key, const char* param,
+                  std::vector<uint8_t>* out) {
+  BIGNUM* value = nullptr;
+  if (EVP_PKEY_get_bn_param(key, param, &value) != 1) return false;
+  const size_t offset = out->size();
+  out->resize(offset + static_cast<size_t>(BN_num_bytes(value)));
+  BN_bn2bin(value, out->data() + offset);
+  BN_free(value);
+  return true;
+}
+
+std::vector<uint8_t> RsaPublicBlob(const EVP_PKEY* key) {
+  std::vector<uint8_t> exponent, modulus;
+  if (EVP_PKEY_get_base_id(key) != EVP_PKEY_RSA ||
+      !AppendBignum(key, OSSL_PKEY_PARAM_RSA_E, &exponent) ||
+      !AppendBignum(key, OSSL_PKEY_PARAM_RSA_N, &modulus)) {
+    throw std::runtime_error("Not an RSA key");
+  }
+  // Magic, BitLength, cbPublicExp, cbModulus, cbPrime1, cbPrime2, then the
+  // big-endian exponent and modulus.
+  std::vector<uint8_t> blob;
+  AppendLe32(kRsaPublicMagic, &blob);
+  AppendLe32(static_cast<uint32_t>(EVP_PKEY_get_bits(key)), &blob);
+  AppendLe32(static_cast<uint32_t>(exponent.size()), &blob);
+  AppendLe32(static_cast<uint32_t>(modulus.size()), &blob);
+  AppendLe32(0, &blob);
+  AppendLe32(0, &blob);
+  blob.insert(blob.end(), exponent.begin(), exponent.end());
+  blob.insert(blob.end(), modulus.begin(), modulus.end());
+  return blob;
+}
+
+EVP_PKEY* GenerateRsaKey() {
+  EVP_PKEY_CTX* context = EVP_PKEY_CTX_new_from_name(nullptr, "RSA", nullptr);
+  EVP_PKEY* key = nullptr;
+  bool ok = context && EVP_PKEY_keygen_init(context) == 1 &&
+            EVP_PKEY_CTX_set_rsa_keygen_bits(context, 2048) == 1 &&
+            EVP_PKEY_generate(context, &key) == 1;
+  EVP_PKEY_CTX_free(context);
+  if (!ok) {
+    EVP_PKEY_free(key);
+    ERR_clear_error();
+    throw std::runtime_error("RSA key generation failed");
+  }
+  return key;
+}
+
+// A context for |key| set up for RSA-OAEP with SHA-256 for both the digest
+// and MGF1, as CNG pads with BCRYPT_SHA256_ALGORITHM. |init| is
+// EVP_PKEY_encrypt_init or EVP_PKEY_decrypt_init. Null on failure.
+EVP_PKEY_CTX* OaepContext(EVP_PKEY* key, int (*init)(EVP_PKEY_CTX*)) {
+  EVP_PKEY_CTX* context = EVP_PKEY_CTX_new_from_pkey(nullptr, key, nullptr);
+  if (context && init(context) == 1 &&
+      EVP_PKEY_CTX_set_rsa_padding(context, RSA_PKCS1_OAEP_PADDING) == 1 &&
+      EVP_PKEY_CTX_set_rsa_oaep_md(context, EVP_sha256()) == 1 &&
+      EVP_PKEY_CTX_set_rsa_mgf1_md(context, EVP_sha256()) == 1) {
+    return context;
+  }
+  EVP_PKEY_CTX_free(context);
+  ERR_clear_error();
+  return nullptr;
+}
+
+// Writes |key| to |path| readable only by the owner. The file appears
+// complete or not at all.
+void WriteKey(EVP_PKEY* key, const std::string& path) {
+  const std::string temp = path + ".tmp";
+  int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  FILE* file = fd >= 0 ? fdopen(fd, "w") : nullptr;
+  if (!file) {
+    if (fd >= 0) close(fd);
+    throw std::runtime_error("Cannot create " + temp);
+  }
+  bool ok = PEM_write_PrivateKey(file, key, nullptr, nullptr, 0, nullptr,
+                                 nullptr) == 1 &&
+            fflush(file) == 0 && fsync(fileno(file)) == 0;
+  ok = fclose(file) == 0 && ok;
+  if (!ok || rename(temp.c_str(), path.c_str()) != 0) {
+    unlink(temp.c_str());
+    ERR_clear_error();
+    throw std::runtime_error("Cannot write " + path);
+  }
+}
+
+}  // namespace
+
+FileKeyStore::FileKeyStore(std::string directory)
+    : directory_(std::move(directory)) {}
+
+std::string FileKeyStore::PathOf(const std::string& name) const {
+  return directory_ + "/" + HexName(name) + ".pem";
+}
+
+std::vector<KeyInfo> FileKeyStore::Enumerate() {
+  namespace fs = std::filesystem;
+  std::vector<KeyInfo> keys;
+  std::error_code error;
+  fs::directory_iterator it(fs::u8path(directory_), error);
+  if (error == std::errc::no_such_file_or_directory) return keys;
+  for (fs::directory_iterator end; !error && it != end; it.increment(error)) {
+    const fs::path& path = it->path();
+    KeyInfo info;
+    if (path.extension() != ".pem" ||
+        !ParseHexName(path.stem().string(), &info.name)) {
+      continue;
+    }
+    // The store only creates RSA keys.
+    info.algorithm = "RSA";
+    keys.push_back(std::move(info));
+  }
+  if (error) throw std::runtime_error("Cannot read key directory " + directory_);
+  return keys;
+}
+
+std::optional<KeyInfo> FileKeyStore::Describe(const std::string& name) {
+  const std::string path = PathOf(name);
+  struct stat status;
+  if (stat(path.c_str(), &status) != 0) return std::nullopt;
+  EVP_PKEY* key = ReadKey(path);
+  if (!key) throw std::runtime_error("Cannot read key " + name);
+
+  KeyInfo info;
+  info.name = name;
+  info.has_details = true;
+  info.length_bits = static_cast<uint32_t>(EVP_PKEY_get_bits(key));
+  switch (EVP_PKEY_get_base_id(key)) {
+    case EVP_PKEY_RSA:
+      info.algorithm = "RSA";
+      info.usages = {"decrypt", "sign"};
+      break;
+    case EVP_PKEY_EC:
+      // As CNG names the curves it signs with.
+      info.algorithm = "ECDSA_P" + std::to_string(info.length_bits);
+      info.usages = {"sign"};
+      break;
+    default:
+      if (const char* type = EVP_PKEY_get0_type_name(key)) info.algorithm = type;
+      break;
+  }
+  EVP_PKEY_free(key);
+  info.created = static_cast<int64_t>(status.st_mtim.tv_sec) * 1000 +
+                 status.st_mtim.tv_nsec / 1000000;
+  return info;
+}
+
+std::vector<uint8_t> FileKeyStore::CreateOrOpen(const std::string& name,
+                                                bool* created) {
+  if (directory_.empty()) throw std::runtime_error("No key directory");
+  const std::string path = PathOf(name);
+  std::lock_guard<std::mutex> lock(mutex_);
+  *created = false;
+  EVP_PKEY* key = ReadKey(path);
+  if (!key) {
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::u8path(directory_),
+                                        error);
+    key = GenerateRsaKey();
+    try {
+      WriteKey(key, path);
+    } catch (...) {
+      EVP_PKEY_free(key);
+      throw;
+    }
+    *created = true;
+  }
+  try {
+    std::vector<uint8_t> blob = RsaPublicBlob(key);
+    EVP_PKEY_free(key);
+    return blob;
+  } catch (...) {
+    EVP_PKEY_free(key);
+    throw;
+  }
+}
+
+bool FileKeyStore::Delete(const std::string& name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return unlink(PathOf(name).c_str()) == 0;
+}
+
+std::vector<uint8_t> FileKeyStore::Wrap(const std::string& name,
+                                        const uint8_t* data, size_t len) {
+  EVP_PKEY* key = ReadKey(PathOf(name));
+  if (!key) throw std::runtime_error("No key named " + name);
+  EVP_PKEY_CTX* context = OaepContext(key, EVP_PKEY_encrypt_init);
+  std::vector<uint8_t> wrapped;
+  size_t size = 0;
+  bool ok = context &&
+            EVP_PKEY_encrypt(context, nullptr, &size, data, len) == 1;
+  if (ok) {
+    wrapped.resize(size);
+    ok = EVP_PKEY_encrypt(context, wrapped.data(), &size, data, len) == 1;
+    wrapped.resize(size);
+  }
+  EVP_PKEY_CTX_free(context);
+  EVP_PKEY_free(key);
+  if (!ok) {
+    ERR_clear_error();
+    throw std::runtime_error("RSA-OAEP encryption failed");
+  }
+  return wrapped;
+}
+
+bool FileKeyStore::Unwrap(const std::string& name, const uint8_t* wrapped,
+                          size_t wrapped_len, uint8_t* out, size_t out_len) {
+  EVP_PKEY* key = ReadKey(PathOf(name));
+  if (!key) return false;
+  EVP_PKEY_CTX* context = OaepContext(key, EVP_PKEY_decrypt_init);
+  // Decrypted into a buffer the size of the modulus, which is what OpenSSL
+  // requires of |out|, then copied out only if the length matches.
+  SecureBytes plain(static_cast<size_t>(EVP_PKEY_get_size(key)));
+  size_t size = plain.size();
+  const bool ok = context &&
+                  EVP_PKEY_decrypt(context, plain.data(), &size, wrapped,
+                                   wrapped_len) == 1 &&
+                  size == out_len;
+  if (ok) std::copy(plain.begin(), plain.begin() + size, out);
+  EVP_PKEY_CTX_free(context);
+  EVP_PKEY_free(key);
+  ERR_clear_error();
+  return ok;
+}
+#endif
+
+// ---------- KeyIndex ----------
+
+KeyIndex::KeyIndex(std::unique_ptr<KeyStore> store)
+    : store_(std::move(store)) {}
+
+void KeyIndex::EnsureBuilt() {
+  if (built_) return;
+  std::map<std::string, KeyInfo> keys;
+  for (KeyInfo& info : store_->Enumerate()) {
+    // Keys described or created before the first listing keep their
+    // details.
+    auto known = keys_.find(info.name);
+    if (known != keys_.end() && known->second.has_details) {
+      info = known->second;
+    }
+    std::string name = info.name;
+    keys.emplace(std::move(name), std::move(info));
+  }
+  keys_ = std::move(keys);
+  built_ = true;
+}
+
+KeyPage KeyIndex::List(const std::string& prefix, const std::string& after,
+                       size_t page_size) {
+  if (page_size == 0 || page_size > kMaxPageSize) {
+    throw std::invalid_argument("pageSize must be between 1 and 1000");
+  }
+  auto matches = [&prefix](const std::string& name) {
+    return name.compare(0, prefix.size(), prefix) == 0;
+  };
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  EnsureBuilt();
+  KeyPage page;
+  auto it = after < prefix ? keys_.lower_bound(prefix) : keys_.upper_bound(after);
+  for (; it != keys_.end() && matches(it->first) &&
+         page.keys.size() < page_size;
+       ++it) {
+    page.keys.push_back(it->second);
+  }
+  page.done = it == keys_.end() || !matches(it->first);
+  if (!page.keys.empty()) page.last = page.keys.back().name;
+  return page;
+}
+
+std::optional<KeyInfo> KeyIndex::Info(const std::string& name) {
+  if (name.empty()) throw std::invalid_argument("Empty key name");
+  uint64_t deletions_before;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = keys_.find(name);
+    if (it != keys_.end() && it->second.has_details) return it->second;
+    deletions_before = deletions();
+  }
+
+  std::optional<KeyInfo> info = store_->Describe(name);
+  std::lock_guard<std::mutex> lock(mutex_);
+  // A deletion in the meantime may have been of this key.
+  if (deletions() == deletions_before) {
+    if (info) {
+      keys_[name] = *info;
+    } else {
+      keys_.erase(name);
+    }
+  }
+  return info;
+}
+
+std::vector<uint8_t> KeyIndex::CreateOrOpen(const std::string& name) {
+  if (name.empty()) throw std::invalid_argument("Empty key name");
+  bool created = false;
+  std::vector<uint8_t> public_key = store_->CreateOrOpen(name, &created);
+  if (created) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Details of an earlier key of that name, deleted by another process,
+    // are stale.
+    keys_.erase(name);
+  }
+  // Opens the key again only if its details are not known yet.
+  Info(name);
+  return public_key;
+}
+
+bool KeyIndex::Delete(const std::string& name) {
+  if (name.empty()) throw std::invalid_argument("Empty key name");
+  const bool deleted = store_->Delete(name);
+  std::lock_guard<std::mutex> lock(mutex_);
+  keys_.erase(name);
+  if (deleted) deletions_.fetch_add(1, std::memory_order_release);
+  return deleted;
+}
+
+std::vector<uint8_t> KeyIndex::Wrap(const std::string& name,
+                                    const uint8_t* data, size_t len) {
+  if (name.empty()) throw std::invalid_argument("Empty key name");
+  if (len > KeyStore::kMaxWrapLen) {
+    throw std::invalid_argument("Too much data to wrap");
+  }
+  return store_->Wrap(name, data, len);
+}
+
+bool KeyIndex::Unwrap(const std::string& name, const uint8_t* wrapped,
+                      size_t wrapped_len, uint8_t* out, size_t out_len) {
+  if (name.empty()) throw std::invalid_argument("Empty key name");
+  return store_->Unwrap(name, wrapped, wrapped_len, out, out_len);
+}
+
+void KeyIndex::Load() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  EnsureBuilt();
+}
+
+void KeyIndex::Reload() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  keys_.clear();
+  built_ = false;
+}
+
+// ---------- DataKeyCache ----------
+
+// Key names cannot contain NUL, so this is unambiguous.
+static std::string DataKeyCacheKey(const std::string& key_name,
+                                   const std::vector<uint8_t>& wrapped) {
+  std::string cache_key;
+  cache_key.reserve(key_name.size() + 1 + wrapped.size());
+  cache_key.append(key_name);
+  cache_key.push_back('\0');
+  cache_key.append(wrapped.begin(), wrapped.end());
+  return cache_key;
+}
+
+DataKeyCache::DataKeyCache(KeyIndex* keys, size_t capacity)
+    : keys_(keys), capacity_(std::max<size_t>(capacity, 1)) {}
+
+std::shared_ptr<const AesGcmKey> DataKeyCache::Touch(
+    const std::string& cache_key) {
+  auto it = by_key_.find(cache_key);
+  if (it == by_key_.end()) return nullptr;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->key;
+}
+
+std::shared_ptr<const AesGcmKey> DataKeyCache::Find(
+    const std::string& key_name, const std::vector<uint8_t>& wrapped) {
+  const std::string cache_key = DataKeyCacheKey(key_name, wrapped);
+  std::lock_guard<std::mutex> lock(mutex_);
+  return Touch(cache_key);
+}
+
+std::shared_ptr<const AesGcmKey> DataKeyCache::Unwrap(
+    const std::string& key_name, const std::vector<uint8_t>& wrapped) {
+  std::string cache_key = DataKeyCacheKey(key_name, wrapped);
+  uint64_t deletions_before;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (std::shared_ptr<const AesGcmKey> key = Touch(cache_key)) return key;
+    deletions_before = keys_->deletions();
+  }
+
+  // Cached keys live in the secure pool: locked, and wiped when released.
+  std::shared_ptr<AesGcmKey> data_key =
+      std::allocate_shared<AesGcmKey>(SecureAllocator<AesGcmKey>());
+  if (!keys_->Unwrap(key_name, wrapped.data(), wrapped.size(),
+                     data_key->data(), data_key->size())) {
+    throw std::invalid_argument("wrappedKey cannot be unwrapped by keyName");
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // A deletion in the meantime may have been of this key.
+  if (keys_->deletions() != deletions_before) return data_key;
+  // Another caller may have unwrapped it meanwhile.
+  if (std::shared_ptr<const AesGcmKey> key = Touch(cache_key)) return key;
+  if (entries_.size() >= capacity_) {
+    by_key_.erase(entries_.back().cache_key);
+    entries_.pop_back();
+  }
+  entries_.push_front(Entry{cache_key, key_name, data_key});
+  by_key_.emplace(std::move(cache_key), entries_.begin());
+  return data_key;
+}
+
+void DataKeyCache::Forget(const std::string& key_name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->key_name == key_name) {
+      by_key_.erase(it->cache_key);
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+size_t DataKeyCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+}  // namespace flutter_native_utils
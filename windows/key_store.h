@@ -0,0 +1,238 @@
+#ifndef FLUTTER_PLUGIN_KEY_STORE_H_
+#define FLUTTER_PLUGIN_KEY_STORE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "aes_gcm.h"
+
+namespace flutter_native_utils {
+
+// Metadata of one persisted key pair. No key material is kept.
+struct KeyInfo {
+  std::string name;
+  std::string algorithm;  // CNG algorithm id, e.g. "RSA".
+  // The fields below are only known once the key has been opened; listing a
+  // store does not open its keys.
+  bool has_details = false;
+  uint32_t length_bits = 0;
+  // Milliseconds since the Unix epoch. Persisted keys are never modified
+  // after they are finalized, so this is their last-modified time.
+  int64_t created = 0;
+  // Any of "decrypt", "sign" and "keyAgreement".
+  std::vector<std::string> usages;
+};
+
+// A store of named key pairs, such as the one CreateKeyPair creates its keys
+// in. Thread-safe.
+class KeyStore {
+ public:
+  virtual ~KeyStore() = default;
+
+  // Every stored key, with only its name and algorithm set. Throws
+  // std::runtime_error if the store cannot be read.
+  virtual std::vector<KeyInfo> Enumerate() = 0;
+
+  // Opens |name| and reads all of its metadata, or returns nullopt if there
+  // is no such key.
+  virtual std::optional<KeyInfo> Describe(const std::string& name) = 0;
+
+  // Creates a 2048-bit RSA key pair named |name| unless one exists, and
+  // returns its public key as a BCRYPT_RSAPUBLIC_BLOB. Sets |*created| to
+  // whether it was created. Throws std::runtime_error on failure.
+  virtual std::vector<uint8_t> CreateOrOpen(const std::string& name,
+                                            bool* created) = 0;
+
+  // Returns false if there was no such key.
+  virtual bool Delete(const std::string& name) = 0;
+
+  // Encrypts |len| bytes (at most kMaxWrapLen) to the public key of |name|
+  // with RSA-OAEP and SHA-256, so only that key can recover them. Throws
+  // std::runtime_error if there is no such key or encryption fails.
+  virtual std::vector<uint8_t> Wrap(const std::string& name,
+                                    const uint8_t* data, size_t len) = 0;
+
+  // Decrypts what Wrap returned into |out|. Returns false, leaving |out|
+  // unspecified, if there is no such key or |wrapped| does not decrypt to
+  // exactly |out_len| bytes under it.
+  virtual bool Unwrap(const std::string& name, const uint8_t* wrapped,
+                      size_t wrapped_len, uint8_t* out, size_t out_len) = 0;
+
+  // The most bytes a 2048-bit key can wrap with OAEP and SHA-256.
+  static constexpr size_t kMaxWrapLen = 190;
+};
+
+#ifdef _WIN32
+// The current user's keys in the Microsoft Software Key Storage Provider.
+class CngKeyStore : public KeyStore {
+ public:
+  std::vector<KeyInfo> Enumerate() override;
+  std::optional<KeyInfo> Describe(const std::string& name) override;
+  std::vector<uint8_t> CreateOrOpen(const std::string& name,
+                                    bool* created) override;
+  bool Delete(const std::string& name) override;
+  std::vector<uint8_t> Wrap(const std::string& name, const uint8_t* data,
+                            size_t len) override;
+  bool Unwrap(const std::string& name, const uint8_t* wrapped,
+              size_t wrapped_len, uint8_t* out, size_t out_len) override;
+};
+#else
+// Keys stored as unencrypted PKCS#8 PEM files directly under |directory|,
+// one per key, named by the hex of the key's UTF-8 name, so any name maps
+// to a safe file name. The directory is created with the first key. Stands
+// in for the CNG key store on Linux hosts.
+class FileKeyStore : public KeyStore {
+ public:
+  explicit FileKeyStore(std::string directory);
+
+  std::vector<KeyInfo> Enumerate() override;
+  std::optional<KeyInfo> Describe(const std::string& name) override;
+  std::vector<uint8_t> CreateOrOpen(const std::string& name,
+                                    bool* created) override;
+  bool Delete(const std::string& name) override;
+  std::vector<uint8_t> Wrap(const std::string& name, const uint8_t* data,
+                            size_t len) override;
+  bool Unwrap(const std::string& name, const uint8_t* wrapped,
+              size_t wrapped_len, uint8_t* out, size_t out_len) override;
+
+ private:
+  std::string PathOf(const std::string& name) const;
+
+  std::string directory_;
+  // Serializes creation and deletion, so two creators of one name cannot
+  // each return a different key.
+  std::mutex mutex_;
+};
+#endif
+
+struct KeyPage {
+  std::vector<KeyInfo> keys;
+  // Name of the last key returned; pass it as |after| for the next page.
+  std::string last;
+  bool done = true;
+};
+
+// Metadata of every key in a store, enumerated once and then kept current
+// by the creations and deletions made through the index, so neither
+// listing nor paging opens a key. Details are filled in when a key is
+// created through the index or first described. Keys changed by other
+// processes show up after Reload(). Thread-safe.
+class KeyIndex {
+ public:
+  static constexpr size_t kMaxPageSize = 1000;
+
+  explicit KeyIndex(std::unique_ptr<KeyStore> store);
+
+  // Disallow copy and assign.
+  KeyIndex(const KeyIndex&) = delete;
+  KeyIndex& operator=(const KeyIndex&) = delete;
+
+  // Returns up to |page_size| keys whose names start with |prefix| and sort
+  // after |after|, in name order. Throws std::invalid_argument if
+  // |page_size| is not in [1, kMaxPageSize], and std::runtime_error if the
+  // store cannot be enumerated.
+  KeyPage List(const std::string& prefix, const std::string& after,
+               size_t page_size);
+
+  // Full metadata of |name|, opening the key only the first time, or
+  // nullopt if there is no such key.
+  std::optional<KeyInfo> Info(const std::string& name);
+
+  // See KeyStore::CreateOrOpen.
+  std::vector<uint8_t> CreateOrOpen(const std::string& name);
+
+  // Returns false if there was no such key.
+  bool Delete(const std::string& name);
+
+  // See KeyStore::Wrap and KeyStore::Unwrap.
+  std::vector<uint8_t> Wrap(const std::string& name, const uint8_t* data,
+                            size_t len);
+  bool Unwrap(const std::string& name, const uint8_t* wrapped,
+              size_t wrapped_len, uint8_t* out, size_t out_len);
+
+  // Enumerates the store now unless that was already done, as List would.
+  void Load();
+
+  // Forgets the enumeration; the next List reads the store again.
+  void Reload();
+
+  // Deletions made through the index so far. Caches of material derived
+  // from stored keys drop it when this changes.
+  uint64_t deletions() const {
+    return deletions_.load(std::memory_order_acquire);
+  }
+
+ private:
+  // Enumerates the store unless that was already done. Requires |mutex_|.
+  void EnsureBuilt();
+
+  std::unique_ptr<KeyStore> store_;
+  std::atomic<uint64_t> deletions_{0};
+
+  std::mutex mutex_;
+  bool built_ = false;
+  std::map<std::string, KeyInfo> keys_;
+};
+
+// Data keys unwrapped by the keys of an index. Unwrapping is an RSA
+// private-key operation, so one cache serves every engine. Holds up to
+// |capacity| keys in the secure pool, evicting the least recently used one
+// when full. Thread-safe.
+class DataKeyCache {
+ public:
+  static constexpr size_t kDefaultCapacity = 64;
+
+  explicit DataKeyCache(KeyIndex* keys, size_t capacity = kDefaultCapacity);
+
+  // Disallow copy and assign.
+  DataKeyCache(const DataKeyCache&) = delete;
+  DataKeyCache& operator=(const DataKeyCache&) = delete;
+
+  // The data key |key_name| wrapped as |wrapped|, or null if it is not
+  // cached. Never unwraps.
+  std::shared_ptr<const AesGcmKey> Find(const std::string& key_name,
+                                        const std::vector<uint8_t>& wrapped);
+
+  // As Find, but unwraps and caches the key on a miss, without holding the
+  // cache locked meanwhile. Throws std::invalid_argument if |key_name|
+  // cannot unwrap |wrapped|, and as KeyIndex::Unwrap does.
+  std::shared_ptr<const AesGcmKey> Unwrap(const std::string& key_name,
+                                          const std::vector<uint8_t>& wrapped);
+
+  // Drops the data keys of |key_name|, e.g. once it is deleted. Keys being
+  // unwrapped by then are not cached if it was deleted through the index.
+  void Forget(const std::string& key_name);
+
+  size_t size() const;
+
+ private:
+  struct Entry {
+    std::string cache_key;
+    std::string key_name;
+    std::shared_ptr<const AesGcmKey> key;
+  };
+
+  // Finds |cache_key| and marks it most recently used. Requires |mutex_|.
+  std::shared_ptr<const AesGcmKey> Touch(const std::string& cache_key);
+
+  KeyIndex* const keys_;
+  const size_t capacity_;
+
+  mutable std::mutex mutex_;
+  // Most recently used first.
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> by_key_;
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_KEY_STORE_H_
@@ -0,0 +1,229 @@
+#include "load_driver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace flutter_native_utils {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int64_t MicrosecondsBetween(Clock::time_point from, Clock::time_point to) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(to - from)
+      .count();
+}
+
+// The calls of one load thread. Completions may arrive on any thread, and
+// after RunLoadTest has given up on them, so done callbacks share it.
+struct ThreadState {
+  explicit ThreadState(size_t methods)
+      : latencies(methods), errors(methods), not_implemented(methods) {}
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  size_t in_flight = 0;
+  // Indexed like the mix.
+  std::vector<std::vector<int64_t>> latencies;
+  std::vector<size_t> errors;
+  std::vector<size_t> not_implemented;
+  size_t skipped = 0;
+  size_t duplicate_completions = 0;
+  uint64_t result_bytes = 0;
+};
+
+void RunLoadThread(const LoadTestOptions& options,
+                   const LoadDispatcher& dispatcher, size_t thread,
+                   Clock::time_point start,
+                   const std::shared_ptr<ThreadState>& state) {
+  std::vector<double> weights;
+  for (const LoadMixEntry& entry : options.mix) weights.push_back(entry.weight);
+  std::mt19937_64 rng(options.seed + thread * 0x9e3779b97f4a7c15ull);
+  std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+  std::uniform_int_distribution<size_t> payload(options.min_payload_bytes,
+                                                options.max_payload_bytes);
+
+  const Clock::time_point end = start + options.duration;
+  const bool paced = options.calls_per_second > 0;
+  const auto interval =
+      paced ? std::chrono::duration_cast<Clock::duration>(
+                  std::chrono::duration<double>(
+                      static_cast<double>(options.threads) /
+                      options.calls_per_second))
+            : Clock::duration::zero();
+  // Threads are staggered so the aggregate rate is even.
+  Clock::time_point next_due =
+      start + interval * static_cast<int64_t>(thread) /
+                  static_cast<int64_t>(options.threads);
+
+  for (uint64_t sequence = 0;;) {
+    if (options.max_calls_per_thread &&
+        sequence >= options.max_calls_per_thread) {
+      break;
+    }
+    Clock::time_point due;
+    if (paced) {
+      due = next_due;
+      if (due >= end) break;
+      std::this_thread::sleep_until(due);
+      next_due += interval;
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (state->in_flight >= options.max_in_flight_per_thread) {
+        ++state->skipped;
+        continue;
+      }
+      ++state->in_flight;
+    } else {
+      due = Clock::now();
+      if (due >= end) break;
+      std::lock_guard<std::mutex> lock(state->mutex);
+      ++state->in_flight;
+    }
+
+    const size_t entry = pick(rng);
+    auto completed = std::make_shared<bool>(false);
+    ReplayDone done = [state, completed, entry, due](MethodCallOutcome outcome,
+                                                    uint64_t result_bytes) {
+      const Clock::time_point now = Clock::now();
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (*completed) {
+        ++state->duplicate_completions;
+        return;
+      }
+      *completed = true;
+      --state->in_flight;
+      state->latencies[entry].push_back(MicrosecondsBetween(due, now));
+      if (outcome == MethodCallOutcome::kError) ++state->errors[entry];
+      if (outcome == MethodCallOutcome::kNotImplemented) {
+        ++state->not_implemented[entry];
+      }
+      state->result_bytes += result_bytes;
+      state->changed.notify_all();
+    };
+    try {
+      dispatcher(LoadCall{options.mix[entry].method, payload(rng), thread,
+                          sequence++},
+                 done);
+    } catch (const std::exception&) {
+      done(MethodCallOutcome::kError, 0);
+    }
+
+    if (!paced) {
+      std::unique_lock<std::mutex> lock(state->mutex);
+      // A call that never completes ends this thread's run; it is reported
+      // as unfinished.
+      if (!state->changed.wait_until(
+              lock, end + options.drain_timeout,
+              [&state] { return state->in_flight == 0; })) {
+        break;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+std::vector<LoadMixEntry> ParseLoadMix(const std::string& text) {
+  std::vector<LoadMixEntry> mix;
+  std::set<std::string> seen;
+  size_t begin = 0;
+  while (begin <= text.size()) {
+    size_t comma = text.find(',', begin);
+    if (comma == std::string::npos) comma = text.size();
+    const std::string item = text.substr(begin, comma - begin);
+    begin = comma + 1;
+
+    LoadMixEntry entry;
+    const size_t equals = item.find('=');
+    entry.method = item.substr(0, equals);
+    if (equals != std::string::npos) {
+      const std::string weight = item.substr(equals + 1);
+      char* end = nullptr;
+      entry.weight = std::strtod(weight.c_str(), &end);
+      if (weight.empty() || *end != '\0' || !std::isfinite(entry.weight) ||
+          entry.weight <= 0) {
+        throw std::invalid_argument("Invalid weight for " + entry.method +
+                                    ": " + weight);
+      }
+    }
+    if (entry.method.empty()) throw std::invalid_argument("Empty method name");
+    if (!seen.insert(entry.method).second) {
+      throw std::invalid_argument("Method listed twice: " + entry.method);
+    }
+    mix.push_back(std::move(entry));
+  }
+  return mix;
+}
+
+LoadTestReport RunLoadTest(const LoadTestOptions& options,
+                           const LoadDispatcher& dispatcher) {
+  if (options.mix.empty()) throw std::invalid_argument("Empty method mix");
+  if (options.threads == 0) throw std::invalid_argument("No load threads");
+  if (options.min_payload_bytes > options.max_payload_bytes) {
+    throw std::invalid_argument("Inverted payload size range");
+  }
+
+  std::vector<std::shared_ptr<ThreadState>> states;
+  for (size_t i = 0; i < options.threads; ++i) {
+    states.push_back(std::make_shared<ThreadState>(options.mix.size()));
+  }
+  const Clock::time_point start = Clock::now();
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < options.threads; ++i) {
+    threads.emplace_back([&options, &dispatcher, i, start, &states]() {
+      RunLoadThread(options, dispatcher, i, start, states[i]);
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  const Clock::time_point deadline =
+      std::max(Clock::now(), start + options.duration) + options.drain_timeout;
+  LoadTestReport report;
+  std::vector<std::vector<int64_t>> latencies(options.mix.size());
+  std::vector<int64_t> all;
+  for (const std::shared_ptr<ThreadState>& state : states) {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->changed.wait_until(lock, deadline,
+                              [&state] { return state->in_flight == 0; });
+    report.unfinished += state->in_flight;
+    report.skipped += state->skipped;
+    report.duplicate_completions += state->duplicate_completions;
+    report.result_bytes += state->result_bytes;
+    for (size_t m = 0; m < options.mix.size(); ++m) {
+      LoadMethodReport& method = report.by_method[options.mix[m].method];
+      method.errors += state->errors[m];
+      method.not_implemented += state->not_implemented[m];
+      latencies[m].insert(latencies[m].end(), state->latencies[m].begin(),
+                          state->latencies[m].end());
+    }
+  }
+  report.elapsed_seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+
+  for (size_t m = 0; m < options.mix.size(); ++m) {
+    LoadMethodReport& method = report.by_method[options.mix[m].method];
+    method.calls = latencies[m].size();
+    report.calls += method.calls;
+    report.errors += method.errors;
+    report.not_implemented += method.not_implemented;
+    all.insert(all.end(), latencies[m].begin(), latencies[m].end());
+    method.latency = SummarizeLatencies(&latencies[m]);
+  }
+  report.latency = SummarizeLatencies(&all);
+  if (report.elapsed_seconds > 0) {
+    report.calls_per_second =
+        static_cast<double>(report.calls) / report.elapsed_seconds;
+  }
+  return report;
+}
+
+}  // namespace flutter_native_utils
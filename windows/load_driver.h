@@ -0,0 +1,106 @@
+#ifndef FLUTTER_PLUGIN_LOAD_DRIVER_H_
+#define FLUTTER_PLUGIN_LOAD_DRIVER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "method_call_replay.h"
+
+namespace flutter_native_utils {
+
+// A method and its share of a load-test mix.
+struct LoadMixEntry {
+  std::string method;
+  double weight = 1;
+};
+
+// Parses "Encrypt=4,GetRandomBytes,HashFiles=0.5"; a method without a
+// weight has weight 1. Throws std::invalid_argument if a weight is not a
+// positive number or a method is empty or repeated.
+std::vector<LoadMixEntry> ParseLoadMix(const std::string& text);
+
+// One generated call, valid only for the duration of the dispatch.
+struct LoadCall {
+  const std::string& method;
+  size_t payload_bytes;
+  // The issuing thread, in [0, threads), and its count of calls so far, so
+  // dispatchers can keep per-thread state such as one engine per thread.
+  size_t thread;
+  uint64_t sequence;
+};
+
+// Starts |call| and reports it through |done|, exactly once, from any
+// thread. Called concurrently from every load thread. A throw counts as an
+// error completion.
+using LoadDispatcher = std::function<void(const LoadCall& call, ReplayDone done)>;
+
+struct LoadTestOptions {
+  std::vector<LoadMixEntry> mix;
+  size_t threads = 8;
+  // Aggregate rate at which calls are issued. Zero runs closed-loop: each
+  // thread issues its next call as soon as its previous one completes.
+  double calls_per_second = 0;
+  std::chrono::milliseconds duration{5000};
+  // If nonzero, each thread stops once it has issued this many calls, even
+  // before |duration| has passed.
+  size_t max_calls_per_thread = 0;
+  // Payload sizes are drawn uniformly from this range.
+  size_t min_payload_bytes = 1024;
+  size_t max_payload_bytes = 1024;
+  // Calls one thread may have outstanding at a fixed rate. Calls falling due
+  // beyond it are skipped and counted rather than queued.
+  size_t max_in_flight_per_thread = 64;
+  // How long to wait after |duration| for outstanding calls.
+  std::chrono::milliseconds drain_timeout{10000};
+  uint64_t seed = 1;
+};
+
+struct LoadMethodReport {
+  size_t calls = 0;
+  size_t errors = 0;
+  size_t not_implemented = 0;
+  LatencySummary latency;
+};
+
+struct LoadTestReport {
+  // Completed calls, including failed ones.
+  size_t calls = 0;
+  size_t errors = 0;
+  size_t not_implemented = 0;
+  // Calls not issued because their thread had too many in flight.
+  size_t skipped = 0;
+  // Calls still outstanding when the drain timeout passed.
+  size_t unfinished = 0;
+  // Completions reported more than once for the same call.
+  size_t duplicate_completions = 0;
+  double elapsed_seconds = 0;
+  double calls_per_second = 0;
+  uint64_t result_bytes = 0;
+  // At a fixed rate, measured from when each call was due rather than when
+  // it was issued, so a stalled dispatcher shows in the percentiles.
+  LatencySummary latency;
+  std::map<std::string, LoadMethodReport> by_method;
+
+  // Every call completed exactly once and none failed.
+  bool ok() const {
+    return errors == 0 && not_implemented == 0 && unfinished == 0 &&
+           duplicate_completions == 0;
+  }
+};
+
+// Issues calls drawn from |options.mix| through |dispatcher| from
+// |options.threads| threads for |options.duration| (or until each has issued
+// |options.max_calls_per_thread|), then waits for them to complete. Throws
+// std::invalid_argument for an empty mix, no threads or an inverted payload
+// range.
+LoadTestReport RunLoadTest(const LoadTestOptions& options,
+                           const LoadDispatcher& dispatcher);
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_LOAD_DRIVER_H_
@@ -0,0 +1,509 @@
+// Fires a weighted mix of channel methods from many threads at once and
+// reports throughput, latency percentiles and any call that failed, never
+// completed or completed twice. Exits non-zero in those cases, so it also
+// serves as a concurrency check under the sanitizer builds.
+//
+// Usage: flutter_native_utils_load_test [--mix=METHOD[=WEIGHT],...]
+//            [--threads=N] [--rate=CALLS_PER_S] [--duration=MS]
+//            [--payload=BYTES|MIN-MAX] [--in-flight=N] [--seed=N]
+//
+// Without --rate each thread issues its next call when the previous one
+// completes. The default mix is every method the dispatcher supports in
+// this build's features, at weight 1.
+//
+// On Windows each load thread drives its own plugin instance through
+// HandleMethodCall, as each engine of a multi-window app does from its own
+// platform thread, and the instances share the process-wide backends.
+// Instances without a registrar refuse the methods that need one, so only
+// the rest are offered. On Linux, where the plugin does not build, calls
+// run on the portable backends the handlers use, in the same scheduling
+// classes and on the same kind of threads; CNG-bound calls are fakes that
+// occupy a worker for a typical duration.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "load_driver.h"
+
+#ifdef _WIN32
+#include <flutter/encodable_value.h>
+#include <flutter/method_call.h>
+#include <flutter/method_result_functions.h>
+#include <flutter/standard_method_codec.h>
+
+#include "flutter_native_utils_plugin.h"
+#else
+#include "aes_gcm.h"
+#include "backend_hub.h"
+#include "buffered_random.h"
+#include "hmac_session.h"
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE
+#include "affine_executor.h"
+#include "device_fingerprint.h"
+#include "inventory.h"
+#endif
+
+#include <unistd.h>
+#endif
+
+namespace {
+
+using namespace flutter_native_utils;
+
+struct Options {
+  LoadTestOptions load;
+  bool mix_given = false;
+};
+
+// Deterministic payload contents, distinct per call.
+std::vector<uint8_t> Payload(const LoadCall& call) {
+  std::vector<uint8_t> payload(call.payload_bytes);
+  for (size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<uint8_t>(i + call.sequence + call.thread * 31);
+  }
+  return payload;
+}
+
+#ifdef _WIN32
+class PluginDispatcher {
+ public:
+  explicit PluginDispatcher(size_t threads) {
+    for (size_t i = 0; i < threads; ++i) {
+      auto plugin = std::make_unique<FlutterNativeUtilsPlugin>();
+      int64_t session_id = 0;
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+      plugin->HandleMethodCall(
+          flutter::MethodCall<flutter::EncodableValue>(
+              "CreateHmacSession",
+              std::make_unique<flutter::EncodableValue>(flutter::EncodableMap{
+                  {flutter::EncodableValue("key"),
+                   flutter::EncodableValue(std::vector<uint8_t>(32, 0x5a))},
+              })),
+          std::make_unique<flutter::MethodResultFunctions<>>(
+              [&session_id](const flutter::EncodableValue* result) {
+                session_id = result->LongValue();
+              },
+              nullptr, nullptr));
+#endif
+      plugins_.push_back(std::move(plugin));
+      hmac_sessions_.push_back(session_id);
+    }
+  }
+
+  static std::vector<std::string> Methods() {
+    std::vector<std::string> methods = {"GetRandomBytes", "GetSchedulerStats",
+                                        "GetStartupTimeline"};
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+    methods.push_back("ComputeHmacs");
+#endif
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE
+    methods.insert(methods.end(), {"RequestCpuTopology", "RequestHardwareInfo",
+                                   "QueryInventory", "GetDeviceFingerprint"});
+#endif
+    return methods;
+  }
+
+  void Dispatch(const LoadCall& call, ReplayDone done) {
+    auto shared_done = std::make_shared<ReplayDone>(std::move(done));
+    plugins_[call.thread]->HandleMethodCall(
+        flutter::MethodCall<flutter::EncodableValue>(
+            call.method,
+            std::make_unique<flutter::EncodableValue>(Arguments(call))),
+        std::make_unique<flutter::MethodResultFunctions<>>(
+            [shared_done](const flutter::EncodableValue* result) {
+              uint64_t bytes = 0;
+              if (result) {
+                bytes = flutter::StandardMessageCodec::GetInstance()
+                            .EncodeMessage(*result)
+                            ->size();
+              }
+              (*shared_done)(MethodCallOutcome::kSuccess, bytes);
+            },
+            [shared_done](const std::string&, const std::string&,
+                          const flutter::EncodableValue*) {
+              (*shared_done)(MethodCallOutcome::kError, 0);
+            },
+            [shared_done]() {
+              (*shared_done)(MethodCallOutcome::kNotImplemented, 0);
+            }));
+  }
+
+ private:
+  flutter::EncodableValue Arguments(const LoadCall& call) const {
+    if (call.method == "GetRandomBytes") {
+      return flutter::EncodableValue(flutter::EncodableMap{
+          {flutter::EncodableValue("length"),
+           flutter::EncodableValue(static_cast<int32_t>(call.payload_bytes))},
+      });
+    }
+    if (call.method == "ComputeHmacs") {
+      // API-request-sized messages.
+      std::vector<uint8_t> payload = Payload(call);
+      flutter::EncodableList messages;
+      for (size_t offset = 0; offset < payload.size(); offset += 256) {
+        const size_t len = std::min<size_t>(256, payload.size() - offset);
+        messages.push_back(flutter::EncodableValue(std::vector<uint8_t>(
+            payload.begin() + offset, payload.begin() + offset + len)));
+      }
+      return flutter::EncodableValue(flutter::EncodableMap{
+          {flutter::EncodableValue("sessionId"),
+           flutter::EncodableValue(hmac_sessions_[call.thread])},
+          {flutter::EncodableValue("messages"),
+           flutter::EncodableValue(std::move(messages))},
+      });
+    }
+    if (call.method == "QueryInventory") {
+      return flutter::EncodableValue(flutter::EncodableMap{
+          {flutter::EncodableValue("class"),
+           flutter::EncodableValue("Win32_Processor")},
+          {flutter::EncodableValue("columns"),
+           flutter::EncodableValue(flutter::EncodableList{
+               flutter::EncodableValue("Name"),
+               flutter::EncodableValue("NumberOfCores")})},
+          {flutter::EncodableValue("pageSize"), flutter::EncodableValue(1000)},
+      });
+    }
+    if (call.method == "GetDeviceFingerprint") {
+      return flutter::EncodableValue(flutter::EncodableMap{
+          {flutter::EncodableValue("salt"),
+           flutter::EncodableValue(std::vector<uint8_t>(16, 0x5a))},
+      });
+    }
+    return flutter::EncodableValue();
+  }
+
+  std::vector<std::unique_ptr<FlutterNativeUtilsPlugin>> plugins_;
+  std::vector<int64_t> hmac_sessions_;
+};
+#else
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE
+// Stands in for the plugin's WMI thread.
+struct FakeWmiSession {
+  InventoryEngine inventory{std::make_unique<SysfsInventoryProvider>()};
+};
+#endif
+
+class PortableDispatcher {
+ public:
+  PortableDispatcher(BackendHub* hub, std::string hash_file)
+      : hub_(hub),
+        hash_file_(std::move(hash_file)),
+        hmac_(MacAlgorithm::kHmacSha256, hmac_key_, sizeof(hmac_key_)) {
+    FillRandomBuffered(key_.data(), key_.size());
+  }
+
+  static std::vector<std::string> Methods() {
+    std::vector<std::string> methods = {"GetRandomBytes", "HashFiles",
+                                        "GetSchedulerStats"};
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+    methods.insert(methods.end(),
+                   {"Encrypt", "Decrypt", "ComputeHmacs", "SignNonce",
+                    "GenerateDataKey", "CreateKeyPair"});
+#endif
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE
+    methods.insert(methods.end(), {"QueryInventory", "RequestHardwareInfo",
+                                   "GetDeviceFingerprint"});
+#endif
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+    methods.push_back("GetCertificate");
+#endif
+    return methods;
+  }
+
+  void Dispatch(const LoadCall& call, ReplayDone done) {
+    if (call.method == "GetRandomBytes") {
+      std::vector<uint8_t> bytes(call.payload_bytes);
+      FillRandomBuffered(bytes.data(), bytes.size());
+      done(MethodCallOutcome::kSuccess, bytes.size());
+    } else if (call.method == "Encrypt") {
+      const size_t expected =
+          AesGcmCiphertextLen(call.payload_bytes, kAesGcmDefaultChunkLen);
+      AesGcmEncryptAsync(key_, Payload(call), {}, hub_->workers(),
+                         [done, expected](bool ok, std::vector<uint8_t> out) {
+                           ok = ok && out.size() == expected;
+                           done(ok ? MethodCallOutcome::kSuccess
+                                   : MethodCallOutcome::kError,
+                                out.size());
+                         });
+    } else if (call.method == "Decrypt") {
+      RoundTrip(call, std::move(done));
+    } else if (call.method == "ComputeHmacs") {
+      ComputeHmacs(call, done);
+    } else if (call.method == "HashFiles") {
+      hub_->hasher()->HashFilesAsync(
+          {hash_file_}, HashAlgorithm::kSha256, nullptr,
+          [done](std::vector<FileHashResult> results) {
+            const bool ok = results.size() == 1 && results[0].error.empty();
+            done(ok ? MethodCallOutcome::kSuccess : MethodCallOutcome::kError,
+                 ok ? results[0].digest.size() : 0);
+          });
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE
+    } else if (call.method == "QueryInventory" ||
+               call.method == "RequestHardwareInfo") {
+      QueryInventory(call.method == "RequestHardwareInfo" ? 1 : 100, done);
+    } else if (call.method == "GetDeviceFingerprint") {
+      GetDeviceFingerprint(done);
+#endif
+    } else if (call.method == "GetSchedulerStats") {
+      uint64_t bytes = 0;
+      for (size_t i = 0; i < kTaskPriorityCount; ++i) {
+        bytes += sizeof(hub_->workers()->stats(static_cast<TaskPriority>(i)));
+      }
+      done(MethodCallOutcome::kSuccess, bytes);
+    } else if (call.method == "SignNonce") {
+      Fake(TaskPriority::kInteractive, std::chrono::microseconds(200), 256,
+           done);
+    } else if (call.method == "GenerateDataKey") {
+      Fake(TaskPriority::kNormal, std::chrono::microseconds(150), 512, done);
+    } else if (call.method == "CreateKeyPair") {
+      Fake(TaskPriority::kNormal, std::chrono::milliseconds(5), 270, done);
+    } else if (call.method == "GetCertificate") {
+      Fake(TaskPriority::kBulk, std::chrono::milliseconds(1), 1500, done);
+    } else {
+      done(MethodCallOutcome::kNotImplemented, 0);
+    }
+  }
+
+ private:
+  void RoundTrip(const LoadCall& call, ReplayDone done) {
+    auto plaintext = std::make_shared<std::vector<uint8_t>>(Payload(call));
+    WorkerPool* workers = hub_->workers();
+    AesGcmEncryptAsync(
+        key_, *plaintext, {}, workers,
+        [plaintext, workers, key = key_, done](bool ok,
+                                               std::vector<uint8_t> out) {
+          if (!ok) {
+            done(MethodCallOutcome::kError, 0);
+            return;
+          }
+          AesGcmDecryptAsync(key, std::move(out), {}, workers,
+                             [plaintext, done](bool ok,
+                                               std::vector<uint8_t> result) {
+                               ok = ok && result == *plaintext;
+                               done(ok ? MethodCallOutcome::kSuccess
+                                       : MethodCallOutcome::kError,
+                                    result.size());
+                             });
+        });
+  }
+
+  // Runs inline, as the plugin does on the platform thread, against one
+  // session shared by every thread.
+  void ComputeHmacs(const LoadCall& call, const ReplayDone& done) {
+    std::vector<uint8_t> payload = Payload(call);
+    std::vector<MacMessage> messages;
+    for (size_t offset = 0; offset < payload.size(); offset += 256) {
+      messages.push_back(MacMessage{
+          payload.data() + offset, std::min<size_t>(256, payload.size() - offset)});
+    }
+    std::vector<uint8_t> macs = hmac_.ComputeBatch(messages);
+    bool ok = true;
+    uint8_t mac[64];
+    for (size_t i = 0; i < messages.size() && ok; ++i) {
+      hmac_.Compute(messages[i].data, messages[i].len, mac);
+      ok = std::memcmp(mac, macs.data() + i * hmac_.mac_len(),
+                       hmac_.mac_len()) == 0;
+    }
+    done(ok ? MethodCallOutcome::kSuccess : MethodCallOutcome::kError,
+         macs.size());
+  }
+
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE
+  void QueryInventory(size_t page_size, const ReplayDone& done) {
+    wmi_.Submit([page_size, done](FakeWmiSession& session) {
+      try {
+        InventoryQuery query;
+        query.class_name = "processors";
+        query.columns = {"processor", "modelName"};
+        query.page_size = page_size;
+        InventoryPage page = session.inventory.Start(query);
+        if (!page.done) session.inventory.Close(page.cursor);
+        done(MethodCallOutcome::kSuccess, page.rows.size());
+      } catch (const std::exception&) {
+        done(MethodCallOutcome::kError, 0);
+      }
+    });
+  }
+
+  void GetDeviceFingerprint(const ReplayDone& done) {
+    ReadDeviceIdentifiersAsync(
+        CreateDefaultDeviceIdentifierSource(), DeviceIdentifierNames(),
+        hub_->workers(), [done](std::vector<DeviceIdentifier> identifiers) {
+          const uint8_t salt[16] = {0x5a};
+          DeviceFingerprint fingerprint =
+              ComputeDeviceFingerprint(identifiers, salt, sizeof(salt));
+          done(MethodCallOutcome::kSuccess,
+               (fingerprint.components.size() + 1) * fingerprint.digest.size());
+        });
+  }
+#endif
+
+  // A CNG call: occupies a worker of |priority| for about |cost|.
+  void Fake(TaskPriority priority, std::chrono::microseconds cost,
+            uint64_t result_bytes, const ReplayDone& done) {
+    hub_->workers()->Post(
+        [cost, result_bytes, done]() {
+          std::this_thread::sleep_for(cost);
+          done(MethodCallOutcome::kSuccess, result_bytes);
+        },
+        priority);
+  }
+
+  BackendHub* hub_;
+  std::string hash_file_;
+  AesGcmKey key_;
+  const uint8_t hmac_key_[32] = {0x5a};
+  HmacSession hmac_;
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE
+  AffineExecutor<FakeWmiSession> wmi_;
+#endif
+};
+#endif
+
+bool ParseSize(const char* text, size_t* out) {
+  char* end = nullptr;
+  const unsigned long long value = std::strtoull(text, &end, 10);
+  if (end == text || *end != '\0') return false;
+  *out = static_cast<size_t>(value);
+  return true;
+}
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  LoadTestOptions& load = options->load;
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    size_t value = 0;
+    if (std::strncmp(arg, "--mix=", 6) == 0) {
+      try {
+        load.mix = ParseLoadMix(arg + 6);
+      } catch (const std::invalid_argument& ex) {
+        std::fprintf(stderr, "%s\n", ex.what());
+        return false;
+      }
+      options->mix_given = true;
+    } else if (std::strncmp(arg, "--threads=", 10) == 0 &&
+               ParseSize(arg + 10, &value) && value > 0) {
+      load.threads = value;
+    } else if (std::strncmp(arg, "--rate=", 7) == 0) {
+      load.calls_per_second = std::atof(arg + 7);
+    } else if (std::strncmp(arg, "--duration=", 11) == 0 &&
+               ParseSize(arg + 11, &value)) {
+      load.duration = std::chrono::milliseconds(value);
+    } else if (std::strncmp(arg, "--payload=", 10) == 0) {
+      std::string range = arg + 10;
+      const size_t dash = range.find('-');
+      size_t min = 0;
+      size_t max = 0;
+      if (!ParseSize(range.substr(0, dash).c_str(), &min) ||
+          (dash != std::string::npos &&
+           !ParseSize(range.substr(dash + 1).c_str(), &max))) {
+        return false;
+      }
+      load.min_payload_bytes = min;
+      load.max_payload_bytes = dash == std::string::npos ? min : max;
+      if (load.min_payload_bytes > load.max_payload_bytes) return false;
+    } else if (std::strncmp(arg, "--in-flight=", 12) == 0 &&
+               ParseSize(arg + 12, &value) && value > 0) {
+      load.max_in_flight_per_thread = value;
+    } else if (std::strncmp(arg, "--seed=", 7) == 0 &&
+               ParseSize(arg + 7, &value)) {
+      load.seed = value;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+void PrintMethod(const std::string& name, size_t errors,
+                 const LatencySummary& summary) {
+  std::printf("  %-22s %8zu  err %6zu  mean %9.0f  p50 %8lld  p90 %8lld  "
+              "p99 %8lld  max %8lld us\n",
+              name.c_str(), summary.count, errors, summary.mean_us,
+              static_cast<long long>(summary.p50_us),
+              static_cast<long long>(summary.p90_us),
+              static_cast<long long>(summary.p99_us),
+              static_cast<long long>(summary.max_us));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    std::fprintf(stderr,
+                 "usage: %s [--mix=METHOD[=WEIGHT],...] [--threads=N] "
+                 "[--rate=CALLS_PER_S] [--duration=MS] "
+                 "[--payload=BYTES|MIN-MAX] [--in-flight=N] [--seed=N]\n",
+                 argv[0]);
+    return 2;
+  }
+
+#ifdef _WIN32
+  const std::vector<std::string> methods = PluginDispatcher::Methods();
+#else
+  const std::vector<std::string> methods = PortableDispatcher::Methods();
+#endif
+  if (!options.mix_given) {
+    for (const std::string& method : methods) {
+      options.load.mix.push_back(LoadMixEntry{method, 1});
+    }
+  }
+
+  LoadTestReport report;
+  try {
+#ifdef _WIN32
+    PluginDispatcher dispatcher(options.load.threads);
+#else
+    // HashFiles reads one file of the largest payload size.
+    const std::filesystem::path hash_file =
+        std::filesystem::temp_directory_path() /
+        ("flutter_native_utils_load_test_" + std::to_string(::getpid()));
+    {
+      std::ofstream file(hash_file, std::ios::binary);
+      std::vector<char> data(options.load.max_payload_bytes, 'x');
+      file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+    std::shared_ptr<BackendHub> hub = BackendHub::Acquire();
+    PortableDispatcher dispatcher(hub.get(), hash_file.string());
+#endif
+    report = RunLoadTest(options.load,
+                         [&dispatcher](const LoadCall& call, ReplayDone done) {
+                           dispatcher.Dispatch(call, std::move(done));
+                         });
+#ifndef _WIN32
+    std::error_code ignored;
+    std::filesystem::remove(hash_file, ignored);
+#endif
+  } catch (const std::exception& ex) {
+    std::fprintf(stderr, "%s\n", ex.what());
+    return 1;
+  }
+
+  std::printf("%zu calls in %.3f s (%.0f calls/s) on %zu threads, %s\n",
+              report.calls, report.elapsed_seconds, report.calls_per_second,
+              options.load.threads,
+              options.load.calls_per_second > 0 ? "fixed rate" : "closed loop");
+  std::printf("%zu errors, %zu not implemented, %zu skipped, %zu unfinished, "
+              "%zu duplicate completions, %llu result bytes\n",
+              report.errors, report.not_implemented, report.skipped,
+              report.unfinished, report.duplicate_completions,
+              static_cast<unsigned long long>(report.result_bytes));
+  PrintMethod("all", report.errors + report.not_implemented, report.latency);
+  for (const auto& [method, method_report] : report.by_method) {
+    PrintMethod(method, method_report.errors + method_report.not_implemented,
+                method_report.latency);
+  }
+  return report.ok() ? 0 : 1;
+}
@@ -0,0 +1,326 @@
+#include "manifest_verifier.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include "rsa_public_key.h"
+
+namespace flutter_native_utils {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr char kManifestHeader[] = "fnu-manifest";
+constexpr char kCacheHeader[] = "fnu-verify-cache 1";
+
+std::string ToHex(const std::vector<uint8_t>& bytes) {
+  static const char kDigits[] = "0123456789abcdef";
+  std::string hex;
+  hex.reserve(bytes.size() * 2);
+  for (uint8_t byte : bytes) {
+    hex.push_back(kDigits[byte >> 4]);
+    hex.push_back(kDigits[byte & 0xf]);
+  }
+  return hex;
+}
+
+int HexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+bool FromHex(const std::string& hex, std::vector<uint8_t>* bytes) {
+  if (hex.size() % 2 != 0) return false;
+  bytes->resize(hex.size() / 2);
+  for (size_t i = 0; i < bytes->size(); ++i) {
+    int high = HexValue(hex[2 * i]);
+    int low = HexValue(hex[2 * i + 1]);
+    if (high < 0 || low < 0) return false;
+    (*bytes)[i] = static_cast<uint8_t>(high << 4 | low);
+  }
+  return true;
+}
+
+// Splits "<a> <b> <c> <rest>" where <rest> may contain spaces.
+bool SplitFields(const std::string& line, std::string* a, std::string* b,
+                 std::string* c, std::string* rest) {
+  std::istringstream stream(line);
+  if (!(stream >> *a >> *b >> *c)) return false;
+  stream.get();  // The separating space.
+  std::getline(stream, *rest);
+  return !rest->empty();
+}
+
+bool IsSafeRelativePath(const std::string& path) {
+  fs::path parsed = fs::u8path(path);
+  if (parsed.empty() || parsed.is_absolute() || parsed.has_root_name() ||
+      parsed.has_root_directory()) {
+    return false;
+  }
+  for (const fs::path& part : parsed) {
+    if (part == "..") return false;
+  }
+  return true;
+}
+
+// What a file looked like when it last verified.
+struct CacheEntry {
+  uint64_t size = 0;
+  int64_t stamp = 0;  // Native last-write time ticks.
+  std::vector<uint8_t> digest;
+};
+
+using VerificationCache = std::unordered_map<std::string, CacheEntry>;
+
+// A missing, unreadable or foreign cache is treated as empty.
+VerificationCache LoadCache(const std::string& path, const std::string& root) {
+  VerificationCache cache;
+  if (path.empty()) return cache;
+  std::ifstream file(fs::u8path(path));
+  std::string line;
+  if (!std::getline(file, line) || line != kCacheHeader) return cache;
+  if (!std::getline(file, line) || line != root) return cache;
+  while (std::getline(file, line)) {
+    std::string size, stamp, digest, entry_path;
+    CacheEntry entry;
+    if (!SplitFields(line, &size, &stamp, &digest, &entry_path) ||
+        !FromHex(digest, &entry.digest)) {
+      return VerificationCache();
+    }
+    try {
+      entry.size = std::stoull(size);
+      entry.stamp = std::stoll(stamp);
+    } catch (const std::exception&) {
+      return VerificationCache();
+    }
+    cache[entry_path] = std::move(entry);
+  }
+  return cache;
+}
+
+// Writes to a temporary file first so a crash never leaves a torn cache.
+void SaveCache(const std::string& path, const std::string& root,
+               const VerificationCache& cache) {
+  fs::path target = fs::u8path(path);
+  fs::path temp = target;
+  temp += ".tmp";
+  {
+    std::ofstream file(temp, std::ios::trunc);
+    file << kCacheHeader << '\n' << root << '\n';
+    for (const auto& [entry_path, entry] : cache) {
+      file << entry.size << ' ' << entry.stamp << ' ' << ToHex(entry.digest)
+           << ' ' << entry_path << '\n';
+    }
+    if (!file) return;
+  }
+  std::error_code error;
+  fs::rename(temp, target, error);
+  if (error) fs::remove(temp, error);
+}
+
+struct VerifyJob {
+  ManifestVerifyRequest request;
+  Manifest manifest;
+  std::unique_ptr<RsaPublicKey> key;
+  ManifestVerifier::Callback on_complete;
+  std::chrono::steady_clock::time_point start;
+
+  ManifestVerifyResult result;
+  VerificationCache previous_cache;
+  VerificationCache next_cache;
+  // Manifest indices that need rehashing, with their stat results.
+  std::vector<size_t> dirty;
+  std::vector<CacheEntry> dirty_stats;
+
+  void Finish() {
+    if (!request.cache_path.empty() &&
+        (result.files_rehashed > 0 ||
+         next_cache.size() != previous_cache.size())) {
+      SaveCache(request.cache_path, request.root, next_cache);
+    }
+    result.elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+    on_complete(std::move(result));
+  }
+};
+
+std::string ResolvePath(const std::string& root, const std::string& path) {
+  return (fs::u8path(root) / fs::u8path(path)).u8string();
+}
+
+// Stats every manifest entry and sorts it into clean (cache hit), failed
+// (missing or wrong size) or dirty (needs rehashing).
+void ClassifyEntries(VerifyJob* job) {
+  for (size_t i = 0; i < job->manifest.entries.size(); ++i) {
+    const ManifestEntry& entry = job->manifest.entries[i];
+    fs::path path = fs::u8path(ResolvePath(job->request.root, entry.path));
+    std::error_code error;
+    uint64_t size = fs::file_size(path, error);
+    if (error) {
+      job->result.failures.push_back(
+          {entry.path, ManifestFailureReason::kMissing, error.message()});
+      continue;
+    }
+    if (size != entry.size) {
+      job->result.failures.push_back(
+          {entry.path, ManifestFailureReason::kSizeMismatch,
+           "expected " + std::to_string(entry.size) + " bytes, found " +
+               std::to_string(size)});
+      continue;
+    }
+    CacheEntry stat;
+    stat.size = size;
+    stat.stamp = static_cast<int64_t>(
+        fs::last_write_time(path, error).time_since_epoch().count());
+
+    auto cached = job->previous_cache.find(entry.path);
+    if (!error && cached != job->previous_cache.end() &&
+        cached->second.size == stat.size &&
+        cached->second.stamp == stat.stamp &&
+        cached->second.digest == entry.digest) {
+      job->next_cache[entry.path] = cached->second;
+      continue;
+    }
+    job->dirty.push_back(i);
+    job->dirty_stats.push_back(std::move(stat));
+  }
+}
+
+void CompareHashes(VerifyJob* job, const std::vector<FileHashResult>& hashes) {
+  for (size_t d = 0; d < job->dirty.size(); ++d) {
+    const ManifestEntry& entry = job->manifest.entries[job->dirty[d]];
+    const FileHashResult& hash = hashes[d];
+    if (!hash.error.empty()) {
+      job->result.failures.push_back(
+          {entry.path, ManifestFailureReason::kReadError, hash.error});
+    } else if (hash.digest != entry.digest) {
+      job->result.failures.push_back(
+          {entry.path, ManifestFailureReason::kDigestMismatch,
+           "expected " + ToHex(entry.digest) + ", found " +
+               ToHex(hash.digest)});
+    } else {
+      CacheEntry cached = std::move(job->dirty_stats[d]);
+      cached.digest = hash.digest;
+      job->next_cache[entry.path] = std::move(cached);
+    }
+  }
+}
+
+}  // namespace
+
+Manifest ParseManifest(const std::string& text) {
+  std::istringstream stream(text);
+  std::string line;
+  if (!std::getline(stream, line)) {
+    throw std::invalid_argument("Manifest is empty");
+  }
+  std::istringstream header(line);
+  std::string magic, version, algorithm_name;
+  Manifest manifest;
+  if (!(header >> magic >> version >> algorithm_name) ||
+      magic != kManifestHeader || version != "1") {
+    throw std::invalid_argument("Unsupported manifest header");
+  }
+  if (!ParseHashAlgorithm(algorithm_name, &manifest.algorithm)) {
+    throw std::invalid_argument("Unsupported manifest algorithm");
+  }
+
+  size_t line_number = 1;
+  while (std::getline(stream, line)) {
+    ++line_number;
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line.empty()) continue;
+    std::string digest, size, mtime;
+    ManifestEntry entry;
+    // Both algorithms produce 32-byte digests.
+    bool ok = SplitFields(line, &digest, &size, &mtime, &entry.path) &&
+              FromHex(digest, &entry.digest) &&
+              entry.digest.size() == kSha256Len &&
+              IsSafeRelativePath(entry.path);
+    if (ok) {
+      try {
+        entry.size = std::stoull(size);
+        entry.mtime = std::stoll(mtime);
+      } catch (const std::exception&) {
+        ok = false;
+      }
+    }
+    if (!ok) {
+      throw std::invalid_argument("Malformed manifest line " +
+                                  std::to_string(line_number));
+    }
+    manifest.entries.push_back(std::move(entry));
+  }
+  return manifest;
+}
+
+ManifestVerifier::ManifestVerifier(FileHasher* hasher) : hasher_(hasher) {}
+
+void ManifestVerifier::VerifyAsync(ManifestVerifyRequest request,
+                                   Callback on_complete) {
+  auto job = std::make_shared<VerifyJob>();
+  job->start = std::chrono::steady_clock::now();
+  job->manifest = ParseManifest(request.manifest);
+  job->key = RsaPublicKey::FromCngBlob(request.public_key);
+  job->request = std::move(request);
+  job->on_complete = std::move(on_complete);
+
+  FileHasher* hasher = hasher_;
+  hasher->pool()->Post([hasher, job]() {
+    const std::string& manifest = job->request.manifest;
+    const std::vector<uint8_t>& signature = job->request.signature;
+    job->result.signature_valid = job->key->VerifySha256(
+        reinterpret_cast<const uint8_t*>(manifest.data()), manifest.size(),
+        signature.data(), signature.size());
+    job->result.files_checked = job->manifest.entries.size();
+    if (!job->result.signature_valid) {
+      // Nothing in an unsigned manifest can be trusted, including which
+      // files it lists, so neither hash nor touch the cache.
+      job->request.cache_path.clear();
+      job->Finish();
+      return;
+    }
+
+    job->previous_cache = LoadCache(job->request.cache_path, job->request.root);
+    ClassifyEntries(job.get());
+    job->result.files_rehashed = job->dirty.size();
+    if (job->dirty.empty()) {
+      job->Finish();
+      return;
+    }
+
+    std::vector<std::string> paths;
+    paths.reserve(job->dirty.size());
+    for (size_t index : job->dirty) {
+      paths.push_back(
+          ResolvePath(job->request.root, job->manifest.entries[index].path));
+    }
+    hasher->HashFilesAsync(std::move(paths), job->manifest.algorithm, nullptr,
+                           [job](std::vector<FileHashResult> hashes) {
+                             CompareHashes(job.get(), hashes);
+                             job->Finish();
+                           });
+  }, TaskPriority::kBulk);
+}
+
+ManifestVerifyResult ManifestVerifier::Verify(ManifestVerifyRequest request) {
+  std::promise<ManifestVerifyResult> promise;
+  auto future = promise.get_future();
+  VerifyAsync(std::move(request), [&promise](ManifestVerifyResult result) {
+    promise.set_value(std::move(result));
+  });
+  return future.get();
+}
+
+}  // namespace flutter_native_utils
@@ -0,0 +1,109 @@
+#ifndef FLUTTER_PLUGIN_MANIFEST_VERIFIER_H_
+#define FLUTTER_PLUGIN_MANIFEST_VERIFIER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "file_hasher.h"
+
+namespace flutter_native_utils {
+
+// One file listed in a bundle manifest.
+struct ManifestEntry {
+  std::string path;  // Relative to the bundle root, '/'-separated.
+  uint64_t size = 0;
+  int64_t mtime = 0;  // Seconds since the Unix epoch at build time.
+  std::vector<uint8_t> digest;
+};
+
+struct Manifest {
+  HashAlgorithm algorithm = HashAlgorithm::kSha256;
+  std::vector<ManifestEntry> entries;
+};
+
+// Parses a manifest of the form
+//
+//   fnu-manifest 1 <sha256|blake3>
+//   <hex digest> <size> <mtime> <relative path>
+//   ...
+//
+// Paths may contain spaces but must be relative and must not contain ".."
+// components. Throws std::invalid_argument on malformed input.
+Manifest ParseManifest(const std::string& text);
+
+enum class ManifestFailureReason {
+  kMissing,
+  kSizeMismatch,
+  kDigestMismatch,
+  kReadError,
+};
+
+struct ManifestFailure {
+  std::string path;
+  ManifestFailureReason reason;
+  std::string detail;
+};
+
+struct ManifestVerifyResult {
+  bool signature_valid = false;
+  size_t files_checked = 0;
+  // Files whose size or mtime differed from the verification cache.
+  size_t files_rehashed = 0;
+  std::vector<ManifestFailure> failures;
+  int64_t elapsed_us = 0;
+
+  bool ok() const { return signature_valid && failures.empty(); }
+};
+
+struct ManifestVerifyRequest {
+  // Exact bytes that were signed.
+  std::string manifest;
+  // RSASSA-PKCS1-v1_5 / SHA-256 signature over |manifest| (see SignNonce).
+  std::vector<uint8_t> signature;
+  // BCRYPT_RSAPUBLIC_BLOB of the signing key (see CreateKeyPair).
+  std::vector<uint8_t> public_key;
+  // Bundle directory that manifest paths are resolved against (UTF-8).
+  std::string root;
+  // Verification cache file (UTF-8). Empty disables the cache, so every file
+  // is rehashed.
+  std::string cache_path;
+};
+
+// Verifies an installed bundle against a signed manifest.
+//
+// The signature is checked once per call. Files are then compared with a
+// persistent cache of the size, mtime and digest each file had when it last
+// verified; only files whose size or mtime changed are rehashed, in parallel
+// on the hasher's pool. The manifest's own mtime field is informational, since
+// installers do not preserve build-time mtimes.
+//
+// The cache is only as trustworthy as the directory it lives in, so keep it in
+// the protected install location rather than a user-writable one. As with any
+// mtime-based cache, a change that restores the original size and mtime goes
+// unnoticed until the cache is deleted.
+class ManifestVerifier {
+ public:
+  using Callback = std::function<void(ManifestVerifyResult result)>;
+
+  // |hasher| must outlive the verifier.
+  explicit ManifestVerifier(FileHasher* hasher);
+
+  // Parses the manifest and imports the key on the calling thread, throwing
+  // std::invalid_argument if either is malformed. Everything else runs on
+  // the hasher's pool; |on_complete| is invoked on a worker thread.
+  void VerifyAsync(ManifestVerifyRequest request, Callback on_complete);
+
+  // Blocking variant of VerifyAsync. Must not be called from a task running
+  // on the hasher's pool.
+  ManifestVerifyResult Verify(ManifestVerifyRequest request);
+
+ private:
+  FileHasher* hasher_;
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_MANIFEST_VERIFIER_H_
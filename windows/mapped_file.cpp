@@ -0,0 +1,129 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+#include <utility>
+
+namespace flutter_native_utils {
+
+MappedFile::~MappedFile() { Close(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    Close();
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+#ifdef _WIN32
+    std::swap(file_, other.file_);
+    std::swap(mapping_, other.mapping_);
+#endif
+  }
+  return *this;
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::string& path, std::string* error) {
+  Close();
+  int wide_len = MultiByteToWideChar(CP_UTF8, 0, path.c_str(),
+                                     static_cast<int>(path.size()), nullptr, 0);
+  std::wstring wide_path(wide_len, 0);
+  MultiByteToWideChar(CP_UTF8, 0, path.c_str(), static_cast<int>(path.size()),
+                      wide_path.data(), wide_len);
+
+  HANDLE file = CreateFileW(wide_path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    *error = "Failed to open file";
+    return false;
+  }
+  file_ = file;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    *error = "Failed to get file size";
+    Close();
+    return false;
+  }
+  size_ = static_cast<size_t>(size.QuadPart);
+  if (size_ == 0) return true;
+
+  HANDLE mapping =
+      CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping) {
+    *error = "Failed to create file mapping";
+    Close();
+    return false;
+  }
+  mapping_ = mapping;
+
+  data_ = static_cast<const uint8_t*>(
+      MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  if (!data_) {
+    *error = "Failed to map file";
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void MappedFile::Close() {
+  if (data_) UnmapViewOfFile(data_);
+  if (mapping_) CloseHandle(mapping_);
+  if (file_) CloseHandle(file_);
+  data_ = nullptr;
+  mapping_ = nullptr;
+  file_ = nullptr;
+  size_ = 0;
+}
+#else
+bool MappedFile::Open(const std::string& path, std::string* error) {
+  Close();
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    *error = std::string("Failed to open file: ") + std::strerror(errno);
+    return false;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    *error = std::string("Failed to stat file: ") + std::strerror(errno);
+    ::close(fd);
+    return false;
+  }
+  size_ = static_cast<size_t>(info.st_size);
+  if (size_ > 0) {
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      *error = std::string("Failed to map file: ") + std::strerror(errno);
+      ::close(fd);
+      size_ = 0;
+      return false;
+    }
+    madvise(data, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const uint8_t*>(data);
+  }
+  // The mapping stays valid after the descriptor is closed.
+  ::close(fd);
+  return true;
+}
+
+void MappedFile::Close() {
+  if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+  data_ = nullptr;
+  size_ = 0;
+}
+#endif
+
+}  // namespace flutter_native_utils
@@ -0,0 +1,43 @@
+#ifndef FLUTTER_PLUGIN_MAPPED_FILE_H_
+#define FLUTTER_PLUGIN_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace flutter_native_utils {
+
+// Read-only memory mapping of a whole file, hinted for sequential access.
+// Paths are UTF-8.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  // Disallow copy and assign; ownership of a mapping can be moved.
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  // Maps |path|. Returns false and fills |error| on failure. Empty files
+  // succeed with a null data() and zero size().
+  bool Open(const std::string& path, std::string* error);
+
+  void Close();
+
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+#ifdef _WIN32
+  void* file_ = nullptr;
+  void* mapping_ = nullptr;
+#endif
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_MAPPED_FILE_H_
@@ -0,0 +1,269 @@
+#include "method_call_log.h"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace flutter_native_utils {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr char kLogMagic[8] = {'F', 'N', 'U', 'C', 'A', 'L', 'L', 1};
+// Buffered bytes that trigger a write.
+constexpr size_t kFlushThreshold = 64 << 10;
+
+void PutVarint(std::vector<uint8_t>* out, uint64_t value) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t ZigZag(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+int64_t UnZigZag(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+bool KeyIsRedacted(const MethodCallRedaction& redaction,
+                   const std::string& key) {
+  std::string lower(key);
+  std::transform(lower.begin(), lower.end(), lower.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  for (const std::string& pattern : redaction.keys) {
+    std::string needle(pattern);
+    std::transform(needle.begin(), needle.end(), needle.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    if (lower.find(needle) != std::string::npos) return true;
+  }
+  return false;
+}
+
+template <typename T>
+void ZeroAll(std::vector<T>* values) {
+  std::fill(values->begin(), values->end(), T());
+}
+
+// Replaces every leaf of |value|, keeping sizes.
+void RedactAll(CodecValue* value) {
+  if (auto* text = std::get_if<std::string>(value)) {
+    std::fill(text->begin(), text->end(), '*');
+  } else if (auto* number = std::get_if<int32_t>(value)) {
+    *number = 0;
+  } else if (auto* number = std::get_if<int64_t>(value)) {
+    *number = 0;
+  } else if (auto* number = std::get_if<double>(value)) {
+    *number = 0;
+  } else if (auto* bytes = std::get_if<std::vector<uint8_t>>(value)) {
+    ZeroAll(bytes);
+  } else if (auto* list = std::get_if<std::vector<int32_t>>(value)) {
+    ZeroAll(list);
+  } else if (auto* list = std::get_if<std::vector<int64_t>>(value)) {
+    ZeroAll(list);
+  } else if (auto* list = std::get_if<std::vector<double>>(value)) {
+    ZeroAll(list);
+  } else if (auto* list = std::get_if<std::vector<float>>(value)) {
+    ZeroAll(list);
+  } else if (auto* list = std::get_if<CodecList>(value)) {
+    for (CodecValue& item : *list) RedactAll(&item);
+  } else if (auto* map = std::get_if<CodecMap>(value)) {
+    for (auto& entry : *map) RedactAll(&entry.second);
+  }
+}
+
+class LogReader {
+ public:
+  LogReader(const uint8_t* data, size_t len) : data_(data), len_(len) {}
+
+  bool done() const { return pos_ == len_; }
+
+  // False if the log ends first.
+  bool Varint(uint64_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (pos_ == len_) return false;
+      uint8_t byte = data_[pos_++];
+      *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) return true;
+    }
+    throw std::runtime_error("Corrupt method call log: varint too long");
+  }
+
+  bool Bytes(size_t count, const uint8_t** bytes) {
+    if (count > len_ - pos_) return false;
+    *bytes = data_ + pos_;
+    pos_ += count;
+    return true;
+  }
+
+ private:
+  const uint8_t* data_;
+  size_t len_;
+  size_t pos_ = 0;
+};
+
+}  // namespace
+
+void RedactCodecValue(const MethodCallRedaction& redaction, CodecValue* value) {
+  if (redaction.zero_bytes) {
+    if (auto* bytes = std::get_if<std::vector<uint8_t>>(value)) {
+      ZeroAll(bytes);
+      return;
+    }
+  }
+  if (auto* list = std::get_if<CodecList>(value)) {
+    for (CodecValue& item : *list) RedactCodecValue(redaction, &item);
+  } else if (auto* map = std::get_if<CodecMap>(value)) {
+    for (auto& entry : *map) {
+      const auto* key = std::get_if<std::string>(&entry.first);
+      if (key && KeyIsRedacted(redaction, *key)) {
+        RedactAll(&entry.second);
+      } else {
+        RedactCodecValue(redaction, &entry.second);
+      }
+    }
+  }
+}
+
+MethodCallRecorder::MethodCallRecorder(const std::string& path,
+                                       MethodCallRedaction redaction)
+    : origin_(std::chrono::steady_clock::now()),
+      redaction_(std::move(redaction)),
+      file_(fs::u8path(path), std::ios::binary | std::ios::trunc) {
+  if (!file_) {
+    throw std::runtime_error("Failed to create method call log " + path);
+  }
+  buffer_.assign(std::begin(kLogMagic), std::end(kLogMagic));
+}
+
+MethodCallRecorder::~MethodCallRecorder() { Flush(); }
+
+int64_t MethodCallRecorder::Now() const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - origin_)
+      .count();
+}
+
+void MethodCallRecorder::Record(const std::string& method,
+                                const uint8_t* arguments, size_t arguments_len,
+                                int64_t start_us, MethodCallOutcome outcome,
+                                uint64_t result_bytes) {
+  // Redact before taking the lock; most calls carry small arguments.
+  std::vector<uint8_t> redacted;
+  if (arguments_len > 0) {
+    try {
+      CodecValue value = DecodeStandardValue(arguments, arguments_len);
+      RedactCodecValue(redaction_, &value);
+      redacted = EncodeStandardValue(value);
+    } catch (const std::invalid_argument&) {
+      // Never write what could not be redacted.
+    }
+  }
+  const int64_t end_us = Now();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto id = method_ids_.find(method);
+  if (id == method_ids_.end()) {
+    // Zero introduces a name; later records refer to it by its 1-based id.
+    PutVarint(&buffer_, 0);
+    PutVarint(&buffer_, method.size());
+    buffer_.insert(buffer_.end(), method.begin(), method.end());
+    method_ids_.emplace(method, method_ids_.size() + 1);
+  } else {
+    PutVarint(&buffer_, id->second);
+  }
+  // Results arrive out of start order, so starts are signed deltas.
+  PutVarint(&buffer_, ZigZag(start_us - last_start_us_));
+  last_start_us_ = start_us;
+  PutVarint(&buffer_,
+            static_cast<uint64_t>(std::max<int64_t>(0, end_us - start_us)));
+  buffer_.push_back(static_cast<uint8_t>(outcome));
+  PutVarint(&buffer_, result_bytes);
+  PutVarint(&buffer_, redacted.size());
+  buffer_.insert(buffer_.end(), redacted.begin(), redacted.end());
+  ++records_;
+  if (buffer_.size() >= kFlushThreshold) FlushLocked();
+}
+
+void MethodCallRecorder::Flush() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  FlushLocked();
+}
+
+void MethodCallRecorder::FlushLocked() {
+  if (buffer_.empty()) return;
+  file_.write(reinterpret_cast<const char*>(buffer_.data()),
+              static_cast<std::streamsize>(buffer_.size()));
+  file_.flush();
+  buffer_.clear();
+}
+
+size_t MethodCallRecorder::records() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return records_;
+}
+
+std::vector<MethodCallRecord> ParseMethodCallLog(const uint8_t* data,
+                                                 size_t len) {
+  if (len < sizeof(kLogMagic) ||
+      !std::equal(std::begin(kLogMagic), std::end(kLogMagic), data)) {
+    throw std::runtime_error("Not a method call log");
+  }
+  LogReader reader(data + sizeof(kLogMagic), len - sizeof(kLogMagic));
+  std::vector<std::string> methods;
+  std::vector<MethodCallRecord> records;
+  int64_t start_us = 0;
+  while (!reader.done()) {
+    MethodCallRecord record;
+    uint64_t id, start_delta, duration, result_bytes, arguments_len;
+    const uint8_t* bytes = nullptr;
+    if (!reader.Varint(&id)) break;
+    if (id == 0) {
+      uint64_t name_len;
+      if (!reader.Varint(&name_len) || !reader.Bytes(name_len, &bytes)) break;
+      methods.emplace_back(reinterpret_cast<const char*>(bytes), name_len);
+      record.method = methods.back();
+    } else if (id <= methods.size()) {
+      record.method = methods[id - 1];
+    } else {
+      throw std::runtime_error("Corrupt method call log: unknown method id");
+    }
+    const uint8_t* outcome = nullptr;
+    if (!reader.Varint(&start_delta) || !reader.Varint(&duration) ||
+        !reader.Bytes(1, &outcome) || !reader.Varint(&result_bytes) ||
+        !reader.Varint(&arguments_len) ||
+        !reader.Bytes(arguments_len, &bytes)) {
+      break;  // Cut off mid-record.
+    }
+    if (*outcome > static_cast<uint8_t>(MethodCallOutcome::kNotImplemented)) {
+      throw std::runtime_error("Corrupt method call log: unknown outcome");
+    }
+    start_us += UnZigZag(start_delta);
+    record.start_us = start_us;
+    record.duration_us = static_cast<int64_t>(duration);
+    record.outcome = static_cast<MethodCallOutcome>(*outcome);
+    record.result_bytes = result_bytes;
+    record.arguments.assign(bytes, bytes + arguments_len);
+    records.push_back(std::move(record));
+  }
+  return records;
+}
+
+std::vector<MethodCallRecord> ReadMethodCallLog(const std::string& path) {
+  std::ifstream file(fs::u8path(path), std::ios::binary);
+  if (!file) throw std::runtime_error("Failed to open method call log " + path);
+  std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+  return ParseMethodCallLog(data.data(), data.size());
+}
+
+}  // namespace flutter_native_utils
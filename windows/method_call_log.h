@@ -0,0 +1,106 @@
+#ifndef FLUTTER_PLUGIN_METHOD_CALL_LOG_H_
+#define FLUTTER_PLUGIN_METHOD_CALL_LOG_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "standard_codec.h"
+
+namespace flutter_native_utils {
+
+enum class MethodCallOutcome : uint8_t { kSuccess, kError, kNotImplemented };
+
+struct MethodCallRecord {
+  std::string method;
+  // StandardMessageCodec encoding of the redacted arguments; empty if the
+  // call had none.
+  std::vector<uint8_t> arguments;
+  // Microseconds since recording began, and until the result was delivered.
+  int64_t start_us = 0;
+  int64_t duration_us = 0;
+  MethodCallOutcome outcome = MethodCallOutcome::kSuccess;
+  // Encoded size of the success value, or of the error code, message and
+  // details.
+  uint64_t result_bytes = 0;
+};
+
+struct MethodCallRedaction {
+  // Map keys whose values are replaced, matched case-insensitively as
+  // substrings (so "password" also covers "newPassword").
+  std::vector<std::string> keys = {"password", "passphrase", "secret",
+                                   "token", "credential"};
+  // Zeroes every byte list (plaintext, keys, signatures), keeping its length
+  // so replayed calls move as much data as the recorded ones.
+  bool zero_bytes = true;
+};
+
+// Replaces what |redaction| covers in |value|. Redacted strings become
+// asterisks and numbers zero, both keeping their size; lists and maps under
+// a redacted key are redacted throughout.
+void RedactCodecValue(const MethodCallRedaction& redaction, CodecValue* value);
+
+// Appends method calls to a compact binary log, for replaying a field
+// session's exact call mix (see ReplayMethodCalls). Each record stores the
+// method name once per log, varint timestamps, outcome and result size, and
+// the redacted arguments; a typical call costs its arguments plus about ten
+// bytes. Records are buffered and written in batches. Thread-safe.
+class MethodCallRecorder {
+ public:
+  // Throws std::runtime_error if |path| cannot be created.
+  explicit MethodCallRecorder(const std::string& path,
+                              MethodCallRedaction redaction =
+                                  MethodCallRedaction());
+  // Writes what is still buffered.
+  ~MethodCallRecorder();
+
+  // Disallow copy and assign.
+  MethodCallRecorder(const MethodCallRecorder&) = delete;
+  MethodCallRecorder& operator=(const MethodCallRecorder&) = delete;
+
+  // Microseconds since the recorder was created; the clock for |start_us|.
+  int64_t Now() const;
+
+  // Records a call that started at |start_us| and has just delivered its
+  // result. |arguments| is the unredacted StandardMessageCodec encoding (may
+  // be empty); arguments that do not decode are recorded as empty.
+  void Record(const std::string& method, const uint8_t* arguments,
+              size_t arguments_len, int64_t start_us,
+              MethodCallOutcome outcome, uint64_t result_bytes);
+
+  // Writes buffered records to the file.
+  void Flush();
+
+  size_t records() const;
+
+ private:
+  void FlushLocked();
+
+  const std::chrono::steady_clock::time_point origin_;
+  const MethodCallRedaction redaction_;
+
+  mutable std::mutex mutex_;
+  std::ofstream file_;
+  std::vector<uint8_t> buffer_;
+  std::unordered_map<std::string, uint64_t> method_ids_;
+  int64_t last_start_us_ = 0;
+  size_t records_ = 0;
+};
+
+// Parses a log written by MethodCallRecorder, in the order the results were
+// delivered. Throws std::runtime_error if it is not such a log or is
+// corrupt; a record cut off by a crash ends the log instead.
+std::vector<MethodCallRecord> ParseMethodCallLog(const uint8_t* data,
+                                                 size_t len);
+
+// Reads and parses the log at |path|. Throws std::runtime_error.
+std::vector<MethodCallRecord> ReadMethodCallLog(const std::string& path);
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_METHOD_CALL_LOG_H_
@@ -0,0 +1,153 @@
+#include "method_call_replay.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace flutter_native_utils {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int64_t MicrosecondsBetween(Clock::time_point from, Clock::time_point to) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(to - from)
+      .count();
+}
+
+// Nearest-rank percentile of sorted |values|.
+int64_t Percentile(const std::vector<int64_t>& values, double fraction) {
+  size_t rank =
+      static_cast<size_t>(fraction * static_cast<double>(values.size()));
+  return values[std::min(rank, values.size() - 1)];
+}
+
+}  // namespace
+
+LatencySummary SummarizeLatencies(std::vector<int64_t>* latencies_us) {
+  LatencySummary summary;
+  if (latencies_us->empty()) return summary;
+  std::sort(latencies_us->begin(), latencies_us->end());
+  summary.count = latencies_us->size();
+  double total = 0;
+  for (int64_t latency : *latencies_us) total += static_cast<double>(latency);
+  summary.mean_us = total / static_cast<double>(summary.count);
+  summary.p50_us = Percentile(*latencies_us, 0.50);
+  summary.p90_us = Percentile(*latencies_us, 0.90);
+  summary.p99_us = Percentile(*latencies_us, 0.99);
+  summary.max_us = latencies_us->back();
+  return summary;
+}
+
+ReplayReport ReplayMethodCalls(std::vector<MethodCallRecord> records,
+                               const ReplayDispatcher& dispatcher,
+                               const ReplayOptions& options) {
+  std::stable_sort(records.begin(), records.end(),
+                   [](const MethodCallRecord& a, const MethodCallRecord& b) {
+                     return a.start_us < b.start_us;
+                   });
+
+  // Completions may arrive on any thread.
+  struct State {
+    std::mutex mutex;
+    std::condition_variable changed;
+    size_t in_flight = 0;
+    std::vector<int64_t> latencies;
+    std::map<std::string, std::vector<int64_t>> latencies_by_method;
+    size_t outcome_mismatches = 0;
+    uint64_t result_bytes = 0;
+  } state;
+  state.latencies.reserve(records.size());
+  std::vector<int64_t> issue_lag;
+  const size_t max_in_flight = std::max<size_t>(1, options.max_in_flight);
+
+  const Clock::time_point start = Clock::now();
+  const int64_t first_start_us = records.empty() ? 0 : records[0].start_us;
+  for (const MethodCallRecord& record : records) {
+    if (options.speed == ReplaySpeed::kOriginal) {
+      const Clock::time_point due =
+          start + std::chrono::microseconds(record.start_us - first_start_us);
+      std::this_thread::sleep_until(due);
+      issue_lag.push_back(
+          std::max<int64_t>(0, MicrosecondsBetween(due, Clock::now())));
+    }
+    {
+      std::unique_lock<std::mutex> lock(state.mutex);
+      state.changed.wait(lock,
+                         [&]() { return state.in_flight < max_in_flight; });
+      ++state.in_flight;
+    }
+    const Clock::time_point dispatched = Clock::now();
+    dispatcher(record, [&state, &record, dispatched](MethodCallOutcome outcome,
+                                                     uint64_t result_bytes) {
+      const int64_t latency = MicrosecondsBetween(dispatched, Clock::now());
+      std::lock_guard<std::mutex> lock(state.mutex);
+      state.latencies.push_back(latency);
+      state.latencies_by_method[record.method].push_back(latency);
+      if (outcome != record.outcome) ++state.outcome_mismatches;
+      state.result_bytes += result_bytes;
+      --state.in_flight;
+      state.changed.notify_all();
+    });
+  }
+  std::unique_lock<std::mutex> lock(state.mutex);
+  state.changed.wait(lock, [&]() { return state.in_flight == 0; });
+
+  ReplayReport report;
+  report.calls = records.size();
+  report.outcome_mismatches = state.outcome_mismatches;
+  report.elapsed_seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+  if (report.elapsed_seconds > 0) {
+    report.calls_per_second =
+        static_cast<double>(report.calls) / report.elapsed_seconds;
+  }
+  report.result_bytes = state.result_bytes;
+  report.latency = SummarizeLatencies(&state.latencies);
+  for (auto& [method, latencies] : state.latencies_by_method) {
+    report.latency_by_method[method] = SummarizeLatencies(&latencies);
+  }
+  report.issue_lag = SummarizeLatencies(&issue_lag);
+  return report;
+}
+
+SimulatedBackend::SimulatedBackend() : thread_([this]() { TimerLoop(); }) {}
+
+SimulatedBackend::~SimulatedBackend() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  thread_.join();
+}
+
+void SimulatedBackend::Dispatch(const MethodCallRecord& record,
+                                ReplayDone done) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  pending_.push({Clock::now() + std::chrono::microseconds(record.duration_us),
+                 next_sequence_++, record.outcome, record.result_bytes,
+                 std::move(done)});
+  wake_.notify_all();
+}
+
+void SimulatedBackend::TimerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    if (pending_.empty()) {
+      wake_.wait(lock);
+      continue;
+    }
+    const Clock::time_point due = pending_.top().due;
+    if (Clock::now() < due) {
+      wake_.wait_until(lock, due);
+      continue;
+    }
+    Pending call = pending_.top();
+    pending_.pop();
+    lock.unlock();
+    call.done(call.outcome, call.result_bytes);
+    lock.lock();
+  }
+}
+
+}  // namespace flutter_native_utils
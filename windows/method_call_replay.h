@@ -0,0 +1,117 @@
+#ifndef FLUTTER_PLUGIN_METHOD_CALL_REPLAY_H_
+#define FLUTTER_PLUGIN_METHOD_CALL_REPLAY_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "method_call_log.h"
+
+namespace flutter_native_utils {
+
+// Completes a replayed call. May be called from any thread, exactly once.
+using ReplayDone =
+    std::function<void(MethodCallOutcome outcome, uint64_t result_bytes)>;
+
+// Runs one recorded call against a backend, the way HandleMethodCall would,
+// and reports its result through |done|. Called on the replay thread, which
+// stands in for the platform thread, so it should not block.
+using ReplayDispatcher =
+    std::function<void(const MethodCallRecord& record, ReplayDone done)>;
+
+enum class ReplaySpeed {
+  kOriginal,  // Issue each call at its recorded offset from the first one.
+  kMaximum,   // Issue calls back to back, up to |max_in_flight|.
+};
+
+struct ReplayOptions {
+  ReplaySpeed speed = ReplaySpeed::kOriginal;
+  // Calls that may be outstanding at once; further calls wait, in either
+  // mode, as they would behind a busy platform thread.
+  size_t max_in_flight = 256;
+};
+
+struct LatencySummary {
+  size_t count = 0;
+  double mean_us = 0;
+  int64_t p50_us = 0;
+  int64_t p90_us = 0;
+  int64_t p99_us = 0;
+  int64_t max_us = 0;
+};
+
+// Summarises |latencies_us| (reordered in place). All zero if empty.
+LatencySummary SummarizeLatencies(std::vector<int64_t>* latencies_us);
+
+struct ReplayReport {
+  size_t calls = 0;
+  // Calls whose outcome differs from the recorded one.
+  size_t outcome_mismatches = 0;
+  double elapsed_seconds = 0;
+  double calls_per_second = 0;
+  uint64_t result_bytes = 0;
+  // Dispatch to completion.
+  LatencySummary latency;
+  std::map<std::string, LatencySummary> latency_by_method;
+  // How late calls were issued against their recorded offsets; only
+  // meaningful at original speed.
+  LatencySummary issue_lag;
+};
+
+// Replays |records| in start order through |dispatcher| and waits for every
+// call to complete.
+ReplayReport ReplayMethodCalls(std::vector<MethodCallRecord> records,
+                               const ReplayDispatcher& dispatcher,
+                               const ReplayOptions& options = ReplayOptions());
+
+// A stand-in for the real backends: answers each call with its recorded
+// outcome and result size once its recorded duration has passed, from a
+// single timer thread. Replaying against it measures what the recorded
+// latencies and call mix alone imply, plus the replay overhead.
+class SimulatedBackend {
+ public:
+  SimulatedBackend();
+  // Completes nothing further; calls still pending are dropped.
+  ~SimulatedBackend();
+
+  // Disallow copy and assign.
+  SimulatedBackend(const SimulatedBackend&) = delete;
+  SimulatedBackend& operator=(const SimulatedBackend&) = delete;
+
+  void Dispatch(const MethodCallRecord& record, ReplayDone done);
+
+ private:
+  struct Pending {
+    std::chrono::steady_clock::time_point due;
+    uint64_t sequence;
+    MethodCallOutcome outcome;
+    uint64_t result_bytes;
+    ReplayDone done;
+
+    // Earliest (then first dispatched) at the top of the queue.
+    bool operator<(const Pending& other) const {
+      return due != other.due ? due > other.due : sequence > other.sequence;
+    }
+  };
+
+  void TimerLoop();
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::priority_queue<Pending> pending_;
+  uint64_t next_sequence_ = 0;
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_METHOD_CALL_REPLAY_H_
@@ -0,0 +1,183 @@
+#include "nonce_replay_filter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "secure_random.h"
+#include "siphash.h"
+
+namespace flutter_native_utils {
+
+namespace {
+
+// The splitmix64 finaliser, to draw the bit positions from other bits than
+// the word index.
+uint64_t Mix64(uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+const NonceReplayFilterOptions& Validated(
+    const NonceReplayFilterOptions& options) {
+  if (options.window.count() <= 0) {
+    throw std::invalid_argument("window must be positive");
+  }
+  if (options.capacity == 0) {
+    throw std::invalid_argument("capacity must be positive");
+  }
+  if (options.generations < 2) {
+    throw std::invalid_argument("generations must be at least 2");
+  }
+  if (options.bits_per_nonce < 4) {
+    throw std::invalid_argument("bits_per_nonce must be at least 4");
+  }
+  return options;
+}
+
+// A power of two up to a cache line, so the words of one nonce never
+// straddle two.
+size_t Stride(size_t generations) {
+  if (generations > 8) return (generations + 7) / 8 * 8;
+  size_t stride = 1;
+  while (stride < generations) stride *= 2;
+  return stride;
+}
+
+// Sized for the nonces one generation receives while it is current.
+size_t WordsPerGeneration(const NonceReplayFilterOptions& options) {
+  const double per_generation =
+      static_cast<double>(options.capacity) / (options.generations - 1);
+  const double words = per_generation * options.bits_per_nonce / 64;
+  if (words * Stride(options.generations) * sizeof(uint64_t) >
+      kNonceReplayFilterMaxBytes) {
+    throw std::invalid_argument("Nonce filter would exceed " +
+                                std::to_string(kNonceReplayFilterMaxBytes >> 20) +
+                                " MiB");
+  }
+  return static_cast<size_t>(words) + 1;
+}
+
+// The best number of bits for a 64-bit block at |bits_per_nonce|, fitted to
+// the false-positive rate of register-blocked Bloom filters: 6 at 16 bits,
+// 7 at 24 and 9 at 32. At most 10, the positions one hash yields.
+unsigned BitsSet(size_t bits_per_nonce) {
+  const size_t bits = (bits_per_nonce + 15) / 5;
+  return static_cast<unsigned>(bits > 10 ? 10 : bits);
+}
+
+}  // namespace
+
+NonceReplayFilter::NonceReplayFilter(const NonceReplayFilterOptions& options,
+                                     Clock::time_point now)
+    : options_(Validated(options)),
+      words_(WordsPerGeneration(options)),
+      stride_(Stride(options.generations)),
+      bits_set_(BitsSet(options.bits_per_nonce)),
+      generation_ns_(std::max<int64_t>(
+          1, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 options.window)
+                     .count() /
+                 static_cast<int64_t>(options.generations - 1))),
+      epoch_(now),
+      lines_(new CacheLine[(words_ * stride_ + 7) / 8]),
+      next_rotation_(generation_ns_) {
+  uint8_t key[sizeof(key_)];
+  FillRandom(key, sizeof(key));
+  std::memcpy(key_, key, sizeof(key_));
+  for (size_t i = 0; i < (words_ * stride_ + 7) / 8; ++i) {
+    for (std::atomic<uint64_t>& word : lines_[i].words) {
+      word.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+size_t NonceReplayFilter::memory_bytes() const {
+  return (words_ * stride_ + 7) / 8 * sizeof(CacheLine);
+}
+
+void NonceReplayFilter::Locate(const uint8_t* nonce, size_t len, size_t* word,
+                               uint64_t* mask) const {
+  const uint64_t hash = SipHash24(key_, nonce, len);
+  // Scales the top half of the hash to [0, words_) without a division.
+  *word = static_cast<size_t>(((hash >> 32) * words_) >> 32);
+  uint64_t positions = Mix64(hash);
+  *mask = 0;
+  for (unsigned i = 0; i < bits_set_; ++i) {
+    *mask |= uint64_t{1} << (positions & 63);
+    positions >>= 6;
+  }
+}
+
+std::atomic<uint64_t>& NonceReplayFilter::Word(uint64_t generation,
+                                               size_t word) {
+  const size_t index =
+      word * stride_ + static_cast<size_t>(generation % options_.generations);
+  return lines_[index / 8].words[index % 8];
+}
+
+void NonceReplayFilter::Rotate(int64_t now) {
+  std::unique_lock<std::mutex> lock(rotation_mutex_, std::try_to_lock);
+  // Another caller is rotating; this one records into the generation it
+  // finds current, which only keeps the nonce longer.
+  if (!lock.owns_lock()) return;
+  int64_t due = next_rotation_.load(std::memory_order_relaxed);
+  for (size_t cleared = 0; now >= due && cleared < options_.generations;
+       ++cleared) {
+    // The oldest generation. Callers still checking it see its nonces,
+    // which are a window old, disappear.
+    const uint64_t next = current_.load(std::memory_order_relaxed) + 1;
+    for (size_t i = 0; i < words_; ++i) {
+      Word(next, i).store(0, std::memory_order_relaxed);
+    }
+    // Publishes the cleared words with it.
+    current_.store(next, std::memory_order_seq_cst);
+    due += generation_ns_;
+  }
+  if (now >= due) {
+    // Idle for longer than the window: every generation is already clear.
+    due += ((now - due) / generation_ns_ + 1) * generation_ns_;
+  }
+  next_rotation_.store(due, std::memory_order_release);
+}
+
+bool NonceReplayFilter::CheckAndRecord(const uint8_t* nonce, size_t len,
+                                       Clock::time_point now) {
+  const int64_t now_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - epoch_)
+          .count();
+  if (now_ns >= next_rotation_.load(std::memory_order_acquire)) {
+    Rotate(now_ns);
+  }
+
+  size_t word = 0;
+  uint64_t mask = 0;
+  Locate(nonce, len, &word, &mask);
+
+  uint64_t current = current_.load(std::memory_order_seq_cst);
+  // Older generations are only read: a nonce found there stays where it is.
+  for (uint64_t age = 1; age < options_.generations && age <= current;
+       ++age) {
+    const uint64_t bits =
+        Word(current - age, word).load(std::memory_order_relaxed);
+    if ((bits & mask) == mask) return false;
+  }
+  uint64_t before =
+      Word(current, word).fetch_or(mask, std::memory_order_seq_cst);
+  bool fresh = (before & mask) != mask;
+
+  // A rotation meanwhile left the bits in what is now an older generation,
+  // which a call that already saw the new one may have checked too early.
+  // Recording again in the new one lets only one of the two accept.
+  for (uint64_t latest = current_.load(std::memory_order_seq_cst);
+       latest != current; latest = current_.load(std::memory_order_seq_cst)) {
+    current = latest;
+    before = Word(current, word).fetch_or(mask, std::memory_order_seq_cst);
+    fresh = fresh && (before & mask) != mask;
+  }
+  return fresh;
+}
+
+}  // namespace flutter_native_utils
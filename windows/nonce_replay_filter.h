@@ -0,0 +1,100 @@
+#ifndef FLUTTER_PLUGIN_NONCE_REPLAY_FILTER_H_
+#define FLUTTER_PLUGIN_NONCE_REPLAY_FILTER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace flutter_native_utils {
+
+struct NonceReplayFilterOptions {
+  // How long a nonce is remembered at least. It may be remembered for up to
+  // a generation longer.
+  std::chrono::milliseconds window{std::chrono::minutes(5)};
+  // The most nonces expected within one window. More are still recorded,
+  // at a higher false-positive rate.
+  size_t capacity = 100000;
+  // Filter bits per nonce and generation; more lowers the false-positive
+  // rate.
+  size_t bits_per_nonce = 32;
+  // Generations the window is split into: the filter drops the oldest every
+  // window / (generations - 1).
+  size_t generations = 4;
+};
+
+// Filters over this many bytes are rejected.
+constexpr size_t kNonceReplayFilterMaxBytes = 64 << 20;
+
+// Remembers the nonces seen within a sliding time window, in fixed memory,
+// so a nonce can be accepted at most once. Unlike a set of the nonces, it
+// can wrongly report an unseen nonce as seen (a false positive, about 0.1%
+// with the default options at full capacity), but never the reverse while
+// the nonce is within the window.
+//
+// The window is a ring of generations, each a register-blocked Bloom filter:
+// a nonce sets a few bits of one 64-bit word, chosen by SipHash under a key
+// drawn at construction, so nonces cannot be crafted to collide. Its words
+// in every generation share a cache line, so a check touches one. Recording
+// a nonce is a single fetch_or, so of two concurrent calls with the same
+// nonce exactly one accepts it. Checks take no lock; the caller that finds
+// a generation due clears the oldest and makes it current. Thread-safe.
+class NonceReplayFilter {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // Throws std::invalid_argument if |options| has a non-positive window, no
+  // capacity, fewer than 2 generations or 4 bits per nonce, or needs more
+  // than kNonceReplayFilterMaxBytes.
+  explicit NonceReplayFilter(const NonceReplayFilterOptions& options,
+                             Clock::time_point now = Clock::now());
+
+  // Disallow copy and assign.
+  NonceReplayFilter(const NonceReplayFilter&) = delete;
+  NonceReplayFilter& operator=(const NonceReplayFilter&) = delete;
+
+  // Records |nonce| and returns true if it was not seen within the window;
+  // returns false, recording nothing, if it was (or on a false positive).
+  bool CheckAndRecord(const uint8_t* nonce, size_t len,
+                      Clock::time_point now = Clock::now());
+
+  const NonceReplayFilterOptions& options() const { return options_; }
+  size_t memory_bytes() const;
+
+ private:
+  struct alignas(64) CacheLine {
+    std::atomic<uint64_t> words[8];
+  };
+
+  // The word and bit mask |nonce| maps to in every generation.
+  void Locate(const uint8_t* nonce, size_t len, size_t* word,
+              uint64_t* mask) const;
+  // Word |word| of generation |generation| % generations.
+  std::atomic<uint64_t>& Word(uint64_t generation, size_t word);
+  // Retires generations whose time has passed.
+  void Rotate(int64_t now);
+
+  const NonceReplayFilterOptions options_;
+  const size_t words_;          // Per generation.
+  // Words between one word of a generation and the next; generations are
+  // interleaved.
+  const size_t stride_;
+  const unsigned bits_set_;     // Per nonce.
+  const int64_t generation_ns_;
+  const Clock::time_point epoch_;
+  uint64_t key_[2];
+  std::unique_ptr<CacheLine[]> lines_;
+
+  // Generation |current_| % generations is recorded into. It counts up, so
+  // a caller can tell it rotated meanwhile.
+  std::atomic<uint64_t> current_{0};
+  // Nanoseconds since |epoch_| at which the next generation is due.
+  std::atomic<int64_t> next_rotation_;
+  std::mutex rotation_mutex_;
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_NONCE_REPLAY_FILTER_H_
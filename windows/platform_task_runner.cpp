@@ -0,0 +1,67 @@
+#include "platform_task_runner.h"
+
+#include <utility>
+
+namespace flutter_native_utils {
+
+PlatformTaskRunner::PlatformTaskRunner(
+    flutter::PluginRegistrarWindows* registrar)
+    : registrar_(registrar),
+      message_id_(RegisterWindowMessage(L"FlutterNativeUtilsPlatformTask")) {
+  window_proc_id_ = registrar_->RegisterTopLevelWindowProcDelegate(
+      [this](HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam) {
+        return HandleWindowProc(hwnd, message, wparam, lparam);
+      });
+}
+
+PlatformTaskRunner::~PlatformTaskRunner() {
+  registrar_->UnregisterTopLevelWindowProcDelegate(window_proc_id_);
+}
+
+void PlatformTaskRunner::PostTask(std::function<void()> task) {
+  bool needs_wake;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+    // One outstanding message drains the whole queue, so bursts of tasks do
+    // not flood the message loop.
+    needs_wake = !wake_pending_;
+    wake_pending_ = true;
+  }
+  if (!needs_wake) return;
+
+  HWND window = TopLevelWindow();
+  if (!window || !PostMessage(window, message_id_, 0, 0)) {
+    // No window yet; the queue is drained when the next wake succeeds.
+    std::lock_guard<std::mutex> lock(mutex_);
+    wake_pending_ = false;
+  }
+}
+
+std::optional<LRESULT> PlatformTaskRunner::HandleWindowProc(HWND hwnd,
+                                                            UINT message,
+                                                            WPARAM wparam,
+                                                            LPARAM lparam) {
+  if (message != message_id_) return std::nullopt;
+  RunPendingTasks();
+  return 0;
+}
+
+HWND PlatformTaskRunner::TopLevelWindow() {
+  flutter::FlutterView* view = registrar_->GetView();
+  if (!view) return nullptr;
+  // Plugins register before the view is parented, so resolve lazily.
+  return GetAncestor(view->GetNativeWindow(), GA_ROOT);
+}
+
+void PlatformTaskRunner::RunPendingTasks() {
+  std::deque<std::function<void()>> tasks;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks.swap(tasks_);
+    wake_pending_ = false;
+  }
+  for (auto& task : tasks) task();
+}
+
+}  // namespace flutter_native_utils
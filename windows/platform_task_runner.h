@@ -0,0 +1,52 @@
+#ifndef FLUTTER_PLUGIN_PLATFORM_TASK_RUNNER_H_
+#define FLUTTER_PLUGIN_PLATFORM_TASK_RUNNER_H_
+
+#include <windows.h>
+
+#include <flutter/plugin_registrar_windows.h>
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+
+namespace flutter_native_utils {
+
+// Runs tasks posted from any thread on the platform (UI) thread.
+//
+// Flutter channel objects (MethodResult, EventSink) must only be used on the
+// platform thread. Worker threads post a registered window message to the
+// top-level window, and the tasks are run from the plugin's top-level window
+// proc delegate.
+class PlatformTaskRunner {
+ public:
+  explicit PlatformTaskRunner(flutter::PluginRegistrarWindows* registrar);
+  ~PlatformTaskRunner();
+
+  // Disallow copy and assign.
+  PlatformTaskRunner(const PlatformTaskRunner&) = delete;
+  PlatformTaskRunner& operator=(const PlatformTaskRunner&) = delete;
+
+  // Thread-safe. Tasks posted before the top-level window exists are run once
+  // the first message reaches it. Tasks still queued at destruction are
+  // dropped.
+  void PostTask(std::function<void()> task);
+
+ private:
+  std::optional<LRESULT> HandleWindowProc(HWND hwnd, UINT message,
+                                          WPARAM wparam, LPARAM lparam);
+  HWND TopLevelWindow();
+  void RunPendingTasks();
+
+  flutter::PluginRegistrarWindows* registrar_;
+  int window_proc_id_ = -1;
+  const UINT message_id_;
+
+  std::mutex mutex_;
+  std::deque<std::function<void()>> tasks_;
+  bool wake_pending_ = false;
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_PLATFORM_TASK_RUNNER_H_
@@ -0,0 +1,178 @@
+#include "plugin_feature.h"
+
+#include <windows.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <utility>
+#include <variant>
+
+#include "allocation_stats.h"
+
+namespace flutter_native_utils {
+
+// ---------- Scheduling ----------
+
+// Completes |inner| on the engine's platform thread, whichever thread the
+// handler finishes on. Copies made for a handler that threw share |answered|,
+// so the first answer wins and later ones are dropped.
+class RoutedMethodResult
+    : public flutter::MethodResult<flutter::EncodableValue> {
+ public:
+  RoutedMethodResult(
+      std::shared_ptr<EngineRoute> route,
+      std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> inner,
+      std::shared_ptr<std::atomic<bool>> answered)
+      : route_(std::move(route)),
+        inner_(std::move(inner)),
+        answered_(std::move(answered)) {}
+
+ protected:
+  void SuccessInternal(const flutter::EncodableValue* result) override {
+    if (answered_->exchange(true)) return;
+    std::shared_ptr<flutter::EncodableValue> value;
+    if (result) value = std::make_shared<flutter::EncodableValue>(*result);
+    route_->Post([inner = inner_, value]() {
+      if (value) {
+        inner->Success(*value);
+      } else {
+        inner->Success();
+      }
+    });
+  }
+
+  void ErrorInternal(const std::string& error_code,
+                     const std::string& error_message,
+                     const flutter::EncodableValue* error_details) override {
+    if (answered_->exchange(true)) return;
+    std::shared_ptr<flutter::EncodableValue> details;
+    if (error_details) {
+      details = std::make_shared<flutter::EncodableValue>(*error_details);
+    }
+    route_->Post([inner = inner_, error_code, error_message, details]() {
+      if (details) {
+        inner->Error(error_code, error_message, *details);
+      } else {
+        inner->Error(error_code, error_message);
+      }
+    });
+  }
+
+  void NotImplementedInternal() override {
+    if (answered_->exchange(true)) return;
+    route_->Post([inner = inner_]() { inner->NotImplemented(); });
+  }
+
+ private:
+  std::shared_ptr<EngineRoute> route_;
+  std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> inner_;
+  std::shared_ptr<std::atomic<bool>> answered_;
+};
+
+MethodHandler Scheduled(const FeatureContext& context, TaskPriority priority,
+                        MethodHandler handler) {
+  // The hub outlives every task on its pool, so it is not kept alive here.
+  return [hub = context.hub, route = context.route, priority, handler](
+             const auto& call, auto result) {
+    if (!route) {
+      handler(call, std::move(result));
+      return;
+    }
+    // |call| only lives until this returns.
+    auto copy = std::make_shared<flutter::MethodCall<flutter::EncodableValue>>(
+        call.method_name(),
+        call.arguments()
+            ? std::make_unique<flutter::EncodableValue>(*call.arguments())
+            : nullptr);
+    std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> inner =
+        std::move(result);
+    hub->workers()->Post(
+        [handler, copy, route, inner]() {
+          // The call itself was counted by HandleMethodCall.
+          AllocationScope scope(copy->method_name(), /*continuation=*/true);
+          auto answered = std::make_shared<std::atomic<bool>>(false);
+          // An exception escaping a task would terminate the worker, and
+          // with it the app; the caller gets FAILURE instead, unless the
+          // handler answered before it threw.
+          try {
+            handler(*copy,
+                    std::make_unique<RoutedMethodResult>(route, inner, answered));
+          } catch (const std::exception& ex) {
+            RoutedMethodResult(route, inner, answered)
+                .Error("FAILURE", ex.what());
+          } catch (...) {
+            RoutedMethodResult(route, inner, answered)
+                .Error("FAILURE", "Unexpected error in " + copy->method_name());
+          }
+        },
+        priority);
+  };
+}
+
+// ---------- Arguments ----------
+const flutter::EncodableValue* FindArgument(const flutter::EncodableMap& args,
+                                            const char* name) {
+  auto it = args.find(flutter::EncodableValue(name));
+  return it == args.end() ? nullptr : &it->second;
+}
+
+std::vector<uint8_t> BytesArgument(const flutter::EncodableMap& args,
+                                   const char* name, bool required) {
+  const flutter::EncodableValue* value = FindArgument(args, name);
+  if (!value && !required) return {};
+  const auto* bytes = value ? std::get_if<std::vector<uint8_t>>(value) : nullptr;
+  if (!bytes) {
+    throw std::invalid_argument(std::string(name) + " must be a byte array");
+  }
+  return *bytes;
+}
+
+std::string OptionalStringArgument(const flutter::EncodableMap& args,
+                                   const char* name) {
+  const flutter::EncodableValue* value = FindArgument(args, name);
+  if (!value || value->IsNull()) return std::string();
+  const auto* text = std::get_if<std::string>(value);
+  if (!text) throw std::invalid_argument(std::string(name) + " must be a string");
+  return *text;
+}
+
+std::vector<MacMessage> ByteListArgument(const flutter::EncodableMap& args,
+                                         const char* name) {
+  const flutter::EncodableValue* value = FindArgument(args, name);
+  const auto* list = value ? std::get_if<flutter::EncodableList>(value) : nullptr;
+  if (!list) {
+    throw std::invalid_argument(std::string(name) + " must be a list");
+  }
+  std::vector<MacMessage> messages;
+  messages.reserve(list->size());
+  for (const flutter::EncodableValue& item : *list) {
+    const auto* bytes = std::get_if<std::vector<uint8_t>>(&item);
+    if (!bytes) {
+      throw std::invalid_argument(std::string(name) +
+                                  " must only contain byte arrays");
+    }
+    messages.push_back(MacMessage{bytes->data(), bytes->size()});
+  }
+  return messages;
+}
+
+// ---------- UTF8 <-> Wide ----------
+std::wstring Utf8ToWide(const std::string& str) {
+  if (str.empty()) return L"";
+  int len = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), (int)str.size(), nullptr, 0);
+  std::wstring result(len, 0);
+  MultiByteToWideChar(CP_UTF8, 0, str.c_str(), (int)str.size(), result.data(), len);
+  return result;
+}
+
+std::string WideToUtf8(const std::wstring& wstr) {
+  if (wstr.empty()) return "";
+  int len = WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), (int)wstr.size(),
+                                nullptr, 0, nullptr, nullptr);
+  std::string result(len, 0);
+  WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), (int)wstr.size(),
+                      result.data(), len, nullptr, nullptr);
+  return result;
+}
+
+}  // namespace flutter_native_utils
@@ -0,0 +1,120 @@
+#ifndef FLUTTER_PLUGIN_PLUGIN_FEATURE_H_
+#define FLUTTER_PLUGIN_PLUGIN_FEATURE_H_
+
+#include <flutter/encodable_value.h>
+#include <flutter/method_call.h>
+#include <flutter/method_result.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "backend_hub.h"
+#include "hmac_session.h"
+#include "worker_pool.h"
+
+namespace flutter_native_utils {
+
+using MethodHandler = std::function<void(
+    const flutter::MethodCall<flutter::EncodableValue>&,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>)>;
+
+// Channel method names to their handlers.
+using MethodRegistry = std::unordered_map<std::string, MethodHandler>;
+
+// What an engine's plugin instance lends its features.
+struct FeatureContext {
+  BackendHub* hub = nullptr;
+  // Delivers results to the engine's platform thread; null without a
+  // registrar.
+  std::shared_ptr<EngineRoute> route;
+};
+
+// A group of channel methods that can be left out of the build, with the
+// per-engine state they share. Each is enabled by its
+// FLUTTER_NATIVE_UTILS_FEATURE_* option in CMakeLists.txt, which defines the
+// macro of the same name; a disabled feature is not compiled, so its methods
+// report NotImplemented and its system libraries are not imported.
+//
+// The plugin creates one instance of each enabled feature per engine, on the
+// platform thread. Creating one creates no backend.
+class PluginFeature {
+ public:
+  virtual ~PluginFeature() = default;
+
+  // Adds this feature's methods to |registry|.
+  virtual void Register(MethodRegistry* registry) = 0;
+
+  // Per-engine backends of this feature that Prewarm accepts by name.
+  // Backends shared through the hub are prewarmed by the hub instead.
+  virtual std::vector<std::string> PrewarmBackends() const { return {}; }
+
+  // Creates |backend| ahead of first use, on a worker. The engine may close
+  // meanwhile, so engine state may only be touched while holding its route
+  // (see EngineRoute::Enter). Returns a task to run on the platform thread
+  // once the engine's backends are warm, or null. Failures are recorded on
+  // the timeline before they are thrown.
+  virtual std::function<void()> Prewarm(const std::string& backend) {
+    return nullptr;
+  }
+
+  // Joins the feature's per-engine threads. Called on the platform thread
+  // after the engine's route closed.
+  virtual void Close() {}
+};
+
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE
+// RequestHardwareInfo, RequestCpuTopology and paged inventory queries.
+std::shared_ptr<PluginFeature> CreateHardwareFeature(
+    const FeatureContext& context);
+#endif
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+// Persisted key pairs, SignNonce, and the data keys, ciphers and HMAC
+// sessions keyed by them.
+std::shared_ptr<PluginFeature> CreateKeyFeature(const FeatureContext& context);
+#endif
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+// Certificate export, enumeration, chains and signing.
+std::shared_ptr<PluginFeature> CreateCertificateFeature(
+    const FeatureContext& context);
+#endif
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_RESTART
+// RequestAppRestart.
+std::shared_ptr<PluginFeature> CreateRestartFeature(
+    const FeatureContext& context);
+#endif
+
+// Wraps a blocking |handler| to run on the hub's workers as a |priority|
+// task, completing its result on the platform thread. An exception the
+// handler throws before answering is reported as FAILURE. Without a route it
+// runs inline.
+MethodHandler Scheduled(const FeatureContext& context, TaskPriority priority,
+                        MethodHandler handler);
+
+// ---------- Arguments ----------
+// Null if |args| has no |name|.
+const flutter::EncodableValue* FindArgument(const flutter::EncodableMap& args,
+                                            const char* name);
+// Throws std::invalid_argument if |name| is not a byte array, or is missing
+// and |required|; returns an empty array if it is missing otherwise.
+std::vector<uint8_t> BytesArgument(const flutter::EncodableMap& args,
+                                   const char* name, bool required);
+// An empty string if |name| is missing or null. Throws std::invalid_argument
+// if it is not a string.
+std::string OptionalStringArgument(const flutter::EncodableMap& args,
+                                   const char* name);
+// Views the byte arrays in the list argument |name| without copying them.
+// Throws std::invalid_argument if it is not a list of byte arrays.
+std::vector<MacMessage> ByteListArgument(const flutter::EncodableMap& args,
+                                         const char* name);
+
+// ---------- UTF8 <-> Wide ----------
+std::wstring Utf8ToWide(const std::string& str);
+std::string WideToUtf8(const std::wstring& wstr);
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_PLUGIN_FEATURE_H_
@@ -0,0 +1,286 @@
+// Replays a method-call log recorded by the plugin (see MethodCallRecorder)
+// and reports throughput and latency distributions.
+//
+// Usage: flutter_native_utils_replay LOG [--max-speed] [--in-flight=N]
+//            [--backend=simulated|real] [--certificates=DIR]
+//            [--authorities=DIR] [--threads=N]
+//
+// The simulated backend answers every call after its recorded duration.
+// The real backend runs HashFiles, GetRandomBytes, GetCertificateChain and
+// SignWithCertificate on the portable backends (certificates come from the
+// given PEM directories) and simulates the rest, including the certificate
+// calls in a build without the certificates feature. Recorded arguments are
+// redacted, so byte payloads are zeros and hashed paths must exist on this
+// machine for those calls to do the same work.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "backend_hub.h"
+#include "buffered_random.h"
+#include "method_call_log.h"
+#include "method_call_replay.h"
+#include "standard_codec.h"
+
+namespace {
+
+using namespace flutter_native_utils;
+
+struct Options {
+  std::string log;
+  ReplayOptions replay;
+  bool real = false;
+  BackendHubOptions hub;
+};
+
+const CodecValue* Argument(const CodecValue& arguments, const char* name) {
+  const auto* map = std::get_if<CodecMap>(&arguments);
+  return map ? FindCodecMapValue(*map, name) : nullptr;
+}
+
+std::string StringArgument(const CodecValue& arguments, const char* name) {
+  const CodecValue* value = Argument(arguments, name);
+  const auto* text = value ? std::get_if<std::string>(value) : nullptr;
+  return text ? *text : std::string();
+}
+
+// Runs the calls the portable backends implement, and hands the rest to
+// |simulated|. Arguments that do not parse fail the call, as in the plugin.
+class RealDispatcher {
+ public:
+  RealDispatcher(BackendHub* hub, SimulatedBackend* simulated)
+      : hub_(hub), simulated_(simulated) {}
+
+  void Dispatch(const MethodCallRecord& record, ReplayDone done) {
+    try {
+      CodecValue arguments;
+      if (!record.arguments.empty()) {
+        arguments = DecodeStandardValue(record.arguments.data(),
+                                        record.arguments.size());
+      }
+      if (record.method == "HashFiles") {
+        HashFiles(arguments, done);
+      } else if (record.method == "GetRandomBytes") {
+        const CodecValue* length = Argument(arguments, "length");
+        const auto* count = length ? std::get_if<int32_t>(length) : nullptr;
+        if (!count || *count < 0) throw std::invalid_argument("length");
+        std::vector<uint8_t> bytes(static_cast<size_t>(*count));
+        FillRandomBuffered(bytes.data(), bytes.size());
+        done(MethodCallOutcome::kSuccess, bytes.size());
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+      } else if (record.method == "GetCertificateChain") {
+        GetCertificateChain(arguments, done);
+      } else if (record.method == "SignWithCertificate") {
+        SignWithCertificate(arguments, done);
+#endif
+      } else {
+        simulated_->Dispatch(record, done);
+      }
+    } catch (const std::exception&) {
+      done(MethodCallOutcome::kError, 0);
+    }
+  }
+
+ private:
+  // Each helper validates before anything is posted, so a throw means
+  // |done| has not been called.
+  void HashFiles(const CodecValue& arguments, const ReplayDone& done) {
+    std::vector<std::string> paths;
+    const CodecValue* list = Argument(arguments, "paths");
+    if (const auto* items = list ? std::get_if<CodecList>(list) : nullptr) {
+      for (const CodecValue& item : *items) {
+        if (const auto* path = std::get_if<std::string>(&item)) {
+          paths.push_back(*path);
+        }
+      }
+    }
+    HashAlgorithm algorithm = HashAlgorithm::kSha256;
+    std::string name = StringArgument(arguments, "algorithm");
+    if (!name.empty() && !ParseHashAlgorithm(name, &algorithm)) {
+      throw std::invalid_argument("algorithm");
+    }
+    hub_->hasher()->HashFilesAsync(
+        std::move(paths), algorithm, nullptr,
+        [done](std::vector<FileHashResult> results) {
+          uint64_t bytes = 0;
+          for (const FileHashResult& file : results) {
+            bytes += file.path.size() + file.digest.size() + file.error.size();
+          }
+          done(MethodCallOutcome::kSuccess, bytes);
+        });
+  }
+
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+  void GetCertificateChain(const CodecValue& arguments,
+                           const ReplayDone& done) {
+    const std::string thumbprint = StringArgument(arguments, "thumbprint");
+    const CodecValue* revocation = Argument(arguments, "checkRevocation");
+    const bool check_revocation =
+        revocation && std::holds_alternative<bool>(*revocation) &&
+        std::get<bool>(*revocation);
+    CertificateChainBuilder* builder = hub_->chain_builder();
+    if (auto cached = builder->Find(thumbprint, check_revocation)) {
+      done(MethodCallOutcome::kSuccess, ChainBytes(*cached));
+      return;
+    }
+    hub_->workers()->Post([builder, thumbprint, check_revocation, done]() {
+      try {
+        auto chain = builder->Build(thumbprint, check_revocation);
+        if (chain) {
+          done(MethodCallOutcome::kSuccess, ChainBytes(*chain));
+          return;
+        }
+      } catch (const std::exception&) {
+      }
+      done(MethodCallOutcome::kError, 0);
+    });
+  }
+
+  void SignWithCertificate(const CodecValue& arguments,
+                           const ReplayDone& done) {
+    SignatureHash hash = SignatureHash::kSha256;
+    SignaturePadding padding = SignaturePadding::kPkcs1;
+    std::string hash_name = StringArgument(arguments, "hash");
+    std::string padding_name = StringArgument(arguments, "padding");
+    if ((!hash_name.empty() && !ParseSignatureHash(hash_name, &hash)) ||
+        (!padding_name.empty() &&
+         !ParseSignaturePadding(padding_name, &padding))) {
+      throw std::invalid_argument("hash or padding");
+    }
+    const CodecValue* digest = Argument(arguments, "digest");
+    const CodecValue* data = digest ? digest : Argument(arguments, "data");
+    const auto* input =
+        data ? std::get_if<std::vector<uint8_t>>(data) : nullptr;
+    if (!input) throw std::invalid_argument("data or digest");
+    CertificateSigner* signer = hub_->certificate_signer();
+    hub_->workers()->Post([signer,
+                           thumbprint = StringArgument(arguments, "thumbprint"),
+                           hash, padding, input = *input,
+                           prehashed = digest != nullptr, done]() {
+      try {
+        auto key = signer->Key(thumbprint);
+        if (key) {
+          std::vector<uint8_t> signature =
+              prehashed
+                  ? key->SignDigest(hash, padding, input.data(), input.size())
+                  : key->Sign(hash, padding, input.data(), input.size());
+          done(MethodCallOutcome::kSuccess, signature.size());
+          return;
+        }
+      } catch (const std::exception&) {
+      }
+      done(MethodCallOutcome::kError, 0);
+    });
+  }
+
+  static uint64_t ChainBytes(const CertificateChain& chain) {
+    uint64_t bytes = chain.status.size();
+    for (const auto& der : chain.certificates) bytes += der.size();
+    return bytes;
+  }
+#endif
+
+  BackendHub* hub_;
+  SimulatedBackend* simulated_;
+};
+
+void PrintSummary(const std::string& name, const LatencySummary& summary) {
+  std::printf("  %-28s %8zu  mean %9.0f  p50 %8lld  p90 %8lld  p99 %8lld  "
+              "max %8lld us\n",
+              name.c_str(), summary.count, summary.mean_us,
+              static_cast<long long>(summary.p50_us),
+              static_cast<long long>(summary.p90_us),
+              static_cast<long long>(summary.p99_us),
+              static_cast<long long>(summary.max_us));
+}
+
+bool ParseOptions(int argc, char** argv, Options* options) {
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    if (std::strcmp(arg, "--max-speed") == 0) {
+      options->replay.speed = ReplaySpeed::kMaximum;
+    } else if (std::strncmp(arg, "--in-flight=", 12) == 0) {
+      options->replay.max_in_flight =
+          static_cast<size_t>(std::strtoul(arg + 12, nullptr, 10));
+    } else if (std::strcmp(arg, "--backend=simulated") == 0) {
+      options->real = false;
+    } else if (std::strcmp(arg, "--backend=real") == 0) {
+      options->real = true;
+    } else if (std::strncmp(arg, "--certificates=", 15) == 0) {
+      options->hub.certificate_directory = arg + 15;
+    } else if (std::strncmp(arg, "--authorities=", 14) == 0) {
+      options->hub.ca_directory = arg + 14;
+    } else if (std::strncmp(arg, "--threads=", 10) == 0) {
+      options->hub.worker_threads =
+          static_cast<size_t>(std::strtoul(arg + 10, nullptr, 10));
+    } else if (arg[0] != '-' && options->log.empty()) {
+      options->log = arg;
+    } else {
+      return false;
+    }
+  }
+  return !options->log.empty();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!ParseOptions(argc, argv, &options)) {
+    std::fprintf(stderr,
+                 "usage: %s LOG [--max-speed] [--in-flight=N] "
+                 "[--backend=simulated|real] [--certificates=DIR] "
+                 "[--authorities=DIR] [--threads=N]\n",
+                 argv[0]);
+    return 2;
+  }
+
+  std::vector<MethodCallRecord> records;
+  try {
+    records = ReadMethodCallLog(options.log);
+  } catch (const std::exception& ex) {
+    std::fprintf(stderr, "%s\n", ex.what());
+    return 1;
+  }
+
+  SimulatedBackend simulated;
+  std::shared_ptr<BackendHub> hub;
+  std::unique_ptr<RealDispatcher> real;
+  if (options.real) {
+    hub = BackendHub::Acquire(options.hub);
+    real = std::make_unique<RealDispatcher>(hub.get(), &simulated);
+  }
+  ReplayDispatcher dispatcher = [&](const MethodCallRecord& record,
+                                    ReplayDone done) {
+    if (real) {
+      real->Dispatch(record, std::move(done));
+    } else {
+      simulated.Dispatch(record, std::move(done));
+    }
+  };
+
+  ReplayReport report = ReplayMethodCalls(records, dispatcher, options.replay);
+  std::printf("%zu calls in %.3f s (%.0f calls/s), %s speed, %s backend\n",
+              report.calls, report.elapsed_seconds, report.calls_per_second,
+              options.replay.speed == ReplaySpeed::kMaximum ? "maximum"
+                                                             : "original",
+              options.real ? "real" : "simulated");
+  std::printf("%zu outcome mismatches, %llu result bytes\n",
+              report.outcome_mismatches,
+              static_cast<unsigned long long>(report.result_bytes));
+  PrintSummary("all", report.latency);
+  for (const auto& [method, summary] : report.latency_by_method) {
+    PrintSummary(method, summary);
+  }
+  if (options.replay.speed == ReplaySpeed::kOriginal) {
+    PrintSummary("issue lag", report.issue_lag);
+  }
+  return 0;
+}
@@ -0,0 +1,579 @@
+#include "resource_sampler.h"
+
+#ifdef _WIN32
+// winsock2.h must come before windows.h, which would otherwise pull in the
+// conflicting winsock.h that iphlpapi.h does not expect.
+#include <winsock2.h>
+#include <windows.h>
+
+#include <iphlpapi.h>
+#include <pdh.h>
+#include <timeapi.h>
+#include <winternl.h>
+
+#pragma comment(lib, "iphlpapi.lib")
+#pragma comment(lib, "pdh.lib")
+#pragma comment(lib, "winmm.lib")
+
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace flutter_native_utils {
+
+namespace {
+
+int64_t NowUnixMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// CPU time consumed by the calling thread, in microseconds.
+uint64_t CurrentThreadCpuMicros() {
+#ifdef _WIN32
+  FILETIME creation, exit, kernel, user;
+  if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+    return 0;
+  }
+  ULARGE_INTEGER k, u;
+  k.LowPart = kernel.dwLowDateTime;
+  k.HighPart = kernel.dwHighDateTime;
+  u.LowPart = user.dwLowDateTime;
+  u.HighPart = user.dwHighDateTime;
+  return (k.QuadPart + u.QuadPart) / 10;  // 100 ns units.
+#else
+  timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000u +
+         static_cast<uint64_t>(ts.tv_nsec) / 1000u;
+#endif
+}
+
+uint64_t Delta(uint64_t current, uint64_t previous) {
+  // Counters can reset (interface re-created, device removed); report zero
+  // rather than a huge bogus rate.
+  return current >= previous ? current - previous : 0;
+}
+
+float BusyFraction(uint64_t busy_delta, uint64_t total_delta) {
+  if (total_delta == 0) return 0.0f;
+  double fraction = static_cast<double>(busy_delta) /
+                    static_cast<double>(total_delta);
+  if (fraction > 1.0) fraction = 1.0;
+  return static_cast<float>(fraction);
+}
+
+void DeriveSample(const ResourceCounters& prev, const ResourceCounters& cur,
+                  double elapsed_sec, ResourceSample* out) {
+  out->timestamp_us = NowUnixMicros();
+  out->cpu_total =
+      BusyFraction(Delta(cur.cpu_busy_ticks, prev.cpu_busy_ticks),
+                   Delta(cur.cpu_total_ticks, prev.cpu_total_ticks));
+  out->core_count = cur.core_count < prev.core_count ? cur.core_count
+                                                     : prev.core_count;
+  for (uint32_t i = 0; i < out->core_count; ++i) {
+    out->cpu_per_core[i] =
+        BusyFraction(Delta(cur.core_busy_ticks[i], prev.core_busy_ticks[i]),
+                     Delta(cur.core_total_ticks[i], prev.core_total_ticks[i]));
+  }
+  out->memory_total_bytes = cur.memory_total_bytes;
+  out->memory_available_bytes = cur.memory_available_bytes;
+  double inv = elapsed_sec > 0.0 ? 1.0 / elapsed_sec : 0.0;
+  out->disk_read_bytes_per_sec =
+      static_cast<double>(Delta(cur.disk_read_bytes, prev.disk_read_bytes)) * inv;
+  out->disk_write_bytes_per_sec =
+      static_cast<double>(Delta(cur.disk_write_bytes, prev.disk_write_bytes)) * inv;
+  out->net_rx_bytes_per_sec =
+      static_cast<double>(Delta(cur.net_rx_bytes, prev.net_rx_bytes)) * inv;
+  out->net_tx_bytes_per_sec =
+      static_cast<double>(Delta(cur.net_tx_bytes, prev.net_tx_bytes)) * inv;
+}
+
+// ---------- procfs parsing helpers ----------
+
+// Reads |path| into |buffer|, reusing its capacity: once the buffer has grown
+// to the size of the file, a read does not allocate.
+bool ReadWholeFile(const std::string& path, std::string* buffer) {
+#ifdef _WIN32
+  int fd = _open(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+  if (fd < 0) return false;
+  buffer->resize(buffer->capacity());
+  size_t size = 0;
+  for (;;) {
+    if (size == buffer->size()) {
+      buffer->resize(std::max<size_t>(4096, buffer->size() * 2));
+    }
+#ifdef _WIN32
+    int n = _read(fd, &(*buffer)[size],
+                  static_cast<unsigned>(buffer->size() - size));
+#else
+    ssize_t n = ::read(fd, &(*buffer)[size], buffer->size() - size);
+    if (n < 0 && errno == EINTR) continue;
+#endif
+    if (n <= 0) break;
+    size += static_cast<size_t>(n);
+  }
+#ifdef _WIN32
+  _close(fd);
+#else
+  ::close(fd);
+#endif
+  buffer->resize(size);
+  return true;
+}
+
+// Parses whitespace separated unsigned integers starting at |p| into |values|
+// until the end of the line. Returns the number parsed.
+size_t ParseLineNumbers(const char*& p, uint64_t* values, size_t max_values) {
+  size_t count = 0;
+  while (*p && *p != '\n') {
+    while (*p == ' ' || *p == '\t') ++p;
+    if (!*p || *p == '\n') break;
+    char* end = nullptr;
+    unsigned long long value = std::strtoull(p, &end, 10);
+    if (end == p) {
+      // Not a number; skip the token.
+      while (*p && *p != ' ' && *p != '\t' && *p != '\n') ++p;
+      continue;
+    }
+    if (count < max_values) values[count++] = value;
+    p = end;
+  }
+  if (*p == '\n') ++p;
+  return count;
+}
+
+void SkipLine(const char*& p) {
+  while (*p && *p != '\n') ++p;
+  if (*p == '\n') ++p;
+}
+
+bool StartsWith(const char* p, const char* prefix) {
+  return std::strncmp(p, prefix, std::strlen(prefix)) == 0;
+}
+
+bool ParseProcStat(const std::string& text, ResourceCounters* out) {
+  const char* p = text.c_str();
+  out->core_count = 0;
+  bool have_total = false;
+  while (*p) {
+    if (!StartsWith(p, "cpu")) {
+      SkipLine(p);
+      continue;
+    }
+    bool is_total = p[3] == ' ';
+    size_t core = 0;
+    p += 3;
+    if (!is_total) {
+      char* end = nullptr;
+      core = static_cast<size_t>(std::strtoul(p, &end, 10));
+      p = end;
+    }
+    // user nice system idle iowait irq softirq steal
+    uint64_t v[8] = {};
+    if (ParseLineNumbers(p, v, 8) < 4) continue;
+    uint64_t idle = v[3] + v[4];
+    uint64_t busy = v[0] + v[1] + v[2] + v[5] + v[6] + v[7];
+    if (is_total) {
+      out->cpu_busy_ticks = busy;
+      out->cpu_total_ticks = busy + idle;
+      have_total = true;
+    } else if (core < kMaxSampledCores) {
+      out->core_busy_ticks[core] = busy;
+      out->core_total_ticks[core] = busy + idle;
+      if (core + 1 > out->core_count) {
+        out->core_count = static_cast<uint32_t>(core + 1);
+      }
+    }
+  }
+  return have_total;
+}
+
+bool ParseProcMeminfo(const std::string& text, ResourceCounters* out) {
+  const char* p = text.c_str();
+  bool have_total = false;
+  while (*p) {
+    uint64_t* target = nullptr;
+    if (StartsWith(p, "MemTotal:")) {
+      target = &out->memory_total_bytes;
+      have_total = true;
+    } else if (StartsWith(p, "MemAvailable:")) {
+      target = &out->memory_available_bytes;
+    }
+    if (!target) {
+      SkipLine(p);
+      continue;
+    }
+    while (*p != ':') ++p;
+    ++p;
+    uint64_t kib = 0;
+    ParseLineNumbers(p, &kib, 1);
+    *target = kib * 1024;
+  }
+  return have_total;
+}
+
+void ParseProcDiskstats(const std::string& text, ResourceCounters* out) {
+  out->disk_read_bytes = 0;
+  out->disk_write_bytes = 0;
+  const char* p = text.c_str();
+  // Points into |text|, so that no name is copied.
+  const char* last_disk = nullptr;
+  size_t last_disk_len = 0;
+  while (*p) {
+    // major minor name reads merged sectors_read ms writes merged
+    // sectors_written ...
+    char* end = nullptr;
+    std::strtoul(p, &end, 10);
+    std::strtoul(end, &end, 10);
+    p = end;
+    while (*p == ' ') ++p;
+    const char* name = p;
+    while (*p && *p != ' ' && *p != '\n') ++p;
+    const size_t name_len = static_cast<size_t>(p - name);
+    uint64_t v[7] = {};
+    size_t count = ParseLineNumbers(p, v, 7);
+    if (count < 7 || name_len == 0) continue;
+    if (StartsWith(name, "loop") || StartsWith(name, "ram")) continue;
+    // Partitions follow their whole disk (sda, sda1, ...); count the disk
+    // only so that I/O is not reported twice.
+    if (last_disk && name_len > last_disk_len &&
+        std::strncmp(name, last_disk, last_disk_len) == 0) {
+      continue;
+    }
+    last_disk = name;
+    last_disk_len = name_len;
+    out->disk_read_bytes += v[2] * 512;
+    out->disk_write_bytes += v[6] * 512;
+  }
+}
+
+void ParseProcNetDev(const std::string& text, ResourceCounters* out) {
+  out->net_rx_bytes = 0;
+  out->net_tx_bytes = 0;
+  const char* p = text.c_str();
+  // Two header lines.
+  SkipLine(p);
+  SkipLine(p);
+  while (*p) {
+    while (*p == ' ') ++p;
+    const char* name_begin = p;
+    while (*p && *p != ':' && *p != '\n') ++p;
+    if (*p != ':') {
+      SkipLine(p);
+      continue;
+    }
+    bool loopback = (p - name_begin) == 2 && StartsWith(name_begin, "lo");
+    ++p;
+    uint64_t v[16] = {};
+    size_t count = ParseLineNumbers(p, v, 16);
+    if (loopback || count < 9) continue;
+    out->net_rx_bytes += v[0];
+    out->net_tx_bytes += v[8];
+  }
+}
+
+#ifdef _WIN32
+// ---------- Windows backend ----------
+
+using NtQuerySystemInformationFn = NTSTATUS(NTAPI*)(SYSTEM_INFORMATION_CLASS,
+                                                    PVOID, ULONG, PULONG);
+
+uint64_t FileTimeToTicks(const FILETIME& ft) {
+  ULARGE_INTEGER value;
+  value.LowPart = ft.dwLowDateTime;
+  value.HighPart = ft.dwHighDateTime;
+  return value.QuadPart;
+}
+
+class WindowsResourceBackend : public ResourceBackend {
+ public:
+  WindowsResourceBackend() {
+    query_system_information_ = reinterpret_cast<NtQuerySystemInformationFn>(
+        GetProcAddress(GetModuleHandleW(L"ntdll.dll"),
+                       "NtQuerySystemInformation"));
+    core_info_.resize(kMaxSampledCores);
+    interfaces_.reserve(kMaxSampledInterfaces);
+
+    if (PdhOpenQueryW(nullptr, 0, &disk_query_) == ERROR_SUCCESS) {
+      PdhAddEnglishCounterW(disk_query_,
+                            L"\\PhysicalDisk(_Total)\\Disk Read Bytes/sec", 0,
+                            &disk_read_counter_);
+      PdhAddEnglishCounterW(disk_query_,
+                            L"\\PhysicalDisk(_Total)\\Disk Write Bytes/sec", 0,
+                            &disk_write_counter_);
+    }
+    RefreshInterfaces();
+  }
+
+  ~WindowsResourceBackend() override {
+    if (disk_query_) PdhCloseQuery(disk_query_);
+  }
+
+  bool ReadCounters(ResourceCounters* out) override {
+    FILETIME idle, kernel, user;
+    if (!GetSystemTimes(&idle, &kernel, &user)) return false;
+    // Kernel time includes idle time.
+    uint64_t total = FileTimeToTicks(kernel) + FileTimeToTicks(user);
+    out->cpu_total_ticks = total;
+    out->cpu_busy_ticks = total - FileTimeToTicks(idle);
+
+    out->core_count = 0;
+    if (query_system_information_) {
+      ULONG returned = 0;
+      NTSTATUS status = query_system_information_(
+          SystemProcessorPerformanceInformation, core_info_.data(),
+          static_cast<ULONG>(core_info_.size() *
+                             sizeof(SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION)),
+          &returned);
+      if (status >= 0) {
+        size_t cores =
+            returned / sizeof(SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION);
+        for (size_t i = 0; i < cores && i < kMaxSampledCores; ++i) {
+          const auto& info = core_info_[i];
+          uint64_t core_total = static_cast<uint64_t>(info.KernelTime.QuadPart) +
+                                static_cast<uint64_t>(info.UserTime.QuadPart);
+          out->core_total_ticks[i] = core_total;
+          out->core_busy_ticks[i] =
+              core_total - static_cast<uint64_t>(info.IdleTime.QuadPart);
+        }
+        out->core_count = static_cast<uint32_t>(
+            cores < kMaxSampledCores ? cores : kMaxSampledCores);
+      }
+    }
+
+    MEMORYSTATUSEX memory = {sizeof(memory)};
+    if (GlobalMemoryStatusEx(&memory)) {
+      out->memory_total_bytes = memory.ullTotalPhys;
+      out->memory_available_bytes = memory.ullAvailPhys;
+    }
+
+    if (disk_query_ && PdhCollectQueryData(disk_query_) == ERROR_SUCCESS) {
+      PDH_RAW_COUNTER raw;
+      if (disk_read_counter_ &&
+          PdhGetRawCounterValue(disk_read_counter_, nullptr, &raw) ==
+              ERROR_SUCCESS) {
+        out->disk_read_bytes = static_cast<uint64_t>(raw.FirstValue);
+      }
+      if (disk_write_counter_ &&
+          PdhGetRawCounterValue(disk_write_counter_, nullptr, &raw) ==
+              ERROR_SUCCESS) {
+        out->disk_write_bytes = static_cast<uint64_t>(raw.FirstValue);
+      }
+    }
+
+    // The interface list is refreshed occasionally; per-sample reads use
+    // GetIfEntry2, which does not allocate.
+    if (++reads_since_refresh_ >= kInterfaceRefreshInterval) {
+      RefreshInterfaces();
+    }
+    out->net_rx_bytes = 0;
+    out->net_tx_bytes = 0;
+    for (NET_IFINDEX index : interfaces_) {
+      MIB_IF_ROW2 row = {};
+      row.InterfaceIndex = index;
+      if (GetIfEntry2(&row) == NO_ERROR) {
+        out->net_rx_bytes += row.InOctets;
+        out->net_tx_bytes += row.OutOctets;
+      }
+    }
+    return true;
+  }
+
+ private:
+  static constexpr uint32_t kInterfaceRefreshInterval = 1000;
+  static constexpr size_t kMaxSampledInterfaces = 64;
+
+  void RefreshInterfaces() {
+    reads_since_refresh_ = 0;
+    interfaces_.clear();
+    MIB_IF_TABLE2* table = nullptr;
+    if (GetIfTable2(&table) != NO_ERROR) return;
+    for (ULONG i = 0; i < table->NumEntries; ++i) {
+      const MIB_IF_ROW2& row = table->Table[i];
+      if (row.Type == IF_TYPE_SOFTWARE_LOOPBACK) continue;
+      if (!row.InterfaceAndOperStatusFlags.HardwareInterface) continue;
+      if (interfaces_.size() == kMaxSampledInterfaces) break;
+      interfaces_.push_back(row.InterfaceIndex);
+    }
+    FreeMibTable(table);
+  }
+
+  NtQuerySystemInformationFn query_system_information_ = nullptr;
+  std::vector<SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION> core_info_;
+  PDH_HQUERY disk_query_ = nullptr;
+  PDH_HCOUNTER disk_read_counter_ = nullptr;
+  PDH_HCOUNTER disk_write_counter_ = nullptr;
+  std::vector<NET_IFINDEX> interfaces_;
+  uint32_t reads_since_refresh_ = 0;
+};
+#endif
+
+}  // namespace
+
+// ---------- ProcResourceBackend ----------
+
+ProcResourceBackend::ProcResourceBackend(const std::string& proc_root)
+    : stat_path_(proc_root + "/stat"),
+      meminfo_path_(proc_root + "/meminfo"),
+      diskstats_path_(proc_root + "/diskstats"),
+      net_dev_path_(proc_root + "/net/dev") {
+  buffer_.reserve(64 * 1024);
+}
+
+bool ProcResourceBackend::ReadCounters(ResourceCounters* out) {
+  if (!ReadWholeFile(stat_path_, &buffer_) || !ParseProcStat(buffer_, out)) {
+    return false;
+  }
+  if (ReadWholeFile(meminfo_path_, &buffer_)) {
+    ParseProcMeminfo(buffer_, out);
+  }
+  if (ReadWholeFile(diskstats_path_, &buffer_)) {
+    ParseProcDiskstats(buffer_, out);
+  }
+  if (ReadWholeFile(net_dev_path_, &buffer_)) {
+    ParseProcNetDev(buffer_, out);
+  }
+  return true;
+}
+
+std::unique_ptr<ResourceBackend> CreateDefaultResourceBackend() {
+#ifdef _WIN32
+  return std::make_unique<WindowsResourceBackend>();
+#else
+  return std::make_unique<ProcResourceBackend>();
+#endif
+}
+
+// ---------- ResourceSampler ----------
+
+ResourceSampler::ResourceSampler(std::unique_ptr<ResourceBackend> backend,
+                                 size_t buffer_capacity)
+    : backend_(std::move(backend)), buffer_(buffer_capacity) {}
+
+ResourceSampler::~ResourceSampler() { Stop(); }
+
+void ResourceSampler::Start(uint32_t rate_hz, uint32_t batch_size,
+                            std::function<void()> on_batch_ready) {
+  if (rate_hz < kMinRateHz || rate_hz > kMaxRateHz) {
+    throw std::invalid_argument("rateHz must be between 10 and 1000");
+  }
+  if (batch_size == 0) {
+    throw std::invalid_argument("batchSize must be positive");
+  }
+  if (running()) throw std::logic_error("Sampler already running");
+  if (thread_.joinable()) thread_.join();
+
+  on_batch_ready_ = std::move(on_batch_ready);
+  samples_.store(0, std::memory_order_relaxed);
+  thread_cpu_us_.store(0, std::memory_order_relaxed);
+  thread_wall_us_.store(0, std::memory_order_relaxed);
+  running_.store(true, std::memory_order_release);
+  thread_ = std::thread(&ResourceSampler::Run, this, rate_hz, batch_size);
+}
+
+void ResourceSampler::Stop() {
+  running_.store(false, std::memory_order_release);
+  if (thread_.joinable()) thread_.join();
+}
+
+size_t ResourceSampler::Drain(std::vector<ResourceSample>* out,
+                              size_t max_count) {
+  size_t start = out->size();
+  out->resize(start + max_count);
+  size_t count = buffer_.PopBatch(out->data() + start, max_count);
+  out->resize(start + count);
+  return count;
+}
+
+ResourceSamplerStats ResourceSampler::stats() const {
+  ResourceSamplerStats stats;
+  stats.samples = samples_.load(std::memory_order_relaxed);
+  stats.dropped = buffer_.dropped();
+  uint64_t wall = thread_wall_us_.load(std::memory_order_relaxed);
+  if (wall > 0) {
+    stats.cpu_overhead =
+        static_cast<double>(thread_cpu_us_.load(std::memory_order_relaxed)) /
+        static_cast<double>(wall);
+  }
+  return stats;
+}
+
+void ResourceSampler::Run(uint32_t rate_hz, uint32_t batch_size) {
+  using Clock = std::chrono::steady_clock;
+#ifdef _WIN32
+  // The default 15.6 ms timer resolution cannot sustain rates above ~60 Hz.
+  bool raised_timer_resolution = rate_hz > 60 && timeBeginPeriod(1) == TIMERR_NOERROR;
+#endif
+
+  // Counter snapshots are large; allocate them once, off the sampling path.
+  auto previous = std::make_unique<ResourceCounters>();
+  auto current = std::make_unique<ResourceCounters>();
+  const auto period = std::chrono::microseconds(1000000 / rate_hz);
+  const uint64_t start_cpu = CurrentThreadCpuMicros();
+  const auto start_wall = Clock::now();
+
+  bool have_previous = backend_->ReadCounters(previous.get());
+  auto previous_time = Clock::now();
+  auto next_tick = previous_time + period;
+  uint32_t pending = 0;
+
+  while (running_.load(std::memory_order_acquire)) {
+    std::this_thread::sleep_until(next_tick);
+    auto now = Clock::now();
+    next_tick += period;
+    // If we fell behind (e.g. the machine was suspended), resynchronise rather
+    // than firing a burst of back-to-back samples.
+    if (next_tick < now) next_tick = now + period;
+
+    if (backend_->ReadCounters(current.get())) {
+      if (have_previous) {
+        ResourceSample sample;
+        double elapsed =
+            std::chrono::duration<double>(now - previous_time).count();
+        DeriveSample(*previous, *current, elapsed, &sample);
+        buffer_.TryPush(sample);
+        samples_.fetch_add(1, std::memory_order_relaxed);
+        if (++pending >= batch_size) {
+          pending = 0;
+          if (on_batch_ready_) on_batch_ready_();
+        }
+      }
+      std::swap(previous, current);
+      previous_time = now;
+      have_previous = true;
+    }
+
+    thread_cpu_us_.store(CurrentThreadCpuMicros() - start_cpu,
+                         std::memory_order_relaxed);
+    thread_wall_us_.store(
+        static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                Clock::now() - start_wall)
+                .count()),
+        std::memory_order_relaxed);
+  }
+
+  if (pending > 0 && on_batch_ready_) on_batch_ready_();
+#ifdef _WIN32
+  if (raised_timer_resolution) timeEndPeriod(1);
+#endif
+}
+
+}  // namespace flutter_native_utils
@@ -0,0 +1,139 @@
+#ifndef FLUTTER_PLUGIN_RESOURCE_SAMPLER_H_
+#define FLUTTER_PLUGIN_RESOURCE_SAMPLER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spsc_ring_buffer.h"
+
+namespace flutter_native_utils {
+
+// Maximum number of logical cores reported per sample. Samples are fixed-size
+// so that the sampler thread never allocates once its backend has warmed up
+// (the Windows backend still allocates when it refreshes its interface list,
+// once every 1000 reads).
+constexpr size_t kMaxSampledCores = 128;
+
+// Cumulative counters read from the operating system. The sampler turns two
+// consecutive readings into rates.
+struct ResourceCounters {
+  uint64_t cpu_busy_ticks = 0;
+  uint64_t cpu_total_ticks = 0;
+  uint32_t core_count = 0;
+  uint64_t core_busy_ticks[kMaxSampledCores] = {};
+  uint64_t core_total_ticks[kMaxSampledCores] = {};
+  uint64_t memory_total_bytes = 0;
+  uint64_t memory_available_bytes = 0;
+  uint64_t disk_read_bytes = 0;
+  uint64_t disk_write_bytes = 0;
+  uint64_t net_rx_bytes = 0;
+  uint64_t net_tx_bytes = 0;
+};
+
+// A single derived sample as delivered to Dart.
+struct ResourceSample {
+  int64_t timestamp_us = 0;  // Microseconds since the Unix epoch.
+  float cpu_total = 0.0f;    // Busy fraction in [0, 1].
+  uint32_t core_count = 0;
+  float cpu_per_core[kMaxSampledCores] = {};
+  uint64_t memory_total_bytes = 0;
+  uint64_t memory_available_bytes = 0;
+  double disk_read_bytes_per_sec = 0.0;
+  double disk_write_bytes_per_sec = 0.0;
+  double net_rx_bytes_per_sec = 0.0;
+  double net_tx_bytes_per_sec = 0.0;
+};
+
+// Source of cumulative counters. Implementations are only ever called from the
+// sampler thread.
+class ResourceBackend {
+ public:
+  virtual ~ResourceBackend() = default;
+
+  // Fills |out| with the current counters. Returns false if the counters could
+  // not be read; the sample is then skipped.
+  virtual bool ReadCounters(ResourceCounters* out) = 0;
+};
+
+// Reads counters from a procfs tree (/proc/stat, /proc/meminfo,
+// /proc/diskstats, /proc/net/dev). |proc_root| can point at a fixture tree.
+class ProcResourceBackend : public ResourceBackend {
+ public:
+  explicit ProcResourceBackend(const std::string& proc_root = "/proc");
+
+  // Does not allocate once |buffer_| has grown to the largest file.
+  bool ReadCounters(ResourceCounters* out) override;
+
+ private:
+  const std::string stat_path_;
+  const std::string meminfo_path_;
+  const std::string diskstats_path_;
+  const std::string net_dev_path_;
+  std::string buffer_;  // Reused across reads to avoid per-sample allocation.
+};
+
+// Returns the backend for the current platform.
+std::unique_ptr<ResourceBackend> CreateDefaultResourceBackend();
+
+struct ResourceSamplerStats {
+  uint64_t samples = 0;
+  uint64_t dropped = 0;
+  // CPU time consumed by the sampler thread as a fraction of one core.
+  double cpu_overhead = 0.0;
+};
+
+// Samples system resources on a dedicated thread at a fixed rate and writes
+// them into a lock-free ring buffer. |on_batch_ready| is invoked from the
+// sampler thread every |batch_size| samples so the owner can schedule a drain
+// on its own thread; it must not block.
+class ResourceSampler {
+ public:
+  static constexpr uint32_t kMinRateHz = 10;
+  static constexpr uint32_t kMaxRateHz = 1000;
+
+  ResourceSampler(std::unique_ptr<ResourceBackend> backend,
+                  size_t buffer_capacity = 4096);
+  ~ResourceSampler();
+
+  // Disallow copy and assign.
+  ResourceSampler(const ResourceSampler&) = delete;
+  ResourceSampler& operator=(const ResourceSampler&) = delete;
+
+  // Starts sampling. Throws std::invalid_argument if |rate_hz| is outside
+  // [kMinRateHz, kMaxRateHz] or |batch_size| is zero, and std::logic_error if
+  // the sampler is already running.
+  void Start(uint32_t rate_hz, uint32_t batch_size,
+             std::function<void()> on_batch_ready);
+
+  // Stops sampling and joins the sampler thread. Queued samples stay readable.
+  void Stop();
+
+  bool running() const { return running_.load(std::memory_order_acquire); }
+
+  // Consumer side: moves up to |max_count| queued samples into |out|.
+  size_t Drain(std::vector<ResourceSample>* out, size_t max_count);
+
+  ResourceSamplerStats stats() const;
+
+ private:
+  void Run(uint32_t rate_hz, uint32_t batch_size);
+
+  std::unique_ptr<ResourceBackend> backend_;
+  SpscRingBuffer<ResourceSample> buffer_;
+  std::function<void()> on_batch_ready_;
+  std::thread thread_;
+  std::atomic<bool> running_{false};
+  std::atomic<uint64_t> samples_{0};
+  std::atomic<uint64_t> thread_cpu_us_{0};
+  std::atomic<uint64_t> thread_wall_us_{0};
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_RESOURCE_SAMPLER_H_
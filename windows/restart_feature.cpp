@@ -0,0 +1,58 @@
+#include "plugin_feature.h"
+
+#include <windows.h>
+
+#include <memory>
+#include <string>
+
+namespace flutter_native_utils {
+
+// ---------- RequestAppRestart ----------
+static std::wstring RequestAppRestart(const std::wstring& restartArgs) {
+  wchar_t moduleFileName[MAX_PATH];
+  if (GetModuleFileName(NULL, moduleFileName, MAX_PATH) == 0) {
+    return L"Failed to get module file name.";
+  }
+
+  std::wstring commandLine = L"\"";
+  commandLine += moduleFileName;
+  commandLine += L"\" ";
+  commandLine += restartArgs;
+
+  STARTUPINFO startupInfo = { sizeof(startupInfo) };
+  PROCESS_INFORMATION processInfo = { 0 };
+
+  if (!CreateProcess(moduleFileName, &commandLine[0], NULL, NULL, FALSE,
+                     0, NULL, NULL, &startupInfo, &processInfo)) {
+    return L"Failed to create process.";
+  }
+
+  CloseHandle(processInfo.hProcess);
+  CloseHandle(processInfo.hThread);
+
+  ExitProcess(0);
+}
+
+static void HandleRequestAppRestart(
+    const flutter::MethodCall<flutter::EncodableValue>&,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  std::wstring msg = RequestAppRestart(L"");
+  if (msg == L"Success") {
+    result->Success("Restart requested successfully.");
+  } else {
+    result->Error("FAILURE", WideToUtf8(msg));
+  }
+}
+
+class RestartFeature : public PluginFeature {
+ public:
+  void Register(MethodRegistry* registry) override {
+    (*registry)["RequestAppRestart"] = HandleRequestAppRestart;
+  }
+};
+
+std::shared_ptr<PluginFeature> CreateRestartFeature(const FeatureContext&) {
+  return std::make_shared<RestartFeature>();
+}
+
+}  // namespace flutter_native_utils
@@ -0,0 +1,147 @@
+#include "rsa_public_key.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <bcrypt.h>
+
+#pragma comment(lib, "bcrypt.lib")
+#else
+#include <openssl/bn.h>
+#include <openssl/core_names.h>
+#include <openssl/evp.h>
+#include <openssl/param_build.h>
+#include <openssl/rsa.h>
+#endif
+
+#include <stdexcept>
+
+namespace flutter_native_utils {
+
+#ifdef _WIN32
+namespace {
+
+BCRYPT_ALG_HANDLE RsaProvider() {
+  static BCRYPT_ALG_HANDLE provider = [] {
+    BCRYPT_ALG_HANDLE handle = nullptr;
+    if (BCryptOpenAlgorithmProvider(&handle, BCRYPT_RSA_ALGORITHM, nullptr,
+                                    0) != 0) {
+      handle = nullptr;
+    }
+    return handle;
+  }();
+  return provider;
+}
+
+}  // namespace
+
+std::unique_ptr<RsaPublicKey> RsaPublicKey::FromCngBlob(
+    const std::vector<uint8_t>& blob) {
+  BCRYPT_ALG_HANDLE provider = RsaProvider();
+  if (!provider) {
+    throw std::runtime_error("BCryptOpenAlgorithmProvider (RSA) failed");
+  }
+  BCRYPT_KEY_HANDLE key = nullptr;
+  if (BCryptImportKeyPair(provider, nullptr, BCRYPT_RSAPUBLIC_BLOB, &key,
+                          const_cast<PUCHAR>(blob.data()),
+                          static_cast<ULONG>(blob.size()), 0) != 0) {
+    throw std::invalid_argument("Invalid RSA public key blob");
+  }
+  return std::unique_ptr<RsaPublicKey>(new RsaPublicKey(key));
+}
+
+RsaPublicKey::~RsaPublicKey() {
+  BCryptDestroyKey(static_cast<BCRYPT_KEY_HANDLE>(key_));
+}
+
+bool RsaPublicKey::VerifyDigest(const Sha256Digest& digest,
+                                const uint8_t* signature,
+                                size_t signature_len) const {
+  BCRYPT_PKCS1_PADDING_INFO padding_info;
+  padding_info.pszAlgId = BCRYPT_SHA256_ALGORITHM;
+  return BCryptVerifySignature(static_cast<BCRYPT_KEY_HANDLE>(key_),
+                               &padding_info, const_cast<PUCHAR>(digest.data()),
+                               static_cast<ULONG>(digest.size()),
+                               const_cast<PUCHAR>(signature),
+                               static_cast<ULONG>(signature_len),
+                               BCRYPT_PAD_PKCS1) == 0;
+}
+#else
+namespace {
+
+// BCRYPT_RSAKEY_BLOB header; all fields are little-endian.
+constexpr uint32_t kRsaPublicMagic = 0x31415352;  // "RSA1"
+constexpr size_t kBlobHeaderLen = 24;
+
+uint32_t ReadLe32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+         static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+}  // namespace
+
+std::unique_ptr<RsaPublicKey> RsaPublicKey::FromCngBlob(
+    const std::vector<uint8_t>& blob) {
+  // Header: Magic, BitLength, cbPublicExp, cbModulus, cbPrime1, cbPrime2,
+  // followed by the big-endian exponent and modulus.
+  if (blob.size() < kBlobHeaderLen || ReadLe32(blob.data()) != kRsaPublicMagic) {
+    throw std::invalid_argument("Invalid RSA public key blob");
+  }
+  size_t exponent_len = ReadLe32(blob.data() + 8);
+  size_t modulus_len = ReadLe32(blob.data() + 12);
+  if (exponent_len == 0 || modulus_len == 0 ||
+      blob.size() < kBlobHeaderLen + exponent_len + modulus_len) {
+    throw std::invalid_argument("Invalid RSA public key blob");
+  }
+  const uint8_t* exponent_bytes = blob.data() + kBlobHeaderLen;
+  const uint8_t* modulus_bytes = exponent_bytes + exponent_len;
+
+  BIGNUM* exponent =
+      BN_bin2bn(exponent_bytes, static_cast<int>(exponent_len), nullptr);
+  BIGNUM* modulus =
+      BN_bin2bn(modulus_bytes, static_cast<int>(modulus_len), nullptr);
+  OSSL_PARAM_BLD* builder = OSSL_PARAM_BLD_new();
+  OSSL_PARAM* params = nullptr;
+  EVP_PKEY_CTX* context = EVP_PKEY_CTX_new_from_name(nullptr, "RSA", nullptr);
+  EVP_PKEY* key = nullptr;
+  bool ok = exponent && modulus && builder && context &&
+            OSSL_PARAM_BLD_push_BN(builder, OSSL_PKEY_PARAM_RSA_N, modulus) &&
+            OSSL_PARAM_BLD_push_BN(builder, OSSL_PKEY_PARAM_RSA_E, exponent) &&
+            (params = OSSL_PARAM_BLD_to_param(builder)) != nullptr &&
+            EVP_PKEY_fromdata_init(context) == 1 &&
+            EVP_PKEY_fromdata(context, &key, EVP_PKEY_PUBLIC_KEY, params) == 1;
+  EVP_PKEY_CTX_free(context);
+  OSSL_PARAM_free(params);
+  OSSL_PARAM_BLD_free(builder);
+  BN_free(modulus);
+  BN_free(exponent);
+  if (!ok) {
+    EVP_PKEY_free(key);
+    throw std::invalid_argument("Invalid RSA public key blob");
+  }
+  return std::unique_ptr<RsaPublicKey>(new RsaPublicKey(key));
+}
+
+RsaPublicKey::~RsaPublicKey() { EVP_PKEY_free(static_cast<EVP_PKEY*>(key_)); }
+
+bool RsaPublicKey::VerifyDigest(const Sha256Digest& digest,
+                                const uint8_t* signature,
+                                size_t signature_len) const {
+  EVP_PKEY_CTX* context =
+      EVP_PKEY_CTX_new(static_cast<EVP_PKEY*>(key_), nullptr);
+  bool ok = context && EVP_PKEY_verify_init(context) == 1 &&
+            EVP_PKEY_CTX_set_rsa_padding(context, RSA_PKCS1_PADDING) == 1 &&
+            EVP_PKEY_CTX_set_signature_md(context, EVP_sha256()) == 1 &&
+            EVP_PKEY_verify(context, signature, signature_len, digest.data(),
+                            digest.size()) == 1;
+  EVP_PKEY_CTX_free(context);
+  return ok;
+}
+#endif
+
+bool RsaPublicKey::VerifySha256(const uint8_t* data, size_t len,
+                                const uint8_t* signature,
+                                size_t signature_len) const {
+  return VerifyDigest(ComputeSha256(data, len), signature, signature_len);
+}
+
+}  // namespace flutter_native_utils
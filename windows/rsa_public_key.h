@@ -0,0 +1,44 @@
+#ifndef FLUTTER_PLUGIN_RSA_PUBLIC_KEY_H_
+#define FLUTTER_PLUGIN_RSA_PUBLIC_KEY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "sha256.h"
+
+namespace flutter_native_utils {
+
+// An imported RSA public key that verifies RSASSA-PKCS1-v1_5 / SHA-256
+// signatures, the format SignNonce produces. Backed by CNG on Windows and
+// OpenSSL libcrypto elsewhere. Verification is thread-safe.
+class RsaPublicKey {
+ public:
+  // Imports a BCRYPT_RSAPUBLIC_BLOB, as returned by CreateKeyPair. Throws
+  // std::invalid_argument if the blob is malformed.
+  static std::unique_ptr<RsaPublicKey> FromCngBlob(
+      const std::vector<uint8_t>& blob);
+
+  ~RsaPublicKey();
+
+  // Disallow copy and assign.
+  RsaPublicKey(const RsaPublicKey&) = delete;
+  RsaPublicKey& operator=(const RsaPublicKey&) = delete;
+
+  bool VerifySha256(const uint8_t* data, size_t len, const uint8_t* signature,
+                    size_t signature_len) const;
+
+  // Same as VerifySha256 for a message that has already been hashed.
+  bool VerifyDigest(const Sha256Digest& digest, const uint8_t* signature,
+                    size_t signature_len) const;
+
+ private:
+  explicit RsaPublicKey(void* key) : key_(key) {}
+
+  void* key_;  // BCRYPT_KEY_HANDLE or EVP_PKEY*.
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_RSA_PUBLIC_KEY_H_
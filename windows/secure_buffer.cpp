@@ -0,0 +1,211 @@
+#include "secure_buffer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace flutter_native_utils {
+
+namespace {
+
+// Usable bytes per slab; classes up to this size share slabs.
+constexpr size_t kSlabLen = 64 << 10;
+
+size_t PageSize() {
+  static const size_t page_size = [] {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return static_cast<size_t>(info.dwPageSize);
+#else
+    return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+  }();
+  return page_size;
+}
+
+size_t RoundUp(size_t value, size_t multiple) {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+// Index of the smallest class holding |len| bytes; |len| must not exceed
+// kMaxClassLen.
+size_t ClassIndex(size_t len) {
+  size_t index = 0;
+  for (size_t capacity = SecureBufferPool::kMinClassLen; capacity < len;
+       capacity <<= 1) {
+    ++index;
+  }
+  return index;
+}
+
+size_t ClassLen(size_t index) {
+  return SecureBufferPool::kMinClassLen << index;
+}
+
+const size_t kClassCount =
+    ClassIndex(SecureBufferPool::kMaxClassLen) + 1;
+
+}  // namespace
+
+void SecureZero(void* data, size_t len) {
+#ifdef _WIN32
+  SecureZeroMemory(data, len);
+#else
+  volatile uint8_t* p = static_cast<volatile uint8_t*>(data);
+  while (len--) *p++ = 0;
+#endif
+}
+
+SecureBufferPool::SecureBufferPool()
+    : free_lists_(kClassCount),
+      slab_cursor_(kClassCount, nullptr),
+      slab_remaining_(kClassCount, 0) {}
+
+SecureBufferPool::~SecureBufferPool() {
+  for (const Region& region : slabs_) UnmapRegion(region);
+  for (const Region& region : large_) UnmapRegion(region);
+}
+
+SecureBufferPool& SecureBufferPool::Default() {
+  // Never destroyed, so buffers held by other statics stay valid at exit.
+  static SecureBufferPool* pool = new SecureBufferPool();
+  return *pool;
+}
+
+size_t SecureBufferPool::CapacityFor(size_t len) {
+  if (len > kMaxClassLen) return RoundUp(len, PageSize());
+  return ClassLen(ClassIndex(len));
+}
+
+void* SecureBufferPool::Allocate(size_t len) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.allocations++;
+  stats_.bytes_in_use += CapacityFor(len);
+
+  if (len > kMaxClassLen) {
+    // Placed against the trailing guard page (16-byte aligned), so even a
+    // one-byte overrun is likely to fault.
+    large_.push_back(MapRegion(RoundUp(len, PageSize())));
+    const Region& region = large_.back();
+    return region.base + PageSize() +
+           ((region.data_len - len) & ~static_cast<size_t>(15));
+  }
+
+  const size_t index = ClassIndex(len);
+  std::vector<void*>& free_list = free_lists_[index];
+  if (!free_list.empty()) {
+    void* data = free_list.back();
+    free_list.pop_back();
+    stats_.reused++;
+    return data;
+  }
+  const size_t capacity = ClassLen(index);
+  if (slab_remaining_[index] < capacity) {
+    slabs_.push_back(MapRegion(kSlabLen));
+    slab_cursor_[index] = slabs_.back().base + PageSize();
+    slab_remaining_[index] = kSlabLen;
+  }
+  void* data = slab_cursor_[index];
+  slab_cursor_[index] += capacity;
+  slab_remaining_[index] -= capacity;
+  return data;
+}
+
+void SecureBufferPool::Free(void* data, size_t len) {
+  if (!data) return;
+  const size_t capacity = CapacityFor(len);
+  if (len <= kMaxClassLen) {
+    SecureZero(data, capacity);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.bytes_in_use -= capacity;
+    free_lists_[ClassIndex(len)].push_back(data);
+    return;
+  }
+
+  uint8_t* bytes = static_cast<uint8_t*>(data);
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = 0; i < large_.size(); ++i) {
+    uint8_t* begin = large_[i].base + PageSize();
+    if (bytes >= begin && bytes < begin + large_[i].data_len) {
+      SecureZero(begin, large_[i].data_len);
+      stats_.bytes_in_use -= capacity;
+      UnmapRegion(large_[i]);
+      large_[i] = large_.back();
+      large_.pop_back();
+      return;
+    }
+  }
+}
+
+SecureBufferPoolStats SecureBufferPool::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+#ifdef _WIN32
+SecureBufferPool::Region SecureBufferPool::MapRegion(size_t data_len) {
+  const size_t page = PageSize();
+  Region region;
+  region.length = data_len + 2 * page;
+  region.data_len = data_len;
+  region.base = static_cast<uint8_t*>(VirtualAlloc(
+      nullptr, region.length, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+  if (!region.base) throw std::bad_alloc();
+  DWORD old_protect = 0;
+  VirtualProtect(region.base, page, PAGE_NOACCESS, &old_protect);
+  VirtualProtect(region.base + page + data_len, page, PAGE_NOACCESS,
+                 &old_protect);
+  region.locked = VirtualLock(region.base + page, data_len) != 0;
+  if (region.locked) {
+    stats_.locked_bytes += data_len;
+  } else {
+    stats_.lock_failures++;
+  }
+  return region;
+}
+
+void SecureBufferPool::UnmapRegion(const Region& region) {
+  if (region.locked) {
+    VirtualUnlock(region.base + PageSize(), region.data_len);
+    stats_.locked_bytes -= region.data_len;
+  }
+  VirtualFree(region.base, 0, MEM_RELEASE);
+}
+#else
+SecureBufferPool::Region SecureBufferPool::MapRegion(size_t data_len) {
+  const size_t page = PageSize();
+  Region region;
+  region.length = data_len + 2 * page;
+  region.data_len = data_len;
+  void* base = mmap(nullptr, region.length, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) throw std::bad_alloc();
+  region.base = static_cast<uint8_t*>(base);
+  mprotect(region.base, page, PROT_NONE);
+  mprotect(region.base + page + data_len, page, PROT_NONE);
+#ifdef MADV_DONTDUMP
+  madvise(region.base + page, data_len, MADV_DONTDUMP);
+#endif
+  region.locked = mlock(region.base + page, data_len) == 0;
+  if (region.locked) {
+    stats_.locked_bytes += data_len;
+  } else {
+    stats_.lock_failures++;
+  }
+  return region;
+}
+
+void SecureBufferPool::UnmapRegion(const Region& region) {
+  if (region.locked) {
+    munlock(region.base + PageSize(), region.data_len);
+    stats_.locked_bytes -= region.data_len;
+  }
+  munmap(region.base, region.length);
+}
+#endif
+
+}  // namespace flutter_native_utils
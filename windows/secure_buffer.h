@@ -0,0 +1,124 @@
+#ifndef FLUTTER_PLUGIN_SECURE_BUFFER_H_
+#define FLUTTER_PLUGIN_SECURE_BUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace flutter_native_utils {
+
+// Overwrites |len| bytes with zeros in a way the compiler cannot elide.
+void SecureZero(void* data, size_t len);
+
+struct SecureBufferPoolStats {
+  size_t allocations = 0;     // Allocate() calls.
+  size_t reused = 0;          // Of those, served from a recycled buffer.
+  size_t bytes_in_use = 0;    // Capacity currently handed out.
+  size_t locked_bytes = 0;    // Pool memory pinned in RAM.
+  size_t lock_failures = 0;   // Regions that could not be locked.
+};
+
+// Allocator for secret material (passwords, key blobs, PFX buffers).
+//
+// Buffers are carved from slabs of pages that are locked in RAM
+// (VirtualLock / mlock) when the slab is created, excluded from core dumps
+// where the OS allows it, and bracketed by inaccessible guard pages so a
+// linear overrun off either end of a slab faults instead of reading
+// neighbouring memory. Requests are rounded up to power-of-two size classes;
+// freed buffers are zeroized and kept on a per-class free list for reuse, so
+// hot paths stop allocating once warm. Requests above the largest class get
+// a dedicated guarded mapping that is released on free.
+//
+// Locking is best effort: if the process's locked-memory quota is exhausted
+// the slab is still used (and still zeroized), and the failure is counted in
+// stats(). Thread-safe.
+class SecureBufferPool {
+ public:
+  static constexpr size_t kMinClassLen = 32;
+  static constexpr size_t kMaxClassLen = 64 << 10;
+
+  SecureBufferPool();
+
+  // Releases every slab. Buffers must not be used afterwards.
+  ~SecureBufferPool();
+
+  // Disallow copy and assign.
+  SecureBufferPool(const SecureBufferPool&) = delete;
+  SecureBufferPool& operator=(const SecureBufferPool&) = delete;
+
+  // The process-wide pool used by SecureAllocator.
+  static SecureBufferPool& Default();
+
+  // Returns a zero-filled buffer of at least |len| bytes. Throws
+  // std::bad_alloc if the OS cannot provide pages.
+  void* Allocate(size_t len);
+
+  // Zeroizes and recycles a buffer from Allocate(); |len| must be the length
+  // it was allocated with.
+  void Free(void* data, size_t len);
+
+  // Bytes a request of |len| actually occupies.
+  static size_t CapacityFor(size_t len);
+
+  SecureBufferPoolStats stats() const;
+
+ private:
+  struct Region {
+    uint8_t* base;     // Start of the mapping, including guard pages.
+    size_t length;     // Mapping length.
+    size_t data_len;   // Usable bytes between the guard pages.
+    bool locked;
+  };
+
+  Region MapRegion(size_t data_len);
+  void UnmapRegion(const Region& region);
+
+  mutable std::mutex mutex_;
+  // Per size class: recycled buffers, and the unused tail of the newest slab.
+  std::vector<std::vector<void*>> free_lists_;
+  std::vector<uint8_t*> slab_cursor_;
+  std::vector<size_t> slab_remaining_;
+  std::vector<Region> slabs_;
+  std::vector<Region> large_;
+  SecureBufferPoolStats stats_;
+};
+
+// Standard allocator over SecureBufferPool::Default().
+template <typename T>
+struct SecureAllocator {
+  using value_type = T;
+
+  SecureAllocator() = default;
+  template <typename U>
+  SecureAllocator(const SecureAllocator<U>&) {}
+
+  T* allocate(size_t n) {
+    if (n > static_cast<size_t>(-1) / sizeof(T)) throw std::bad_alloc();
+    return static_cast<T*>(SecureBufferPool::Default().Allocate(n * sizeof(T)));
+  }
+  void deallocate(T* p, size_t n) {
+    SecureBufferPool::Default().Free(p, n * sizeof(T));
+  }
+
+  template <typename U>
+  bool operator==(const SecureAllocator<U>&) const {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const SecureAllocator<U>&) const {
+    return false;
+  }
+};
+
+using SecureBytes = std::vector<uint8_t, SecureAllocator<uint8_t>>;
+
+// Secret text is kept in vectors (NUL-terminated where an API needs it)
+// rather than std::basic_string, whose small-string buffer lives inside the
+// string object and would bypass the pool.
+using SecureWideChars = std::vector<wchar_t, SecureAllocator<wchar_t>>;
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_SECURE_BUFFER_H_
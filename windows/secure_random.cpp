@@ -0,0 +1,37 @@
+#include "secure_random.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <bcrypt.h>
+
+#pragma comment(lib, "bcrypt.lib")
+#else
+#include <openssl/rand.h>
+#endif
+
+#include <climits>
+#include <stdexcept>
+
+namespace flutter_native_utils {
+
+void FillRandom(uint8_t* data, size_t len) {
+  // Both APIs take 32-bit lengths.
+  constexpr size_t kMaxPiece = INT_MAX;
+  while (len > 0) {
+    size_t piece = len < kMaxPiece ? len : kMaxPiece;
+#ifdef _WIN32
+    if (BCryptGenRandom(nullptr, data, static_cast<ULONG>(piece),
+                        BCRYPT_USE_SYSTEM_PREFERRED_RNG) != 0) {
+      throw std::runtime_error("BCryptGenRandom failed");
+    }
+#else
+    if (RAND_bytes(data, static_cast<int>(piece)) != 1) {
+      throw std::runtime_error("RAND_bytes failed");
+    }
+#endif
+    data += piece;
+    len -= piece;
+  }
+}
+
+}  // namespace flutter_native_utils
@@ -0,0 +1,15 @@
+#ifndef FLUTTER_PLUGIN_SECURE_RANDOM_H_
+#define FLUTTER_PLUGIN_SECURE_RANDOM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace flutter_native_utils {
+
+// Fills |data| from the operating system CSPRNG (BCryptGenRandom on Windows,
+// OpenSSL's RAND_bytes elsewhere). Throws std::runtime_error on failure.
+void FillRandom(uint8_t* data, size_t len);
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_SECURE_RANDOM_H_
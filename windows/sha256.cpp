@@ -0,0 +1,128 @@
+#include "sha256.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <bcrypt.h>
+
+#pragma comment(lib, "bcrypt.lib")
+#else
+#include <openssl/evp.h>
+#endif
+
+#include <stdexcept>
+
+namespace flutter_native_utils {
+
+#ifdef _WIN32
+namespace {
+
+// The algorithm provider is expensive to open and safe to share between
+// threads, so it is opened once per process.
+BCRYPT_ALG_HANDLE Sha256Provider() {
+  static BCRYPT_ALG_HANDLE provider = [] {
+    BCRYPT_ALG_HANDLE handle = nullptr;
+    if (BCryptOpenAlgorithmProvider(&handle, BCRYPT_SHA256_ALGORITHM, nullptr,
+                                    0) != 0) {
+      handle = nullptr;
+    }
+    return handle;
+  }();
+  return provider;
+}
+
+}  // namespace
+
+Sha256::Sha256() {
+  BCRYPT_ALG_HANDLE provider = Sha256Provider();
+  BCRYPT_HASH_HANDLE hash = nullptr;
+  // With no object buffer supplied, CNG allocates the hash object itself.
+  if (!provider ||
+      BCryptCreateHash(provider, &hash, nullptr, 0, nullptr, 0, 0) != 0) {
+    throw std::runtime_error("BCryptCreateHash (SHA256) failed");
+  }
+  state_ = hash;
+}
+
+Sha256::Sha256(const Sha256& other) {
+  BCRYPT_HASH_HANDLE hash = nullptr;
+  if (BCryptDuplicateHash(static_cast<BCRYPT_HASH_HANDLE>(other.state_),
+                          &hash, nullptr, 0, 0) != 0) {
+    throw std::runtime_error("BCryptDuplicateHash (SHA256) failed");
+  }
+  state_ = hash;
+}
+
+Sha256::~Sha256() {
+  if (state_) BCryptDestroyHash(static_cast<BCRYPT_HASH_HANDLE>(state_));
+}
+
+void Sha256::Update(const uint8_t* data, size_t len) {
+  // BCryptHashData takes a 32-bit length.
+  constexpr size_t kMaxPiece = 1u << 30;
+  while (len > 0) {
+    size_t piece = len < kMaxPiece ? len : kMaxPiece;
+    if (BCryptHashData(static_cast<BCRYPT_HASH_HANDLE>(state_),
+                       const_cast<PUCHAR>(data), static_cast<ULONG>(piece),
+                       0) != 0) {
+      throw std::runtime_error("BCryptHashData failed");
+    }
+    data += piece;
+    len -= piece;
+  }
+}
+
+Sha256Digest Sha256::Finish() {
+  Sha256Digest digest;
+  if (BCryptFinishHash(static_cast<BCRYPT_HASH_HANDLE>(state_), digest.data(),
+                       static_cast<ULONG>(digest.size()), 0) != 0) {
+    throw std::runtime_error("BCryptFinishHash failed");
+  }
+  return digest;
+}
+#else
+Sha256::Sha256() {
+  EVP_MD_CTX* context = EVP_MD_CTX_new();
+  if (!context || EVP_DigestInit_ex(context, EVP_sha256(), nullptr) != 1) {
+    EVP_MD_CTX_free(context);
+    throw std::runtime_error("EVP_DigestInit_ex (SHA256) failed");
+  }
+  state_ = context;
+}
+
+Sha256::Sha256(const Sha256& other) {
+  EVP_MD_CTX* context = EVP_MD_CTX_new();
+  if (!context ||
+      EVP_MD_CTX_copy_ex(context, static_cast<EVP_MD_CTX*>(other.state_)) !=
+          1) {
+    EVP_MD_CTX_free(context);
+    throw std::runtime_error("EVP_MD_CTX_copy_ex (SHA256) failed");
+  }
+  state_ = context;
+}
+
+Sha256::~Sha256() { EVP_MD_CTX_free(static_cast<EVP_MD_CTX*>(state_)); }
+
+void Sha256::Update(const uint8_t* data, size_t len) {
+  if (EVP_DigestUpdate(static_cast<EVP_MD_CTX*>(state_), data, len) != 1) {
+    throw std::runtime_error("EVP_DigestUpdate failed");
+  }
+}
+
+Sha256Digest Sha256::Finish() {
+  Sha256Digest digest;
+  unsigned int len = 0;
+  if (EVP_DigestFinal_ex(static_cast<EVP_MD_CTX*>(state_), digest.data(),
+                         &len) != 1) {
+    throw std::runtime_error("EVP_DigestFinal_ex failed");
+  }
+  return digest;
+}
+#endif
+
+Sha256Digest ComputeSha256(const uint8_t* data, size_t len) {
+  Sha256 hash;
+  hash.Update(data, len);
+  return hash.Finish();
+}
+
+}  // namespace flutter_native_utils
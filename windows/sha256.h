@@ -0,0 +1,41 @@
+#ifndef FLUTTER_PLUGIN_SHA256_H_
+#define FLUTTER_PLUGIN_SHA256_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace flutter_native_utils {
+
+constexpr size_t kSha256Len = 32;
+using Sha256Digest = std::array<uint8_t, kSha256Len>;
+
+// Incremental SHA-256 backed by the platform library (CNG on Windows,
+// OpenSSL libcrypto elsewhere), which selects SHA-NI/AVX2 code paths at run
+// time. Throws std::runtime_error if the provider cannot be initialised.
+class Sha256 {
+ public:
+  Sha256();
+  ~Sha256();
+
+  // Copies the running state, so a shared prefix is hashed only once.
+  Sha256(const Sha256& other);
+
+  // Disallow assign.
+  Sha256& operator=(const Sha256&) = delete;
+
+  void Update(const uint8_t* data, size_t len);
+
+  // Finishes the hash. The object must not be updated afterwards.
+  Sha256Digest Finish();
+
+ private:
+  void* state_ = nullptr;  // BCRYPT_HASH_HANDLE or EVP_MD_CTX*.
+};
+
+// One-shot convenience wrapper.
+Sha256Digest ComputeSha256(const uint8_t* data, size_t len);
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_SHA256_H_
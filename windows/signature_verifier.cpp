@@ -0,0 +1,109 @@
+#include "signature_verifier.h"
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <utility>
+
+namespace flutter_native_utils {
+
+namespace {
+
+// Checks per task. A multiple of 8, so each task owns whole bitmap bytes and
+// tasks never write to the same byte. An RSA-2048 verify is tens of
+// microseconds, so this keeps tasks in the low milliseconds.
+constexpr size_t kChecksPerTask = 64;
+
+struct VerifyBatch {
+  std::vector<SignatureCheck> checks;
+  SignatureBitmap bitmap;
+  SignatureCallback on_complete;
+  std::atomic<size_t> remaining{0};
+};
+
+void VerifyRange(VerifyBatch* batch, size_t begin, size_t end) {
+  for (size_t i = begin; i < end; ++i) {
+    const SignatureCheck& check = batch->checks[i];
+    bool valid = false;
+    try {
+      valid = check.key &&
+              check.key->VerifySha256(check.message, check.message_len,
+                                      check.signature, check.signature_len);
+    } catch (const std::exception&) {
+      valid = false;
+    }
+    if (valid) batch->bitmap[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+  }
+}
+
+}  // namespace
+
+void PublicKeyTable::Import(const std::string& key_id,
+                            const std::vector<uint8_t>& blob) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = keys_.find(key_id);
+    if (it != keys_.end() && it->second.blob == blob) return;
+  }
+  // Parse outside the lock; a concurrent import of the same id simply wins
+  // or loses the race below.
+  std::shared_ptr<const RsaPublicKey> key = RsaPublicKey::FromCngBlob(blob);
+  std::lock_guard<std::mutex> lock(mutex_);
+  keys_[key_id] = Entry{blob, std::move(key)};
+}
+
+bool PublicKeyTable::Remove(const std::string& key_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return keys_.erase(key_id) > 0;
+}
+
+std::shared_ptr<const RsaPublicKey> PublicKeyTable::Find(
+    const std::string& key_id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = keys_.find(key_id);
+  return it == keys_.end() ? nullptr : it->second.key;
+}
+
+size_t PublicKeyTable::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return keys_.size();
+}
+
+void VerifySignaturesAsync(std::vector<SignatureCheck> checks, WorkerPool* pool,
+                           SignatureCallback on_complete) {
+  auto batch = std::make_shared<VerifyBatch>();
+  batch->checks = std::move(checks);
+  batch->bitmap.assign((batch->checks.size() + 7) / 8, 0);
+  batch->on_complete = std::move(on_complete);
+  if (batch->checks.empty()) {
+    batch->on_complete({});
+    return;
+  }
+
+  const size_t count = batch->checks.size();
+  const size_t task_count = (count + kChecksPerTask - 1) / kChecksPerTask;
+  batch->remaining.store(task_count);
+  for (size_t task = 0; task < task_count; ++task) {
+    size_t begin = task * kChecksPerTask;
+    size_t end = begin + kChecksPerTask < count ? begin + kChecksPerTask : count;
+    pool->Post([batch, begin, end]() {
+      VerifyRange(batch.get(), begin, end);
+      if (batch->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        batch->on_complete(std::move(batch->bitmap));
+      }
+    });
+  }
+}
+
+SignatureBitmap VerifySignatures(std::vector<SignatureCheck> checks,
+                                 WorkerPool* pool) {
+  std::promise<SignatureBitmap> promise;
+  auto future = promise.get_future();
+  VerifySignaturesAsync(std::move(checks), pool,
+                        [&promise](SignatureBitmap bitmap) {
+                          promise.set_value(std::move(bitmap));
+                        });
+  return future.get();
+}
+
+}  // namespace flutter_native_utils
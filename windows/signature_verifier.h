@@ -0,0 +1,78 @@
+#ifndef FLUTTER_PLUGIN_SIGNATURE_VERIFIER_H_
+#define FLUTTER_PLUGIN_SIGNATURE_VERIFIER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rsa_public_key.h"
+#include "worker_pool.h"
+
+namespace flutter_native_utils {
+
+// Imported RSA public keys by caller-chosen id. Blobs are parsed once on
+// import; lookups hand out shared references so a key stays usable by
+// in-flight checks after it is removed or replaced. Thread-safe.
+class PublicKeyTable {
+ public:
+  // Imports a BCRYPT_RSAPUBLIC_BLOB under |key_id|, replacing any previous
+  // key with that id. Re-importing an identical blob is a lookup. Throws
+  // std::invalid_argument if the blob is malformed.
+  void Import(const std::string& key_id, const std::vector<uint8_t>& blob);
+
+  // Returns false if there was no key with that id.
+  bool Remove(const std::string& key_id);
+
+  // Returns null for unknown ids.
+  std::shared_ptr<const RsaPublicKey> Find(const std::string& key_id) const;
+
+  size_t size() const;
+
+ private:
+  struct Entry {
+    std::vector<uint8_t> blob;
+    std::shared_ptr<const RsaPublicKey> key;
+  };
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Entry> keys_;
+};
+
+// One message/signature pair to check. The bytes are not copied and must
+// stay valid until the verification completes. A null |key| (e.g. an unknown
+// key id) fails the check.
+struct SignatureCheck {
+  const uint8_t* message = nullptr;
+  size_t message_len = 0;
+  const uint8_t* signature = nullptr;
+  size_t signature_len = 0;
+  std::shared_ptr<const RsaPublicKey> key;
+};
+
+// Result of a batch: bit i (LSB first within byte i / 8) is set if check i
+// verified. Unused high bits of the last byte are zero.
+using SignatureBitmap = std::vector<uint8_t>;
+
+inline bool SignatureBitmapTest(const SignatureBitmap& bitmap, size_t index) {
+  return (bitmap[index / 8] >> (index % 8)) & 1;
+}
+
+using SignatureCallback = std::function<void(SignatureBitmap bitmap)>;
+
+// Verifies RSASSA-PKCS1-v1_5 / SHA-256 signatures in parallel on |pool|;
+// |on_complete| runs on a worker thread once every check is done.
+void VerifySignaturesAsync(std::vector<SignatureCheck> checks, WorkerPool* pool,
+                           SignatureCallback on_complete);
+
+// Blocking variant. Must not be called from a task running on |pool|.
+SignatureBitmap VerifySignatures(std::vector<SignatureCheck> checks,
+                                 WorkerPool* pool);
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_SIGNATURE_VERIFIER_H_
@@ -0,0 +1,15 @@
+#ifndef FLUTTER_PLUGIN_SIPHASH_H_
+#define FLUTTER_PLUGIN_SIPHASH_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace flutter_native_utils {
+
+// SipHash-2-4: a keyed hash short inputs cannot be steered to collide under
+// without the key, for hash tables and filters fed untrusted data.
+uint64_t SipHash24(const uint64_t key[2], const uint8_t* data, size_t len);
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_SIPHASH_H_
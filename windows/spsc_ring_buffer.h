@@ -0,0 +1,111 @@
+#ifndef FLUTTER_PLUGIN_SPSC_RING_BUFFER_H_
+#define FLUTTER_PLUGIN_SPSC_RING_BUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace flutter_native_utils {
+
+// Lock-free single-producer / single-consumer ring buffer.
+//
+// Exactly one thread may call TryPush and exactly one (other) thread may call
+// TryPop/PopBatch. The capacity is rounded up to a power of two so that the
+// head/tail indices can be masked instead of divided. Elements that do not fit
+// are dropped and counted, so a slow consumer never blocks the producer.
+template <typename T>
+class SpscRingBuffer {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SpscRingBuffer elements must be trivially copyable");
+
+ public:
+  explicit SpscRingBuffer(size_t min_capacity)
+      : capacity_(RoundUpToPowerOfTwo(min_capacity < 2 ? 2 : min_capacity)),
+        mask_(capacity_ - 1),
+        slots_(new T[capacity_]) {}
+
+  // Disallow copy and assign.
+  SpscRingBuffer(const SpscRingBuffer&) = delete;
+  SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+  size_t capacity() const { return capacity_; }
+
+  // Producer side. Returns false (and counts a drop) if the buffer is full.
+  bool TryPush(const T& value) {
+    const uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head - cached_tail_ >= capacity_) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head - cached_tail_ >= capacity_) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+    }
+    slots_[head & mask_] = value;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Returns false if the buffer is empty.
+  bool TryPop(T* out) {
+    const uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == cached_head_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail == cached_head_) return false;
+    }
+    *out = slots_[tail & mask_];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Pops up to |max_count| elements into |out| and returns how
+  // many were written. The tail is published once for the whole batch.
+  size_t PopBatch(T* out, size_t max_count) {
+    const uint64_t tail = tail_.load(std::memory_order_relaxed);
+    cached_head_ = head_.load(std::memory_order_acquire);
+    size_t available = static_cast<size_t>(cached_head_ - tail);
+    size_t count = available < max_count ? available : max_count;
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = slots_[(tail + i) & mask_];
+    }
+    tail_.store(tail + count, std::memory_order_release);
+    return count;
+  }
+
+  // Approximate number of queued elements; exact only when both sides idle.
+  size_t SizeApprox() const {
+    return static_cast<size_t>(head_.load(std::memory_order_acquire) -
+                               tail_.load(std::memory_order_acquire));
+  }
+
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  static size_t RoundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) result <<= 1;
+    return result;
+  }
+
+  const size_t capacity_;
+  const size_t mask_;
+  std::unique_ptr<T[]> slots_;
+
+  // Producer and consumer indices are padded onto separate cache lines to
+  // avoid false sharing between the two threads. Explicit padding is used
+  // instead of alignas so MSVC does not warn about the padded layout (C4324).
+  static constexpr size_t kCacheLine = 64;
+  char pad0_[kCacheLine];
+  std::atomic<uint64_t> head_{0};
+  uint64_t cached_tail_ = 0;  // Producer-local snapshot of tail_.
+  char pad1_[kCacheLine - 2 * sizeof(uint64_t)];
+  std::atomic<uint64_t> tail_{0};
+  uint64_t cached_head_ = 0;  // Consumer-local snapshot of head_.
+  char pad2_[kCacheLine - 2 * sizeof(uint64_t)];
+  std::atomic<uint64_t> dropped_{0};
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_SPSC_RING_BUFFER_H_
@@ -0,0 +1,282 @@
+#include "standard_codec.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace flutter_native_utils {
+
+namespace {
+
+// Type tags of the standard codec.
+enum : uint8_t {
+  kNull = 0,
+  kTrue = 1,
+  kFalse = 2,
+  kInt32 = 3,
+  kInt64 = 4,
+  kFloat64 = 6,
+  kString = 7,
+  kUint8List = 8,
+  kInt32List = 9,
+  kInt64List = 10,
+  kFloat64List = 11,
+  kList = 12,
+  kMap = 13,
+  kFloat32List = 14,
+};
+
+// Deeper nesting than any channel message needs; bounds the recursion on
+// corrupt input.
+constexpr int kMaxDepth = 64;
+
+class Writer {
+ public:
+  void Byte(uint8_t byte) { out_.push_back(byte); }
+
+  template <typename T>
+  void Scalar(T value) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out_.insert(out_.end(), bytes, bytes + sizeof(T));
+  }
+
+  void Size(size_t size) {
+    if (size < 254) {
+      Byte(static_cast<uint8_t>(size));
+    } else if (size <= 0xffff) {
+      Byte(254);
+      Scalar(static_cast<uint16_t>(size));
+    } else {
+      Byte(255);
+      Scalar(static_cast<uint32_t>(size));
+    }
+  }
+
+  void Align(size_t alignment) {
+    while (out_.size() % alignment != 0) Byte(0);
+  }
+
+  template <typename T>
+  void Array(const std::vector<T>& values, size_t alignment) {
+    Size(values.size());
+    if (alignment > 1) Align(alignment);
+    const auto* bytes = reinterpret_cast<const uint8_t*>(values.data());
+    out_.insert(out_.end(), bytes, bytes + values.size() * sizeof(T));
+  }
+
+  void Value(const CodecValue& value) {
+    switch (value.index()) {
+      case 0:
+        Byte(kNull);
+        break;
+      case 1:
+        Byte(std::get<bool>(value) ? kTrue : kFalse);
+        break;
+      case 2:
+        Byte(kInt32);
+        Scalar(std::get<int32_t>(value));
+        break;
+      case 3:
+        Byte(kInt64);
+        Scalar(std::get<int64_t>(value));
+        break;
+      case 4:
+        Byte(kFloat64);
+        Align(8);
+        Scalar(std::get<double>(value));
+        break;
+      case 5: {
+        const std::string& text = std::get<std::string>(value);
+        Byte(kString);
+        Size(text.size());
+        out_.insert(out_.end(), text.begin(), text.end());
+        break;
+      }
+      case 6:
+        Byte(kUint8List);
+        Array(std::get<std::vector<uint8_t>>(value), 1);
+        break;
+      case 7:
+        Byte(kInt32List);
+        Array(std::get<std::vector<int32_t>>(value), 4);
+        break;
+      case 8:
+        Byte(kInt64List);
+        Array(std::get<std::vector<int64_t>>(value), 8);
+        break;
+      case 9:
+        Byte(kFloat64List);
+        Array(std::get<std::vector<double>>(value), 8);
+        break;
+      case 10: {
+        const CodecList& list = std::get<CodecList>(value);
+        Byte(kList);
+        Size(list.size());
+        for (const CodecValue& item : list) Value(item);
+        break;
+      }
+      case 11: {
+        const CodecMap& map = std::get<CodecMap>(value);
+        Byte(kMap);
+        Size(map.size());
+        for (const auto& entry : map) {
+          Value(entry.first);
+          Value(entry.second);
+        }
+        break;
+      }
+      case 12:
+        Byte(kFloat32List);
+        Array(std::get<std::vector<float>>(value), 4);
+        break;
+    }
+  }
+
+  std::vector<uint8_t> Take() { return std::move(out_); }
+
+ private:
+  std::vector<uint8_t> out_;
+};
+
+class Reader {
+ public:
+  Reader(const uint8_t* data, size_t len) : data_(data), len_(len) {}
+
+  bool done() const { return pos_ == len_; }
+
+  uint8_t Byte() {
+    Need(1);
+    return data_[pos_++];
+  }
+
+  template <typename T>
+  T Scalar() {
+    Need(sizeof(T));
+    T value;
+    std::memcpy(&value, data_ + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return value;
+  }
+
+  size_t Size() {
+    uint8_t first = Byte();
+    if (first < 254) return first;
+    if (first == 254) return Scalar<uint16_t>();
+    return Scalar<uint32_t>();
+  }
+
+  void Align(size_t alignment) {
+    size_t padding = (alignment - pos_ % alignment) % alignment;
+    Need(padding);
+    pos_ += padding;
+  }
+
+  template <typename T>
+  std::vector<T> Array(size_t alignment) {
+    size_t count = Size();
+    if (alignment > 1) Align(alignment);
+    if (count > (len_ - pos_) / sizeof(T)) Truncated();
+    std::vector<T> values(count);
+    if (count > 0) std::memcpy(values.data(), data_ + pos_, count * sizeof(T));
+    pos_ += count * sizeof(T);
+    return values;
+  }
+
+  CodecValue Value(int depth) {
+    if (depth > kMaxDepth) {
+      throw std::invalid_argument("Standard codec value nested too deeply");
+    }
+    uint8_t type = Byte();
+    switch (type) {
+      case kNull:
+        return CodecValue();
+      case kTrue:
+        return CodecValue(true);
+      case kFalse:
+        return CodecValue(false);
+      case kInt32:
+        return CodecValue(Scalar<int32_t>());
+      case kInt64:
+        return CodecValue(Scalar<int64_t>());
+      case kFloat64:
+        Align(8);
+        return CodecValue(Scalar<double>());
+      case kString: {
+        std::vector<uint8_t> bytes = Array<uint8_t>(1);
+        return CodecValue(std::string(bytes.begin(), bytes.end()));
+      }
+      case kUint8List:
+        return CodecValue(Array<uint8_t>(1));
+      case kInt32List:
+        return CodecValue(Array<int32_t>(4));
+      case kInt64List:
+        return CodecValue(Array<int64_t>(8));
+      case kFloat64List:
+        return CodecValue(Array<double>(8));
+      case kFloat32List:
+        return CodecValue(Array<float>(4));
+      case kList: {
+        size_t count = Size();
+        // Every element takes at least one byte.
+        if (count > len_ - pos_) Truncated();
+        CodecList list;
+        list.reserve(count);
+        for (size_t i = 0; i < count; ++i) list.push_back(Value(depth + 1));
+        return CodecValue(std::move(list));
+      }
+      case kMap: {
+        size_t count = Size();
+        if (count > (len_ - pos_) / 2) Truncated();
+        CodecMap map;
+        map.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+          CodecValue key = Value(depth + 1);
+          map.emplace_back(std::move(key), Value(depth + 1));
+        }
+        return CodecValue(std::move(map));
+      }
+    }
+    throw std::invalid_argument("Unknown standard codec type " +
+                                std::to_string(type));
+  }
+
+ private:
+  void Need(size_t count) {
+    if (count > len_ - pos_) Truncated();
+  }
+
+  [[noreturn]] static void Truncated() {
+    throw std::invalid_argument("Truncated standard codec value");
+  }
+
+  const uint8_t* data_;
+  size_t len_;
+  size_t pos_ = 0;
+};
+
+}  // namespace
+
+const CodecValue* FindCodecMapValue(const CodecMap& map,
+                                    const std::string& key) {
+  for (const auto& entry : map) {
+    const auto* name = std::get_if<std::string>(&entry.first);
+    if (name && *name == key) return &entry.second;
+  }
+  return nullptr;
+}
+
+std::vector<uint8_t> EncodeStandardValue(const CodecValue& value) {
+  Writer writer;
+  writer.Value(value);
+  return writer.Take();
+}
+
+CodecValue DecodeStandardValue(const uint8_t* data, size_t len) {
+  Reader reader(data, len);
+  CodecValue value = reader.Value(0);
+  if (!reader.done()) {
+    throw std::invalid_argument("Trailing bytes after standard codec value");
+  }
+  return value;
+}
+
+}  // namespace flutter_native_utils
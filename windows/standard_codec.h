@@ -0,0 +1,53 @@
+#ifndef FLUTTER_PLUGIN_STANDARD_CODEC_H_
+#define FLUTTER_PLUGIN_STANDARD_CODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace flutter_native_utils {
+
+// A value in Flutter's StandardMessageCodec wire format, for code that has
+// to read or rewrite encoded method-call arguments without the Flutter
+// client wrapper (e.g. the call recorder and the Linux replay tool). It
+// mirrors flutter::EncodableValue, except that maps keep their wire order.
+class CodecValue;
+
+using CodecList = std::vector<CodecValue>;
+using CodecMap = std::vector<std::pair<CodecValue, CodecValue>>;
+
+using CodecVariant =
+    std::variant<std::monostate, bool, int32_t, int64_t, double, std::string,
+                 std::vector<uint8_t>, std::vector<int32_t>,
+                 std::vector<int64_t>, std::vector<double>, CodecList,
+                 CodecMap, std::vector<float>>;
+
+class CodecValue : public CodecVariant {
+ public:
+  using CodecVariant::CodecVariant;
+  using CodecVariant::operator=;
+
+  // A string literal would otherwise convert to bool.
+  CodecValue(const char* text) : CodecVariant(std::string(text)) {}
+
+  bool IsNull() const { return std::holds_alternative<std::monostate>(*this); }
+};
+
+// The value stored under the string key |key| in |map|, or null if absent.
+const CodecValue* FindCodecMapValue(const CodecMap& map, const std::string& key);
+
+// Encodes |value| exactly as flutter::StandardMessageCodec does, including
+// the alignment padding before floating-point and typed-list data.
+std::vector<uint8_t> EncodeStandardValue(const CodecValue& value);
+
+// Decodes one value spanning all of |data|. Throws std::invalid_argument if
+// it is truncated, has trailing bytes or uses a type the codec does not
+// define.
+CodecValue DecodeStandardValue(const uint8_t* data, size_t len);
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_STANDARD_CODEC_H_
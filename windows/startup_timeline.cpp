@@ -0,0 +1,43 @@
+#include "startup_timeline.h"
+
+namespace flutter_native_utils {
+
+const char* StartupPhaseName(StartupPhase phase) {
+  switch (phase) {
+    case StartupPhase::kRegistration:
+      return "registration";
+    case StartupPhase::kFirstUse:
+      return "firstUse";
+    case StartupPhase::kPrewarm:
+      return "prewarm";
+  }
+  return "unknown";
+}
+
+StartupTimeline::StartupTimeline()
+    : origin_(std::chrono::steady_clock::now()) {}
+
+int64_t StartupTimeline::Now() const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - origin_)
+      .count();
+}
+
+void StartupTimeline::Record(const std::string& backend, StartupPhase phase,
+                             int64_t start_us, const std::string& error) {
+  StartupEvent event;
+  event.backend = backend;
+  event.phase = phase;
+  event.start_us = start_us;
+  event.duration_us = Now() - start_us;
+  event.error = error;
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.push_back(std::move(event));
+}
+
+std::vector<StartupEvent> StartupTimeline::events() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return events_;
+}
+
+}  // namespace flutter_native_utils
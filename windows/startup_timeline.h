@@ -0,0 +1,131 @@
+#ifndef FLUTTER_PLUGIN_STARTUP_TIMELINE_H_
+#define FLUTTER_PLUGIN_STARTUP_TIMELINE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace flutter_native_utils {
+
+enum class StartupPhase {
+  kRegistration,  // Plugin registration, on the startup critical path.
+  kFirstUse,      // Created by the first call that needed it.
+  kPrewarm,       // Created ahead of use by an explicit warm-up.
+};
+
+// "registration", "firstUse" or "prewarm".
+const char* StartupPhaseName(StartupPhase phase);
+
+struct StartupEvent {
+  std::string backend;
+  StartupPhase phase = StartupPhase::kFirstUse;
+  // Microseconds since the timeline was created.
+  int64_t start_us = 0;
+  int64_t duration_us = 0;
+  // Why initialisation failed; empty if it succeeded.
+  std::string error;
+};
+
+// Records how long plugin registration and the initialisation of each
+// backend took, in the order they finished. Thread-safe.
+class StartupTimeline {
+ public:
+  StartupTimeline();
+
+  // Disallow copy and assign.
+  StartupTimeline(const StartupTimeline&) = delete;
+  StartupTimeline& operator=(const StartupTimeline&) = delete;
+
+  // Microseconds since the timeline was created.
+  int64_t Now() const;
+
+  // Records |backend| as having run from |start_us| until now.
+  void Record(const std::string& backend, StartupPhase phase, int64_t start_us,
+              const std::string& error = std::string());
+
+  std::vector<StartupEvent> events() const;
+
+ private:
+  const std::chrono::steady_clock::time_point origin_;
+
+  mutable std::mutex mutex_;
+  std::vector<StartupEvent> events_;
+};
+
+// A backend that is created on first use, or ahead of it by a warm-up, and
+// whose creation is recorded on a StartupTimeline. Get may be called from any
+// thread; concurrent first calls wait for a single creation.
+template <typename T>
+class LazyBackend {
+ public:
+  using Factory = std::function<std::unique_ptr<T>()>;
+
+  LazyBackend(std::string name, StartupTimeline* timeline, Factory factory)
+      : name_(std::move(name)),
+        timeline_(timeline),
+        factory_(std::move(factory)) {}
+
+  // Disallow copy and assign.
+  LazyBackend(const LazyBackend&) = delete;
+  LazyBackend& operator=(const LazyBackend&) = delete;
+
+  const std::string& name() const { return name_; }
+
+  // Returns the backend, creating it first if needed and recording the
+  // creation under |phase|. If the factory throws, the failure is recorded,
+  // the exception propagates and the next call tries again. Throws
+  // std::runtime_error after Close().
+  T* Get(StartupPhase phase = StartupPhase::kFirstUse) {
+    if (T* backend = created_.load(std::memory_order_acquire)) return backend;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) throw std::runtime_error(name_ + " is shut down");
+    if (backend_) return backend_.get();
+    const int64_t start = timeline_->Now();
+    try {
+      backend_ = factory_();
+    } catch (const std::exception& ex) {
+      timeline_->Record(name_, phase, start, ex.what());
+      throw;
+    }
+    timeline_->Record(name_, phase, start);
+    created_.store(backend_.get(), std::memory_order_release);
+    return backend_.get();
+  }
+
+  // Returns the backend, or null if it has not been created. Never creates.
+  T* GetIfCreated() const { return created_.load(std::memory_order_acquire); }
+
+  // Destroys the backend and makes later Get calls throw, so a warm-up
+  // still running during shutdown cannot bring it back. Waits for an
+  // in-progress creation. Pointers returned by Get must no longer be used.
+  void Close() {
+    std::unique_ptr<T> backend;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+      created_.store(nullptr, std::memory_order_release);
+      backend = std::move(backend_);
+    }
+  }
+
+ private:
+  const std::string name_;
+  StartupTimeline* const timeline_;
+  const Factory factory_;
+
+  std::mutex mutex_;
+  std::atomic<T*> created_{nullptr};
+  std::unique_ptr<T> backend_;
+  bool closed_ = false;
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_STARTUP_TIMELINE_H_
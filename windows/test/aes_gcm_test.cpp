@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "aes_gcm.h"
+#include "worker_pool.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+std::string ToHex(const uint8_t* data, size_t len) {
+  static const char kDigits[] = "0123456789abcdef";
+  std::string hex;
+  for (size_t i = 0; i < len; ++i) {
+    hex.push_back(kDigits[data[i] >> 4]);
+    hex.push_back(kDigits[data[i] & 0xf]);
+  }
+  return hex;
+}
+
+std::vector<uint8_t> Pattern(size_t len) {
+  std::vector<uint8_t> data(len);
+  for (size_t i = 0; i < len; ++i) data[i] = static_cast<uint8_t>(i * 7 + 3);
+  return data;
+}
+
+AesGcmKey TestKey() {
+  AesGcmKey key;
+  for (size_t i = 0; i < key.size(); ++i) key[i] = static_cast<uint8_t>(i);
+  return key;
+}
+
+constexpr size_t kSmallChunk = 1000;
+
+}  // namespace
+
+// NIST GCM specification test cases 13 and 14 (zero key and IV).
+TEST(AesGcmCipher, MatchesNistVectors) {
+  AesGcmKey key = {};
+  uint8_t nonce[kAesGcmNonceLen] = {};
+  AesGcmCipher cipher(key);
+
+  uint8_t empty_out[kAesGcmTagLen];
+  cipher.Seal(nonce, nullptr, 0, nullptr, 0, empty_out);
+  EXPECT_EQ(ToHex(empty_out, sizeof(empty_out)),
+            "530f8afbc74536b9a963b4f1c4cb738b");
+
+  uint8_t zeros[16] = {};
+  uint8_t out[16 + kAesGcmTagLen];
+  cipher.Seal(nonce, nullptr, 0, zeros, sizeof(zeros), out);
+  EXPECT_EQ(ToHex(out, sizeof(out)),
+            "cea7403d4d606b6e074ec5d3baf39d18d0d1c8a799996bf0265b98b5d48ab919");
+
+  uint8_t opened[16];
+  EXPECT_TRUE(cipher.Open(nonce, nullptr, 0, out, sizeof(out), opened));
+  out[3] ^= 1;
+  EXPECT_FALSE(cipher.Open(nonce, nullptr, 0, out, sizeof(out), opened));
+}
+
+TEST(AesGcm, BulkRoundTripsAtChunkBoundaries) {
+  WorkerPool pool(3);
+  const std::vector<uint8_t> aad = {'c', 't', 'x'};
+  for (size_t len : {size_t{0}, size_t{1}, kSmallChunk - 1, kSmallChunk,
+                     kSmallChunk + 1, 3 * kSmallChunk, 2500 * kSmallChunk + 17}) {
+    std::vector<uint8_t> plaintext = Pattern(len);
+    std::vector<uint8_t> ciphertext =
+        AesGcmEncrypt(TestKey(), plaintext, aad, &pool, kSmallChunk);
+    EXPECT_EQ(ciphertext.size(), AesGcmCiphertextLen(len, kSmallChunk));
+
+    std::vector<uint8_t> decrypted;
+    ASSERT_TRUE(AesGcmDecrypt(TestKey(), ciphertext, aad, &pool, &decrypted))
+        << "len=" << len;
+    EXPECT_EQ(decrypted, plaintext);
+  }
+}
+
+TEST(AesGcm, DetectsTamperingTruncationAndWrongContext) {
+  WorkerPool pool(2);
+  std::vector<uint8_t> ciphertext =
+      AesGcmEncrypt(TestKey(), Pattern(5 * kSmallChunk), {}, &pool, kSmallChunk);
+  std::vector<uint8_t> out;
+
+  std::vector<uint8_t> flipped = ciphertext;
+  flipped[kAesGcmHeaderLen + 2 * kSmallChunk] ^= 1;
+  EXPECT_FALSE(AesGcmDecrypt(TestKey(), flipped, {}, &pool, &out));
+  EXPECT_TRUE(out.empty());
+
+  // Dropping the final chunk leaves a valid-looking but non-final record.
+  std::vector<uint8_t> truncated(
+      ciphertext.begin(), ciphertext.end() - (kSmallChunk + kAesGcmTagLen));
+  EXPECT_FALSE(AesGcmDecrypt(TestKey(), truncated, {}, &pool, &out));
+
+  std::vector<uint8_t> swapped = ciphertext;
+  const size_t record = kSmallChunk + kAesGcmTagLen;
+  std::swap_ranges(swapped.begin() + kAesGcmHeaderLen,
+                   swapped.begin() + kAesGcmHeaderLen + record,
+                   swapped.begin() + kAesGcmHeaderLen + record);
+  EXPECT_FALSE(AesGcmDecrypt(TestKey(), swapped, {}, &pool, &out));
+
+  EXPECT_FALSE(AesGcmDecrypt(TestKey(), ciphertext, {'x'}, &pool, &out));
+  AesGcmKey other = TestKey();
+  other[0] ^= 1;
+  EXPECT_FALSE(AesGcmDecrypt(other, ciphertext, {}, &pool, &out));
+
+  EXPECT_THROW(AesGcmDecrypt(TestKey(), {1, 2, 3}, {}, &pool, &out),
+               std::invalid_argument);
+}
+
+TEST(AesGcm, StreamsInterOperateWithBulk) {
+  WorkerPool pool(2);
+  const std::vector<uint8_t> plaintext = Pattern(7 * kSmallChunk + 123);
+  const std::vector<uint8_t> aad = {1, 2, 3};
+
+  // Feed the encryptor in uneven pieces.
+  AesGcmStreamEncryptor encryptor(TestKey(), aad, kSmallChunk);
+  std::vector<uint8_t> ciphertext;
+  size_t offset = 0;
+  for (size_t piece : {size_t{1}, size_t{999}, size_t{2500}, size_t{10}}) {
+    encryptor.Update(plaintext.data() + offset, piece, &ciphertext);
+    offset += piece;
+  }
+  encryptor.Update(plaintext.data() + offset, plaintext.size() - offset,
+                   &ciphertext);
+  encryptor.Finish(&ciphertext);
+
+  std::vector<uint8_t> decrypted;
+  ASSERT_TRUE(AesGcmDecrypt(TestKey(), ciphertext, aad, &pool, &decrypted));
+  EXPECT_EQ(decrypted, plaintext);
+
+  std::vector<uint8_t> bulk =
+      AesGcmEncrypt(TestKey(), plaintext, aad, &pool, kSmallChunk);
+  AesGcmStreamDecryptor decryptor(TestKey(), aad);
+  std::vector<uint8_t> streamed;
+  for (size_t i = 0; i < bulk.size(); i += 777) {
+    size_t piece = bulk.size() - i < 777 ? bulk.size() - i : 777;
+    ASSERT_TRUE(decryptor.Update(bulk.data() + i, piece, &streamed));
+  }
+  ASSERT_TRUE(decryptor.Finish(&streamed));
+  EXPECT_EQ(streamed, plaintext);
+}
+
+TEST(AesGcm, StreamDecryptorRejectsTruncatedStream) {
+  WorkerPool pool(1);
+  std::vector<uint8_t> ciphertext =
+      AesGcmEncrypt(TestKey(), Pattern(3 * kSmallChunk), {}, &pool, kSmallChunk);
+  ciphertext.resize(ciphertext.size() - (kSmallChunk + kAesGcmTagLen));
+
+  AesGcmStreamDecryptor decryptor(TestKey(), {});
+  std::vector<uint8_t> out;
+  EXPECT_TRUE(decryptor.Update(ciphertext.data(), ciphertext.size(), &out));
+  EXPECT_FALSE(decryptor.Finish(&out));
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "affine_executor.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+// Records which threads construct and destroy it, like a COM apartment that
+// must be entered and left on the same thread.
+struct RecordingContext {
+  static std::thread::id constructed_on;
+  static std::thread::id destroyed_on;
+  static int constructions;
+
+  RecordingContext() {
+    constructed_on = std::this_thread::get_id();
+    ++constructions;
+  }
+  ~RecordingContext() { destroyed_on = std::this_thread::get_id(); }
+
+  // Per-thread state the tasks build on, like a cached connection.
+  int calls = 0;
+};
+
+std::thread::id RecordingContext::constructed_on;
+std::thread::id RecordingContext::destroyed_on;
+int RecordingContext::constructions = 0;
+
+struct FailingContext {
+  FailingContext() { throw std::runtime_error("CoInitializeEx failed"); }
+};
+
+}  // namespace
+
+TEST(AffineExecutor, RunsEveryTaskOnOneInitialisedThread) {
+  RecordingContext::constructions = 0;
+  std::thread::id executor_thread;
+  {
+    AffineExecutor<RecordingContext> executor;
+    EXPECT_FALSE(executor.IsCurrentThread());
+    std::vector<std::future<int>> calls;
+    for (int i = 0; i < 50; ++i) {
+      calls.push_back(executor.Submit([&executor](RecordingContext& context) {
+        EXPECT_TRUE(executor.IsCurrentThread());
+        EXPECT_EQ(std::this_thread::get_id(), RecordingContext::constructed_on);
+        return ++context.calls;
+      }));
+    }
+    // In order, and against the same context.
+    for (int i = 0; i < 50; ++i) EXPECT_EQ(calls[i].get(), i + 1);
+    executor_thread = RecordingContext::constructed_on;
+  }
+  EXPECT_EQ(RecordingContext::constructions, 1);
+  EXPECT_NE(executor_thread, std::this_thread::get_id());
+  EXPECT_EQ(RecordingContext::destroyed_on, executor_thread);
+}
+
+TEST(AffineExecutor, DeliversResultsAndExceptions) {
+  AffineExecutor<RecordingContext> executor;
+  std::future<std::string> text =
+      executor.Submit([](RecordingContext&) { return std::string("cpu"); });
+  std::atomic<bool> ran{false};
+  std::future<void> done =
+      executor.Submit([&ran](RecordingContext&) { ran = true; });
+  std::future<int> failed = executor.Submit([](RecordingContext&) -> int {
+    throw std::invalid_argument("no such property");
+  });
+
+  EXPECT_EQ(text.get(), "cpu");
+  done.get();
+  EXPECT_TRUE(ran);
+  EXPECT_THROW(failed.get(), std::invalid_argument);
+  // A failed task leaves the thread usable.
+  EXPECT_EQ(executor.Submit([](RecordingContext&) { return 7; }).get(), 7);
+}
+
+TEST(AffineExecutor, FailsEveryTaskIfTheContextCannotBeCreated) {
+  AffineExecutor<FailingContext> executor;
+  for (int i = 0; i < 3; ++i) {
+    std::future<int> result =
+        executor.Submit([](FailingContext&) { return 1; });
+    EXPECT_THROW(result.get(), std::runtime_error);
+  }
+}
+
+TEST(AffineExecutor, DiscardsQueuedTasksOnDestruction) {
+  std::promise<void> release;
+  std::shared_future<void> gate = release.get_future().share();
+  std::future<void> blocked;
+  std::future<int> queued;
+  std::thread releaser;
+  {
+    AffineExecutor<RecordingContext> executor;
+    std::promise<void> started;
+    blocked = executor.Submit([&started, gate](RecordingContext&) {
+      started.set_value();
+      gate.wait();
+    });
+    started.get_future().wait();
+    queued = executor.Submit([](RecordingContext&) { return 1; });
+    // The destructor waits for the running task; release it meanwhile.
+    releaser = std::thread([&release]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      release.set_value();
+    });
+  }
+  releaser.join();
+  blocked.get();
+  try {
+    queued.get();
+    FAIL() << "queued task ran";
+  } catch (const std::future_error& error) {
+    EXPECT_EQ(error.code(), std::future_errc::broken_promise);
+  }
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "allocation_stats.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+// Keeps the compiler from eliding the allocations under test.
+void* volatile escaped = nullptr;
+
+void* Allocate(size_t size) {
+  void* block = ::operator new(size);
+  escaped = block;
+  return block;
+}
+
+const MethodAllocationStats* FindStats(
+    const std::vector<MethodAllocationStats>& snapshot,
+    const std::string& method) {
+  for (const MethodAllocationStats& stats : snapshot) {
+    if (stats.method == method) return &stats;
+  }
+  return nullptr;
+}
+
+class AllocationStatsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!AllocationTrackingEnabled()) {
+      GTEST_SKIP() << "allocation_hooks.cpp is not linked into this build";
+    }
+    ResetAllocationStats();
+  }
+};
+
+}  // namespace
+
+TEST_F(AllocationStatsTest, CountsAllocationsAndPeakPerMethod) {
+  uint64_t allocations = 0;
+  uint64_t bytes = 0;
+  uint64_t peak_bytes = 0;
+  {
+    AllocationScope scope("alpha");
+    void* first = Allocate(100);
+    void* second = Allocate(200);
+    ::operator delete(first);
+    void* third = Allocate(50);
+    ::operator delete(second);
+    ::operator delete(third);
+    allocations = scope.allocations();
+    bytes = scope.bytes();
+    peak_bytes = scope.peak_bytes();
+  }
+  EXPECT_EQ(allocations, 3u);
+  EXPECT_EQ(bytes, 350u);
+  EXPECT_EQ(peak_bytes, 300u);
+
+  {
+    AllocationScope scope("alpha");
+    ::operator delete(Allocate(1000));
+  }
+  {
+    AllocationScope scope("beta");
+  }
+
+  std::vector<MethodAllocationStats> snapshot = AllocationStatsSnapshot();
+  ASSERT_EQ(snapshot.size(), 2u);
+  EXPECT_EQ(snapshot[0].method, "alpha");
+  EXPECT_EQ(snapshot[0].calls, 2u);
+  EXPECT_EQ(snapshot[0].allocations, 4u);
+  EXPECT_EQ(snapshot[0].bytes, 1350u);
+  EXPECT_EQ(snapshot[0].peak_bytes, 1000u);
+  EXPECT_EQ(snapshot[1].method, "beta");
+  EXPECT_EQ(snapshot[1].calls, 1u);
+  EXPECT_EQ(snapshot[1].allocations, 0u);
+
+  ResetAllocationStats();
+  EXPECT_TRUE(AllocationStatsSnapshot().empty());
+}
+
+TEST_F(AllocationStatsTest, NestedScopesChargeTheOuterOne) {
+  {
+    AllocationScope outer("outer");
+    AllocationScope inner("inner");
+    ::operator delete(Allocate(64));
+  }
+  std::vector<MethodAllocationStats> snapshot = AllocationStatsSnapshot();
+  const MethodAllocationStats* outer = FindStats(snapshot, "outer");
+  ASSERT_NE(outer, nullptr);
+  EXPECT_EQ(outer->calls, 1u);
+  EXPECT_EQ(outer->allocations, 1u);
+  EXPECT_EQ(FindStats(snapshot, "inner"), nullptr);
+}
+
+TEST_F(AllocationStatsTest, ContinuationsAddToTheCallWithoutCountingIt) {
+  {
+    AllocationScope scope("delta");
+    ::operator delete(Allocate(10));
+  }
+  std::thread worker([]() {
+    AllocationScope scope("delta", /*continuation=*/true);
+    ::operator delete(Allocate(20));
+  });
+  worker.join();
+
+  std::vector<MethodAllocationStats> snapshot = AllocationStatsSnapshot();
+  const MethodAllocationStats* delta = FindStats(snapshot, "delta");
+  ASSERT_NE(delta, nullptr);
+  EXPECT_EQ(delta->calls, 1u);
+  EXPECT_EQ(delta->allocations, 2u);
+  EXPECT_EQ(delta->bytes, 30u);
+  EXPECT_EQ(delta->peak_bytes, 20u);
+}
+
+TEST_F(AllocationStatsTest, FreesOfEarlierBlocksDoNotLowerThePeak) {
+  void* earlier = Allocate(500);
+  uint64_t peak_bytes = 0;
+  {
+    AllocationScope scope("gamma");
+    ::operator delete(earlier);
+    void* block = Allocate(100);
+    peak_bytes = scope.peak_bytes();
+    ::operator delete(block);
+  }
+  EXPECT_EQ(peak_bytes, 100u);
+}
+
+TEST_F(AllocationStatsTest, CountsOverAlignedAllocations) {
+  struct alignas(128) Line {
+    uint8_t bytes[128];
+  };
+  uint64_t allocations = 0;
+  uint64_t peak_bytes = 0;
+  {
+    AllocationScope scope("delta");
+    auto* line = new Line;
+    escaped = line;
+    auto* lines = new Line[3];
+    escaped = lines;
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(line) % alignof(Line), 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(lines) % alignof(Line), 0u);
+    delete line;
+    delete[] lines;
+    allocations = scope.allocations();
+    peak_bytes = scope.peak_bytes();
+  }
+  EXPECT_EQ(allocations, 2u);
+  EXPECT_GE(peak_bytes, 4 * sizeof(Line));
+  std::vector<MethodAllocationStats> snapshot = AllocationStatsSnapshot();
+  const MethodAllocationStats* stats = FindStats(snapshot, "delta");
+  ASSERT_NE(stats, nullptr);
+  EXPECT_EQ(stats->allocations, 2u);
+}
+
+TEST_F(AllocationStatsTest, UnscopedAllocationsAreNotCounted) {
+  ::operator delete(Allocate(128));
+  EXPECT_TRUE(AllocationStatsSnapshot().empty());
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
@@ -0,0 +1,356 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "backend_hub.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+const std::string kFixturesDir = FLUTTER_NATIVE_UTILS_FIXTURES_DIR;
+constexpr size_t kEngineCount = 16;
+constexpr size_t kWorkerThreads = 4;
+// Covers a platform thread's touched stack and allocator arena; a private
+// pool, chain engine and key cache per engine would not fit.
+constexpr size_t kMaxBytesPerExtraEngine = 256 << 10;
+// Sanitizer runtimes add threads and shadow memory of their own.
+#ifdef FLUTTER_NATIVE_UTILS_SANITIZED
+constexpr bool kCountsResources = false;
+#else
+constexpr bool kCountsResources = true;
+#endif
+
+size_t ThreadCount() {
+  size_t count = 0;
+  for (const auto& entry : fs::directory_iterator("/proc/self/task")) {
+    (void)entry;
+    ++count;
+  }
+  return count;
+}
+
+size_t ResidentBytes() {
+  size_t pages = 0;
+  size_t resident = 0;
+  FILE* statm = std::fopen("/proc/self/statm", "r");
+  if (statm) {
+    if (std::fscanf(statm, "%zu %zu", &pages, &resident) != 2) resident = 0;
+    std::fclose(statm);
+  }
+  return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+// A scratch directory of the running test's own, so tests run in parallel
+// do not share one.
+fs::path ScratchDirectory() {
+  const ::testing::TestInfo* info =
+      ::testing::UnitTest::GetInstance()->current_test_info();
+  return fs::temp_directory_path() /
+         ("fnu_" + std::string(info->test_suite_name()) + "_" + info->name());
+}
+
+BackendHubOptions TestOptions() {
+  BackendHubOptions options;
+  options.worker_threads = kWorkerThreads;
+  options.certificate_directory = kFixturesDir + "/certificates";
+  options.ca_directory = kFixturesDir + "/certificate_authorities";
+  return options;
+}
+
+// Stands in for a registrar: one engine with its own platform thread, which
+// acquires the hub and routes results back to itself the way the plugin
+// does through its PlatformTaskRunner.
+class FakeEngine {
+ public:
+  FakeEngine()
+      : thread_([this]() { Run(); }),
+        hub_(BackendHub::Acquire(TestOptions())),
+        route_(EngineRoute::Create([this](std::function<void()> task) {
+          std::lock_guard<std::mutex> lock(mutex_);
+          tasks_.push_back(std::move(task));
+          wake_.notify_one();
+        })) {}
+
+  // Stops the platform thread first, as a closing window would, then
+  // unregisters.
+  ~FakeEngine() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+      wake_.notify_one();
+    }
+    thread_.join();
+    route_->Close();
+  }
+
+  BackendHub* hub() { return hub_.get(); }
+  const std::shared_ptr<EngineRoute>& route() { return route_; }
+  std::thread::id platform_thread() const { return thread_.get_id(); }
+
+ private:
+  void Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      wake_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+      if (stopping_) return;
+      std::function<void()> task = std::move(tasks_.front());
+      tasks_.pop_front();
+      lock.unlock();
+      task();
+      lock.lock();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<std::function<void()>> tasks_;
+  bool stopping_ = false;
+  std::thread thread_;
+
+  std::shared_ptr<BackendHub> hub_;
+  std::shared_ptr<EngineRoute> route_;
+};
+
+struct HashReply {
+  std::vector<uint8_t> digest;
+  std::thread::id thread;
+};
+
+// Hashes |path| on the shared hasher and delivers the digest on the
+// engine's platform thread.
+std::future<HashReply> HashOnEngine(FakeEngine* engine,
+                                   const std::string& path) {
+  auto reply = std::make_shared<std::promise<HashReply>>();
+  std::future<HashReply> future = reply->get_future();
+  engine->hub()->hasher()->HashFilesAsync(
+      {path}, HashAlgorithm::kSha256, nullptr,
+      [route = engine->route(), reply](std::vector<FileHashResult> results) {
+        std::vector<uint8_t> digest = results[0].digest;
+        route->Post([reply, digest]() {
+          reply->set_value({digest, std::this_thread::get_id()});
+        });
+      });
+  return future;
+}
+
+}  // namespace
+
+TEST(BackendHub, EnginesShareOneHubAndRouteTheirOwnResults) {
+  const fs::path scratch = ScratchDirectory();
+  fs::remove_all(scratch);
+  fs::create_directories(scratch);
+  std::vector<std::string> paths;
+  std::vector<std::vector<uint8_t>> digests;
+  for (size_t i = 0; i < kEngineCount; ++i) {
+    const std::string contents = "contents of engine " + std::to_string(i);
+    paths.push_back((scratch / ("engine" + std::to_string(i))).string());
+    std::ofstream(paths.back()) << contents;
+    digests.push_back(FileHasher::HashBuffer(
+        reinterpret_cast<const uint8_t*>(contents.data()), contents.size(),
+        HashAlgorithm::kSha256));
+  }
+
+  const size_t baseline_threads = ThreadCount();
+  std::vector<std::unique_ptr<FakeEngine>> engines;
+  engines.push_back(std::make_unique<FakeEngine>());
+  std::weak_ptr<BackendHub> first_hub;
+  {
+    std::shared_ptr<BackendHub> hub = BackendHub::Acquire();
+    first_hub = hub;
+    EXPECT_EQ(hub.get(), engines[0]->hub());
+  }
+  HashOnEngine(engines[0].get(), paths[0]).get();
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+  engines[0]->hub()->Prewarm("certificateChains");
+  engines[0]->hub()->Prewarm("certificateSigner");
+#endif
+  const size_t one_engine_bytes = ResidentBytes();
+
+  for (size_t i = 1; i < kEngineCount; ++i) {
+    engines.push_back(std::make_unique<FakeEngine>());
+    EXPECT_EQ(engines[i]->hub(), engines[0]->hub());
+  }
+  std::vector<std::future<HashReply>> replies;
+  for (size_t i = 0; i < kEngineCount; ++i) {
+    replies.push_back(HashOnEngine(engines[i].get(), paths[i]));
+  }
+  for (size_t i = 0; i < kEngineCount; ++i) {
+    HashReply reply = replies[i].get();
+    EXPECT_EQ(reply.thread, engines[i]->platform_thread()) << i;
+    EXPECT_EQ(reply.digest, digests[i]) << i;
+  }
+
+  // One platform thread per engine, and a single pool between them.
+  EXPECT_EQ(engines[0]->hub()->workers()->thread_count(), kWorkerThreads);
+  if (kCountsResources) {
+    EXPECT_EQ(ThreadCount(), baseline_threads + kEngineCount + kWorkerThreads);
+    // Fifteen more engines cost their platform threads and routes, not
+    // another set of backends.
+    const size_t sixteen_engine_bytes = ResidentBytes();
+    EXPECT_LT(sixteen_engine_bytes,
+              one_engine_bytes + kMaxBytesPerExtraEngine * (kEngineCount - 1));
+  }
+
+  // The hub, and its pool, outlive every engine but the last.
+  engines.erase(engines.begin());
+  EXPECT_FALSE(first_hub.expired());
+  engines.clear();
+  EXPECT_TRUE(first_hub.expired());
+  if (kCountsResources) EXPECT_EQ(ThreadCount(), baseline_threads);
+
+  // The next engine starts over with a fresh hub.
+  FakeEngine late;
+  EXPECT_TRUE(first_hub.expired());
+  EXPECT_EQ(late.hub()->timeline().events().size(), 0u);
+  fs::remove_all(scratch);
+}
+
+TEST(BackendHub, PrewarmsSharedBackendsByName) {
+  std::shared_ptr<BackendHub> hub = BackendHub::Acquire(TestOptions());
+  EXPECT_TRUE(hub->Prewarm("manifestVerifier"));
+  EXPECT_FALSE(hub->Prewarm("resourceSampler"));
+
+  // The verifier needed the hasher, which needed the pool; both finished
+  // first.
+  std::vector<StartupEvent> events = hub->timeline().events();
+  ASSERT_EQ(events.size(), 3u);
+  EXPECT_EQ(events[0].backend, "workers");
+  EXPECT_EQ(events[1].backend, "fileHasher");
+  EXPECT_EQ(events[2].backend, "manifestVerifier");
+  EXPECT_EQ(events[2].phase, StartupPhase::kPrewarm);
+
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+  EXPECT_TRUE(hub->Prewarm("certificateSigner"));
+  events = hub->timeline().events();
+  ASSERT_EQ(events.size(), 4u);
+  EXPECT_EQ(events[3].backend, "certificateSigner");
+  EXPECT_EQ(events[3].phase, StartupPhase::kPrewarm);
+#endif
+}
+
+TEST(BackendHub, OffersOnlyTheBackendsOfEnabledFeatures) {
+  const std::vector<std::string> backends = BackendHub::PrewarmableBackends();
+  auto offered = [&backends](const std::string& name) {
+    return std::find(backends.begin(), backends.end(), name) != backends.end();
+  };
+  EXPECT_TRUE(offered("workers"));
+  EXPECT_TRUE(offered("fileHasher"));
+  EXPECT_TRUE(offered("manifestVerifier"));
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+  const bool certificates = true;
+#else
+  const bool certificates = false;
+#endif
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+  const bool keys = true;
+#else
+  const bool keys = false;
+#endif
+  EXPECT_EQ(offered("certificateChains"), certificates);
+  EXPECT_EQ(offered("certificateSigner"), certificates);
+  EXPECT_EQ(offered("keyIndex"), keys);
+
+  // A backend left out of the build is unknown, like any other name.
+  std::shared_ptr<BackendHub> hub = BackendHub::Acquire(TestOptions());
+  if (!certificates) EXPECT_FALSE(hub->Prewarm("certificateSigner"));
+  if (!keys) EXPECT_FALSE(hub->Prewarm("keyIndex"));
+}
+
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+TEST(BackendHub, SharesKeyValueStoresByDirectory) {
+  const fs::path scratch = ScratchDirectory();
+  fs::remove_all(scratch);
+  BackendHubOptions options = TestOptions();
+  options.key_directory = (scratch / "keys").string();
+  std::shared_ptr<BackendHub> hub = BackendHub::Acquire(options);
+  const std::string directory = (scratch / "store").string();
+  const std::vector<uint8_t> value = {1, 2, 3};
+
+  const int64_t first = hub->OpenKvStore(directory, "kv");
+  // The same directory, spelled differently.
+  const int64_t second =
+      hub->OpenKvStore((scratch / "keys" / ".." / "store").string(), "kv");
+  EXPECT_NE(first, second);
+  ASSERT_NE(hub->kv_store(first), nullptr);
+  EXPECT_EQ(hub->kv_store(first), hub->kv_store(second));
+  EXPECT_THROW(hub->OpenKvStore(directory, "other"), std::invalid_argument);
+  hub->kv_store(first)->Put("k", value);
+
+  // Open until its last handle closes.
+  EXPECT_TRUE(hub->CloseKvStore(first));
+  EXPECT_FALSE(hub->CloseKvStore(first));
+  EXPECT_EQ(hub->kv_store(first), nullptr);
+  EXPECT_EQ(hub->kv_store(second)->Get("k"), value);
+  EXPECT_TRUE(hub->CloseKvStore(second));
+
+  const int64_t third = hub->OpenKvStore(directory, "kv");
+  EXPECT_EQ(hub->kv_store(third)->Get("k"), value);
+  hub.reset();
+  fs::remove_all(scratch);
+}
+#endif
+
+TEST(EngineRoute, DropsResultsOnceClosed) {
+  std::vector<std::function<void()>> queued;
+  auto route = EngineRoute::Create([&queued](std::function<void()> task) {
+    queued.push_back(std::move(task));
+  });
+  int delivered = 0;
+  EXPECT_TRUE(route->Post([&delivered]() { ++delivered; }));
+  EXPECT_TRUE(route->Post([&delivered]() { ++delivered; }));
+  queued[0]();
+  EXPECT_EQ(delivered, 1);
+
+  // Handed over before Close, run after it.
+  route->Close();
+  EXPECT_TRUE(route->closed());
+  queued[1]();
+  EXPECT_EQ(delivered, 1);
+
+  EXPECT_FALSE(route->Post([&delivered]() { ++delivered; }));
+  EXPECT_EQ(queued.size(), 2u);
+  route->Close();
+}
+
+TEST(EngineRoute, CloseWaitsForHolds) {
+  auto route = EngineRoute::Create([](std::function<void()> task) { task(); });
+  std::promise<void> entered;
+  std::atomic<bool> released{false};
+  std::thread worker([&]() {
+    EngineRoute::Hold hold = route->Enter();
+    ASSERT_TRUE(hold);
+    entered.set_value();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    released = true;
+  });
+  entered.get_future().wait();
+  route->Close();
+  EXPECT_TRUE(released.load());
+  worker.join();
+
+  EXPECT_FALSE(route->Enter());
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffered_random.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+std::string ToHex(const uint8_t* data, size_t len) {
+  static const char kDigits[] = "0123456789abcdef";
+  std::string hex;
+  for (size_t i = 0; i < len; ++i) {
+    hex.push_back(kDigits[data[i] >> 4]);
+    hex.push_back(kDigits[data[i] & 0xf]);
+  }
+  return hex;
+}
+
+std::vector<uint8_t> RandomBytes(size_t len) {
+  std::vector<uint8_t> bytes(len);
+  FillRandomBuffered(bytes.data(), bytes.size());
+  return bytes;
+}
+
+}  // namespace
+
+// RFC 8439 section 2.3.2; its 32-bit counter and 96-bit nonce map onto the
+// 64/64-bit layout as below.
+TEST(ChaCha20, MatchesRfc8439Block) {
+  uint8_t key[kChaCha20KeyLen];
+  for (size_t i = 0; i < sizeof(key); ++i) key[i] = static_cast<uint8_t>(i);
+  uint8_t block[64];
+  ChaCha20Keystream(key, 0x0900000000000001ull, 0x4a000000, block,
+                    sizeof(block));
+  EXPECT_EQ(ToHex(block, sizeof(block)),
+            "10f1e7e4d13b5915500fdd1fa32071c4c7d1f4c733c068030422aa9ac3d46c4e"
+            "d2826446079faa0914c2d705d98b02a2b5129cd1de164eb9cbd083e8a2503c4e");
+}
+
+TEST(ChaCha20, KeystreamIsContinuousAcrossCalls) {
+  uint8_t key[kChaCha20KeyLen] = {7};
+  std::vector<uint8_t> whole(5000);
+  ChaCha20Keystream(key, 0, 3, whole.data(), whole.size());
+  for (size_t blocks : {1, 8, 9, 40}) {
+    std::vector<uint8_t> rest(whole.size() - blocks * 64);
+    ChaCha20Keystream(key, blocks, 3, rest.data(), rest.size());
+    EXPECT_TRUE(std::equal(rest.begin(), rest.end(),
+                           whole.begin() + blocks * 64))
+        << "blocks=" << blocks;
+  }
+}
+
+TEST(BufferedRandom, OutputsDoNotRepeat) {
+  // Small requests come from the buffer, large ones are generated directly.
+  for (size_t len : {16, 1000, 1024, 100000}) {
+    std::vector<uint8_t> a = RandomBytes(len);
+    std::vector<uint8_t> b = RandomBytes(len);
+    EXPECT_NE(a, b) << "len=" << len;
+    EXPECT_NE(a, std::vector<uint8_t>(len, 0)) << "len=" << len;
+  }
+
+  // Every byte value turns up in a megabyte of output.
+  std::vector<uint8_t> bulk = RandomBytes(1 << 20);
+  std::vector<size_t> counts(256);
+  for (uint8_t byte : bulk) counts[byte]++;
+  for (size_t value = 0; value < counts.size(); ++value) {
+    EXPECT_GT(counts[value], 3000u) << "value=" << value;
+  }
+}
+
+TEST(BufferedRandom, ThreadsHaveIndependentStreams) {
+  std::vector<uint8_t> main_bytes = RandomBytes(64);
+  std::vector<uint8_t> thread_bytes;
+  std::thread([&thread_bytes] { thread_bytes = RandomBytes(64); }).join();
+  EXPECT_NE(main_bytes, thread_bytes);
+}
+
+TEST(BufferedRandom, ForkedChildReseeds) {
+  RandomBytes(16);  // Make sure the generator is seeded before forking.
+
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    std::vector<uint8_t> child = RandomBytes(32);
+    ssize_t written = write(fds[1], child.data(), child.size());
+    _exit(written == 32 ? 0 : 1);
+  }
+  close(fds[1]);
+  std::vector<uint8_t> parent = RandomBytes(32);
+  std::vector<uint8_t> child(32);
+  ASSERT_EQ(read(fds[0], child.data(), child.size()), 32);
+  close(fds[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  EXPECT_NE(parent, child);
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
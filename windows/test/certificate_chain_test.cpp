@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <openssl/x509.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "certificate_chain.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+const std::string kFixturesDir = FLUTTER_NATIVE_UTILS_FIXTURES_DIR;
+constexpr char kClientThumbprint[] = "d9c75c3f5faa9b01e310e9f8337dbf9046037ae2";
+constexpr char kExpiredThumbprint[] = "E46AC4C9ADE27B4CEC63CBD7D2DFC31D4513D746";
+
+constexpr int64_t kJan2025 = 1735689600000;
+constexpr int64_t kJan2034 = 2019686400000;  // The client leaf's expiry.
+constexpr int64_t kMinute = 60 * 1000;
+
+// Builder over the fixtures, with a clock the test controls.
+std::unique_ptr<CertificateChainBuilder> MakeBuilder(int64_t* now) {
+  return std::make_unique<CertificateChainBuilder>(
+      kFixturesDir + "/certificates", kFixturesDir + "/certificate_authorities",
+      [now]() { return *now; });
+}
+
+std::string CommonName(const std::vector<uint8_t>& der) {
+  const uint8_t* p = der.data();
+  X509* cert = d2i_X509(nullptr, &p, static_cast<long>(der.size()));
+  if (!cert) return std::string();
+  char name[256];
+  X509_NAME_get_text_by_NID(X509_get_subject_name(cert), NID_commonName, name,
+                            sizeof(name));
+  X509_free(cert);
+  return name;
+}
+
+}  // namespace
+
+TEST(CertificateChainBuilder, BuildsTrustedChainLeafFirst) {
+  int64_t now = kJan2025;
+  auto builder = MakeBuilder(&now);
+  auto chain = builder->Build(kClientThumbprint, false);
+  ASSERT_NE(chain, nullptr);
+  EXPECT_TRUE(chain->trusted);
+  EXPECT_EQ(chain->status, "");
+  ASSERT_EQ(chain->certificates.size(), 3u);
+  EXPECT_EQ(CommonName(chain->certificates[0]), "Alice Client");
+  EXPECT_EQ(CommonName(chain->certificates[1]), "Example Issuing CA");
+  EXPECT_EQ(CommonName(chain->certificates[2]), "Example Root CA");
+}
+
+TEST(CertificateChainBuilder, ReportsWhyAChainIsNotTrusted) {
+  int64_t now = kJan2025;
+  auto builder = MakeBuilder(&now);
+  auto expired = builder->Build(kExpiredThumbprint, false);
+  ASSERT_NE(expired, nullptr);
+  EXPECT_FALSE(expired->trusted);
+  EXPECT_NE(expired->status.find("expired"), std::string::npos);
+  EXPECT_EQ(CommonName(expired->certificates[0]), "Bob Client");
+
+  // The fixtures have no CRLs, so revocation status cannot be established.
+  auto checked = builder->Build(kClientThumbprint, true);
+  ASSERT_NE(checked, nullptr);
+  EXPECT_FALSE(checked->trusted);
+  EXPECT_NE(checked->status.find("CRL"), std::string::npos);
+
+  EXPECT_EQ(builder->Build("0000000000000000000000000000000000000000", false),
+            nullptr);
+  EXPECT_EQ(builder->Build("not a thumbprint", false), nullptr);
+}
+
+TEST(CertificateChainBuilder, CachesPerLeafAndRevocationMode) {
+  int64_t now = kJan2025;
+  auto builder = MakeBuilder(&now);
+  EXPECT_EQ(builder->Find(kClientThumbprint, false), nullptr);
+  auto first = builder->Build(kClientThumbprint, false);
+  EXPECT_EQ(builder->Build("D9C75C3F5FAA9B01E310E9F8337DBF9046037AE2", false),
+            first);
+  EXPECT_EQ(builder->Find(kClientThumbprint, false), first);
+  EXPECT_EQ(builder->Find(kClientThumbprint, true), nullptr);
+
+  CertificateChainCacheStats stats = builder->stats();
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.hits, 2u);
+  EXPECT_EQ(stats.entries, 1u);
+
+  builder->Clear();
+  EXPECT_EQ(builder->Find(kClientThumbprint, false), nullptr);
+}
+
+TEST(CertificateChainBuilder, RebuildsAfterTtl) {
+  int64_t now = kJan2025;
+  auto builder = MakeBuilder(&now);
+  auto first = builder->Build(kClientThumbprint, false);
+  EXPECT_EQ(first->expires_at, now + CertificateChainBuilder::kTrustedTtlMs);
+
+  now = first->expires_at - 1;
+  EXPECT_EQ(builder->Find(kClientThumbprint, false), first);
+  now = first->expires_at;
+  EXPECT_EQ(builder->Find(kClientThumbprint, false), nullptr);
+  auto second = builder->Build(kClientThumbprint, false);
+  EXPECT_NE(second, first);
+  EXPECT_TRUE(second->trusted);
+}
+
+TEST(CertificateChainBuilder, InvalidatesWhenACertificateExpires) {
+  int64_t now = kJan2034 - 10 * kMinute;
+  auto builder = MakeBuilder(&now);
+  auto before = builder->Build(kClientThumbprint, false);
+  ASSERT_NE(before, nullptr);
+  EXPECT_TRUE(before->trusted);
+  // Capped by the leaf's expiry rather than the full TTL.
+  EXPECT_EQ(before->expires_at, kJan2034);
+
+  now = kJan2034 + kMinute;
+  EXPECT_EQ(builder->Find(kClientThumbprint, false), nullptr);
+  auto after = builder->Build(kClientThumbprint, false);
+  EXPECT_FALSE(after->trusted);
+  EXPECT_EQ(after->expires_at, now + CertificateChainBuilder::kShortTtlMs);
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "certificate_index.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+const std::string kFixturesDir =
+    std::string(FLUTTER_NATIVE_UTILS_FIXTURES_DIR) + "/certificates";
+
+// 2025-01-01T00:00:00Z, when every fixture except expired.crt is valid.
+constexpr int64_t kJan2025 = 1735689600000;
+
+CertificateIndex FixtureIndex() {
+  return CertificateIndex(ReadPemDirectory(kFixturesDir));
+}
+
+std::vector<std::string> Subjects(const CertificatePage& page) {
+  std::vector<std::string> subjects;
+  for (const CertificateInfo& info : page.certificates) {
+    subjects.push_back(info.subject);
+  }
+  return subjects;
+}
+
+}  // namespace
+
+TEST(CertificateIndex, ProjectsPemDirectoryInFileOrder) {
+  std::vector<CertificateInfo> certificates = ReadPemDirectory(kFixturesDir);
+  ASSERT_EQ(certificates.size(), 5u);
+  EXPECT_EQ(certificates[0].subject,
+            "CN=Example Issuing CA, O=Example Corp, C=US");
+  EXPECT_EQ(certificates[1].subject, "CN=Example Root CA, O=Example Corp, C=US");
+
+  const CertificateInfo& client = certificates[2];
+  EXPECT_EQ(client.subject, "CN=Alice Client, O=Example Corp, C=US");
+  EXPECT_EQ(client.issuer, "CN=Example Issuing CA, O=Example Corp, C=US");
+  EXPECT_EQ(client.thumbprint, "D9C75C3F5FAA9B01E310E9F8337DBF9046037AE2");
+  EXPECT_EQ(client.serial_number, "1002");
+  EXPECT_EQ(client.not_before, 1704067200000);  // 2024-01-01
+  EXPECT_EQ(client.not_after, 2019686400000);   // 2034-01-01
+  EXPECT_EQ(client.ekus, std::vector<std::string>{"1.3.6.1.5.5.7.3.2"});
+  EXPECT_TRUE(client.has_private_key);
+
+  EXPECT_EQ(certificates[3].subject, "CN=Bob Client, O=Legacy Ltd");
+  EXPECT_EQ(certificates[3].ekus.size(), 2u);
+  EXPECT_FALSE(certificates[3].has_private_key);
+  EXPECT_TRUE(certificates[0].ekus.empty());
+}
+
+TEST(CertificateIndex, MissingDirectoryIsEmpty) {
+  EXPECT_TRUE(ReadPemDirectory(kFixturesDir + "/missing").empty());
+}
+
+TEST(CertificateIndex, FiltersBySubjectAndIssuerIgnoringCase) {
+  CertificateIndex index = FixtureIndex();
+  CertificateFilter filter;
+  filter.subject_contains = "CLIENT";
+  EXPECT_EQ(Subjects(index.Query(filter, 0, 10)),
+            (std::vector<std::string>{"CN=Alice Client, O=Example Corp, C=US",
+                                      "CN=Bob Client, O=Legacy Ltd"}));
+
+  filter.issuer_contains = "issuing ca";
+  EXPECT_EQ(index.Count(filter), 1u);
+}
+
+TEST(CertificateIndex, FiltersByEkuTreatingMissingExtensionAsAnyPurpose) {
+  CertificateIndex index = FixtureIndex();
+  CertificateFilter filter;
+  filter.eku = "serverAuth";
+  // The two CAs carry no EKU extension, plus the server certificate.
+  EXPECT_EQ(index.Count(filter), 3u);
+  filter.eku = "1.3.6.1.5.5.7.3.4";
+  filter.subject_contains = "client";
+  CertificatePage page = index.Query(filter, 0, 10);
+  ASSERT_EQ(page.certificates.size(), 1u);
+  EXPECT_EQ(page.certificates[0].subject, "CN=Bob Client, O=Legacy Ltd");
+}
+
+TEST(CertificateIndex, FiltersByValidityWindowAndPrivateKey) {
+  CertificateIndex index = FixtureIndex();
+  CertificateFilter filter;
+  filter.valid_from = kJan2025;
+  EXPECT_EQ(index.Count(filter), 4u);
+  // Through 2040-01-01: past the leaf certificates' expiry, not the CAs'.
+  filter.valid_to = 2208988800000;
+  EXPECT_EQ(index.Count(filter), 2u);
+
+  CertificateFilter with_key;
+  with_key.has_private_key = true;
+  with_key.valid_to = kJan2025;
+  EXPECT_EQ(Subjects(index.Query(with_key, 0, 10)),
+            std::vector<std::string>{"CN=Alice Client, O=Example Corp, C=US"});
+
+  CertificateFilter machine;
+  machine.location = CertificateStoreLocation::kLocalMachine;
+  EXPECT_EQ(index.Count(machine), 0u);
+}
+
+TEST(CertificateIndex, PagesResumeFromCursor) {
+  CertificateIndex index = FixtureIndex();
+  CertificateFilter filter;
+  filter.subject_contains = "example";
+
+  CertificatePage first = index.Query(filter, 0, 2);
+  EXPECT_EQ(first.certificates.size(), 2u);
+  EXPECT_FALSE(first.done);
+
+  CertificatePage second = index.Query(filter, first.next_cursor, 2);
+  ASSERT_EQ(second.certificates.size(), 2u);
+  EXPECT_EQ(second.certificates[1].subject,
+            "CN=www.example.com, O=Example Corp, C=US");
+  // No further matches, so the scan reports completion without an empty page.
+  EXPECT_TRUE(second.done);
+  EXPECT_EQ(second.next_cursor, index.size());
+
+  EXPECT_TRUE(index.Query(filter, index.size() + 1, 2).certificates.empty());
+}
+
+TEST(CertificateIndex, ParsesLocationNames) {
+  CertificateStoreLocation location;
+  EXPECT_TRUE(ParseCertificateStoreLocation("localMachine", &location));
+  EXPECT_EQ(location, CertificateStoreLocation::kLocalMachine);
+  EXPECT_STREQ(CertificateStoreLocationName(location), "localMachine");
+  EXPECT_FALSE(ParseCertificateStoreLocation("LocalMachine", &location));
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
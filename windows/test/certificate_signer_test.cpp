@@ -0,0 +1,265 @@
+#include <gtest/gtest.h>
+
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "certificate_signer.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+const std::string kFixturesDir = FLUTTER_NATIVE_UTILS_FIXTURES_DIR;
+constexpr char kClientThumbprint[] = "d9c75c3f5faa9b01e310e9f8337dbf9046037ae2";
+constexpr char kServerThumbprint[] = "EB76BB32370DE550F27E0C66BBD4AD3311BBF30A";
+constexpr char kExpiredThumbprint[] = "E46AC4C9ADE27B4CEC63CBD7D2DFC31D4513D746";
+
+std::vector<uint8_t> Bytes(const std::string& text) {
+  return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+std::string Thumbprint(X509* cert) {
+  uint8_t digest[EVP_MAX_MD_SIZE];
+  unsigned int len = 0;
+  X509_digest(cert, EVP_sha1(), digest, &len);
+  std::string hex;
+  for (unsigned int i = 0; i < len; ++i) {
+    char byte[3];
+    std::snprintf(byte, sizeof(byte), "%02X", digest[i]);
+    hex += byte;
+  }
+  return hex;
+}
+
+X509* ReadCertificate(const fs::path& path) {
+  FILE* in = std::fopen(path.string().c_str(), "r");
+  if (!in) return nullptr;
+  X509* cert = PEM_read_X509(in, nullptr, nullptr, nullptr);
+  std::fclose(in);
+  return cert;
+}
+
+// Verifies |signature| over |data| with the public key of |cert|.
+bool Verify(X509* cert, const EVP_MD* md, int rsa_padding,
+            const std::vector<uint8_t>& data,
+            const std::vector<uint8_t>& signature) {
+  EVP_PKEY* key = X509_get0_pubkey(cert);
+  EVP_MD_CTX* context = EVP_MD_CTX_new();
+  EVP_PKEY_CTX* key_context = nullptr;
+  bool ok = EVP_DigestVerifyInit(context, &key_context, md, nullptr, key) == 1;
+  if (ok && EVP_PKEY_get_base_id(key) == EVP_PKEY_RSA) {
+    ok = EVP_PKEY_CTX_set_rsa_padding(key_context, rsa_padding) == 1;
+    if (ok && rsa_padding == RSA_PKCS1_PSS_PADDING) {
+      ok = EVP_PKEY_CTX_set_rsa_pss_saltlen(key_context,
+                                            RSA_PSS_SALTLEN_DIGEST) == 1;
+    }
+  }
+  ok = ok && EVP_DigestVerify(context, signature.data(), signature.size(),
+                              data.data(), data.size()) == 1;
+  EVP_MD_CTX_free(context);
+  return ok;
+}
+
+// A scratch certificate directory with a self-signed RSA certificate and its
+// key, and a copy of the client certificate paired with the wrong key.
+class RsaSignerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    scratch_ = fs::temp_directory_path() /
+               ("fnu_signer_test_" +
+                std::string(::testing::UnitTest::GetInstance()
+                                ->current_test_info()
+                                ->name()));
+    fs::remove_all(scratch_);
+    fs::create_directories(scratch_);
+
+    EVP_PKEY* key = EVP_RSA_gen(2048);
+    cert_ = X509_new();
+    X509_set_version(cert_, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert_), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert_), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert_), 86400L);
+    X509_NAME_add_entry_by_txt(X509_get_subject_name(cert_), "CN",
+                               MBSTRING_ASC,
+                               reinterpret_cast<const unsigned char*>("RSA"),
+                               -1, -1, 0);
+    X509_set_issuer_name(cert_, X509_get_subject_name(cert_));
+    X509_set_pubkey(cert_, key);
+    X509_sign(cert_, key, EVP_sha256());
+
+    WritePem((scratch_ / "rsa.pem").string(), cert_, nullptr);
+    WritePem((scratch_ / "rsa.key").string(), nullptr, key);
+    fs::copy(kFixturesDir + "/certificates/client.pem",
+             scratch_ / "mismatch.pem");
+    WritePem((scratch_ / "mismatch.key").string(), nullptr, key);
+    EVP_PKEY_free(key);
+  }
+
+  void TearDown() override {
+    X509_free(cert_);
+    fs::remove_all(scratch_);
+  }
+
+  static void WritePem(const std::string& path, X509* cert, EVP_PKEY* key) {
+    FILE* out = std::fopen(path.c_str(), "w");
+    ASSERT_NE(out, nullptr) << path;
+    if (cert) PEM_write_X509(out, cert);
+    if (key) {
+      PEM_write_PrivateKey(out, key, nullptr, nullptr, 0, nullptr, nullptr);
+    }
+    std::fclose(out);
+  }
+
+  fs::path scratch_;
+  X509* cert_ = nullptr;
+};
+
+}  // namespace
+
+TEST(SignatureHash, ParsesNamesAndLengths) {
+  SignatureHash hash;
+  ASSERT_TRUE(ParseSignatureHash("sha384", &hash));
+  EXPECT_EQ(hash, SignatureHash::kSha384);
+  EXPECT_EQ(SignatureHashLength(hash), 48u);
+  EXPECT_FALSE(ParseSignatureHash("SHA256", &hash));
+  EXPECT_FALSE(ParseSignatureHash("sha1", &hash));
+
+  SignaturePadding padding;
+  ASSERT_TRUE(ParseSignaturePadding("pss", &padding));
+  EXPECT_EQ(padding, SignaturePadding::kPss);
+  EXPECT_FALSE(ParseSignaturePadding("oaep", &padding));
+
+  EXPECT_EQ(ComputeSignatureHash(SignatureHash::kSha512, nullptr, 0).size(),
+            64u);
+}
+
+TEST(EcdsaRawToDer, MatchesOpenSslEncoding) {
+  // P-256 with a high-bit r and an s with leading zero bytes, and P-521,
+  // whose DER body needs a long-form length.
+  for (size_t scalar_len : {32u, 66u}) {
+    std::vector<uint8_t> raw(scalar_len * 2);
+    for (size_t i = 0; i < raw.size(); ++i) {
+      raw[i] = static_cast<uint8_t>(0x80 + i * 7);
+    }
+    raw[scalar_len] = 0;
+    raw[scalar_len + 1] = 0;
+    raw[scalar_len + 2] = 0x01;
+
+    ECDSA_SIG* sig = ECDSA_SIG_new();
+    ECDSA_SIG_set0(sig,
+                   BN_bin2bn(raw.data(), static_cast<int>(scalar_len), nullptr),
+                   BN_bin2bn(raw.data() + scalar_len,
+                             static_cast<int>(scalar_len), nullptr));
+    unsigned char* expected = nullptr;
+    int expected_len = i2d_ECDSA_SIG(sig, &expected);
+    ECDSA_SIG_free(sig);
+
+    std::vector<uint8_t> der = EcdsaRawToDer(raw.data(), raw.size());
+    EXPECT_EQ(der, std::vector<uint8_t>(expected, expected + expected_len))
+        << scalar_len;
+    OPENSSL_free(expected);
+  }
+
+  const uint8_t raw[3] = {1, 2, 3};
+  EXPECT_THROW(EcdsaRawToDer(raw, 0), std::invalid_argument);
+  EXPECT_THROW(EcdsaRawToDer(raw, 3), std::invalid_argument);
+  std::vector<uint8_t> too_long(2 * 67, 1);
+  EXPECT_THROW(EcdsaRawToDer(too_long.data(), too_long.size()),
+               std::invalid_argument);
+}
+
+TEST(CertificateSigner, OpensAndCachesKeysByThumbprint) {
+  CertificateSigner signer(kFixturesDir + "/certificates");
+  auto key = signer.Key(kClientThumbprint);
+  ASSERT_NE(key, nullptr);
+  EXPECT_EQ(key->type(), CertificateKeyType::kEc);
+  EXPECT_EQ(signer.Key("D9C75C3F5FAA9B01E310E9F8337DBF9046037AE2"), key);
+  EXPECT_EQ(signer.size(), 1u);
+
+  // Certificates without a key file, and unknown thumbprints.
+  EXPECT_EQ(signer.Key(kServerThumbprint), nullptr);
+  EXPECT_EQ(signer.Key(kExpiredThumbprint), nullptr);
+  EXPECT_EQ(signer.Key("0000000000000000000000000000000000000000"), nullptr);
+  EXPECT_EQ(signer.Key("not a thumbprint"), nullptr);
+  EXPECT_EQ(signer.size(), 1u);
+
+  // A key handed out before Clear stays usable.
+  signer.Clear();
+  EXPECT_EQ(signer.size(), 0u);
+  EXPECT_FALSE(key->Sign(SignatureHash::kSha256, SignaturePadding::kPkcs1,
+                         nullptr, 0)
+                   .empty());
+  EXPECT_NE(signer.Key(kClientThumbprint), key);
+}
+
+TEST(CertificateSigner, EcSignaturesVerifyAgainstTheCertificate) {
+  CertificateSigner signer(kFixturesDir + "/certificates");
+  auto key = signer.Key(kClientThumbprint);
+  ASSERT_NE(key, nullptr);
+  X509* cert = ReadCertificate(kFixturesDir + "/certificates/client.pem");
+  ASSERT_NE(cert, nullptr);
+
+  const std::vector<uint8_t> handshake = Bytes("client hello ... certificate");
+  std::vector<uint8_t> signature = key->Sign(
+      SignatureHash::kSha256, SignaturePadding::kPkcs1, handshake.data(),
+      handshake.size());
+  EXPECT_EQ(signature[0], 0x30);  // DER, as TLS expects.
+  EXPECT_TRUE(Verify(cert, EVP_sha256(), 0, handshake, signature));
+
+  std::vector<uint8_t> digest = ComputeSignatureHash(
+      SignatureHash::kSha384, handshake.data(), handshake.size());
+  signature = key->SignDigest(SignatureHash::kSha384, SignaturePadding::kPkcs1,
+                              digest.data(), digest.size());
+  EXPECT_TRUE(Verify(cert, EVP_sha384(), 0, handshake, signature));
+  EXPECT_FALSE(Verify(cert, EVP_sha384(), 0, Bytes("other"), signature));
+
+  EXPECT_THROW(key->SignDigest(SignatureHash::kSha256, SignaturePadding::kPkcs1,
+                               digest.data(), digest.size()),
+               std::invalid_argument);
+  X509_free(cert);
+}
+
+TEST_F(RsaSignerTest, SignsWithPkcs1AndPss) {
+  CertificateSigner signer(scratch_.string());
+  auto key = signer.Key(Thumbprint(cert_));
+  ASSERT_NE(key, nullptr);
+  EXPECT_EQ(key->type(), CertificateKeyType::kRsa);
+
+  const std::vector<uint8_t> data = Bytes("certificate verify");
+  std::vector<uint8_t> pkcs1 = key->Sign(
+      SignatureHash::kSha256, SignaturePadding::kPkcs1, data.data(),
+      data.size());
+  EXPECT_EQ(pkcs1.size(), 256u);
+  EXPECT_TRUE(Verify(cert_, EVP_sha256(), RSA_PKCS1_PADDING, data, pkcs1));
+  EXPECT_EQ(key->Sign(SignatureHash::kSha256, SignaturePadding::kPkcs1,
+                      data.data(), data.size()),
+            pkcs1);
+
+  std::vector<uint8_t> pss = key->Sign(
+      SignatureHash::kSha512, SignaturePadding::kPss, data.data(), data.size());
+  EXPECT_TRUE(Verify(cert_, EVP_sha512(), RSA_PKCS1_PSS_PADDING, data, pss));
+  EXPECT_FALSE(Verify(cert_, EVP_sha512(), RSA_PKCS1_PADDING, data, pss));
+}
+
+TEST_F(RsaSignerTest, IgnoresAKeyThatDoesNotMatchItsCertificate) {
+  CertificateSigner signer(scratch_.string());
+  EXPECT_EQ(signer.Key(kClientThumbprint), nullptr);
+  EXPECT_NE(signer.Key(Thumbprint(cert_)), nullptr);
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
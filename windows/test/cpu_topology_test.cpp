@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "cpu_topology.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+TEST(CpuTopology, ParsesCpuLists) {
+  EXPECT_EQ(ParseCpuList("0-3,8,10-11"),
+            (std::vector<uint32_t>{0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(ParseCpuList("5"), (std::vector<uint32_t>{5}));
+  EXPECT_TRUE(ParseCpuList("").empty());
+}
+
+// The fixture models a hybrid part: one SMT P-core (cpu0-1) and two E-cores
+// (cpu2, cpu3) sharing an L2, split over two NUMA nodes.
+TEST(CpuTopology, ReadsHybridSysfsFixture) {
+  CpuTopology topology =
+      ReadSysfsCpuTopology(FLUTTER_NATIVE_UTILS_FIXTURES_DIR "/sys");
+
+  EXPECT_EQ(topology.packages, 1u);
+  EXPECT_EQ(topology.physical_cores, 3u);
+  EXPECT_EQ(topology.logical_processors, 4u);
+  EXPECT_EQ(topology.performance_cores, 1u);
+  EXPECT_EQ(topology.efficiency_cores, 2u);
+
+  auto p_core = std::find_if(
+      topology.cores.begin(), topology.cores.end(),
+      [](const CpuCore& core) { return core.type == CpuCoreType::kPerformance; });
+  ASSERT_NE(p_core, topology.cores.end());
+  EXPECT_EQ(p_core->logical_processors, (std::vector<uint32_t>{0, 1}));
+
+  auto find_cache = [&topology](uint32_t level, const std::string& type,
+                                uint64_t size) -> const CpuCache* {
+    for (const CpuCache& cache : topology.caches) {
+      if (cache.level == level && cache.type == type && cache.size_bytes == size) {
+        return &cache;
+      }
+    }
+    return nullptr;
+  };
+  const CpuCache* p_l1d = find_cache(1, "data", 48 * 1024);
+  ASSERT_NE(p_l1d, nullptr);
+  EXPECT_EQ(p_l1d->instances, 1u);
+  EXPECT_EQ(p_l1d->shared_by, 2u);
+  EXPECT_EQ(p_l1d->line_size, 64u);
+
+  const CpuCache* e_l1d = find_cache(1, "data", 32 * 1024);
+  ASSERT_NE(e_l1d, nullptr);
+  EXPECT_EQ(e_l1d->instances, 2u);
+
+  const CpuCache* e_l2 = find_cache(2, "unified", 2048 * 1024);
+  ASSERT_NE(e_l2, nullptr);
+  EXPECT_EQ(e_l2->instances, 1u);
+  EXPECT_EQ(e_l2->shared_by, 2u);
+
+  const CpuCache* l3 = find_cache(3, "unified", 12288 * 1024);
+  ASSERT_NE(l3, nullptr);
+  EXPECT_EQ(l3->instances, 1u);
+  EXPECT_EQ(l3->shared_by, 4u);
+
+  ASSERT_EQ(topology.numa_nodes.size(), 2u);
+  EXPECT_EQ(topology.numa_nodes[0].logical_processors,
+            (std::vector<uint32_t>{0, 1}));
+  EXPECT_EQ(topology.numa_nodes[1].node, 1u);
+  EXPECT_EQ(topology.numa_nodes[1].logical_processors,
+            (std::vector<uint32_t>{2, 3}));
+}
+
+TEST(CpuTopology, LiveTopologyIsCachedAndConsistent) {
+  const CpuTopology& first = GetCpuTopology();
+  const CpuTopology& second = GetCpuTopology();
+  EXPECT_EQ(&first, &second);
+  EXPECT_GE(first.logical_processors, first.physical_cores);
+  EXPECT_EQ(first.performance_cores + first.efficiency_cores,
+            first.physical_cores);
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "device_fingerprint.h"
+#include "worker_pool.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+const std::vector<uint8_t> kSalt(32, 0x42);
+
+// Appends an SMBIOS structure: header, |fields| after the handle, then
+// |strings| and the terminating NULs.
+void AppendStructure(std::vector<uint8_t>* table, uint8_t type,
+                     const std::vector<uint8_t>& fields,
+                     const std::vector<std::string>& strings) {
+  table->push_back(type);
+  table->push_back(static_cast<uint8_t>(4 + fields.size()));
+  table->push_back(0x00);
+  table->push_back(0x01);
+  table->insert(table->end(), fields.begin(), fields.end());
+  for (const std::string& text : strings) {
+    table->insert(table->end(), text.begin(), text.end());
+    table->push_back(0);
+  }
+  if (strings.empty()) table->push_back(0);
+  table->push_back(0);
+}
+
+std::vector<uint8_t> SmbiosTable() {
+  // System information: manufacturer, product, version and serial string
+  // indices, then the UUID.
+  std::vector<uint8_t> system = {1, 2, 0, 3};
+  for (uint8_t i = 0; i < 16; ++i) system.push_back(i);
+  std::vector<uint8_t> table;
+  AppendStructure(&table, 0, {1, 2, 0, 0}, {"BIOS Vendor", "1.0"});
+  AppendStructure(&table, 1, system, {"Vendor", "Model", "SN-0042"});
+  AppendStructure(&table, 2, {1, 0, 0, 2}, {"Board Vendor", "BRD-7"});
+  AppendStructure(&table, 127, {}, {});
+  // Past the end-of-table structure.
+  AppendStructure(&table, 2, {1, 0, 0, 1}, {"ignored"});
+  return table;
+}
+
+std::vector<DeviceIdentifier> Identifiers(
+    std::map<std::string, std::string> values) {
+  std::vector<DeviceIdentifier> identifiers;
+  for (const std::string& name : DeviceIdentifierNames()) {
+    identifiers.push_back(DeviceIdentifier{name, values[name]});
+  }
+  return identifiers;
+}
+
+}  // namespace
+
+TEST(DeviceFingerprint, NormalizesIdentifiersAndDropsPlaceholders) {
+  EXPECT_EQ(NormalizeDeviceIdentifier("  abc\t 123 \n"), "ABC 123");
+  EXPECT_EQ(NormalizeDeviceIdentifier("4c4c4544-0042-3510"),
+            "4C4C4544-0042-3510");
+  EXPECT_EQ(NormalizeDeviceIdentifier("To be filled by O.E.M."), "");
+  EXPECT_EQ(NormalizeDeviceIdentifier("  Default string "), "");
+  EXPECT_EQ(NormalizeDeviceIdentifier("System Serial Number"), "");
+  EXPECT_EQ(NormalizeDeviceIdentifier("N/A"), "");
+  EXPECT_EQ(NormalizeDeviceIdentifier("00000000-0000-0000-0000-000000000000"),
+            "");
+  EXPECT_EQ(NormalizeDeviceIdentifier("ffffffff-ffff-ffff-ffff-ffffffffffff"),
+            "");
+  EXPECT_EQ(NormalizeDeviceIdentifier("XXXXXXXX"), "");
+  EXPECT_EQ(NormalizeDeviceIdentifier(""), "");
+}
+
+TEST(DeviceFingerprint, JoinsOnlyGloballyAdministeredMacs) {
+  EXPECT_EQ(JoinPhysicalMacAddresses({"a4:c3:f0:11:22:33", "00-1A-2B-3C-4D-5E",
+                                      "00:00:00:00:00:00", "02:42:ac:11:00:02",
+                                      "A4:C3:F0:11:22:33", "bogus", ""}),
+            "00:1A:2B:3C:4D:5E,A4:C3:F0:11:22:33");
+  EXPECT_EQ(JoinPhysicalMacAddresses({}), "");
+}
+
+TEST(DeviceFingerprint, ParsesSmbiosSystemAndBoardStructures) {
+  std::vector<uint8_t> table = SmbiosTable();
+  SmbiosIdentifiers identifiers =
+      ParseSmbiosTable(table.data(), table.size(), 3, 4);
+  EXPECT_EQ(identifiers.system_serial, "SN-0042");
+  EXPECT_EQ(identifiers.board_serial, "BRD-7");
+  // The first three fields are little-endian since SMBIOS 2.6.
+  EXPECT_EQ(identifiers.system_uuid, "03020100-0504-0706-0809-0A0B0C0D0E0F");
+
+  identifiers = ParseSmbiosTable(table.data(), table.size(), 2, 4);
+  EXPECT_EQ(identifiers.system_uuid, "00010203-0405-0607-0809-0A0B0C0D0E0F");
+
+  // A truncated table yields what was complete.
+  identifiers = ParseSmbiosTable(table.data(), 40, 3, 4);
+  EXPECT_EQ(identifiers.system_serial, "");
+  EXPECT_EQ(ParseSmbiosTable(table.data(), 0, 3, 4).board_serial, "");
+}
+
+TEST(DeviceFingerprint, ReadsFixtureIdentifiersInParallel) {
+  WorkerPool pool(4);
+  std::vector<DeviceIdentifier> identifiers = ReadDeviceIdentifiers(
+      std::make_shared<SysfsDeviceIdentifierSource>(
+          FLUTTER_NATIVE_UTILS_FIXTURES_DIR),
+      DeviceIdentifierNames(), &pool);
+
+  std::map<std::string, std::string> values;
+  for (const DeviceIdentifier& identifier : identifiers) {
+    values[identifier.name] = identifier.value;
+  }
+  ASSERT_EQ(identifiers.size(), DeviceIdentifierNames().size());
+  EXPECT_EQ(identifiers[0].name, "systemUuid");
+  EXPECT_EQ(values["systemUuid"], "4C4C4544-0042-3510-8052-B4C04F4E3432");
+  EXPECT_EQ(values["systemSerial"], "5R2N4B2");
+  // The fixture board serial is an OEM placeholder.
+  EXPECT_EQ(values["boardSerial"], "");
+  EXPECT_EQ(values["processorId"], "GENUINEINTEL INTEL(R) CORE(TM) I7-1260P");
+  EXPECT_EQ(values["machineId"], "0F6D2B1E6A3C4F0B9D8E7C6B5A493827");
+  EXPECT_EQ(values["diskSerial"], "S4EWNX0R123456");
+  // lo has no device behind it.
+  EXPECT_EQ(values["macAddresses"], "00:1A:2B:3C:4D:5E,A4:C3:F0:11:22:33");
+
+  EXPECT_THROW(
+      ReadDeviceIdentifiers(std::make_shared<SysfsDeviceIdentifierSource>(),
+                            {"systemUuid", "hostname"}, &pool),
+      std::invalid_argument);
+  EXPECT_TRUE(ReadDeviceIdentifiers(
+                  std::make_shared<SysfsDeviceIdentifierSource>(), {}, &pool)
+                  .empty());
+}
+
+TEST(DeviceFingerprint, MatchesWithToleranceForChangedComponents) {
+  std::map<std::string, std::string> values = {
+      {"systemUuid", "UUID-1"},     {"systemSerial", "SERIAL-1"},
+      {"processorId", "CPU-1"},     {"machineId", "MACHINE-1"},
+      {"diskSerial", "DISK-1"},     {"macAddresses", "00:1A:2B:3C:4D:5E"},
+  };
+  DeviceFingerprint enrolled =
+      ComputeDeviceFingerprint(Identifiers(values), kSalt.data(), kSalt.size());
+  ASSERT_EQ(enrolled.components.size(), DeviceIdentifierNames().size());
+  // boardSerial is missing.
+  EXPECT_FALSE(enrolled.components[2].hash.has_value());
+
+  std::map<std::string, std::vector<uint8_t>> reference;
+  for (const DeviceFingerprintComponent& component : enrolled.components) {
+    if (component.hash) {
+      reference[component.name].assign(component.hash->begin(),
+                                       component.hash->end());
+    }
+  }
+
+  DeviceFingerprint again =
+      ComputeDeviceFingerprint(Identifiers(values), kSalt.data(), kSalt.size());
+  EXPECT_EQ(again.digest, enrolled.digest);
+  EXPECT_EQ(CountMatchingComponents(again, reference), 6u);
+
+  // A replaced disk changes the digest but leaves five of six components.
+  values["diskSerial"] = "DISK-2";
+  DeviceFingerprint changed =
+      ComputeDeviceFingerprint(Identifiers(values), kSalt.data(), kSalt.size());
+  EXPECT_NE(changed.digest, enrolled.digest);
+  EXPECT_EQ(CountMatchingComponents(changed, reference), 5u);
+
+  // Another salt links nothing.
+  const std::vector<uint8_t> other_salt(16, 0x17);
+  DeviceFingerprint other = ComputeDeviceFingerprint(
+      Identifiers(values), other_salt.data(), other_salt.size());
+  EXPECT_EQ(CountMatchingComponents(other, reference), 0u);
+
+  EXPECT_THROW(ComputeDeviceFingerprint(Identifiers(values), kSalt.data(), 15),
+               std::invalid_argument);
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
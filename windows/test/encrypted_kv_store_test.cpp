@@ -0,0 +1,329 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "encrypted_kv_store.h"
+#include "key_store.h"
+#include "worker_pool.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+std::vector<uint8_t> Bytes(const std::string& text) {
+  return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+// A store directory and a key store to protect it with, both removed
+// afterwards.
+class KvStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    root_ = fs::temp_directory_path() /
+            ("fnu_kv_store_test_" +
+             std::string(::testing::UnitTest::GetInstance()
+                             ->current_test_info()
+                             ->name()));
+    fs::remove_all(root_);
+    keys_ = std::make_unique<KeyIndex>(
+        std::make_unique<FileKeyStore>((root_ / "keys").string()));
+  }
+
+  void TearDown() override { fs::remove_all(root_); }
+
+  std::string Directory(const std::string& name = "store") const {
+    return (root_ / name).string();
+  }
+
+  std::shared_ptr<EncryptedKvStore> Open(
+      const KvStoreOptions& options = KvStoreOptions(),
+      WorkerPool* pool = nullptr, const std::string& name = "store") {
+    return EncryptedKvStore::Open(Directory(name), "kv", keys_.get(), pool,
+                                  options);
+  }
+
+  // The store's files as a crash would leave them while it is open.
+  std::string CopyAsCrashed(const std::string& name) {
+    fs::copy(root_ / "store", root_ / name, fs::copy_options::recursive);
+    return name;
+  }
+
+  fs::path root_;
+  std::unique_ptr<KeyIndex> keys_;
+};
+
+// Whether the file at |path| holds |text| anywhere.
+bool FileContains(const fs::path& path, const std::string& text) {
+  std::ifstream in(path, std::ios::binary);
+  const std::string data((std::istreambuf_iterator<char>(in)),
+                         std::istreambuf_iterator<char>());
+  return data.find(text) != std::string::npos;
+}
+
+}  // namespace
+
+TEST_F(KvStoreTest, PutsGetsAndDeletesAcrossReopening) {
+  {
+    auto store = Open();
+    EXPECT_FALSE(store->Get("token").has_value());
+    store->Put("token", Bytes("secret-access-token"));
+    store->Put("empty", {});
+    store->Write({{"a", Bytes("1")}, {"b", Bytes("2")}, {"a", std::nullopt}});
+    store->Put("token", Bytes("refreshed-access-token"));
+    store->Delete("missing");
+
+    EXPECT_EQ(store->Get("token"), Bytes("refreshed-access-token"));
+    EXPECT_EQ(store->Get("empty"), std::vector<uint8_t>());
+    EXPECT_FALSE(store->Get("a").has_value());
+    EXPECT_EQ(store->Get("b"), Bytes("2"));
+    EXPECT_EQ(store->stats().keys, 3u);
+  }
+  // Nothing readable at rest.
+  for (const auto& entry : fs::directory_iterator(Directory())) {
+    EXPECT_FALSE(FileContains(entry.path(), "access-token")) << entry.path();
+    EXPECT_FALSE(FileContains(entry.path(), "token")) << entry.path();
+  }
+
+  auto store = Open();
+  EXPECT_EQ(store->Get("token"), Bytes("refreshed-access-token"));
+  EXPECT_EQ(store->Get("empty"), std::vector<uint8_t>());
+  EXPECT_FALSE(store->Get("a").has_value());
+  EXPECT_EQ(store->stats().keys, 3u);
+  store->Put("c", Bytes("3"));
+  EXPECT_EQ(store->Get("c"), Bytes("3"));
+}
+
+TEST_F(KvStoreTest, OpensOnlyWithItsKey) {
+  {
+    auto store = Open();
+    store->Put("k", Bytes("v"));
+    // Not twice at once, however the directory is spelled.
+    EXPECT_THROW(EncryptedKvStore::Open(Directory() + "/.", "kv", keys_.get(),
+                                        nullptr),
+                 std::runtime_error);
+  }
+  EXPECT_THROW(EncryptedKvStore::Open(Directory(), "other", keys_.get(),
+                                      nullptr),
+               std::runtime_error);
+  // A new key under the same name cannot unwrap it.
+  keys_->Delete("kv");
+  keys_->CreateOrOpen("kv");
+  EXPECT_THROW(Open(), std::runtime_error);
+
+  EXPECT_THROW(EncryptedKvStore::Open(Directory("x"), "", keys_.get(),
+                                      nullptr),
+               std::invalid_argument);
+  KvStoreOptions options;
+  options.segment_bytes = 10;
+  EXPECT_THROW(Open(options, nullptr, "y"), std::invalid_argument);
+
+  auto store = Open(KvStoreOptions(), nullptr, "z");
+  EXPECT_THROW(store->Put("", Bytes("v")), std::invalid_argument);
+  EXPECT_THROW(store->Put(std::string(EncryptedKvStore::kMaxKeyLen + 1, 'k'),
+                          Bytes("v")),
+               std::invalid_argument);
+  EXPECT_THROW(store->Scan("", "", 0), std::invalid_argument);
+}
+
+TEST_F(KvStoreTest, ScansPrefixesInKeyOrderByPage) {
+  auto store = Open();
+  std::vector<KvWrite> batch;
+  for (int i = 0; i < 25; ++i) {
+    const std::string id = std::to_string(100 + i);
+    batch.push_back({"cache/" + id, Bytes(id)});
+    batch.push_back({"token/" + id, Bytes(id)});
+  }
+  store->Write(std::move(batch));
+  store->Delete("cache/101");
+
+  std::vector<std::string> keys;
+  std::string after;
+  for (bool done = false; !done;) {
+    KvScanPage page = store->Scan("cache/", after, 10);
+    for (const KvEntry& entry : page.entries) {
+      EXPECT_EQ(entry.value, Bytes(entry.key.substr(6)));
+      keys.push_back(entry.key);
+    }
+    after = page.last;
+    done = page.done;
+  }
+  ASSERT_EQ(keys.size(), 24u);
+  EXPECT_EQ(keys.front(), "cache/100");
+  EXPECT_EQ(keys[1], "cache/102");
+  EXPECT_EQ(keys.back(), "cache/124");
+  EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+
+  KvScanPage all = store->Scan("", "", 1000);
+  EXPECT_EQ(all.entries.size(), 49u);
+  EXPECT_TRUE(all.done);
+  EXPECT_TRUE(store->Scan("none/", "", 5).entries.empty());
+}
+
+TEST_F(KvStoreTest, RebuildsAfterACrashAndDropsATornBatch) {
+  auto store = Open();
+  store->Put("kept", Bytes("1"));
+  store->Write({{"x", Bytes("2")}, {"y", Bytes("3")}, {"kept", std::nullopt}});
+  store->Put("kept", Bytes("4"));
+  CopyAsCrashed("crashed");
+
+  // A batch cut short by the crash.
+  store->Write({{"torn1", Bytes("5")}, {"torn2", Bytes("6")}});
+  CopyAsCrashed("torn");
+  const fs::path segment = root_ / "torn" / "1.seg";
+  fs::resize_file(segment, fs::file_size(segment) - 3);
+
+  auto crashed = Open(KvStoreOptions(), nullptr, "crashed");
+  EXPECT_EQ(crashed->Get("kept"), Bytes("4"));
+  EXPECT_EQ(crashed->Get("y"), Bytes("3"));
+  EXPECT_EQ(crashed->stats().keys, 3u);
+
+  auto torn = Open(KvStoreOptions(), nullptr, "torn");
+  EXPECT_FALSE(torn->Get("torn1").has_value());
+  EXPECT_FALSE(torn->Get("torn2").has_value());
+  EXPECT_EQ(torn->Get("kept"), Bytes("4"));
+  // Appends go on from the last whole batch.
+  torn->Put("after", Bytes("7"));
+  torn.reset();
+  torn = Open(KvStoreOptions(), nullptr, "torn");
+  EXPECT_EQ(torn->Get("after"), Bytes("7"));
+  EXPECT_EQ(torn->stats().keys, 4u);
+}
+
+TEST_F(KvStoreTest, KeepsServingReadsWhenTheIndexCannotGrow) {
+  KvStoreOptions options;
+  options.sync = false;
+  auto store = Open(options);
+  auto keys = [](const std::string& prefix, int count) {
+    std::vector<KvWrite> batch;
+    for (int i = 0; i < count; ++i) {
+      batch.push_back({prefix + std::to_string(i), Bytes("v")});
+    }
+    return batch;
+  };
+  // Fits the smallest index.
+  store->Write(keys("key", 700));
+  // A directory where the larger index would be built.
+  fs::create_directories(root_ / "store" / "INDEX.tmp" / "blocked");
+  EXPECT_THROW(store->Write(keys("more", 100)), std::runtime_error);
+
+  // None of the failed batch, and all of the rest.
+  EXPECT_EQ(store->stats().keys, 700u);
+  EXPECT_EQ(store->Get("key699"), Bytes("v"));
+  EXPECT_FALSE(store->Get("more0").has_value());
+  EXPECT_EQ(store->Scan("", "", 1000).entries.size(), 700u);
+  EXPECT_THROW(store->Put("x", Bytes("y")), std::runtime_error);
+
+  store.reset();
+  fs::remove_all(root_ / "store" / "INDEX.tmp");
+  store = Open(options);
+  EXPECT_EQ(store->stats().keys, 700u);
+  store->Write(keys("more", 100));
+  EXPECT_EQ(store->stats().keys, 800u);
+  store.reset();
+  store = Open(options);
+  EXPECT_EQ(store->Get("more99"), Bytes("v"));
+  EXPECT_EQ(store->stats().keys, 800u);
+}
+
+TEST_F(KvStoreTest, CompactsGarbageWithoutLosingOrResurrectingKeys) {
+  KvStoreOptions options;
+  options.segment_bytes = 4096;
+  options.sync = false;
+  auto store = Open(options);
+  const std::vector<uint8_t> value(100, 0x42);
+  for (int round = 0; round < 20; ++round) {
+    for (int i = 0; i < 10; ++i) store->Put("key" + std::to_string(i), value);
+  }
+  store->Put("gone", value);
+  store->Delete("gone");
+  // Enough after the deletion to seal its segment too.
+  for (int i = 0; i < 30; ++i) store->Put("key0", value);
+  store->Put("last", Bytes("x"));
+
+  const KvStoreStats before = store->stats();
+  EXPECT_GT(before.segments, 5u);
+  ASSERT_TRUE(store->Compact());
+  const KvStoreStats after = store->stats();
+  EXPECT_EQ(after.compactions, 1u);
+  EXPECT_LT(after.segments, before.segments);
+  EXPECT_LT(after.disk_bytes, before.disk_bytes / 4);
+  EXPECT_EQ(after.keys, 11u);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(store->Get("key" + std::to_string(i)), value) << i;
+  }
+  EXPECT_FALSE(store->Get("gone").has_value());
+
+  // Rebuilt from the compacted segments, the deletion still holds.
+  CopyAsCrashed("crashed");
+  store.reset();
+  auto crashed = Open(options, nullptr, "crashed");
+  EXPECT_FALSE(crashed->Get("gone").has_value());
+  EXPECT_EQ(crashed->Get("key9"), value);
+  EXPECT_EQ(crashed->Get("last"), Bytes("x"));
+  EXPECT_EQ(crashed->stats().keys, 11u);
+}
+
+TEST_F(KvStoreTest, CompactsInTheBackgroundWhileWriting) {
+  WorkerPool pool(2);
+  KvStoreOptions options;
+  options.segment_bytes = 4096;
+  options.compaction_min_garbage = 8192;
+  options.sync = false;
+  auto store = Open(options, &pool);
+  const std::vector<uint8_t> value(200, 0x17);
+  for (int round = 0; round < 200; ++round) {
+    store->Put("key" + std::to_string(round % 5), value);
+  }
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (store->stats().compactions == 0 &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_GT(store->stats().compactions, 0u);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(store->Get("key" + std::to_string(i)), value) << i;
+  }
+}
+
+TEST_F(KvStoreTest, GroupsConcurrentWritesIntoCommits) {
+  constexpr int kThreads = 8;
+  constexpr int kWrites = 100;
+  auto store = Open();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&store, t]() {
+      for (int i = 0; i < kWrites; ++i) {
+        store->Put(std::to_string(t) + "/" + std::to_string(i),
+                   Bytes(std::to_string(i)));
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  const KvStoreStats stats = store->stats();
+  EXPECT_EQ(stats.keys, static_cast<size_t>(kThreads * kWrites));
+  EXPECT_EQ(stats.batches, static_cast<uint64_t>(kThreads * kWrites));
+  EXPECT_LE(stats.commits, stats.batches);
+  store.reset();
+  store = Open();
+  for (int t = 0; t < kThreads; ++t) {
+    EXPECT_EQ(store->Get(std::to_string(t) + "/99"), Bytes("99")) << t;
+  }
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "blake3.h"
+#include "file_hasher.h"
+#include "sha256.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+std::string ToHex(const uint8_t* data, size_t len) {
+  static const char kDigits[] = "0123456789abcdef";
+  std::string hex;
+  for (size_t i = 0; i < len; ++i) {
+    hex.push_back(kDigits[data[i] >> 4]);
+    hex.push_back(kDigits[data[i] & 0xf]);
+  }
+  return hex;
+}
+
+std::string ToHex(const std::vector<uint8_t>& data) {
+  return ToHex(data.data(), data.size());
+}
+
+// The input pattern used by the official BLAKE3 test vectors.
+std::vector<uint8_t> TestInput(size_t len) {
+  std::vector<uint8_t> input(len);
+  for (size_t i = 0; i < len; ++i) input[i] = static_cast<uint8_t>(i % 251);
+  return input;
+}
+
+std::string Blake3Hex(const std::vector<uint8_t>& input) {
+  uint8_t out[kBlake3OutLen];
+  Blake3Hash(input.data(), input.size(), out);
+  return ToHex(out, sizeof(out));
+}
+
+class TempFile {
+ public:
+  TempFile(const std::string& name, const std::vector<uint8_t>& contents)
+      : path_((std::filesystem::temp_directory_path() / name).string()) {
+    std::ofstream file(path_, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(contents.data()),
+               static_cast<std::streamsize>(contents.size()));
+  }
+  ~TempFile() { std::remove(path_.c_str()); }
+
+  const std::string& path() const { return path_; }
+
+ private:
+  std::string path_;
+};
+
+}  // namespace
+
+TEST(Blake3, MatchesOfficialTestVectors) {
+  EXPECT_EQ(Blake3Hex(TestInput(0)),
+            "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262");
+  EXPECT_EQ(Blake3Hex(TestInput(1)),
+            "2d3adedff11b61f14c886e35afa036736dcd87a74d27b5c1510225d0f592e213");
+  EXPECT_EQ(Blake3Hex(TestInput(1024)),
+            "42214739f095a406f3fc83deb889744ac00df831c10daa55189b5d121c855af7");
+  EXPECT_EQ(Blake3Hex(TestInput(1025)),
+            "d00278ae47eb27b34faecf67b4fe263f82d5412916c1ffd97c8cb7fb814b8444");
+  EXPECT_EQ(Blake3Hex(TestInput(2048)),
+            "e776b6028c7cd22a4d0ba182a8bf62205d2ef576467e838ed6f2529b85fba24a");
+  EXPECT_EQ(Blake3Hex(TestInput(102400)),
+            "bc3e3d41a1146b069abffad3c0d44860cf664390afce4d9661f7902e7943e085");
+}
+
+TEST(Blake3, CombinedSubtreesMatchSequentialHash) {
+  constexpr size_t kSubtreeLen = 4 * kBlake3ChunkLen;
+  for (size_t len : {kSubtreeLen + 1, 2 * kSubtreeLen, 3 * kSubtreeLen + 100,
+                     7 * kSubtreeLen + kSubtreeLen / 2}) {
+    std::vector<uint8_t> input = TestInput(len);
+    size_t subtree_count = (len - 1) / kSubtreeLen;
+    std::vector<Blake3ChainingValue> subtrees;
+    for (size_t s = 0; s < subtree_count; ++s) {
+      subtrees.push_back(Blake3SubtreeChainingValue(
+          input.data() + s * kSubtreeLen, kSubtreeLen, s * 4));
+    }
+    uint8_t out[kBlake3OutLen];
+    size_t tail = subtree_count * kSubtreeLen;
+    Blake3CombineSubtrees(subtrees, 4, input.data() + tail, len - tail, out);
+    EXPECT_EQ(ToHex(out, sizeof(out)), Blake3Hex(input)) << "len=" << len;
+  }
+}
+
+TEST(Sha256, MatchesKnownDigest) {
+  const std::string abc = "abc";
+  Sha256Digest digest = ComputeSha256(
+      reinterpret_cast<const uint8_t*>(abc.data()), abc.size());
+  EXPECT_EQ(ToHex(digest.data(), digest.size()),
+            "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+}
+
+TEST(FileHasher, HashesFilesInInputOrderWithErrors) {
+  std::vector<uint8_t> large = TestInput(3 * FileHasher::kBlake3SegmentLen + 7);
+  std::vector<uint8_t> small = TestInput(100);
+  TempFile large_file("fnu_hash_large.bin", large);
+  TempFile small_file("fnu_hash_small.bin", small);
+  TempFile empty_file("fnu_hash_empty.bin", {});
+
+  FileHasher hasher(4);
+  std::atomic<int> progress_calls{0};
+  auto results = hasher.HashFiles(
+      {large_file.path(), "/nonexistent/fnu_missing.bin", small_file.path(),
+       empty_file.path()},
+      HashAlgorithm::kBlake3,
+      [&progress_calls](const HashProgress& progress) {
+        EXPECT_LE(progress.bytes_done, progress.total_bytes);
+        progress_calls.fetch_add(1);
+      });
+
+  ASSERT_EQ(results.size(), 4u);
+  EXPECT_EQ(ToHex(results[0].digest), Blake3Hex(large));
+  EXPECT_EQ(results[0].size, large.size());
+  EXPECT_TRUE(results[1].digest.empty());
+  EXPECT_FALSE(results[1].error.empty());
+  EXPECT_EQ(ToHex(results[2].digest), Blake3Hex(small));
+  EXPECT_EQ(ToHex(results[3].digest), Blake3Hex({}));
+  EXPECT_GE(progress_calls.load(), 1);
+}
+
+TEST(FileHasher, Sha256MatchesBufferHash) {
+  std::vector<uint8_t> contents = TestInput(10 * 1024 * 1024 + 3);
+  TempFile file("fnu_hash_sha.bin", contents);
+
+  FileHasher hasher(2);
+  auto results = hasher.HashFiles({file.path()}, HashAlgorithm::kSha256);
+  ASSERT_EQ(results.size(), 1u);
+  EXPECT_EQ(results[0].digest,
+            FileHasher::HashBuffer(contents.data(), contents.size(),
+                                   HashAlgorithm::kSha256));
+}
+
+TEST(FileHasher, FileTruncatedWhileHashingFails) {
+  std::vector<uint8_t> contents = TestInput(20 * 1024 * 1024);
+  TempFile file("fnu_hash_truncated.bin", contents);
+
+  // The first progress report comes after the first 8 MiB piece; the file is
+  // cut short before the next one is read.
+  FileHasher hasher(1);
+  std::atomic<bool> truncated{false};
+  auto results = hasher.HashFiles(
+      {file.path()}, HashAlgorithm::kSha256,
+      [&file, &truncated](const HashProgress&) {
+        if (truncated.exchange(true)) return;
+        std::error_code error;
+        std::filesystem::resize_file(file.path(), 1024, error);
+      });
+
+  ASSERT_EQ(results.size(), 1u);
+  ASSERT_TRUE(truncated.load());
+#ifdef _WIN32
+  // The mapping keeps the file from being truncated.
+  EXPECT_EQ(results[0].digest,
+            FileHasher::HashBuffer(contents.data(), contents.size(),
+                                   HashAlgorithm::kSha256));
+#else
+  EXPECT_TRUE(results[0].digest.empty());
+  EXPECT_FALSE(results[0].error.empty());
+#endif
+}
+
+TEST(FileHasher, ParsesAlgorithmNames) {
+  HashAlgorithm algorithm;
+  EXPECT_TRUE(ParseHashAlgorithm("sha256", &algorithm));
+  EXPECT_EQ(algorithm, HashAlgorithm::kSha256);
+  EXPECT_TRUE(ParseHashAlgorithm("blake3", &algorithm));
+  EXPECT_EQ(algorithm, HashAlgorithm::kBlake3);
+  EXPECT_FALSE(ParseHashAlgorithm("md5", &algorithm));
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
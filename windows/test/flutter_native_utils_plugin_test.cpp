@@ -4,10 +4,17 @@
 #include <gtest/gtest.h>
 #include <windows.h>
 
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <variant>
+#include <vector>
 
+#include "allocation_stats.h"
 #include "flutter_native_utils_plugin.h"
 
 namespace flutter_native_utils {
@@ -20,24 +27,420 @@ using flutter::EncodableValue;
 using flutter::MethodCall;
 using flutter::MethodResultFunctions;
 
+// Stands in for the platform thread of a plugin created with a poster: the
+// test runs the results its features post.
+class PostedTasks {
+ public:
+  EngineRoute::Poster poster() {
+    return [this](std::function<void()> task) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(task));
+      posted_.notify_one();
+    };
+  }
+
+  // Runs posted tasks until |done| returns true.
+  void RunUntil(const std::function<bool()>& done) {
+    while (!done()) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        posted_.wait(lock, [this]() { return !tasks_.empty(); });
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable posted_;
+  std::deque<std::function<void()>> tasks_;
+};
+
 }  // namespace
 
-TEST(FlutterNativeUtilsPlugin, GetPlatformVersion) {
+TEST(FlutterNativeUtilsPlugin, GetRandomBytesReturnsTheLengthAsked) {
   FlutterNativeUtilsPlugin plugin;
-  // Save the reply value from the success callback.
-  std::string result_string;
+  std::vector<uint8_t> bytes;
+  std::string error_code;
+  auto get_random_bytes = [&](EncodableValue length) {
+    bytes.clear();
+    error_code.clear();
+    plugin.HandleMethodCall(
+        MethodCall("GetRandomBytes",
+                   std::make_unique<EncodableValue>(EncodableMap{
+                       {EncodableValue("length"), std::move(length)}})),
+        std::make_unique<MethodResultFunctions<>>(
+            [&bytes](const EncodableValue* result) {
+              bytes = std::get<std::vector<uint8_t>>(*result);
+            },
+            [&error_code](const std::string& code, const std::string&,
+                          const EncodableValue*) { error_code = code; },
+            nullptr));
+  };
+
+  get_random_bytes(EncodableValue(64));
+  ASSERT_TRUE(error_code.empty()) << error_code;
+  EXPECT_EQ(bytes.size(), 64u);
+  // 64 random bytes are all zero with negligible probability.
+  EXPECT_NE(bytes, std::vector<uint8_t>(64, 0));
+
+  get_random_bytes(EncodableValue(0));
+  EXPECT_TRUE(error_code.empty()) << error_code;
+  EXPECT_TRUE(bytes.empty());
+
+  get_random_bytes(EncodableValue(-1));
+  EXPECT_EQ(error_code, "BAD_ARGS");
+  get_random_bytes(EncodableValue("64"));
+  EXPECT_EQ(error_code, "BAD_ARGS");
+}
+
+TEST(FlutterNativeUtilsPlugin, CreatesNoBackendUntilUsed) {
+  FlutterNativeUtilsPlugin plugin;
+  size_t event_count = 1;
   plugin.HandleMethodCall(
-      MethodCall("getPlatformVersion", std::make_unique<EncodableValue>()),
+      MethodCall("GetStartupTimeline", std::make_unique<EncodableValue>()),
+      std::make_unique<MethodResultFunctions<>>(
+          [&event_count](const EncodableValue* result) {
+            event_count = std::get<flutter::EncodableList>(*result).size();
+          },
+          nullptr, nullptr));
+  EXPECT_EQ(event_count, 0u);
+}
+
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+TEST(FlutterNativeUtilsPlugin, InstancesShareBackends) {
+  FlutterNativeUtilsPlugin first;
+  FlutterNativeUtilsPlugin second;
+  // Cache lookups run inline, so this creates the chain builder even
+  // without a registrar.
+  first.HandleMethodCall(
+      MethodCall("GetCertificateChain",
+                 std::make_unique<EncodableValue>(EncodableMap{
+                     {EncodableValue("thumbprint"),
+                      EncodableValue(std::string(40, '0'))}})),
+      std::make_unique<MethodResultFunctions<>>(nullptr, nullptr, nullptr));
+
+  flutter::EncodableList events;
+  second.HandleMethodCall(
+      MethodCall("GetStartupTimeline", std::make_unique<EncodableValue>()),
       std::make_unique<MethodResultFunctions<>>(
-          [&result_string](const EncodableValue* result) {
-            result_string = std::get<std::string>(*result);
+          [&events](const EncodableValue* result) {
+            events = std::get<flutter::EncodableList>(*result);
           },
           nullptr, nullptr));
+  ASSERT_EQ(events.size(), 1u);
+  const auto& event = std::get<EncodableMap>(events[0]);
+  EXPECT_EQ(std::get<std::string>(event.at(EncodableValue("backend"))),
+            "certificateChains");
+}
+#endif
+
+// Only methods of features left out of this build are called; the others
+// would run.
+TEST(FlutterNativeUtilsPlugin, DisabledFeaturesAreNotImplemented) {
+  FlutterNativeUtilsPlugin plugin;
+  auto implemented = [&plugin](const std::string& method) {
+    bool not_implemented = false;
+    plugin.HandleMethodCall(
+        MethodCall(method, std::make_unique<EncodableValue>()),
+        std::make_unique<MethodResultFunctions<>>(
+            nullptr, nullptr,
+            [&not_implemented]() { not_implemented = true; }));
+    return !not_implemented;
+  };
+  EXPECT_FALSE(implemented("NoSuchMethod"));
+#ifndef FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE
+  EXPECT_FALSE(implemented("RequestHardwareInfo"));
+  EXPECT_FALSE(implemented("QueryInventory"));
+#endif
+#ifndef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+  EXPECT_FALSE(implemented("SignNonce"));
+  EXPECT_FALSE(implemented("Encrypt"));
+  EXPECT_FALSE(implemented("CreateHmacSession"));
+#endif
+#ifndef FLUTTER_NATIVE_UTILS_FEATURE_CERTIFICATES
+  EXPECT_FALSE(implemented("GetCertificate"));
+  EXPECT_FALSE(implemented("EnumerateCertificates"));
+#endif
+#ifndef FLUTTER_NATIVE_UTILS_FEATURE_RESTART
+  EXPECT_FALSE(implemented("RequestAppRestart"));
+#endif
+}
+
+TEST(FlutterNativeUtilsPlugin, PrewarmValidatesBackendNames) {
+  FlutterNativeUtilsPlugin plugin;
+  std::string error_code;
+  auto record_error = [&error_code](const std::string& code,
+                                    const std::string&, const EncodableValue*) {
+    error_code = code;
+  };
+
+  plugin.HandleMethodCall(
+      MethodCall("Prewarm",
+                 std::make_unique<EncodableValue>(EncodableMap{
+                     {EncodableValue("backends"),
+                      EncodableValue(flutter::EncodableList{
+                          EncodableValue("teleporter")})}})),
+      std::make_unique<MethodResultFunctions<>>(nullptr, record_error,
+                                                nullptr));
+  EXPECT_EQ(error_code, "BAD_ARGS");
+
+#ifndef FLUTTER_NATIVE_UTILS_FEATURE_HARDWARE
+  // The backends of a feature left out are unknown too.
+  error_code.clear();
+  plugin.HandleMethodCall(
+      MethodCall("Prewarm",
+                 std::make_unique<EncodableValue>(EncodableMap{
+                     {EncodableValue("backends"),
+                      EncodableValue(flutter::EncodableList{
+                          EncodableValue("wmi")})}})),
+      std::make_unique<MethodResultFunctions<>>(nullptr, record_error,
+                                                nullptr));
+  EXPECT_EQ(error_code, "BAD_ARGS");
+#endif
+
+  // Without a registrar there is no platform thread to report back on.
+  plugin.HandleMethodCall(
+      MethodCall("Prewarm", std::make_unique<EncodableValue>()),
+      std::make_unique<MethodResultFunctions<>>(nullptr, record_error,
+                                                nullptr));
+  EXPECT_EQ(error_code, "UNAVAILABLE");
+}
+
+TEST(FlutterNativeUtilsPlugin, GetAllocationStatsReportsPerMethodTotals) {
+  FlutterNativeUtilsPlugin plugin;
+  std::string error_code;
+  flutter::EncodableList methods;
+  auto get_stats = [&plugin, &error_code, &methods]() {
+    plugin.HandleMethodCall(
+        MethodCall("GetAllocationStats",
+                   std::make_unique<EncodableValue>(EncodableMap{
+                       {EncodableValue("reset"), EncodableValue(true)}})),
+        std::make_unique<MethodResultFunctions<>>(
+            [&methods](const EncodableValue* result) {
+              methods = std::get<flutter::EncodableList>(*result);
+            },
+            [&error_code](const std::string& code, const std::string&,
+                          const EncodableValue*) { error_code = code; },
+            nullptr));
+  };
+
+  if (!AllocationTrackingEnabled()) {
+    get_stats();
+    EXPECT_EQ(error_code, "UNAVAILABLE");
+    return;
+  }
+  get_stats();
+  plugin.HandleMethodCall(
+      MethodCall("GetStartupTimeline", std::make_unique<EncodableValue>()),
+      std::make_unique<MethodResultFunctions<>>(nullptr, nullptr, nullptr));
+  get_stats();
+  ASSERT_TRUE(error_code.empty());
+
+  const EncodableMap* timeline = nullptr;
+  for (const EncodableValue& entry : methods) {
+    const auto& stats = std::get<EncodableMap>(entry);
+    if (std::get<std::string>(stats.at(EncodableValue("method"))) ==
+        "GetStartupTimeline") {
+      timeline = &stats;
+    }
+  }
+  ASSERT_NE(timeline, nullptr);
+  EXPECT_EQ(std::get<int64_t>(timeline->at(EncodableValue("calls"))), 1);
+  EXPECT_GT(std::get<int64_t>(timeline->at(EncodableValue("allocations"))), 0);
+}
+
+// Heap allocations per call of the busiest methods, made by
+// HandleMethodCall with the arguments the Dart side sends. Each method has a
+// budget with some headroom over what it makes today, so a handler that
+// starts allocating more fails here. Work a handler posts to other threads
+// is not charged to it; see AllocationScope.
+TEST(FlutterNativeUtilsPlugin, BusiestMethodsStayWithinAllocationBudgets) {
+  if (!AllocationTrackingEnabled()) {
+    GTEST_SKIP() << "allocation_hooks.cpp is not linked";
+  }
+  PostedTasks platform_thread;
+  FlutterNativeUtilsPlugin plugin(BackendHub::Acquire(),
+                                  platform_thread.poster());
+
+  EncodableValue response;
+  std::string error_code;
+  // Calls |method| and runs the platform thread until it completes.
+  auto call = [&](const std::string& method, const EncodableMap& args) {
+    bool done = false;
+    error_code.clear();
+    plugin.HandleMethodCall(
+        MethodCall(method, std::make_unique<EncodableValue>(args)),
+        std::make_unique<MethodResultFunctions<>>(
+            [&](const EncodableValue* result) {
+              response = result ? *result : EncodableValue();
+              done = true;
+            },
+            [&](const std::string& code, const std::string&,
+                const EncodableValue*) {
+              error_code = code;
+              done = true;
+            },
+            [&]() {
+              error_code = "NOT_IMPLEMENTED";
+              done = true;
+            }));
+    platform_thread.RunUntil([&done]() { return done; });
+  };
+
+  struct Budget {
+    std::string method;
+    EncodableMap args;
+    double allocations;
+  };
+  std::vector<Budget> budgets = {
+      {"GetRandomBytes", {{EncodableValue("length"), EncodableValue(32)}}, 8},
+  };
+
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+  call("CreateHmacSession",
+       {{EncodableValue("key"),
+         EncodableValue(std::vector<uint8_t>(32, 0x5a))}});
+  ASSERT_TRUE(error_code.empty()) << error_code;
+  const EncodableValue session_id = response;
+  flutter::EncodableList messages;
+  for (int i = 0; i < 16; ++i) {
+    messages.push_back(
+        EncodableValue(std::vector<uint8_t>(256, static_cast<uint8_t>(i))));
+  }
+  budgets.push_back({"ComputeHmacs",
+                     {{EncodableValue("sessionId"), session_id},
+                      {EncodableValue("messages"), EncodableValue(messages)}},
+                     48});
+
+  const std::string key_name =
+      "flutter_native_utils_test_allocation_budgets";
+  const EncodableMap key_args = {
+      {EncodableValue("keyName"), EncodableValue(key_name)}};
+  call("GenerateDataKey", key_args);
+  ASSERT_TRUE(error_code.empty()) << error_code;
+  budgets.push_back({"Encrypt",
+                     {{EncodableValue("keyName"), EncodableValue(key_name)},
+                      {EncodableValue("wrappedKey"), response},
+                      {EncodableValue("data"),
+                       EncodableValue(std::vector<uint8_t>(4096, 7))}},
+                     32});
+#endif
+
+  constexpr int kCalls = 100;
+  for (const Budget& budget : budgets) {
+    SCOPED_TRACE(budget.method);
+    // The first call creates backends and caches a long-running plugin only
+    // creates once.
+    call(budget.method, budget.args);
+    ASSERT_TRUE(error_code.empty()) << error_code;
+    ResetAllocationStats();
+    for (int i = 0; i < kCalls; ++i) call(budget.method, budget.args);
+    ASSERT_TRUE(error_code.empty()) << error_code;
+
+    const MethodAllocationStats* stats = nullptr;
+    std::vector<MethodAllocationStats> snapshot = AllocationStatsSnapshot();
+    for (const MethodAllocationStats& entry : snapshot) {
+      if (entry.method == budget.method) stats = &entry;
+    }
+    ASSERT_NE(stats, nullptr);
+    ASSERT_EQ(stats->calls, static_cast<uint64_t>(kCalls));
+    const double per_call = static_cast<double>(stats->allocations) / kCalls;
+    std::printf("  %-20s %8.1f allocs per call (budget %.0f)\n",
+                budget.method.c_str(), per_call, budget.allocations);
+    EXPECT_LE(per_call, budget.allocations);
+  }
+
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+  call("DeleteKey", key_args);
+  EXPECT_TRUE(error_code.empty()) << error_code;
+#endif
+}
+
+#ifdef FLUTTER_NATIVE_UTILS_FEATURE_KEYS
+TEST(FlutterNativeUtilsPlugin, SignNonceRejectsReplaysWithinTheWindow) {
+  FlutterNativeUtilsPlugin plugin;
+  std::string error_code;
+  auto call = [&plugin, &error_code](const std::string& method,
+                                     EncodableMap args) {
+    error_code.clear();
+    plugin.HandleMethodCall(
+        MethodCall(method, std::make_unique<EncodableValue>(std::move(args))),
+        std::make_unique<MethodResultFunctions<>>(
+            nullptr,
+            [&error_code](const std::string& code, const std::string&,
+                          const EncodableValue*) { error_code = code; },
+            nullptr));
+  };
+  const EncodableMap sign_args = {
+      {EncodableValue("keyName"),
+       EncodableValue("flutter_native_utils_test_missing_key")},
+      {EncodableValue("nonce"), EncodableValue(std::vector<uint8_t>(32, 7))},
+  };
+
+  // Without a window a nonce reaches the key every time.
+  call("SignNonce", sign_args);
+  EXPECT_EQ(error_code, "CNG_ERROR");
+  call("SignNonce", sign_args);
+  EXPECT_EQ(error_code, "CNG_ERROR");
+
+  call("ConfigureNonceReplayWindow",
+       {{EncodableValue("windowMs"), EncodableValue(60000)},
+        {EncodableValue("capacity"), EncodableValue(1000)}});
+  ASSERT_TRUE(error_code.empty());
+  call("SignNonce", sign_args);
+  EXPECT_EQ(error_code, "CNG_ERROR");
+  call("SignNonce", sign_args);
+  EXPECT_EQ(error_code, "REPLAYED_NONCE");
+
+  call("ConfigureNonceReplayWindow",
+       {{EncodableValue("windowMs"), EncodableValue(-1)}});
+  EXPECT_EQ(error_code, "BAD_ARGS");
+  call("ConfigureNonceReplayWindow", {});
+  call("SignNonce", sign_args);
+  EXPECT_EQ(error_code, "CNG_ERROR");
+}
+
+TEST(FlutterNativeUtilsPlugin, KvMethodsRejectBadArgumentsAndUnknownStores) {
+  FlutterNativeUtilsPlugin plugin;
+  std::string error_code;
+  const EncodableValue* response = nullptr;
+  EncodableValue last;
+  auto call = [&](const std::string& method, EncodableMap args) {
+    error_code.clear();
+    response = nullptr;
+    plugin.HandleMethodCall(
+        MethodCall(method, std::make_unique<EncodableValue>(std::move(args))),
+        std::make_unique<MethodResultFunctions<>>(
+            [&](const EncodableValue* result) {
+              last = result ? *result : EncodableValue();
+              response = &last;
+            },
+            [&error_code](const std::string& code, const std::string&,
+                          const EncodableValue*) { error_code = code; },
+            nullptr));
+  };
+  const EncodableValue unknown(int64_t{999999});
+
+  call("OpenKvStore", {{EncodableValue("keyName"), EncodableValue("kv")}});
+  EXPECT_EQ(error_code, "BAD_ARGS");
+  call("KvGet", {{EncodableValue("store"), unknown},
+                 {EncodableValue("key"), EncodableValue("k")}});
+  EXPECT_EQ(error_code, "BAD_ARGS");
+  call("KvPut", {{EncodableValue("store"), unknown},
+                 {EncodableValue("entries"), EncodableValue(EncodableMap{})}});
+  EXPECT_EQ(error_code, "BAD_ARGS");
+  call("KvScan", {{EncodableValue("store"), unknown}});
+  EXPECT_EQ(error_code, "BAD_ARGS");
 
-  // Since the exact string varies by host, just ensure that it's a string
-  // with the expected format.
-  EXPECT_TRUE(result_string.rfind("Windows ", 0) == 0);
+  call("CloseKvStore", {{EncodableValue("store"), unknown}});
+  ASSERT_NE(response, nullptr);
+  EXPECT_EQ(*response, EncodableValue(false));
 }
+#endif
 
 }  // namespace test
 }  // namespace flutter_native_utils
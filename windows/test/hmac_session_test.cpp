@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "hmac.h"
+#include "hmac_session.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+std::string ToHex(const uint8_t* data, size_t len) {
+  static const char kDigits[] = "0123456789abcdef";
+  std::string hex;
+  for (size_t i = 0; i < len; ++i) {
+    hex.push_back(kDigits[data[i] >> 4]);
+    hex.push_back(kDigits[data[i] & 0xf]);
+  }
+  return hex;
+}
+
+const uint8_t* Bytes(const std::string& text) {
+  return reinterpret_cast<const uint8_t*>(text.data());
+}
+
+MacMessage Message(const std::string& text) {
+  return MacMessage{Bytes(text), text.size()};
+}
+
+}  // namespace
+
+// RFC 4231 test case 2; the session is reused for the second message.
+TEST(HmacSession, MatchesRfc4231) {
+  const std::string data = "what do ya want for nothing?";
+  HmacSession sha256(MacAlgorithm::kHmacSha256, Bytes("Jefe"), 4);
+  HmacSession sha512(MacAlgorithm::kHmacSha512, Bytes("Jefe"), 4);
+  for (int round = 0; round < 2; ++round) {
+    uint8_t mac[64];
+    sha256.Compute(Bytes(data), data.size(), mac);
+    EXPECT_EQ(ToHex(mac, sha256.mac_len()),
+              "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+    sha512.Compute(Bytes(data), data.size(), mac);
+    EXPECT_EQ(ToHex(mac, sha512.mac_len()),
+              "164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea250554"
+              "9758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737");
+  }
+}
+
+// RFC 4231 test case 6 exercises a key longer than the block size.
+TEST(HmacSession, HashesLongKeys) {
+  std::vector<uint8_t> key(131, 0xaa);
+  const std::string data = "Test Using Larger Than Block-Size Key - Hash Key First";
+  HmacSession session(MacAlgorithm::kHmacSha512, key.data(), key.size());
+  uint8_t mac[64];
+  session.Compute(Bytes(data), data.size(), mac);
+  EXPECT_EQ(ToHex(mac, sizeof(mac)),
+            "80b24263c7c1a3ebb71493c1dd7be8b49b46d1f41b4aeec1121b013783f8f352"
+            "6b56d037e05f2598bd0fd2215d6a1e5295e64f73f63f0aec8b915a985d786598");
+}
+
+TEST(HmacSession, BatchMatchesPortableHmac) {
+  const std::string key = "request-signing-key";
+  std::vector<std::string> bodies = {"", "GET /v1/items", std::string(1000, 'x')};
+  std::vector<MacMessage> messages;
+  for (const std::string& body : bodies) messages.push_back(Message(body));
+
+  HmacSession session(MacAlgorithm::kHmacSha256, Bytes(key), key.size());
+  std::vector<uint8_t> macs = session.ComputeBatch(messages);
+  ASSERT_EQ(macs.size(), bodies.size() * kSha256Len);
+  for (size_t i = 0; i < bodies.size(); ++i) {
+    HmacSha256 reference(Bytes(key), key.size());
+    reference.Update(Bytes(bodies[i]), bodies[i].size());
+    Sha256Digest digest = reference.Finish();
+    EXPECT_EQ(ToHex(macs.data() + i * kSha256Len, kSha256Len),
+              ToHex(digest.data(), digest.size()));
+  }
+}
+
+TEST(HmacSession, VerifyBatchFlagsEachBadMac) {
+  const std::string key = "k";
+  std::vector<std::string> bodies = {"a", "b", "c", "d"};
+  std::vector<MacMessage> messages;
+  for (const std::string& body : bodies) messages.push_back(Message(body));
+
+  HmacSession session(MacAlgorithm::kHmacSha256, Bytes(key), key.size());
+  std::vector<uint8_t> macs = session.ComputeBatch(messages);
+  macs[kSha256Len + 5] ^= 1;  // Corrupt the MAC of "b".
+  std::vector<MacMessage> mac_views;
+  for (size_t i = 0; i < bodies.size(); ++i) {
+    mac_views.push_back(MacMessage{macs.data() + i * kSha256Len, kSha256Len});
+  }
+  mac_views[3].len = 16;  // Truncated MACs never verify.
+
+  std::vector<bool> valid = session.VerifyBatch(messages, mac_views);
+  EXPECT_EQ(valid, (std::vector<bool>{true, false, true, false}));
+
+  mac_views.pop_back();
+  EXPECT_THROW(session.VerifyBatch(messages, mac_views), std::invalid_argument);
+}
+
+TEST(HmacSession, ParsesAlgorithmNames) {
+  MacAlgorithm algorithm;
+  EXPECT_TRUE(ParseMacAlgorithm("sha512", &algorithm));
+  EXPECT_EQ(algorithm, MacAlgorithm::kHmacSha512);
+  EXPECT_EQ(MacLength(algorithm), 64u);
+  EXPECT_FALSE(ParseMacAlgorithm("md5", &algorithm));
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
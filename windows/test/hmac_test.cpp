@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "hmac.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+std::string ToHex(const uint8_t* data, size_t len) {
+  static const char kDigits[] = "0123456789abcdef";
+  std::string hex;
+  for (size_t i = 0; i < len; ++i) {
+    hex.push_back(kDigits[data[i] >> 4]);
+    hex.push_back(kDigits[data[i] & 0xf]);
+  }
+  return hex;
+}
+
+const uint8_t* Bytes(const std::string& text) {
+  return reinterpret_cast<const uint8_t*>(text.data());
+}
+
+}  // namespace
+
+// RFC 4231 test cases 2 and 6.
+TEST(HmacSha256, MatchesRfc4231) {
+  HmacSha256 short_key(Bytes("Jefe"), 4);
+  const std::string data = "what do ya want for nothing?";
+  short_key.Update(Bytes(data), data.size());
+  Sha256Digest digest = short_key.Finish();
+  EXPECT_EQ(ToHex(digest.data(), digest.size()),
+            "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+
+  std::vector<uint8_t> long_key(131, 0xaa);
+  HmacSha256 hashed_key(long_key.data(), long_key.size());
+  const std::string test = "Test Using Larger Than Block-Size Key - Hash Key First";
+  hashed_key.Update(Bytes(test), test.size());
+  digest = hashed_key.Finish();
+  EXPECT_EQ(ToHex(digest.data(), digest.size()),
+            "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54");
+}
+
+// RFC 5869 test case 1.
+TEST(HkdfSha256, MatchesRfc5869) {
+  std::vector<uint8_t> ikm(22, 0x0b);
+  std::vector<uint8_t> salt = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+                               0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c};
+  std::vector<uint8_t> info = {0xf0, 0xf1, 0xf2, 0xf3, 0xf4,
+                               0xf5, 0xf6, 0xf7, 0xf8, 0xf9};
+  uint8_t okm[42];
+  HkdfSha256(ikm.data(), ikm.size(), salt.data(), salt.size(), info.data(),
+             info.size(), okm, sizeof(okm));
+  EXPECT_EQ(ToHex(okm, sizeof(okm)),
+            "3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db02d56ecc4c5bf"
+            "34007208d5b887185865");
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
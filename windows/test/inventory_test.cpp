@@ -0,0 +1,268 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "inventory.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+// Provider of one class whose rows are 0..count-1, counting live cursors.
+class CountingProvider : public InventoryProvider {
+ public:
+  explicit CountingProvider(int64_t count) : count_(count) {}
+
+  std::unique_ptr<InventoryCursor> Open(const InventoryQuery& query) override {
+    if (query.class_name != "numbers") {
+      throw std::invalid_argument("Unknown inventory class");
+    }
+    return std::make_unique<Cursor>(this);
+  }
+
+  int live_cursors = 0;
+  bool fail_next_read = false;
+
+ private:
+  class Cursor : public InventoryCursor {
+   public:
+    explicit Cursor(CountingProvider* owner) : owner_(owner) {
+      ++owner_->live_cursors;
+    }
+    ~Cursor() override { --owner_->live_cursors; }
+
+    bool Next(size_t max_rows, std::vector<InventoryRow>* rows) override {
+      if (owner_->fail_next_read) throw std::runtime_error("source failed");
+      for (size_t i = 0; i < max_rows && next_ < owner_->count_; ++i) {
+        rows->push_back({InventoryValue(next_++)});
+      }
+      return next_ < owner_->count_;
+    }
+
+   private:
+    CountingProvider* owner_;
+    int64_t next_ = 0;
+  };
+
+  int64_t count_;
+};
+
+InventoryQuery Query(const std::string& class_name,
+                     std::vector<std::string> columns) {
+  InventoryQuery query;
+  query.class_name = class_name;
+  query.columns = std::move(columns);
+  return query;
+}
+
+std::vector<InventoryRow> ReadAll(InventoryProvider* provider,
+                                  const InventoryQuery& query) {
+  std::unique_ptr<InventoryCursor> cursor = provider->Open(query);
+  std::vector<InventoryRow> rows;
+  while (cursor->Next(2, &rows)) {
+  }
+  return rows;
+}
+
+}  // namespace
+
+TEST(Inventory, MatchesConditionsWithWqlSemantics) {
+  auto matches = [](const InventoryValue& value, InventoryOperator op,
+                    const InventoryValue& expected) {
+    return MatchesCondition(value, {"column", op, expected});
+  };
+  EXPECT_TRUE(matches(std::string("Samsung SSD"), InventoryOperator::kEquals,
+                      std::string("samsung ssd")));
+  EXPECT_TRUE(matches(std::string("Samsung SSD"), InventoryOperator::kContains,
+                      std::string("ssd")));
+  EXPECT_TRUE(matches(int64_t{1500}, InventoryOperator::kGreater, 1000.5));
+  EXPECT_TRUE(matches(2.5, InventoryOperator::kLess, int64_t{3}));
+  EXPECT_TRUE(matches(true, InventoryOperator::kNotEquals, false));
+  // Null only equals null, and mismatched types never match.
+  EXPECT_TRUE(matches(InventoryValue(), InventoryOperator::kEquals,
+                      InventoryValue()));
+  EXPECT_FALSE(matches(InventoryValue(), InventoryOperator::kNotEquals,
+                       int64_t{0}));
+  EXPECT_FALSE(matches(int64_t{0}, InventoryOperator::kEquals,
+                       InventoryValue()));
+  EXPECT_FALSE(matches(std::string("1"), InventoryOperator::kEquals,
+                       int64_t{1}));
+  EXPECT_FALSE(matches(int64_t{10}, InventoryOperator::kContains,
+                       std::string("1")));
+
+  InventoryOperator op;
+  EXPECT_TRUE(ParseInventoryOperator("notEquals", &op));
+  EXPECT_EQ(op, InventoryOperator::kNotEquals);
+  EXPECT_FALSE(ParseInventoryOperator("like", &op));
+}
+
+TEST(Inventory, BuildsEscapedWql) {
+  InventoryQuery query = Query("Win32_DiskDrive", {"Model", "Size"});
+  EXPECT_EQ(BuildWqlQuery(query), "SELECT Model, Size FROM Win32_DiskDrive");
+
+  query.filter = {
+      {"Model", InventoryOperator::kContains, std::string("50%_[x]")},
+      {"Caption", InventoryOperator::kEquals, std::string("it's C:\\")},
+      {"Size", InventoryOperator::kGreater, int64_t{1000}},
+      {"Removable", InventoryOperator::kNotEquals, true},
+      {"Serial", InventoryOperator::kEquals, InventoryValue()},
+  };
+  EXPECT_EQ(BuildWqlQuery(query),
+            "SELECT Model, Size FROM Win32_DiskDrive"
+            " WHERE Model LIKE '%50[%][_][[]x]%'"
+            " AND Caption = 'it\\'s C:\\\\'"
+            " AND Size > 1000"
+            " AND Removable <> TRUE"
+            " AND Serial IS NULL");
+}
+
+TEST(Inventory, RejectsWqlInjection) {
+  EXPECT_THROW(BuildWqlQuery(Query("Win32_Process WHERE 1=1", {"Name"})),
+               std::invalid_argument);
+  EXPECT_THROW(BuildWqlQuery(Query("Win32_Process", {"Name, CommandLine"})),
+               std::invalid_argument);
+  EXPECT_THROW(BuildWqlQuery(Query("Win32_Process", {})),
+               std::invalid_argument);
+
+  InventoryQuery query = Query("Win32_Process", {"Name"});
+  query.filter = {{"Name OR 1", InventoryOperator::kEquals, int64_t{1}}};
+  EXPECT_THROW(BuildWqlQuery(query), std::invalid_argument);
+  query.filter = {{"Name", InventoryOperator::kLess, InventoryValue()}};
+  EXPECT_THROW(BuildWqlQuery(query), std::invalid_argument);
+  query.filter = {{"Name", InventoryOperator::kContains, int64_t{1}}};
+  EXPECT_THROW(BuildWqlQuery(query), std::invalid_argument);
+}
+
+TEST(SysfsInventoryProvider, ProjectsTypedColumns) {
+  SysfsInventoryProvider provider(FLUTTER_NATIVE_UTILS_FIXTURES_DIR);
+
+  std::vector<InventoryRow> disks = ReadAll(
+      &provider, Query("disks", {"name", "sizeBytes", "rotational", "model"}));
+  ASSERT_EQ(disks.size(), 3u);
+  EXPECT_EQ(disks[0], (InventoryRow{std::string("nvme0n1"),
+                                    int64_t{1000215216} * 512, false,
+                                    std::string("Samsung SSD 970 EVO Plus "
+                                                "500GB")}));
+  // Missing attributes are null.
+  EXPECT_EQ(disks[2], (InventoryRow{std::string("sr0"),
+                                    int64_t{2097151} * 512, true,
+                                    InventoryValue()}));
+
+  std::vector<InventoryRow> adapters =
+      ReadAll(&provider, Query("networkAdapters", {"speedMbps", "name"}));
+  EXPECT_EQ(adapters, (std::vector<InventoryRow>{
+                          {int64_t{1000}, std::string("eth0")},
+                          {InventoryValue(), std::string("lo")},
+                          {InventoryValue(), std::string("wlan0")},
+                      }));
+
+  // Cards themselves are not monitors.
+  std::vector<InventoryRow> monitors =
+      ReadAll(&provider, Query("monitors", {"name", "enabled"}));
+  EXPECT_EQ(monitors, (std::vector<InventoryRow>{
+                          {std::string("card0-HDMI-A-1"), false},
+                          {std::string("card0-eDP-1"), true},
+                      }));
+
+  std::vector<InventoryRow> processors = ReadAll(
+      &provider, Query("processors", {"processor", "coreId", "mhz"}));
+  EXPECT_EQ(processors, (std::vector<InventoryRow>{
+                            {int64_t{0}, int64_t{0}, 2100.0},
+                            {int64_t{1}, int64_t{0}, 2100.0},
+                            {int64_t{2}, int64_t{8}, 1800.5},
+                        }));
+}
+
+TEST(SysfsInventoryProvider, FiltersOnUnprojectedColumns) {
+  SysfsInventoryProvider provider(FLUTTER_NATIVE_UTILS_FIXTURES_DIR);
+  InventoryQuery query = Query("disks", {"name"});
+  query.filter = {
+      {"removable", InventoryOperator::kEquals, false},
+      {"model", InventoryOperator::kContains, std::string("wdc")},
+  };
+  EXPECT_EQ(ReadAll(&provider, query),
+            (std::vector<InventoryRow>{{std::string("sda")}}));
+
+  query = Query("networkAdapters", {"name"});
+  query.filter = {{"operState", InventoryOperator::kNotEquals,
+                   std::string("up")}};
+  EXPECT_EQ(ReadAll(&provider, query).size(), 2u);
+}
+
+TEST(SysfsInventoryProvider, RejectsUnknownClassesAndColumns) {
+  SysfsInventoryProvider provider(FLUTTER_NATIVE_UTILS_FIXTURES_DIR);
+  EXPECT_THROW(provider.Open(Query("Win32_DiskDrive", {"Model"})),
+               std::invalid_argument);
+  EXPECT_THROW(provider.Open(Query("disks", {"name", "serial"})),
+               std::invalid_argument);
+  InventoryQuery query = Query("disks", {"name"});
+  query.filter = {{"vendor", InventoryOperator::kEquals, std::string("x")}};
+  EXPECT_THROW(provider.Open(query), std::invalid_argument);
+
+  SysfsInventoryProvider missing(FLUTTER_NATIVE_UTILS_FIXTURES_DIR "/missing");
+  EXPECT_TRUE(ReadAll(&missing, Query("disks", {"name"})).empty());
+  EXPECT_THROW(missing.Open(Query("processors", {"processor"})),
+               std::runtime_error);
+}
+
+TEST(InventoryEngine, PagesAndClosesExhaustedCursors) {
+  auto owned = std::make_unique<CountingProvider>(5);
+  CountingProvider* provider = owned.get();
+  InventoryEngine engine(std::move(owned));
+  InventoryQuery query = Query("numbers", {"n"});
+  query.page_size = 2;
+
+  InventoryPage page = engine.Start(query);
+  EXPECT_EQ(page.rows.size(), 2u);
+  EXPECT_FALSE(page.done);
+  EXPECT_EQ(engine.open_cursors(), 1u);
+
+  page = engine.Next(page.cursor);
+  EXPECT_EQ(page.rows, (std::vector<InventoryRow>{{int64_t{2}}, {int64_t{3}}}));
+  page = engine.Next(page.cursor);
+  EXPECT_EQ(page.rows, (std::vector<InventoryRow>{{int64_t{4}}}));
+  EXPECT_TRUE(page.done);
+  EXPECT_EQ(engine.open_cursors(), 0u);
+  EXPECT_EQ(provider->live_cursors, 0);
+  EXPECT_THROW(engine.Next(page.cursor), std::invalid_argument);
+
+  query.page_size = 0;
+  EXPECT_THROW(engine.Start(query), std::invalid_argument);
+  query.page_size = InventoryEngine::kMaxPageSize + 1;
+  EXPECT_THROW(engine.Start(query), std::invalid_argument);
+}
+
+TEST(InventoryEngine, ClosesAbandonedAndFailedCursors) {
+  auto owned = std::make_unique<CountingProvider>(100);
+  CountingProvider* provider = owned.get();
+  InventoryEngine engine(std::move(owned));
+  InventoryQuery query = Query("numbers", {"n"});
+  query.page_size = 1;
+
+  const int64_t first = engine.Start(query).cursor;
+  const int64_t second = engine.Start(query).cursor;
+  EXPECT_TRUE(engine.Close(second));
+  EXPECT_FALSE(engine.Close(second));
+
+  // The oldest cursors give way once the limit is reached.
+  for (size_t i = 0; i < InventoryEngine::kMaxOpenCursors; ++i) {
+    engine.Start(query);
+  }
+  EXPECT_EQ(engine.open_cursors(), InventoryEngine::kMaxOpenCursors);
+  EXPECT_EQ(provider->live_cursors,
+            static_cast<int>(InventoryEngine::kMaxOpenCursors));
+  EXPECT_THROW(engine.Next(first), std::invalid_argument);
+
+  const int64_t failing = engine.Start(query).cursor;
+  provider->fail_next_read = true;
+  EXPECT_THROW(engine.Next(failing), std::runtime_error);
+  provider->fail_next_read = false;
+  EXPECT_THROW(engine.Next(failing), std::invalid_argument);
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
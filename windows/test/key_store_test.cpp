@@ -0,0 +1,314 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "key_store.h"
+#include "rsa_public_key.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// In-memory store counting the calls the index makes.
+class CountingKeyStore : public KeyStore {
+ public:
+  std::vector<KeyInfo> Enumerate() override {
+    ++enumerations;
+    std::vector<KeyInfo> keys;
+    for (const auto& key : keys_) keys.push_back({key.first, "RSA"});
+    return keys;
+  }
+
+  std::optional<KeyInfo> Describe(const std::string& name) override {
+    ++descriptions;
+    auto it = keys_.find(name);
+    if (it == keys_.end()) return std::nullopt;
+    return it->second;
+  }
+
+  std::vector<uint8_t> CreateOrOpen(const std::string& name,
+                                    bool* created) override {
+    *created = keys_.count(name) == 0;
+    if (*created) Add(name);
+    return {1, 2, 3};
+  }
+
+  bool Delete(const std::string& name) override {
+    return keys_.erase(name) > 0;
+  }
+
+  std::vector<uint8_t> Wrap(const std::string&, const uint8_t*,
+                            size_t) override {
+    throw std::runtime_error("Not supported");
+  }
+
+  // "Unwraps" by repeating the first wrapped byte, for any key it holds.
+  bool Unwrap(const std::string& name, const uint8_t* wrapped,
+              size_t wrapped_len, uint8_t* out, size_t out_len) override {
+    ++unwraps;
+    if (keys_.count(name) == 0 || wrapped_len == 0) return false;
+    std::fill(out, out + out_len, wrapped[0]);
+    return true;
+  }
+
+  // Adds a key behind the index's back.
+  void Add(const std::string& name) {
+    KeyInfo info;
+    info.name = name;
+    info.algorithm = "RSA";
+    info.has_details = true;
+    info.length_bits = 2048;
+    info.created = 1700000000000;
+    info.usages = {"decrypt", "sign"};
+    keys_[name] = info;
+  }
+
+  int enumerations = 0;
+  int descriptions = 0;
+  int unwraps = 0;
+
+ private:
+  std::map<std::string, KeyInfo> keys_;
+};
+
+std::vector<std::string> Names(const KeyPage& page) {
+  std::vector<std::string> names;
+  for (const KeyInfo& info : page.keys) names.push_back(info.name);
+  return names;
+}
+
+// A key directory of the running test's own, so tests run in parallel do
+// not share one.
+fs::path KeyDirectory() {
+  const ::testing::TestInfo* info =
+      ::testing::UnitTest::GetInstance()->current_test_info();
+  return fs::temp_directory_path() /
+         ("fnu_" + std::string(info->test_suite_name()) + "_" + info->name());
+}
+
+}  // namespace
+
+TEST(FileKeyStore, CreatesListsDescribesAndDeletesKeys) {
+  const fs::path directory = KeyDirectory();
+  fs::remove_all(directory);
+  FileKeyStore store(directory.string());
+  EXPECT_TRUE(store.Enumerate().empty());
+  EXPECT_FALSE(store.Describe("device").has_value());
+
+  const int64_t before =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count();
+  bool created = false;
+  // Names are not file names.
+  const std::string name = "user/1 \xE2\x9C\x93";
+  std::vector<uint8_t> public_key = store.CreateOrOpen(name, &created);
+  EXPECT_TRUE(created);
+  EXPECT_NE(RsaPublicKey::FromCngBlob(public_key), nullptr);
+  EXPECT_EQ(fs::status(directory / "757365722f3120e29c93.pem").permissions() &
+                fs::perms::all,
+            fs::perms::owner_read | fs::perms::owner_write);
+
+  EXPECT_EQ(store.CreateOrOpen(name, &created), public_key);
+  EXPECT_FALSE(created);
+  store.CreateOrOpen("device", &created);
+
+  std::vector<KeyInfo> keys = store.Enumerate();
+  ASSERT_EQ(keys.size(), 2u);
+  for (const KeyInfo& info : keys) {
+    EXPECT_TRUE(info.name == name || info.name == "device") << info.name;
+    EXPECT_EQ(info.algorithm, "RSA");
+    EXPECT_FALSE(info.has_details);
+  }
+
+  std::optional<KeyInfo> info = store.Describe(name);
+  ASSERT_TRUE(info.has_value());
+  EXPECT_TRUE(info->has_details);
+  EXPECT_EQ(info->algorithm, "RSA");
+  EXPECT_EQ(info->length_bits, 2048u);
+  EXPECT_EQ(info->usages, (std::vector<std::string>{"decrypt", "sign"}));
+  // File times may be a tick behind the system clock.
+  EXPECT_GE(info->created, before - 1000);
+
+  EXPECT_TRUE(store.Delete(name));
+  EXPECT_FALSE(store.Delete(name));
+  EXPECT_FALSE(store.Describe(name).has_value());
+  EXPECT_EQ(store.Enumerate().size(), 1u);
+  fs::remove_all(directory);
+}
+
+TEST(FileKeyStore, WrapsDataOnlyItsKeyCanUnwrap) {
+  const fs::path directory = KeyDirectory();
+  fs::remove_all(directory);
+  KeyIndex index(std::make_unique<FileKeyStore>(directory.string()));
+  EXPECT_THROW(index.Wrap("missing", nullptr, 0), std::runtime_error);
+  index.CreateOrOpen("a");
+  index.CreateOrOpen("b");
+
+  const std::vector<uint8_t> secret(KeyStore::kMaxWrapLen, 0x5c);
+  std::vector<uint8_t> wrapped = index.Wrap("a", secret.data(), secret.size());
+  EXPECT_EQ(wrapped.size(), 256u);
+  // OAEP is randomized.
+  EXPECT_NE(index.Wrap("a", secret.data(), secret.size()), wrapped);
+
+  std::vector<uint8_t> out(secret.size());
+  ASSERT_TRUE(index.Unwrap("a", wrapped.data(), wrapped.size(), out.data(),
+                           out.size()));
+  EXPECT_EQ(out, secret);
+  EXPECT_FALSE(index.Unwrap("b", wrapped.data(), wrapped.size(), out.data(),
+                            out.size()));
+  EXPECT_FALSE(index.Unwrap("a", wrapped.data(), wrapped.size(), out.data(),
+                            out.size() - 1));
+  EXPECT_FALSE(index.Unwrap("missing", wrapped.data(), wrapped.size(),
+                            out.data(), out.size()));
+  wrapped[10] ^= 1;
+  EXPECT_FALSE(index.Unwrap("a", wrapped.data(), wrapped.size(), out.data(),
+                            out.size()));
+  EXPECT_THROW(index.Wrap("a", secret.data(), secret.size() + 1),
+               std::invalid_argument);
+  fs::remove_all(directory);
+}
+
+TEST(KeyIndex, ListsPagesWithoutOpeningKeys) {
+  auto owned = std::make_unique<CountingKeyStore>();
+  CountingKeyStore* store = owned.get();
+  for (const char* name : {"app.b", "app.a", "other", "app.c", "zzz"}) {
+    store->Add(name);
+  }
+  KeyIndex index(std::move(owned));
+
+  KeyPage page = index.List("app.", "", 2);
+  EXPECT_EQ(Names(page), (std::vector<std::string>{"app.a", "app.b"}));
+  EXPECT_FALSE(page.done);
+  EXPECT_FALSE(page.keys[0].has_details);
+  page = index.List("app.", page.last, 2);
+  EXPECT_EQ(Names(page), (std::vector<std::string>{"app.c"}));
+  EXPECT_TRUE(page.done);
+
+  page = index.List("", "app.c", 10);
+  EXPECT_EQ(Names(page), (std::vector<std::string>{"other", "zzz"}));
+  EXPECT_TRUE(page.done);
+  EXPECT_TRUE(index.List("nothing", "", 10).keys.empty());
+
+  EXPECT_EQ(store->enumerations, 1);
+  EXPECT_EQ(store->descriptions, 0);
+  EXPECT_THROW(index.List("", "", 0), std::invalid_argument);
+  EXPECT_THROW(index.List("", "", KeyIndex::kMaxPageSize + 1),
+               std::invalid_argument);
+}
+
+TEST(KeyIndex, TracksCreationsAndDeletionsMadeThroughIt) {
+  auto owned = std::make_unique<CountingKeyStore>();
+  CountingKeyStore* store = owned.get();
+  store->Add("existing");
+  KeyIndex index(std::move(owned));
+  EXPECT_EQ(index.List("", "", 10).keys.size(), 1u);
+
+  // Details are read once, then served from the index.
+  EXPECT_EQ(index.Info("existing")->length_bits, 2048u);
+  EXPECT_EQ(index.Info("existing")->length_bits, 2048u);
+  EXPECT_EQ(store->descriptions, 1);
+  EXPECT_TRUE(index.List("", "", 10).keys[0].has_details);
+
+  EXPECT_EQ(index.CreateOrOpen("new"), (std::vector<uint8_t>{1, 2, 3}));
+  KeyPage page = index.List("", "", 10);
+  EXPECT_EQ(Names(page), (std::vector<std::string>{"existing", "new"}));
+  EXPECT_TRUE(page.keys[1].has_details);
+  // Reopening a known key does not describe it again.
+  index.CreateOrOpen("new");
+  EXPECT_EQ(store->descriptions, 2);
+
+  EXPECT_EQ(index.deletions(), 0u);
+  EXPECT_TRUE(index.Delete("existing"));
+  EXPECT_FALSE(index.Delete("existing"));
+  EXPECT_EQ(index.deletions(), 1u);
+  EXPECT_EQ(Names(index.List("", "", 10)), (std::vector<std::string>{"new"}));
+  EXPECT_FALSE(index.Info("existing").has_value());
+  EXPECT_EQ(store->enumerations, 1);
+
+  EXPECT_THROW(index.CreateOrOpen(""), std::invalid_argument);
+  EXPECT_THROW(index.Delete(""), std::invalid_argument);
+}
+
+TEST(KeyIndex, PicksUpOutsideChangesOnReload) {
+  auto owned = std::make_unique<CountingKeyStore>();
+  CountingKeyStore* store = owned.get();
+  store->Add("first");
+  KeyIndex index(std::move(owned));
+  EXPECT_EQ(index.List("", "", 10).keys.size(), 1u);
+
+  store->Add("outside");
+  EXPECT_EQ(index.List("", "", 10).keys.size(), 1u);
+  // Describing a key the index does not know adds it.
+  EXPECT_TRUE(index.Info("outside").has_value());
+  EXPECT_EQ(index.List("", "", 10).keys.size(), 2u);
+
+  store->Delete("first");
+  index.Reload();
+  EXPECT_EQ(Names(index.List("", "", 10)),
+            (std::vector<std::string>{"outside"}));
+  EXPECT_EQ(store->enumerations, 2);
+}
+
+TEST(DataKeyCache, UnwrapsOnceAndEvictsTheLeastRecentlyUsedKey) {
+  auto owned = std::make_unique<CountingKeyStore>();
+  CountingKeyStore* store = owned.get();
+  store->Add("k");
+  KeyIndex index(std::move(owned));
+  DataKeyCache cache(&index, 2);
+
+  const std::vector<uint8_t> one = {1};
+  const std::vector<uint8_t> two = {2};
+  const std::vector<uint8_t> three = {3};
+  EXPECT_EQ(cache.Find("k", one), nullptr);
+  std::shared_ptr<const AesGcmKey> key = cache.Unwrap("k", one);
+  EXPECT_EQ((*key)[0], 1);
+  EXPECT_EQ(cache.Unwrap("k", one), key);
+  EXPECT_EQ(cache.Find("k", one), key);
+  EXPECT_EQ(store->unwraps, 1);
+
+  cache.Unwrap("k", two);
+  // |one| was used last, so |two| makes way for |three|.
+  cache.Find("k", one);
+  cache.Unwrap("k", three);
+  EXPECT_EQ(cache.size(), 2u);
+  EXPECT_EQ(cache.Find("k", one), key);
+  EXPECT_EQ(cache.Find("k", two), nullptr);
+  EXPECT_NE(cache.Find("k", three), nullptr);
+  EXPECT_EQ(store->unwraps, 3);
+
+  EXPECT_THROW(cache.Unwrap("missing", one), std::invalid_argument);
+  EXPECT_EQ(cache.size(), 2u);
+}
+
+TEST(DataKeyCache, ForgetsTheKeysOfADeletedKey) {
+  auto owned = std::make_unique<CountingKeyStore>();
+  owned->Add("a");
+  owned->Add("b");
+  KeyIndex index(std::move(owned));
+  DataKeyCache cache(&index);
+
+  const std::vector<uint8_t> wrapped = {7};
+  cache.Unwrap("a", wrapped);
+  cache.Unwrap("b", wrapped);
+  EXPECT_TRUE(index.Delete("a"));
+  cache.Forget("a");
+  EXPECT_EQ(cache.Find("a", wrapped), nullptr);
+  EXPECT_NE(cache.Find("b", wrapped), nullptr);
+  EXPECT_THROW(cache.Unwrap("a", wrapped), std::invalid_argument);
+  EXPECT_EQ(cache.size(), 1u);
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "load_driver.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+TEST(LoadDriver, ParsesMixes) {
+  std::vector<LoadMixEntry> mix =
+      ParseLoadMix("Encrypt=4,GetRandomBytes,Hash=0.5");
+  ASSERT_EQ(mix.size(), 3u);
+  EXPECT_EQ(mix[0].method, "Encrypt");
+  EXPECT_EQ(mix[0].weight, 4);
+  EXPECT_EQ(mix[1].method, "GetRandomBytes");
+  EXPECT_EQ(mix[1].weight, 1);
+  EXPECT_EQ(mix[2].weight, 0.5);
+
+  EXPECT_THROW(ParseLoadMix(""), std::invalid_argument);
+  EXPECT_THROW(ParseLoadMix("Encrypt,"), std::invalid_argument);
+  EXPECT_THROW(ParseLoadMix("Encrypt=0"), std::invalid_argument);
+  EXPECT_THROW(ParseLoadMix("Encrypt=x"), std::invalid_argument);
+  EXPECT_THROW(ParseLoadMix("Encrypt,Encrypt=2"), std::invalid_argument);
+}
+
+TEST(LoadDriver, RunsClosedLoopMixesFromEveryThread) {
+  LoadTestOptions options;
+  options.mix = ParseLoadMix("Fast=3,Failing");
+  options.threads = 4;
+  options.duration = std::chrono::milliseconds(100);
+  options.min_payload_bytes = 10;
+  options.max_payload_bytes = 20;
+  std::atomic<bool> payload_in_range{true};
+  std::atomic<int> threads_seen{0};
+
+  LoadTestReport report = RunLoadTest(
+      options, [&](const LoadCall& call, ReplayDone done) {
+        if (call.payload_bytes < 10 || call.payload_bytes > 20) {
+          payload_in_range = false;
+        }
+        if (call.sequence == 0) ++threads_seen;
+        done(call.method == "Failing" ? MethodCallOutcome::kError
+                                      : MethodCallOutcome::kSuccess,
+             call.payload_bytes);
+      });
+
+  EXPECT_TRUE(payload_in_range);
+  EXPECT_EQ(threads_seen, 4);
+  EXPECT_GT(report.calls, 100u);
+  EXPECT_EQ(report.latency.count, report.calls);
+  const LoadMethodReport& fast = report.by_method["Fast"];
+  const LoadMethodReport& failing = report.by_method["Failing"];
+  EXPECT_EQ(fast.calls + failing.calls, report.calls);
+  EXPECT_EQ(fast.errors, 0u);
+  EXPECT_EQ(failing.errors, failing.calls);
+  EXPECT_EQ(report.errors, failing.calls);
+  // Roughly three to one.
+  EXPECT_GT(fast.calls, 2 * failing.calls);
+  EXPECT_LT(fast.calls, 4 * failing.calls);
+  EXPECT_FALSE(report.ok());
+  EXPECT_EQ(report.unfinished, 0u);
+}
+
+TEST(LoadDriver, PacesCallsAndSkipsBeyondTheInFlightLimit) {
+  LoadTestOptions options;
+  options.mix = ParseLoadMix("Async");
+  options.threads = 2;
+  options.calls_per_second = 1000;
+  options.duration = std::chrono::milliseconds(200);
+  options.max_in_flight_per_thread = 4;
+
+  // Completes every call 20 ms later from another thread: about 20 would be
+  // outstanding per thread, so most are skipped.
+  std::vector<std::thread> completers;
+  std::mutex mutex;
+  LoadTestReport report = RunLoadTest(
+      options, [&](const LoadCall&, ReplayDone done) {
+        std::lock_guard<std::mutex> lock(mutex);
+        completers.emplace_back([done]() {
+          std::this_thread::sleep_for(std::chrono::milliseconds(20));
+          done(MethodCallOutcome::kSuccess, 0);
+        });
+      });
+  for (std::thread& completer : completers) completer.join();
+
+  EXPECT_TRUE(report.ok());
+  EXPECT_GT(report.skipped, 0u);
+  EXPECT_NEAR(static_cast<double>(report.calls + report.skipped), 200, 30);
+  EXPECT_GE(report.latency.p50_us, 20000);
+}
+
+TEST(LoadDriver, ReportsLostAndDuplicateCompletions) {
+  LoadTestOptions options;
+  options.mix = ParseLoadMix("Twice,Lost");
+  options.threads = 2;
+  options.duration = std::chrono::milliseconds(20);
+  options.calls_per_second = 1000;
+  options.drain_timeout = std::chrono::milliseconds(20);
+
+  std::vector<ReplayDone> lost;
+  std::mutex mutex;
+  LoadTestReport report = RunLoadTest(
+      options, [&](const LoadCall& call, ReplayDone done) {
+        if (call.method == "Lost") {
+          // Kept alive but never called.
+          std::lock_guard<std::mutex> lock(mutex);
+          lost.push_back(done);
+          return;
+        }
+        done(MethodCallOutcome::kSuccess, 0);
+        done(MethodCallOutcome::kSuccess, 0);
+      });
+
+  EXPECT_FALSE(report.ok());
+  EXPECT_EQ(report.unfinished, lost.size());
+  EXPECT_EQ(report.duplicate_completions, report.by_method["Twice"].calls);
+  EXPECT_GT(report.unfinished, 0u);
+  EXPECT_GT(report.duplicate_completions, 0u);
+}
+
+TEST(LoadDriver, CountsThrowingDispatchesAsErrors) {
+  LoadTestOptions options;
+  options.mix = ParseLoadMix("Throws");
+  options.threads = 1;
+  // Bounded by calls rather than time, so a slow machine still runs them.
+  options.duration = std::chrono::minutes(1);
+  options.max_calls_per_thread = 20;
+  LoadTestReport report =
+      RunLoadTest(options, [](const LoadCall&, ReplayDone) {
+        throw std::runtime_error("backend exploded");
+      });
+  EXPECT_EQ(report.calls, 20u);
+  EXPECT_EQ(report.errors, 20u);
+  EXPECT_EQ(report.unfinished, 0u);
+
+  options.mix.clear();
+  EXPECT_THROW(RunLoadTest(options, nullptr), std::invalid_argument);
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "file_hasher.h"
+#include "manifest_verifier.h"
+#include "rsa_public_key.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+const std::string kFixtureDir =
+    FLUTTER_NATIVE_UTILS_FIXTURES_DIR "/manifest";
+
+std::string ReadFile(const fs::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+}
+
+std::vector<uint8_t> ReadBytes(const fs::path& path) {
+  std::string contents = ReadFile(path);
+  return std::vector<uint8_t>(contents.begin(), contents.end());
+}
+
+// Copies the fixture bundle to a scratch directory that tests may modify.
+class ManifestVerifierTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    scratch_ = fs::temp_directory_path() /
+               ("fnu_manifest_test_" +
+                std::string(::testing::UnitTest::GetInstance()
+                                ->current_test_info()
+                                ->name()));
+    fs::remove_all(scratch_);
+    fs::create_directories(scratch_);
+    fs::copy(kFixtureDir + "/bundle", scratch_ / "bundle",
+             fs::copy_options::recursive);
+  }
+
+  void TearDown() override { fs::remove_all(scratch_); }
+
+  ManifestVerifyRequest Request() const {
+    ManifestVerifyRequest request;
+    request.manifest = ReadFile(kFixtureDir + "/manifest.txt");
+    request.signature = ReadBytes(kFixtureDir + "/manifest.sig");
+    request.public_key = ReadBytes(kFixtureDir + "/public_key.blob");
+    request.root = (scratch_ / "bundle").string();
+    request.cache_path = (scratch_ / "verify.cache").string();
+    return request;
+  }
+
+  fs::path scratch_;
+  FileHasher hasher_{2};
+};
+
+}  // namespace
+
+TEST(Manifest, ParsesEntriesWithSpacesInPaths) {
+  Manifest manifest = ParseManifest(ReadFile(kFixtureDir + "/manifest.txt"));
+  EXPECT_EQ(manifest.algorithm, HashAlgorithm::kSha256);
+  ASSERT_EQ(manifest.entries.size(), 3u);
+  EXPECT_EQ(manifest.entries[2].path, "assets/sub dir/config.json");
+  EXPECT_EQ(manifest.entries[1].size, 40000u);
+  EXPECT_EQ(manifest.entries[0].mtime, 1767225600);
+}
+
+TEST(Manifest, RejectsUnsafeOrMalformedInput) {
+  const std::string digest(64, 'a');
+  EXPECT_THROW(ParseManifest("fnu-manifest 2 sha256\n"), std::invalid_argument);
+  EXPECT_THROW(ParseManifest("fnu-manifest 1 md5\n"), std::invalid_argument);
+  EXPECT_THROW(ParseManifest("fnu-manifest 1 sha256\n" + digest +
+                             " 1 0 ../outside.bin\n"),
+               std::invalid_argument);
+  EXPECT_THROW(
+      ParseManifest("fnu-manifest 1 sha256\n" + digest + " 1 0 /etc/passwd\n"),
+      std::invalid_argument);
+  EXPECT_THROW(ParseManifest("fnu-manifest 1 sha256\nabc 1 0 a.bin\n"),
+               std::invalid_argument);
+}
+
+TEST(RsaPublicKey, VerifiesSignatureFromCngBlob) {
+  auto key = RsaPublicKey::FromCngBlob(ReadBytes(kFixtureDir + "/public_key.blob"));
+  std::string manifest = ReadFile(kFixtureDir + "/manifest.txt");
+  std::vector<uint8_t> signature = ReadBytes(kFixtureDir + "/manifest.sig");
+  const auto* data = reinterpret_cast<const uint8_t*>(manifest.data());
+
+  EXPECT_TRUE(key->VerifySha256(data, manifest.size(), signature.data(),
+                                signature.size()));
+  manifest[0] ^= 1;
+  EXPECT_FALSE(key->VerifySha256(data, manifest.size(), signature.data(),
+                                 signature.size()));
+  EXPECT_THROW(RsaPublicKey::FromCngBlob({1, 2, 3}), std::invalid_argument);
+}
+
+TEST_F(ManifestVerifierTest, RehashesOnlyChangedFiles) {
+  ManifestVerifier verifier(&hasher_);
+
+  ManifestVerifyResult first = verifier.Verify(Request());
+  EXPECT_TRUE(first.ok());
+  EXPECT_EQ(first.files_checked, 3u);
+  EXPECT_EQ(first.files_rehashed, 3u);
+
+  ManifestVerifyResult second = verifier.Verify(Request());
+  EXPECT_TRUE(second.ok());
+  EXPECT_EQ(second.files_rehashed, 0u);
+
+  // Same size, different contents and mtime.
+  fs::path app = scratch_ / "bundle" / "app.bin";
+  std::string contents = ReadFile(app);
+  contents[0] ^= 1;
+  std::ofstream(app, std::ios::binary | std::ios::trunc) << contents;
+  fs::last_write_time(app, fs::last_write_time(app) + std::chrono::hours(1));
+
+  ManifestVerifyResult third = verifier.Verify(Request());
+  EXPECT_FALSE(third.ok());
+  EXPECT_EQ(third.files_rehashed, 1u);
+  ASSERT_EQ(third.failures.size(), 1u);
+  EXPECT_EQ(third.failures[0].path, "app.bin");
+  EXPECT_EQ(third.failures[0].reason, ManifestFailureReason::kDigestMismatch);
+}
+
+TEST_F(ManifestVerifierTest, ReportsMissingFiles) {
+  fs::remove(scratch_ / "bundle" / "data" / "large.bin");
+  ManifestVerifier verifier(&hasher_);
+
+  ManifestVerifyResult result = verifier.Verify(Request());
+  EXPECT_TRUE(result.signature_valid);
+  ASSERT_EQ(result.failures.size(), 1u);
+  EXPECT_EQ(result.failures[0].path, "data/large.bin");
+  EXPECT_EQ(result.failures[0].reason, ManifestFailureReason::kMissing);
+}
+
+TEST_F(ManifestVerifierTest, RejectsBadSignatureWithoutHashing) {
+  ManifestVerifyRequest request = Request();
+  request.signature[10] ^= 1;
+  ManifestVerifier verifier(&hasher_);
+
+  ManifestVerifyResult result = verifier.Verify(std::move(request));
+  EXPECT_FALSE(result.signature_valid);
+  EXPECT_FALSE(result.ok());
+  EXPECT_EQ(result.files_rehashed, 0u);
+  EXPECT_FALSE(fs::exists(scratch_ / "verify.cache"));
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
@@ -0,0 +1,251 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "method_call_log.h"
+#include "method_call_replay.h"
+#include "standard_codec.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+class MethodCallLogTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = (fs::temp_directory_path() /
+             ("fnu_method_call_log_test_" +
+              std::string(::testing::UnitTest::GetInstance()
+                              ->current_test_info()
+                              ->name()) +
+              ".bin"))
+                .string();
+  }
+  void TearDown() override { fs::remove(path_); }
+
+  void Record(MethodCallRecorder* recorder, const std::string& method,
+              const CodecValue& arguments, int64_t start_us,
+              MethodCallOutcome outcome = MethodCallOutcome::kSuccess,
+              uint64_t result_bytes = 0) {
+    std::vector<uint8_t> encoded = EncodeStandardValue(arguments);
+    recorder->Record(method, encoded.data(), encoded.size(), start_us,
+                     outcome, result_bytes);
+  }
+
+  std::vector<uint8_t> ReadBytes() {
+    std::ifstream file(path_, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file),
+                                std::istreambuf_iterator<char>());
+  }
+
+  std::string path_;
+};
+
+MethodCallRecord Call(const std::string& method, int64_t start_us,
+                      int64_t duration_us) {
+  MethodCallRecord record;
+  record.method = method;
+  record.start_us = start_us;
+  record.duration_us = duration_us;
+  record.result_bytes = 10;
+  return record;
+}
+
+}  // namespace
+
+TEST_F(MethodCallLogTest, RoundTripsRecords) {
+  {
+    MethodCallRecorder recorder(path_);
+    Record(&recorder, "GetRandomBytes", CodecMap{{"length", int32_t{32}}}, 100,
+           MethodCallOutcome::kSuccess, 33);
+    Record(&recorder, "HashFiles", CodecMap{{"paths", CodecList{"/a", "/b"}}},
+           40, MethodCallOutcome::kError, 12);
+    Record(&recorder, "GetRandomBytes", CodecMap{{"length", int32_t{16}}}, 250);
+    recorder.Record("GetStartupTimeline", nullptr, 0, 300,
+                    MethodCallOutcome::kNotImplemented, 0);
+    EXPECT_EQ(recorder.records(), 4u);
+  }
+
+  std::vector<MethodCallRecord> records = ReadMethodCallLog(path_);
+  ASSERT_EQ(records.size(), 4u);
+  EXPECT_EQ(records[0].method, "GetRandomBytes");
+  EXPECT_EQ(records[0].start_us, 100);
+  EXPECT_EQ(records[0].result_bytes, 33u);
+  EXPECT_EQ(records[0].arguments,
+            EncodeStandardValue(CodecMap{{"length", int32_t{32}}}));
+  EXPECT_EQ(records[1].method, "HashFiles");
+  EXPECT_EQ(records[1].start_us, 40);  // Earlier than the previous record.
+  EXPECT_EQ(records[1].outcome, MethodCallOutcome::kError);
+  EXPECT_EQ(records[2].method, "GetRandomBytes");
+  EXPECT_EQ(records[2].start_us, 250);
+  EXPECT_EQ(records[3].outcome, MethodCallOutcome::kNotImplemented);
+  EXPECT_TRUE(records[3].arguments.empty());
+  for (const MethodCallRecord& record : records) {
+    EXPECT_GE(record.duration_us, 0);
+  }
+}
+
+TEST_F(MethodCallLogTest, RepeatedCallsCostAboutTenBytesPlusArguments) {
+  const CodecValue arguments = CodecMap{{"length", int32_t{16}}};
+  const size_t arguments_len = EncodeStandardValue(arguments).size();
+  {
+    MethodCallRecorder recorder(path_);
+    for (int64_t i = 0; i < 1000; ++i) {
+      Record(&recorder, "GetRandomBytes", arguments, i * 250,
+             MethodCallOutcome::kSuccess, 19);
+    }
+  }
+  EXPECT_LT(ReadBytes().size(), 8 + 32 + 1000 * (arguments_len + 10));
+  EXPECT_EQ(ReadMethodCallLog(path_).size(), 1000u);
+}
+
+TEST_F(MethodCallLogTest, RedactsSecretsButKeepsSizes) {
+  {
+    MethodCallRecorder recorder(path_);
+    Record(&recorder, "Unlock",
+           CodecMap{{"userPassword", "hunter2"},
+                    {"keyName", "app-key"},
+                    {"data", std::vector<uint8_t>{1, 2, 3}},
+                    {"options",
+                     CodecMap{{"apiToken", CodecList{"t1", int32_t{5}}},
+                              {"retries", int32_t{3}}}}},
+           0);
+  }
+  std::vector<MethodCallRecord> records = ReadMethodCallLog(path_);
+  ASSERT_EQ(records.size(), 1u);
+  CodecValue arguments = DecodeStandardValue(records[0].arguments.data(),
+                                             records[0].arguments.size());
+  const CodecMap& map = std::get<CodecMap>(arguments);
+  EXPECT_EQ(*FindCodecMapValue(map, "userPassword"), CodecValue("*******"));
+  EXPECT_EQ(*FindCodecMapValue(map, "keyName"), CodecValue("app-key"));
+  EXPECT_EQ(*FindCodecMapValue(map, "data"),
+            CodecValue(std::vector<uint8_t>(3, 0)));
+  const CodecMap& options =
+      std::get<CodecMap>(*FindCodecMapValue(map, "options"));
+  EXPECT_EQ(*FindCodecMapValue(options, "apiToken"),
+            CodecValue(CodecList{"**", int32_t{0}}));
+  EXPECT_EQ(*FindCodecMapValue(options, "retries"), CodecValue(int32_t{3}));
+
+  // Nothing of the secret reaches the file.
+  std::vector<uint8_t> bytes = ReadBytes();
+  std::string text(bytes.begin(), bytes.end());
+  EXPECT_EQ(text.find("hunter2"), std::string::npos);
+}
+
+TEST_F(MethodCallLogTest, DropsArgumentsThatDoNotDecode) {
+  {
+    MethodCallRecorder recorder(path_);
+    const uint8_t garbage[] = {7, 200, 's', 'e', 'c', 'r', 'e', 't'};
+    recorder.Record("Odd", garbage, sizeof(garbage), 0,
+                    MethodCallOutcome::kSuccess, 0);
+  }
+  std::vector<MethodCallRecord> records = ReadMethodCallLog(path_);
+  ASSERT_EQ(records.size(), 1u);
+  EXPECT_TRUE(records[0].arguments.empty());
+}
+
+TEST_F(MethodCallLogTest, ToleratesATornTailButNotCorruption) {
+  {
+    MethodCallRecorder recorder(path_);
+    Record(&recorder, "A", CodecMap{{"x", int32_t{1}}}, 0);
+    Record(&recorder, "A", CodecMap{{"x", int32_t{2}}}, 10);
+  }
+  std::vector<uint8_t> bytes = ReadBytes();
+  // A crash mid-write loses only the last record.
+  EXPECT_EQ(ParseMethodCallLog(bytes.data(), bytes.size() - 3).size(), 1u);
+
+  std::vector<uint8_t> bad_id = bytes;
+  bad_id[8] = 5;  // The first record refers to a name never introduced.
+  EXPECT_THROW(ParseMethodCallLog(bad_id.data(), bad_id.size()),
+               std::runtime_error);
+  std::vector<uint8_t> bad_magic = bytes;
+  bad_magic[0] = 'X';
+  EXPECT_THROW(ParseMethodCallLog(bad_magic.data(), bad_magic.size()),
+               std::runtime_error);
+  EXPECT_THROW(ReadMethodCallLog(path_ + ".missing"), std::runtime_error);
+}
+
+TEST(MethodCallReplay, ReplaysAtOriginalSpeedAgainstTheSimulatedBackend) {
+  std::vector<MethodCallRecord> records = {
+      Call("HashFiles", 30000, 5000),
+      Call("GetRandomBytes", 0, 100),
+      Call("GetRandomBytes", 10000, 100),
+  };
+  SimulatedBackend backend;
+  ReplayReport report = ReplayMethodCalls(
+      records, [&backend](const MethodCallRecord& record, ReplayDone done) {
+        backend.Dispatch(record, std::move(done));
+      });
+
+  EXPECT_EQ(report.calls, 3u);
+  EXPECT_EQ(report.outcome_mismatches, 0u);
+  EXPECT_EQ(report.result_bytes, 30u);
+  // The last call is issued 30 ms in and takes 5 ms.
+  EXPECT_GE(report.elapsed_seconds, 0.035);
+  ASSERT_EQ(report.latency_by_method.size(), 2u);
+  EXPECT_EQ(report.latency_by_method["GetRandomBytes"].count, 2u);
+  EXPECT_GE(report.latency_by_method["HashFiles"].p50_us, 5000);
+  EXPECT_GE(report.latency.max_us, 5000);
+  EXPECT_EQ(report.issue_lag.count, 3u);
+}
+
+TEST(MethodCallReplay, MaximumSpeedIgnoresGapsAndBoundsInFlight) {
+  std::vector<MethodCallRecord> records;
+  for (int i = 0; i < 20; ++i) {
+    records.push_back(Call("Encrypt", i * 1000000, 1000));
+  }
+  std::atomic<int> in_flight{0};
+  int peak = 0;
+  std::vector<std::thread> threads;
+  ReplayOptions options;
+  options.speed = ReplaySpeed::kMaximum;
+  options.max_in_flight = 4;
+  ReplayReport report = ReplayMethodCalls(
+      records,
+      [&](const MethodCallRecord&, ReplayDone done) {
+        peak = std::max(peak, ++in_flight);
+        threads.emplace_back([&in_flight, done]() {
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          --in_flight;
+          done(MethodCallOutcome::kError, 0);
+        });
+      },
+      options);
+  for (std::thread& thread : threads) thread.join();
+
+  EXPECT_EQ(report.calls, 20u);
+  EXPECT_EQ(report.outcome_mismatches, 20u);
+  EXPECT_LE(peak, 4);
+  EXPECT_LT(report.elapsed_seconds, 1.0);
+  EXPECT_EQ(report.issue_lag.count, 0u);
+}
+
+TEST(MethodCallReplay, SummarizesLatencies) {
+  std::vector<int64_t> latencies;
+  for (int64_t i = 100; i >= 1; --i) latencies.push_back(i);
+  LatencySummary summary = SummarizeLatencies(&latencies);
+  EXPECT_EQ(summary.count, 100u);
+  EXPECT_DOUBLE_EQ(summary.mean_us, 50.5);
+  EXPECT_EQ(summary.p50_us, 51);
+  EXPECT_EQ(summary.p90_us, 91);
+  EXPECT_EQ(summary.p99_us, 100);
+  EXPECT_EQ(summary.max_us, 100);
+
+  std::vector<int64_t> none;
+  EXPECT_EQ(SummarizeLatencies(&none).count, 0u);
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "nonce_replay_filter.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+using Clock = NonceReplayFilter::Clock;
+
+// A 16-byte nonce distinct per |index|.
+std::vector<uint8_t> Nonce(uint64_t index) {
+  std::vector<uint8_t> nonce(16, 0xa5);
+  for (int i = 0; i < 8; ++i) nonce[i] = static_cast<uint8_t>(index >> (8 * i));
+  return nonce;
+}
+
+bool Record(NonceReplayFilter& filter, uint64_t index, Clock::time_point now) {
+  const std::vector<uint8_t> nonce = Nonce(index);
+  return filter.CheckAndRecord(nonce.data(), nonce.size(), now);
+}
+
+}  // namespace
+
+TEST(NonceReplayFilter, RejectsNoncesSeenWithinTheWindow) {
+  const Clock::time_point start = Clock::now();
+  NonceReplayFilterOptions options;
+  options.capacity = 10000;
+  NonceReplayFilter filter(options, start);
+
+  size_t accepted = 0;
+  for (uint64_t i = 0; i < 1000; ++i) accepted += Record(filter, i, start);
+  EXPECT_EQ(accepted, 1000u);
+  for (uint64_t i = 0; i < 1000; ++i) {
+    EXPECT_FALSE(Record(filter, i, start + std::chrono::seconds(1)));
+  }
+  // A nonce is the whole byte string, not a prefix of it.
+  const std::vector<uint8_t> nonce = Nonce(0);
+  EXPECT_TRUE(filter.CheckAndRecord(nonce.data(), nonce.size() - 1, start));
+}
+
+TEST(NonceReplayFilter, ForgetsNoncesOnceTheWindowHasPassed) {
+  const Clock::time_point start = Clock::now();
+  NonceReplayFilterOptions options;
+  options.window = std::chrono::seconds(3);
+  options.generations = 4;
+  NonceReplayFilter filter(options, start);
+
+  ASSERT_TRUE(Record(filter, 7, start + std::chrono::milliseconds(999)));
+  // Remembered for the window from when it was seen, checked each second.
+  for (int second = 1; second <= 3; ++second) {
+    EXPECT_FALSE(Record(filter, 7,
+                        start + std::chrono::milliseconds(999) +
+                            std::chrono::seconds(second)))
+        << second;
+  }
+  // Gone at most a generation after that.
+  EXPECT_TRUE(Record(filter, 7, start + std::chrono::seconds(5)));
+
+  // After an idle spell of many windows every generation is clear.
+  ASSERT_TRUE(Record(filter, 8, start + std::chrono::seconds(6)));
+  EXPECT_TRUE(Record(filter, 8, start + std::chrono::hours(1)));
+  EXPECT_FALSE(Record(filter, 8, start + std::chrono::hours(1)));
+}
+
+TEST(NonceReplayFilter, AcceptsEachNonceOnceUnderConcurrentCalls) {
+  constexpr uint64_t kNonces = 20000;
+  constexpr size_t kThreads = 8;
+  const Clock::time_point start = Clock::now();
+  NonceReplayFilter filter(NonceReplayFilterOptions(), start);
+
+  std::vector<std::atomic<int>> accepted(kNonces);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&filter, &accepted, start]() {
+      for (uint64_t i = 0; i < kNonces; ++i) {
+        if (Record(filter, i, start)) accepted[i].fetch_add(1);
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  size_t total = 0;
+  for (uint64_t i = 0; i < kNonces; ++i) {
+    ASSERT_LE(accepted[i].load(), 1) << i;
+    total += accepted[i].load();
+  }
+  // Anything missing was a false positive.
+  EXPECT_GE(total, kNonces - kNonces / 1000);
+}
+
+TEST(NonceReplayFilter, KeepsFalsePositivesRareAtCapacity) {
+  const Clock::time_point start = Clock::now();
+  NonceReplayFilterOptions options;
+  options.capacity = 30000;
+  NonceReplayFilter filter(options, start);
+
+  // The window's nonces spread over the generations it spans.
+  const auto generation = options.window / (options.generations - 1);
+  const uint64_t per_generation = options.capacity / (options.generations - 1);
+  for (uint64_t i = 0; i < options.capacity; ++i) {
+    Record(filter, i, start + generation * (i / per_generation));
+  }
+  // Probed once the window is full, a generation's worth of new nonces.
+  const Clock::time_point end = start + generation * (options.generations - 1);
+  size_t false_positives = 0;
+  for (uint64_t i = 0; i < per_generation; ++i) {
+    false_positives += !Record(filter, (uint64_t{1} << 40) + i, end);
+  }
+  // About 0.1% expected.
+  EXPECT_LT(false_positives, per_generation * 3 / 1000);
+  EXPECT_LE(filter.memory_bytes(),
+            options.capacity * options.bits_per_nonce / 8 *
+                options.generations / (options.generations - 1) +
+                options.generations * 8 + 64);
+}
+
+TEST(NonceReplayFilter, RejectsInvalidOptions) {
+  NonceReplayFilterOptions options;
+  options.window = std::chrono::milliseconds(0);
+  EXPECT_THROW(NonceReplayFilter{options}, std::invalid_argument);
+  options = NonceReplayFilterOptions();
+  options.capacity = 0;
+  EXPECT_THROW(NonceReplayFilter{options}, std::invalid_argument);
+  options = NonceReplayFilterOptions();
+  options.generations = 1;
+  EXPECT_THROW(NonceReplayFilter{options}, std::invalid_argument);
+  options = NonceReplayFilterOptions();
+  options.capacity = size_t{1} << 30;
+  EXPECT_THROW(NonceReplayFilter{options}, std::invalid_argument);
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
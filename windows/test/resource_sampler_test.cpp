@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "allocation_stats.h"
+#include "resource_sampler.h"
+#include "spsc_ring_buffer.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+// Backend whose counters advance by a fixed amount on every read.
+class FakeResourceBackend : public ResourceBackend {
+ public:
+  bool ReadCounters(ResourceCounters* out) override {
+    ++reads_;
+    out->cpu_busy_ticks = reads_ * 25;
+    out->cpu_total_ticks = reads_ * 100;
+    out->core_count = 2;
+    out->core_busy_ticks[0] = reads_ * 10;
+    out->core_total_ticks[0] = reads_ * 50;
+    out->core_busy_ticks[1] = reads_ * 50;
+    out->core_total_ticks[1] = reads_ * 50;
+    out->memory_total_bytes = 1000;
+    out->memory_available_bytes = 400;
+    out->net_rx_bytes = reads_ * 1000;
+    return true;
+  }
+
+ private:
+  uint64_t reads_ = 0;
+};
+
+}  // namespace
+
+TEST(SpscRingBuffer, PreservesOrderAndCountsDrops) {
+  SpscRingBuffer<int> buffer(3);
+  ASSERT_EQ(buffer.capacity(), 4u);
+  for (int i = 0; i < 6; ++i) buffer.TryPush(i);
+  EXPECT_EQ(buffer.dropped(), 2u);
+
+  int out[8];
+  ASSERT_EQ(buffer.PopBatch(out, 8), 4u);
+  for (int i = 0; i < 4; ++i) EXPECT_EQ(out[i], i);
+  EXPECT_FALSE(buffer.TryPop(out));
+}
+
+TEST(SpscRingBuffer, TransfersAcrossThreads) {
+  SpscRingBuffer<uint64_t> buffer(64);
+  constexpr uint64_t kCount = 100000;
+  std::thread producer([&buffer] {
+    for (uint64_t i = 0; i < kCount;) {
+      if (buffer.TryPush(i)) {
+        ++i;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+  uint64_t expected = 0;
+  uint64_t value;
+  while (expected < kCount) {
+    if (buffer.TryPop(&value)) {
+      ASSERT_EQ(value, expected);
+      ++expected;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+}
+
+TEST(ProcResourceBackend, ParsesFixtureTree) {
+  ProcResourceBackend backend(FLUTTER_NATIVE_UTILS_FIXTURES_DIR "/proc");
+  ResourceCounters counters;
+  ASSERT_TRUE(backend.ReadCounters(&counters));
+
+  EXPECT_EQ(counters.cpu_busy_ticks, 5200u);
+  EXPECT_EQ(counters.cpu_total_ticks, 25700u);
+  ASSERT_EQ(counters.core_count, 2u);
+  EXPECT_EQ(counters.core_busy_ticks[0], 2600u);
+  EXPECT_EQ(counters.core_total_ticks[0], 12850u);
+  EXPECT_EQ(counters.memory_total_bytes, 16384000ull * 1024);
+  EXPECT_EQ(counters.memory_available_bytes, 8192000ull * 1024);
+  // Loop devices and partitions are excluded.
+  EXPECT_EQ(counters.disk_read_bytes, 80000ull * 512);
+  EXPECT_EQ(counters.disk_write_bytes, 50000ull * 512);
+  // Loopback is excluded.
+  EXPECT_EQ(counters.net_rx_bytes, 1024000u);
+  EXPECT_EQ(counters.net_tx_bytes, 256000u);
+}
+
+TEST(ProcResourceBackend, ReadsWithoutAllocating) {
+  if (!AllocationTrackingEnabled()) {
+    GTEST_SKIP() << "allocation_hooks.cpp is not linked into this build";
+  }
+  ProcResourceBackend backend(FLUTTER_NATIVE_UTILS_FIXTURES_DIR "/proc");
+  ResourceCounters counters;
+  ASSERT_TRUE(backend.ReadCounters(&counters));
+
+  uint64_t allocations = 0;
+  {
+    AllocationScope scope("ReadCounters");
+    for (int i = 0; i < 10; ++i) ASSERT_TRUE(backend.ReadCounters(&counters));
+    allocations = scope.allocations();
+  }
+  EXPECT_EQ(allocations, 0u);
+  EXPECT_EQ(counters.disk_read_bytes, 80000ull * 512);
+}
+
+TEST(ProcResourceBackend, FailsWhenStatIsMissing) {
+  ProcResourceBackend backend(FLUTTER_NATIVE_UTILS_FIXTURES_DIR "/missing");
+  ResourceCounters counters;
+  EXPECT_FALSE(backend.ReadCounters(&counters));
+}
+
+TEST(ResourceSampler, RejectsOutOfRangeRates) {
+  ResourceSampler sampler(std::make_unique<FakeResourceBackend>());
+  EXPECT_THROW(sampler.Start(5, 10, nullptr), std::invalid_argument);
+  EXPECT_THROW(sampler.Start(2000, 10, nullptr), std::invalid_argument);
+  EXPECT_THROW(sampler.Start(100, 0, nullptr), std::invalid_argument);
+}
+
+TEST(ResourceSampler, DeliversBatchesOfDerivedSamples) {
+  ResourceSampler sampler(std::make_unique<FakeResourceBackend>());
+  std::atomic<int> batches{0};
+  sampler.Start(1000, 5, [&batches] { batches.fetch_add(1); });
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (batches.load() < 2 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  sampler.Stop();
+  ASSERT_GE(batches.load(), 2);
+
+  std::vector<ResourceSample> samples;
+  ASSERT_GE(sampler.Drain(&samples, 1024), 10u);
+  const ResourceSample& sample = samples.front();
+  EXPECT_FLOAT_EQ(sample.cpu_total, 0.25f);
+  ASSERT_EQ(sample.core_count, 2u);
+  EXPECT_FLOAT_EQ(sample.cpu_per_core[0], 0.2f);
+  EXPECT_FLOAT_EQ(sample.cpu_per_core[1], 1.0f);
+  EXPECT_EQ(sample.memory_available_bytes, 400u);
+  EXPECT_GT(sample.net_rx_bytes_per_sec, 0.0);
+
+  ResourceSamplerStats stats = sampler.stats();
+  EXPECT_EQ(stats.samples, samples.size());
+  EXPECT_EQ(stats.dropped, 0u);
+  EXPECT_GE(stats.cpu_overhead, 0.0);
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
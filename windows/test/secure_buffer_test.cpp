@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <cwchar>
+#include <memory>
+#include <vector>
+
+#include "secure_buffer.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+bool AllZero(const void* data, size_t len) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < len; ++i) {
+    if (bytes[i] != 0) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(SecureBufferPool, RoundsRequestsUpToSizeClasses) {
+  EXPECT_EQ(SecureBufferPool::CapacityFor(1), SecureBufferPool::kMinClassLen);
+  EXPECT_EQ(SecureBufferPool::CapacityFor(32), 32u);
+  EXPECT_EQ(SecureBufferPool::CapacityFor(33), 64u);
+  EXPECT_EQ(SecureBufferPool::CapacityFor(3000), 4096u);
+  EXPECT_EQ(SecureBufferPool::CapacityFor(SecureBufferPool::kMaxClassLen),
+            SecureBufferPool::kMaxClassLen);
+  EXPECT_GT(SecureBufferPool::CapacityFor(SecureBufferPool::kMaxClassLen + 1),
+            SecureBufferPool::kMaxClassLen);
+}
+
+TEST(SecureBufferPool, RecyclesZeroizedBuffers) {
+  SecureBufferPool pool;
+  uint8_t* first = static_cast<uint8_t*>(pool.Allocate(100));
+  ASSERT_TRUE(AllZero(first, 128));
+  std::memset(first, 0xab, 100);
+  pool.Free(first, 100);
+  // The freed buffer itself must be wiped, not just the next allocation.
+  EXPECT_TRUE(AllZero(first, 128));
+
+  uint8_t* second = static_cast<uint8_t*>(pool.Allocate(120));
+  EXPECT_EQ(second, first);
+  EXPECT_TRUE(AllZero(second, 120));
+  pool.Free(second, 120);
+
+  SecureBufferPoolStats stats = pool.stats();
+  EXPECT_EQ(stats.allocations, 2u);
+  EXPECT_EQ(stats.reused, 1u);
+  EXPECT_EQ(stats.bytes_in_use, 0u);
+  // Locking is best effort; either outcome must be accounted for.
+  EXPECT_TRUE(stats.locked_bytes > 0 || stats.lock_failures > 0);
+}
+
+TEST(SecureBufferPool, KeepsSizeClassesApart) {
+  SecureBufferPool pool;
+  std::vector<void*> buffers;
+  for (size_t len = 1; len <= SecureBufferPool::kMaxClassLen; len *= 3) {
+    void* data = pool.Allocate(len);
+    std::memset(data, 0xff, len);
+    buffers.push_back(data);
+  }
+  for (size_t i = 0, len = 1; len <= SecureBufferPool::kMaxClassLen;
+       ++i, len *= 3) {
+    pool.Free(buffers[i], len);
+  }
+  EXPECT_EQ(pool.stats().bytes_in_use, 0u);
+}
+
+TEST(SecureBufferPool, ServesLargeRequestsFromDedicatedMappings) {
+  SecureBufferPool pool;
+  const size_t len = SecureBufferPool::kMaxClassLen * 2 + 5;
+  uint8_t* data = static_cast<uint8_t*>(pool.Allocate(len));
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(data) % 16, 0u);
+  EXPECT_TRUE(AllZero(data, len));
+  std::memset(data, 0x5a, len);
+  EXPECT_GT(pool.stats().bytes_in_use, len);
+  pool.Free(data, len);
+  EXPECT_EQ(pool.stats().bytes_in_use, 0u);
+}
+
+TEST(SecureBufferPool, GuardPageCatchesOverrunPastLargeBuffer) {
+  SecureBufferPool pool;
+  const size_t len = SecureBufferPool::kMaxClassLen + 4096;
+  volatile uint8_t* data = static_cast<uint8_t*>(pool.Allocate(len));
+  EXPECT_DEATH(
+      {
+        for (size_t i = 0; i < len + 64; ++i) data[i] = 1;
+      },
+      "");
+  pool.Free(const_cast<uint8_t*>(data), len);
+}
+
+TEST(SecureBufferPool, GuardPageCatchesOverrunPastSlab) {
+  SecureBufferPool pool;
+  // A maximum-class buffer fills its slab exactly.
+  const size_t len = SecureBufferPool::kMaxClassLen;
+  volatile uint8_t* data = static_cast<uint8_t*>(pool.Allocate(len));
+  EXPECT_DEATH(
+      {
+        for (size_t i = 0; i <= len; ++i) data[i] = 1;
+      },
+      "");
+  pool.Free(const_cast<uint8_t*>(data), len);
+}
+
+TEST(SecureAllocator, BacksStandardContainers) {
+  SecureBytes bytes(1000, 7);
+  bytes.resize(5000, 9);
+  EXPECT_EQ(bytes[999], 7);
+  EXPECT_EQ(bytes[4999], 9);
+
+  SecureWideChars text = {L'p', L'w', L'\0'};
+  EXPECT_EQ(std::wcslen(text.data()), 2u);
+
+  struct Key {
+    uint8_t bytes[32];
+  };
+  auto key = std::allocate_shared<Key>(SecureAllocator<Key>());
+  EXPECT_TRUE(AllZero(key->bytes, sizeof(key->bytes)));
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
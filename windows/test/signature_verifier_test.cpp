@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "signature_verifier.h"
+#include "worker_pool.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+// The manifest fixture doubles as a signed message.
+const std::string kFixtureDir =
+    FLUTTER_NATIVE_UTILS_FIXTURES_DIR "/manifest";
+
+std::vector<uint8_t> ReadBytes(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(file),
+                              std::istreambuf_iterator<char>());
+}
+
+class SignatureVerifierTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    message_ = ReadBytes(kFixtureDir + "/manifest.txt");
+    signature_ = ReadBytes(kFixtureDir + "/manifest.sig");
+    keys_.Import("release", ReadBytes(kFixtureDir + "/public_key.blob"));
+  }
+
+  SignatureCheck Check(const std::vector<uint8_t>& message,
+                       const std::string& key_id) const {
+    SignatureCheck check;
+    check.message = message.data();
+    check.message_len = message.size();
+    check.signature = signature_.data();
+    check.signature_len = signature_.size();
+    check.key = keys_.Find(key_id);
+    return check;
+  }
+
+  std::vector<uint8_t> message_;
+  std::vector<uint8_t> signature_;
+  PublicKeyTable keys_;
+  WorkerPool pool_{3};
+};
+
+}  // namespace
+
+TEST_F(SignatureVerifierTest, SetsOneBitPerCheck) {
+  std::vector<uint8_t> tampered = message_;
+  tampered[0] ^= 1;
+
+  // Enough checks to span several tasks and a partial last byte.
+  constexpr size_t kCount = 203;
+  std::vector<SignatureCheck> checks;
+  for (size_t i = 0; i < kCount; ++i) {
+    if (i % 7 == 3) {
+      checks.push_back(Check(tampered, "release"));
+    } else if (i == 100) {
+      checks.push_back(Check(message_, "unknown"));
+    } else {
+      checks.push_back(Check(message_, "release"));
+    }
+  }
+
+  SignatureBitmap bitmap = VerifySignatures(checks, &pool_);
+  ASSERT_EQ(bitmap.size(), (kCount + 7) / 8);
+  for (size_t i = 0; i < kCount; ++i) {
+    EXPECT_EQ(SignatureBitmapTest(bitmap, i), i % 7 != 3 && i != 100)
+        << "check " << i;
+  }
+  EXPECT_EQ(bitmap.back() >> (kCount % 8), 0);
+}
+
+TEST_F(SignatureVerifierTest, EmptyBatchCompletes) {
+  EXPECT_TRUE(VerifySignatures({}, &pool_).empty());
+}
+
+TEST_F(SignatureVerifierTest, KeyTableReplacesAndRemovesKeys) {
+  std::shared_ptr<const RsaPublicKey> original = keys_.Find("release");
+  keys_.Import("release", ReadBytes(kFixtureDir + "/public_key.blob"));
+  EXPECT_EQ(keys_.Find("release"), original);  // Identical blob: not reparsed.
+
+  EXPECT_THROW(keys_.Import("bad", {1, 2, 3}), std::invalid_argument);
+  EXPECT_EQ(keys_.Find("bad"), nullptr);
+
+  // A removed key stays usable by a check that already holds it.
+  SignatureCheck check = Check(message_, "release");
+  EXPECT_TRUE(keys_.Remove("release"));
+  EXPECT_FALSE(keys_.Remove("release"));
+  EXPECT_EQ(keys_.size(), 0u);
+  EXPECT_TRUE(SignatureBitmapTest(VerifySignatures({check}, &pool_), 0));
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "standard_codec.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+TEST(StandardCodec, EncodesLikeTheFlutterCodec) {
+  // {"length": 16}
+  EXPECT_EQ(EncodeStandardValue(CodecMap{{"length", int32_t{16}}}),
+            (std::vector<uint8_t>{13, 1, 7, 6, 'l', 'e', 'n', 'g', 't', 'h', 3,
+                                  16, 0, 0, 0}));
+  // Doubles and typed lists are aligned relative to the message start.
+  EXPECT_EQ(EncodeStandardValue(CodecValue(1.0)),
+            (std::vector<uint8_t>{6, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                  0xf0, 0x3f}));
+  EXPECT_EQ(EncodeStandardValue(CodecValue(std::vector<int32_t>{-1})),
+            (std::vector<uint8_t>{9, 1, 0, 0, 0xff, 0xff, 0xff, 0xff}));
+  // Sizes of 254 and up take a marker and two or four bytes.
+  std::vector<uint8_t> encoded =
+      EncodeStandardValue(CodecValue(std::vector<uint8_t>(300, 7)));
+  ASSERT_EQ(encoded.size(), 1u + 3u + 300u);
+  EXPECT_EQ(encoded[1], 254);
+  EXPECT_EQ(encoded[2] | (encoded[3] << 8), 300);
+  EXPECT_EQ(EncodeStandardValue(CodecValue(std::vector<uint8_t>(70000)))[1],
+            255);
+}
+
+TEST(StandardCodec, RoundTripsEveryType) {
+  CodecValue value = CodecList{
+      CodecValue(),
+      true,
+      false,
+      int32_t{-7},
+      int64_t{1} << 40,
+      3.25,
+      "text",
+      std::vector<uint8_t>{1, 2, 3},
+      std::vector<int32_t>{1, -2},
+      std::vector<int64_t>{int64_t{1} << 50},
+      std::vector<double>{0.5, -0.25},
+      CodecMap{{int32_t{1}, "one"}, {"nested", CodecList{"a", int32_t{2}}}},
+      std::vector<float>{1.5f},
+      std::string(1000, 'x'),
+  };
+  std::vector<uint8_t> encoded = EncodeStandardValue(value);
+  EXPECT_EQ(DecodeStandardValue(encoded.data(), encoded.size()), value);
+
+  const CodecMap& map = std::get<CodecMap>(std::get<CodecList>(value)[11]);
+  ASSERT_NE(FindCodecMapValue(map, "nested"), nullptr);
+  EXPECT_EQ(FindCodecMapValue(map, "missing"), nullptr);
+}
+
+TEST(StandardCodec, RejectsMalformedInput) {
+  std::vector<uint8_t> encoded =
+      EncodeStandardValue(CodecMap{{"paths", CodecList{"a", "b"}}});
+  for (size_t len = 0; len < encoded.size(); ++len) {
+    EXPECT_THROW(DecodeStandardValue(encoded.data(), len),
+                 std::invalid_argument)
+        << len;
+  }
+  encoded.push_back(0);
+  EXPECT_THROW(DecodeStandardValue(encoded.data(), encoded.size()),
+               std::invalid_argument);
+
+  const uint8_t unknown[] = {42};
+  EXPECT_THROW(DecodeStandardValue(unknown, sizeof(unknown)),
+               std::invalid_argument);
+  // A list claiming more elements than there are bytes.
+  const uint8_t huge[] = {12, 255, 0xff, 0xff, 0xff, 0x7f};
+  EXPECT_THROW(DecodeStandardValue(huge, sizeof(huge)), std::invalid_argument);
+  // Nesting deeper than any real message.
+  std::vector<uint8_t> deep(1000, 12);
+  for (size_t i = 1; i < deep.size(); i += 2) deep[i] = 1;
+  EXPECT_THROW(DecodeStandardValue(deep.data(), deep.size()),
+               std::invalid_argument);
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "startup_timeline.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+struct Backend {
+  explicit Backend(int value) : value(value) {}
+  int value;
+};
+
+}  // namespace
+
+TEST(StartupTimeline, RecordsEventsInCompletionOrder) {
+  StartupTimeline timeline;
+  const int64_t start = timeline.Now();
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  timeline.Record("plugin", StartupPhase::kRegistration, start);
+  timeline.Record("index", StartupPhase::kPrewarm, timeline.Now(), "denied");
+
+  std::vector<StartupEvent> events = timeline.events();
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].backend, "plugin");
+  EXPECT_EQ(events[0].phase, StartupPhase::kRegistration);
+  EXPECT_EQ(events[0].start_us, start);
+  EXPECT_GE(events[0].duration_us, 2000);
+  EXPECT_TRUE(events[0].error.empty());
+  EXPECT_EQ(events[1].error, "denied");
+  EXPECT_GE(events[1].start_us, events[0].start_us + events[0].duration_us);
+
+  EXPECT_STREQ(StartupPhaseName(StartupPhase::kFirstUse), "firstUse");
+  EXPECT_STREQ(StartupPhaseName(StartupPhase::kPrewarm), "prewarm");
+}
+
+TEST(LazyBackend, CreatesOnceOnFirstUse) {
+  StartupTimeline timeline;
+  int created = 0;
+  LazyBackend<Backend> lazy("backend", &timeline, [&created]() {
+    ++created;
+    return std::make_unique<Backend>(7);
+  });
+  EXPECT_EQ(lazy.GetIfCreated(), nullptr);
+  EXPECT_TRUE(timeline.events().empty());
+
+  Backend* backend = lazy.Get();
+  EXPECT_EQ(backend->value, 7);
+  EXPECT_EQ(lazy.Get(StartupPhase::kPrewarm), backend);
+  EXPECT_EQ(lazy.GetIfCreated(), backend);
+  EXPECT_EQ(created, 1);
+
+  std::vector<StartupEvent> events = timeline.events();
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].backend, "backend");
+  EXPECT_EQ(events[0].phase, StartupPhase::kFirstUse);
+}
+
+TEST(LazyBackend, ConcurrentFirstCallsShareOneCreation) {
+  StartupTimeline timeline;
+  std::atomic<int> created{0};
+  LazyBackend<Backend> lazy("slow", &timeline, [&created]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    return std::make_unique<Backend>(++created);
+  });
+
+  std::vector<Backend*> seen(8);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < seen.size(); ++i) {
+    threads.emplace_back([&lazy, &seen, i]() {
+      seen[i] = lazy.Get(StartupPhase::kPrewarm);
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  EXPECT_EQ(created.load(), 1);
+  for (Backend* backend : seen) EXPECT_EQ(backend, seen[0]);
+  ASSERT_EQ(timeline.events().size(), 1u);
+  EXPECT_EQ(timeline.events()[0].phase, StartupPhase::kPrewarm);
+  EXPECT_GE(timeline.events()[0].duration_us, 5000);
+}
+
+TEST(LazyBackend, RecordsFailuresAndRetries) {
+  StartupTimeline timeline;
+  bool fail = true;
+  LazyBackend<Backend> lazy("flaky", &timeline, [&fail]() {
+    if (fail) throw std::runtime_error("provider unavailable");
+    return std::make_unique<Backend>(1);
+  });
+
+  EXPECT_THROW(lazy.Get(StartupPhase::kPrewarm), std::runtime_error);
+  EXPECT_EQ(lazy.GetIfCreated(), nullptr);
+  fail = false;
+  EXPECT_NE(lazy.Get(), nullptr);
+
+  std::vector<StartupEvent> events = timeline.events();
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].phase, StartupPhase::kPrewarm);
+  EXPECT_EQ(events[0].error, "provider unavailable");
+  EXPECT_EQ(events[1].phase, StartupPhase::kFirstUse);
+  EXPECT_TRUE(events[1].error.empty());
+}
+
+TEST(LazyBackend, CloseDestroysAndRefusesToRecreate) {
+  StartupTimeline timeline;
+  auto destroyed = std::make_shared<int>(0);
+  struct Tracked {
+    explicit Tracked(std::shared_ptr<int> count) : count(std::move(count)) {}
+    ~Tracked() { ++*count; }
+    std::shared_ptr<int> count;
+  };
+  LazyBackend<Tracked> lazy("tracked", &timeline, [destroyed]() {
+    return std::make_unique<Tracked>(destroyed);
+  });
+  lazy.Get();
+  lazy.Close();
+  EXPECT_EQ(*destroyed, 1);
+  EXPECT_EQ(lazy.GetIfCreated(), nullptr);
+  EXPECT_THROW(lazy.Get(), std::runtime_error);
+  EXPECT_EQ(timeline.events().size(), 1u);
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
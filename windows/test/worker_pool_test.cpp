@@ -0,0 +1,247 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "worker_pool.h"
+
+namespace flutter_native_utils {
+namespace test {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int64_t MicrosecondsSince(Clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() -
+                                                               start)
+      .count();
+}
+
+// Polls |done| for up to five seconds.
+template <typename Predicate>
+bool WaitFor(Predicate done) {
+  const Clock::time_point deadline = Clock::now() + std::chrono::seconds(5);
+  while (!done()) {
+    if (Clock::now() > deadline) return false;
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+  }
+  return true;
+}
+
+// Tracks how many tasks of one kind run at once.
+class ConcurrencyProbe {
+ public:
+  void Enter() {
+    const int now = ++running_;
+    int peak = peak_.load();
+    while (now > peak && !peak_.compare_exchange_weak(peak, now)) {
+    }
+  }
+  void Exit() { --running_; }
+  int peak() const { return peak_.load(); }
+
+ private:
+  std::atomic<int> running_{0};
+  std::atomic<int> peak_{0};
+};
+
+// Posts |count| interactive tasks, one every |interval|, onto a pool
+// saturated by bulk tasks of |bulk_task| each, and returns the 99th
+// percentile of the interactive queue waits.
+int64_t InteractiveP99UnderBulkLoad(WorkerPool* pool,
+                                    std::chrono::microseconds bulk_task,
+                                    int count,
+                                    std::chrono::microseconds interval) {
+  for (int i = 0; i < 2000; ++i) {
+    pool->Post([bulk_task]() { std::this_thread::sleep_for(bulk_task); },
+               TaskPriority::kBulk);
+  }
+  std::mutex mutex;
+  std::vector<int64_t> waits;
+  for (int i = 0; i < count; ++i) {
+    const Clock::time_point posted = Clock::now();
+    pool->Post(
+        [&mutex, &waits, posted]() {
+          std::lock_guard<std::mutex> lock(mutex);
+          waits.push_back(MicrosecondsSince(posted));
+        },
+        TaskPriority::kInteractive);
+    std::this_thread::sleep_for(interval);
+  }
+  EXPECT_TRUE(WaitFor([&]() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return waits.size() == static_cast<size_t>(count);
+  }));
+  std::lock_guard<std::mutex> lock(mutex);
+  std::sort(waits.begin(), waits.end());
+  return waits[waits.size() * 99 / 100];
+}
+
+}  // namespace
+
+TEST(WorkerPool, RunsTasksOfEveryClass) {
+  WorkerPool pool(4);
+  std::atomic<int> done{0};
+  for (int i = 0; i < 300; ++i) {
+    pool.Post([&done]() { ++done; }, static_cast<TaskPriority>(i % 3));
+  }
+  ASSERT_TRUE(WaitFor([&]() { return done.load() == 300; }));
+
+  uint64_t started = 0;
+  for (size_t i = 0; i < kTaskPriorityCount; ++i) {
+    TaskClassStats stats = pool.stats(static_cast<TaskPriority>(i));
+    EXPECT_EQ(stats.queued, 0u);
+    EXPECT_LE(stats.p50_wait_us, stats.p99_wait_us);
+    EXPECT_LE(stats.p99_wait_us, stats.max_wait_us);
+    started += stats.started;
+  }
+  EXPECT_EQ(started, 300u);
+  EXPECT_STREQ(TaskPriorityName(TaskPriority::kBulk), "bulk");
+}
+
+TEST(WorkerPool, InteractiveWaitStaysBoundedUnderBulkSaturation) {
+  // Served FIFO, the last interactive task would wait for the whole bulk
+  // backlog: 2000 tasks of 2 ms on two threads, about two seconds.
+  {
+    WorkerPool pool(2);  // One thread is reserved for interactive tasks.
+    EXPECT_LT(InteractiveP99UnderBulkLoad(&pool, std::chrono::milliseconds(2),
+                                          200, std::chrono::milliseconds(1)),
+              50000);
+    EXPECT_EQ(pool.stats(TaskPriority::kInteractive).started, 200u);
+    EXPECT_LT(pool.stats(TaskPriority::kInteractive).p99_wait_us, 65536);
+    EXPECT_GT(pool.stats(TaskPriority::kBulk).queued, 0u);
+  }
+  {
+    // Without the reserve, an interactive task waits for at most one bulk
+    // task to finish.
+    WorkerPoolOptions options;
+    options.thread_count = 2;
+    options.interactive_reserve = 0;
+    WorkerPool pool(options);
+    EXPECT_LT(InteractiveP99UnderBulkLoad(&pool, std::chrono::milliseconds(2),
+                                          200, std::chrono::milliseconds(1)),
+              50000);
+  }
+}
+
+TEST(WorkerPool, SharesThreadsByWeight) {
+  WorkerPoolOptions options;
+  options.thread_count = 1;
+  WorkerPool pool(options);
+  std::promise<void> release;
+  std::shared_future<void> gate = release.get_future().share();
+  pool.Post([gate]() { gate.wait(); }, TaskPriority::kInteractive);
+  ASSERT_TRUE(WaitFor(
+      [&]() { return pool.stats(TaskPriority::kInteractive).running == 1; }));
+
+  std::mutex mutex;
+  std::vector<TaskPriority> order;
+  for (int i = 0; i < 40; ++i) {
+    for (TaskPriority priority : {TaskPriority::kNormal, TaskPriority::kBulk}) {
+      pool.Post(
+          [&mutex, &order, priority]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(priority);
+          },
+          priority);
+    }
+  }
+  release.set_value();
+  ASSERT_TRUE(WaitFor([&]() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return order.size() == 80;
+  }));
+
+  // Weights 4 and 1: one bulk task for every four normal ones while both
+  // have tasks waiting.
+  const auto bulk =
+      std::count(order.begin(), order.begin() + 25, TaskPriority::kBulk);
+  EXPECT_GE(bulk, 4);
+  EXPECT_LE(bulk, 6);
+}
+
+TEST(WorkerPool, PromotesStarvedTasks) {
+  // Time only moves when an interactive task runs, by a millisecond each.
+  std::atomic<int64_t> now_us{0};
+  std::atomic<int> interactive_ran{0};
+  std::atomic<int> ran_before_bulk{-1};
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+
+  WorkerPoolOptions options;
+  options.thread_count = 1;
+  options.classes[static_cast<size_t>(TaskPriority::kInteractive)].weight =
+      1000;
+  options.classes[static_cast<size_t>(TaskPriority::kBulk)]
+      .starvation_limit = std::chrono::milliseconds(20);
+  options.clock = [&now_us]() {
+    return Clock::time_point() + std::chrono::microseconds(now_us.load());
+  };
+  WorkerPool pool(options);
+
+  // Once bulk has had a turn, weights alone would keep it waiting for about
+  // a thousand interactive tasks.
+  pool.Post([]() {}, TaskPriority::kBulk);
+  ASSERT_TRUE(
+      WaitFor([&]() { return pool.stats(TaskPriority::kBulk).started == 1; }));
+  // Holds the thread until everything below is queued.
+  pool.Post([released]() { released.wait(); }, TaskPriority::kInteractive);
+  for (int i = 0; i < 400; ++i) {
+    pool.Post(
+        [&now_us, &interactive_ran]() {
+          now_us += 1000;
+          ++interactive_ran;
+        },
+        TaskPriority::kInteractive);
+  }
+  pool.Post([&]() { ran_before_bulk = interactive_ran.load(); },
+            TaskPriority::kBulk);
+  release.set_value();
+  ASSERT_TRUE(WaitFor([&]() { return interactive_ran.load() == 400; }));
+
+  // It goes at the first pick more than 20 ms after it was queued.
+  EXPECT_EQ(ran_before_bulk.load(), 21);
+  EXPECT_EQ(pool.stats(TaskPriority::kBulk).promoted, 1u);
+  EXPECT_EQ(pool.stats(TaskPriority::kBulk).max_wait_us, 21000);
+}
+
+TEST(WorkerPool, LimitsConcurrencyPerClass) {
+  WorkerPoolOptions options;
+  options.thread_count = 4;
+  options.classes[static_cast<size_t>(TaskPriority::kBulk)].max_running = 2;
+  WorkerPool pool(options);
+
+  ConcurrencyProbe normal;
+  ConcurrencyProbe bulk;
+  ConcurrencyProbe shared;
+  std::atomic<int> done{0};
+  for (int i = 0; i < 40; ++i) {
+    const bool is_bulk = i % 2 == 1;
+    ConcurrencyProbe* probe = is_bulk ? &bulk : &normal;
+    pool.Post(
+        [probe, &shared, &done]() {
+          probe->Enter();
+          shared.Enter();
+          std::this_thread::sleep_for(std::chrono::milliseconds(2));
+          shared.Exit();
+          probe->Exit();
+          ++done;
+        },
+        is_bulk ? TaskPriority::kBulk : TaskPriority::kNormal);
+  }
+  ASSERT_TRUE(WaitFor([&]() { return done.load() == 40; }));
+
+  EXPECT_LE(bulk.peak(), 2);
+  // One of the four threads is kept for interactive tasks.
+  EXPECT_LE(shared.peak(), 3);
+  EXPECT_GE(shared.peak(), 2);
+}
+
+}  // namespace test
+}  // namespace flutter_native_utils
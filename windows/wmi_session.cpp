@@ -0,0 +1,87 @@
+#include "wmi_session.h"
+
+#include <windows.h>
+
+#include <objbase.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <variant>
+#include <vector>
+
+namespace flutter_native_utils {
+
+namespace {
+
+std::string HResultText(HRESULT hres) {
+  std::ostringstream text;
+  text << "0x" << std::hex << static_cast<unsigned long>(hres);
+  return text.str();
+}
+
+// Lends the session's connection to one engine's InventoryEngine, which
+// takes ownership of its provider.
+class BorrowedInventoryProvider : public InventoryProvider {
+ public:
+  explicit BorrowedInventoryProvider(InventoryProvider* provider)
+      : provider_(provider) {}
+
+  std::unique_ptr<InventoryCursor> Open(const InventoryQuery& query) override {
+    return provider_->Open(query);
+  }
+
+ private:
+  InventoryProvider* provider_;
+};
+
+}  // namespace
+
+WmiSession::WmiSession() {
+  HRESULT hres = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+  if (FAILED(hres)) {
+    throw std::runtime_error("CoInitializeEx failed: " + HResultText(hres));
+  }
+  // Process-wide; the app may have set it already.
+  hres = CoInitializeSecurity(nullptr, -1, nullptr, nullptr,
+                              RPC_C_AUTHN_LEVEL_DEFAULT,
+                              RPC_C_IMP_LEVEL_IMPERSONATE, nullptr, EOAC_NONE,
+                              nullptr);
+  if (FAILED(hres) && hres != RPC_E_TOO_LATE) {
+    CoUninitialize();
+    throw std::runtime_error("CoInitializeSecurity failed: " +
+                             HResultText(hres));
+  }
+}
+
+WmiSession::~WmiSession() {
+  // Its COM objects must go before the apartment does; the cursors first,
+  // as they borrow the connection.
+  inventories_.clear();
+  provider_.reset();
+  CoUninitialize();
+}
+
+std::string WmiSession::Query(const std::string& wmi_class,
+                              const std::string& property) {
+  InventoryQuery query;
+  query.class_name = wmi_class;
+  query.columns = {property};
+  std::vector<InventoryRow> rows;
+  provider_->Open(query)->Next(1, &rows);
+  const std::string* value =
+      rows.empty() ? nullptr : std::get_if<std::string>(&rows[0][0]);
+  return value ? *value : "";
+}
+
+InventoryEngine& WmiSession::inventory(int64_t owner) {
+  std::unique_ptr<InventoryEngine>& inventory = inventories_[owner];
+  if (!inventory) {
+    inventory = std::make_unique<InventoryEngine>(
+        std::make_unique<BorrowedInventoryProvider>(provider_.get()));
+  }
+  return *inventory;
+}
+
+void WmiSession::CloseInventory(int64_t owner) { inventories_.erase(owner); }
+
+}  // namespace flutter_native_utils
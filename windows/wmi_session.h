@@ -0,0 +1,49 @@
+#ifndef FLUTTER_PLUGIN_WMI_SESSION_H_
+#define FLUTTER_PLUGIN_WMI_SESSION_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "inventory.h"
+
+namespace flutter_native_utils {
+
+// COM and WMI state of the thread that runs every engine's WMI queries (see
+// BackendHub::wmi). The thread joins the multithreaded apartment once, for
+// its whole life, so queries neither depend on nor disturb the apartment of
+// the thread that asked (the runner's platform thread is
+// apartment-threaded), and the WMI connection is made on first use and kept.
+// Windows only.
+class WmiSession {
+ public:
+  // Throws std::runtime_error if the thread cannot join the apartment.
+  WmiSession();
+  ~WmiSession();
+
+  // Disallow copy and assign.
+  WmiSession(const WmiSession&) = delete;
+  WmiSession& operator=(const WmiSession&) = delete;
+
+  // The first |property| of |wmi_class|, or an empty string if there is
+  // none or it is not a string.
+  std::string Query(const std::string& wmi_class, const std::string& property);
+
+  // The paged queries from Dart of the engine |owner|, with their open
+  // cursors, over the shared connection. Created on first use.
+  InventoryEngine& inventory(int64_t owner);
+
+  // Closes the cursors of |owner|, e.g. when its engine closes.
+  void CloseInventory(int64_t owner);
+
+ private:
+  // The WMI provider connects on first use and keeps the connection.
+  std::unique_ptr<InventoryProvider> provider_ =
+      CreateDefaultInventoryProvider();
+  std::map<int64_t, std::unique_ptr<InventoryEngine>> inventories_;
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_WMI_SESSION_H_
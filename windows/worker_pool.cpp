@@ -0,0 +1,222 @@
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace flutter_native_utils {
+
+namespace {
+
+// Dequeues advance a class's pass by kStride / weight.
+constexpr uint64_t kStride = uint64_t{1} << 20;
+
+}  // namespace
+
+const char* TaskPriorityName(TaskPriority priority) {
+  switch (priority) {
+    case TaskPriority::kInteractive:
+      return "interactive";
+    case TaskPriority::kNormal:
+      return "normal";
+    case TaskPriority::kBulk:
+      return "bulk";
+  }
+  return "normal";
+}
+
+WorkerPool::WorkerPool(size_t thread_count)
+    : WorkerPool([thread_count]() {
+        WorkerPoolOptions options;
+        options.thread_count = thread_count;
+        return options;
+      }()) {}
+
+WorkerPool::WorkerPool(const WorkerPoolOptions& options)
+    : clock_(options.clock) {
+  size_t thread_count = options.thread_count;
+  if (thread_count == 0) thread_count = std::thread::hardware_concurrency();
+  if (thread_count == 0) thread_count = 1;
+
+  shared_threads_ = std::max<size_t>(
+      1, thread_count - std::min(thread_count, options.interactive_reserve));
+  for (size_t i = 0; i < kTaskPriorityCount; ++i) {
+    const TaskClassOptions& class_options = options.classes[i];
+    TaskClass& task_class = classes_[i];
+    task_class.weight = std::max<uint32_t>(1, class_options.weight);
+    task_class.max_running = class_options.max_running == 0
+                                 ? thread_count
+                                 : class_options.max_running;
+    task_class.starvation_limit = class_options.starvation_limit;
+  }
+
+  threads_.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads_.emplace_back(&WorkerPool::WorkerLoop, this);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    for (TaskClass& task_class : classes_) task_class.tasks.clear();
+  }
+  wake_.notify_all();
+  for (auto& thread : threads_) thread.join();
+}
+
+void WorkerPool::Post(std::function<void()> task, TaskPriority priority) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) return;
+    TaskClass& task_class = classes_[static_cast<size_t>(priority)];
+    if (task_class.tasks.empty() && task_class.running == 0) {
+      task_class.pass = std::max(task_class.pass, virtual_time_);
+    }
+    task_class.tasks.push_back({std::move(task), Now()});
+  }
+  wake_.notify_one();
+}
+
+TaskClassStats WorkerPool::stats(TaskPriority priority) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const TaskClass& task_class = classes_[static_cast<size_t>(priority)];
+  TaskClassStats stats;
+  stats.queued = task_class.tasks.size();
+  stats.running = task_class.running;
+  stats.started = task_class.started;
+  stats.promoted = task_class.promoted;
+  stats.total_wait_us = task_class.total_wait_us;
+  stats.max_wait_us = task_class.max_wait_us;
+  stats.p50_wait_us = WaitPercentile(task_class, 0.50);
+  stats.p99_wait_us = WaitPercentile(task_class, 0.99);
+  return stats;
+}
+
+size_t WorkerPool::WaitBucket(int64_t wait_us) {
+  size_t bucket = 0;
+  while (wait_us > 0 && bucket + 1 < kWaitBuckets) {
+    wait_us >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+int64_t WorkerPool::WaitPercentile(const TaskClass& task_class,
+                                   double fraction) {
+  const uint64_t rank = static_cast<uint64_t>(
+      fraction * static_cast<double>(task_class.started) + 0.5);
+  uint64_t seen = 0;
+  for (size_t bucket = 0; bucket < kWaitBuckets; ++bucket) {
+    seen += task_class.wait_buckets[bucket];
+    if (seen > 0 && seen >= rank) {
+      const int64_t upper = bucket == 0 ? 0 : (int64_t{1} << bucket) - 1;
+      return std::min(upper, task_class.max_wait_us);
+    }
+  }
+  return 0;
+}
+
+bool WorkerPool::CanStart(size_t index) const {
+  const TaskClass& task_class = classes_[index];
+  if (task_class.tasks.empty() ||
+      task_class.running >= task_class.max_running) {
+    return false;
+  }
+  if (static_cast<TaskPriority>(index) == TaskPriority::kInteractive) {
+    return true;
+  }
+  const size_t shared_running =
+      classes_[static_cast<size_t>(TaskPriority::kNormal)].running +
+      classes_[static_cast<size_t>(TaskPriority::kBulk)].running;
+  return shared_running < shared_threads_;
+}
+
+int WorkerPool::PickClass(Clock::time_point now, bool* promoted) const {
+  // A class that has gone unserved past its starvation limit goes first,
+  // the one unserved longest if there are several. A class that keeps
+  // starting tasks is not starved, however long its backlog.
+  int chosen = -1;
+  Clock::duration most_overdue = Clock::duration::zero();
+  for (size_t i = 0; i < kTaskPriorityCount; ++i) {
+    if (!CanStart(i)) continue;
+    const TaskClass& task_class = classes_[i];
+    const Clock::time_point unserved_since =
+        std::max(task_class.last_start, task_class.tasks.front().enqueued);
+    const Clock::duration overdue =
+        now - unserved_since - task_class.starvation_limit;
+    if (overdue > most_overdue) {
+      most_overdue = overdue;
+      chosen = static_cast<int>(i);
+    }
+  }
+  *promoted = chosen >= 0;
+  if (chosen >= 0) return chosen;
+
+  // Otherwise the lowest pass; ties go to the more interactive class.
+  for (size_t i = 0; i < kTaskPriorityCount; ++i) {
+    if (!CanStart(i)) continue;
+    const TaskClass& task_class = classes_[i];
+    if (chosen < 0 || task_class.pass < classes_[chosen].pass) {
+      chosen = static_cast<int>(i);
+    }
+  }
+  return chosen;
+}
+
+void WorkerPool::RecordWait(TaskClass* task_class, int64_t wait_us,
+                            bool promoted) {
+  ++task_class->started;
+  if (promoted) ++task_class->promoted;
+  task_class->total_wait_us += wait_us;
+  task_class->max_wait_us = std::max(task_class->max_wait_us, wait_us);
+  ++task_class->wait_buckets[WaitBucket(wait_us)];
+}
+
+WorkerPool::Clock::time_point WorkerPool::Now() const {
+  return clock_ ? clock_() : Clock::now();
+}
+
+void WorkerPool::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    int chosen = -1;
+    bool promoted = false;
+    wake_.wait(lock, [this, &chosen, &promoted] {
+      if (stopping_) return true;
+      chosen = PickClass(Now(), &promoted);
+      return chosen >= 0;
+    });
+    if (stopping_) return;
+
+    TaskClass& task_class = classes_[chosen];
+    const Clock::time_point now = Now();
+    Task task = std::move(task_class.tasks.front());
+    task_class.tasks.pop_front();
+    RecordWait(&task_class,
+               std::chrono::duration_cast<std::chrono::microseconds>(
+                   now - task.enqueued)
+                   .count(),
+               promoted);
+    task_class.last_start = now;
+    virtual_time_ = task_class.pass;
+    task_class.pass += kStride / task_class.weight;
+    ++task_class.running;
+
+    lock.unlock();
+    task.run();
+    task = Task();  // Captures are destroyed outside the lock.
+    lock.lock();
+    --task_class.running;
+    // This thread picks the next task itself, but with a class at a limit
+    // there may be more waiting that an idle thread can now start.
+    for (const TaskClass& waiting : classes_) {
+      if (!waiting.tasks.empty()) {
+        wake_.notify_one();
+        break;
+      }
+    }
+  }
+}
+
+}  // namespace flutter_native_utils
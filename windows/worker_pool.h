@@ -0,0 +1,151 @@
+#ifndef FLUTTER_PLUGIN_WORKER_POOL_H_
+#define FLUTTER_PLUGIN_WORKER_POOL_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace flutter_native_utils {
+
+// Scheduling classes of pool tasks, most latency-sensitive first.
+enum class TaskPriority { kInteractive, kNormal, kBulk };
+
+constexpr size_t kTaskPriorityCount = 3;
+
+// "interactive", "normal" or "bulk".
+const char* TaskPriorityName(TaskPriority priority);
+
+// The time queue waits and starvation are measured by; injectable for
+// tests.
+using WorkerPoolClock = std::function<std::chrono::steady_clock::time_point()>;
+
+struct TaskClassOptions {
+  // Relative share of dequeues while several classes have tasks waiting.
+  uint32_t weight = 1;
+  // Most tasks of the class running at once; zero means no limit.
+  size_t max_running = 0;
+  // A class that has had a task waiting but none started for this long
+  // starts one next, whatever the weights say.
+  std::chrono::microseconds starvation_limit{100000};
+};
+
+struct WorkerPoolOptions {
+  // Zero uses one thread per logical processor.
+  size_t thread_count = 0;
+  // Indexed by TaskPriority.
+  TaskClassOptions classes[kTaskPriorityCount] = {
+      {8, 0, std::chrono::milliseconds(10)},
+      {4, 0, std::chrono::milliseconds(50)},
+      {1, 0, std::chrono::milliseconds(250)},
+  };
+  // Threads only interactive tasks may take, so a flood of slow normal and
+  // bulk tasks cannot occupy every thread. At least one thread is always
+  // left to them.
+  size_t interactive_reserve = 1;
+  // Null reads std::chrono::steady_clock.
+  WorkerPoolClock clock;
+};
+
+// Queue-wait metrics of one class since the pool was created.
+struct TaskClassStats {
+  size_t queued = 0;
+  size_t running = 0;
+  uint64_t started = 0;
+  // Tasks started early by starvation protection.
+  uint64_t promoted = 0;
+  int64_t total_wait_us = 0;
+  int64_t max_wait_us = 0;
+  // Upper bounds of the power-of-two bucket holding the percentile.
+  int64_t p50_wait_us = 0;
+  int64_t p99_wait_us = 0;
+};
+
+// Fixed-size pool of worker threads. Tasks run in FIFO order within their
+// class; classes share the threads by weighted-fair dequeue (stride
+// scheduling), subject to per-class concurrency limits and starvation
+// protection.
+//
+// Tasks must not block waiting on other tasks posted to the same pool; split
+// work into independent tasks and have the last one to finish complete the
+// job (see FileHasher for the pattern).
+class WorkerPool {
+ public:
+  // |thread_count| of zero uses one thread per logical processor.
+  explicit WorkerPool(size_t thread_count = 0);
+
+  explicit WorkerPool(const WorkerPoolOptions& options);
+
+  // Joins all workers. Tasks that have not started yet are discarded.
+  ~WorkerPool();
+
+  // Disallow copy and assign.
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  void Post(std::function<void()> task,
+            TaskPriority priority = TaskPriority::kNormal);
+
+  size_t thread_count() const { return threads_.size(); }
+
+  TaskClassStats stats(TaskPriority priority) const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  // Waits of 2^(i-1) to 2^i - 1 us land in bucket i; bucket 0 holds zero.
+  static constexpr size_t kWaitBuckets = 32;
+
+  struct Task {
+    std::function<void()> run;
+    Clock::time_point enqueued;
+  };
+
+  struct TaskClass {
+    std::deque<Task> tasks;
+    uint32_t weight = 1;
+    size_t max_running = 0;
+    Clock::duration starvation_limit{};
+    size_t running = 0;
+    // Virtual time of the class's next dequeue.
+    uint64_t pass = 0;
+    Clock::time_point last_start;
+    uint64_t started = 0;
+    uint64_t promoted = 0;
+    int64_t total_wait_us = 0;
+    int64_t max_wait_us = 0;
+    uint64_t wait_buckets[kWaitBuckets] = {};
+  };
+
+  Clock::time_point Now() const;
+  void WorkerLoop();
+  // Whether a task of classes_[index] is waiting and within the limits.
+  bool CanStart(size_t index) const;
+  // Index of the class whose task should start next, or -1 if none may.
+  // Sets |*promoted| if starvation protection chose it.
+  int PickClass(Clock::time_point now, bool* promoted) const;
+  void RecordWait(TaskClass* task_class, int64_t wait_us, bool promoted);
+  static size_t WaitBucket(int64_t wait_us);
+  static int64_t WaitPercentile(const TaskClass& task_class, double fraction);
+
+  const WorkerPoolClock clock_;
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  TaskClass classes_[kTaskPriorityCount];
+  // Most normal and bulk tasks running at once; see interactive_reserve.
+  size_t shared_threads_ = 1;
+  // Pass of the last dequeue; classes that were idle restart from here, so
+  // idling earns no credit.
+  uint64_t virtual_time_ = 0;
+  bool stopping_ = false;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace flutter_native_utils
+
+#endif  // FLUTTER_PLUGIN_WORKER_POOL_H_